@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * @file bench_common.hpp
+ * @brief Minimal timing helpers shared by the benchmark executables
+ */
+
+#include "NovelMind/core/types.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace NovelMind::bench {
+
+/**
+ * @brief Run a callable and return elapsed wall time in seconds
+ */
+template <typename Fn> f64 measureSeconds(Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<f64>(end - start).count();
+}
+
+/**
+ * @brief Best-of-N timing to reduce scheduler noise
+ */
+template <typename Fn> f64 bestOf(int runs, Fn &&fn) {
+  f64 best = measureSeconds(fn);
+  for (int i = 1; i < runs; ++i) {
+    f64 t = measureSeconds(fn);
+    if (t < best) {
+      best = t;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Print one result line: name, time and throughput
+ */
+inline void report(const std::string &name, f64 seconds, f64 operations,
+                   const char *unit) {
+  std::printf("%-44s %10.3f ms %14.2f M%s/s\n", name.c_str(), seconds * 1000.0,
+              seconds > 0.0 ? operations / seconds / 1e6 : 0.0, unit);
+}
+
+/**
+ * @brief Keep a value alive so the optimizer cannot drop the work
+ */
+template <typename T> void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  __asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+} // namespace NovelMind::bench
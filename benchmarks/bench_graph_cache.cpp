@@ -0,0 +1,96 @@
+/**
+ * @file bench_graph_cache.cpp
+ * @brief Opening large graph files from JSON versus the binary cache
+ *
+ * "JSON" rows parse the saved graph with loadJson(); "cache hit" rows load
+ * the same file through GraphCache after its entry has been written, which
+ * hashes the JSON and decodes the binary entry instead of parsing.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/graph_cache.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::unique_ptr<IRGraph> makeGraph(usize nodeCount) {
+  auto graph = std::make_unique<IRGraph>();
+  NodeId previous = graph->createNode(IRNodeType::SceneStart);
+  graph->addScene("start", previous);
+  for (usize i = 1; i < nodeCount; ++i) {
+    const NodeId id = graph->createNode(IRNodeType::Dialogue);
+    if (IRNode *node = graph->getNode(id)) {
+      node->setPosition(static_cast<f32>(i % 40) * 220.0f,
+                        static_cast<f32>(i / 40) * 140.0f);
+      node->setProperty("character", std::string("hero"));
+      node->setProperty("text", "Line " + std::to_string(i) + " of the story");
+      node->setProperty("duration", static_cast<f64>(i % 7) * 0.25);
+    }
+    (void)graph->connect({previous, "exec_out", true}, {id, "exec_in", false});
+    previous = id;
+  }
+  return graph;
+}
+
+void run(usize nodeCount) {
+  const fs::path dir = fs::temp_directory_path() / "novelmind_bench_graph_cache";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  const std::string irPath = (dir / "story.ir.json").string();
+  const std::string visualPath = (dir / "story.graph.json").string();
+
+  auto graph = makeGraph(nodeCount);
+  VisualGraph visual;
+  visual.fromIR(*graph);
+  GraphCache cache((dir / "cache").string());
+  (void)cache.saveIRGraph(*graph, irPath);
+  (void)cache.saveVisualGraph(visual, visualPath);
+
+  const auto nodes = static_cast<f64>(nodeCount);
+  std::printf("\n%zu nodes: IR JSON %ju bytes, binary %zu bytes; visual JSON "
+              "%ju bytes, binary %zu bytes\n",
+              nodeCount, static_cast<uintmax_t>(fs::file_size(irPath)),
+              graph->toBinary(0).size(),
+              static_cast<uintmax_t>(fs::file_size(visualPath)),
+              visual.toBinary(0).size());
+
+  const f64 irJson = bench::bestOf(3, [&] {
+    bench::doNotOptimize(IRGraph::loadJson(irPath).value()->getNodes().size());
+  });
+  bench::report("IRGraph, JSON", irJson, nodes, "nodes");
+  const f64 irCached = bench::bestOf(3, [&] {
+    bench::doNotOptimize(
+        cache.loadIRGraph(irPath).value()->getNodes().size());
+  });
+  bench::report("IRGraph, cache hit", irCached, nodes, "nodes");
+
+  const f64 visualJson = bench::bestOf(3, [&] {
+    bench::doNotOptimize(
+        VisualGraph::loadJson(visualPath).value()->getNodes().size());
+  });
+  bench::report("VisualGraph, JSON", visualJson, nodes, "nodes");
+  const f64 visualCached = bench::bestOf(3, [&] {
+    bench::doNotOptimize(
+        cache.loadVisualGraph(visualPath).value()->getNodes().size());
+  });
+  bench::report("VisualGraph, cache hit", visualCached, nodes, "nodes");
+
+  std::printf("cache hits %zu, misses %zu\n", cache.getStats().hits,
+              cache.getStats().misses);
+  fs::remove_all(dir);
+}
+
+} // namespace
+
+int main() {
+  for (usize nodeCount : {usize{10000}, usize{50000}}) {
+    run(nodeCount);
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file bench_graph_diff.cpp
+ * @brief Diffing and round-trip validating a multi-thousand-node project
+ *
+ * The project is one script of many scenes, converted to a VisualGraph.
+ * "sequential" rows are GraphDiffer::diff() and a loop of
+ * validateTextRoundTrip() over the scenes, which is what an editor save
+ * ran before; "pooled" rows split the work by scene on a ThreadPool and
+ * skip scenes whose hash or text is unchanged.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/core/thread_pool.hpp"
+#include "NovelMind/scripting/incremental_validator.hpp"
+#include "NovelMind/scripting/ir.hpp"
+#include <cstdio>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+std::string makeScript(usize scenes, usize linesPerScene) {
+  std::string script = "character Hero(name=\"Alex\", color=\"#ffcc00\")\n\n";
+  for (usize s = 0; s < scenes; ++s) {
+    script += "scene s" + std::to_string(s) + " {\n";
+    for (usize l = 0; l < linesPerScene; ++l) {
+      script += "    say Hero \"Scene " + std::to_string(s) + ", line " +
+                std::to_string(l) + "\"\n";
+    }
+    script += "    goto s" + std::to_string((s + 1) % scenes) + "\n}\n\n";
+  }
+  return script;
+}
+
+// Edit the text of one line in each of @p count scenes
+VisualGraph editScenes(const VisualGraph &graph, usize count, usize scenes) {
+  VisualGraph edited = graph;
+  for (usize s = 0; s < count; ++s) {
+    const std::string text =
+        "Scene " + std::to_string(s * scenes / count) + ", line 3";
+    for (const auto &node : graph.getNodes()) {
+      auto it = node.properties.find("text");
+      if (it != node.properties.end() && it->second == text) {
+        edited.setNodeProperty(node.id, "text", text + " (edited)");
+        edited.setNodePosition(node.id, node.x + 10.0f, node.y);
+      }
+    }
+  }
+  return edited;
+}
+
+void run(usize scenes, usize linesPerScene) {
+  const std::string script = makeScript(scenes, linesPerScene);
+  RoundTripConverter converter;
+  auto parsed = converter.textToVisualGraph(script);
+  if (parsed.isError()) {
+    std::printf("Failed to build the project: %s\n", parsed.error().c_str());
+    return;
+  }
+  const VisualGraph &graph = *parsed.value();
+  const VisualGraph edited = editScenes(graph, 4, scenes);
+  core::ThreadPool pool;
+  const auto sceneCount = static_cast<f64>(scenes);
+  std::printf("\n%zu scenes, %zu nodes, %zu edges, %zu threads\n", scenes,
+              graph.getNodes().size(), graph.getEdges().size(),
+              pool.getThreadCount());
+
+  GraphDiffer differ;
+  const f64 diff = bench::bestOf(
+      5, [&] { bench::doNotOptimize(differ.diff(graph, edited).size()); });
+  bench::report("diff, sequential", diff, sceneCount, "scenes");
+  const f64 pooled = bench::bestOf(
+      5, [&] { bench::doNotOptimize(differ.diff(graph, edited, pool).size()); });
+  bench::report("diff, pooled by scene", pooled, sceneCount, "scenes");
+
+  const auto sections = splitDeclarations(script);
+  const f64 validate = bench::bestOf(3, [&] {
+    RoundTripValidator validator;
+    usize valid = 0;
+    for (const auto section : sections) {
+      valid += validator.validateTextRoundTrip(std::string(section)).isValid;
+    }
+    bench::doNotOptimize(valid);
+  });
+  bench::report("validate, sequential", validate, sceneCount, "scenes");
+  const f64 cold = bench::bestOf(3, [&] {
+    RoundTripValidator validator;
+    bench::doNotOptimize(validator.validateScenes(script, pool).size());
+  });
+  bench::report("validate, pooled", cold, sceneCount, "scenes");
+
+  // One scene edited since the last save
+  RoundTripValidator validator;
+  (void)validator.validateScenes(script, pool);
+  std::string changed = script;
+  changed.replace(changed.find("\"Scene 1, line 0\""), 17, "\"Scene 1, line 0!\"");
+  bool flip = false;
+  const f64 warm = bench::bestOf(3, [&] {
+    flip = !flip;
+    bench::doNotOptimize(
+        validator.validateScenes(flip ? changed : script, pool).size());
+  });
+  bench::report("validate, pooled, one scene edited", warm, sceneCount,
+                "scenes");
+}
+
+} // namespace
+
+int main() {
+  run(200, 20);
+  run(1000, 20);
+  return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file bench_incremental_validator.cpp
+ * @brief Diagnostics for a 20k-line script: full validation vs. one edit
+ *
+ * "full" lexes, parses and validates the whole script, which is what an
+ * editor pays per keystroke without IncrementalValidator. The edit rows
+ * time IncrementalValidator::edit for a keystroke inside a line of dialogue
+ * and for renaming a scene that another scene jumps to; each should stay
+ * well under 10 ms.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/incremental_validator.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/validator.hpp"
+#include <cstdio>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+constexpr usize kTargetLines = 20000;
+constexpr int kEdits = 200;
+
+std::string generateScript(usize &lines) {
+  static const char *kLines[] = {
+      "The wind carries the smell of rain across the old harbour",
+      "I never thought we would meet again, not after everything",
+      "Somewhere below, a door slams and footsteps fade away",
+      "You should rest. Tomorrow is going to be a long day"};
+
+  std::string script;
+  script += "character Hero(name=\"Alex\", color=\"#FFCC00\")\n";
+  script += "character Sage(name=\"The Elder Sage\", color=\"#88AAFF\")\n\n";
+  lines = 3;
+
+  usize scene = 0;
+  while (lines < kTargetLines) {
+    script += "scene chapter_" + std::to_string(scene) + " {\n";
+    for (usize i = 0; i < 12; ++i) {
+      script += i % 2 == 0 ? "    say Hero \"" : "    say Sage \"";
+      script += kLines[(scene + i) % 4];
+      script += "\"\n";
+    }
+    script += "    set trust = trust + " + std::to_string(scene % 7) + "\n";
+    script += "    choice {\n";
+    script += "        \"Follow the footsteps\" -> goto chapter_" +
+              std::to_string(scene + 1) + "\n";
+    script += "        \"Stay by the fire\" -> { set stayed = trust }\n";
+    script += "    }\n";
+    script += "}\n\n";
+    lines += 20;
+    ++scene;
+  }
+  script += "scene chapter_" + std::to_string(scene) + " {\n    goto chapter_0\n}\n";
+  lines += 3;
+  return script;
+}
+
+usize validateFull(const std::string &script) {
+  Lexer lexer;
+  auto tokens = lexer.tokenize(script);
+  Parser parser;
+  auto program = parser.parse(tokens.value());
+  Validator validator;
+  return validator.validate(program.value()).errors.all().size();
+}
+
+// Apply @p forward, then @p back, kEdits times; returns seconds per edit
+f64 timeEdits(IncrementalValidator &document, const TextEdit &forward,
+              const TextEdit &back) {
+  const f64 seconds = bench::bestOf(3, [&] {
+    for (int i = 0; i < kEdits; ++i) {
+      (void)document.edit(i % 2 == 0 ? forward : back);
+      bench::doNotOptimize(document.getLastUpdate().reparsed);
+    }
+  });
+  return seconds / kEdits;
+}
+
+} // namespace
+
+int main() {
+  usize lines = 0;
+  const std::string script = generateScript(lines);
+  std::printf("Validating %zu lines (%.1f KB)\n", lines,
+              static_cast<f64>(script.size()) / 1024.0);
+
+  usize diagnostics = 0;
+  const f64 full =
+      bench::bestOf(3, [&] { diagnostics = validateFull(script); });
+  bench::report("full lex+parse+validate", full, static_cast<f64>(lines),
+                "lines");
+
+  IncrementalValidator document;
+  const f64 open = bench::measureSeconds([&] { document.open(script); });
+  bench::report("incremental open", open, static_cast<f64>(lines), "lines");
+  if (document.getDiagnostics().all().size() != diagnostics) {
+    std::fprintf(stderr, "diagnostics differ: %zu incremental, %zu full\n",
+                 document.getDiagnostics().all().size(), diagnostics);
+    return 1;
+  }
+
+  // A keystroke in the middle of the script, then its deletion
+  const usize middle = script.find("\"", script.size() / 2) + 1;
+  const f64 typing =
+      timeEdits(document, {middle, 0, "x"}, {middle, 1, ""});
+  bench::report("edit: type inside a say string", typing, 1.0, "edits");
+
+  // Renaming a scene revalidates the scene that jumps to it
+  const std::string name = "chapter_500 {";
+  const usize scene = script.find(name);
+  const f64 rename =
+      timeEdits(document, {scene, 7, "prologue"}, {scene, 8, "chapter"});
+  bench::report("edit: rename a referenced scene", rename, 1.0, "edits");
+  std::printf("last rename: %zu of %zu sections reparsed, %zu revalidated\n",
+              document.getLastUpdate().reparsed,
+              document.getLastUpdate().sections,
+              document.getLastUpdate().revalidated);
+
+  std::printf("speedup per keystroke: %.0fx\n", full / typing);
+  return 0;
+}
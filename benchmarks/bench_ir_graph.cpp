@@ -0,0 +1,152 @@
+/**
+ * @file bench_ir_graph.cpp
+ * @brief Traversal, validation and diffing of large synthetic story graphs
+ *
+ * "scan" rows reproduce the lookups IRGraph and GraphDiffer used before
+ * the adjacency index: every per-node query walks the whole connection
+ * list, which makes a topological sort O(V*E). The other rows call the
+ * current IRGraph and GraphDiffer.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/ir.hpp"
+#include <cstdio>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+// A chain of dialogue with a two-way choice every 8 nodes that rejoins
+std::unique_ptr<IRGraph> makeStoryGraph(usize nodeCount) {
+  auto graph = std::make_unique<IRGraph>();
+  NodeId previous = graph->createNode(IRNodeType::SceneStart);
+  usize created = 1;
+  while (created < nodeCount) {
+    if (created % 8 == 0 && created + 3 <= nodeCount) {
+      const NodeId choice = graph->createNode(IRNodeType::Choice);
+      const NodeId left = graph->createNode(IRNodeType::Dialogue);
+      const NodeId right = graph->createNode(IRNodeType::Dialogue);
+      (void)graph->connect({previous, "exec_out", true},
+                           {choice, "exec_in", false});
+      (void)graph->connect({choice, "choice_0", true},
+                           {left, "exec_in", false});
+      (void)graph->connect({choice, "choice_1", true},
+                           {right, "exec_in", false});
+      (void)graph->connect({left, "exec_out", true},
+                           {right, "exec_in", false});
+      previous = right;
+      created += 3;
+      continue;
+    }
+    const NodeId node = graph->createNode(IRNodeType::Dialogue);
+    graph->getNode(node)->setProperty("text", std::string("Line"));
+    (void)graph->connect({previous, "exec_out", true},
+                         {node, "exec_in", false});
+    previous = node;
+    ++created;
+  }
+  return graph;
+}
+
+usize topologicalScan(const IRGraph &graph) {
+  const auto &connections = graph.getConnections();
+  std::unordered_map<NodeId, int> inDegree;
+  for (const auto *node : graph.getNodes()) {
+    inDegree[node->getId()] = 0;
+  }
+  for (const auto &conn : connections) {
+    inDegree[conn.target.nodeId]++;
+  }
+  std::queue<NodeId> queue;
+  for (const auto &[id, degree] : inDegree) {
+    if (degree == 0) {
+      queue.push(id);
+    }
+  }
+  usize ordered = 0;
+  while (!queue.empty()) {
+    const NodeId id = queue.front();
+    queue.pop();
+    ++ordered;
+    for (const auto &conn : connections) {
+      if (conn.source.nodeId == id && --inDegree[conn.target.nodeId] == 0) {
+        queue.push(conn.target.nodeId);
+      }
+    }
+  }
+  return ordered;
+}
+
+usize diffEdgesScan(const VisualGraph &a, const VisualGraph &b) {
+  usize changes = 0;
+  for (const auto &edge : a.getEdges()) {
+    bool found = false;
+    for (const auto &other : b.getEdges()) {
+      if (edge.sourceNode == other.sourceNode &&
+          edge.sourcePort == other.sourcePort &&
+          edge.targetNode == other.targetNode &&
+          edge.targetPort == other.targetPort) {
+        found = true;
+        break;
+      }
+    }
+    changes += found ? 0 : 1;
+  }
+  return changes;
+}
+
+void run(usize nodeCount) {
+  auto graph = makeStoryGraph(nodeCount);
+  const auto edges = static_cast<f64>(graph->getConnections().size());
+  const auto nodes = static_cast<f64>(nodeCount);
+  std::printf("\n%zu nodes, %zu connections\n", nodeCount,
+              graph->getConnections().size());
+
+  const f64 build = bench::bestOf(3, [&] {
+    bench::doNotOptimize(makeStoryGraph(nodeCount)->getConnections().size());
+  });
+  bench::report("build (createNode + connect)", build, edges, "edges");
+
+  const f64 scan = bench::bestOf(
+      3, [&] { bench::doNotOptimize(topologicalScan(*graph)); });
+  bench::report("topological order, scan", scan, nodes, "nodes");
+  const f64 indexed = bench::bestOf(
+      3, [&] { bench::doNotOptimize(graph->getTopologicalOrder().size()); });
+  bench::report("topological order, indexed", indexed, nodes, "nodes");
+
+  const f64 validate =
+      bench::bestOf(3, [&] { bench::doNotOptimize(graph->validate().size()); });
+  bench::report("validate()", validate, nodes, "nodes");
+
+  VisualGraph before;
+  before.fromIR(*graph);
+  VisualGraph after = before;
+  const auto &edgeList = after.getEdges();
+  for (usize i = 0; i < edgeList.size(); i += 97) {
+    const VisualGraphEdge edge = edgeList[i];
+    after.removeEdge(edge.sourceNode, edge.sourcePort, edge.targetNode,
+                     edge.targetPort);
+  }
+
+  const f64 diffScan = bench::bestOf(
+      3, [&] { bench::doNotOptimize(diffEdgesScan(before, after)); });
+  bench::report("GraphDiffer edges, scan", diffScan, edges, "edges");
+  GraphDiffer differ;
+  const f64 diff = bench::bestOf(
+      3, [&] { bench::doNotOptimize(differ.diff(before, after).size()); });
+  bench::report("GraphDiffer::diff", diff, edges, "edges");
+}
+
+} // namespace
+
+int main() {
+  for (usize nodeCount : {usize{5000}, usize{20000}}) {
+    run(nodeCount);
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file bench_json_graph.cpp
+ * @brief Saving and loading large IR graphs as JSON
+ *
+ * The "stringstream" row reproduces the serializer IRGraph used before
+ * core::JsonWriter: a std::stringstream per node, with strings written
+ * unescaped. The other rows call the current toJson(), saveJson(),
+ * fromJson() and loadJson(); there was no loader before.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/ir.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+std::unique_ptr<IRGraph> makeGraph(usize nodeCount) {
+  auto graph = std::make_unique<IRGraph>();
+  graph->setName("Benchmark");
+  NodeId previous = graph->createNode(IRNodeType::SceneStart);
+  graph->addScene("start", previous);
+  graph->addCharacter("hero", "Hero", "#ffffff");
+  for (usize i = 1; i < nodeCount; ++i) {
+    const NodeId id = graph->createNode(IRNodeType::Dialogue);
+    if (IRNode *node = graph->getNode(id)) {
+      node->setPosition(static_cast<f32>(i % 40) * 220.0f,
+                        static_cast<f32>(i / 40) * 140.5f);
+      node->setProperty("character", std::string("hero"));
+      node->setProperty("text", "Line " + std::to_string(i) +
+                                    " of the story, said \"quietly\".");
+      node->setProperty("duration", static_cast<f64>(i % 7) * 0.25);
+      node->setProperty("voiced", i % 2 == 0);
+    }
+    (void)graph->connect({previous, "exec_out", true}, {id, "exec_in", false});
+    previous = id;
+  }
+  return graph;
+}
+
+std::string nodeToJsonStringstream(const IRNode &node) {
+  std::stringstream ss;
+  ss << "{";
+  ss << "\"id\":" << node.getId() << ",";
+  ss << "\"type\":\"" << node.getTypeName() << "\",";
+  ss << "\"x\":" << node.getX() << ",";
+  ss << "\"y\":" << node.getY() << ",";
+  ss << "\"properties\":{";
+  bool first = true;
+  for (const auto &[name, value] : node.getProperties()) {
+    if (!first)
+      ss << ",";
+    first = false;
+    ss << "\"" << name << "\":";
+    std::visit(
+        [&ss](const auto &v) {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<T, std::nullptr_t>) {
+            ss << "null";
+          } else if constexpr (std::is_same_v<T, bool>) {
+            ss << (v ? "true" : "false");
+          } else if constexpr (std::is_same_v<T, i64> ||
+                               std::is_same_v<T, f64>) {
+            ss << v;
+          } else if constexpr (std::is_same_v<T, std::string>) {
+            ss << "\"" << v << "\"";
+          } else {
+            ss << "[";
+            for (size_t i = 0; i < v.size(); ++i) {
+              if (i > 0)
+                ss << ",";
+              ss << "\"" << v[i] << "\"";
+            }
+            ss << "]";
+          }
+        },
+        value);
+  }
+  ss << "}}";
+  return ss.str();
+}
+
+std::string toJsonStringstream(const IRGraph &graph) {
+  std::stringstream ss;
+  ss << "{\"name\":\"" << graph.getName() << "\",\"nodes\":[";
+  bool first = true;
+  for (const auto *node : graph.getNodes()) {
+    if (!first)
+      ss << ",";
+    first = false;
+    ss << nodeToJsonStringstream(*node);
+  }
+  ss << "],\"connections\":[";
+  first = true;
+  for (const auto &conn : graph.getConnections()) {
+    if (!first)
+      ss << ",";
+    first = false;
+    ss << "{\"sourceNode\":" << conn.source.nodeId << ",\"sourcePort\":\""
+       << conn.source.portName << "\",\"targetNode\":" << conn.target.nodeId
+       << ",\"targetPort\":\"" << conn.target.portName << "\"}";
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+void run(usize nodeCount) {
+  auto graph = makeGraph(nodeCount);
+  const std::string json = graph->toJson();
+  const auto bytes = static_cast<f64>(json.size());
+  std::printf("\n%zu nodes, %zu bytes of JSON\n", nodeCount, json.size());
+
+  const f64 old = bench::bestOf(
+      3, [&] { bench::doNotOptimize(toJsonStringstream(*graph).size()); });
+  bench::report("toJson, stringstream", old, bytes, "bytes");
+  const f64 write =
+      bench::bestOf(3, [&] { bench::doNotOptimize(graph->toJson().size()); });
+  bench::report("toJson, JsonWriter", write, bytes, "bytes");
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "novelmind_bench_graph.json")
+          .string();
+  const f64 save = bench::bestOf(
+      3, [&] { bench::doNotOptimize(graph->saveJson(path).isOk()); });
+  bench::report("saveJson", save, bytes, "bytes");
+
+  const f64 parse = bench::bestOf(3, [&] {
+    bench::doNotOptimize(IRGraph::fromJson(json)->getNodes().size());
+  });
+  bench::report("fromJson", parse, bytes, "bytes");
+  const f64 load = bench::bestOf(3, [&] {
+    bench::doNotOptimize(IRGraph::loadJson(path).value()->getNodes().size());
+  });
+  bench::report("loadJson (mapped file)", load, bytes, "bytes");
+  std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main() {
+  for (usize nodeCount : {usize{10000}, usize{50000}}) {
+    run(nodeCount);
+  }
+  return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file bench_lexer.cpp
+ * @brief Tokenizing a generated 10 MB script: owning vs. string_view tokens
+ *
+ * "owning" copies every lexeme into its own std::string, which is what a
+ * Token used to carry; "view" is the current Lexer, whose tokens point into
+ * the SourceFile buffer. Each variant runs in a child process so its peak
+ * RSS can be reported separately (POSIX only).
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/source_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define NOVELMIND_BENCH_FORK 1
+#else
+#define NOVELMIND_BENCH_FORK 0
+#endif
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+constexpr usize kTargetBytes = 10 * 1024 * 1024;
+
+// Token layout before the switch to views
+struct OwningToken {
+  TokenType type;
+  std::string lexeme;
+  SourceLocation location;
+  union {
+    i32 intValue;
+    f32 floatValue;
+  };
+};
+
+std::string generateScript() {
+  static const char *kLines[] = {
+      "The wind carries the smell of rain across the old harbour",
+      "I never thought we would meet again, not after everything",
+      "Somewhere below, a door slams and footsteps fade away",
+      "You should rest. Tomorrow is going to be a long day"};
+
+  std::string script;
+  script.reserve(kTargetBytes + 4096);
+  script += "character Hero(name=\"Alex\", color=\"#FFCC00\")\n";
+  script += "character Sage(name=\"The Elder Sage\", color=\"#88AAFF\")\n\n";
+
+  usize scene = 0;
+  while (script.size() < kTargetBytes) {
+    script += "scene chapter_" + std::to_string(scene) + " {\n";
+    script += "    show background \"bg_harbour_night\"\n";
+    for (usize i = 0; i < 24; ++i) {
+      script += i % 2 == 0 ? "    say Hero \"" : "    say Sage \"";
+      script += kLines[(scene + i) % 4];
+      script += "\"\n";
+    }
+    script += "    set trust = trust + " + std::to_string(scene % 7) + "\n";
+    script += "    wait 0.5\n";
+    script += "    choice {\n";
+    script += "        \"Follow the footsteps\" -> goto chapter_" +
+              std::to_string(scene + 1) + "\n";
+    script += "        \"Stay by the fire\" -> { set stayed = true }\n";
+    script += "    }\n";
+    script += "}\n\n";
+    ++scene;
+  }
+  return script;
+}
+
+usize tokenizeView(const SourceFile &file) {
+  Lexer lexer;
+  auto tokens = lexer.tokenize(file.getText());
+  if (tokens.isError()) {
+    std::fprintf(stderr, "lexer error: %s\n", tokens.error().c_str());
+    return 0;
+  }
+  bench::doNotOptimize(tokens.value().data());
+  return tokens.value().size();
+}
+
+usize tokenizeOwning(const SourceFile &file) {
+  Lexer lexer;
+  auto tokens = lexer.tokenize(file.getText());
+  if (tokens.isError()) {
+    std::fprintf(stderr, "lexer error: %s\n", tokens.error().c_str());
+    return 0;
+  }
+
+  std::vector<OwningToken> owning;
+  owning.reserve(tokens.value().size());
+  for (const auto &token : tokens.value()) {
+    OwningToken copy{token.type, token.text(), token.location, {}};
+    copy.intValue = token.intValue;
+    owning.push_back(std::move(copy));
+  }
+  bench::doNotOptimize(owning.data());
+  return owning.size();
+}
+
+void run(const char *name, const SourceFile &file,
+         usize (*tokenize)(const SourceFile &)) {
+  usize tokenCount = 0;
+  f64 seconds = bench::bestOf(3, [&] { tokenCount = tokenize(file); });
+  bench::report(std::string(name) + " (" + std::to_string(tokenCount) +
+                    " tokens)",
+                seconds, static_cast<f64>(tokenCount), "tokens");
+}
+
+void runIsolated(const char *name, const SourceFile &file,
+                 usize (*tokenize)(const SourceFile &)) {
+#if NOVELMIND_BENCH_FORK
+  std::fflush(stdout);
+  pid_t child = fork();
+  if (child == 0) {
+    run(name, file, tokenize);
+    std::fflush(stdout);
+    _exit(0);
+  }
+
+  int status = 0;
+  struct rusage usage {};
+  if (child > 0 && wait4(child, &status, 0, &usage) == child) {
+#if defined(__APPLE__)
+    const f64 peakMb = static_cast<f64>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    const f64 peakMb = static_cast<f64>(usage.ru_maxrss) / 1024.0;
+#endif
+    std::printf("%-44s %10.1f MB peak RSS\n", name, peakMb);
+    return;
+  }
+#endif
+  run(name, file, tokenize);
+}
+
+} // namespace
+
+int main() {
+  const auto path =
+      std::filesystem::temp_directory_path() / "novelmind_bench_lexer.nms";
+  {
+    std::ofstream out(path, std::ios::binary);
+    const std::string script = generateScript();
+    out.write(script.data(), static_cast<std::streamsize>(script.size()));
+  }
+
+  auto file = SourceFile::load(path.string());
+  std::filesystem::remove(path);
+  if (file.isError()) {
+    std::fprintf(stderr, "%s\n", file.error().c_str());
+    return 1;
+  }
+
+  std::printf("Lexer over %.1f MB (%u lines)\n",
+              static_cast<f64>(file.value()->size()) / (1024.0 * 1024.0),
+              file.value()->getLineCount());
+  runIsolated("owning std::string tokens", *file.value(), tokenizeOwning);
+  runIsolated("string_view tokens", *file.value(), tokenizeView);
+  return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file bench_pack_codec.cpp
+ * @brief Pack size and BlockCodec speed on a synthetic asset mix
+ *
+ * The mix stands in for a shipped game: script and localization text, UI
+ * layout data made of small binary records, and already-compressed images
+ * and audio (random bytes). Sizes are for whole packs built by PackWriter;
+ * speeds are per resource type, in uncompressed MB/s.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/vfs/block_codec.hpp"
+#include "NovelMind/vfs/pack_writer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::vfs;
+
+namespace {
+
+struct Asset {
+  std::string id;
+  std::vector<u8> data;
+  ResourceType type;
+};
+
+std::vector<u8> scriptText(std::mt19937 &rng, usize size) {
+  static const char *const speakers[] = {"Hero", "Mira", "Narrator", "Guard"};
+  std::string text;
+  while (text.size() < size) {
+    const auto line = static_cast<u32>(rng() % 1000);
+    switch (rng() % 4) {
+    case 0:
+      text += "scene chapter_" + std::to_string(line % 40) + " {\n";
+      break;
+    case 1:
+      text += "    show " + std::string(speakers[rng() % 4]) + " at center\n";
+      break;
+    default:
+      text += "    say " + std::string(speakers[rng() % 4]) + " \"line_" +
+              std::to_string(line) + ": We should keep moving.\"\n";
+      break;
+    }
+  }
+  text.resize(size);
+  return {text.begin(), text.end()};
+}
+
+std::vector<u8> localization(std::mt19937 &rng, usize size) {
+  std::string text = "{\n";
+  while (text.size() < size) {
+    const auto key = static_cast<u32>(rng() % 100000);
+    text += "  \"dialog.chapter" + std::to_string(key % 40) + ".line" +
+            std::to_string(key) + "\": \"Translated text number " +
+            std::to_string(key % 977) + " for the story\",\n";
+  }
+  text.resize(size);
+  return {text.begin(), text.end()};
+}
+
+std::vector<u8> uiLayout(std::mt19937 &rng, usize size) {
+  struct Widget {
+    u32 id;
+    i16 x, y, width, height;
+    u8 anchor, layer, flags, style;
+  };
+  std::vector<u8> data;
+  u32 id = 0;
+  while (data.size() + sizeof(Widget) <= size) {
+    Widget widget{id++,
+                  static_cast<i16>(rng() % 8 * 40),
+                  static_cast<i16>(rng() % 12 * 24),
+                  120,
+                  32,
+                  static_cast<u8>(rng() % 3),
+                  2,
+                  0,
+                  static_cast<u8>(rng() % 4)};
+    const usize offset = data.size();
+    data.resize(offset + sizeof(Widget));
+    std::memcpy(data.data() + offset, &widget, sizeof(Widget));
+  }
+  data.resize(size);
+  return data;
+}
+
+std::vector<u8> encoded(std::mt19937 &rng, usize size) {
+  std::vector<u8> data(size);
+  for (auto &byte : data) {
+    byte = static_cast<u8>(rng());
+  }
+  return data;
+}
+
+std::vector<Asset> makeAssets() {
+  std::mt19937 rng(2024);
+  std::vector<Asset> assets;
+  const auto add = [&](const char *prefix, usize count, usize size,
+                       ResourceType type, auto make) {
+    for (usize i = 0; i < count; ++i) {
+      assets.push_back(
+          {prefix + std::to_string(i), make(rng, size), type});
+    }
+  };
+  add("scripts/", 200, 16 * 1024, ResourceType::Script, scriptText);
+  add("lang/", 40, 128 * 1024, ResourceType::Localization, localization);
+  add("ui/", 300, 8 * 1024, ResourceType::Data, uiLayout);
+  add("sprites/", 100, 96 * 1024, ResourceType::Texture, encoded);
+  add("voice/", 20, 256 * 1024, ResourceType::Audio, encoded);
+  return assets;
+}
+
+u64 packSize(const std::vector<Asset> &assets, PackWriter &writer) {
+  for (const auto &asset : assets) {
+    writer.addResource(asset.id, asset.data, asset.type);
+  }
+  return writer.build().value().size();
+}
+
+void codecRow(const char *name, const std::vector<Asset> &assets,
+              ResourceType type, BlockCodec::Level level) {
+  std::vector<std::vector<u8>> packed;
+  u64 input = 0;
+  u64 output = 0;
+  for (const auto &asset : assets) {
+    if (asset.type != type) {
+      continue;
+    }
+    std::vector<u8> block(BlockCodec::maxCompressedSize(asset.data.size()));
+    block.resize(BlockCodec::compress(asset.data, block, level));
+    input += asset.data.size();
+    output += block.size();
+    packed.push_back(std::move(block));
+  }
+
+  const f64 encode = bench::bestOf(3, [&] {
+    std::vector<u8> block;
+    for (const auto &asset : assets) {
+      if (asset.type == type) {
+        block.resize(BlockCodec::maxCompressedSize(asset.data.size()));
+        bench::doNotOptimize(BlockCodec::compress(asset.data, block, level));
+      }
+    }
+  });
+  const f64 decode = bench::bestOf(5, [&] {
+    std::vector<u8> buffer;
+    usize i = 0;
+    for (const auto &asset : assets) {
+      if (asset.type == type) {
+        buffer.resize(asset.data.size());
+        bench::doNotOptimize(BlockCodec::decompress(packed[i++], buffer).isOk());
+      }
+    }
+  });
+
+  const auto megabytes = static_cast<f64>(input) / 1e6;
+  std::printf("%-28s ratio %5.2f  encode %8.1f MB/s  decode %8.1f MB/s\n",
+              name, static_cast<f64>(input) / static_cast<f64>(output),
+              megabytes / encode, megabytes / decode);
+}
+
+} // namespace
+
+int main() {
+  const auto assets = makeAssets();
+  u64 total = 0;
+  for (const auto &asset : assets) {
+    total += asset.data.size();
+  }
+  std::printf("%zu resources, %.1f MB\n\n", assets.size(),
+              static_cast<f64>(total) / 1e6);
+
+  PackWriter stored;
+  for (usize type = 0; type <= static_cast<usize>(ResourceType::Data); ++type) {
+    stored.setCompression(static_cast<ResourceType>(type),
+                          PackCompression::None);
+  }
+  PackWriter fast;
+  for (usize type = 0; type <= static_cast<usize>(ResourceType::Data); ++type) {
+    fast.setCompression(static_cast<ResourceType>(type), PackCompression::Fast);
+  }
+  PackWriter byType;
+  const u64 storedSize = packSize(assets, stored);
+  const u64 fastSize = packSize(assets, fast);
+  const u64 byTypeSize = packSize(assets, byType);
+  std::printf("pack, stored                 %8.2f MB\n",
+              static_cast<f64>(storedSize) / 1e6);
+  std::printf("pack, Fast for everything    %8.2f MB\n",
+              static_cast<f64>(fastSize) / 1e6);
+  std::printf("pack, by resource type       %8.2f MB  (%zu of %zu compressed)\n\n",
+              static_cast<f64>(byTypeSize) / 1e6,
+              byType.getStats().compressedCount,
+              byType.getStats().resourceCount);
+
+  codecRow("script, Fast", assets, ResourceType::Script, BlockCodec::Level::Fast);
+  codecRow("script, High", assets, ResourceType::Script, BlockCodec::Level::High);
+  codecRow("localization, Fast", assets, ResourceType::Localization,
+           BlockCodec::Level::Fast);
+  codecRow("localization, High", assets, ResourceType::Localization,
+           BlockCodec::Level::High);
+  codecRow("ui data, Fast", assets, ResourceType::Data, BlockCodec::Level::Fast);
+  codecRow("texture, Fast", assets, ResourceType::Texture,
+           BlockCodec::Level::Fast);
+  return 0;
+}
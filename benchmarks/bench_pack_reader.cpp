@@ -0,0 +1,167 @@
+/**
+ * @file bench_pack_reader.cpp
+ * @brief Reading every sprite of a pack, as a scene transition does
+ *
+ * "ifstream per read" opens, seeks and reads the pack for each resource,
+ * which is what PackReader::readFile did before packs were mapped at mount
+ * time; the other rows go through the mounted PackReader, copying with
+ * readFile() or viewing in place with readView().
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/vfs/pack_reader.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace NovelMind;
+using namespace NovelMind::vfs;
+namespace fs = std::filesystem;
+
+namespace {
+
+template <typename T> void append(std::vector<u8> &out, const T &value) {
+  const usize offset = out.size();
+  out.resize(offset + sizeof(T));
+  std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+// A pack of @p count stored sprites of @p size bytes each
+std::vector<u8> buildPack(usize count, usize size) {
+  std::vector<u8> strings;
+  std::vector<u32> stringOffsets;
+  std::vector<PackResourceEntry> entries;
+  for (usize i = 0; i < count; ++i) {
+    const std::string id = "sprites/" + std::to_string(i) + ".png";
+    stringOffsets.push_back(static_cast<u32>(strings.size()));
+    strings.insert(strings.end(), id.begin(), id.end());
+    strings.push_back(0);
+
+    PackResourceEntry entry{};
+    entry.idStringOffset = static_cast<u32>(i);
+    entry.type = static_cast<u32>(ResourceType::Texture);
+    entry.dataOffset = i * size;
+    entry.compressedSize = size;
+    entry.uncompressedSize = size;
+    entries.push_back(entry);
+  }
+
+  PackHeader header{};
+  header.magic = PACK_MAGIC;
+  header.versionMajor = PACK_VERSION_MAJOR;
+  header.resourceCount = static_cast<u32>(count);
+  header.resourceTableOffset = sizeof(PackHeader);
+  header.stringTableOffset =
+      header.resourceTableOffset + count * sizeof(PackResourceEntry);
+  header.dataOffset = header.stringTableOffset + sizeof(u32) +
+                      count * sizeof(u32) + strings.size();
+  header.totalSize = header.dataOffset + count * size;
+
+  std::vector<u8> pack;
+  append(pack, header);
+  for (const auto &entry : entries) {
+    append(pack, entry);
+  }
+  append(pack, static_cast<u32>(count));
+  for (u32 offset : stringOffsets) {
+    append(pack, offset);
+  }
+  pack.insert(pack.end(), strings.begin(), strings.end());
+  const usize dataStart = pack.size();
+  pack.resize(dataStart + count * size);
+  for (usize i = dataStart; i < pack.size(); ++i) {
+    pack[i] = static_cast<u8>(i * 31);
+  }
+  return pack;
+}
+
+void run(usize count, usize size) {
+  const fs::path dir = fs::temp_directory_path() / "novelmind_bench_pack";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  const std::string path = (dir / "sprites.nmres").string();
+  {
+    const auto pack = buildPack(count, size);
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char *>(pack.data()),
+               static_cast<std::streamsize>(pack.size()));
+  }
+
+  PackReader reader;
+  if (reader.mount(path).isError()) {
+    std::printf("Failed to mount %s\n", path.c_str());
+    return;
+  }
+  std::vector<std::string> ids;
+  for (usize i = 0; i < count; ++i) {
+    ids.push_back("sprites/" + std::to_string(i) + ".png");
+  }
+  const u64 dataOffset = fs::file_size(path) - count * size;
+
+  const auto reads = static_cast<f64>(count);
+  std::printf("\n%zu resources of %zu KiB\n", count, size / 1024);
+
+  const f64 ifstream = bench::bestOf(5, [&] {
+    usize total = 0;
+    for (usize i = 0; i < count; ++i) {
+      std::ifstream file(path, std::ios::binary);
+      file.seekg(static_cast<std::streamoff>(dataOffset + i * size));
+      std::vector<u8> data(size);
+      file.read(reinterpret_cast<char *>(data.data()),
+                static_cast<std::streamsize>(size));
+      total += data[size / 2];
+    }
+    bench::doNotOptimize(total);
+  });
+  bench::report("ifstream per read", ifstream, reads, "reads");
+
+  const f64 copy = bench::bestOf(5, [&] {
+    usize total = 0;
+    for (const auto &id : ids) {
+      total += reader.readFile(id).value()[size / 2];
+    }
+    bench::doNotOptimize(total);
+  });
+  bench::report("readFile, mapped", copy, reads, "reads");
+
+  const f64 view = bench::bestOf(5, [&] {
+    usize total = 0;
+    for (const auto &id : ids) {
+      total += reader.readView(id).value().bytes[size / 2];
+    }
+    bench::doNotOptimize(total);
+  });
+  bench::report("readView", view, reads, "reads");
+
+  constexpr usize threads = 4;
+  const f64 shared = bench::bestOf(5, [&] {
+    std::vector<std::thread> workers;
+    for (usize t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        usize total = 0;
+        for (usize i = t; i < count; i += threads) {
+          total += reader.readView(ids[i]).value().bytes[size / 2];
+        }
+        bench::doNotOptimize(total);
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  });
+  bench::report("readView, 4 threads", shared, reads, "reads");
+
+  reader.unmountAll();
+  fs::remove_all(dir);
+}
+
+} // namespace
+
+int main() {
+  run(2000, 4 * 1024);
+  run(500, 64 * 1024);
+  return 0;
+}
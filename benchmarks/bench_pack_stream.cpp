@@ -0,0 +1,119 @@
+/**
+ * @file bench_pack_stream.cpp
+ * @brief Streaming and seeking a 10-minute music track out of a pack
+ *
+ * The track is 16-bit stereo PCM at 44.1 kHz, packed by PackWriter in
+ * 64 KiB chunks. "readFile" decodes the whole track, which is all a pack
+ * could do before chunked entries; the stream rows read it through
+ * PackReader::openStream() in 4 KiB pieces, the way a mixer pulls audio.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/vfs/pack_reader.hpp"
+#include "NovelMind/vfs/pack_writer.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::vfs;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr usize SAMPLE_RATE = 44100;
+constexpr usize FRAME_SIZE = 4; // Two 16-bit channels
+constexpr usize READ_SIZE = 4096;
+
+std::vector<u8> makeTrack(usize seconds) {
+  std::mt19937 rng(1);
+  std::vector<u8> data(seconds * SAMPLE_RATE * FRAME_SIZE);
+  for (usize frame = 0; frame < seconds * SAMPLE_RATE; ++frame) {
+    const f64 t = static_cast<f64>(frame) / SAMPLE_RATE;
+    const auto sample = static_cast<i16>(
+        std::sin(t * 2.0 * 3.14159265 * 220.0) * 8000.0 +
+        static_cast<f64>(rng() % 64));
+    for (usize channel = 0; channel < 2; ++channel) {
+      const usize offset = frame * FRAME_SIZE + channel * 2;
+      data[offset] = static_cast<u8>(sample & 0xFF);
+      data[offset + 1] = static_cast<u8>((sample >> 8) & 0xFF);
+    }
+  }
+  return data;
+}
+
+} // namespace
+
+int main() {
+  const fs::path dir = fs::temp_directory_path() / "novelmind_bench_stream";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  const std::string path = (dir / "music.nmres").string();
+
+  const usize trackSize = [&] {
+    auto track = makeTrack(600);
+    PackWriter writer;
+    writer.addResource("music/theme", track, ResourceType::Music);
+    (void)writer.write(path);
+    return track.size();
+  }();
+
+  PackReader reader;
+  if (reader.mount(path).isError()) {
+    std::printf("Failed to mount %s\n", path.c_str());
+    return 1;
+  }
+  std::printf("10-minute track: %.1f MB of PCM, %.1f MB in the pack\n\n",
+              static_cast<f64>(trackSize) / 1e6,
+              static_cast<f64>(reader.getEntry("music/theme")->compressedSize) /
+                  1e6);
+
+  const f64 whole = bench::bestOf(3, [&] {
+    bench::doNotOptimize(reader.readFile("music/theme").value().size());
+  });
+  bench::report("readFile, whole track", whole, static_cast<f64>(trackSize),
+                "B");
+  std::printf("%-44s %10.1f KiB\n", "  decoded memory held",
+              static_cast<f64>(trackSize) / 1024.0);
+
+  usize buffered = 0;
+  const f64 sequential = bench::bestOf(3, [&] {
+    auto stream = reader.openStream("music/theme");
+    std::vector<u8> buffer(READ_SIZE);
+    usize total = 0;
+    while (!stream->isEof()) {
+      total += stream->read(buffer.data(), buffer.size()).value();
+    }
+    buffered = static_cast<PackStream &>(*stream).bufferedSize();
+    bench::doNotOptimize(total);
+  });
+  bench::report("stream, sequential 4 KiB reads", sequential,
+                static_cast<f64>(trackSize), "B");
+  std::printf("%-44s %10.1f KiB\n", "  decoded memory held",
+              static_cast<f64>(buffered + READ_SIZE) / 1024.0);
+
+  constexpr usize seeks = 2000;
+  std::mt19937 rng(3);
+  std::vector<usize> positions(seeks);
+  for (auto &position : positions) {
+    position = rng() % (trackSize - READ_SIZE);
+  }
+  auto stream = reader.openStream("music/theme");
+  const f64 random = bench::bestOf(3, [&] {
+    std::vector<u8> buffer(READ_SIZE);
+    for (usize position : positions) {
+      (void)stream->seek(static_cast<i64>(position), VFS::SeekOrigin::Begin);
+      bench::doNotOptimize(stream->read(buffer.data(), buffer.size()).value());
+    }
+  });
+  bench::report("stream, seek + 4 KiB read", random, static_cast<f64>(seeks),
+                "seeks");
+  std::printf("%-44s %10.1f us\n", "  per seek",
+              random * 1e6 / static_cast<f64>(seeks));
+
+  reader.unmountAll();
+  fs::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file bench_resource_cache.cpp
+ * @brief ResourceCache hit cost, lock contention and eviction policies
+ *
+ * - A 3840x2160 RGBA image is about 33 MB. The "copy" row copies it out of
+ *   the cache on every hit, as ResourceCache did when it handed out
+ *   vectors; the "shared" row is readAll() returning the cached ByteBuffer.
+ * - Four threads hit a warm cache of small resources, with one shard (one
+ *   lock, as before sharding) and with the default 16.
+ * - A skewed trace over 2000 resources of 4 KiB to 2 MiB, about 13 times
+ *   the cache size in all, is replayed against each eviction policy.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/vfs/virtual_file_system.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace NovelMind;
+using namespace NovelMind::VFS;
+
+namespace {
+
+void contentionRow(const char *name, usize shardCount) {
+  constexpr usize keys = 1024;
+  constexpr usize threads = 4;
+  constexpr usize getsPerThread = 500000;
+
+  ResourceCacheConfig config;
+  config.shardCount = shardCount;
+  ResourceCache cache(config);
+  std::vector<ResourceId> ids;
+  for (usize i = 0; i < keys; ++i) {
+    ids.emplace_back("ui/icon" + std::to_string(i), ResourceType::Texture);
+    cache.put(ids.back(), core::ByteBuffer(std::vector<u8>(256)));
+  }
+
+  const f64 seconds = bench::bestOf(3, [&] {
+    std::vector<std::thread> workers;
+    for (usize t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        usize found = 0;
+        for (usize i = 0; i < getsPerThread; ++i) {
+          found += cache.get(ids[(i * 31 + t * 7) % keys]).has_value() ? usize{1} : usize{0};
+        }
+        bench::doNotOptimize(found);
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  });
+  bench::report(name, seconds, static_cast<f64>(threads * getsPerThread),
+                "gets");
+}
+
+struct Request {
+  ResourceId id;
+  usize size;
+};
+
+// Zipf-like popularity over resources from 4 KiB icons to 2 MiB backgrounds
+std::vector<Request> makeTrace(usize resources, usize requests) {
+  std::mt19937 rng(11);
+  std::vector<usize> sizes(resources);
+  std::vector<f64> weights(resources);
+  for (usize i = 0; i < resources; ++i) {
+    sizes[i] = usize{4096} << (rng() % 10);
+    weights[i] = 1.0 / std::pow(static_cast<f64>(i + 1), 0.9);
+  }
+  std::discrete_distribution<usize> pick(weights.begin(), weights.end());
+
+  std::vector<Request> trace;
+  trace.reserve(requests);
+  for (usize i = 0; i < requests; ++i) {
+    const usize index = pick(rng);
+    trace.push_back({ResourceId("res" + std::to_string(index),
+                                ResourceType::Texture),
+                     sizes[index]});
+  }
+  return trace;
+}
+
+void policyRow(const char *name, EvictionPolicy policy,
+               const std::vector<Request> &trace) {
+  ResourceCacheConfig config;
+  config.maxSize = 64 * 1024 * 1024;
+  config.policy = policy;
+  ResourceCache cache(config);
+  std::vector<u8> pool(2 * 1024 * 1024);
+  auto owner = std::make_shared<std::vector<u8>>(std::move(pool));
+
+  usize bytesMissed = 0;
+  const f64 seconds = bench::measureSeconds([&] {
+    for (const Request &request : trace) {
+      if (!cache.get(request.id)) {
+        bytesMissed += request.size;
+        cache.put(request.id, core::ByteBuffer(owner, std::span<const u8>(
+                                                          owner->data(),
+                                                          request.size)));
+      }
+    }
+  });
+  std::printf("%-28s hit rate %5.1f%%  missed %8.1f MB  %8.1f ms\n", name,
+              cache.stats().hitRate() * 100.0,
+              static_cast<f64>(bytesMissed) / 1e6, seconds * 1000.0);
+}
+
+} // namespace
+
+int main() {
+  constexpr usize imageSize = 3840 * 2160 * 4;
+  constexpr usize hits = 200;
+
+  std::vector<u8> image(imageSize);
+  for (usize i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<u8>(i * 31);
+  }
+
+  auto backend = std::make_unique<MemoryBackend>();
+  backend->addResource("bg/city.png", std::move(image), ResourceType::Texture);
+  VirtualFileSystem vfs;
+  vfs.registerBackend(std::move(backend));
+  (void)vfs.initialize();
+  (void)vfs.readAll("bg/city.png");
+
+  std::printf("%zu hits on a %.1f MB resource\n\n", hits,
+              static_cast<f64>(imageSize) / 1e6);
+
+  const f64 copied = bench::bestOf(3, [&] {
+    for (usize i = 0; i < hits; ++i) {
+      auto bytes = vfs.readAll("bg/city.png").value().toVector();
+      bench::doNotOptimize(bytes[i]);
+    }
+  });
+  bench::report("readAll hit, copy", copied, static_cast<f64>(hits), "hits");
+
+  const f64 shared = bench::bestOf(3, [&] {
+    for (usize i = 0; i < hits; ++i) {
+      auto bytes = vfs.readAll("bg/city.png").value();
+      bench::doNotOptimize(bytes[i]);
+    }
+  });
+  bench::report("readAll hit, shared", shared, static_cast<f64>(hits), "hits");
+
+  std::printf("%-44s %10.1f us\n\n", "  per shared hit",
+              shared * 1e6 / static_cast<f64>(hits));
+
+  contentionRow("4 threads, 1 shard", 1);
+  contentionRow("4 threads, 16 shards", 16);
+  std::printf("\n");
+
+  const auto trace = makeTrace(2000, 200000);
+  policyRow("LRU", EvictionPolicy::LRU, trace);
+  policyRow("CLOCK", EvictionPolicy::Clock, trace);
+  policyRow("GDSF", EvictionPolicy::GDSF, trace);
+  return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file bench_vm_dispatch.cpp
+ * @brief A/B of the switch-per-step loop against the threaded loop
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/vm.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+constexpr u32 kLoop = 2'000'000;
+constexpr f64 kInstructionsPerIteration = 13.0;
+
+// sum = 0; for (i = 0; i < n; ++i) { sum = sum + i; }
+std::vector<Instruction> makeLoopProgram(u32 n) {
+  return {
+      {OpCode::PUSH_INT, 0},    {OpCode::STORE_SLOT, 0}, // 0-1: sum = 0
+      {OpCode::PUSH_INT, 0},    {OpCode::STORE_SLOT, 1}, // 2-3: i = 0
+      {OpCode::LOAD_SLOT, 1},   {OpCode::PUSH_INT, n},   // 4-5
+      {OpCode::LT, 0},          {OpCode::JUMP_IF_NOT, 18}, // 6-7
+      {OpCode::LOAD_SLOT, 0},   {OpCode::LOAD_SLOT, 1},  // 8-9
+      {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 0}, // 10-11
+      {OpCode::LOAD_SLOT, 1},   {OpCode::PUSH_INT, 1},   // 12-13
+      {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 1}, // 14-15
+      {OpCode::JUMP, 4},        {OpCode::NOP, 0},        // 16-17
+      {OpCode::HALT, 0}};                                // 18
+}
+
+f64 runLoop(DispatchMode mode, const std::vector<Instruction> &program) {
+  return bench::bestOf(5, [&] {
+    VirtualMachine vm;
+    vm.setDispatchMode(mode);
+    vm.load(program, {}, {"sum", "i"});
+    vm.run();
+    bench::doNotOptimize(vm.getIP());
+  });
+}
+
+} // namespace
+
+int main() {
+  auto program = makeLoopProgram(kLoop);
+  const f64 instructions = static_cast<f64>(kLoop) * kInstructionsPerIteration;
+
+  f64 switchTime = runLoop(DispatchMode::Switch, program);
+  bench::report("DispatchMode::Switch", switchTime, instructions, "instr");
+
+  f64 threadedTime = runLoop(DispatchMode::Threaded, program);
+  bench::report("DispatchMode::Threaded", threadedTime, instructions, "instr");
+
+  std::printf("%-44s %10.2fx\n", "speedup", switchTime / threadedTime);
+  return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file bench_vm_value.cpp
+ * @brief Stack throughput of the variant Value vs. the tagged VMValue
+ *
+ * "before" pushes/pops std::variant Value the way the VM used to (string
+ * operands are copied out of the string table on every push); "after" uses
+ * VMValue with interned string handles. A full VM loop is timed as well.
+ */
+
+#include "bench_common.hpp"
+#include "NovelMind/scripting/vm.hpp"
+#include "NovelMind/scripting/vm_value.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+constexpr usize kIterations = 2'000'000;
+constexpr usize kDepth = 16;
+
+// Longer than the small-string buffer so the variant copy really allocates
+const std::vector<std::string> kStrings = {
+    "The Elder Sage looks at you thoughtfully",
+    "You feel the morning wind through the trees", "alex", "sage"};
+
+f64 benchVariantStack() {
+  std::vector<Value> stack;
+  stack.reserve(kDepth * 2);
+  return bench::bestOf(3, [&] {
+    for (usize i = 0; i < kIterations; ++i) {
+      for (usize d = 0; d < kDepth; ++d) {
+        if (d % 2 == 0) {
+          stack.emplace_back(std::in_place_type<i32>, static_cast<i32>(d));
+        } else {
+          stack.emplace_back(std::in_place_type<std::string>,
+                             kStrings[d % kStrings.size()]);
+        }
+      }
+      Value top = stack.back(); // DUP
+      stack.push_back(top);
+      for (usize d = 0; d <= kDepth; ++d) {
+        Value v = stack.back();
+        stack.pop_back();
+        bench::doNotOptimize(v);
+      }
+    }
+  });
+}
+
+f64 benchTaggedStack() {
+  StringPool pool;
+  std::vector<u32> handles;
+  for (const auto &s : kStrings) {
+    handles.push_back(pool.intern(s));
+  }
+
+  std::vector<VMValue> stack;
+  stack.reserve(kDepth * 2);
+  return bench::bestOf(3, [&] {
+    for (usize i = 0; i < kIterations; ++i) {
+      for (usize d = 0; d < kDepth; ++d) {
+        if (d % 2 == 0) {
+          stack.push_back(VMValue::fromInt(static_cast<i32>(d)));
+        } else {
+          stack.push_back(VMValue::fromString(handles[d % handles.size()]));
+        }
+      }
+      stack.push_back(stack.back()); // DUP
+      for (usize d = 0; d <= kDepth; ++d) {
+        VMValue v = stack.back();
+        stack.pop_back();
+        bench::doNotOptimize(v);
+      }
+    }
+  });
+}
+
+// for (i = 0; i < n; ++i) { line == line; speaker == "alex"; }
+std::vector<Instruction> makeLoopProgram(u32 n) {
+  return {
+      {OpCode::PUSH_INT, 0},    {OpCode::STORE_SLOT, 0}, // 0-1: i = 0
+      {OpCode::LOAD_SLOT, 0},   {OpCode::PUSH_INT, n},   // 2-3
+      {OpCode::LT, 0},          {OpCode::JUMP_IF_NOT, 20}, // 4-5
+      {OpCode::PUSH_STRING, 0}, {OpCode::PUSH_STRING, 0}, // 6-7
+      {OpCode::EQ, 0},          {OpCode::POP, 0},         // 8-9
+      {OpCode::PUSH_STRING, 2}, {OpCode::PUSH_STRING, 3}, // 10-11
+      {OpCode::NE, 0},          {OpCode::POP, 0},         // 12-13
+      {OpCode::LOAD_SLOT, 0},   {OpCode::PUSH_INT, 1},    // 14-15
+      {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 0},  // 16-17
+      {OpCode::JUMP, 2},        {OpCode::NOP, 0},         // 18-19
+      {OpCode::HALT, 0}};                                 // 20
+}
+
+} // namespace
+
+int main() {
+  std::printf("sizeof(Value)   = %zu bytes\n", sizeof(Value));
+  std::printf("sizeof(VMValue) = %zu bytes\n\n", sizeof(VMValue));
+
+  const f64 ops = static_cast<f64>(kIterations * (kDepth + 1) * 2);
+
+  f64 before = benchVariantStack();
+  bench::report("push/pop std::variant Value (before)", before, ops, "op");
+
+  f64 after = benchTaggedStack();
+  bench::report("push/pop tagged VMValue (after)", after, ops, "op");
+
+  std::printf("%-44s %10.2fx\n\n", "speedup", before / after);
+
+  constexpr u32 kLoop = 1'000'000;
+  auto program = makeLoopProgram(kLoop);
+  f64 vmTime = bench::bestOf(3, [&] {
+    VirtualMachine vm;
+    vm.load(program, kStrings, {"i"});
+    vm.run();
+  });
+  bench::report("VM string compare loop", vmTime,
+                static_cast<f64>(kLoop) * 18.0, "instr");
+
+  return 0;
+}
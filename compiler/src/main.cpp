@@ -7,27 +7,41 @@
  * - Lexical analysis (tokenization)
  * - Parsing (AST generation)
  * - Semantic validation
- * - Bytecode compilation
+ * - Bytecode compilation and optimization
  * - Output in various formats (binary, JSON)
  *
  * Usage:
- *   nmc <input.nms> [-o output] [--ast] [--tokens] [--validate-only] [--verbose]
+ *   nmc <input.nms> [-o output] [-O0|-O1|-O2] [--register] [--explore] [--ast] [--tokens] [--validate-only] [--verbose]
+ *   nmc <directory|manifest> [-j threads] [options]
+ *
+ * Given a directory or a manifest instead of a single .nms file, nmc
+ * builds every script of the project in parallel and links them into one
+ * module (see ProjectCompiler).
  */
 
 #include "NovelMind/scripting/lexer.hpp"
 #include "NovelMind/scripting/parser.hpp"
 #include "NovelMind/scripting/validator.hpp"
 #include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/bytecode_optimizer.hpp"
+#include "NovelMind/scripting/register_compiler.hpp"
+#include "NovelMind/scripting/route_explorer.hpp"
+#include "NovelMind/scripting/project_compiler.hpp"
+#include "NovelMind/scripting/script_image.hpp"
 #include "NovelMind/scripting/script_error.hpp"
+#include "NovelMind/scripting/source_file.hpp"
 #include "NovelMind/core/logger.hpp"
+#include "NovelMind/core/timer.hpp"
 
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <cstring>
+#include <algorithm>
 #include <filesystem>
+#include <iomanip>
+#include <thread>
 
 // Platform-specific includes for isatty/fileno
 #ifdef _WIN32
@@ -61,6 +75,13 @@ struct CompilerOptions {
     bool validateOnly = false;
     bool verbose = false;
     bool noColor = false;
+    NovelMind::scripting::OptimizationLevel optLevel =
+        NovelMind::scripting::OptimizationLevel::Basic;
+    bool registerFormat = false;
+    bool explore = false;
+    NovelMind::usize jobs = 0; // Project mode threads; 0 = hardware concurrency
+    std::string cacheDir;      // Project mode; default: <output>.cache
+    bool noCache = false;
     bool help = false;
     bool version = false;
 };
@@ -74,14 +95,25 @@ void printVersion() {
 }
 
 void printUsage(const char* programName) {
-    std::cout << "Usage: " << programName << " <input.nms> [options]\n\n";
-    std::cout << "NovelMind Script Compiler - Compiles NM Script files to bytecode.\n\n";
+    std::cout << "Usage: " << programName << " <input.nms> [options]\n";
+    std::cout << "       " << programName << " <directory|manifest> [options]\n\n";
+    std::cout << "NovelMind Script Compiler - Compiles NM Script files to bytecode.\n";
+    std::cout << "A directory (every .nms below it) or a manifest (one script path per\n";
+    std::cout << "line) is compiled in parallel and linked into a single module.\n\n";
     std::cout << "Options:\n";
     std::cout << "  -o, --output <file>   Output file (default: <input>.nmc)\n";
     std::cout << "  --tokens              Show lexer tokens\n";
     std::cout << "  --ast                 Show parsed AST\n";
     std::cout << "  --ir                  Show intermediate representation\n";
     std::cout << "  --validate-only       Only validate, don't compile\n";
+    std::cout << "  -O0, -O1, -O2         Bytecode optimization level (default: -O1;\n";
+    std::cout << "                        -O2 adds superinstructions)\n";
+    std::cout << "  --register            Emit register bytecode (NMSC v2)\n";
+    std::cout << "  --explore             Run every route headlessly and report coverage\n";
+    std::cout << "  -j, --jobs <n>        Threads for project builds (default: all cores)\n";
+    std::cout << "  --cache-dir <dir>     Incremental cache of project builds\n";
+    std::cout << "                        (default: <output>.cache)\n";
+    std::cout << "  --no-cache            Rebuild every file of a project\n";
     std::cout << "  -v, --verbose         Verbose output\n";
     std::cout << "  --no-color            Disable colored output\n";
     std::cout << "  -h, --help            Show this help message\n";
@@ -91,6 +123,7 @@ void printUsage(const char* programName) {
     std::cout << "  " << programName << " main.nms -o game.nmc      # Compile to game.nmc\n";
     std::cout << "  " << programName << " main.nms --validate-only  # Only check for errors\n";
     std::cout << "  " << programName << " main.nms --ast --tokens   # Show debug output\n";
+    std::cout << "  " << programName << " scripts/ -o game.nmc      # Link a whole project\n";
 }
 
 CompilerOptions parseArgs(int argc, char* argv[]) {
@@ -121,6 +154,30 @@ CompilerOptions parseArgs(int argc, char* argv[]) {
             opts.verbose = true;
         } else if (arg == "--no-color") {
             opts.noColor = true;
+        } else if (arg == "-O0") {
+            opts.optLevel = NovelMind::scripting::OptimizationLevel::None;
+        } else if (arg == "-O1") {
+            opts.optLevel = NovelMind::scripting::OptimizationLevel::Basic;
+        } else if (arg == "-O2") {
+            opts.optLevel = NovelMind::scripting::OptimizationLevel::Full;
+        } else if (arg == "--register") {
+            opts.registerFormat = true;
+        } else if (arg == "--explore") {
+            opts.explore = true;
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (i + 1 < argc) {
+                opts.jobs = static_cast<NovelMind::usize>(std::strtoul(argv[++i], nullptr, 10));
+            } else {
+                std::cerr << "Error: -j requires an argument\n";
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                opts.cacheDir = argv[++i];
+            } else {
+                std::cerr << "Error: --cache-dir requires an argument\n";
+            }
+        } else if (arg == "--no-cache") {
+            opts.noCache = true;
         } else if (arg[0] != '-') {
             opts.inputFile = arg;
         } else {
@@ -130,22 +187,17 @@ CompilerOptions parseArgs(int argc, char* argv[]) {
 
     // Default output file
     if (opts.outputFile.empty() && !opts.inputFile.empty()) {
-        fs::path inputPath(opts.inputFile);
+        fs::path inputPath = fs::path(opts.inputFile).lexically_normal();
+        if (!inputPath.has_filename()) {
+            inputPath = inputPath.parent_path(); // "scripts/" -> "scripts"
+        }
         opts.outputFile = inputPath.stem().string() + ".nmc";
     }
-
-    return opts;
-}
-
-std::string readFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + path);
+    if (opts.cacheDir.empty() && !opts.outputFile.empty()) {
+        opts.cacheDir = opts.outputFile + ".cache";
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return opts;
 }
 
 void printTokens(const std::vector<NovelMind::scripting::Token>& tokens, bool useColor) {
@@ -165,6 +217,43 @@ void printTokens(const std::vector<NovelMind::scripting::Token>& tokens, bool us
     std::cout << "\n";
 }
 
+void printRouteCoverage(const NovelMind::scripting::RouteCoverage& coverage, bool useColor) {
+    const char* bold = useColor ? Color::Bold : "";
+    const char* cyan = useColor ? Color::Cyan : "";
+    const char* yellow = useColor ? Color::Yellow : "";
+    const char* reset = useColor ? Color::Reset : "";
+
+    std::cout << "\n=== ROUTE COVERAGE ===\n";
+    std::cout << bold << "Instructions: " << reset
+              << coverage.getReachedInstructionCount() << " / "
+              << coverage.reachedInstructions.size() << " reached\n";
+    std::cout << bold << "Scenes: " << reset << coverage.reachedScenes.size()
+              << " reached, " << coverage.unreachedScenes.size() << " unreached\n";
+    for (const auto& scene : coverage.unreachedScenes) {
+        std::cout << "  " << yellow << "unreached: " << reset << cyan << scene << reset << "\n";
+    }
+
+    auto dead = coverage.getDeadChoices();
+    std::cout << bold << "Choices: " << reset << coverage.choices.size() << " total, "
+              << dead.size() << " dead\n";
+    for (const auto* choice : dead) {
+        std::cout << "  " << yellow << "dead: " << reset << cyan << choice->scene << reset
+                  << " @" << choice->instruction;
+        for (const auto& option : choice->options) {
+            std::cout << " \"" << option << "\"";
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << bold << "States: " << reset << coverage.uniqueStates << " unique, "
+              << coverage.duplicateStates << " duplicate, " << coverage.endings
+              << " endings, " << coverage.truncatedRoutes << " truncated"
+              << (coverage.complete ? "" : " (state limit reached)") << "\n";
+    std::cout << bold << "Throughput: " << reset
+              << static_cast<NovelMind::u64>(coverage.statesPerSecond) << " states/sec ("
+              << coverage.seconds << " s)\n\n";
+}
+
 void printAst(const NovelMind::scripting::Program& program, bool useColor) {
     const char* bold = useColor ? Color::Bold : "";
     const char* cyan = useColor ? Color::Cyan : "";
@@ -197,6 +286,8 @@ void printIr(const NovelMind::scripting::CompiledScript& script, bool useColor)
 
     std::cout << bold << "Instructions: " << reset << script.instructions.size() << "\n";
     std::cout << bold << "String table: " << reset << script.stringTable.size() << " entries\n";
+    std::cout << bold << "Variable slots: " << reset << script.variableSlots.size() << "\n";
+    std::cout << bold << "Line table: " << reset << script.lineTable.size() << " entries\n";
     std::cout << bold << "Scene entry points:\n" << reset;
 
     for (const auto& [name, index] : script.sceneEntryPoints) {
@@ -211,7 +302,8 @@ void printIr(const NovelMind::scripting::CompiledScript& script, bool useColor)
     std::cout << "\n";
 }
 
-void printErrors(const NovelMind::scripting::ErrorList& errors, bool useColor) {
+void printErrors(const NovelMind::scripting::ErrorList& errors, bool useColor,
+                 const std::string& path = {}) {
     const char* red = useColor ? Color::Red : "";
     const char* yellow = useColor ? Color::Yellow : "";
     const char* cyan = useColor ? Color::Cyan : "";
@@ -239,9 +331,17 @@ void printErrors(const NovelMind::scripting::ErrorList& errors, bool useColor) {
         }
 
         std::cerr << color << prefix << reset << ": "
-                  << err.message
-                  << " [line " << err.span.start.line
+                  << err.message << " ["
+                  << (path.empty() ? "" : path + ", ")
+                  << "line " << err.span.start.line
                   << ", col " << err.span.start.column << "]\n";
+        if (err.source) {
+            std::cerr << "    " << *err.source << "\n";
+            if (err.span.start.column > 0) {
+                std::cerr << "    " << std::string(err.span.start.column - 1, ' ')
+                          << color << "^" << reset << "\n";
+            }
+        }
     }
 }
 
@@ -252,68 +352,217 @@ bool writeCompiledScript(const NovelMind::scripting::CompiledScript& script,
         return false;
     }
 
-    // Write magic number
-    const char magic[] = "NMC1";
-    file.write(magic, 4);
+    // Memory-mappable NMSC v3 image; the runtime pages scenes in lazily
+    auto image = NovelMind::scripting::serializeScriptImage(script);
+    file.write(reinterpret_cast<const char*>(image.data()),
+               static_cast<std::streamsize>(image.size()));
+    return file.good();
+}
+
+bool writeRegisterProgram(const NovelMind::scripting::RegisterProgram& program,
+                          const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    auto image = NovelMind::scripting::serializeRegisterProgram(program);
+    file.write(reinterpret_cast<const char*>(image.data()),
+               static_cast<std::streamsize>(image.size()));
+    return file.good();
+}
 
-    // Write version
-    NovelMind::u32 version = (NOVELMIND_VERSION_MAJOR << 16) |
-                             (NOVELMIND_VERSION_MINOR << 8) |
-                              NOVELMIND_VERSION_PATCH;
-    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+int emitRegisterProgram(const NovelMind::scripting::Program& program,
+                        const CompilerOptions& opts, bool useColor) {
+    const char* green = useColor ? Color::Green : "";
+    const char* red = useColor ? Color::Red : "";
+    const char* bold = useColor ? Color::Bold : "";
+    const char* reset = useColor ? Color::Reset : "";
 
-    // Write instruction count and instructions
-    NovelMind::u32 instrCount = static_cast<NovelMind::u32>(script.instructions.size());
-    file.write(reinterpret_cast<const char*>(&instrCount), sizeof(instrCount));
+    NovelMind::scripting::RegisterCompiler registerCompiler;
+    auto registerResult = registerCompiler.compile(program);
+
+    if (!registerResult.isOk()) {
+        std::cerr << red << "Compile error: " << reset
+                  << registerResult.error() << "\n";
+        return 1;
+    }
 
-    for (const auto& instr : script.instructions) {
-        file.write(reinterpret_cast<const char*>(&instr.opcode), sizeof(instr.opcode));
-        file.write(reinterpret_cast<const char*>(&instr.operand), sizeof(instr.operand));
+    const auto& registerProgram = registerResult.value();
+    if (!writeRegisterProgram(registerProgram, opts.outputFile)) {
+        std::cerr << red << "Error: " << reset
+                  << "Failed to write output file: " << opts.outputFile << "\n";
+        return 1;
     }
 
-    // Write string table
-    NovelMind::u32 strCount = static_cast<NovelMind::u32>(script.stringTable.size());
-    file.write(reinterpret_cast<const char*>(&strCount), sizeof(strCount));
+    std::cout << green << bold << "Success!" << reset << " Compiled "
+              << opts.inputFile << " -> " << opts.outputFile
+              << " (register bytecode)\n";
 
-    for (const auto& str : script.stringTable) {
-        NovelMind::u32 len = static_cast<NovelMind::u32>(str.length());
-        file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-        file.write(str.data(), static_cast<std::streamsize>(len));
+    if (opts.verbose) {
+        std::cout << "  " << registerProgram.code.size() << " code words\n";
+        std::cout << "  " << registerProgram.constants.size() << " constants\n";
+        std::cout << "  " << registerProgram.variableSlots.size() << " variable slots\n";
+        std::cout << "  " << registerProgram.sceneEntryPoints.size() << " scenes\n";
     }
 
-    // Write scene entry points
-    NovelMind::u32 sceneCount = static_cast<NovelMind::u32>(script.sceneEntryPoints.size());
-    file.write(reinterpret_cast<const char*>(&sceneCount), sizeof(sceneCount));
+    return 0;
+}
 
-    for (const auto& [name, index] : script.sceneEntryPoints) {
-        NovelMind::u32 nameLen = static_cast<NovelMind::u32>(name.length());
-        file.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
-        file.write(name.data(), static_cast<std::streamsize>(nameLen));
-        file.write(reinterpret_cast<const char*>(&index), sizeof(index));
+int emitStackScript(NovelMind::scripting::CompiledScript& compiledScript,
+                    const CompilerOptions& opts, bool useColor) {
+    const char* green = useColor ? Color::Green : "";
+    const char* red = useColor ? Color::Red : "";
+    const char* bold = useColor ? Color::Bold : "";
+    const char* reset = useColor ? Color::Reset : "";
+
+    NovelMind::scripting::BytecodeOptimizer optimizer(opts.optLevel);
+    auto optStats = optimizer.optimize(compiledScript);
+
+    if (opts.optLevel != NovelMind::scripting::OptimizationLevel::None) {
+        std::cout << "Optimized (-O" << static_cast<int>(opts.optLevel) << "): "
+                  << optStats.instructionsBefore << " -> "
+                  << optStats.instructionsAfter << " instructions ("
+                  << optStats.instructionsRemoved() << " removed)\n";
     }
 
-    // Write characters
-    NovelMind::u32 charCount = static_cast<NovelMind::u32>(script.characters.size());
-    file.write(reinterpret_cast<const char*>(&charCount), sizeof(charCount));
+    if (opts.verbose) {
+        std::cout << "  " << optStats.constantsFolded << " constants folded, "
+                  << optStats.jumpsThreaded << " jumps threaded, "
+                  << optStats.deadInstructions << " dead instructions, "
+                  << optStats.peepholes << " peepholes, "
+                  << optStats.superinstructions << " superinstructions\n";
+    }
 
-    for (const auto& [id, ch] : script.characters) {
-        // ID
-        NovelMind::u32 idLen = static_cast<NovelMind::u32>(id.length());
-        file.write(reinterpret_cast<const char*>(&idLen), sizeof(idLen));
-        file.write(id.data(), static_cast<std::streamsize>(idLen));
+    if (opts.showIr) {
+        printIr(compiledScript, useColor);
+    }
 
-        // Display name
-        NovelMind::u32 nameLen = static_cast<NovelMind::u32>(ch.displayName.length());
-        file.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
-        file.write(ch.displayName.data(), static_cast<std::streamsize>(nameLen));
+    if (opts.explore) {
+        auto coverage = NovelMind::scripting::RouteExplorer().explore(compiledScript);
+        if (!coverage.isOk()) {
+            std::cerr << red << "Route exploration failed: " << reset
+                      << coverage.error() << "\n";
+            return 1;
+        }
+        printRouteCoverage(coverage.value(), useColor);
+    }
 
-        // Color
-        NovelMind::u32 colorLen = static_cast<NovelMind::u32>(ch.color.length());
-        file.write(reinterpret_cast<const char*>(&colorLen), sizeof(colorLen));
-        file.write(ch.color.data(), static_cast<std::streamsize>(colorLen));
+    // Write output
+    if (opts.verbose) {
+        std::cout << "Writing " << opts.outputFile << "...\n";
     }
 
-    return file.good();
+    if (!writeCompiledScript(compiledScript, opts.outputFile)) {
+        std::cerr << red << "Error: " << reset
+                  << "Failed to write output file: " << opts.outputFile << "\n";
+        return 1;
+    }
+
+    std::cout << green << bold << "Success!" << reset << " Compiled "
+              << opts.inputFile << " -> " << opts.outputFile << "\n";
+
+    if (opts.verbose) {
+        std::cout << "  " << compiledScript.instructions.size() << " instructions\n";
+        std::cout << "  " << compiledScript.stringTable.size() << " strings\n";
+        std::cout << "  " << compiledScript.variableSlots.size() << " variable slots\n";
+        std::cout << "  " << compiledScript.sceneEntryPoints.size() << " scenes\n";
+        std::cout << "  " << compiledScript.characters.size() << " characters\n";
+    }
+
+    return 0;
+}
+
+bool isProjectInput(const std::string& path) {
+    std::error_code ec;
+    return fs::is_directory(path, ec) || fs::path(path).extension() != ".nms";
+}
+
+void printPhaseTimes(const NovelMind::scripting::ProjectPhaseTimes& times,
+                     NovelMind::usize fileCount, NovelMind::usize threads) {
+    auto ms = [](NovelMind::f64 seconds) { return seconds * 1000.0; };
+    std::cout << std::fixed << std::setprecision(1)
+              << "Phases (" << fileCount << " files, -j" << threads << "): "
+              << "parse " << ms(times.parse) << " ms, "
+              << "link " << ms(times.link) << " ms, "
+              << "validate " << ms(times.validate) << " ms, "
+              << "compile " << ms(times.compile) << " ms, "
+              << "total " << ms(times.total()) << " ms\n"
+              << std::defaultfloat;
+}
+
+int compileProject(const CompilerOptions& opts, bool useColor) {
+    const char* green = useColor ? Color::Green : "";
+    const char* red = useColor ? Color::Red : "";
+    const char* reset = useColor ? Color::Reset : "";
+
+    auto sources = NovelMind::scripting::ProjectCompiler::collectSources(opts.inputFile);
+    if (!sources.isOk()) {
+        std::cerr << red << "Error: " << reset << sources.error() << "\n";
+        return 1;
+    }
+
+    if (opts.verbose) {
+        std::cout << "Building " << sources.value().size() << " files from "
+                  << opts.inputFile << "...\n";
+    }
+
+    NovelMind::scripting::ProjectCompilerConfig config;
+    config.threadCount = opts.jobs;
+    config.compile = !opts.validateOnly && !opts.registerFormat;
+    // --register and --ast work on the linked AST, which cached files skip
+    if (!opts.noCache && !opts.registerFormat && !opts.showAst) {
+        config.cacheDirectory = opts.cacheDir;
+    }
+    NovelMind::scripting::ProjectCompiler projectCompiler(config);
+    auto build = projectCompiler.build(sources.value());
+
+    // Files are reported in build order whatever the thread count
+    for (const auto& file : build.files) {
+        printErrors(file.diagnostics, useColor, file.path);
+    }
+    printErrors(build.projectErrors, useColor);
+
+    const NovelMind::usize threads =
+        opts.jobs > 0 ? opts.jobs : std::max(1u, std::thread::hardware_concurrency());
+
+    if (opts.verbose && !config.cacheDirectory.empty()) {
+        std::cout << "Cache " << config.cacheDirectory << ": "
+                  << build.cache.hits << " hits, " << build.cache.misses
+                  << " misses (" << build.cache.invalidated
+                  << " invalidated by removed symbols)\n";
+    }
+
+    if (build.getErrorCount() > 0) {
+        printPhaseTimes(build.times, build.files.size(), threads);
+        std::cerr << red << "Build failed" << reset << ": " << build.getErrorCount()
+                  << " errors, " << build.getWarningCount() << " warnings\n";
+        return 1;
+    }
+
+    if (opts.showAst) {
+        printAst(build.linked, useColor);
+    }
+
+    if (opts.validateOnly) {
+        printPhaseTimes(build.times, build.files.size(), threads);
+        std::cout << green << "Validation passed" << reset << " - "
+                  << build.files.size() << " files, "
+                  << build.symbols.scenes.size() << " scenes, "
+                  << build.symbols.characters.size() << " characters\n";
+        return 0;
+    }
+
+    if (opts.registerFormat) {
+        NovelMind::core::Timer timer;
+        int status = emitRegisterProgram(build.linked, opts, useColor);
+        build.times.compile = timer.getElapsedSeconds();
+        printPhaseTimes(build.times, build.files.size(), threads);
+        return status;
+    }
+
+    printPhaseTimes(build.times, build.files.size(), threads);
+    return emitStackScript(build.script, opts, useColor);
 }
 
 int main(int argc, char* argv[]) {
@@ -342,13 +591,27 @@ int main(int argc, char* argv[]) {
     const char* bold = useColor ? Color::Bold : "";
     const char* reset = useColor ? Color::Reset : "";
 
+    if (isProjectInput(opts.inputFile)) {
+        try {
+            return compileProject(opts, useColor);
+        } catch (const std::exception& e) {
+            std::cerr << red << "Error: " << reset << e.what() << "\n";
+            return 1;
+        }
+    }
+
     try {
         // Read source file
         if (opts.verbose) {
             std::cout << "Reading " << opts.inputFile << "...\n";
         }
 
-        std::string source = readFile(opts.inputFile);
+        // Tokens view into this buffer, so it stays loaded until we exit
+        auto sourceResult = NovelMind::scripting::SourceFile::load(opts.inputFile);
+        if (!sourceResult.isOk()) {
+            throw std::runtime_error(sourceResult.error());
+        }
+        NovelMind::scripting::SourceFilePtr source = sourceResult.value();
 
         // Lexical analysis
         if (opts.verbose) {
@@ -356,7 +619,7 @@ int main(int argc, char* argv[]) {
         }
 
         NovelMind::scripting::Lexer lexer;
-        auto tokenResult = lexer.tokenize(source);
+        auto tokenResult = lexer.tokenize(source->getText());
 
         if (!tokenResult.isOk()) {
             std::cerr << red << "Lexer error: " << reset
@@ -430,6 +693,7 @@ int main(int argc, char* argv[]) {
         }
 
         NovelMind::scripting::Validator validator;
+        validator.setSource(source);
         auto validationResult = validator.validate(program);
 
         if (validationResult.hasErrors() || validationResult.hasWarnings()) {
@@ -453,6 +717,10 @@ int main(int argc, char* argv[]) {
             std::cout << "Compiling...\n";
         }
 
+        if (opts.registerFormat) {
+            return emitRegisterProgram(program, opts, useColor);
+        }
+
         NovelMind::scripting::Compiler compiler;
         auto compileResult = compiler.compile(program);
 
@@ -472,32 +740,7 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
-        if (opts.showIr) {
-            printIr(compiledScript, useColor);
-        }
-
-        // Write output
-        if (opts.verbose) {
-            std::cout << "Writing " << opts.outputFile << "...\n";
-        }
-
-        if (!writeCompiledScript(compiledScript, opts.outputFile)) {
-            std::cerr << red << "Error: " << reset
-                      << "Failed to write output file: " << opts.outputFile << "\n";
-            return 1;
-        }
-
-        std::cout << green << bold << "Success!" << reset << " Compiled "
-                  << opts.inputFile << " -> " << opts.outputFile << "\n";
-
-        if (opts.verbose) {
-            std::cout << "  " << compiledScript.instructions.size() << " instructions\n";
-            std::cout << "  " << compiledScript.stringTable.size() << " strings\n";
-            std::cout << "  " << compiledScript.sceneEntryPoints.size() << " scenes\n";
-            std::cout << "  " << compiledScript.characters.size() << " characters\n";
-        }
-
-        return 0;
+        return emitStackScript(compiledScript, opts, useColor);
 
     } catch (const std::exception& e) {
         std::cerr << red << "Error: " << reset << e.what() << "\n";
@@ -724,7 +724,7 @@ Result<void> EditorRuntimeHost::compileProject() {
 
     // Extract scene names
     for (const auto &scene : m_program->scenes) {
-      m_sceneNames.push_back(scene.name);
+      m_sceneNames.emplace_back(scene.name);
     }
 
     // Validator
@@ -0,0 +1,83 @@
+#pragma once
+
+/**
+ * @file byte_buffer.hpp
+ * @brief Immutable, reference-counted bytes shared without copying
+ *
+ * A ByteBuffer is a read-only span plus shared ownership of whatever holds
+ * the bytes: a vector it took over, or a mapped file it points into.
+ * Copying a ByteBuffer copies a pointer and bumps a count, so a resource
+ * can sit in a cache and be handed to any number of readers while living
+ * in memory exactly once. The bytes are freed with the last copy.
+ *
+ * Example usage:
+ * @code
+ * core::ByteBuffer image(decodePng(file));   // Takes the vector, no copy
+ * cache.put(id, image);                       // Shares it
+ * texture.upload(image.span());
+ * @endcode
+ */
+
+#include "NovelMind/core/types.hpp"
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace NovelMind::core {
+
+class ByteBuffer {
+public:
+  ByteBuffer() = default;
+
+  /**
+   * @brief Take ownership of @p bytes without copying them
+   */
+  ByteBuffer(std::vector<u8> &&bytes);
+
+  /**
+   * @brief Share @p bytes, which @p owner keeps alive
+   */
+  template <typename Owner>
+  ByteBuffer(std::shared_ptr<Owner> owner, std::span<const u8> bytes)
+      : m_owner(std::move(owner)), m_data(bytes.data()), m_size(bytes.size()) {}
+
+  /**
+   * @brief Copy @p bytes into a new buffer
+   */
+  [[nodiscard]] static ByteBuffer copyOf(std::span<const u8> bytes);
+
+  [[nodiscard]] const u8 *data() const { return m_data; }
+  [[nodiscard]] usize size() const { return m_size; }
+  [[nodiscard]] bool empty() const { return m_size == 0; }
+
+  [[nodiscard]] std::span<const u8> span() const { return {m_data, m_size}; }
+  operator std::span<const u8>() const { return span(); }
+
+  [[nodiscard]] const u8 *begin() const { return m_data; }
+  [[nodiscard]] const u8 *end() const { return m_data + m_size; }
+  [[nodiscard]] u8 operator[](usize index) const { return m_data[index]; }
+
+  /**
+   * @brief A range of these bytes, sharing their ownership
+   */
+  [[nodiscard]] ByteBuffer subspan(usize offset, usize count) const;
+
+  /**
+   * @brief Copy the bytes out, for callers that need to modify them
+   */
+  [[nodiscard]] std::vector<u8> toVector() const;
+
+  /**
+   * @brief Number of buffers sharing these bytes, 0 when empty
+   */
+  [[nodiscard]] long useCount() const { return m_owner.use_count(); }
+
+  friend bool operator==(const ByteBuffer &lhs, std::span<const u8> rhs);
+
+private:
+  std::shared_ptr<const void> m_owner;
+  const u8 *m_data = nullptr;
+  usize m_size = 0;
+};
+
+} // namespace NovelMind::core
@@ -0,0 +1,204 @@
+#pragma once
+
+/**
+ * @file json.hpp
+ * @brief Streaming JSON writer and pull parser
+ *
+ * JsonWriter emits a document token by token, straight into a string or
+ * through a fixed-size buffer into a stream, and escapes every string it
+ * writes. JsonReader walks a document held in memory (for instance a
+ * MappedFile) one event at a time; strings without escapes are returned
+ * as views into the input, so reading allocates only for escaped strings
+ * and for what the caller keeps.
+ *
+ * Example usage:
+ * @code
+ * std::ofstream file("graph.json", std::ios::binary);
+ * core::JsonWriter writer(file);
+ * writer.beginObject().key("name").value(name).endObject();
+ *
+ * core::JsonReader reader(text);
+ * if (reader.next() == core::JsonEvent::BeginObject) {
+ *     while (reader.next() == core::JsonEvent::Key) {
+ *         if (reader.getString() == "name" &&
+ *             reader.next() == core::JsonEvent::String) {
+ *             name = reader.getString();
+ *         } else {
+ *             reader.skipValue();
+ *         }
+ *     }
+ * }
+ * if (reader.hasError()) {
+ *     // reader.getError() names the line and column
+ * }
+ * @endcode
+ */
+
+#include "NovelMind/core/types.hpp"
+#include <concepts>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NovelMind::core {
+
+class JsonWriter {
+public:
+  /**
+   * @brief Append the document to @p out
+   */
+  explicit JsonWriter(std::string &out);
+
+  /**
+   * @brief Write the document to @p out in chunks
+   *
+   * Output is buffered; it is flushed when the buffer fills, on flush()
+   * and on destruction.
+   */
+  explicit JsonWriter(std::ostream &out);
+
+  ~JsonWriter();
+
+  JsonWriter(const JsonWriter &) = delete;
+  JsonWriter &operator=(const JsonWriter &) = delete;
+
+  JsonWriter &beginObject();
+  JsonWriter &endObject();
+  JsonWriter &beginArray();
+  JsonWriter &endArray();
+
+  /**
+   * @brief Name the next member of the current object
+   */
+  JsonWriter &key(std::string_view name);
+
+  JsonWriter &value(std::string_view text);
+  JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+  JsonWriter &value(bool flag);
+  // Floating-point numbers are written with a fraction or exponent, so a
+  // reader can tell them from integers; non-finite ones are written as null
+  JsonWriter &value(f64 number);
+  JsonWriter &value(f32 number); // Shortest text that reads back as the f32
+  JsonWriter &nullValue();
+
+  template <std::integral T>
+    requires(!std::same_as<T, bool>)
+  JsonWriter &value(T number) {
+    if constexpr (std::is_signed_v<T>) {
+      return writeInteger(static_cast<i64>(number));
+    } else {
+      return writeUnsigned(static_cast<u64>(number));
+    }
+  }
+
+  void flush();
+
+private:
+  JsonWriter &writeInteger(i64 number);
+  JsonWriter &writeUnsigned(u64 number);
+  void beginValue();
+  void writeString(std::string_view text);
+  void maybeFlush();
+
+  std::string *m_out;
+  std::ostream *m_stream = nullptr;
+  std::string m_buffer; // Used only when writing to a stream
+  // One entry per open container: whether it has members yet
+  std::vector<bool> m_hasMembers;
+  bool m_afterKey = false;
+};
+
+enum class JsonEvent : u8 {
+  BeginObject,
+  EndObject,
+  BeginArray,
+  EndArray,
+  Key,
+  String,
+  Number,
+  Bool,
+  Null,
+  End,  // The document was read completely
+  Error // See JsonReader::getError()
+};
+
+class JsonReader {
+public:
+  /**
+   * @param text The document; must outlive the reader
+   */
+  explicit JsonReader(std::string_view text);
+
+  /**
+   * @brief Advance to the next event
+   *
+   * After End or Error, every further call returns the same event.
+   */
+  JsonEvent next();
+
+  /**
+   * @brief Skip the value that the next call to next() would start
+   *
+   * Call after a Key event to ignore the member's value.
+   */
+  void skipValue();
+
+  /**
+   * @brief Text of the current Key or String event, unescaped
+   *
+   * Valid until the next call to next().
+   */
+  [[nodiscard]] std::string_view getString() const { return m_string; }
+
+  /**
+   * @brief Whether the current Number has no fraction or exponent
+   */
+  [[nodiscard]] bool isInteger() const;
+
+  [[nodiscard]] f64 getNumber() const;
+  [[nodiscard]] i64 getInt() const;
+  [[nodiscard]] u64 getUint() const;
+  [[nodiscard]] bool getBool() const { return m_bool; }
+
+  /**
+   * @brief Stop reading with an error at the current position
+   *
+   * Lets a consumer report a document that is valid JSON but not what it
+   * expected, with the same position information as a syntax error.
+   */
+  void fail(const std::string &message);
+
+  [[nodiscard]] bool hasError() const { return !m_error.empty(); }
+  [[nodiscard]] const std::string &getError() const { return m_error; }
+
+private:
+  enum class State : u8 {
+    Value,        // A value is required
+    ValueOrEnd,   // First element of an array
+    Key,          // A member name is required (after a comma)
+    KeyOrEnd,     // First member of an object
+    CommaOrEnd,   // After a member or element
+    Done          // The top-level value was read
+  };
+
+  JsonEvent readValue();
+  JsonEvent readString(JsonEvent event);
+  JsonEvent readNumber();
+  JsonEvent readLiteral(std::string_view literal, JsonEvent event);
+  JsonEvent close(char bracket, JsonEvent event);
+  JsonEvent afterValue(JsonEvent event);
+  JsonEvent error(const std::string &message);
+  void skipWhitespace();
+
+  std::string_view m_text;
+  usize m_pos = 0;
+  State m_state = State::Value;
+  std::vector<char> m_containers; // '{' or '[' per open container
+  std::string_view m_string;      // Current string, number or key text
+  std::string m_scratch;          // Unescaped text of the current string
+  bool m_bool = false;
+  std::string m_error;
+};
+
+} // namespace NovelMind::core
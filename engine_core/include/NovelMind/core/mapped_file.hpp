@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Maps a file with mmap (POSIX) or a file mapping (Windows) so its bytes
+ * can be used in place: nothing is read until a page is touched, and
+ * pages stay shared with the OS file cache. Platforms without mapping
+ * support, and empty files, fall back to reading the file into memory.
+ *
+ * Example usage:
+ * @code
+ * auto file = core::MappedFile::open("game.nmc");
+ * if (file.isOk()) {
+ *     const u8 *bytes = file.value()->data();
+ *     // ... use file.value()->size() bytes
+ * }
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace NovelMind::core {
+
+class MappedFile;
+using MappedFilePtr = std::shared_ptr<const MappedFile>;
+
+class MappedFile {
+public:
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  [[nodiscard]] static Result<MappedFilePtr> open(const std::string &path);
+
+  [[nodiscard]] const u8 *data() const { return m_data; }
+  [[nodiscard]] usize size() const { return m_size; }
+
+  /**
+   * @brief Whether the bytes are mapped rather than read into memory
+   */
+  [[nodiscard]] bool isMapped() const { return m_mapping != nullptr; }
+
+  /**
+   * @brief Ask the OS to start paging in a byte range ahead of use
+   *
+   * Only a hint; does nothing for files that are not mapped.
+   */
+  void prefetch(usize offset, usize length) const;
+
+private:
+  MappedFile() = default;
+
+  const u8 *m_data = nullptr;
+  usize m_size = 0;
+  void *m_mapping = nullptr;      // Base of the mapped view
+  void *m_mappingHandle = nullptr; // Windows file mapping object
+  std::vector<u8> m_buffer;       // Fallback when the file is not mapped
+};
+
+} // namespace NovelMind::core
@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+ * @file thread_pool.hpp
+ * @brief Work-stealing thread pool for CPU-bound tool jobs
+ *
+ * Each worker owns a task deque. Tasks submitted from a worker go to the
+ * back of its own deque and are popped LIFO, which keeps recursive work
+ * (forking a search, splitting a batch) cache-warm; idle workers steal from
+ * the front of other deques. Tasks submitted from other threads are spread
+ * round-robin.
+ *
+ * Example usage:
+ * @code
+ * core::ThreadPool pool;
+ * pool.submit([&] { visit(root, pool); }); // visit() may submit more tasks
+ * pool.wait();
+ * @endcode
+ */
+
+#include "NovelMind/core/types.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NovelMind::core {
+
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  static constexpr usize NOT_A_WORKER = static_cast<usize>(-1);
+
+  /**
+   * @param threadCount Number of workers; 0 uses the hardware concurrency
+   */
+  explicit ThreadPool(usize threadCount = 0);
+
+  /**
+   * @brief Finishes all queued tasks, then joins the workers
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Queue a task; tasks must not throw
+   */
+  void submit(Task task);
+
+  /**
+   * @brief Block until every submitted task, including tasks submitted by
+   *        tasks, has finished
+   *
+   * Must not be called from a worker.
+   */
+  void wait();
+
+  [[nodiscard]] usize getThreadCount() const { return m_workers.size(); }
+
+  /**
+   * @brief Index of the calling worker in this pool, or NOT_A_WORKER
+   */
+  [[nodiscard]] usize getCurrentWorker() const;
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(usize index);
+  bool popLocal(usize index, Task &task);
+  bool steal(usize thief, Task &task);
+  void finishTask();
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake; // Tasks queued or stopping
+  std::condition_variable m_idle; // m_pending reached zero
+  std::atomic<usize> m_queued{0};  // Tasks sitting in a deque
+  std::atomic<usize> m_pending{0}; // Tasks submitted and not yet finished
+  std::atomic<usize> m_nextWorker{0};
+  bool m_stopping = false;
+};
+
+} // namespace NovelMind::core
@@ -6,13 +6,20 @@
  *
  * This module defines the AST node types used to represent
  * parsed NM Script programs.
+ *
+ * Nodes, child lists and strings are allocated from the AstArena owned by
+ * the Program, and are only valid while that Program is alive. Node
+ * pointers (ExprPtr, StmtPtr) do not own what they point to, and names and
+ * texts are interned string_views, so dropping a Program frees the whole
+ * tree at once.
  */
 
 #include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/ast_arena.hpp"
 #include "NovelMind/scripting/token.hpp"
 #include <memory>
 #include <optional>
-#include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -22,8 +29,8 @@ namespace NovelMind::scripting {
 struct Expression;
 struct Statement;
 
-using ExprPtr = std::unique_ptr<Expression>;
-using StmtPtr = std::unique_ptr<Statement>;
+using ExprPtr = Expression *;
+using StmtPtr = Statement *;
 
 /**
  * @brief Position enum for character/sprite placement
@@ -35,11 +42,11 @@ enum class Position { Left, Center, Right, Custom };
  */
 
 struct LiteralExpr {
-  std::variant<std::monostate, i32, f32, bool, std::string> value;
+  std::variant<std::monostate, i32, f32, bool, std::string_view> value;
 };
 
 struct IdentifierExpr {
-  std::string name;
+  std::string_view name;
 };
 
 struct BinaryExpr {
@@ -54,13 +61,13 @@ struct UnaryExpr {
 };
 
 struct CallExpr {
-  std::string callee;
-  std::vector<ExprPtr> arguments;
+  std::string_view callee;
+  AstList<ExprPtr> arguments;
 };
 
 struct PropertyExpr {
   ExprPtr object;
-  std::string property;
+  std::string_view property;
 };
 
 /**
@@ -85,18 +92,20 @@ struct Expression {
  * @brief Character declaration: character Hero(name="Alex", color="#FFCC00")
  */
 struct CharacterDecl {
-  std::string id;
-  std::string displayName;
-  std::string color;
-  std::optional<std::string> defaultSprite;
+  std::string_view id;
+  std::string_view displayName;
+  std::string_view color;
+  std::optional<std::string_view> defaultSprite;
+  SourceLocation location; // Of the identifier
 };
 
 /**
  * @brief Scene declaration: scene intro { ... }
  */
 struct SceneDecl {
-  std::string name;
-  std::vector<StmtPtr> body;
+  std::string_view name;
+  AstList<StmtPtr> body;
+  SourceLocation location; // Of the name
 };
 
 /**
@@ -106,12 +115,12 @@ struct ShowStmt {
   enum class Target { Background, Character, Sprite };
 
   Target target;
-  std::string identifier;
-  std::optional<std::string> resource;
+  std::string_view identifier;
+  std::optional<std::string_view> resource;
   std::optional<Position> position;
   std::optional<f32> customX;
   std::optional<f32> customY;
-  std::optional<std::string> transition;
+  std::optional<std::string_view> transition;
   std::optional<f32> duration;
 };
 
@@ -119,8 +128,8 @@ struct ShowStmt {
  * @brief Hide command: hide Hero
  */
 struct HideStmt {
-  std::string identifier;
-  std::optional<std::string> transition;
+  std::string_view identifier;
+  std::optional<std::string_view> transition;
   std::optional<f32> duration;
 };
 
@@ -128,25 +137,25 @@ struct HideStmt {
  * @brief Say command: say Hero "Hello, world!"
  */
 struct SayStmt {
-  std::optional<std::string> speaker;
-  std::string text;
+  std::optional<std::string_view> speaker;
+  std::string_view text;
 };
 
 /**
  * @brief Choice option within a choice block
  */
 struct ChoiceOption {
-  std::string text;
+  std::string_view text;
   std::optional<ExprPtr> condition;
-  std::vector<StmtPtr> body;
-  std::optional<std::string> gotoTarget;
+  AstList<StmtPtr> body;
+  std::optional<std::string_view> gotoTarget;
 };
 
 /**
  * @brief Choice block: choice { "Option 1" -> ... }
  */
 struct ChoiceStmt {
-  std::vector<ChoiceOption> options;
+  AstList<ChoiceOption> options;
 };
 
 /**
@@ -154,15 +163,15 @@ struct ChoiceStmt {
  */
 struct IfStmt {
   ExprPtr condition;
-  std::vector<StmtPtr> thenBranch;
-  std::vector<StmtPtr> elseBranch;
+  AstList<StmtPtr> thenBranch;
+  AstList<StmtPtr> elseBranch;
 };
 
 /**
  * @brief Goto statement: goto scene_name
  */
 struct GotoStmt {
-  std::string target;
+  std::string_view target;
 };
 
 /**
@@ -179,7 +188,7 @@ struct PlayStmt {
   enum class MediaType { Sound, Music };
 
   MediaType type;
-  std::string resource;
+  std::string_view resource;
   std::optional<f32> volume;
   std::optional<bool> loop;
 };
@@ -196,7 +205,7 @@ struct StopStmt {
  * @brief Set statement: set flag_name = value
  */
 struct SetStmt {
-  std::string variable;
+  std::string_view variable;
   ExprPtr value;
 };
 
@@ -204,9 +213,9 @@ struct SetStmt {
  * @brief Transition statement: transition fade 1.0
  */
 struct TransitionStmt {
-  std::string type;
+  std::string_view type;
   f32 duration;
-  std::optional<std::string> color;
+  std::optional<std::string_view> color;
 };
 
 /**
@@ -220,7 +229,7 @@ struct ExpressionStmt {
  * @brief Block statement (group of statements)
  */
 struct BlockStmt {
-  std::vector<StmtPtr> statements;
+  AstList<StmtPtr> statements;
 };
 
 /**
@@ -245,20 +254,25 @@ struct Program {
   std::vector<CharacterDecl> characters;
   std::vector<SceneDecl> scenes;
   std::vector<StmtPtr> globalStatements;
+
+  // Owns every node, list and string the declarations above refer to
+  std::unique_ptr<AstArena> arena = std::make_unique<AstArena>();
 };
 
 /**
  * @brief Helper to create expressions
  */
-template <typename T> ExprPtr makeExpr(T &&expr, SourceLocation loc = {}) {
-  return std::make_unique<Expression>(std::forward<T>(expr), loc);
+template <typename T>
+ExprPtr makeExpr(AstArena &arena, T &&expr, SourceLocation loc = {}) {
+  return arena.create<Expression>(std::forward<T>(expr), loc);
 }
 
 /**
  * @brief Helper to create statements
  */
-template <typename T> StmtPtr makeStmt(T &&stmt, SourceLocation loc = {}) {
-  return std::make_unique<Statement>(std::forward<T>(stmt), loc);
+template <typename T>
+StmtPtr makeStmt(AstArena &arena, T &&stmt, SourceLocation loc = {}) {
+  return arena.create<Statement>(std::forward<T>(stmt), loc);
 }
 
 } // namespace NovelMind::scripting
@@ -0,0 +1,123 @@
+#pragma once
+
+/**
+ * @file ast_arena.hpp
+ * @brief Bump allocator and string interner backing the NM Script AST
+ *
+ * Every node, child list and string of a parsed Program lives in one
+ * AstArena. Nodes are trivially destructible, so the arena releases the
+ * whole tree by freeing its chunks: no per-node destructor runs.
+ * Identifiers and literal strings are interned, so a name used throughout
+ * a script is stored once and equal names share the same characters.
+ */
+
+#include "NovelMind/core/types.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Fixed-size array of AST children allocated in an AstArena
+ *
+ * A non-owning view like std::span; copying it copies the view, not the
+ * elements.
+ */
+template <typename T> class AstList {
+public:
+  AstList() = default;
+  AstList(T *data, usize size) : m_data(data), m_size(size) {}
+
+  [[nodiscard]] T *begin() const { return m_data; }
+  [[nodiscard]] T *end() const { return m_data + m_size; }
+  [[nodiscard]] T *data() const { return m_data; }
+  [[nodiscard]] usize size() const { return m_size; }
+  [[nodiscard]] bool empty() const { return m_size == 0; }
+
+  [[nodiscard]] T &operator[](usize index) const { return m_data[index]; }
+  [[nodiscard]] T &front() const { return m_data[0]; }
+  [[nodiscard]] T &back() const { return m_data[m_size - 1]; }
+
+private:
+  T *m_data = nullptr;
+  usize m_size = 0;
+};
+
+class AstArena {
+public:
+  AstArena() = default;
+  ~AstArena();
+
+  AstArena(const AstArena &) = delete;
+  AstArena &operator=(const AstArena &) = delete;
+
+  /**
+   * @brief Construct a T in the arena; it is never destroyed individually
+   */
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "AST arena objects are freed without running destructors");
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Copy @p count items into a new arena list
+   */
+  template <typename T> AstList<T> makeList(const T *items, usize count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "AST arena objects are freed without running destructors");
+    if (count == 0) {
+      return {};
+    }
+    T *data = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    for (usize i = 0; i < count; ++i) {
+      new (data + i) T(items[i]);
+    }
+    return AstList<T>(data, count);
+  }
+
+  template <typename T> AstList<T> makeList(const std::vector<T> &items) {
+    return makeList(items.data(), items.size());
+  }
+
+  template <typename T> AstList<T> makeList(std::initializer_list<T> items) {
+    return makeList(items.begin(), items.size());
+  }
+
+  /**
+   * @brief Arena copy of @p text, shared with every equal interned string
+   */
+  std::string_view intern(std::string_view text);
+
+  void *allocate(usize size, usize alignment);
+
+  /**
+   * @brief Bytes reserved from the system, including unused chunk tails
+   */
+  [[nodiscard]] usize getBytesReserved() const { return m_bytesReserved; }
+  [[nodiscard]] usize getInternedCount() const { return m_internedCount; }
+
+private:
+  static constexpr usize CHUNK_SIZE = 64 * 1024;
+
+  void addChunk(usize minimumSize);
+  void growInternTable();
+
+  std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+  std::byte *m_cursor = nullptr;
+  std::byte *m_end = nullptr;
+  usize m_bytesReserved = 0;
+
+  // Open-addressing set of interned strings; empty views are free slots
+  std::vector<std::string_view> m_internTable;
+  usize m_internedCount = 0;
+};
+
+} // namespace NovelMind::scripting
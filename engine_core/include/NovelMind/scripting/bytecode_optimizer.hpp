@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * @file bytecode_optimizer.hpp
+ * @brief Peephole and constant-folding pass over compiled NM Script bytecode
+ *
+ * The Compiler emits straightforward stack code (every literal is pushed,
+ * every branch is a separate compare + jump). BytecodeOptimizer rewrites a
+ * CompiledScript in place before it is written out or loaded into the VM,
+ * keeping scene entry points and all jump targets valid.
+ */
+
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Optimization level, mirrors nmc's -O0/-O1/-O2
+ */
+enum class OptimizationLevel : u8 {
+  None = 0,  // Leave the bytecode untouched
+  Basic = 1, // Constant folding, jump threading, dead code, peepholes
+  Full = 2   // Basic + superinstruction fusion (needs a VM that knows them)
+};
+
+/**
+ * @brief What a single optimize() call changed
+ */
+struct OptimizationStats {
+  usize instructionsBefore = 0;
+  usize instructionsAfter = 0;
+  usize constantsFolded = 0;
+  usize jumpsThreaded = 0;
+  usize deadInstructions = 0;
+  usize peepholes = 0;
+  usize superinstructions = 0;
+
+  [[nodiscard]] usize instructionsRemoved() const {
+    return instructionsBefore - instructionsAfter;
+  }
+};
+
+/**
+ * @brief Rewrites CompiledScript::instructions without changing behaviour
+ *
+ * Passes run to a fixed point:
+ * - constant folding of literal arithmetic/comparisons and of conditional
+ *   jumps on literals
+ * - jump threading (jumps to jumps, jumps to HALT)
+ * - removal of code unreachable from instruction 0 and the scene entry
+ *   points, i.e. anything after JUMP/HALT/GOTO_SCENE that nothing jumps to
+ * - peepholes: push+POP pairs, NOT+JUMP_IF_NOT, jumps to the next
+ *   instruction
+ *
+ * At OptimizationLevel::Full, common sequences are then fused into
+ * superinstructions (see OpCode::CMP_JUMP_IF_NOT, SLOT_CMP_INT_JUMP_IF_NOT
+ * and INC_SLOT).
+ *
+ * Example usage:
+ * @code
+ * auto result = compiler.compile(program);
+ * BytecodeOptimizer optimizer(OptimizationLevel::Basic);
+ * OptimizationStats stats = optimizer.optimize(result.value());
+ * @endcode
+ */
+class BytecodeOptimizer {
+public:
+  explicit BytecodeOptimizer(OptimizationLevel level = OptimizationLevel::Basic);
+
+  /**
+   * @brief Optimize a compiled script in place
+   * @return Counts of what each pass changed
+   */
+  OptimizationStats optimize(CompiledScript &script);
+
+  [[nodiscard]] OptimizationLevel getLevel() const { return m_level; }
+
+private:
+  bool foldConstants(CompiledScript &script);
+  bool foldConstantsOnce(CompiledScript &script);
+  bool threadJumps(CompiledScript &script);
+  bool removeDeadCode(CompiledScript &script);
+  bool applyPeepholes(CompiledScript &script);
+  bool fuseSuperinstructions(CompiledScript &script);
+
+  // Drop instructions whose m_removed bit is set, remapping jump targets and
+  // scene entry points to the next surviving instruction
+  void compact(CompiledScript &script);
+  void markJumpTargets(const CompiledScript &script);
+
+  OptimizationLevel m_level;
+  OptimizationStats m_stats;
+  std::vector<bool> m_removed;
+  std::vector<bool> m_isTarget;
+};
+
+} // namespace NovelMind::scripting
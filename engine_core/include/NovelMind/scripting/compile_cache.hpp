@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * @file compile_cache.hpp
+ * @brief On-disk cache of per-file compilation results for project builds
+ *
+ * Each source file of a project is cached under a key derived from its
+ * content hash and from everything else its compiled form depends on: the
+ * compiler version, the cache format and the build options. An entry holds
+ * the file's relocatable bytecode, the scenes and characters it declares
+ * and imports, and the warnings reported against it, so a file whose key
+ * still matches is neither parsed, validated nor compiled again.
+ *
+ * Entries live one per source file in the cache directory, named after a
+ * hash of the source path. A stale, corrupt or foreign entry is treated
+ * as a miss and overwritten by the next store().
+ *
+ * Example usage:
+ * @code
+ * CompileCache cache(".nmcache", CompileCache::hashContent("dead-code=1"));
+ * const u64 key = cache.makeKey(source->getText());
+ * if (auto cached = cache.load(path, key)) {
+ *     // cached->fragment is the file's bytecode
+ * }
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/script_error.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Everything a project build needs from one compiled source file
+ */
+struct CompiledFile {
+  std::vector<std::string> scenes;     // Declared, in source order
+  std::vector<std::string> characters; // Declared, in source order
+  // Where each of the above is declared, for duplicate diagnostics
+  std::vector<SourceLocation> sceneLocations;
+  std::vector<SourceLocation> characterLocations;
+
+  // Declared by other files of the project; sorted
+  std::vector<std::string> importedScenes;
+  std::vector<std::string> importedCharacters;
+
+  ScriptFragment fragment;
+  std::vector<ScriptError> diagnostics; // Warnings; files with errors are not cached
+};
+
+class CompileCache {
+public:
+  /**
+   * @param directory   Where entries are stored; created on first store()
+   * @param configHash  Hash of the build options that affect the output
+   */
+  CompileCache(std::string directory, u64 configHash);
+
+  /**
+   * @brief Fast 64-bit hash of @p data; not cryptographic
+   */
+  [[nodiscard]] static u64 hashContent(std::string_view data, u64 seed = 0);
+
+  /**
+   * @brief Cache key of a source file with content @p source
+   */
+  [[nodiscard]] u64 makeKey(std::string_view source) const;
+
+  /**
+   * @brief Cached result for @p path, if one was stored under @p key
+   *
+   * Safe to call concurrently, including for different paths being
+   * stored at the same time.
+   */
+  [[nodiscard]] std::optional<CompiledFile> load(const std::string &path,
+                                                 u64 key) const;
+
+  /**
+   * @brief Store @p file as the result for @p path under @p key
+   *
+   * The entry is written to a temporary file and renamed into place, so a
+   * concurrent or interrupted build never reads a partial entry.
+   */
+  Result<void> store(const std::string &path, u64 key,
+                     const CompiledFile &file) const;
+
+  [[nodiscard]] const std::string &getDirectory() const { return m_directory; }
+
+private:
+  [[nodiscard]] std::string entryPath(const std::string &path) const;
+
+  std::string m_directory;
+  u64 m_configHash;
+};
+
+} // namespace NovelMind::scripting
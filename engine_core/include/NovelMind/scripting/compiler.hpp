@@ -13,12 +13,35 @@
 #include "NovelMind/scripting/ast.hpp"
 #include "NovelMind/scripting/opcode.hpp"
 #include "NovelMind/scripting/value.hpp"
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 namespace NovelMind::scripting {
 
+/**
+ * @brief Debug info: source location of the instructions from an index on
+ */
+struct LineTableEntry {
+  u32 instruction;
+  SourceLocation location;
+};
+
+/**
+ * @brief Character definition owned by a compiled script
+ *
+ * Copied out of the CharacterDecl, whose strings live in the Program's
+ * arena and so do not outlive the AST.
+ */
+struct CompiledCharacter {
+  std::string id;
+  std::string displayName;
+  std::string color;
+  std::optional<std::string> defaultSprite;
+};
+
 /**
  * @brief Compiled bytecode representation
  */
@@ -30,12 +53,48 @@ struct CompiledScript {
   std::unordered_map<std::string, u32> sceneEntryPoints;
 
   // Character definitions
-  std::unordered_map<std::string, CharacterDecl> characters;
+  std::unordered_map<std::string, CompiledCharacter> characters;
 
   // Variable declarations (for type checking)
   std::unordered_map<std::string, ValueType> variables;
+
+  // Variable slots: slot index -> variable name (for LOAD_SLOT/STORE_SLOT)
+  std::vector<std::string> variableSlots;
+
+  // Sorted by instruction; each entry covers instructions up to the next one
+  std::vector<LineTableEntry> lineTable;
+};
+
+/**
+ * @brief A goto whose target scene the compiled file does not declare
+ */
+struct ExternalJump {
+  u32 instruction;
+  std::string scene;
+};
+
+/**
+ * @brief Relocatable bytecode of one file of a multi-file project
+ *
+ * Operands are local to the fragment: string and slot operands index its
+ * own tables and jump targets its own instructions. Scene code comes
+ * first, then the file's global statements from globalsStart on; there is
+ * no trailing HALT. linkFragments() joins fragments into one script.
+ */
+struct ScriptFragment {
+  CompiledScript script;
+  u32 globalsStart = 0;
+  std::vector<ExternalJump> externalJumps;
 };
 
+/**
+ * @brief Source location of an instruction, or nullptr if the line table
+ *        does not cover it
+ */
+[[nodiscard]] const SourceLocation *
+findSourceLocation(const std::vector<LineTableEntry> &lineTable,
+                   u32 instruction);
+
 /**
  * @brief Compiler error information
  */
@@ -60,7 +119,7 @@ struct CompileError {
  * auto result = compiler.compile(program);
  * if (result.isOk()) {
  *     CompiledScript script = result.value();
- *     vm.load(script.instructions, script.stringTable);
+ *     vm.load(script.instructions, script.stringTable, script.variableSlots);
  * }
  * @endcode
  */
@@ -76,6 +135,14 @@ public:
    */
   [[nodiscard]] Result<CompiledScript> compile(const Program &program);
 
+  /**
+   * @brief Compile one file of a project to a relocatable fragment
+   *
+   * Gotos to scenes declared by other files become external jumps instead
+   * of errors.
+   */
+  [[nodiscard]] Result<ScriptFragment> compileFragment(const Program &program);
+
   /**
    * @brief Get all errors encountered during compilation
    */
@@ -84,10 +151,12 @@ public:
 private:
   // Compilation helpers
   void reset();
+  void resolvePendingJumps(std::vector<ExternalJump> *externalJumps);
   void emit(OpCode op, u32 operand = 0);
   u32 emitJump(OpCode op);
   void patchJump(u32 jumpIndex);
-  u32 addString(const std::string &str);
+  u32 addString(std::string_view str);
+  u32 addVariableSlot(std::string_view name);
 
   // Error handling
   void error(const std::string &message, SourceLocation loc = {});
@@ -97,6 +166,7 @@ private:
   void compileCharacter(const CharacterDecl &decl);
   void compileScene(const SceneDecl &decl);
   void compileStatement(const Statement &stmt);
+  void markSourceLocation(SourceLocation loc);
   void compileExpression(const Expression &expr);
 
   // Statement compilers
@@ -132,6 +202,10 @@ private:
   };
   std::vector<PendingJump> m_pendingJumps;
   std::unordered_map<std::string, u32> m_labels;
+  u32 m_globalsStart = 0;
+
+  // Variable name -> slot index, mirrored in m_output.variableSlots
+  std::unordered_map<std::string, u32> m_variableSlots;
 
   // Current compilation context
   std::string m_currentScene;
@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+ * @file graph_cache.hpp
+ * @brief Binary cache of IRGraph and VisualGraph project files
+ *
+ * JSON stays the format graphs are saved and versioned in. GraphCache keeps
+ * a binary copy of each graph file next to the project, made with
+ * IRGraph::toBinary / VisualGraph::toBinary, and loads that copy instead of
+ * parsing the JSON whenever the JSON is unchanged. Every entry records a
+ * hash of the JSON it was made from, so an edited, reverted or replaced
+ * file is simply a miss; a missing, stale or corrupt entry is rebuilt from
+ * the JSON on the next load.
+ *
+ * The binary form is a version header followed by fixed-size tables:
+ * interned strings (keys, types, ports and values are stored once), nodes,
+ * properties and edges. It is read from a single mapping of the file and
+ * decoded straight into the graph, without parsing.
+ *
+ * Example usage:
+ * @code
+ * GraphCache cache(projectDir + "/.nmcache/graphs");
+ * auto graph = cache.loadVisualGraph(projectDir + "/story.graph.json");
+ * if (graph.isOk()) {
+ *     editor.open(std::move(graph).value());
+ * }
+ * // Later, save the JSON and refresh the entry in one step
+ * cache.saveVisualGraph(*editedGraph, projectDir + "/story.graph.json");
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/ir.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace NovelMind::scripting {
+
+class GraphCache {
+public:
+  struct Stats {
+    usize hits = 0;   // Loaded from the binary entry
+    usize misses = 0; // Parsed from JSON (entry missing, stale or corrupt)
+  };
+
+  /**
+   * @param directory Where entries are stored; created on first write
+   */
+  explicit GraphCache(std::string directory);
+
+  /**
+   * @brief Hash that ties an entry to the JSON text it was made from
+   */
+  [[nodiscard]] static u64 hashSource(std::string_view json);
+
+  /**
+   * @brief Load the graph saved at @p jsonPath, through the cache
+   *
+   * On a miss the JSON is parsed and the entry rewritten; failing to write
+   * the entry does not fail the load.
+   */
+  Result<std::unique_ptr<IRGraph>> loadIRGraph(const std::string &jsonPath);
+  Result<std::unique_ptr<VisualGraph>>
+  loadVisualGraph(const std::string &jsonPath);
+
+  /**
+   * @brief Save @p graph as JSON to @p jsonPath and refresh its entry
+   */
+  Result<void> saveIRGraph(const IRGraph &graph, const std::string &jsonPath);
+  Result<void> saveVisualGraph(const VisualGraph &graph,
+                               const std::string &jsonPath);
+
+  [[nodiscard]] const Stats &getStats() const { return m_stats; }
+  [[nodiscard]] const std::string &getDirectory() const { return m_directory; }
+
+private:
+  template <typename Graph>
+  Result<std::unique_ptr<Graph>> load(const std::string &jsonPath,
+                                      std::string_view extension);
+  template <typename Graph>
+  Result<void> save(const Graph &graph, const std::string &jsonPath,
+                    std::string_view extension);
+
+  [[nodiscard]] std::string entryPath(const std::string &jsonPath,
+                                      std::string_view extension) const;
+  Result<void> writeEntry(const std::string &path,
+                          const std::vector<u8> &data) const;
+
+  std::string m_directory;
+  Stats m_stats;
+};
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,169 @@
+#pragma once
+
+/**
+ * @file incremental_validator.hpp
+ * @brief Diagnostics for a script being edited, updated per edit
+ *
+ * Validator walks a whole Program, so an editor that revalidates on every
+ * keystroke pays for the whole file each time. IncrementalValidator keeps
+ * a document split into sections, each starting at a line that declares a
+ * top-level scene or character, and keeps every section's parse and
+ * validation results between edits:
+ *
+ * - An edit reparses only the sections whose text it changed. A section
+ *   boundary is only ever placed outside braces and comments, so an edit
+ *   that opens a brace extends the reparsed region until it is closed.
+ * - Each section is validated on its own against the symbols the whole
+ *   document declares, the way ProjectCompiler validates files. A section
+ *   is revalidated when its text changed or when a scene or character it
+ *   resolves outside itself appears or disappears.
+ * - Checks that need the whole document (duplicate declarations, unused
+ *   symbols, unreachable scenes) are recomputed from every section's
+ *   symbol tables, which is linear in the number of symbols, not in the
+ *   size of the text.
+ *
+ * The diagnostics after any sequence of edits are the ones open() would
+ * report for the resulting text.
+ *
+ * Example usage:
+ * @code
+ * IncrementalValidator document;
+ * document.open(text);
+ * document.edit({offset, removedLength, "typed text"});
+ * for (const auto &diagnostic : document.getDiagnostics().all()) {
+ *     // ...
+ * }
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/ast.hpp"
+#include "NovelMind/scripting/script_error.hpp"
+#include "NovelMind/scripting/source_file.hpp"
+#include "NovelMind/scripting/validator.hpp"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Replacement of a byte range of the document
+ */
+struct TextEdit {
+  usize offset = 0; // First byte replaced
+  usize length = 0; // Bytes removed
+  std::string text; // Bytes inserted in their place
+};
+
+/**
+ * @brief Work done by the last open() or edit()
+ */
+struct IncrementalStats {
+  usize sections = 0;    // Sections in the document
+  usize reparsed = 0;    // Sections tokenized and parsed
+  usize revalidated = 0; // Sections validated
+  f64 seconds = 0.0;
+};
+
+/**
+ * @brief Split @p text before each line that declares a top-level scene or
+ *        character
+ *
+ * The first section also holds anything before the first declaration.
+ * Boundaries are placed outside braces and comments only, as for the
+ * sections of IncrementalValidator; the sections concatenate to @p text.
+ */
+[[nodiscard]] std::vector<std::string_view>
+splitDeclarations(std::string_view text);
+
+class IncrementalValidator {
+public:
+  IncrementalValidator();
+  ~IncrementalValidator();
+
+  /**
+   * @brief Configure whether to report unused symbols as warnings
+   *
+   * Takes effect at the next open() or edit().
+   */
+  void setReportUnused(bool report);
+
+  /**
+   * @brief Configure whether to report dead code as warnings
+   *
+   * Takes effect for sections validated after the change; call open()
+   * again to apply it to the whole document.
+   */
+  void setReportDeadCode(bool report);
+
+  /**
+   * @brief Replace the document and analyze all of it
+   */
+  void open(std::string text);
+
+  /**
+   * @brief Apply an edit and update the diagnostics it can affect
+   */
+  Result<void> edit(const TextEdit &edit);
+
+  [[nodiscard]] const std::string &getText() const { return m_text; }
+
+  /**
+   * @brief Diagnostics of the document, in section order, followed by the
+   *        document-wide checks
+   */
+  [[nodiscard]] ErrorList getDiagnostics() const;
+
+  [[nodiscard]] const IncrementalStats &getLastUpdate() const {
+    return m_stats;
+  }
+
+private:
+  struct Section {
+    usize offset = 0; // Byte offset in the document
+    u32 line = 0;     // Lines before the section
+    u32 lineCount = 0;
+    SourceFilePtr source; // The section's text; lines are section-relative
+    Program program;
+    bool parsed = false;
+    ErrorList parseErrors;
+    ValidationResult result;
+    // Declared scenes and characters, in source order
+    std::vector<std::string> scenes;
+    std::vector<std::string> characters;
+  };
+
+  struct ChangedSymbols {
+    std::unordered_set<std::string> scenes;
+    std::unordered_set<std::string> characters;
+  };
+
+  [[nodiscard]] usize sectionAt(usize offset) const;
+  void parseSection(Section &section);
+  void validateSection(Section &section);
+  void declare(const Section &section, bool add, ChangedSymbols &changed);
+  [[nodiscard]] bool dependsOn(const Section &section,
+                               const ChangedSymbols &changed) const;
+  void layoutSections(usize from);
+  void analyzeDocument();
+
+  std::string m_text;
+  std::vector<Section> m_sections; // Never empty
+
+  // Declarations of the whole document, and how many sections make each
+  ProjectSymbols m_symbols;
+  std::unordered_map<std::string, u32> m_sceneCounts;
+  std::unordered_map<std::string, u32> m_characterCounts;
+
+  ErrorList m_documentErrors; // Duplicates, unused and unreachable symbols
+  IncrementalStats m_stats;
+
+  bool m_reportUnused = true;
+  bool m_reportDeadCode = true;
+};
+
+} // namespace NovelMind::scripting
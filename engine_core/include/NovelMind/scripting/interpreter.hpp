@@ -2,17 +2,36 @@
 
 #include "NovelMind/core/result.hpp"
 #include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/register_vm.hpp"
+#include "NovelMind/scripting/script_image.hpp"
 #include "NovelMind/scripting/vm.hpp"
 #include <memory>
 
 namespace NovelMind::scripting {
 
+/**
+ * @brief Loads NMSC bytecode and runs it on the matching engine
+ *
+ * Version 1 images run on the stack VirtualMachine, version 2 images on
+ * RegisterVM. Version 3 script images (see script_image.hpp) run in place
+ * on the stack VirtualMachine; loadFromFile() maps them instead of reading
+ * them. Callbacks and flags are forwarded to both engines so they can
+ * be set up before the image is loaded.
+ */
 class ScriptInterpreter {
 public:
   ScriptInterpreter();
   ~ScriptInterpreter();
 
   Result<void> loadFromBytecode(const std::vector<u8> &bytecode);
+
+  /**
+   * @brief Load a compiled script file, mapping it if it is a script image
+   */
+  Result<void> loadFromFile(const std::string &path);
+
+  Result<void> loadImage(ScriptImagePtr image);
+
   void reset();
 
   bool step();
@@ -46,8 +65,21 @@ public:
 
   void registerCallback(OpCode op, VirtualMachine::NativeCallback callback);
 
+  /**
+   * @brief Whether the loaded image uses the register format
+   */
+  [[nodiscard]] bool usesRegisterFormat() const { return m_registerFormat; }
+
 private:
+  // Calls f with whichever engine the loaded image runs on
+  template <typename F> decltype(auto) withVm(F &&f);
+  template <typename F> decltype(auto) withVm(F &&f) const;
+
+  Result<void> loadStackBytecode(const std::vector<u8> &bytecode);
+
   std::unique_ptr<VirtualMachine> m_vm;
+  std::unique_ptr<RegisterVM> m_registerVm;
+  bool m_registerFormat = false;
 };
 
 } // namespace NovelMind::scripting
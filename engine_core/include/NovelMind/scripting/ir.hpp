@@ -19,14 +19,22 @@
 #include "NovelMind/scripting/ast.hpp"
 #include "NovelMind/scripting/lexer.hpp"
 #include "NovelMind/scripting/parser.hpp"
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <variant>
 #include <vector>
 
+namespace NovelMind::core {
+class JsonReader;
+class JsonWriter;
+class ThreadPool;
+} // namespace NovelMind::core
+
 namespace NovelMind::scripting {
 
 // Forward declarations
@@ -61,6 +69,67 @@ struct IRConnection {
   std::string label; // Optional label for debugging
 };
 
+/**
+ * @brief Connections on one side of a node, viewed in place
+ *
+ * Iterating does not allocate. The range refers to the graph's storage, so
+ * it is invalidated by connect(), disconnect() and removeNode().
+ */
+class IRConnectionRange {
+public:
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = IRConnection;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const IRConnection *;
+    using reference = const IRConnection &;
+
+    Iterator() = default;
+    Iterator(const IRConnection *connections, const u32 *index)
+        : m_connections(connections), m_index(index) {}
+
+    reference operator*() const { return m_connections[*m_index]; }
+    pointer operator->() const { return &m_connections[*m_index]; }
+    Iterator &operator++() {
+      ++m_index;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      ++m_index;
+      return previous;
+    }
+    bool operator==(const Iterator &other) const {
+      return m_index == other.m_index;
+    }
+    bool operator!=(const Iterator &other) const {
+      return m_index != other.m_index;
+    }
+
+  private:
+    const IRConnection *m_connections = nullptr;
+    const u32 *m_index = nullptr;
+  };
+
+  IRConnectionRange() = default;
+  IRConnectionRange(const IRConnection *connections, std::span<const u32> indices)
+      : m_connections(connections), m_indices(indices) {}
+
+  [[nodiscard]] Iterator begin() const {
+    return {m_connections, m_indices.data()};
+  }
+  [[nodiscard]] Iterator end() const {
+    return {m_connections, m_indices.data() + m_indices.size()};
+  }
+  [[nodiscard]] usize size() const { return m_indices.size(); }
+  [[nodiscard]] bool empty() const { return m_indices.empty(); }
+
+private:
+  const IRConnection *m_connections = nullptr;
+  std::span<const u32> m_indices;
+};
+
 /**
  * @brief IR Node types
  */
@@ -135,6 +204,7 @@ public:
 
   // Properties
   void setProperty(const std::string &name, const IRPropertyValue &value);
+  void setProperty(const std::string &name, IRPropertyValue &&value);
   [[nodiscard]] std::optional<IRPropertyValue>
   getProperty(const std::string &name) const;
   [[nodiscard]] const std::unordered_map<std::string, IRPropertyValue> &
@@ -171,6 +241,8 @@ public:
   // Serialization
   [[nodiscard]] std::string toJson() const;
   static std::unique_ptr<IRNode> fromJson(const std::string &json);
+  void writeJson(core::JsonWriter &writer) const;
+  static Result<std::unique_ptr<IRNode>> readJson(core::JsonReader &reader);
 
 protected:
   NodeId m_id;
@@ -206,13 +278,19 @@ public:
   Result<void> connect(const PortId &source, const PortId &target);
   void disconnect(const PortId &source, const PortId &target);
   void disconnectAll(NodeId nodeId);
-  [[nodiscard]] std::vector<IRConnection> getConnections() const;
+  [[nodiscard]] const std::vector<IRConnection> &getConnections() const {
+    return m_connections;
+  }
   [[nodiscard]] std::vector<IRConnection>
   getConnectionsFrom(NodeId nodeId) const;
   [[nodiscard]] std::vector<IRConnection> getConnectionsTo(NodeId nodeId) const;
   [[nodiscard]] bool isConnected(const PortId &source,
                                  const PortId &target) const;
 
+  // Connections of one node without copying; O(degree)
+  [[nodiscard]] IRConnectionRange getOutgoing(NodeId nodeId) const;
+  [[nodiscard]] IRConnectionRange getIncoming(NodeId nodeId) const;
+
   // Traversal
   [[nodiscard]] std::vector<NodeId> getTopologicalOrder() const;
   [[nodiscard]] std::vector<NodeId> getExecutionOrder() const;
@@ -231,15 +309,39 @@ public:
                     const std::string &color);
   [[nodiscard]] bool hasCharacter(const std::string &id) const;
 
-  // Serialization
+  // Serialization; fromJson returns nullptr for an invalid document
   [[nodiscard]] std::string toJson() const;
   static std::unique_ptr<IRGraph> fromJson(const std::string &json);
+  void writeJson(core::JsonWriter &writer) const;
+  static Result<std::unique_ptr<IRGraph>> readJson(core::JsonReader &reader);
+  Result<void> saveJson(const std::string &path) const;
+  static Result<std::unique_ptr<IRGraph>> loadJson(const std::string &path);
+
+  // Compact binary form for the editor's project cache (see graph_cache.hpp).
+  // @p sourceHash identifies the JSON it was made from; fromBinary fails on
+  // a damaged blob or one made from a different source
+  [[nodiscard]] std::vector<u8> toBinary(u64 sourceHash) const;
+  static Result<std::unique_ptr<IRGraph>>
+  fromBinary(const u8 *data, usize size, u64 sourceHash);
 
 private:
+  // Positions in m_connections of the edges at each node
+  struct Adjacency {
+    std::vector<u32> outgoing;
+    std::vector<u32> incoming;
+  };
+
+  // Removes the connections at @p indices, keeping the rest in order.
+  // Touches only the lists of the removed connections and of those after
+  // the first removed one, O((E - first) log degree) in all
+  void removeConnections(std::vector<u32> indices);
+
   NodeId m_nextId = 1;
   std::string m_name;
   std::unordered_map<NodeId, std::unique_ptr<IRNode>> m_nodes;
+  // In connection order, which toJson() writes out as is
   std::vector<IRConnection> m_connections;
+  std::unordered_map<NodeId, Adjacency> m_adjacency;
   std::unordered_map<std::string, NodeId> m_sceneStartNodes;
   std::unordered_map<std::string, std::pair<std::string, std::string>>
       m_characters; // id -> (name, color)
@@ -285,10 +387,9 @@ public:
   Result<Program> convert(const IRGraph &graph);
 
 private:
-  std::unique_ptr<Statement> convertNode(const IRNode *node,
-                                         const IRGraph &graph);
-  std::unique_ptr<Expression> convertToExpression(const IRNode *node,
-                                                  const IRGraph &graph);
+  StmtPtr convertNode(const IRNode *node, const IRGraph &graph,
+                      AstArena &arena);
+  ExprPtr convertToExpression(const IRNode *node, const IRGraph &graph);
 
   std::unordered_set<NodeId> m_visited;
 };
@@ -317,7 +418,7 @@ private:
 
   void indent();
   void newline();
-  void write(const std::string &text);
+  void write(std::string_view text);
 };
 
 /**
@@ -397,9 +498,20 @@ public:
   // Layout
   void autoLayout();
 
-  // Serialization
+  // Serialization; fromJson returns nullptr for an invalid document
   [[nodiscard]] std::string toJson() const;
   static std::unique_ptr<VisualGraph> fromJson(const std::string &json);
+  void writeJson(core::JsonWriter &writer) const;
+  static Result<std::unique_ptr<VisualGraph>>
+  readJson(core::JsonReader &reader);
+  Result<void> saveJson(const std::string &path) const;
+  static Result<std::unique_ptr<VisualGraph>>
+  loadJson(const std::string &path);
+
+  // Compact binary form for the editor's project cache (see graph_cache.hpp)
+  [[nodiscard]] std::vector<u8> toBinary(u64 sourceHash) const;
+  static Result<std::unique_ptr<VisualGraph>>
+  fromBinary(const u8 *data, usize size, u64 sourceHash);
 
 private:
   NodeId m_nextId = 1;
@@ -507,6 +619,19 @@ public:
   [[nodiscard]] GraphDiff diff(const VisualGraph &oldGraph,
                                const VisualGraph &newGraph) const;
 
+  /**
+   * @brief Compute the same diff, one scene at a time on @p pool
+   *
+   * Each node belongs to the first scene, in name order, whose SceneStart
+   * node reaches it; nodes no scene reaches form one more group, and an
+   * edge belongs to the group of its source. A group whose structural
+   * hash is equal on both sides is skipped without comparing its nodes.
+   * Must not be called from a worker of @p pool.
+   */
+  [[nodiscard]] GraphDiff diff(const VisualGraph &oldGraph,
+                               const VisualGraph &newGraph,
+                               core::ThreadPool &pool) const;
+
   /**
    * @brief Apply a diff to a graph
    * @param graph The graph to modify
@@ -542,6 +667,9 @@ private:
                  GraphDiff &result) const;
   void diffEdges(const VisualGraph &oldGraph, const VisualGraph &newGraph,
                  GraphDiff &result) const;
+  // Property and position changes of a node present in both graphs
+  void diffNode(const VisualGraphNode &oldNode, const VisualGraphNode &newNode,
+                GraphDiff &result) const;
   void diffNodeProperties(const VisualGraphNode &oldNode,
                           const VisualGraphNode &newNode,
                           GraphDiff &result) const;
@@ -637,6 +765,29 @@ public:
   [[nodiscard]] ValidationResult
   validateFullRoundTrip(const std::string &nmScript);
 
+  /**
+   * @brief Text round-trip result of one scene of a script
+   */
+  struct SceneResult {
+    std::string scene;
+    usize offset = 0; // Byte offset of the scene's section in the script
+    bool isValid = false;
+    bool reused = false; // Section unchanged since the last call
+    std::vector<std::string> differences;
+  };
+
+  /**
+   * @brief Validate the text round-trip of every scene of @p nmScript
+   *
+   * The script is split at its top-level declarations and each scene is
+   * round-tripped on its own, as a task on @p pool. A scene whose section
+   * text is the same as in the previous call reuses that call's verdict.
+   * Trailing blank lines of a section are not compared. Must not be called
+   * from a worker of @p pool.
+   */
+  [[nodiscard]] std::vector<SceneResult>
+  validateScenes(const std::string &nmScript, core::ThreadPool &pool);
+
   /**
    * @brief Compare two IR graphs for semantic equivalence
    */
@@ -644,9 +795,16 @@ public:
                                                 const IRGraph &b) const;
 
 private:
+  struct SceneVerdict {
+    bool isValid = false;
+    std::vector<std::string> differences;
+  };
+
   std::unique_ptr<RoundTripConverter> m_converter;
   std::unique_ptr<GraphDiffer> m_differ;
   std::unique_ptr<IDNormalizer> m_normalizer;
+  // Verdicts of the last validateScenes(), by section text
+  std::unordered_map<std::string, SceneVerdict> m_sceneVerdicts;
 };
 
 } // namespace NovelMind::scripting
@@ -57,6 +57,10 @@ public:
    * @brief Tokenize source code into a vector of tokens
    * @param source The source code string to tokenize
    * @return Result containing tokens or an error
+   *
+   * Tokens view into @p source and allocate nothing themselves, so the
+   * caller must keep the text alive while they are used; for files, hold
+   * the SourceFile the text came from.
    */
   [[nodiscard]] Result<std::vector<Token>> tokenize(std::string_view source);
 
@@ -85,7 +89,7 @@ private:
 
   Token scanToken();
   Token makeToken(TokenType type);
-  Token makeToken(TokenType type, const std::string &lexeme);
+  // Records the error and returns an Error token over the offending text
   Token errorToken(const std::string &message);
 
   Token scanString();
@@ -93,7 +97,7 @@ private:
   Token scanIdentifier();
   Token scanColorLiteral();
 
-  [[nodiscard]] TokenType identifierType(const std::string &lexeme) const;
+  [[nodiscard]] TokenType identifierType(std::string_view lexeme) const;
 
   std::string_view m_source;
   size_t m_start;
@@ -103,7 +107,8 @@ private:
   u32 m_startColumn;
 
   std::vector<LexerError> m_errors;
-  std::unordered_map<std::string, TokenType> m_keywords;
+  // Keys view the keyword string literals
+  std::unordered_map<std::string_view, TokenType> m_keywords;
 };
 
 } // namespace NovelMind::scripting
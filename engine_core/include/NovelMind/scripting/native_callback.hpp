@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file native_callback.hpp
+ * @brief Host callbacks for visual novel commands
+ *
+ * Commands (SAY, SHOW_*, PLAY_*, ...) are the only opcodes that call into
+ * the host. Their callbacks live in a fixed table indexed by opcode and
+ * receive their arguments as a span over VM-owned scratch storage, so a
+ * command dispatch does no hashing and, once the scratch has grown to the
+ * largest command, no allocation.
+ */
+
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/opcode.hpp"
+#include "NovelMind/scripting/value.hpp"
+#include <array>
+#include <functional>
+#include <span>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Arguments of a command
+ *
+ * Only valid until the callback returns or calls back into the VM (for
+ * example signalContinue()); copy any value that must outlive that.
+ */
+using NativeArgs = std::span<const Value>;
+
+using NativeCallback = std::function<void(NativeArgs)>;
+
+constexpr u8 FIRST_NATIVE_OPCODE = static_cast<u8>(OpCode::SHOW_BACKGROUND);
+constexpr u8 LAST_NATIVE_OPCODE = static_cast<u8>(OpCode::GOTO_SCENE);
+
+/**
+ * @brief Whether @p op is a command that invokes a native callback
+ */
+[[nodiscard]] constexpr bool isNativeOpCode(OpCode op) {
+  return static_cast<u8>(op) >= FIRST_NATIVE_OPCODE &&
+         static_cast<u8>(op) <= LAST_NATIVE_OPCODE &&
+         op != OpCode::SET_FLAG && op != OpCode::CHECK_FLAG;
+}
+
+/**
+ * @brief Fixed table of command callbacks indexed by opcode
+ */
+class NativeCallbackTable {
+public:
+  /**
+   * @brief Install (or, with an empty function, remove) a callback
+   * @return false if @p op is not a command opcode
+   */
+  bool set(OpCode op, NativeCallback callback) {
+    if (!isNativeOpCode(op)) {
+      return false;
+    }
+    m_entries[index(op)] = std::move(callback);
+    return true;
+  }
+
+  /**
+   * @brief Callback for @p op, or nullptr if none is installed
+   */
+  [[nodiscard]] const NativeCallback *find(OpCode op) const {
+    if (!isNativeOpCode(op)) {
+      return nullptr;
+    }
+    const NativeCallback &callback = m_entries[index(op)];
+    return callback ? &callback : nullptr;
+  }
+
+private:
+  static constexpr usize index(OpCode op) {
+    return static_cast<usize>(static_cast<u8>(op) - FIRST_NATIVE_OPCODE);
+  }
+
+  std::array<NativeCallback, LAST_NATIVE_OPCODE - FIRST_NATIVE_OPCODE + 1>
+      m_entries;
+};
+
+} // namespace NovelMind::scripting
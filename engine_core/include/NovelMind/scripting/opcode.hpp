@@ -28,6 +28,8 @@ enum class OpCode : u8 {
   STORE_VAR = 0x21,
   LOAD_GLOBAL = 0x22,
   STORE_GLOBAL = 0x23,
+  LOAD_SLOT = 0x24,  // Operand is a variable slot, not a string index
+  STORE_SLOT = 0x25, // Operand is a variable slot, not a string index
 
   // Arithmetic
   ADD = 0x30,
@@ -63,9 +65,193 @@ enum class OpCode : u8 {
   STOP_MUSIC = 0x69,
   WAIT = 0x6A,
   TRANSITION = 0x6B,
-  GOTO_SCENE = 0x6C
+  GOTO_SCENE = 0x6C,
+
+  // Superinstructions (only emitted by BytecodeOptimizer)
+  CMP_JUMP_IF_NOT = 0x70,          // operand = target << 3 | CompareOp
+  SLOT_CMP_INT_JUMP_IF_NOT = 0x71, // operand = slot << 3 | CompareOp, then
+                                   // EXTRA_ARG i32 constant, EXTRA_ARG target
+  INC_SLOT = 0x72,                 // slot = slot + 1
+  EXTRA_ARG = 0x7F // Data word of the preceding superinstruction
 };
 
+/**
+ * @brief Comparison packed into the low bits of a superinstruction operand
+ */
+enum class CompareOp : u8 { Eq = 0, Ne = 1, Lt = 2, Le = 3, Gt = 4, Ge = 5 };
+
+constexpr u32 COMPARE_OP_BITS = 3;
+
+[[nodiscard]] constexpr u32 packCompareOperand(u32 value, CompareOp op) {
+  return (value << COMPARE_OP_BITS) | static_cast<u32>(op);
+}
+
+[[nodiscard]] constexpr u32 unpackCompareValue(u32 operand) {
+  return operand >> COMPARE_OP_BITS;
+}
+
+[[nodiscard]] constexpr CompareOp unpackCompareOp(u32 operand) {
+  return static_cast<CompareOp>(operand & ((1u << COMPARE_OP_BITS) - 1));
+}
+
+/**
+ * @brief Mnemonic of an opcode, "UNKNOWN" for unassigned values
+ */
+[[nodiscard]] constexpr const char *opcodeName(OpCode op) {
+  switch (op) {
+  case OpCode::NOP:
+    return "NOP";
+  case OpCode::HALT:
+    return "HALT";
+  case OpCode::JUMP:
+    return "JUMP";
+  case OpCode::JUMP_IF:
+    return "JUMP_IF";
+  case OpCode::JUMP_IF_NOT:
+    return "JUMP_IF_NOT";
+  case OpCode::CALL:
+    return "CALL";
+  case OpCode::RETURN:
+    return "RETURN";
+  case OpCode::PUSH_INT:
+    return "PUSH_INT";
+  case OpCode::PUSH_FLOAT:
+    return "PUSH_FLOAT";
+  case OpCode::PUSH_STRING:
+    return "PUSH_STRING";
+  case OpCode::PUSH_BOOL:
+    return "PUSH_BOOL";
+  case OpCode::PUSH_NULL:
+    return "PUSH_NULL";
+  case OpCode::POP:
+    return "POP";
+  case OpCode::DUP:
+    return "DUP";
+  case OpCode::LOAD_VAR:
+    return "LOAD_VAR";
+  case OpCode::STORE_VAR:
+    return "STORE_VAR";
+  case OpCode::LOAD_GLOBAL:
+    return "LOAD_GLOBAL";
+  case OpCode::STORE_GLOBAL:
+    return "STORE_GLOBAL";
+  case OpCode::LOAD_SLOT:
+    return "LOAD_SLOT";
+  case OpCode::STORE_SLOT:
+    return "STORE_SLOT";
+  case OpCode::ADD:
+    return "ADD";
+  case OpCode::SUB:
+    return "SUB";
+  case OpCode::MUL:
+    return "MUL";
+  case OpCode::DIV:
+    return "DIV";
+  case OpCode::MOD:
+    return "MOD";
+  case OpCode::NEG:
+    return "NEG";
+  case OpCode::EQ:
+    return "EQ";
+  case OpCode::NE:
+    return "NE";
+  case OpCode::LT:
+    return "LT";
+  case OpCode::LE:
+    return "LE";
+  case OpCode::GT:
+    return "GT";
+  case OpCode::GE:
+    return "GE";
+  case OpCode::AND:
+    return "AND";
+  case OpCode::OR:
+    return "OR";
+  case OpCode::NOT:
+    return "NOT";
+  case OpCode::SHOW_BACKGROUND:
+    return "SHOW_BACKGROUND";
+  case OpCode::SHOW_CHARACTER:
+    return "SHOW_CHARACTER";
+  case OpCode::HIDE_CHARACTER:
+    return "HIDE_CHARACTER";
+  case OpCode::SAY:
+    return "SAY";
+  case OpCode::CHOICE:
+    return "CHOICE";
+  case OpCode::SET_FLAG:
+    return "SET_FLAG";
+  case OpCode::CHECK_FLAG:
+    return "CHECK_FLAG";
+  case OpCode::PLAY_SOUND:
+    return "PLAY_SOUND";
+  case OpCode::PLAY_MUSIC:
+    return "PLAY_MUSIC";
+  case OpCode::STOP_MUSIC:
+    return "STOP_MUSIC";
+  case OpCode::WAIT:
+    return "WAIT";
+  case OpCode::TRANSITION:
+    return "TRANSITION";
+  case OpCode::GOTO_SCENE:
+    return "GOTO_SCENE";
+  case OpCode::CMP_JUMP_IF_NOT:
+    return "CMP_JUMP_IF_NOT";
+  case OpCode::SLOT_CMP_INT_JUMP_IF_NOT:
+    return "SLOT_CMP_INT_JUMP_IF_NOT";
+  case OpCode::INC_SLOT:
+    return "INC_SLOT";
+  case OpCode::EXTRA_ARG:
+    return "EXTRA_ARG";
+  }
+  return "UNKNOWN";
+}
+
+/**
+ * @brief Whether the operand of @p op is a string table index
+ */
+[[nodiscard]] constexpr bool hasStringOperand(OpCode op) {
+  switch (op) {
+  case OpCode::CALL:
+  case OpCode::PUSH_STRING:
+  case OpCode::LOAD_VAR:
+  case OpCode::STORE_VAR:
+  case OpCode::LOAD_GLOBAL:
+  case OpCode::STORE_GLOBAL:
+  case OpCode::SHOW_BACKGROUND:
+  case OpCode::SHOW_CHARACTER:
+  case OpCode::HIDE_CHARACTER:
+  case OpCode::SAY:
+  case OpCode::SET_FLAG:
+  case OpCode::CHECK_FLAG:
+  case OpCode::PLAY_SOUND:
+  case OpCode::PLAY_MUSIC:
+  case OpCode::TRANSITION:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Whether the operand of @p op is a variable slot
+ */
+[[nodiscard]] constexpr bool hasSlotOperand(OpCode op) {
+  return op == OpCode::LOAD_SLOT || op == OpCode::STORE_SLOT ||
+         op == OpCode::INC_SLOT;
+}
+
+/**
+ * @brief Whether the whole operand of @p op is an instruction index
+ *
+ * Fused compare-and-branch instructions pack their target with other
+ * fields and are not included.
+ */
+[[nodiscard]] constexpr bool hasJumpTarget(OpCode op) {
+  return op == OpCode::JUMP || op == OpCode::JUMP_IF ||
+         op == OpCode::JUMP_IF_NOT || op == OpCode::GOTO_SCENE;
+}
+
 struct Instruction {
   OpCode opcode;
   u32 operand;
@@ -13,6 +13,7 @@
 #include "NovelMind/scripting/ast.hpp"
 #include "NovelMind/scripting/token.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace NovelMind::scripting {
@@ -111,13 +112,26 @@ private:
 
   // Helper parsers
   Position parsePosition();
-  std::string parseString();
-  std::vector<StmtPtr> parseStatementList();
+  std::string_view parseString();
+  AstList<StmtPtr> parseStatementList();
+
+  // Token text interned in the program's arena, escapes decoded
+  std::string_view intern(const Token &token);
+
+  // Move scratch[first..] into an arena list and pop it off the scratch
+  template <typename T>
+  AstList<T> takeList(std::vector<T> &scratch, usize first);
 
   const std::vector<Token> *m_tokens;
   size_t m_current;
   std::vector<ParseError> m_errors;
   Program m_program;
+  AstArena *m_arena; // m_program's arena while parsing
+
+  // Children of lists still being parsed; reused across parse() calls
+  std::vector<StmtPtr> m_stmtScratch;
+  std::vector<ExprPtr> m_exprScratch;
+  std::vector<ChoiceOption> m_optionScratch;
 };
 
 } // namespace NovelMind::scripting
@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @file register_bytecode.hpp
+ * @brief Register-based bytecode format for NM Script (NMSC version 2)
+ *
+ * The stack format (Instruction, one u32 operand) needs a dispatch per
+ * push, so `set x = x + 1` is four instructions and every command argument
+ * is a separate PUSH. The register format packs an opcode and up to three
+ * 8-bit register operands into one 32-bit word:
+ *
+ *   [ op:8 | A:8 | B:8 | C:8 ]      e.g. ADD A, B, C   (r[A] = r[B] + r[C])
+ *   [ op:8 | A:8 | Bx:16     ]      e.g. LOADK A, Bx   (r[A] = K[Bx])
+ *
+ * Jumps append a target word. Commands are variable length: the header's
+ * Bx holds the argument count and one operand word per argument follows,
+ * each either a register or a constant (REG_OPERAND_CONSTANT set), so a
+ * whole `say`/`show` statement is a single dispatch.
+ *
+ * Register file layout: variable slots below REG_PINNED_VARIABLES live in
+ * r[slot] so arithmetic can address them directly; r[REG_TEMP_BASE ..
+ * REG_TEMP_BASE + REG_TEMP_COUNT) are expression temporaries; any further
+ * variable slots live above 255 and are reached with LOADVAR/STOREVAR.
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/opcode.hpp"
+#include "NovelMind/scripting/value.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+constexpr u16 NMSC_VERSION_STACK = 1;
+constexpr u16 NMSC_VERSION_REGISTER = 2;
+
+constexpr u32 REG_PINNED_VARIABLES = 192;
+constexpr u32 REG_TEMP_BASE = REG_PINNED_VARIABLES;
+constexpr u32 REG_TEMP_COUNT = 64;
+constexpr u32 REG_OVERFLOW_BASE = REG_TEMP_BASE + REG_TEMP_COUNT;
+constexpr u32 REG_OPERAND_CONSTANT = 0x80000000u;
+
+enum class RegOp : u8 {
+  NOP = 0x00,
+  HALT = 0x01,
+
+  MOVE = 0x02,     // A B     r[A] = r[B]
+  LOADK = 0x03,    // A Bx    r[A] = K[Bx]
+  LOADVAR = 0x04,  // A Bx    r[A] = r[Bx]  (Bx reaches overflow variables)
+  STOREVAR = 0x05, // A Bx    r[Bx] = r[A]
+
+  ADD = 0x10, // A B C   r[A] = r[B] op r[C]
+  SUB = 0x11,
+  MUL = 0x12,
+  DIV = 0x13,
+  MOD = 0x14,
+  EQ = 0x15,
+  NE = 0x16,
+  LT = 0x17,
+  LE = 0x18,
+  GT = 0x19,
+  GE = 0x1A,
+  NOT = 0x1B, // A B     r[A] = !r[B]
+  NEG = 0x1C, // A B     r[A] = -r[B]
+
+  JMP = 0x20,      // + target word
+  JMPIF = 0x21,    // A + target word
+  JMPIFNOT = 0x22, // A + target word
+
+  // Commands: Bx = argument count, then one operand word per argument.
+  // Arguments are passed to the callback registered for the matching OpCode.
+  SHOW_BACKGROUND = 0x30,
+  SHOW_CHARACTER = 0x31, // id, position, expression
+  HIDE_CHARACTER = 0x32,
+  SAY = 0x33,    // text, speaker
+  CHOICE = 0x34, // count, option texts...; the selection is written to r[A]
+  PLAY_SOUND = 0x35,
+  PLAY_MUSIC = 0x36,
+  STOP_MUSIC = 0x37,
+  WAIT = 0x38,
+  TRANSITION = 0x39,
+  GOTO_SCENE = 0x3A // scene name, + target word after the operands
+};
+
+[[nodiscard]] constexpr u32 encodeABC(RegOp op, u32 a, u32 b, u32 c) {
+  return static_cast<u32>(op) | (a << 8) | (b << 16) | (c << 24);
+}
+
+[[nodiscard]] constexpr u32 encodeABx(RegOp op, u32 a, u32 bx) {
+  return static_cast<u32>(op) | (a << 8) | (bx << 16);
+}
+
+[[nodiscard]] constexpr RegOp decodeOp(u32 word) {
+  return static_cast<RegOp>(word & 0xFF);
+}
+[[nodiscard]] constexpr u32 decodeA(u32 word) { return (word >> 8) & 0xFF; }
+[[nodiscard]] constexpr u32 decodeB(u32 word) { return (word >> 16) & 0xFF; }
+[[nodiscard]] constexpr u32 decodeC(u32 word) { return word >> 24; }
+[[nodiscard]] constexpr u32 decodeBx(u32 word) { return word >> 16; }
+
+/**
+ * @brief Register holding a variable slot
+ */
+[[nodiscard]] constexpr u32 registerForSlot(u32 slot) {
+  return slot < REG_PINNED_VARIABLES
+             ? slot
+             : REG_OVERFLOW_BASE + (slot - REG_PINNED_VARIABLES);
+}
+
+/**
+ * @brief The stack OpCode whose callback a command invokes
+ */
+[[nodiscard]] OpCode commandOpCode(RegOp op);
+
+/**
+ * @brief Whether the instruction is a command (variable length)
+ */
+[[nodiscard]] constexpr bool isCommand(RegOp op) {
+  return static_cast<u8>(op) >= static_cast<u8>(RegOp::SHOW_BACKGROUND) &&
+         static_cast<u8>(op) <= static_cast<u8>(RegOp::GOTO_SCENE);
+}
+
+/**
+ * @brief Number of words the instruction starting at @p word occupies
+ */
+[[nodiscard]] u32 instructionWords(u32 word);
+
+/**
+ * @brief Constant pool entry; String constants index the string table
+ */
+struct RegConstant {
+  ValueType type = ValueType::Null;
+  u32 bits = 0; // i32/f32 bit pattern, bool, or string table index
+};
+
+/**
+ * @brief A program in the register format
+ */
+struct RegisterProgram {
+  std::vector<u32> code;
+  std::vector<RegConstant> constants;
+  std::vector<std::string> stringTable;
+
+  // Scene name -> word offset into code
+  std::unordered_map<std::string, u32> sceneEntryPoints;
+
+  // Slot index -> variable name; see registerForSlot()
+  std::vector<std::string> variableSlots;
+};
+
+/**
+ * @brief Serialize to an NMSC version 2 image
+ */
+[[nodiscard]] std::vector<u8>
+serializeRegisterProgram(const RegisterProgram &program);
+
+/**
+ * @brief Parse an NMSC version 2 image
+ */
+[[nodiscard]] Result<RegisterProgram>
+deserializeRegisterProgram(const std::vector<u8> &bytecode);
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,106 @@
+#pragma once
+
+/**
+ * @file register_compiler.hpp
+ * @brief Compiles NM Script AST into the register bytecode format
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/ast.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/register_bytecode.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Compiles NM Script AST into a RegisterProgram for RegisterVM
+ *
+ * Counterpart of Compiler for the register format. Expression results are
+ * written straight into their destination (a variable register or a
+ * temporary) and command arguments are encoded as operands of the command
+ * itself.
+ *
+ * Example usage:
+ * @code
+ * RegisterCompiler compiler;
+ * auto result = compiler.compile(program);
+ * if (result.isOk()) {
+ *     registerVm.load(result.value());
+ * }
+ * @endcode
+ */
+class RegisterCompiler {
+public:
+  RegisterCompiler();
+  ~RegisterCompiler();
+
+  /**
+   * @brief Compile an AST program to register bytecode
+   * @param program The parsed program AST
+   * @return Result containing the program or the first error
+   */
+  [[nodiscard]] Result<RegisterProgram> compile(const Program &program);
+
+  /**
+   * @brief Get all errors encountered during compilation
+   */
+  [[nodiscard]] const std::vector<CompileError> &getErrors() const;
+
+private:
+  void reset();
+  void emit(u32 word);
+  u32 emitJump(RegOp op, u32 reg = 0);
+  void patchJump(u32 targetWord);
+  void emitCommand(RegOp op, const std::vector<u32> &operands, u32 a = 0);
+  u32 addString(std::string_view str);
+  u32 addConstant(ValueType type, u32 bits);
+  u32 constantOperand(ValueType type, u32 bits);
+  u32 stringOperand(std::string_view str);
+  u32 floatBitsOperand(f32 value);
+  u32 addVariableSlot(std::string_view name);
+  u32 allocTemp();
+
+  void error(const std::string &message, SourceLocation loc = {});
+
+  void compileScene(const SceneDecl &decl);
+  void compileStatement(const Statement &stmt);
+  void compileTransition(const std::optional<std::string_view> &transition,
+                         const std::optional<f32> &duration);
+  void compileChoice(const ChoiceStmt &stmt);
+  void compileIf(const IfStmt &stmt);
+  void compileSet(const SetStmt &stmt);
+
+  /**
+   * @brief Compile an expression
+   * @param dest Register to write to; if empty, the result may be left in
+   *        a variable register or a fresh temporary
+   * @return The register holding the result
+   */
+  u32 compileExpression(const Expression &expr, std::optional<u32> dest);
+  u32 compileBinary(const BinaryExpr &expr, std::optional<u32> dest);
+
+  RegisterProgram m_output;
+  std::vector<CompileError> m_errors;
+
+  struct PendingJump {
+    u32 targetWord;
+    std::string targetLabel;
+  };
+  std::vector<PendingJump> m_pendingJumps;
+  std::unordered_map<std::string, u32> m_labels;
+
+  std::unordered_map<std::string, u32> m_variableSlots;
+  std::unordered_map<std::string, u32> m_strings;
+  std::unordered_map<u64, u32> m_constants;
+
+  // Next free temporary; temporaries are released in stack order
+  u32 m_nextTemp = REG_TEMP_BASE;
+};
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,94 @@
+#pragma once
+
+/**
+ * @file register_vm.hpp
+ * @brief Execution engine for the register bytecode format
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/native_callback.hpp"
+#include "NovelMind/scripting/register_bytecode.hpp"
+#include "NovelMind/scripting/vm_value.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Runs RegisterProgram bytecode
+ *
+ * Public interface mirrors VirtualMachine so ScriptInterpreter can drive
+ * either engine. Commands pass their operands to the registered callback in
+ * the order documented on RegOp; GOTO_SCENE passes the scene name.
+ *
+ * load() validates the whole program (instruction boundaries, jump targets,
+ * register and constant indices), so the run loop does no bounds checks.
+ */
+class RegisterVM {
+public:
+  using NativeCallback = scripting::NativeCallback;
+
+  RegisterVM();
+  ~RegisterVM();
+
+  Result<void> load(const RegisterProgram &program);
+  void reset();
+
+  bool step();
+  void run();
+  void pause();
+  void resume();
+
+  [[nodiscard]] bool isRunning() const;
+  [[nodiscard]] bool isPaused() const;
+  [[nodiscard]] bool isWaiting() const;
+  [[nodiscard]] bool isHalted() const;
+  [[nodiscard]] u32 getIP() const { return m_ip; }
+  [[nodiscard]] usize getStringCount() const { return m_strings.size(); }
+
+  /**
+   * @brief Variables are the registers of their slots; a variable counts as
+   *        set once it holds a non-null value
+   */
+  void setVariable(const std::string &name, Value value);
+  [[nodiscard]] Value getVariable(const std::string &name) const;
+  [[nodiscard]] bool hasVariable(const std::string &name) const;
+  [[nodiscard]] std::unordered_map<std::string, Value> getVariables() const;
+
+  void setFlag(const std::string &name, bool value);
+  [[nodiscard]] bool getFlag(const std::string &name) const;
+
+  void registerCallback(OpCode op, NativeCallback callback);
+
+  void signalContinue();
+  void signalChoice(i32 choice);
+
+private:
+  void execute(bool singleStep);
+  void invokeCommand(RegOp op, u32 header, u32 ip);
+  [[nodiscard]] const VMValue &operand(u32 word) const;
+  Result<void> validate() const;
+  u32 resolveVariableSlot(const std::string &name);
+
+  std::vector<u32> m_code;
+  std::vector<VMValue> m_constants;
+  std::vector<VMValue> m_registers;
+  std::vector<std::string> m_variableNames;
+  std::unordered_map<std::string, u32> m_variableSlots;
+  std::unordered_map<std::string, bool> m_flags;
+  NativeCallbackTable m_callbacks;
+  // Reused argument storage; see VirtualMachine::m_callbackArgs
+  std::vector<Value> m_callbackArgs;
+  StringPool m_strings;
+
+  u32 m_ip;
+  u32 m_choiceRegister;
+  bool m_running;
+  bool m_paused;
+  bool m_waiting;
+  bool m_halted;
+};
+
+} // namespace NovelMind::scripting
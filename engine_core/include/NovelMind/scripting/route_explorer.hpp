@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file route_explorer.hpp
+ * @brief Headless enumeration of every reachable story branch
+ *
+ * RouteExplorer runs ScriptRuntime with no scene, audio or dialogue systems
+ * attached. Dialogue advances immediately, waits and transitions complete
+ * at once, and at every CHOICE the runtime state is captured with
+ * saveState() and each option is explored as its own task on a
+ * work-stealing core::ThreadPool, resumed through restoreSnapshot().
+ *
+ * Choice points are deduplicated on (scene, IP, stack, variables, flags),
+ * found by hash and compared in full, so routes that converge on the same
+ * state are explored once.
+ * Unlike the editor's ScriptReferenceAnalyzer, which inspects the source
+ * statically, the coverage reported here is what the bytecode actually
+ * reaches.
+ *
+ * Example usage:
+ * @code
+ * RouteExplorer explorer;
+ * auto coverage = explorer.explore(compiledScript);
+ * for (const auto *choice : coverage.value().getDeadChoices()) {
+ *     // Report choice->instruction / choice->options as unreachable
+ * }
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include <string>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+struct RouteExplorerConfig {
+  usize threadCount = 0;          // 0 uses the hardware concurrency
+  u64 maxStates = 1'000'000;      // Stop forking after this many choice points
+  u64 maxStepsPerBranch = 1'000'000; // Cuts off loops that never reach a choice
+  std::string startScene; // Empty starts at the first scene, as start() does
+};
+
+/**
+ * @brief A CHOICE instruction and whether any route reached it
+ */
+struct ChoiceCoverage {
+  u32 instruction = 0;
+  std::string scene; // Scene whose code contains the instruction
+  std::vector<std::string> options;
+  bool reached = false;
+  u64 timesReached = 0; // Distinct states in which the choice was offered
+};
+
+struct RouteCoverage {
+  std::vector<bool> reachedInstructions; // Indexed by instruction
+  std::vector<std::string> reachedScenes;   // Sorted
+  std::vector<std::string> unreachedScenes; // Sorted
+  std::vector<ChoiceCoverage> choices;      // Every CHOICE, by instruction
+
+  u64 uniqueStates = 0;    // Choice points forked
+  u64 duplicateStates = 0; // Choice points already explored via another route
+  u64 endings = 0;         // Routes that ran to HALT
+  u64 truncatedRoutes = 0; // Routes cut off by maxStepsPerBranch
+  bool complete = true;    // false if maxStates stopped the search
+
+  f64 seconds = 0.0;
+  f64 statesPerSecond = 0.0; // All visited states (unique, duplicate, endings)
+
+  [[nodiscard]] usize getReachedInstructionCount() const;
+
+  /**
+   * @brief Choices no explored route offers to the player
+   */
+  [[nodiscard]] std::vector<const ChoiceCoverage *> getDeadChoices() const;
+};
+
+class RouteExplorer {
+public:
+  explicit RouteExplorer(RouteExplorerConfig config = {});
+
+  /**
+   * @brief Explore every route from the entry of the start scene
+   */
+  [[nodiscard]] Result<RouteCoverage> explore(const CompiledScript &script);
+
+private:
+  RouteExplorerConfig m_config;
+};
+
+} // namespace NovelMind::scripting
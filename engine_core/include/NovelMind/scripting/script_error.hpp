@@ -9,6 +9,7 @@
  */
 
 #include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/source_file.hpp"
 #include "NovelMind/scripting/token.hpp"
 #include <optional>
 #include <string>
@@ -185,6 +186,17 @@ struct ScriptError {
     return *this;
   }
 
+  /**
+   * @brief Add the line of @p file the error starts on as source context
+   */
+  ScriptError &withSource(const SourceFile &file) {
+    std::string_view line = file.getLine(span.start.line);
+    if (!line.empty()) {
+      source = std::string(line);
+    }
+    return *this;
+  }
+
   /**
    * @brief Check if this is an error (vs warning/info)
    */
@@ -316,6 +328,17 @@ public:
     return result;
   }
 
+  /**
+   * @brief Fill in source context for every error that has none yet
+   */
+  void attachSource(const SourceFile &file) {
+    for (auto &e : m_errors) {
+      if (!e.source) {
+        e.withSource(file);
+      }
+    }
+  }
+
   void clear() { m_errors.clear(); }
 
   [[nodiscard]] bool empty() const { return m_errors.empty(); }
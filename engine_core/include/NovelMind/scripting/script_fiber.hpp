@@ -0,0 +1,237 @@
+#pragma once
+
+/**
+ * @file script_fiber.hpp
+ * @brief Coroutine-based script execution
+ *
+ * A ScriptFiber is a C++20 coroutine that runs script code and suspends
+ * with co_await on dialogue input, choices, timers or the next frame.
+ * FiberScheduler owns fibers and resumes the ready ones once per update, so
+ * resuming after a SAY never recurses through the caller's stack, and many
+ * independent script contexts (the main story, ambient background scripts)
+ * share one thread.
+ *
+ * Example usage:
+ * @code
+ * ScriptFiber birdsong(audio::AudioManager &audio) {
+ *     while (true) {
+ *         co_await WaitForSeconds{5.0};
+ *         audio.playSound("birds");
+ *     }
+ * }
+ *
+ * FiberScheduler scheduler;
+ * scheduler.spawn(birdsong(audio));
+ * scheduler.spawn(runVirtualMachine(storyVm));
+ * scheduler.update(deltaTime); // from the game loop
+ * @endcode
+ */
+
+#include "NovelMind/core/types.hpp"
+#include <coroutine>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+class VirtualMachine;
+
+/**
+ * @brief What a suspended fiber is waiting for
+ */
+enum class FiberWait : u8 {
+  Start,     // Spawned, not yet run
+  NextFrame, // Resume on the next update
+  Input,     // Resume after signalInput()
+  Choice,    // Resume after signalChoice()
+  Timer      // Resume once the timer has elapsed
+};
+
+/**
+ * @brief Coroutine return type for script fibers
+ *
+ * Fibers start suspended and only run when resumed by a FiberScheduler.
+ * Move-only; destroying a ScriptFiber destroys its coroutine frame.
+ */
+class ScriptFiber {
+public:
+  struct promise_type {
+    FiberWait wait = FiberWait::Start;
+    bool signaled = false;
+    f64 timer = 0.0;
+    i32 choice = -1;
+
+    ScriptFiber get_return_object();
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept;
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  ScriptFiber() = default;
+  ScriptFiber(ScriptFiber &&other) noexcept;
+  ScriptFiber &operator=(ScriptFiber &&other) noexcept;
+  ScriptFiber(const ScriptFiber &) = delete;
+  ScriptFiber &operator=(const ScriptFiber &) = delete;
+  ~ScriptFiber();
+
+  [[nodiscard]] bool valid() const { return static_cast<bool>(m_handle); }
+  [[nodiscard]] bool done() const { return !m_handle || m_handle.done(); }
+  [[nodiscard]] promise_type &promise() { return m_handle.promise(); }
+  [[nodiscard]] const promise_type &promise() const {
+    return m_handle.promise();
+  }
+
+  /**
+   * @brief Run the fiber until its next suspension point
+   */
+  void resume();
+
+private:
+  explicit ScriptFiber(Handle handle) : m_handle(handle) {}
+
+  Handle m_handle;
+};
+
+/**
+ * @brief Suspend until the next scheduler update
+ */
+struct NextFrame {
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+  void await_suspend(ScriptFiber::Handle handle) const noexcept {
+    handle.promise().wait = FiberWait::NextFrame;
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Suspend until FiberScheduler::signalInput() (dialogue advanced)
+ */
+struct WaitForInput {
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+  void await_suspend(ScriptFiber::Handle handle) const noexcept {
+    handle.promise().wait = FiberWait::Input;
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Suspend until FiberScheduler::signalChoice(); yields the choice
+ */
+struct WaitForChoice {
+  ScriptFiber::Handle handle;
+
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+  void await_suspend(ScriptFiber::Handle h) noexcept {
+    handle = h;
+    handle.promise().wait = FiberWait::Choice;
+  }
+  [[nodiscard]] i32 await_resume() const noexcept {
+    return handle.promise().choice;
+  }
+};
+
+/**
+ * @brief Suspend for a number of seconds of scheduler time
+ */
+struct WaitForSeconds {
+  f64 seconds = 0.0;
+
+  [[nodiscard]] bool await_ready() const noexcept { return seconds <= 0.0; }
+  void await_suspend(ScriptFiber::Handle handle) const noexcept {
+    handle.promise().wait = FiberWait::Timer;
+    handle.promise().timer = seconds;
+  }
+  void await_resume() const noexcept {}
+};
+
+using FiberId = u32;
+constexpr FiberId INVALID_FIBER_ID = 0;
+
+/**
+ * @brief Owns script fibers and resumes the ready ones
+ *
+ * Single-threaded: call every method from the thread that calls update().
+ * Fibers may spawn, signal or cancel fibers (including themselves) while
+ * they run.
+ */
+class FiberScheduler {
+public:
+  FiberScheduler();
+  ~FiberScheduler();
+
+  FiberScheduler(const FiberScheduler &) = delete;
+  FiberScheduler &operator=(const FiberScheduler &) = delete;
+
+  /**
+   * @brief Take ownership of a fiber; it first runs on the next update()
+   * @return Id of the fiber, or INVALID_FIBER_ID if @p fiber is empty
+   */
+  FiberId spawn(ScriptFiber fiber);
+
+  /**
+   * @brief Advance timers and resume every ready fiber once
+   *
+   * Fibers spawned during the update first run on the following one.
+   */
+  void update(f64 deltaTime);
+
+  /**
+   * @brief Wake a fiber suspended on WaitForInput
+   * @return false if the fiber does not exist or is not waiting for input
+   */
+  bool signalInput(FiberId id);
+
+  /**
+   * @brief Wake a fiber suspended on WaitForChoice with the selection
+   * @return false if the fiber does not exist or is not waiting for a choice
+   */
+  bool signalChoice(FiberId id, i32 choice);
+
+  /**
+   * @brief Destroy a fiber without resuming it
+   */
+  bool cancel(FiberId id);
+
+  /**
+   * @brief Destroy all fibers
+   */
+  void clear();
+
+  [[nodiscard]] bool isAlive(FiberId id) const;
+
+  /**
+   * @brief What the fiber is suspended on (Start for unknown ids)
+   */
+  [[nodiscard]] FiberWait getWait(FiberId id) const;
+
+  [[nodiscard]] usize size() const;
+
+private:
+  struct Entry {
+    FiberId id;
+    ScriptFiber fiber;
+    bool cancelled;
+  };
+
+  [[nodiscard]] Entry *find(FiberId id);
+  [[nodiscard]] const Entry *find(FiberId id) const;
+  void collect();
+
+  std::vector<Entry> m_fibers;
+  FiberId m_nextId = 1;
+  bool m_updating = false;
+};
+
+/**
+ * @brief Drive a VirtualMachine as a fiber
+ *
+ * Runs the VM until it suspends, then waits for the matching event: SAY
+ * waits for input, CHOICE for a choice (stored back into the VM) and WAIT
+ * for its duration. Finishes when the VM halts. The VM must outlive the
+ * fiber.
+ */
+[[nodiscard]] ScriptFiber runVirtualMachine(VirtualMachine &vm);
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,171 @@
+#pragma once
+
+/**
+ * @file script_image.hpp
+ * @brief Memory-mappable compiled script format (NMSC version 3)
+ *
+ * A script image is laid out so it can be mapped and used in place, with
+ * no per-instruction or per-string decoding at load time:
+ *
+ *   header       64 bytes: magic "NMSC", version 3, counts and the offset
+ *                of every section below
+ *   instructions Instruction[count], 8-byte aligned; the VM reads them
+ *                straight from the mapping
+ *   strings      {offset, length} per string table entry
+ *   slots        {offset, length} per variable slot name
+ *   scenes       {name offset, name length, entry, end} per scene, sorted
+ *                by entry point, then a u32 permutation sorted by name
+ *   characters   {id, display name, color, default sprite} string refs
+ *   line table   {instruction, line, column} per entry
+ *   string data  UTF-8 bytes every string ref points into, each followed
+ *                by a NUL
+ *
+ * All integers are little-endian. Opening an image only checks that the
+ * sections fit the file. Each scene's instructions are validated the first
+ * time it is entered (loadScene()), which is also when its pages are
+ * prefetched, so startup cost does not grow with the size of the story.
+ *
+ * Images are always linked: name-addressed LOAD_VAR/STORE_VAR accesses are
+ * resolved to variable slots when the image is written.
+ *
+ * Example usage:
+ * @code
+ * auto image = ScriptImage::open("game.nmc");
+ * auto program = VMProgram::create(image.value());
+ * vm.load(program.value()); // Scenes are validated as the VM enters them
+ * @endcode
+ */
+
+#include "NovelMind/core/mapped_file.hpp"
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/opcode.hpp"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+constexpr u16 NMSC_VERSION_IMAGE = 3;
+
+/**
+ * @brief A scene of an image and the instructions it owns
+ *
+ * A scene owns the instructions from its entry point up to the next
+ * scene's entry point; the last scene also owns any global statements.
+ */
+struct ImageScene {
+  std::string_view name;
+  u32 entry = 0;
+  u32 end = 0;
+};
+
+/**
+ * @brief Write @p script as a script image
+ */
+[[nodiscard]] std::vector<u8> serializeScriptImage(const CompiledScript &script);
+
+class ScriptImage;
+using ScriptImagePtr = std::shared_ptr<const ScriptImage>;
+
+class ScriptImage {
+public:
+  ~ScriptImage();
+
+  ScriptImage(const ScriptImage &) = delete;
+  ScriptImage &operator=(const ScriptImage &) = delete;
+
+  /**
+   * @brief Map an image file
+   */
+  [[nodiscard]] static Result<ScriptImagePtr> open(const std::string &path);
+
+  /**
+   * @brief Use an image already in memory
+   */
+  [[nodiscard]] static Result<ScriptImagePtr> fromBytes(std::vector<u8> bytes);
+
+  [[nodiscard]] std::span<const Instruction> getInstructions() const {
+    return {m_code, m_codeSize};
+  }
+
+  [[nodiscard]] u32 getStringCount() const { return m_stringCount; }
+  [[nodiscard]] std::string_view getString(u32 index) const;
+
+  [[nodiscard]] u32 getVariableSlotCount() const { return m_slotCount; }
+  [[nodiscard]] std::string_view getVariableSlot(u32 slot) const;
+
+  [[nodiscard]] u32 getSceneCount() const { return m_sceneCount; }
+
+  /**
+   * @brief Scene by index; indices follow entry-point order
+   */
+  [[nodiscard]] ImageScene getScene(u32 index) const;
+
+  [[nodiscard]] std::optional<u32> findScene(std::string_view name) const;
+
+  /**
+   * @brief Scene owning @p instruction, or nullopt for code before the
+   *        first scene
+   */
+  [[nodiscard]] std::optional<u32> findSceneAt(u32 instruction) const;
+
+  /**
+   * @brief Validate a scene's instructions and prefetch them
+   *
+   * Only the first call per scene does any work; the outcome is cached.
+   * Safe to call from several threads.
+   */
+  Result<void> loadScene(u32 index) const;
+
+  [[nodiscard]] bool isSceneLoaded(u32 index) const;
+  [[nodiscard]] usize getLoadedSceneCount() const;
+
+  [[nodiscard]] u32 getCharacterCount() const { return m_characterCount; }
+  [[nodiscard]] CompiledCharacter getCharacter(u32 index) const;
+
+  [[nodiscard]] std::vector<LineTableEntry> getLineTable() const;
+
+  /**
+   * @brief Decode the whole image, for tools that need a CompiledScript
+   */
+  [[nodiscard]] CompiledScript toCompiledScript() const;
+
+private:
+  ScriptImage() = default;
+
+  Result<void> bind(const u8 *data, usize size);
+  [[nodiscard]] std::string_view stringAt(const u8 *ref) const;
+  [[nodiscard]] Result<void> validateRange(u32 begin, u32 end) const;
+
+  core::MappedFilePtr m_file;
+  std::vector<u8> m_bytes;
+  const u8 *m_data = nullptr;
+  usize m_size = 0;
+
+  const Instruction *m_code = nullptr;
+  u32 m_codeSize = 0;
+  u32 m_stringCount = 0;
+  u32 m_slotCount = 0;
+  u32 m_sceneCount = 0;
+  u32 m_characterCount = 0;
+  u32 m_lineCount = 0;
+  const u8 *m_stringIndex = nullptr;
+  const u8 *m_slotIndex = nullptr;
+  const u8 *m_sceneIndex = nullptr;
+  const u8 *m_sceneNameOrder = nullptr;
+  const u8 *m_characters = nullptr;
+  const u8 *m_lineTable = nullptr;
+  const u8 *m_stringData = nullptr;
+  u32 m_stringDataSize = 0;
+
+  // Per scene: 0 = not loaded, 1 = valid, 2 = invalid
+  std::unique_ptr<std::atomic<u8>[]> m_sceneStates;
+};
+
+} // namespace NovelMind::scripting
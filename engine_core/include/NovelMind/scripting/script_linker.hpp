@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @file script_linker.hpp
+ * @brief Links per-file bytecode fragments into one CompiledScript
+ *
+ * The result has the layout Compiler::compile() gives the concatenation of
+ * the files: the scene code of every fragment in order, then the global
+ * statements of every fragment in order, then a single HALT. String and
+ * variable-slot operands are renumbered into merged tables and external
+ * jumps are bound to the scenes the other fragments declare.
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Link @p fragments, in order, into one script
+ *
+ * Fails on an external jump to a scene no fragment declares and on
+ * optimized superinstructions, which fragments never contain.
+ */
+[[nodiscard]] Result<CompiledScript>
+linkFragments(const std::vector<const ScriptFragment *> &fragments);
+
+} // namespace NovelMind::scripting
@@ -22,6 +22,8 @@
 #include "NovelMind/scene/scene_manager.hpp"
 #include "NovelMind/scene/transition.hpp"
 #include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/script_fiber.hpp"
+#include "NovelMind/scripting/script_image.hpp"
 #include "NovelMind/scripting/vm.hpp"
 #include <functional>
 #include <memory>
@@ -49,6 +51,14 @@ enum class RuntimeState : u8 {
   Halted             // Execution complete
 };
 
+/**
+ * @brief How the runtime drives the VM
+ */
+enum class ExecutionMode : u8 {
+  Stepped, // update() steps the VM; input re-enters it via signalContinue()
+  Fibers   // The story runs as a fiber resumed by the runtime's scheduler
+};
+
 /**
  * @brief Event types for script callbacks
  */
@@ -96,14 +106,19 @@ struct RuntimeConfig {
  */
 struct RuntimeSaveState {
   std::string currentScene;
-  u32 instructionPointer;
+  u32 instructionPointer = 0;
   std::unordered_map<std::string, Value> variables;
   std::unordered_map<std::string, bool> flags;
 
+  // Exact execution point, used by restoreSnapshot(); only meaningful for
+  // the compiled script it was saved from
+  std::vector<Value> stack;
+  std::vector<std::string> pendingChoices; // Options of an open CHOICE
+
   // Scene state
   std::vector<std::string> visibleCharacters;
   std::string currentBackground;
-  bool inDialogue;
+  bool inDialogue = false;
 };
 
 /**
@@ -148,6 +163,19 @@ public:
    */
   Result<void> load(const CompiledScript &script);
 
+  /**
+   * @brief Load a script with a program already linked from it
+   *
+   * Runtimes loaded with the same @p program share its instructions and
+   * strings; only the scene and character tables are copied.
+   */
+  Result<void> load(const CompiledScript &script, VMProgramPtr program);
+
+  /**
+   * @brief Load a script image; scenes are validated as they are entered
+   */
+  Result<void> load(ScriptImagePtr image);
+
   /**
    * @brief Set the scene manager for character/background commands
    */
@@ -285,9 +313,25 @@ public:
 
   /**
    * @brief Load state
+   *
+   * Restores variables and flags and restarts the saved scene. Survives a
+   * recompile of the script (hot reload); see restoreSnapshot() to resume
+   * at the exact saved instruction instead.
    */
   Result<void> loadState(const RuntimeSaveState &state);
 
+  /**
+   * @brief Resume exactly where saveState() was called
+   *
+   * Replaces all variables and flags, then restores the IP, the VM stack
+   * and a pending dialogue line or choice, so a state saved at a CHOICE can
+   * be restored any number of times to take each option. A pending WAIT is
+   * restored as elapsed. Requires the same compiled script that was running
+   * when the state was saved; the story restarts in Stepped mode semantics
+   * (no fiber is spawned).
+   */
+  Result<void> restoreSnapshot(const RuntimeSaveState &state);
+
   /**
    * @brief Register event callback
    */
@@ -298,22 +342,40 @@ public:
    */
   [[nodiscard]] VirtualMachine &getVM();
 
+  /**
+   * @brief Select how the story is executed; takes effect on the next
+   *        start() or gotoScene()
+   */
+  void setExecutionMode(ExecutionMode mode);
+  [[nodiscard]] ExecutionMode getExecutionMode() const;
+
+  /**
+   * @brief Scheduler resumed by update() in both execution modes
+   *
+   * Additional fibers (ambient scripts, other VM contexts via
+   * runVirtualMachine()) can be spawned here and run alongside the story.
+   */
+  [[nodiscard]] FiberScheduler &getScheduler();
+
 private:
   // VM callback handlers
-  void onShowBackground(const std::vector<Value> &args);
-  void onShowCharacter(const std::vector<Value> &args);
-  void onHideCharacter(const std::vector<Value> &args);
-  void onSay(const std::vector<Value> &args);
-  void onChoice(const std::vector<Value> &args);
-  void onGotoScene(const std::vector<Value> &args);
-  void onWait(const std::vector<Value> &args);
-  void onPlaySound(const std::vector<Value> &args);
-  void onPlayMusic(const std::vector<Value> &args);
-  void onStopMusic(const std::vector<Value> &args);
-  void onTransition(const std::vector<Value> &args);
+  void onShowBackground(NativeArgs args);
+  void onShowCharacter(NativeArgs args);
+  void onHideCharacter(NativeArgs args);
+  void onSay(NativeArgs args);
+  void onChoice(NativeArgs args);
+  void onGotoScene(NativeArgs args);
+  void onWait(NativeArgs args);
+  void onPlaySound(NativeArgs args);
+  void onPlayMusic(NativeArgs args);
+  void onStopMusic(NativeArgs args);
+  void onTransition(NativeArgs args);
 
   // Internal helpers
+  // Install the tables and program of a load()
+  Result<void> attach(CompiledScript tables, VMProgramPtr program);
   void registerCallbacks();
+  ScriptFiber runStory();
   void fireEvent(ScriptEventType type, const std::string &name = "",
                  const Value &value = Value{});
 
@@ -326,9 +388,11 @@ private:
   std::unique_ptr<Scene::ITransition> createTransition(const std::string &type,
                                                        f32 duration);
 
-  // VM and compiled script
+  // VM, and the scene and character tables of the compiled script
   VirtualMachine m_vm;
   CompiledScript m_script;
+  // Linked once per load(); gotoScene() reloads it without copying
+  VMProgramPtr m_program;
 
   // Connected systems
   scene::SceneManager *m_sceneManager = nullptr;
@@ -356,6 +420,11 @@ private:
   // Skip mode
   bool m_skipMode = false;
 
+  // Fiber execution
+  ExecutionMode m_executionMode = ExecutionMode::Stepped;
+  FiberScheduler m_scheduler;
+  FiberId m_storyFiber = INVALID_FIBER_ID;
+
   // Event callback
   EventCallback m_eventCallback;
 };
@@ -364,7 +433,7 @@ private:
  * @brief Helper to create a character sprite from script data
  */
 [[nodiscard]] inline std::unique_ptr<Scene::CharacterSprite>
-createCharacterFromDecl(const CharacterDecl &decl) {
+createCharacterFromDecl(const CompiledCharacter &decl) {
   auto sprite = std::make_unique<Scene::CharacterSprite>(decl.id, decl.id);
   sprite->setDisplayName(decl.displayName);
 
@@ -0,0 +1,76 @@
+#pragma once
+
+/**
+ * @file source_file.hpp
+ * @brief Immutable, shared NM Script source text
+ *
+ * Tokens produced by the Lexer view directly into the text they were
+ * scanned from instead of owning a copy. A SourceFile is the buffer that
+ * keeps those views valid: hold a SourceFilePtr for as long as any token,
+ * or diagnostic that refers back into the text, is in use.
+ *
+ * Example usage:
+ * @code
+ * auto file = SourceFile::load("chapter1.nms");
+ * Lexer lexer;
+ * auto tokens = lexer.tokenize(file.value()->getText());
+ * // tokens[i].lexeme points into file.value()'s buffer
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/token.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+class SourceFile;
+using SourceFilePtr = std::shared_ptr<const SourceFile>;
+
+class SourceFile {
+public:
+  /**
+   * @brief Take ownership of in-memory source text
+   * @param path Name used in diagnostics; need not exist on disk
+   */
+  [[nodiscard]] static SourceFilePtr create(std::string text,
+                                            std::string path = {});
+
+  /**
+   * @brief Read a source file from disk
+   */
+  [[nodiscard]] static Result<SourceFilePtr> load(const std::string &path);
+
+  [[nodiscard]] const std::string &getPath() const { return m_path; }
+  [[nodiscard]] std::string_view getText() const { return m_text; }
+  [[nodiscard]] usize size() const { return m_text.size(); }
+
+  [[nodiscard]] u32 getLineCount() const {
+    return static_cast<u32>(m_lineStarts.size());
+  }
+
+  /**
+   * @brief Text of a 1-based line, without its line terminator
+   *
+   * Empty if @p line is out of range.
+   */
+  [[nodiscard]] std::string_view getLine(u32 line) const;
+
+  /**
+   * @brief Byte offset of a line/column location, clamped to the text
+   */
+  [[nodiscard]] usize getOffset(SourceLocation location) const;
+
+private:
+  SourceFile(std::string text, std::string path);
+
+  std::string m_text;
+  std::string m_path;
+  std::vector<u32> m_lineStarts; // Offset of the first byte of each line
+};
+
+} // namespace NovelMind::scripting
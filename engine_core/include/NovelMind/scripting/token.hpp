@@ -10,6 +10,7 @@
 
 #include "NovelMind/core/types.hpp"
 #include <string>
+#include <string_view>
 
 namespace NovelMind::scripting {
 
@@ -96,12 +97,26 @@ struct SourceLocation {
   SourceLocation(u32 l, u32 c) : line(l), column(c) {}
 };
 
+/**
+ * @brief Decode the escape sequences of a string literal's raw contents
+ *
+ * Expects contents the Lexer has already accepted; unknown escapes are
+ * copied through unchanged.
+ */
+[[nodiscard]] std::string decodeStringLiteral(std::string_view raw);
+
 /**
  * @brief Represents a token in the NM Script language
+ *
+ * The lexeme is a view into the source text the token was scanned from
+ * (see SourceFile); the token is only valid while that text is alive.
+ * String literals view their raw contents between the quotes, so use
+ * text() to get the value with escapes decoded.
  */
 struct Token {
   TokenType type;
-  std::string lexeme;
+  bool escaped = false; // String literal containing escape sequences
+  std::string_view lexeme;
   SourceLocation location;
 
   // Literal values (for performance, avoid variant overhead)
@@ -112,8 +127,15 @@ struct Token {
 
   Token() : type(TokenType::EndOfFile), lexeme(), location(), intValue(0) {}
 
-  Token(TokenType t, std::string lex, SourceLocation loc)
-      : type(t), lexeme(std::move(lex)), location(loc), intValue(0) {}
+  Token(TokenType t, std::string_view lex, SourceLocation loc)
+      : type(t), lexeme(lex), location(loc), intValue(0) {}
+
+  /**
+   * @brief Owned copy of the token's text, with string escapes decoded
+   */
+  [[nodiscard]] std::string text() const {
+    return escaped ? decodeStringLiteral(lexeme) : std::string(lexeme);
+  }
 
   [[nodiscard]] bool isKeyword() const {
     return type >= TokenType::Character && type <= TokenType::Fade;
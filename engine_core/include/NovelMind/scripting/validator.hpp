@@ -17,6 +17,7 @@
 #include "NovelMind/scripting/ast.hpp"
 #include "NovelMind/scripting/script_error.hpp"
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -41,11 +42,38 @@ struct ValidationResult {
   ErrorList errors;
   bool isValid;
 
+  // Names resolved through the project symbols rather than the program
+  std::unordered_set<std::string> importedScenes;
+  std::unordered_set<std::string> importedCharacters;
+
+  // Names referenced but declared neither by the program nor the project
+  std::unordered_set<std::string> undefinedScenes;
+  std::unordered_set<std::string> undefinedCharacters;
+
+  // Symbol tables of the program, with every usage it makes of them
+  std::unordered_map<std::string, SymbolInfo> characters;
+  std::unordered_map<std::string, SymbolInfo> scenes;
+  std::unordered_map<std::string, SymbolInfo> variables;
+
+  // Scene -> scenes it can goto, imported ones included
+  std::unordered_map<std::string, std::unordered_set<std::string>> sceneGraph;
+
   [[nodiscard]] bool hasErrors() const { return errors.hasErrors(); }
 
   [[nodiscard]] bool hasWarnings() const { return errors.hasWarnings(); }
 };
 
+/**
+ * @brief Scenes and characters declared anywhere in a multi-file project
+ *
+ * Lets each file of a project be validated on its own: a reference that is
+ * not declared in the file is accepted if some other file declares it.
+ */
+struct ProjectSymbols {
+  std::unordered_set<std::string> scenes;
+  std::unordered_set<std::string> characters;
+};
+
 /**
  * @brief AST Validator for semantic analysis
  *
@@ -88,6 +116,23 @@ public:
    */
   void setReportDeadCode(bool report);
 
+  /**
+   * @brief Source the validated program was parsed from
+   *
+   * When set, each reported error carries its source line. Pass nullptr
+   * to stop attaching source context.
+   */
+  void setSource(SourceFilePtr source);
+
+  /**
+   * @brief Symbols declared across the project the program belongs to
+   *
+   * Reachability and unused-symbol checks need the whole project, so they
+   * are skipped while project symbols are set. Pass nullptr to validate
+   * the program as a standalone script again.
+   */
+  void setProjectSymbols(const ProjectSymbols *symbols);
+
 private:
   // Reset state for new validation
   void reset();
@@ -134,14 +179,16 @@ private:
   void reportUnusedSymbols();
 
   // Helper methods
-  void markCharacterUsed(const std::string &name, SourceLocation loc);
-  void markSceneUsed(const std::string &name, SourceLocation loc);
-  void markVariableUsed(const std::string &name, SourceLocation loc);
-  void markVariableDefined(const std::string &name, SourceLocation loc);
+  void markCharacterUsed(std::string_view name, SourceLocation loc);
+  void markSceneUsed(std::string_view name, SourceLocation loc);
+  void markVariableUsed(std::string_view name, SourceLocation loc);
+  void markVariableDefined(std::string_view name, SourceLocation loc);
+  void undefinedCharacter(std::string_view name);
+  void undefinedScene(std::string_view name, const char *context);
 
-  bool isCharacterDefined(const std::string &name) const;
-  bool isSceneDefined(const std::string &name) const;
-  bool isVariableDefined(const std::string &name) const;
+  bool isCharacterDefined(std::string_view name) const;
+  bool isSceneDefined(std::string_view name) const;
+  bool isVariableDefined(std::string_view name) const;
 
   // Error reporting
   void error(ErrorCode code, const std::string &message, SourceLocation loc);
@@ -163,9 +210,15 @@ private:
   // Configuration
   bool m_reportUnused = true;
   bool m_reportDeadCode = true;
+  SourceFilePtr m_source;
+  const ProjectSymbols *m_projectSymbols = nullptr;
 
   // Results
   ErrorList m_errors;
+  std::unordered_set<std::string> m_importedScenes;
+  std::unordered_set<std::string> m_importedCharacters;
+  std::unordered_set<std::string> m_undefinedScenes;
+  std::unordered_set<std::string> m_undefinedCharacters;
 };
 
 } // namespace NovelMind::scripting
@@ -2,24 +2,52 @@
 
 #include "NovelMind/core/result.hpp"
 #include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/native_callback.hpp"
 #include "NovelMind/scripting/opcode.hpp"
+#include "NovelMind/scripting/vm_profiler.hpp"
+#include "NovelMind/scripting/vm_program.hpp"
 #include "NovelMind/scripting/value.hpp"
-#include <functional>
+#include "NovelMind/scripting/vm_value.hpp"
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace NovelMind::scripting {
 
+/**
+ * @brief Execution loop used by VirtualMachine::run()
+ */
+enum class DispatchMode : u8 {
+  Switch,  // step() per instruction; state flags checked every instruction
+  Threaded // Pre-decoded stream; computed goto on GCC/Clang, switch elsewhere
+};
+
 class VirtualMachine {
 public:
-  using NativeCallback = std::function<void(const std::vector<Value> &)>;
+  using NativeCallback = scripting::NativeCallback;
 
   VirtualMachine();
   ~VirtualMachine();
 
+  /**
+   * @brief Link and load a program owned by this VM alone
+   *
+   * Shorthand for VMProgram::create() followed by load(VMProgramPtr); see
+   * VMProgram::create() for @p variableSlots.
+   */
   Result<void> load(const std::vector<Instruction> &program,
-                    const std::vector<std::string> &stringTable);
+                    const std::vector<std::string> &stringTable,
+                    const std::vector<std::string> &variableSlots = {});
+
+  /**
+   * @brief Load a shared program
+   *
+   * Copies nothing from the program: this VM keeps a reference and owns
+   * only its IP, stack, variables and flags. Variables already set are kept.
+   */
+  Result<void> load(VMProgramPtr program);
+
+  [[nodiscard]] const VMProgramPtr &getProgram() const { return m_program; }
   void reset();
 
   bool step();
@@ -33,32 +61,137 @@ public:
   [[nodiscard]] bool isHalted() const;
   [[nodiscard]] u32 getIP() const { return m_ip; }
 
+  void setDispatchMode(DispatchMode mode) { m_dispatchMode = mode; }
+  [[nodiscard]] DispatchMode getDispatchMode() const { return m_dispatchMode; }
+
+  /**
+   * @brief Strings held by this VM's pool, counting the program's
+   */
+  [[nodiscard]] usize getStringCount() const { return m_strings.size(); }
+
+  /**
+   * @brief Attach a profiler that records every executed instruction
+   *
+   * Not owned; pass nullptr to detach. While attached, run() steps through
+   * step() in either dispatch mode. Has no effect unless the VM was built
+   * with NOVELMIND_ENABLE_VM_PROFILER (see isProfilingAvailable()).
+   */
+  void setProfiler(VMProfiler *profiler);
+  [[nodiscard]] VMProfiler *getProfiler() const { return m_profiler; }
+  [[nodiscard]] static bool isProfilingAvailable();
+
   void setVariable(const std::string &name, Value value);
   [[nodiscard]] Value getVariable(const std::string &name) const;
   [[nodiscard]] bool hasVariable(const std::string &name) const;
+  [[nodiscard]] std::unordered_map<std::string, Value> getVariables() const;
 
   void setFlag(const std::string &name, bool value);
   [[nodiscard]] bool getFlag(const std::string &name) const;
+  [[nodiscard]] const std::unordered_map<std::string, bool> &getFlags() const {
+    return m_flags;
+  }
+
+  /**
+   * @brief Unset all variables (slots stay linked) or flags
+   */
+  void clearVariables();
+  void clearFlags();
 
+  /**
+   * @brief Operand stack, bottom first
+   */
+  [[nodiscard]] std::vector<Value> getStack() const;
+
+  /**
+   * @brief Resume from a saved execution point
+   *
+   * Replaces the IP and stack. With @p waitReason CHOICE the top of
+   * @p stack receives the selection, as if the CHOICE had just run; SAY
+   * restores a pending input wait. Any other reason restores a running VM.
+   */
+  Result<void> restoreExecution(u32 ip, const std::vector<Value> &stack,
+                                OpCode waitReason = OpCode::NOP);
+
+  /**
+   * @brief Install the host callback for a command opcode
+   *
+   * Arguments, in order:
+   *   SHOW_BACKGROUND [resource]     SHOW_CHARACTER [id, position]
+   *   HIDE_CHARACTER  [id]           SAY            [text, speaker|null]
+   *   CHOICE   [count, texts...]     GOTO_SCENE     [target IP]
+   *   WAIT     [duration f32 bits]   PLAY_SOUND/PLAY_MUSIC [resource]
+   *   STOP_MUSIC [fade f32 bits]?    TRANSITION     [type, duration f32 bits]
+   */
   void registerCallback(OpCode op, NativeCallback callback);
 
   void signalContinue();
   void signalChoice(i32 choice);
 
+  /**
+   * @brief Command the VM is waiting on (SAY, CHOICE or WAIT), NOP if none
+   */
+  [[nodiscard]] OpCode getWaitReason() const { return m_waitReason; }
+
+  /**
+   * @brief Duration in seconds of a pending WAIT, 0 otherwise
+   */
+  [[nodiscard]] f32 getWaitDuration() const;
+
+  /**
+   * @brief Clear a pending wait without resuming execution
+   *
+   * Unlike signalContinue() and signalChoice(), these never re-enter run();
+   * the caller resumes the VM itself. Used by fiber-based execution.
+   */
+  void completeWait();
+  void completeChoice(i32 choice);
+
 private:
   void executeInstruction(const Instruction &instr);
-  void push(Value value);
-  Value pop();
+  void runThreaded();
+  void invokeCallback(OpCode op, u32 operand);
+  NativeArgs collectArgs(OpCode op, u32 operand);
+  Value &scratchArg(usize index);
+  void push(VMValue value);
+  VMValue pop();
+  // After an instruction that may create a string; values on the stack and
+  // in variables are the only references to run-time strings
+  void collectStrings();
   [[nodiscard]] const std::string &getString(u32 index) const;
+  [[nodiscard]] u32 getStringHandle(u32 index) const;
+  [[nodiscard]] i32 findVariableSlot(const std::string &name) const;
+  [[nodiscard]] const std::string &getVariableName(u32 slot) const;
+  u32 resolveVariableSlot(const std::string &name);
 
-  std::vector<Instruction> m_program;
-  std::vector<std::string> m_stringTable;
-  std::vector<Value> m_stack;
-  std::unordered_map<std::string, Value> m_variables;
+  VMProgramPtr m_program;
+  std::vector<VMValue> m_stack;
+  // Program slots first, then m_localVariableNames
+  std::vector<VMValue> m_variables;
+  std::vector<bool> m_variableAssigned;
+  // Host-set variables the program does not reference
+  std::vector<std::string> m_localVariableNames;
+  std::unordered_map<std::string, u32> m_localVariableSlots;
   std::unordered_map<std::string, bool> m_flags;
-  std::unordered_map<OpCode, NativeCallback> m_callbacks;
+  NativeCallbackTable m_callbacks;
+
+  // Reused argument storage for callbacks; only ever grows so string
+  // capacity is recycled between commands
+  std::vector<Value> m_callbackArgs;
+  // Stack slot receiving the CHOICE selection, or npos when none is pending
+  usize m_choiceSlot = static_cast<usize>(-1);
+
+  // Strings created at run time, layered over the program's pool
+  StringPool m_strings;
+
+  DispatchMode m_dispatchMode = DispatchMode::Switch;
+  VMProfiler *m_profiler = nullptr;
 
   u32 m_ip;
+  // Instructions known to be valid; see VMProgram::loadRange()
+  u32 m_loadedBegin = 0;
+  u32 m_loadedEnd = 0;
+  OpCode m_waitReason = OpCode::NOP;
+  u32 m_waitOperand = 0;
   bool m_running;
   bool m_paused;
   bool m_waiting;
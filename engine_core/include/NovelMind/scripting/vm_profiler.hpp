@@ -0,0 +1,131 @@
+#pragma once
+
+/**
+ * @file vm_profiler.hpp
+ * @brief Per-opcode and per-instruction execution profile of the script VM
+ *
+ * The VM only contains profiling hooks when built with
+ * NOVELMIND_ENABLE_VM_PROFILER (on by default for Debug builds). Without it
+ * the dispatch loops carry no instrumentation at all and attaching a
+ * profiler does nothing; check VirtualMachine::isProfilingAvailable().
+ *
+ * With a profiler attached, the VM runs every instruction through step()
+ * regardless of its dispatch mode and records one execution and its
+ * wall-clock time per instruction. Command instructions include the time
+ * spent in their host callback.
+ *
+ * Example usage:
+ * @code
+ * VMProfiler profiler;
+ * vm.setProfiler(&profiler);
+ * vm.run();
+ * for (const auto &spot : profiler.getHotSpots(script.lineTable, 10)) {
+ *     // spot.location.line, spot.counter.nanoseconds, ...
+ * }
+ * profiler.exportToChromeTrace("script_profile.json", script.lineTable);
+ * @endcode
+ */
+
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/opcode.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+struct ExecutionCounter {
+  u64 count = 0;
+  u64 nanoseconds = 0;
+};
+
+/**
+ * @brief A profiled instruction
+ */
+struct HotSpot {
+  u32 instruction = 0;
+  OpCode opcode = OpCode::NOP;
+  SourceLocation location{0, 0}; // Line 0 if the line table does not cover it
+  ExecutionCounter counter;
+};
+
+/**
+ * @brief Accumulated cost of the instructions compiled from a source line
+ */
+struct SourceLineProfile {
+  SourceLocation location;
+  ExecutionCounter counter;
+};
+
+class VMProfiler {
+public:
+  void reset();
+
+  /**
+   * @brief Count one execution of @p instruction; called by the VM
+   */
+  void record(u32 instruction, OpCode op, u64 nanoseconds) {
+    ExecutionCounter &opcode = m_opcodes[static_cast<u8>(op)];
+    ++opcode.count;
+    opcode.nanoseconds += nanoseconds;
+
+    if (instruction >= m_instructions.size()) {
+      m_instructions.resize(instruction + 1);
+    }
+    InstructionProfile &profile = m_instructions[instruction];
+    profile.opcode = op;
+    ++profile.counter.count;
+    profile.counter.nanoseconds += nanoseconds;
+  }
+
+  [[nodiscard]] const ExecutionCounter &getOpcode(OpCode op) const {
+    return m_opcodes[static_cast<u8>(op)];
+  }
+
+  /**
+   * @brief Counter of one instruction (zero if it never ran)
+   */
+  [[nodiscard]] ExecutionCounter getInstruction(u32 instruction) const;
+
+  [[nodiscard]] ExecutionCounter getTotal() const;
+
+  /**
+   * @brief Executed instructions, most time first
+   * @param limit Maximum number of entries; 0 for all
+   */
+  [[nodiscard]] std::vector<HotSpot>
+  getHotSpots(const std::vector<LineTableEntry> &lineTable,
+              usize limit = 0) const;
+
+  /**
+   * @brief Instruction counters summed per source location, most time first
+   *
+   * Instructions the line table does not cover are left out.
+   */
+  [[nodiscard]] std::vector<SourceLineProfile>
+  getSourceLines(const std::vector<LineTableEntry> &lineTable) const;
+
+  /**
+   * @brief Write opcode and source line totals as Chrome trace events
+   *
+   * Same format as Core::Profiler::exportToChromeTrace(), so both load into
+   * chrome://tracing or Perfetto. Totals are laid out back to back, hottest
+   * first, on an "opcodes" and a "source lines" track; each event carries
+   * its execution count in args.
+   */
+  bool exportToChromeTrace(const std::string &filename,
+                           const std::vector<LineTableEntry> &lineTable = {})
+      const;
+
+private:
+  struct InstructionProfile {
+    OpCode opcode = OpCode::NOP;
+    ExecutionCounter counter;
+  };
+
+  std::array<ExecutionCounter, 256> m_opcodes{};
+  std::vector<InstructionProfile> m_instructions;
+};
+
+} // namespace NovelMind::scripting
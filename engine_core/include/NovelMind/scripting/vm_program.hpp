@@ -0,0 +1,210 @@
+#pragma once
+
+/**
+ * @file vm_program.hpp
+ * @brief Immutable stack bytecode program shared between VM contexts
+ *
+ * A VMProgram is everything VirtualMachine needs from a compiled script that
+ * does not change while it runs: linked instructions, the string table and
+ * its interned pool, the variable slot layout and the pre-decoded stream
+ * for the threaded loop. It is built once and shared by reference count;
+ * each VirtualMachine owns only its execution state (IP, stack, variables,
+ * flags), so loading a shared program into another VM is O(1) in program
+ * size.
+ *
+ * Nothing in a VMProgram is mutated after create(), so VMs running it may
+ * live on different threads. The one exception is the threaded stream of a
+ * program created from a ScriptImage, which is decoded on first use under a
+ * once flag.
+ *
+ * A program created from a ScriptImage executes the image's instructions in
+ * place. Its scenes are validated lazily: before running an instruction the
+ * VM asks loadRange() for the validated range containing it, which loads
+ * the owning scene the first time it is entered.
+ *
+ * Example usage:
+ * @code
+ * auto program = VMProgram::create(script.instructions, script.stringTable,
+ *                                  script.variableSlots);
+ * VirtualMachine story;
+ * VirtualMachine preview;
+ * story.load(program.value());
+ * preview.load(program.value()); // Shares instructions and strings
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/opcode.hpp"
+#include "NovelMind/scripting/script_image.hpp"
+#include "NovelMind/scripting/vm_value.hpp"
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+/**
+ * @brief Handler indices of the threaded dispatch loop
+ *
+ * Order must match the label table in VirtualMachine::runThreaded().
+ */
+enum class ThreadedHandler : u8 {
+  Nop,
+  Halt,
+  Jump,
+  JumpIf,
+  JumpIfNot,
+  PushInt,
+  PushFloat,
+  PushString,
+  PushBool,
+  PushNull,
+  Pop,
+  Dup,
+  LoadSlot,
+  StoreSlot,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Eq,
+  Ne,
+  Lt,
+  Le,
+  Gt,
+  Ge,
+  And,
+  Or,
+  Not,
+  SetFlag,
+  CheckFlag,
+  CmpJumpIfNot,
+  SlotCmpIntJumpIfNot,
+  IncSlot,
+  Callback,
+  Unknown,
+  End
+};
+
+/**
+ * @brief Instruction of the pre-decoded threaded stream
+ */
+struct ThreadedInstruction {
+  u32 operand; // Jump targets unpacked, PUSH_STRING resolved to a handle
+  u8 handler;  // ThreadedHandler
+  OpCode opcode;
+  u8 compare; // CompareOp of fused compare-and-branch instructions
+};
+
+/**
+ * @brief Half-open range of instructions that are valid to execute
+ */
+struct InstructionRange {
+  u32 begin = 0;
+  u32 end = 0;
+};
+
+class VMProgram;
+using VMProgramPtr = std::shared_ptr<const VMProgram>;
+
+class VMProgram {
+public:
+  /**
+   * @brief Link a program for execution
+   *
+   * @param variableSlots Slot index -> variable name table emitted by the
+   *        compiler for LOAD_SLOT/STORE_SLOT. Name-addressed LOAD_VAR and
+   *        STORE_VAR are resolved to slots here, so older bytecode without
+   *        a slot table runs on the same fast path.
+   */
+  [[nodiscard]] static Result<VMProgramPtr>
+  create(std::vector<Instruction> instructions,
+         std::vector<std::string> stringTable,
+         const std::vector<std::string> &variableSlots = {});
+
+  /**
+   * @brief Run a script image in place
+   *
+   * Only the image's string table and slot names are copied; instructions
+   * stay in the image, which the program keeps alive.
+   */
+  [[nodiscard]] static Result<VMProgramPtr> create(ScriptImagePtr image);
+
+  [[nodiscard]] std::span<const Instruction> getInstructions() const {
+    return m_code;
+  }
+  [[nodiscard]] u32 size() const { return static_cast<u32>(m_code.size()); }
+
+  /**
+   * @brief Validated range of instructions containing @p ip
+   *
+   * The whole program for a linked instruction vector. For an image, the
+   * scene owning @p ip, which is validated on the first call, or the code
+   * ahead of the first scene.
+   */
+  [[nodiscard]] Result<InstructionRange> loadRange(u32 ip) const;
+
+  [[nodiscard]] const ScriptImagePtr &getImage() const { return m_image; }
+
+  /**
+   * @brief Threaded stream: one entry per instruction plus an End sentinel
+   *
+   * For an image this validates every scene on first use; instructions of
+   * an invalid scene decode to End.
+   */
+  [[nodiscard]] const std::vector<ThreadedInstruction> &getThreaded() const;
+
+  [[nodiscard]] const std::vector<std::string> &getStringTable() const {
+    return m_stringTable;
+  }
+  [[nodiscard]] const std::string &getString(u32 index) const;
+
+  /**
+   * @brief Pool handle of a string table entry
+   */
+  [[nodiscard]] u32 getStringHandle(u32 index) const;
+
+  /**
+   * @brief Pool holding the string table; VMs layer their own pool on it
+   */
+  [[nodiscard]] const std::shared_ptr<const StringPool> &getStrings() const {
+    return m_strings;
+  }
+
+  /**
+   * @brief Slot index -> variable name, including resolved LOAD_VAR names
+   */
+  [[nodiscard]] const std::vector<std::string> &getVariableNames() const {
+    return m_variableNames;
+  }
+
+  /**
+   * @brief Slot of a variable, or -1 if the program does not use it
+   */
+  [[nodiscard]] i32 findVariableSlot(const std::string &name) const;
+
+private:
+  VMProgram() = default;
+
+  Result<void> link(const std::vector<std::string> &variableSlots);
+  void internStrings();
+  void decode() const;
+  u32 resolveVariableSlot(const std::string &name);
+
+  std::vector<Instruction> m_instructions; // Empty for an image
+  ScriptImagePtr m_image;
+  std::span<const Instruction> m_code;
+  mutable std::vector<ThreadedInstruction> m_threaded;
+  mutable std::once_flag m_decoded;
+  std::vector<std::string> m_stringTable;
+  std::shared_ptr<const StringPool> m_strings;
+  std::vector<u32> m_stringHandles;
+  std::vector<std::string> m_variableNames;
+  std::unordered_map<std::string, u32> m_variableSlots;
+};
+
+} // namespace NovelMind::scripting
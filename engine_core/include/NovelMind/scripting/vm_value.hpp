@@ -0,0 +1,255 @@
+#pragma once
+
+/**
+ * @file vm_value.hpp
+ * @brief Compact tagged value representation used inside the VM
+ *
+ * scripting::Value is a std::variant that owns a std::string, so every
+ * push/pop/DUP of a string copies heap memory and each stack slot is ~40
+ * bytes. VMValue is an 8-byte tag + payload; strings are handles into a
+ * StringPool owned by the VM. Conversions to and from Value happen only at
+ * the VM API boundary (variables, callbacks, save state).
+ */
+
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/scripting/opcode.hpp"
+#include "NovelMind/scripting/value.hpp"
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace NovelMind::scripting {
+
+struct VMValue;
+
+/**
+ * @brief Interned string storage addressed by dense u32 handles
+ *
+ * Equal strings always share a handle, so string equality is a handle
+ * comparison. Handle 0 is always the empty string.
+ *
+ * A pool may be layered over an immutable base pool: base handles stay
+ * valid, strings already in the base resolve to their base handle and new
+ * strings get handles after it. VMs running one shared program layer their
+ * pool over the program's, so creating a VM copies no strings.
+ */
+class StringPool {
+public:
+  StringPool();
+  explicit StringPool(std::shared_ptr<const StringPool> base);
+  StringPool(const StringPool &other);
+  StringPool &operator=(const StringPool &other);
+  StringPool(StringPool &&) = default;
+  StringPool &operator=(StringPool &&) = default;
+
+  /**
+   * @brief Get the handle for a string, adding it if not yet present
+   */
+  u32 intern(std::string_view str);
+
+  /**
+   * @brief Handle of an interned string, without adding it
+   */
+  [[nodiscard]] std::optional<u32> find(std::string_view str) const;
+
+  /**
+   * @brief Get the string for a handle (empty string if out of range)
+   */
+  [[nodiscard]] const std::string &get(u32 handle) const;
+
+  /**
+   * @brief Drop all strings except the empty string and the base pool
+   */
+  void clear();
+
+  /**
+   * @brief Keep the handles of every string interned so far
+   *
+   * For strings the program refers to by handle, e.g. register constants.
+   * collect() never drops or moves them.
+   */
+  void pin();
+
+  /**
+   * @brief True once the pool has doubled since the last collect()
+   */
+  [[nodiscard]] bool shouldCollect() const {
+    return m_strings.size() >= m_collectAt;
+  }
+
+  /**
+   * @brief Drop strings no value in @p roots refers to
+   *
+   * Strings created at run time, such as concatenation results, are only
+   * reachable from the VM's values. Live ones are renumbered and the
+   * handles in @p roots rewritten, so a loop that builds strings runs in
+   * bounded memory.
+   */
+  void collect(std::initializer_list<std::span<VMValue>> roots);
+
+  [[nodiscard]] usize size() const { return m_baseSize + m_strings.size(); }
+
+private:
+  void rebuildIndex();
+
+  std::shared_ptr<const StringPool> m_base;
+  u32 m_baseSize = 0;
+  // Local strings before this index are pinned
+  usize m_pinned = 0;
+  usize m_collectAt = 0;
+  // std::deque keeps element addresses stable, so the map can key on views
+  std::deque<std::string> m_strings;
+  std::unordered_map<std::string_view, u32> m_handles;
+};
+
+/**
+ * @brief 8-byte tagged VM value
+ */
+struct VMValue {
+  ValueType type = ValueType::Null;
+  union {
+    i32 intValue;
+    f32 floatValue;
+    bool boolValue;
+    u32 stringHandle;
+  };
+
+  VMValue() : intValue(0) {}
+
+  [[nodiscard]] static VMValue null() { return VMValue{}; }
+
+  [[nodiscard]] static VMValue fromInt(i32 value) {
+    VMValue v;
+    v.type = ValueType::Int;
+    v.intValue = value;
+    return v;
+  }
+
+  [[nodiscard]] static VMValue fromFloat(f32 value) {
+    VMValue v;
+    v.type = ValueType::Float;
+    v.floatValue = value;
+    return v;
+  }
+
+  [[nodiscard]] static VMValue fromBool(bool value) {
+    VMValue v;
+    v.type = ValueType::Bool;
+    v.boolValue = value;
+    return v;
+  }
+
+  [[nodiscard]] static VMValue fromString(u32 handle) {
+    VMValue v;
+    v.type = ValueType::String;
+    v.stringHandle = handle;
+    return v;
+  }
+
+  [[nodiscard]] bool isNull() const { return type == ValueType::Null; }
+
+  // Same conversion rules as the free functions in value.hpp
+  [[nodiscard]] i32 asInt() const {
+    switch (type) {
+    case ValueType::Int:
+      return intValue;
+    case ValueType::Float:
+      return static_cast<i32>(floatValue);
+    case ValueType::Bool:
+      return boolValue ? 1 : 0;
+    default:
+      return 0;
+    }
+  }
+
+  [[nodiscard]] f32 asFloat() const {
+    switch (type) {
+    case ValueType::Float:
+      return floatValue;
+    case ValueType::Int:
+      return static_cast<f32>(intValue);
+    case ValueType::Bool:
+      return boolValue ? 1.0f : 0.0f;
+    default:
+      return 0.0f;
+    }
+  }
+
+  [[nodiscard]] bool asBool(const StringPool &pool) const {
+    switch (type) {
+    case ValueType::Bool:
+      return boolValue;
+    case ValueType::Int:
+      return intValue != 0;
+    case ValueType::Float:
+      return floatValue != 0.0f;
+    case ValueType::String:
+      return !pool.get(stringHandle).empty();
+    default:
+      return false;
+    }
+  }
+};
+
+static_assert(sizeof(VMValue) == 8, "VMValue must stay 8 bytes");
+
+/**
+ * @brief Convert a VM value to its string form (allocates)
+ */
+[[nodiscard]] std::string toString(const VMValue &value,
+                                   const StringPool &pool);
+
+/**
+ * @brief Convert a VM value to the public Value type
+ */
+[[nodiscard]] Value toValue(const VMValue &value, const StringPool &pool);
+
+/**
+ * @brief toValue() into existing storage
+ *
+ * Reuses the string buffer when @p out already holds a string, so callback
+ * argument scratch space does not reallocate once warmed up.
+ */
+void assignValue(Value &out, const VMValue &value, const StringPool &pool);
+
+/**
+ * @brief Convert a public Value into a VM value, interning strings
+ */
+[[nodiscard]] VMValue fromValue(const Value &value, StringPool &pool);
+
+/**
+ * @brief Equality with the same semantics as comparing asString() results
+ *
+ * Matching int/bool/string/null operands are compared without allocating;
+ * mixed types and floats fall back to string comparison.
+ */
+[[nodiscard]] bool valuesEqual(const VMValue &a, const VMValue &b,
+                               const StringPool &pool);
+
+/**
+ * @brief Arithmetic shared by the VM execution engines
+ *
+ * ADD concatenates when either side is a string; otherwise any float operand
+ * makes the result a float. DIV always yields a float. Division or modulo
+ * by zero logs an error and yields 0.
+ */
+[[nodiscard]] VMValue addValues(const VMValue &a, const VMValue &b,
+                                StringPool &strings);
+[[nodiscard]] VMValue subValues(const VMValue &a, const VMValue &b);
+[[nodiscard]] VMValue mulValues(const VMValue &a, const VMValue &b);
+[[nodiscard]] VMValue divValues(const VMValue &a, const VMValue &b);
+[[nodiscard]] VMValue modValues(const VMValue &a, const VMValue &b);
+[[nodiscard]] VMValue negateValue(const VMValue &a);
+
+/**
+ * @brief Same results as the EQ..GE opcodes
+ */
+[[nodiscard]] bool compareValues(CompareOp op, const VMValue &a,
+                                 const VMValue &b, const StringPool &strings);
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * @file block_codec.hpp
+ * @brief Fast LZ block compression for pack resources
+ *
+ * Blocks use the LZ4 block layout: a run of sequences, each a token byte
+ * (literal length in the high nibble, match length in the low nibble),
+ * extra length bytes, the literals, and a two-byte little-endian offset
+ * back into the last 64 KiB of output. Decoding is a tight copy loop with
+ * no tables, which is what makes it cheap enough to run on every read.
+ *
+ * Both compressors emit the same format and share one decoder:
+ * - Fast keeps one candidate per hash slot and skips ahead faster over
+ *   data that does not match, for bulk data that is packed often.
+ * - High walks a hash chain for the longest match, trading build time for
+ *   size on text-like data that is read many times.
+ *
+ * Example usage:
+ * @code
+ * std::vector<u8> packed(BlockCodec::maxCompressedSize(data.size()));
+ * const usize size = BlockCodec::compress(data, packed, BlockCodec::Level::Fast);
+ * if (size != 0 && size < data.size()) {
+ *     packed.resize(size); // Worth storing compressed
+ * }
+ * std::vector<u8> unpacked(data.size());
+ * auto decoded = BlockCodec::decompress(packed, unpacked);
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include <span>
+
+namespace NovelMind::vfs {
+
+class BlockCodec {
+public:
+  enum class Level : u8 {
+    Fast,
+    High
+  };
+
+  /**
+   * @brief Output capacity that always fits compress() of @p size bytes
+   */
+  [[nodiscard]] static constexpr usize maxCompressedSize(usize size) {
+    return size + size / 255 + 16;
+  }
+
+  /**
+   * @brief Compress @p input into @p output
+   *
+   * @return Compressed size, or 0 if @p output is too small
+   */
+  [[nodiscard]] static usize compress(std::span<const u8> input,
+                                      std::span<u8> output, Level level);
+
+  /**
+   * @brief Decompress a block into exactly @p output.size() bytes
+   *
+   * Fails on malformed input, or if the block does not decode to exactly
+   * the size of @p output; never reads or writes out of bounds.
+   */
+  [[nodiscard]] static Result<void> decompress(std::span<const u8> input,
+                                               std::span<u8> output);
+};
+
+} // namespace NovelMind::vfs
@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * @file cache_policy.hpp
+ * @brief Eviction policies for ResourceCache
+ *
+ * Every ResourceCache shard owns one CachePolicy and calls it with the
+ * shard's lock held, so a policy needs no locking of its own. Entries are
+ * identified by the address of their ResourceId, which does not move while
+ * the entry is cached.
+ *
+ * Built-in policies:
+ * - LRU evicts the least recently used entry.
+ * - CLOCK approximates LRU with one reference bit per entry, so a hit only
+ *   sets a flag instead of reordering a list.
+ * - GDSF (Greedy-Dual-Size-Frequency) ranks entries by hits per byte, plus
+ *   an inflation term that ages entries out. It keeps many small, popular
+ *   resources over one large, rarely used one.
+ *
+ * Victims are picked among a set of resource types, which lets the cache
+ * keep per-type budgets without the policy knowing about them.
+ *
+ * The policies of one cache share a CacheClock, so the ranks they report
+ * from peek() compare across shards and the cache can evict the entry a
+ * single policy over all of it would have chosen.
+ */
+
+#include "NovelMind/vfs/resource_id.hpp"
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace NovelMind::VFS {
+
+enum class EvictionPolicy : u8 { LRU, Clock, GDSF };
+
+constexpr usize RESOURCE_TYPE_COUNT =
+    static_cast<usize>(ResourceType::Config) + 1;
+
+/**
+ * @brief Bit of @p type in the type masks passed to CachePolicy::evict()
+ */
+constexpr u32 resourceTypeBit(ResourceType type) {
+  return 1u << static_cast<u32>(type);
+}
+
+constexpr u32 ALL_RESOURCE_TYPES = (1u << RESOURCE_TYPE_COUNT) - 1;
+
+/**
+ * @brief Time and GDSF inflation shared by the policies of one cache
+ */
+struct CacheClock {
+  std::atomic<u64> tick{0};
+  std::atomic<f64> inflation{0.0};
+};
+
+class CachePolicy {
+public:
+  virtual ~CachePolicy() = default;
+
+  virtual void onInsert(const ResourceId *id, usize size) = 0;
+  virtual void onAccess(const ResourceId *id) = 0;
+  virtual void onRemove(const ResourceId *id) = 0;
+  virtual void clear() = 0;
+
+  /**
+   * @brief Choose an entry to evict and stop tracking it
+   *
+   * @param typeMask resourceTypeBit() of every type that may be evicted
+   * @return The entry, or null when no entry of those types is tracked
+   */
+  [[nodiscard]] virtual const ResourceId *evict(u32 typeMask) = 0;
+
+  /**
+   * @brief Rank of the entry the policy considers next; lower goes first
+   *
+   * Must not change any state: the cache peeks every shard but evicts from
+   * one, and the others must be left as they were.
+   *
+   * @return The rank, or nullopt when no entry of those types is tracked
+   */
+  [[nodiscard]] virtual std::optional<f64> peek(u32 typeMask) = 0;
+
+  /**
+   * @brief Spare the entry peek() ranks instead of evicting it, if it has
+   *        earned that
+   *
+   * For CLOCK, an entry used since the hand last passed it loses its
+   * reference bit and is ranked again as if just inserted. The cache calls
+   * this on the shard it is about to evict from, then ranks that shard
+   * again, so second chances are given in the order of the whole cache.
+   *
+   * @return True if an entry was spared and peek() may now differ
+   */
+  [[nodiscard]] virtual bool spareNext(u32 /*typeMask*/) { return false; }
+
+  [[nodiscard]] static std::unique_ptr<CachePolicy>
+  create(EvictionPolicy policy,
+         std::shared_ptr<CacheClock> clock = std::make_shared<CacheClock>());
+};
+
+} // namespace NovelMind::VFS
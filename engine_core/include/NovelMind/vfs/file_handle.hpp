@@ -1,5 +1,6 @@
 #pragma once
 
+#include "NovelMind/core/byte_buffer.hpp"
 #include "NovelMind/core/result.hpp"
 #include "NovelMind/core/types.hpp"
 #include <cstddef>
@@ -30,6 +31,7 @@ class MemoryFileHandle : public IFileHandle {
 public:
   MemoryFileHandle() = default;
   explicit MemoryFileHandle(std::vector<u8> data);
+  explicit MemoryFileHandle(core::ByteBuffer data);
   MemoryFileHandle(const u8 *data, usize size);
 
   [[nodiscard]] bool isValid() const override;
@@ -41,7 +43,7 @@ public:
   Result<void> seek(i64 offset, SeekOrigin origin) override;
 
 private:
-  std::vector<u8> m_data;
+  core::ByteBuffer m_data;
   usize m_position = 0;
   bool m_valid = false;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "NovelMind/vfs/file_handle.hpp"
+#include "NovelMind/vfs/pack_reader.hpp"
 #include "NovelMind/vfs/resource_id.hpp"
 #include <memory>
 #include <mutex>
@@ -18,6 +19,15 @@ public:
 
   [[nodiscard]] virtual std::unique_ptr<IFileHandle>
   open(const ResourceId &id) = 0;
+
+  /**
+   * @brief Read a whole resource
+   *
+   * Reads open() to the end by default. Backends that already hold the
+   * bytes in memory override this to share them instead of copying.
+   */
+  [[nodiscard]] virtual Result<core::ByteBuffer> read(const ResourceId &id);
+
   [[nodiscard]] virtual bool exists(const ResourceId &id) const = 0;
   [[nodiscard]] virtual std::optional<ResourceInfo>
   getInfo(const ResourceId &id) const = 0;
@@ -38,6 +48,7 @@ public:
 
   [[nodiscard]] std::unique_ptr<IFileHandle>
   open(const ResourceId &id) override;
+  [[nodiscard]] Result<core::ByteBuffer> read(const ResourceId &id) override;
   [[nodiscard]] bool exists(const ResourceId &id) const override;
   [[nodiscard]] std::optional<ResourceInfo>
   getInfo(const ResourceId &id) const override;
@@ -53,7 +64,7 @@ public:
 
 private:
   struct ResourceEntry {
-    std::vector<u8> data;
+    core::ByteBuffer data;
     ResourceInfo info;
   };
 
@@ -63,4 +74,36 @@ private:
   std::unordered_map<ResourceId, ResourceEntry> m_resources;
 };
 
+/**
+ * @brief Serves resources out of mounted pack files
+ *
+ * open() hands out PackReader::openStream() handles, so chunked music and
+ * voice tracks are decoded a chunk at a time as they are read. read()
+ * shares stored entries straight out of the pack's mapping.
+ */
+class PackBackend : public IFileSystemBackend {
+public:
+  PackBackend() = default;
+  ~PackBackend() override = default;
+
+  [[nodiscard]] std::string name() const override { return "pack"; }
+  [[nodiscard]] u32 priority() const override { return 50; }
+
+  [[nodiscard]] std::unique_ptr<IFileHandle>
+  open(const ResourceId &id) override;
+  [[nodiscard]] Result<core::ByteBuffer> read(const ResourceId &id) override;
+  [[nodiscard]] bool exists(const ResourceId &id) const override;
+  [[nodiscard]] std::optional<ResourceInfo>
+  getInfo(const ResourceId &id) const override;
+  [[nodiscard]] std::vector<ResourceId> list(ResourceType type) const override;
+
+  Result<void> mount(const std::string &packPath);
+  void unmount(const std::string &packPath);
+
+  [[nodiscard]] const vfs::PackReader &reader() const { return m_reader; }
+
+private:
+  vfs::PackReader m_reader;
+};
+
 } // namespace NovelMind::VFS
@@ -298,9 +298,9 @@ public:
   /**
    * @brief Read a resource (respecting priority)
    * @param resourceId Resource identifier
-   * @return Resource data or error
+   * @return Resource data, shared with the pack mapping when stored
    */
-  Result<std::vector<u8>> readResource(const std::string &resourceId);
+  Result<core::ByteBuffer> readResource(const std::string &resourceId);
 
   /**
    * @brief Check if a resource exists in any loaded pack
@@ -333,8 +333,8 @@ public:
   /**
    * @brief Read resource from a specific pack (bypassing priority)
    */
-  Result<std::vector<u8>> readResourceFromPack(const std::string &packId,
-                                               const std::string &resourceId);
+  Result<core::ByteBuffer> readResourceFromPack(const std::string &packId,
+                                                const std::string &resourceId);
 
   // =========================================================================
   // Mod Support
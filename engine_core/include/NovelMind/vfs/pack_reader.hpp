@@ -1,8 +1,44 @@
 #pragma once
 
+/**
+ * @file pack_reader.hpp
+ * @brief Read resources out of mounted NMRS pack files
+ *
+ * Each pack is mapped into memory once, when it is mounted, and its tables
+ * are parsed from the mapping. Reads never open the file again: readFile()
+ * copies an entry out of the mapping, readInto() decodes it into a buffer
+ * the caller owns, and readView() hands out the mapped bytes of a stored
+ * (neither compressed nor encrypted) entry without copying at all.
+ * readBuffer() returns a shared core::ByteBuffer either way: the mapped
+ * bytes of a stored entry, or the decoded bytes of any other.
+ * Compressed entries are BlockCodec blocks and are decompressed on read.
+ * openStream() reads stored and chunked entries a piece at a time, for
+ * resources too long to decode whole.
+ *
+ * The set of mounted packs is an immutable snapshot that mount() and
+ * unmount() replace. Lookups and reads work on whichever snapshot they
+ * picked up, so they take no lock and never wait for each other or for a
+ * mount in progress. A view keeps its pack's mapping alive, so it stays
+ * valid after the pack is unmounted.
+ *
+ * Example usage:
+ * @code
+ * PackReader packs;
+ * packs.mount("data/base.nmres");
+ * auto sprite = packs.readView("sprites/hero.png");
+ * if (sprite.isOk()) {
+ *     texture.upload(sprite.value().bytes);
+ * }
+ * @endcode
+ */
+
+#include "NovelMind/core/byte_buffer.hpp"
+#include "NovelMind/core/mapped_file.hpp"
+#include "NovelMind/vfs/file_handle.hpp"
 #include "NovelMind/vfs/virtual_fs.hpp"
-#include <fstream>
+#include <memory>
 #include <mutex>
+#include <span>
 #include <unordered_map>
 
 namespace NovelMind::vfs {
@@ -39,7 +75,16 @@ enum class PackFlags : u32 {
   None = 0,
   Encrypted = 1 << 0,
   Compressed = 1 << 1,
-  Signed = 1 << 2
+  Signed = 1 << 2,
+  Chunked = 1 << 3 // Entry is a chunk index and chunks, see pack_stream.hpp
+};
+
+/**
+ * @brief Bytes of one pack entry, read in place from the pack's mapping
+ */
+struct PackResourceView {
+  core::MappedFilePtr file; // Keeps the mapping alive
+  std::span<const u8> bytes;
 };
 
 class PackReader : public IVirtualFileSystem {
@@ -54,6 +99,49 @@ public:
   [[nodiscard]] Result<std::vector<u8>>
   readFile(const std::string &resourceId) const override;
 
+  /**
+   * @brief Read a resource into a buffer that can be shared without copying
+   *
+   * Stored entries point into the pack's mapping and keep it alive; other
+   * entries are decoded once into a buffer of their own.
+   */
+  [[nodiscard]] Result<core::ByteBuffer>
+  readBuffer(const std::string &resourceId) const;
+
+  /**
+   * @brief Read a resource into @p buffer, decompressing it if needed
+   *
+   * @p buffer must hold at least getInfo(id)->size bytes.
+   * @return Number of bytes written
+   */
+  [[nodiscard]] Result<usize> readInto(const std::string &resourceId,
+                                       std::span<u8> buffer) const;
+
+  /**
+   * @brief Read a stored entry without copying it
+   *
+   * Fails for entries that are compressed or encrypted, since their bytes
+   * have to be decoded before use; read those with readFile().
+   */
+  [[nodiscard]] Result<PackResourceView>
+  readView(const std::string &resourceId) const;
+
+  /**
+   * @brief Open a resource for seeking and reading in pieces
+   *
+   * Stored and chunked entries are decoded on demand, a chunk at a time;
+   * other compressed entries are decoded whole when opened. Returns null
+   * for missing, encrypted or damaged entries.
+   */
+  [[nodiscard]] std::unique_ptr<VFS::IFileHandle>
+  openStream(const std::string &resourceId) const;
+
+  /**
+   * @brief Table entry of a resource, for its flags and stored size
+   */
+  [[nodiscard]] std::optional<PackResourceEntry>
+  getEntry(const std::string &resourceId) const;
+
   [[nodiscard]] bool exists(const std::string &resourceId) const override;
 
   [[nodiscard]] std::optional<ResourceInfo>
@@ -65,21 +153,44 @@ public:
 private:
   struct MountedPack {
     std::string path;
+    core::MappedFilePtr file;
     PackHeader header;
     std::unordered_map<std::string, PackResourceEntry> entries;
     std::vector<std::string> stringTable;
   };
-
-  Result<void> readPackHeader(std::ifstream &file, PackHeader &header);
-  Result<void> readResourceTable(std::ifstream &file, MountedPack &pack);
-  Result<void> readStringTable(std::ifstream &file, MountedPack &pack);
-
-  [[nodiscard]] Result<std::vector<u8>>
-  readResourceData(const std::string &packPath,
-                   const PackResourceEntry &entry) const;
-
-  mutable std::mutex m_mutex;
-  std::unordered_map<std::string, MountedPack> m_packs;
+  using PackPtr = std::shared_ptr<const MountedPack>;
+  using PackTable = std::unordered_map<std::string, PackPtr>;
+
+  static Result<void> readPackHeader(const core::MappedFile &file,
+                                     PackHeader &header);
+  static Result<void> readResourceTable(const core::MappedFile &file,
+                                        MountedPack &pack,
+                                        std::vector<PackResourceEntry> &table);
+  static Result<void> readStringTable(const core::MappedFile &file,
+                                      MountedPack &pack);
+
+  [[nodiscard]] std::shared_ptr<const PackTable> snapshot() const;
+  void publish(std::shared_ptr<const PackTable> packs);
+
+  // Pack and entry holding @p resourceId, or a null pack
+  [[nodiscard]] std::pair<PackPtr, const PackResourceEntry *>
+  find(const std::string &resourceId) const;
+
+  [[nodiscard]] static Result<std::span<const u8>>
+  resourceBytes(const MountedPack &pack, const PackResourceEntry &entry);
+
+  // Decode a compressed or chunked, unencrypted entry into exactly @p output
+  [[nodiscard]] static Result<void> decode(const MountedPack &pack,
+                                           const PackResourceEntry &entry,
+                                           std::span<u8> output);
+
+  // decode() into a new buffer, after checking the size is plausible
+  [[nodiscard]] static Result<std::vector<u8>>
+  decodeWhole(const MountedPack &pack, const PackResourceEntry &entry,
+              const std::string &resourceId);
+
+  std::mutex m_mutex; // Serializes mount() and unmount()
+  std::shared_ptr<const PackTable> m_packs = std::make_shared<PackTable>();
 };
 
 } // namespace NovelMind::vfs
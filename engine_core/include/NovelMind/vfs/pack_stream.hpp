@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ * @file pack_stream.hpp
+ * @brief Random access into pack resources without decoding them whole
+ *
+ * Long resources such as music and voice tracks can be packed as a run of
+ * independently compressed, fixed-size chunks (PackFlags::Chunked). The
+ * entry's bytes start with a chunk index:
+ *
+ *   u32 chunkSize   Decoded size of every chunk but the last
+ *   u32 chunkCount
+ *   u64 chunkEnd[chunkCount]  End of each chunk, from the end of the index
+ *
+ * followed by the chunks. A chunk whose stored size equals its decoded
+ * size is stored as is; any other chunk is a BlockCodec block.
+ *
+ * PackStream reads such an entry as an IFileHandle: it decodes only the
+ * chunk under the read position into one chunk-sized buffer, so seeking
+ * anywhere in a long track costs one chunk of work and memory. Stored
+ * entries are streamed straight out of the pack's mapping.
+ *
+ * Example usage:
+ * @code
+ * auto stream = packs.openStream("music/theme.wav");
+ * stream->seek(static_cast<i64>(secondsToBytes(95.0)));
+ * auto samples = stream->readBytes(4096);
+ * @endcode
+ */
+
+#include "NovelMind/core/mapped_file.hpp"
+#include "NovelMind/vfs/block_codec.hpp"
+#include "NovelMind/vfs/file_handle.hpp"
+#include <span>
+#include <vector>
+
+namespace NovelMind::vfs {
+
+constexpr usize PACK_DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * @brief Chunk index of a PackFlags::Chunked entry
+ */
+class PackChunkTable {
+public:
+  /**
+   * @brief Split @p data into chunks of @p chunkSize and compress each
+   *
+   * @param anyCompressed Set when at least one chunk got smaller
+   * @return The entry bytes: chunk index followed by the chunks
+   */
+  [[nodiscard]] static std::vector<u8> encode(std::span<const u8> data,
+                                              usize chunkSize,
+                                              BlockCodec::Level level,
+                                              bool &anyCompressed);
+
+  /**
+   * @brief Read and check the index of an entry decoding to @p size bytes
+   */
+  [[nodiscard]] static Result<PackChunkTable> parse(std::span<const u8> entry,
+                                                    u64 size);
+
+  [[nodiscard]] usize chunkCount() const { return m_chunkCount; }
+  [[nodiscard]] usize chunkSize() const { return m_chunkSize; }
+  [[nodiscard]] usize decodedSize(usize chunk) const;
+
+  /**
+   * @brief Decode @p chunk into @p output, which holds decodedSize(chunk)
+   */
+  [[nodiscard]] Result<void> decode(usize chunk, std::span<u8> output) const;
+
+  /**
+   * @brief Decode every chunk into @p output, which holds the whole entry
+   */
+  [[nodiscard]] Result<void> decodeAll(std::span<u8> output) const;
+
+private:
+  [[nodiscard]] u64 chunkEnd(usize chunk) const;
+
+  std::span<const u8> m_ends; // u64 per chunk, unaligned
+  std::span<const u8> m_data; // Chunk bytes after the index
+  usize m_chunkSize = 0;
+  usize m_chunkCount = 0;
+  u64 m_size = 0;
+};
+
+/**
+ * @brief Seekable handle over a stored or chunked pack entry
+ */
+class PackStream : public VFS::IFileHandle {
+public:
+  /**
+   * @brief Stream a stored entry straight from the mapping
+   */
+  PackStream(core::MappedFilePtr file, std::span<const u8> bytes);
+
+  /**
+   * @brief Stream a chunked entry of @p chunks, decoding as it goes
+   */
+  PackStream(core::MappedFilePtr file, PackChunkTable chunks);
+
+  [[nodiscard]] bool isValid() const override { return m_file != nullptr; }
+  [[nodiscard]] usize size() const override { return m_size; }
+  [[nodiscard]] usize position() const override { return m_position; }
+  [[nodiscard]] bool isEof() const override { return m_position >= m_size; }
+
+  Result<usize> read(u8 *buffer, usize count) override;
+  Result<void> seek(i64 offset, VFS::SeekOrigin origin) override;
+
+  /**
+   * @brief Bytes of decoded data the stream keeps, at most one chunk
+   */
+  [[nodiscard]] usize bufferedSize() const { return m_chunk.size(); }
+
+private:
+  static constexpr usize NO_CHUNK = static_cast<usize>(-1);
+
+  core::MappedFilePtr m_file; // Keeps the mapping alive
+  std::span<const u8> m_bytes;
+  PackChunkTable m_chunks;
+  bool m_chunked = false;
+  std::vector<u8> m_chunk; // Decoded m_loadedChunk
+  usize m_loadedChunk = NO_CHUNK;
+  usize m_size = 0;
+  usize m_position = 0;
+};
+
+} // namespace NovelMind::vfs
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file pack_writer.hpp
+ * @brief Build NMRS pack files for PackReader
+ *
+ * Lays a pack out as PackReader expects it: header, resource table, string
+ * table and the resource data, with each resource aligned (4 KiB above
+ * 4 KiB, 16 bytes otherwise) so stored entries can be used in place from
+ * the mapping.
+ *
+ * Every resource is compressed on its own with BlockCodec, at the level
+ * chosen for its ResourceType, and marked PackFlags::Compressed. Images are
+ * stored as they are by default, since their formats are already
+ * compressed. A resource that does not get smaller is stored as well, so a
+ * reader only pays for decoding where it saves space.
+ *
+ * Types with a chunk size (audio and music by default) are split into
+ * chunks compressed one by one and marked PackFlags::Chunked, so they can
+ * be streamed and seeked with PackReader::openStream(). Chunks that do not
+ * shrink are stored, which keeps already-compressed audio cheap to read.
+ *
+ * Example usage:
+ * @code
+ * PackWriter writer;
+ * writer.addResource("scripts/main.nmc", scriptBytes, ResourceType::Script);
+ * writer.addResource("bg/city.png", pngBytes, ResourceType::Texture);
+ * writer.setCompression(ResourceType::Data, PackCompression::High);
+ * auto written = writer.write("data/base.nmres");
+ * @endcode
+ */
+
+#include "NovelMind/core/result.hpp"
+#include "NovelMind/core/types.hpp"
+#include "NovelMind/vfs/pack_stream.hpp"
+#include "NovelMind/vfs/virtual_fs.hpp"
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NovelMind::vfs {
+
+enum class PackCompression : u8 {
+  None, // Store as is
+  Fast, // BlockCodec::Level::Fast
+  High  // BlockCodec::Level::High
+};
+
+class PackWriter {
+public:
+  struct Stats {
+    usize resourceCount = 0;
+    usize compressedCount = 0;  // Resources stored compressed
+    usize chunkedCount = 0;     // Resources stored in chunks
+    u64 uncompressedSize = 0;   // Resource bytes before compression
+    u64 storedSize = 0;         // Resource bytes as written
+  };
+
+  PackWriter();
+
+  /**
+   * @brief Compression used for a type when none was set
+   *
+   * None for textures, High for scripts, scenes and localization, Fast for
+   * everything else.
+   */
+  [[nodiscard]] static PackCompression defaultCompression(ResourceType type);
+
+  /**
+   * @brief Chunk size used for a type when none was set
+   *
+   * PACK_DEFAULT_CHUNK_SIZE for audio and music, 0 (whole resource) for
+   * everything else.
+   */
+  [[nodiscard]] static usize defaultChunkSize(ResourceType type);
+
+  void setCompression(ResourceType type, PackCompression compression);
+  [[nodiscard]] PackCompression getCompression(ResourceType type) const;
+
+  /**
+   * @brief Chunk resources of @p type larger than @p chunkSize; 0 disables
+   *
+   * Only applies to types that are compressed.
+   */
+  void setChunkSize(ResourceType type, usize chunkSize);
+  [[nodiscard]] usize getChunkSize(ResourceType type) const;
+
+  /**
+   * @brief Add a resource; a later resource with the same ID replaces it
+   */
+  void addResource(const std::string &resourceId, std::vector<u8> data,
+                   ResourceType type = ResourceType::Data);
+
+  void clear();
+
+  /**
+   * @brief Compress the resources and lay out the whole pack in memory
+   */
+  [[nodiscard]] Result<std::vector<u8>> build();
+
+  /**
+   * @brief build() and write the pack to @p path
+   */
+  Result<void> write(const std::string &path);
+
+  /**
+   * @brief Figures for the last build()
+   */
+  [[nodiscard]] const Stats &getStats() const { return m_stats; }
+
+private:
+  struct Resource {
+    std::string id;
+    std::vector<u8> data;
+    ResourceType type;
+  };
+
+  std::array<PackCompression, 9> m_compression;
+  std::array<usize, 9> m_chunkSize;
+  std::vector<Resource> m_resources;
+  std::unordered_map<std::string, usize> m_index; // ID to m_resources slot
+  Stats m_stats;
+};
+
+} // namespace NovelMind::vfs
@@ -1,9 +1,42 @@
 #pragma once
 
+/**
+ * @file resource_cache.hpp
+ * @brief Sharded, size-bounded cache of whole resources
+ *
+ * Entries are spread over shards by ResourceId::hash(), and each shard has
+ * its own lock and its own CachePolicy, so threads decoding assets only
+ * contend when their ids land in the same shard. Sizes are tracked across
+ * all shards. When a put() needs room, every shard's policy ranks its next
+ * victim on a clock shared by the whole cache and the lowest ranked entry
+ * goes, so the policy orders the cache as a whole. Ranking only looks at a
+ * shard, and a shard whose lock is taken is skipped rather than waited for,
+ * so an eviction holds one shard's lock at a time and never queues behind
+ * the others.
+ *
+ * A resource type can be given a budget. Its entries then only evict each
+ * other, and everything without a budget shares what is left of the cache,
+ * so a run of music tracks cannot push out the UI atlases.
+ *
+ * Example usage:
+ * @code
+ * ResourceCacheConfig config;
+ * config.maxSize = 256 * 1024 * 1024;
+ * config.policy = EvictionPolicy::GDSF;
+ * ResourceCache cache(config);
+ * cache.setTypeBudget(ResourceType::Music, 32 * 1024 * 1024);
+ * @endcode
+ */
+
+#include "NovelMind/core/byte_buffer.hpp"
 #include "NovelMind/core/types.hpp"
+#include "NovelMind/vfs/cache_policy.hpp"
 #include "NovelMind/vfs/resource_id.hpp"
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <list>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
@@ -12,7 +45,7 @@
 namespace NovelMind::VFS {
 
 struct CacheEntry {
-  std::vector<u8> data;
+  core::ByteBuffer data;
   std::chrono::steady_clock::time_point lastAccess;
   usize accessCount = 0;
 };
@@ -31,43 +64,97 @@ struct CacheStats {
   }
 };
 
+struct ResourceCacheConfig {
+  usize maxSize = 64 * 1024 * 1024;
+  usize shardCount = 16;
+  EvictionPolicy policy = EvictionPolicy::LRU;
+
+  // Overrides policy when set; called once per shard with the cache's clock
+  std::function<std::unique_ptr<CachePolicy>(std::shared_ptr<CacheClock>)>
+      policyFactory;
+};
+
 class ResourceCache {
 public:
   explicit ResourceCache(usize maxSize = 64 * 1024 * 1024);
+  explicit ResourceCache(const ResourceCacheConfig &config);
   ~ResourceCache() = default;
 
   ResourceCache(const ResourceCache &) = delete;
   ResourceCache &operator=(const ResourceCache &) = delete;
 
   void setMaxSize(usize maxSize);
-  [[nodiscard]] usize maxSize() const { return m_maxSize; }
-
-  [[nodiscard]] std::optional<std::vector<u8>> get(const ResourceId &id);
-  void put(const ResourceId &id, std::vector<u8> data);
+  [[nodiscard]] usize maxSize() const { return m_maxSize.load(); }
+
+  /**
+   * @brief Reserve @p budget bytes of the cache for @p type
+   *
+   * Entries of a type with a budget evict only each other. Budgets come
+   * out of maxSize(); 0 returns the type to the shared remainder.
+   */
+  void setTypeBudget(ResourceType type, usize budget);
+  [[nodiscard]] usize typeBudget(ResourceType type) const;
+
+  /**
+   * @brief Share a cached resource; a hit copies no bytes
+   */
+  [[nodiscard]] std::optional<core::ByteBuffer> get(const ResourceId &id);
+  void put(const ResourceId &id, core::ByteBuffer data);
   void remove(const ResourceId &id);
   void clear();
 
   [[nodiscard]] bool contains(const ResourceId &id) const;
-  [[nodiscard]] usize currentSize() const { return m_currentSize; }
-  [[nodiscard]] usize entryCount() const { return m_cache.size(); }
+  [[nodiscard]] usize currentSize() const { return m_currentSize.load(); }
+  [[nodiscard]] usize entryCount() const { return m_entryCount.load(); }
+  [[nodiscard]] usize shardCount() const { return m_shards.size(); }
 
   [[nodiscard]] CacheStats stats() const;
+  [[nodiscard]] CacheStats shardStats(usize shard) const;
+  [[nodiscard]] CacheStats typeStats(ResourceType type) const;
   void resetStats();
 
 private:
-  void evictIfNeeded(usize requiredSpace);
-  void updateAccessOrder(const ResourceId &id);
-
-  mutable std::mutex m_mutex;
-  usize m_maxSize;
-  usize m_currentSize = 0;
-
-  std::unordered_map<ResourceId, CacheEntry> m_cache;
-  std::list<ResourceId> m_accessOrder;
-  std::unordered_map<ResourceId, std::list<ResourceId>::iterator>
-      m_orderIterators;
-
-  mutable CacheStats m_stats;
+  using EntryMap = std::unordered_map<ResourceId, CacheEntry>;
+
+  // Stats are kept per shard, under its lock, so hits never share a counter
+  struct Shard {
+    mutable std::mutex mutex;
+    EntryMap entries;
+    std::unique_ptr<CachePolicy> policy;
+    CacheStats stats;
+    std::array<CacheStats, RESOURCE_TYPE_COUNT> typeStats;
+  };
+
+  // Cache-wide sizes, needed to decide when to evict
+  struct TypeCounters {
+    std::atomic<usize> size{0};
+    std::atomic<usize> budget{0};
+  };
+
+  [[nodiscard]] Shard &shardFor(const ResourceId &id) const;
+  [[nodiscard]] TypeCounters &counters(ResourceType type) const;
+
+  // Types sharing room with @p type, and how much room they have
+  [[nodiscard]] u32 partitionOf(ResourceType type) const;
+  [[nodiscard]] usize partitionSize(u32 typeMask) const;
+  [[nodiscard]] usize partitionCapacity(ResourceType type) const;
+
+  // Evict until @p required more bytes of @p type fit
+  void makeRoom(ResourceType type, usize required);
+  void enforceLimits();
+  [[nodiscard]] bool evictOne(u32 typeMask);
+
+  // Drop the entry at @p it, already gone from the shard's policy. The
+  // caller holds the shard's lock.
+  void erase(Shard &shard, EntryMap::iterator it);
+  void account(Shard &shard, ResourceType type, usize size, bool added);
+
+  std::shared_ptr<CacheClock> m_clock;
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  mutable std::array<TypeCounters, RESOURCE_TYPE_COUNT> m_types;
+  std::atomic<usize> m_maxSize;
+  std::atomic<usize> m_currentSize{0};
+  std::atomic<usize> m_entryCount{0};
 };
 
 } // namespace NovelMind::VFS
@@ -11,6 +11,8 @@ namespace NovelMind::VFS {
 
 struct VFSConfig {
   usize cacheMaxSize = 64 * 1024 * 1024;
+  usize cacheShardCount = 16;
+  EvictionPolicy cachePolicy = EvictionPolicy::LRU;
   bool enableCaching = true;
   bool enableLogging = false;
 };
@@ -38,8 +40,14 @@ public:
   void unregisterBackend(const std::string &name);
 
   [[nodiscard]] std::unique_ptr<IFileHandle> openStream(const ResourceId &id);
-  [[nodiscard]] Result<std::vector<u8>> readAll(const ResourceId &id);
-  [[nodiscard]] Result<std::vector<u8>> readAll(const std::string &id);
+  /**
+   * @brief Read a whole resource, sharing it with the cache
+   *
+   * The returned buffer and the cache entry are the same bytes, so a
+   * cache hit copies nothing and a resource is held in memory once.
+   */
+  [[nodiscard]] Result<core::ByteBuffer> readAll(const ResourceId &id);
+  [[nodiscard]] Result<core::ByteBuffer> readAll(const std::string &id);
 
   [[nodiscard]] bool exists(const ResourceId &id) const;
   [[nodiscard]] bool exists(const std::string &id) const;
@@ -49,20 +57,24 @@ public:
 
   void clearCache();
   void setCacheMaxSize(usize maxSize);
+  void setCacheTypeBudget(ResourceType type, usize budget);
   [[nodiscard]] VFSStats stats() const;
 
   using ResourceLoadCallback =
       std::function<void(const ResourceId &, bool success)>;
   void setLoadCallback(ResourceLoadCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_loadCallback = std::move(callback);
   }
 
 private:
-  [[nodiscard]] IFileSystemBackend *findBackend(const ResourceId &id) const;
+  [[nodiscard]] std::shared_ptr<IFileSystemBackend>
+  findBackend(const ResourceId &id) const;
   void sortBackendsByPriority();
 
   VFSConfig m_config;
-  std::vector<std::unique_ptr<IFileSystemBackend>> m_backends;
+  // Shared so a read can keep its backend alive outside the lock
+  std::vector<std::shared_ptr<IFileSystemBackend>> m_backends;
   std::unique_ptr<ResourceCache> m_cache;
   ResourceLoadCallback m_loadCallback;
   bool m_initialized = false;
@@ -0,0 +1,38 @@
+#include "NovelMind/core/byte_buffer.hpp"
+#include <algorithm>
+
+namespace NovelMind::core {
+
+ByteBuffer::ByteBuffer(std::vector<u8> &&bytes) {
+  if (bytes.empty()) {
+    return;
+  }
+  auto owner = std::make_shared<const std::vector<u8>>(std::move(bytes));
+  m_data = owner->data();
+  m_size = owner->size();
+  m_owner = std::move(owner);
+}
+
+ByteBuffer ByteBuffer::copyOf(std::span<const u8> bytes) {
+  return ByteBuffer(std::vector<u8>(bytes.begin(), bytes.end()));
+}
+
+ByteBuffer ByteBuffer::subspan(usize offset, usize count) const {
+  offset = std::min(offset, m_size);
+  count = std::min(count, m_size - offset);
+  ByteBuffer result;
+  if (count > 0) {
+    result.m_owner = m_owner;
+    result.m_data = m_data + offset;
+    result.m_size = count;
+  }
+  return result;
+}
+
+std::vector<u8> ByteBuffer::toVector() const { return {begin(), end()}; }
+
+bool operator==(const ByteBuffer &lhs, std::span<const u8> rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+} // namespace NovelMind::core
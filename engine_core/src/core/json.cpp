@@ -0,0 +1,586 @@
+#include "NovelMind/core/json.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace NovelMind::core {
+
+namespace {
+
+constexpr usize FLUSH_THRESHOLD = 64 * 1024;
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+void appendUtf8(std::string &out, u32 codepoint) {
+  if (codepoint < 0x80) {
+    out += static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codepoint >> 6));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codepoint >> 12));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codepoint >> 18));
+    out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+}
+
+template <typename T> void appendNumber(std::string &out, T number) {
+  char digits[32];
+  auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), number);
+  out.append(digits, static_cast<usize>(end - digits));
+}
+
+template <typename T> void appendFloat(std::string &out, T number) {
+  const usize start = out.size();
+  appendNumber(out, number);
+  if (out.find_first_of(".e", start) == std::string::npos) {
+    out += ".0";
+  }
+}
+
+} // namespace
+
+// ============================================================================
+// JsonWriter
+// ============================================================================
+
+JsonWriter::JsonWriter(std::string &out) : m_out(&out) {}
+
+JsonWriter::JsonWriter(std::ostream &out) : m_out(&m_buffer), m_stream(&out) {
+  m_buffer.reserve(FLUSH_THRESHOLD + 1024);
+}
+
+JsonWriter::~JsonWriter() { flush(); }
+
+JsonWriter &JsonWriter::beginObject() {
+  beginValue();
+  *m_out += '{';
+  m_hasMembers.push_back(false);
+  return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+  m_hasMembers.pop_back();
+  *m_out += '}';
+  maybeFlush();
+  return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() {
+  beginValue();
+  *m_out += '[';
+  m_hasMembers.push_back(false);
+  return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+  m_hasMembers.pop_back();
+  *m_out += ']';
+  maybeFlush();
+  return *this;
+}
+
+JsonWriter &JsonWriter::key(std::string_view name) {
+  beginValue();
+  writeString(name);
+  *m_out += ':';
+  m_afterKey = true;
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view text) {
+  beginValue();
+  writeString(text);
+  maybeFlush();
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(bool flag) {
+  beginValue();
+  *m_out += flag ? "true" : "false";
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(f64 number) {
+  if (!std::isfinite(number)) {
+    return nullValue();
+  }
+  beginValue();
+  appendFloat(*m_out, number);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(f32 number) {
+  if (!std::isfinite(number)) {
+    return nullValue();
+  }
+  beginValue();
+  appendFloat(*m_out, number);
+  return *this;
+}
+
+JsonWriter &JsonWriter::nullValue() {
+  beginValue();
+  *m_out += "null";
+  return *this;
+}
+
+JsonWriter &JsonWriter::writeInteger(i64 number) {
+  beginValue();
+  appendNumber(*m_out, number);
+  return *this;
+}
+
+JsonWriter &JsonWriter::writeUnsigned(u64 number) {
+  beginValue();
+  appendNumber(*m_out, number);
+  return *this;
+}
+
+void JsonWriter::flush() {
+  if (m_stream && !m_buffer.empty()) {
+    m_stream->write(m_buffer.data(),
+                    static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+  }
+}
+
+void JsonWriter::beginValue() {
+  // A value after a key belongs to that key; anything else in a container
+  // is a new member and needs a separator
+  if (m_afterKey) {
+    m_afterKey = false;
+    return;
+  }
+  if (!m_hasMembers.empty()) {
+    if (m_hasMembers.back()) {
+      *m_out += ',';
+    }
+    m_hasMembers.back() = true;
+  }
+}
+
+void JsonWriter::writeString(std::string_view text) {
+  static const char *HEX_DIGITS = "0123456789abcdef";
+  std::string &out = *m_out;
+  out += '"';
+  usize run = 0; // Start of the bytes that need no escaping
+  for (usize i = 0; i < text.size(); ++i) {
+    const auto c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(text.data() + run, i - run);
+    run = i + 1;
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    default:
+      out += "\\u00";
+      out += HEX_DIGITS[c >> 4];
+      out += HEX_DIGITS[c & 0xF];
+      break;
+    }
+  }
+  out.append(text.data() + run, text.size() - run);
+  out += '"';
+}
+
+void JsonWriter::maybeFlush() {
+  if (m_stream && m_buffer.size() >= FLUSH_THRESHOLD) {
+    flush();
+  }
+}
+
+// ============================================================================
+// JsonReader
+// ============================================================================
+
+JsonReader::JsonReader(std::string_view text) : m_text(text) {}
+
+JsonEvent JsonReader::next() {
+  if (hasError()) {
+    return JsonEvent::Error;
+  }
+  skipWhitespace();
+
+  switch (m_state) {
+  case State::Done:
+    if (m_pos < m_text.size()) {
+      return error("Unexpected text after the document");
+    }
+    return JsonEvent::End;
+
+  case State::CommaOrEnd: {
+    if (m_pos >= m_text.size()) {
+      return error("Unexpected end of document");
+    }
+    const char c = m_text[m_pos];
+    if (c == '}' || c == ']') {
+      return close(c, c == '}' ? JsonEvent::EndObject : JsonEvent::EndArray);
+    }
+    if (c != ',') {
+      return error("Expected ',' or a closing bracket");
+    }
+    ++m_pos;
+    skipWhitespace();
+    m_state = m_containers.back() == '{' ? State::Key : State::Value;
+    return next();
+  }
+
+  case State::Key:
+  case State::KeyOrEnd: {
+    if (m_state == State::KeyOrEnd && m_pos < m_text.size() &&
+        m_text[m_pos] == '}') {
+      return close('}', JsonEvent::EndObject);
+    }
+    if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+      return error("Expected a member name");
+    }
+    if (readString(JsonEvent::Key) == JsonEvent::Error) {
+      return JsonEvent::Error;
+    }
+    skipWhitespace();
+    if (m_pos >= m_text.size() || m_text[m_pos] != ':') {
+      return error("Expected ':' after a member name");
+    }
+    ++m_pos;
+    m_state = State::Value;
+    return JsonEvent::Key;
+  }
+
+  case State::ValueOrEnd:
+    if (m_pos < m_text.size() && m_text[m_pos] == ']') {
+      return close(']', JsonEvent::EndArray);
+    }
+    return readValue();
+
+  case State::Value:
+    return readValue();
+  }
+  return error("Invalid reader state");
+}
+
+void JsonReader::skipValue() {
+  usize depth = 0;
+  do {
+    switch (next()) {
+    case JsonEvent::BeginObject:
+    case JsonEvent::BeginArray:
+      ++depth;
+      break;
+    case JsonEvent::EndObject:
+    case JsonEvent::EndArray:
+      --depth;
+      break;
+    case JsonEvent::End:
+    case JsonEvent::Error:
+      return;
+    default:
+      break;
+    }
+  } while (depth > 0);
+}
+
+bool JsonReader::isInteger() const {
+  return m_string.find_first_of(".eE") == std::string_view::npos;
+}
+
+f64 JsonReader::getNumber() const {
+  f64 number = 0.0;
+  std::from_chars(m_string.data(), m_string.data() + m_string.size(), number);
+  return number;
+}
+
+i64 JsonReader::getInt() const {
+  i64 number = 0;
+  auto [end, ec] =
+      std::from_chars(m_string.data(), m_string.data() + m_string.size(), number);
+  if (ec != std::errc() || end != m_string.data() + m_string.size()) {
+    return static_cast<i64>(getNumber());
+  }
+  return number;
+}
+
+u64 JsonReader::getUint() const {
+  u64 number = 0;
+  auto [end, ec] =
+      std::from_chars(m_string.data(), m_string.data() + m_string.size(), number);
+  if (ec != std::errc() || end != m_string.data() + m_string.size()) {
+    const f64 value = getNumber();
+    return value > 0.0 ? static_cast<u64>(value) : 0;
+  }
+  return number;
+}
+
+void JsonReader::fail(const std::string &message) {
+  if (!hasError()) {
+    error(message);
+  }
+}
+
+JsonEvent JsonReader::readValue() {
+  if (m_pos >= m_text.size()) {
+    return error("Unexpected end of document");
+  }
+  switch (m_text[m_pos]) {
+  case '{':
+    ++m_pos;
+    m_containers.push_back('{');
+    m_state = State::KeyOrEnd;
+    return JsonEvent::BeginObject;
+  case '[':
+    ++m_pos;
+    m_containers.push_back('[');
+    m_state = State::ValueOrEnd;
+    return JsonEvent::BeginArray;
+  case '"':
+    return afterValue(readString(JsonEvent::String));
+  case 't':
+    m_bool = true;
+    return afterValue(readLiteral("true", JsonEvent::Bool));
+  case 'f':
+    m_bool = false;
+    return afterValue(readLiteral("false", JsonEvent::Bool));
+  case 'n':
+    return afterValue(readLiteral("null", JsonEvent::Null));
+  default:
+    return afterValue(readNumber());
+  }
+}
+
+JsonEvent JsonReader::readString(JsonEvent event) {
+  const usize start = ++m_pos; // Past the opening quote
+  usize end = start;
+  while (end < m_text.size() && m_text[end] != '"' && m_text[end] != '\\') {
+    if (static_cast<unsigned char>(m_text[end]) < 0x20) {
+      m_pos = end;
+      return error("Control character in string");
+    }
+    ++end;
+  }
+  if (end < m_text.size() && m_text[end] == '"') {
+    m_string = m_text.substr(start, end - start);
+    m_pos = end + 1;
+    return event;
+  }
+
+  // Escapes: decode into the scratch buffer
+  m_scratch.assign(m_text.data() + start, end - start);
+  m_pos = end;
+  while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+    const char c = m_text[m_pos];
+    if (static_cast<unsigned char>(c) < 0x20) {
+      return error("Control character in string");
+    }
+    if (c != '\\') {
+      m_scratch += c;
+      ++m_pos;
+      continue;
+    }
+    if (m_pos + 1 >= m_text.size()) {
+      break;
+    }
+    const char escape = m_text[m_pos + 1];
+    m_pos += 2;
+    switch (escape) {
+    case '"':
+    case '\\':
+    case '/':
+      m_scratch += escape;
+      break;
+    case 'n':
+      m_scratch += '\n';
+      break;
+    case 'r':
+      m_scratch += '\r';
+      break;
+    case 't':
+      m_scratch += '\t';
+      break;
+    case 'b':
+      m_scratch += '\b';
+      break;
+    case 'f':
+      m_scratch += '\f';
+      break;
+    case 'u': {
+      const auto readHex = [this](u32 &out) {
+        if (m_pos + 4 > m_text.size()) {
+          return false;
+        }
+        out = 0;
+        for (usize i = 0; i < 4; ++i) {
+          const int digit = hexValue(m_text[m_pos + i]);
+          if (digit < 0) {
+            return false;
+          }
+          out = out * 16 + static_cast<u32>(digit);
+        }
+        m_pos += 4;
+        return true;
+      };
+      u32 codepoint = 0;
+      if (!readHex(codepoint)) {
+        return error("Invalid \\u escape");
+      }
+      // A high surrogate must be followed by an escaped low surrogate
+      if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+        if (m_text.substr(m_pos, 2) != "\\u") {
+          return error("Invalid surrogate pair");
+        }
+        m_pos += 2;
+        u32 low = 0;
+        if (!readHex(low) || low < 0xDC00 || low > 0xDFFF) {
+          return error("Invalid surrogate pair");
+        }
+        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+      } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+        return error("Invalid surrogate pair");
+      }
+      appendUtf8(m_scratch, codepoint);
+      break;
+    }
+    default:
+      m_pos -= 2;
+      return error("Invalid escape sequence");
+    }
+  }
+  if (m_pos >= m_text.size()) {
+    return error("Unterminated string");
+  }
+  ++m_pos;
+  m_string = m_scratch;
+  return event;
+}
+
+JsonEvent JsonReader::readNumber() {
+  // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  const usize start = m_pos;
+  usize pos = m_pos;
+  const auto digits = [&] {
+    const usize first = pos;
+    while (pos < m_text.size() && isDigit(m_text[pos])) {
+      ++pos;
+    }
+    return pos > first;
+  };
+
+  if (pos < m_text.size() && m_text[pos] == '-') {
+    ++pos;
+  }
+  if (pos < m_text.size() && m_text[pos] == '0') {
+    ++pos;
+  } else if (!digits()) {
+    return error("Expected a value");
+  }
+  if (pos < m_text.size() && m_text[pos] == '.') {
+    ++pos;
+    if (!digits()) {
+      m_pos = pos;
+      return error("Expected digits after '.'");
+    }
+  }
+  if (pos < m_text.size() && (m_text[pos] == 'e' || m_text[pos] == 'E')) {
+    ++pos;
+    if (pos < m_text.size() && (m_text[pos] == '+' || m_text[pos] == '-')) {
+      ++pos;
+    }
+    if (!digits()) {
+      m_pos = pos;
+      return error("Expected digits in exponent");
+    }
+  }
+  m_string = m_text.substr(start, pos - start);
+  m_pos = pos;
+  return JsonEvent::Number;
+}
+
+JsonEvent JsonReader::readLiteral(std::string_view literal, JsonEvent event) {
+  if (m_text.substr(m_pos, literal.size()) != literal) {
+    return error("Expected a value");
+  }
+  m_pos += literal.size();
+  return event;
+}
+
+JsonEvent JsonReader::close(char bracket, JsonEvent event) {
+  if (m_containers.empty() ||
+      m_containers.back() != (bracket == '}' ? '{' : '[')) {
+    return error("Mismatched closing bracket");
+  }
+  ++m_pos;
+  m_containers.pop_back();
+  return afterValue(event);
+}
+
+JsonEvent JsonReader::afterValue(JsonEvent event) {
+  if (event != JsonEvent::Error) {
+    m_state = m_containers.empty() ? State::Done : State::CommaOrEnd;
+  }
+  return event;
+}
+
+JsonEvent JsonReader::error(const std::string &message) {
+  u32 line = 1;
+  usize lineStart = 0;
+  const usize end = std::min(m_pos, m_text.size());
+  for (usize i = 0; i < end; ++i) {
+    if (m_text[i] == '\n') {
+      ++line;
+      lineStart = i + 1;
+    }
+  }
+  m_error = "JSON error at line " + std::to_string(line) + ", column " +
+            std::to_string(end - lineStart + 1) + ": " + message;
+  return JsonEvent::Error;
+}
+
+void JsonReader::skipWhitespace() {
+  while (m_pos < m_text.size()) {
+    const char c = m_text[m_pos];
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+      return;
+    }
+    ++m_pos;
+  }
+}
+
+} // namespace NovelMind::core
@@ -0,0 +1,130 @@
+#include "NovelMind/core/mapped_file.hpp"
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace NovelMind::core {
+
+namespace {
+
+Result<std::vector<u8>> readWholeFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return Result<std::vector<u8>>::error("Cannot open file: " + path);
+  }
+  const std::streamoff size = file.tellg();
+  if (size < 0) {
+    return Result<std::vector<u8>>::error("Cannot read file: " + path);
+  }
+  std::vector<u8> bytes(static_cast<usize>(size));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char *>(bytes.data()), size)) {
+    return Result<std::vector<u8>>::error("Cannot read file: " + path);
+  }
+  return Result<std::vector<u8>>::ok(std::move(bytes));
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+#if defined(_WIN32)
+  if (m_mapping) {
+    UnmapViewOfFile(m_mapping);
+  }
+  if (m_mappingHandle) {
+    CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+  }
+#else
+  if (m_mapping) {
+    munmap(m_mapping, m_size);
+  }
+#endif
+}
+
+Result<MappedFilePtr> MappedFile::open(const std::string &path) {
+  // Private constructor, so no make_shared
+  std::shared_ptr<MappedFile> file(new MappedFile());
+
+#if defined(_WIN32)
+  HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return Result<MappedFilePtr>::error("Cannot open file: " + path);
+  }
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(handle, &size) && size.QuadPart > 0) {
+    HANDLE mapping =
+        CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+      void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      if (view) {
+        file->m_mapping = view;
+        file->m_mappingHandle = mapping;
+        file->m_data = static_cast<const u8 *>(view);
+        file->m_size = static_cast<usize>(size.QuadPart);
+      } else {
+        CloseHandle(mapping);
+      }
+    }
+  }
+  CloseHandle(handle);
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Result<MappedFilePtr>::error("Cannot open file: " + path);
+  }
+  struct stat info {};
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    const auto size = static_cast<usize>(info.st_size);
+    void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view != MAP_FAILED) {
+      file->m_mapping = view;
+      file->m_data = static_cast<const u8 *>(view);
+      file->m_size = size;
+    }
+  }
+  ::close(fd);
+#endif
+
+  if (!file->m_mapping) {
+    auto bytes = readWholeFile(path);
+    if (bytes.isError()) {
+      return Result<MappedFilePtr>::error(bytes.error());
+    }
+    file->m_buffer = std::move(bytes).value();
+    file->m_data = file->m_buffer.data();
+    file->m_size = file->m_buffer.size();
+  }
+  return Result<MappedFilePtr>::ok(std::move(file));
+}
+
+void MappedFile::prefetch(usize offset, usize length) const {
+  if (!m_mapping || offset >= m_size) {
+    return;
+  }
+  if (length > m_size - offset) {
+    length = m_size - offset;
+  }
+#if defined(_WIN32)
+  (void)length;
+#else
+  // madvise wants a page-aligned start
+  const auto pageSize = static_cast<usize>(sysconf(_SC_PAGESIZE));
+  const usize start = offset - offset % pageSize;
+  madvise(static_cast<u8 *>(m_mapping) + start, length + (offset - start),
+          MADV_WILLNEED);
+#endif
+}
+
+} // namespace NovelMind::core
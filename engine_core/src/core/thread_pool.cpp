@@ -0,0 +1,130 @@
+#include "NovelMind/core/thread_pool.hpp"
+#include <algorithm>
+
+namespace NovelMind::core {
+
+namespace {
+
+// Set on worker threads so submit() and getCurrentWorker() can find the
+// calling worker's deque
+thread_local const ThreadPool *t_pool = nullptr;
+thread_local usize t_workerIndex = ThreadPool::NOT_A_WORKER;
+
+} // namespace
+
+ThreadPool::ThreadPool(usize threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max<usize>(1, std::thread::hardware_concurrency());
+  }
+
+  m_workers.reserve(threadCount);
+  for (usize i = 0; i < threadCount; ++i) {
+    m_workers.push_back(std::make_unique<Worker>());
+  }
+
+  m_threads.reserve(threadCount);
+  for (usize i = 0; i < threadCount; ++i) {
+    m_threads.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::submit(Task task) {
+  usize index = getCurrentWorker();
+  if (index == NOT_A_WORKER) {
+    index = m_nextWorker.fetch_add(1, std::memory_order_relaxed) %
+            m_workers.size();
+  }
+
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+    m_workers[index]->tasks.push_back(std::move(task));
+  }
+  m_queued.fetch_add(1, std::memory_order_release);
+
+  // Taking the lock orders this notify after a sleeper's predicate check
+  { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+  m_wake.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(m_sleepMutex);
+  m_idle.wait(lock, [this] {
+    return m_pending.load(std::memory_order_acquire) == 0;
+  });
+}
+
+usize ThreadPool::getCurrentWorker() const {
+  return t_pool == this ? t_workerIndex : NOT_A_WORKER;
+}
+
+void ThreadPool::workerLoop(usize index) {
+  t_pool = this;
+  t_workerIndex = index;
+
+  while (true) {
+    Task task;
+    if (popLocal(index, task) || steal(index, task)) {
+      task();
+      finishTask();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wake.wait(lock, [this] {
+      return m_stopping || m_queued.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stopping && m_queued.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::popLocal(usize index, Task &task) {
+  Worker &worker = *m_workers[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  m_queued.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool ThreadPool::steal(usize thief, Task &task) {
+  const usize count = m_workers.size();
+  for (usize offset = 1; offset < count; ++offset) {
+    Worker &victim = *m_workers[(thief + offset) % count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.tasks.empty()) {
+      continue;
+    }
+    task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::finishTask() {
+  if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_idle.notify_all();
+  }
+}
+
+} // namespace NovelMind::core
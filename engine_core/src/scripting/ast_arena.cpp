@@ -0,0 +1,76 @@
+#include "NovelMind/scripting/ast_arena.hpp"
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+namespace NovelMind::scripting {
+
+AstArena::~AstArena() = default;
+
+void *AstArena::allocate(usize size, usize alignment) {
+  auto address = reinterpret_cast<std::uintptr_t>(m_cursor);
+  usize padding = (alignment - (address % alignment)) % alignment;
+  if (m_cursor == nullptr ||
+      static_cast<usize>(m_end - m_cursor) < size + padding) {
+    addChunk(size + alignment);
+    address = reinterpret_cast<std::uintptr_t>(m_cursor);
+    padding = (alignment - (address % alignment)) % alignment;
+  }
+
+  std::byte *result = m_cursor + padding;
+  m_cursor = result + size;
+  return result;
+}
+
+void AstArena::addChunk(usize minimumSize) {
+  const usize size = minimumSize > CHUNK_SIZE ? minimumSize : CHUNK_SIZE;
+  m_chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+  m_cursor = m_chunks.back().get();
+  m_end = m_cursor + size;
+  m_bytesReserved += size;
+}
+
+std::string_view AstArena::intern(std::string_view text) {
+  if (text.empty()) {
+    return {};
+  }
+
+  // Keep the load factor at or below 1/2
+  if ((m_internedCount + 1) * 2 > m_internTable.size()) {
+    growInternTable();
+  }
+
+  const usize mask = m_internTable.size() - 1;
+  usize slot = std::hash<std::string_view>{}(text) & mask;
+  while (!m_internTable[slot].empty()) {
+    if (m_internTable[slot] == text) {
+      return m_internTable[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  auto *storage = static_cast<char *>(allocate(text.size(), 1));
+  std::memcpy(storage, text.data(), text.size());
+  m_internTable[slot] = std::string_view(storage, text.size());
+  ++m_internedCount;
+  return m_internTable[slot];
+}
+
+void AstArena::growInternTable() {
+  std::vector<std::string_view> previous = std::move(m_internTable);
+  m_internTable.assign(previous.empty() ? 256 : previous.size() * 2, {});
+
+  const usize mask = m_internTable.size() - 1;
+  for (std::string_view entry : previous) {
+    if (entry.empty()) {
+      continue;
+    }
+    usize slot = std::hash<std::string_view>{}(entry) & mask;
+    while (!m_internTable[slot].empty()) {
+      slot = (slot + 1) & mask;
+    }
+    m_internTable[slot] = entry;
+  }
+}
+
+} // namespace NovelMind::scripting
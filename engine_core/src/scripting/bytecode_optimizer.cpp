@@ -0,0 +1,669 @@
+#include "NovelMind/scripting/bytecode_optimizer.hpp"
+#include <cstring>
+#include <optional>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+// Enough for any realistic script; guards against pathological ping-pong
+constexpr int MAX_ROUNDS = 16;
+
+// Largest value that still fits next to a CompareOp in a packed operand
+constexpr u32 MAX_PACKED_VALUE = unpackCompareValue(~0u);
+
+bool isConditionalJump(OpCode op) {
+  return op == OpCode::JUMP_IF || op == OpCode::JUMP_IF_NOT;
+}
+
+bool isPlainJump(OpCode op) {
+  return op == OpCode::JUMP || isConditionalJump(op) ||
+         op == OpCode::GOTO_SCENE;
+}
+
+// Instructions that only push one value and have no other effect
+bool isPurePush(OpCode op) {
+  switch (op) {
+  case OpCode::PUSH_INT:
+  case OpCode::PUSH_FLOAT:
+  case OpCode::PUSH_STRING:
+  case OpCode::PUSH_BOOL:
+  case OpCode::PUSH_NULL:
+  case OpCode::DUP:
+  case OpCode::LOAD_VAR:
+  case OpCode::LOAD_GLOBAL:
+  case OpCode::LOAD_SLOT:
+  case OpCode::CHECK_FLAG:
+    return true;
+  default:
+    return false;
+  }
+}
+
+std::optional<CompareOp> compareOpFor(OpCode op) {
+  switch (op) {
+  case OpCode::EQ:
+    return CompareOp::Eq;
+  case OpCode::NE:
+    return CompareOp::Ne;
+  case OpCode::LT:
+    return CompareOp::Lt;
+  case OpCode::LE:
+    return CompareOp::Le;
+  case OpCode::GT:
+    return CompareOp::Gt;
+  case OpCode::GE:
+    return CompareOp::Ge;
+  default:
+    return std::nullopt;
+  }
+}
+
+/**
+ * @brief Call fn(index, target) for every instruction-index operand
+ */
+template <typename Fn>
+void visitJumpTargets(const std::vector<Instruction> &code, Fn &&fn) {
+  for (usize i = 0; i < code.size(); ++i) {
+    const auto &instr = code[i];
+    if (isPlainJump(instr.opcode)) {
+      fn(i, instr.operand);
+    } else if (instr.opcode == OpCode::CMP_JUMP_IF_NOT) {
+      fn(i, unpackCompareValue(instr.operand));
+    } else if (instr.opcode == OpCode::SLOT_CMP_INT_JUMP_IF_NOT &&
+               i + 2 < code.size()) {
+      fn(i, code[i + 2].operand);
+      i += 2;
+    }
+  }
+}
+
+/**
+ * @brief Replace every instruction-index operand with map(target)
+ */
+template <typename Fn>
+void remapJumpTargets(std::vector<Instruction> &code, Fn &&map) {
+  for (usize i = 0; i < code.size(); ++i) {
+    auto &instr = code[i];
+    if (isPlainJump(instr.opcode)) {
+      instr.operand = map(instr.operand);
+    } else if (instr.opcode == OpCode::CMP_JUMP_IF_NOT) {
+      instr.operand = packCompareOperand(map(unpackCompareValue(instr.operand)),
+                                         unpackCompareOp(instr.operand));
+    } else if (instr.opcode == OpCode::SLOT_CMP_INT_JUMP_IF_NOT &&
+               i + 2 < code.size()) {
+      code[i + 2].operand = map(code[i + 2].operand);
+      i += 2;
+    }
+  }
+}
+
+/**
+ * @brief A PUSH_* operand decoded the way the VM would
+ */
+struct Literal {
+  ValueType type = ValueType::Null;
+  i32 intValue = 0;
+  f32 floatValue = 0.0f;
+  u32 stringIndex = 0;
+
+  [[nodiscard]] bool isNumber() const {
+    return type == ValueType::Int || type == ValueType::Float;
+  }
+
+  [[nodiscard]] f32 asFloat() const {
+    return type == ValueType::Float ? floatValue
+                                    : static_cast<f32>(intValue);
+  }
+};
+
+std::optional<Literal> literalOf(const Instruction &instr) {
+  Literal lit;
+  switch (instr.opcode) {
+  case OpCode::PUSH_INT:
+    lit.type = ValueType::Int;
+    lit.intValue = static_cast<i32>(instr.operand);
+    return lit;
+  case OpCode::PUSH_FLOAT:
+    lit.type = ValueType::Float;
+    std::memcpy(&lit.floatValue, &instr.operand, sizeof(f32));
+    return lit;
+  case OpCode::PUSH_BOOL:
+    lit.type = ValueType::Bool;
+    lit.intValue = instr.operand != 0 ? 1 : 0;
+    return lit;
+  case OpCode::PUSH_STRING:
+    lit.type = ValueType::String;
+    lit.stringIndex = instr.operand;
+    return lit;
+  case OpCode::PUSH_NULL:
+    return lit;
+  default:
+    return std::nullopt;
+  }
+}
+
+std::optional<bool> truthiness(const Literal &lit,
+                               const std::vector<std::string> &strings) {
+  switch (lit.type) {
+  case ValueType::Int:
+  case ValueType::Bool:
+    return lit.intValue != 0;
+  case ValueType::Float:
+    return lit.floatValue != 0.0f;
+  case ValueType::String:
+    if (lit.stringIndex >= strings.size()) {
+      return std::nullopt;
+    }
+    return !strings[lit.stringIndex].empty();
+  default:
+    return false;
+  }
+}
+
+Instruction pushFloat(f32 value) {
+  u32 bits = 0;
+  std::memcpy(&bits, &value, sizeof(f32));
+  return {OpCode::PUSH_FLOAT, bits};
+}
+
+Instruction pushBool(bool value) { return {OpCode::PUSH_BOOL, value ? 1u : 0u}; }
+
+u32 internString(std::vector<std::string> &strings, const std::string &str) {
+  for (u32 i = 0; i < strings.size(); ++i) {
+    if (strings[i] == str) {
+      return i;
+    }
+  }
+  strings.push_back(str);
+  return static_cast<u32>(strings.size() - 1);
+}
+
+/**
+ * @brief Evaluate `a op b` at compile time with the VM's semantics
+ *
+ * Only cases whose result cannot depend on runtime state and that need no
+ * string conversion of numbers are folded; everything else is left alone.
+ */
+std::optional<Instruction> foldBinary(OpCode op, const Literal &a,
+                                      const Literal &b,
+                                      std::vector<std::string> &strings) {
+  const bool ints = a.type == ValueType::Int && b.type == ValueType::Int;
+  const bool numbers = a.isNumber() && b.isNumber();
+
+  switch (op) {
+  case OpCode::ADD:
+    if (a.type == ValueType::String && b.type == ValueType::String &&
+        a.stringIndex < strings.size() && b.stringIndex < strings.size()) {
+      std::string joined = strings[a.stringIndex] + strings[b.stringIndex];
+      return Instruction(OpCode::PUSH_STRING, internString(strings, joined));
+    }
+    [[fallthrough]];
+  case OpCode::SUB:
+  case OpCode::MUL: {
+    if (ints) {
+      // Unsigned arithmetic gives the same two's complement bits without
+      // relying on signed overflow
+      u32 x = static_cast<u32>(a.intValue);
+      u32 y = static_cast<u32>(b.intValue);
+      u32 r = op == OpCode::ADD ? x + y : op == OpCode::SUB ? x - y : x * y;
+      return Instruction(OpCode::PUSH_INT, r);
+    }
+    if (numbers) {
+      f32 x = a.asFloat();
+      f32 y = b.asFloat();
+      return pushFloat(op == OpCode::ADD   ? x + y
+                       : op == OpCode::SUB ? x - y
+                                           : x * y);
+    }
+    return std::nullopt;
+  }
+  case OpCode::DIV:
+    // Division by zero logs at runtime, keep that behaviour
+    if (numbers && b.asFloat() != 0.0f) {
+      return pushFloat(a.asFloat() / b.asFloat());
+    }
+    return std::nullopt;
+  case OpCode::LT:
+  case OpCode::LE:
+  case OpCode::GT:
+  case OpCode::GE: {
+    if (!numbers) {
+      return std::nullopt;
+    }
+    f32 x = a.asFloat();
+    f32 y = b.asFloat();
+    bool r = op == OpCode::LT   ? x < y
+             : op == OpCode::LE ? x <= y
+             : op == OpCode::GT ? x > y
+                                : x >= y;
+    return pushBool(r);
+  }
+  case OpCode::EQ:
+  case OpCode::NE: {
+    if (a.type != b.type || a.type == ValueType::Float) {
+      return std::nullopt;
+    }
+    bool equal = true;
+    if (a.type == ValueType::String) {
+      if (a.stringIndex >= strings.size() || b.stringIndex >= strings.size()) {
+        return std::nullopt;
+      }
+      equal = strings[a.stringIndex] == strings[b.stringIndex];
+    } else {
+      equal = a.intValue == b.intValue;
+    }
+    return pushBool(op == OpCode::EQ ? equal : !equal);
+  }
+  default:
+    return std::nullopt;
+  }
+}
+
+} // namespace
+
+BytecodeOptimizer::BytecodeOptimizer(OptimizationLevel level)
+    : m_level(level) {}
+
+OptimizationStats BytecodeOptimizer::optimize(CompiledScript &script) {
+  m_stats = OptimizationStats{};
+  m_stats.instructionsBefore = script.instructions.size();
+
+  if (m_level != OptimizationLevel::None && !script.instructions.empty()) {
+    for (int round = 0; round < MAX_ROUNDS; ++round) {
+      bool changed = false;
+      changed |= foldConstants(script);
+      changed |= threadJumps(script);
+      changed |= removeDeadCode(script);
+      changed |= applyPeepholes(script);
+      if (!changed) {
+        break;
+      }
+    }
+
+    if (m_level == OptimizationLevel::Full) {
+      fuseSuperinstructions(script);
+    }
+  }
+
+  m_stats.instructionsAfter = script.instructions.size();
+  return m_stats;
+}
+
+void BytecodeOptimizer::markJumpTargets(const CompiledScript &script) {
+  m_isTarget.assign(script.instructions.size() + 1, false);
+  visitJumpTargets(script.instructions, [this](usize, u32 target) {
+    if (target < m_isTarget.size()) {
+      m_isTarget[target] = true;
+    }
+  });
+  for (const auto &[name, entry] : script.sceneEntryPoints) {
+    if (entry < m_isTarget.size()) {
+      m_isTarget[entry] = true;
+    }
+  }
+  m_removed.assign(script.instructions.size(), false);
+}
+
+void BytecodeOptimizer::compact(CompiledScript &script) {
+  auto &code = script.instructions;
+  const usize size = code.size();
+
+  // newIndex[i] = surviving instructions before i, which is also where a
+  // removed instruction's successor lands; newIndex[size] is the new end
+  std::vector<u32> newIndex(size + 1);
+  u32 next = 0;
+  for (usize i = 0; i < size; ++i) {
+    newIndex[i] = next;
+    if (!m_removed[i]) {
+      ++next;
+    }
+  }
+  newIndex[size] = next;
+
+  auto map = [&](u32 target) {
+    return target < newIndex.size() ? newIndex[target] : target;
+  };
+  remapJumpTargets(code, map);
+  for (auto &[name, entry] : script.sceneEntryPoints) {
+    entry = map(entry);
+  }
+
+  // Entries whose instructions were all removed collapse onto the next
+  // entry's instruction; the later entry owns it
+  auto &lines = script.lineTable;
+  usize lineOut = 0;
+  for (usize i = 0; i < lines.size(); ++i) {
+    LineTableEntry entry{map(lines[i].instruction), lines[i].location};
+    if (lineOut > 0 && lines[lineOut - 1].instruction == entry.instruction) {
+      lines[lineOut - 1] = entry;
+    } else {
+      lines[lineOut++] = entry;
+    }
+  }
+  lines.resize(lineOut);
+
+  usize out = 0;
+  for (usize i = 0; i < size; ++i) {
+    if (!m_removed[i]) {
+      code[out++] = code[i];
+    }
+  }
+  code.resize(out);
+}
+
+bool BytecodeOptimizer::foldConstants(CompiledScript &script) {
+  // A fold can expose another one (1 + 2 + 3), so rescan until stable
+  bool changed = false;
+  while (foldConstantsOnce(script)) {
+    changed = true;
+  }
+  return changed;
+}
+
+bool BytecodeOptimizer::foldConstantsOnce(CompiledScript &script) {
+  auto &code = script.instructions;
+  markJumpTargets(script);
+  bool changed = false;
+
+  // Only rewrite [i, i + n) if control cannot enter in the middle
+  auto straightLine = [&](usize i, usize n) {
+    if (i + n > code.size()) {
+      return false;
+    }
+    for (usize k = i + 1; k < i + n; ++k) {
+      if (m_isTarget[k] || m_removed[k]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (usize i = 0; i < code.size(); ++i) {
+    if (m_removed[i]) {
+      continue;
+    }
+    auto lhs = literalOf(code[i]);
+    if (!lhs) {
+      continue;
+    }
+
+    // literal literal binop -> literal
+    if (straightLine(i, 3)) {
+      auto rhs = literalOf(code[i + 1]);
+      if (rhs) {
+        if (auto folded =
+                foldBinary(code[i + 2].opcode, *lhs, *rhs, script.stringTable)) {
+          code[i] = *folded;
+          m_removed[i + 1] = true;
+          m_removed[i + 2] = true;
+          ++m_stats.constantsFolded;
+          changed = true;
+          continue;
+        }
+      }
+    }
+
+    if (!straightLine(i, 2)) {
+      continue;
+    }
+    auto truth = truthiness(*lhs, script.stringTable);
+    if (!truth) {
+      continue;
+    }
+    const OpCode next = code[i + 1].opcode;
+
+    if (next == OpCode::NOT) {
+      code[i] = pushBool(!*truth);
+      m_removed[i + 1] = true;
+      ++m_stats.constantsFolded;
+      changed = true;
+    } else if (isConditionalJump(next)) {
+      bool taken = (next == OpCode::JUMP_IF) == *truth;
+      if (taken) {
+        code[i] = Instruction(OpCode::JUMP, code[i + 1].operand);
+        m_removed[i + 1] = true;
+      } else {
+        m_removed[i] = true;
+        m_removed[i + 1] = true;
+      }
+      ++m_stats.constantsFolded;
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    compact(script);
+  }
+  return changed;
+}
+
+bool BytecodeOptimizer::threadJumps(CompiledScript &script) {
+  auto &code = script.instructions;
+  const usize size = code.size();
+  bool changed = false;
+
+  for (usize i = 0; i < size; ++i) {
+    auto &instr = code[i];
+    // GOTO_SCENE keeps pointing at the scene entry so it still names a scene
+    if (instr.opcode != OpCode::JUMP && !isConditionalJump(instr.opcode)) {
+      continue;
+    }
+
+    u32 target = instr.operand;
+    usize hops = 0;
+    while (target < size && code[target].opcode == OpCode::JUMP &&
+           code[target].operand != target && hops < size) {
+      target = code[target].operand;
+      ++hops;
+    }
+    if (target != instr.operand) {
+      instr.operand = target;
+      ++m_stats.jumpsThreaded;
+      changed = true;
+    }
+
+    if (instr.opcode == OpCode::JUMP && target < size &&
+        code[target].opcode == OpCode::HALT) {
+      instr = Instruction(OpCode::HALT);
+      ++m_stats.jumpsThreaded;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool BytecodeOptimizer::removeDeadCode(CompiledScript &script) {
+  auto &code = script.instructions;
+  const usize size = code.size();
+
+  std::vector<bool> reachable(size, false);
+  std::vector<u32> worklist;
+  auto enqueue = [&](u32 index) {
+    if (index < size && !reachable[index]) {
+      reachable[index] = true;
+      worklist.push_back(index);
+    }
+  };
+
+  enqueue(0);
+  for (const auto &[name, entry] : script.sceneEntryPoints) {
+    enqueue(entry);
+  }
+
+  while (!worklist.empty()) {
+    u32 i = worklist.back();
+    worklist.pop_back();
+    const auto &instr = code[i];
+
+    switch (instr.opcode) {
+    case OpCode::HALT:
+      break;
+    case OpCode::JUMP:
+    case OpCode::GOTO_SCENE:
+      enqueue(instr.operand);
+      break;
+    case OpCode::JUMP_IF:
+    case OpCode::JUMP_IF_NOT:
+      enqueue(instr.operand);
+      enqueue(i + 1);
+      break;
+    case OpCode::CMP_JUMP_IF_NOT:
+      enqueue(unpackCompareValue(instr.operand));
+      enqueue(i + 1);
+      break;
+    case OpCode::SLOT_CMP_INT_JUMP_IF_NOT:
+      if (i + 2 < size) {
+        reachable[i + 1] = true;
+        reachable[i + 2] = true;
+        enqueue(code[i + 2].operand);
+      }
+      enqueue(i + 3);
+      break;
+    default:
+      enqueue(i + 1);
+      break;
+    }
+  }
+
+  m_removed.assign(size, false);
+  usize dead = 0;
+  for (usize i = 0; i < size; ++i) {
+    if (!reachable[i]) {
+      m_removed[i] = true;
+      ++dead;
+    }
+  }
+  if (dead == 0) {
+    return false;
+  }
+
+  m_stats.deadInstructions += dead;
+  compact(script);
+  return true;
+}
+
+bool BytecodeOptimizer::applyPeepholes(CompiledScript &script) {
+  auto &code = script.instructions;
+  markJumpTargets(script);
+  bool changed = false;
+
+  for (usize i = 0; i < code.size(); ++i) {
+    if (m_removed[i]) {
+      continue;
+    }
+    auto &instr = code[i];
+    const bool hasNext = i + 1 < code.size() && !m_isTarget[i + 1] &&
+                         !m_removed[i + 1];
+
+    if (instr.opcode == OpCode::NOP) {
+      m_removed[i] = true;
+    } else if (hasNext && isPurePush(instr.opcode) &&
+               code[i + 1].opcode == OpCode::POP) {
+      m_removed[i] = true;
+      m_removed[i + 1] = true;
+    } else if (hasNext && instr.opcode == OpCode::NOT &&
+               isConditionalJump(code[i + 1].opcode)) {
+      code[i + 1].opcode = code[i + 1].opcode == OpCode::JUMP_IF
+                               ? OpCode::JUMP_IF_NOT
+                               : OpCode::JUMP_IF;
+      m_removed[i] = true;
+    } else if (instr.opcode == OpCode::JUMP && instr.operand == i + 1) {
+      m_removed[i] = true;
+    } else if (isConditionalJump(instr.opcode) && instr.operand == i + 1) {
+      // Both paths continue at i + 1; only the pop of the condition remains
+      instr = Instruction(OpCode::POP);
+    } else {
+      continue;
+    }
+    ++m_stats.peepholes;
+    changed = true;
+  }
+
+  if (changed) {
+    compact(script);
+  }
+  return changed;
+}
+
+bool BytecodeOptimizer::fuseSuperinstructions(CompiledScript &script) {
+  auto &code = script.instructions;
+  markJumpTargets(script);
+  bool changed = false;
+
+  auto straightLine = [&](usize i, usize n) {
+    if (i + n > code.size()) {
+      return false;
+    }
+    for (usize k = i + 1; k < i + n; ++k) {
+      if (m_isTarget[k] || m_removed[k]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (usize i = 0; i < code.size(); ++i) {
+    if (m_removed[i]) {
+      continue;
+    }
+    const auto &instr = code[i];
+
+    // LOAD_SLOT s; PUSH_INT k; <cmp>; JUMP_IF_NOT t
+    if (instr.opcode == OpCode::LOAD_SLOT && straightLine(i, 4) &&
+        code[i + 1].opcode == OpCode::PUSH_INT &&
+        code[i + 3].opcode == OpCode::JUMP_IF_NOT &&
+        instr.operand <= MAX_PACKED_VALUE) {
+      if (auto cmp = compareOpFor(code[i + 2].opcode)) {
+        u32 slot = instr.operand;
+        u32 constant = code[i + 1].operand;
+        u32 target = code[i + 3].operand;
+        code[i] = Instruction(OpCode::SLOT_CMP_INT_JUMP_IF_NOT,
+                              packCompareOperand(slot, *cmp));
+        code[i + 1] = Instruction(OpCode::EXTRA_ARG, constant);
+        code[i + 2] = Instruction(OpCode::EXTRA_ARG, target);
+        m_removed[i + 3] = true;
+        ++m_stats.superinstructions;
+        changed = true;
+        i += 3;
+        continue;
+      }
+    }
+
+    // LOAD_SLOT s; PUSH_INT 1; ADD; STORE_SLOT s
+    if (instr.opcode == OpCode::LOAD_SLOT && straightLine(i, 4) &&
+        code[i + 1].opcode == OpCode::PUSH_INT && code[i + 1].operand == 1 &&
+        code[i + 2].opcode == OpCode::ADD &&
+        code[i + 3].opcode == OpCode::STORE_SLOT &&
+        code[i + 3].operand == instr.operand) {
+      code[i] = Instruction(OpCode::INC_SLOT, instr.operand);
+      m_removed[i + 1] = true;
+      m_removed[i + 2] = true;
+      m_removed[i + 3] = true;
+      ++m_stats.superinstructions;
+      changed = true;
+      i += 3;
+      continue;
+    }
+
+    // <cmp>; JUMP_IF_NOT t
+    if (straightLine(i, 2) && code[i + 1].opcode == OpCode::JUMP_IF_NOT &&
+        code[i + 1].operand <= MAX_PACKED_VALUE) {
+      if (auto cmp = compareOpFor(instr.opcode)) {
+        code[i] = Instruction(OpCode::CMP_JUMP_IF_NOT,
+                              packCompareOperand(code[i + 1].operand, *cmp));
+        m_removed[i + 1] = true;
+        ++m_stats.superinstructions;
+        changed = true;
+        ++i;
+      }
+    }
+  }
+
+  if (changed) {
+    compact(script);
+  }
+  return changed;
+}
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,450 @@
+#include "NovelMind/scripting/compile_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace NovelMind::scripting {
+
+namespace {
+
+constexpr u32 CACHE_MAGIC = 0x43434D4E; // "NMCC"
+constexpr u16 CACHE_FORMAT_VERSION = 2;
+
+u64 mix(u64 value) {
+  value ^= value >> 30;
+  value *= 0xBF58476D1CE4E5B9ULL;
+  value ^= value >> 27;
+  value *= 0x94D049BB133111EBULL;
+  value ^= value >> 31;
+  return value;
+}
+
+std::string toHex(u64 value) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+class Writer {
+public:
+  template <typename T> void write(T value) {
+    u8 bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+  }
+
+  void writeString(const std::string &str) {
+    write(static_cast<u32>(str.size()));
+    m_data.insert(m_data.end(), str.begin(), str.end());
+  }
+
+  void writeStrings(const std::vector<std::string> &strings) {
+    write(static_cast<u32>(strings.size()));
+    for (const auto &str : strings) {
+      writeString(str);
+    }
+  }
+
+  void writeLocation(SourceLocation loc) {
+    write(loc.line);
+    write(loc.column);
+  }
+
+  void writeLocations(const std::vector<SourceLocation> &locations) {
+    write(static_cast<u32>(locations.size()));
+    for (const auto &loc : locations) {
+      writeLocation(loc);
+    }
+  }
+
+  [[nodiscard]] const std::vector<u8> &data() const { return m_data; }
+
+private:
+  std::vector<u8> m_data;
+};
+
+class Reader {
+public:
+  explicit Reader(const std::vector<u8> &data) : m_data(data) {}
+
+  template <typename T> bool read(T &value) {
+    if (sizeof(T) > m_data.size() - m_offset) {
+      return false;
+    }
+    std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+    m_offset += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string &value) {
+    u32 size = 0;
+    if (!read(size) || size > m_data.size() - m_offset) {
+      return false;
+    }
+    const auto *begin = reinterpret_cast<const char *>(m_data.data()) + m_offset;
+    value.assign(begin, size);
+    m_offset += size;
+    return true;
+  }
+
+  bool readStrings(std::vector<std::string> &strings) {
+    u32 count = 0;
+    if (!readCount(count)) {
+      return false;
+    }
+    strings.resize(count);
+    for (auto &str : strings) {
+      if (!readString(str)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool readLocation(SourceLocation &loc) {
+    return read(loc.line) && read(loc.column);
+  }
+
+  bool readLocations(std::vector<SourceLocation> &locations) {
+    u32 count = 0;
+    if (!readCount(count)) {
+      return false;
+    }
+    locations.resize(count);
+    for (auto &loc : locations) {
+      if (!readLocation(loc)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // An element count; every element takes at least one byte
+  bool readCount(u32 &count) {
+    return read(count) && count <= m_data.size() - m_offset;
+  }
+
+  [[nodiscard]] bool atEnd() const { return m_offset == m_data.size(); }
+
+private:
+  const std::vector<u8> &m_data;
+  usize m_offset = 0;
+};
+
+void writeScript(Writer &out, const CompiledScript &script) {
+  out.write(static_cast<u32>(script.instructions.size()));
+  for (const auto &instr : script.instructions) {
+    out.write(static_cast<u8>(instr.opcode));
+    out.write(instr.operand);
+  }
+  out.writeStrings(script.stringTable);
+  out.writeStrings(script.variableSlots);
+
+  // Hash maps are written sorted so equal scripts give equal entries
+  std::vector<std::pair<std::string, u32>> scenes(
+      script.sceneEntryPoints.begin(), script.sceneEntryPoints.end());
+  std::sort(scenes.begin(), scenes.end());
+  out.write(static_cast<u32>(scenes.size()));
+  for (const auto &[name, entry] : scenes) {
+    out.writeString(name);
+    out.write(entry);
+  }
+
+  std::vector<const CompiledCharacter *> characters;
+  for (const auto &[id, character] : script.characters) {
+    characters.push_back(&character);
+  }
+  std::sort(characters.begin(), characters.end(),
+            [](const auto *a, const auto *b) { return a->id < b->id; });
+  out.write(static_cast<u32>(characters.size()));
+  for (const auto *character : characters) {
+    out.writeString(character->id);
+    out.writeString(character->displayName);
+    out.writeString(character->color);
+    out.write(static_cast<u8>(character->defaultSprite.has_value()));
+    out.writeString(character->defaultSprite.value_or(std::string()));
+  }
+
+  std::vector<std::pair<std::string, ValueType>> variables(
+      script.variables.begin(), script.variables.end());
+  std::sort(variables.begin(), variables.end());
+  out.write(static_cast<u32>(variables.size()));
+  for (const auto &[name, type] : variables) {
+    out.writeString(name);
+    out.write(static_cast<u8>(type));
+  }
+
+  out.write(static_cast<u32>(script.lineTable.size()));
+  for (const auto &entry : script.lineTable) {
+    out.write(entry.instruction);
+    out.writeLocation(entry.location);
+  }
+}
+
+bool readScript(Reader &in, CompiledScript &script) {
+  u32 count = 0;
+  if (!in.readCount(count)) {
+    return false;
+  }
+  script.instructions.resize(count);
+  for (auto &instr : script.instructions) {
+    u8 opcode = 0;
+    if (!in.read(opcode) || !in.read(instr.operand)) {
+      return false;
+    }
+    instr.opcode = static_cast<OpCode>(opcode);
+  }
+  if (!in.readStrings(script.stringTable) ||
+      !in.readStrings(script.variableSlots)) {
+    return false;
+  }
+
+  if (!in.readCount(count)) {
+    return false;
+  }
+  for (u32 i = 0; i < count; ++i) {
+    std::string name;
+    u32 entry = 0;
+    if (!in.readString(name) || !in.read(entry)) {
+      return false;
+    }
+    script.sceneEntryPoints.emplace(std::move(name), entry);
+  }
+
+  if (!in.readCount(count)) {
+    return false;
+  }
+  for (u32 i = 0; i < count; ++i) {
+    CompiledCharacter character;
+    u8 hasSprite = 0;
+    std::string sprite;
+    if (!in.readString(character.id) || !in.readString(character.displayName) ||
+        !in.readString(character.color) || !in.read(hasSprite) ||
+        !in.readString(sprite)) {
+      return false;
+    }
+    if (hasSprite != 0) {
+      character.defaultSprite = std::move(sprite);
+    }
+    std::string id = character.id;
+    script.characters.emplace(std::move(id), std::move(character));
+  }
+
+  if (!in.readCount(count)) {
+    return false;
+  }
+  for (u32 i = 0; i < count; ++i) {
+    std::string name;
+    u8 type = 0;
+    if (!in.readString(name) || !in.read(type) ||
+        type > static_cast<u8>(ValueType::String)) {
+      return false;
+    }
+    script.variables.emplace(std::move(name), static_cast<ValueType>(type));
+  }
+
+  if (!in.readCount(count)) {
+    return false;
+  }
+  script.lineTable.resize(count);
+  for (auto &entry : script.lineTable) {
+    if (!in.read(entry.instruction) || !in.readLocation(entry.location)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void writeDiagnostic(Writer &out, const ScriptError &diagnostic) {
+  out.write(static_cast<u32>(diagnostic.code));
+  out.write(static_cast<u8>(diagnostic.severity));
+  out.writeString(diagnostic.message);
+  out.writeLocation(diagnostic.span.start);
+  out.writeLocation(diagnostic.span.end);
+  out.write(static_cast<u8>(diagnostic.source.has_value()));
+  out.writeString(diagnostic.source.value_or(std::string()));
+  out.write(static_cast<u32>(diagnostic.relatedInfo.size()));
+  for (const auto &related : diagnostic.relatedInfo) {
+    out.writeLocation(related.location);
+    out.writeString(related.message);
+  }
+  out.writeStrings(diagnostic.suggestions);
+}
+
+bool readDiagnostic(Reader &in, ScriptError &diagnostic) {
+  u32 code = 0;
+  u8 severity = 0;
+  u8 hasSource = 0;
+  std::string source;
+  if (!in.read(code) || !in.read(severity) ||
+      severity > static_cast<u8>(Severity::Error) ||
+      !in.readString(diagnostic.message) ||
+      !in.readLocation(diagnostic.span.start) ||
+      !in.readLocation(diagnostic.span.end) || !in.read(hasSource) ||
+      !in.readString(source)) {
+    return false;
+  }
+  diagnostic.code = static_cast<ErrorCode>(code);
+  diagnostic.severity = static_cast<Severity>(severity);
+  if (hasSource != 0) {
+    diagnostic.source = std::move(source);
+  }
+
+  u32 count = 0;
+  if (!in.readCount(count)) {
+    return false;
+  }
+  diagnostic.relatedInfo.resize(count);
+  for (auto &related : diagnostic.relatedInfo) {
+    if (!in.readLocation(related.location) || !in.readString(related.message)) {
+      return false;
+    }
+  }
+  return in.readStrings(diagnostic.suggestions);
+}
+
+} // namespace
+
+CompileCache::CompileCache(std::string directory, u64 configHash)
+    : m_directory(std::move(directory)), m_configHash(configHash) {}
+
+u64 CompileCache::hashContent(std::string_view data, u64 seed) {
+  u64 hash = mix(seed ^ (data.size() * 0x9E3779B97F4A7C15ULL));
+  usize offset = 0;
+  for (; offset + sizeof(u64) <= data.size(); offset += sizeof(u64)) {
+    u64 chunk = 0;
+    std::memcpy(&chunk, data.data() + offset, sizeof(u64));
+    hash = mix(hash ^ chunk) + 0x9E3779B97F4A7C15ULL;
+  }
+  u64 tail = 0;
+  if (offset < data.size()) {
+    std::memcpy(&tail, data.data() + offset, data.size() - offset);
+  }
+  return mix(hash ^ tail);
+}
+
+u64 CompileCache::makeKey(std::string_view source) const {
+  const u64 version =
+      (static_cast<u64>(NOVELMIND_VERSION_MAJOR) << 48) |
+      (static_cast<u64>(NOVELMIND_VERSION_MINOR) << 32) |
+      (static_cast<u64>(NOVELMIND_VERSION_PATCH) << 16) | CACHE_FORMAT_VERSION;
+  return hashContent(source, mix(m_configHash ^ mix(version)));
+}
+
+std::string CompileCache::entryPath(const std::string &path) const {
+  return (fs::path(m_directory) / (toHex(hashContent(path)) + ".nmcc"))
+      .string();
+}
+
+std::optional<CompiledFile> CompileCache::load(const std::string &path,
+                                               u64 key) const {
+  std::ifstream stream(entryPath(path), std::ios::binary);
+  if (!stream.is_open()) {
+    return std::nullopt;
+  }
+  const std::vector<u8> data((std::istreambuf_iterator<char>(stream)),
+                             std::istreambuf_iterator<char>());
+
+  Reader in(data);
+  u32 magic = 0;
+  u16 version = 0;
+  u64 storedKey = 0;
+  std::string storedPath;
+  if (!in.read(magic) || magic != CACHE_MAGIC || !in.read(version) ||
+      version != CACHE_FORMAT_VERSION || !in.read(storedKey) ||
+      storedKey != key || !in.readString(storedPath) || storedPath != path) {
+    return std::nullopt;
+  }
+
+  CompiledFile file;
+  u32 count = 0;
+  if (!in.readStrings(file.scenes) || !in.readStrings(file.characters) ||
+      !in.readLocations(file.sceneLocations) ||
+      !in.readLocations(file.characterLocations) ||
+      file.sceneLocations.size() != file.scenes.size() ||
+      file.characterLocations.size() != file.characters.size() ||
+      !in.readStrings(file.importedScenes) ||
+      !in.readStrings(file.importedCharacters) ||
+      !in.read(file.fragment.globalsStart) ||
+      !readScript(in, file.fragment.script) || !in.readCount(count)) {
+    return std::nullopt;
+  }
+  file.fragment.externalJumps.resize(count);
+  for (auto &jump : file.fragment.externalJumps) {
+    if (!in.read(jump.instruction) || !in.readString(jump.scene)) {
+      return std::nullopt;
+    }
+  }
+  if (!in.readCount(count)) {
+    return std::nullopt;
+  }
+  file.diagnostics.resize(count);
+  for (auto &diagnostic : file.diagnostics) {
+    if (!readDiagnostic(in, diagnostic)) {
+      return std::nullopt;
+    }
+  }
+  if (!in.atEnd()) {
+    return std::nullopt;
+  }
+  return file;
+}
+
+Result<void> CompileCache::store(const std::string &path, u64 key,
+                                 const CompiledFile &file) const {
+  Writer out;
+  out.write(CACHE_MAGIC);
+  out.write(CACHE_FORMAT_VERSION);
+  out.write(key);
+  out.writeString(path);
+
+  out.writeStrings(file.scenes);
+  out.writeStrings(file.characters);
+  out.writeLocations(file.sceneLocations);
+  out.writeLocations(file.characterLocations);
+  out.writeStrings(file.importedScenes);
+  out.writeStrings(file.importedCharacters);
+  out.write(file.fragment.globalsStart);
+  writeScript(out, file.fragment.script);
+  out.write(static_cast<u32>(file.fragment.externalJumps.size()));
+  for (const auto &jump : file.fragment.externalJumps) {
+    out.write(jump.instruction);
+    out.writeString(jump.scene);
+  }
+  out.write(static_cast<u32>(file.diagnostics.size()));
+  for (const auto &diagnostic : file.diagnostics) {
+    writeDiagnostic(out, diagnostic);
+  }
+
+  std::error_code ec;
+  fs::create_directories(m_directory, ec);
+  if (ec) {
+    return Result<void>::error("Cannot create cache directory: " +
+                               m_directory + " (" + ec.message() + ")");
+  }
+
+  const std::string target = entryPath(path);
+  const std::string temporary = target + "." + toHex(key) + ".tmp";
+  {
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open() ||
+        !stream.write(reinterpret_cast<const char *>(out.data().data()),
+                      static_cast<std::streamsize>(out.data().size()))) {
+      return Result<void>::error("Cannot write cache entry: " + temporary);
+    }
+  }
+  fs::rename(temporary, target, ec);
+  if (ec) {
+    fs::remove(temporary, ec);
+    return Result<void>::error("Cannot write cache entry: " + target);
+  }
+  return Result<void>::ok();
+}
+
+} // namespace NovelMind::scripting
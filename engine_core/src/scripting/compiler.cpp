@@ -1,4 +1,5 @@
 #include "NovelMind/scripting/compiler.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace NovelMind::scripting {
@@ -6,6 +7,20 @@ namespace NovelMind::scripting {
 Compiler::Compiler() = default;
 Compiler::~Compiler() = default;
 
+const SourceLocation *
+findSourceLocation(const std::vector<LineTableEntry> &lineTable,
+                   u32 instruction) {
+  auto it = std::upper_bound(
+      lineTable.begin(), lineTable.end(), instruction,
+      [](u32 value, const LineTableEntry &entry) {
+        return value < entry.instruction;
+      });
+  if (it == lineTable.begin()) {
+    return nullptr;
+  }
+  return &std::prev(it)->location;
+}
+
 Result<CompiledScript> Compiler::compile(const Program &program) {
   reset();
 
@@ -17,15 +32,10 @@ Result<CompiledScript> Compiler::compile(const Program &program) {
     }
   }
 
-  // Resolve pending jumps
-  for (const auto &pending : m_pendingJumps) {
-    auto it = m_labels.find(pending.targetLabel);
-    if (it != m_labels.end()) {
-      m_output.instructions[pending.instructionIndex].operand = it->second;
-    } else {
-      error("Undefined label: " + pending.targetLabel);
-    }
-  }
+  // Add HALT at end
+  emit(OpCode::HALT);
+
+  resolvePendingJumps(nullptr);
 
   if (!m_errors.empty()) {
     return Result<CompiledScript>::error(m_errors[0].message);
@@ -34,6 +44,29 @@ Result<CompiledScript> Compiler::compile(const Program &program) {
   return Result<CompiledScript>::ok(std::move(m_output));
 }
 
+Result<ScriptFragment> Compiler::compileFragment(const Program &program) {
+  reset();
+
+  try {
+    compileProgram(program);
+  } catch (...) {
+    if (m_errors.empty()) {
+      error("Internal compiler error");
+    }
+  }
+
+  ScriptFragment fragment;
+  resolvePendingJumps(&fragment.externalJumps);
+
+  if (!m_errors.empty()) {
+    return Result<ScriptFragment>::error(m_errors[0].message);
+  }
+
+  fragment.script = std::move(m_output);
+  fragment.globalsStart = m_globalsStart;
+  return Result<ScriptFragment>::ok(std::move(fragment));
+}
+
 const std::vector<CompileError> &Compiler::getErrors() const {
   return m_errors;
 }
@@ -43,6 +76,8 @@ void Compiler::reset() {
   m_errors.clear();
   m_pendingJumps.clear();
   m_labels.clear();
+  m_globalsStart = 0;
+  m_variableSlots.clear();
   m_currentScene.clear();
 }
 
@@ -61,7 +96,7 @@ void Compiler::patchJump(u32 jumpIndex) {
   m_output.instructions[jumpIndex].operand = target;
 }
 
-u32 Compiler::addString(const std::string &str) {
+u32 Compiler::addString(std::string_view str) {
   // Check if string already exists
   for (u32 i = 0; i < m_output.stringTable.size(); ++i) {
     if (m_output.stringTable[i] == str) {
@@ -70,10 +105,23 @@ u32 Compiler::addString(const std::string &str) {
   }
 
   u32 index = static_cast<u32>(m_output.stringTable.size());
-  m_output.stringTable.push_back(str);
+  m_output.stringTable.emplace_back(str);
   return index;
 }
 
+u32 Compiler::addVariableSlot(std::string_view name) {
+  std::string key(name);
+  auto it = m_variableSlots.find(key);
+  if (it != m_variableSlots.end()) {
+    return it->second;
+  }
+
+  u32 slot = static_cast<u32>(m_output.variableSlots.size());
+  m_output.variableSlots.push_back(key);
+  m_variableSlots.emplace(std::move(key), slot);
+  return slot;
+}
+
 void Compiler::error(const std::string &message, SourceLocation loc) {
   m_errors.emplace_back(message, loc);
 }
@@ -90,25 +138,43 @@ void Compiler::compileProgram(const Program &program) {
   }
 
   // Global statements (if any)
+  m_globalsStart = static_cast<u32>(m_output.instructions.size());
   for (const auto &stmt : program.globalStatements) {
     if (stmt) {
       compileStatement(*stmt);
     }
   }
+}
 
-  // Add HALT at end
-  emit(OpCode::HALT);
+void Compiler::resolvePendingJumps(std::vector<ExternalJump> *externalJumps) {
+  for (const auto &pending : m_pendingJumps) {
+    auto it = m_labels.find(pending.targetLabel);
+    if (it != m_labels.end()) {
+      m_output.instructions[pending.instructionIndex].operand = it->second;
+    } else if (externalJumps) {
+      externalJumps->push_back({pending.instructionIndex, pending.targetLabel});
+    } else {
+      error("Undefined label: " + pending.targetLabel);
+    }
+  }
 }
 
 void Compiler::compileCharacter(const CharacterDecl &decl) {
-  m_output.characters[decl.id] = decl;
+  CompiledCharacter character;
+  character.id = decl.id;
+  character.displayName = decl.displayName;
+  character.color = decl.color;
+  if (decl.defaultSprite) {
+    character.defaultSprite = std::string(*decl.defaultSprite);
+  }
+  m_output.characters[character.id] = std::move(character);
 }
 
 void Compiler::compileScene(const SceneDecl &decl) {
   // Record entry point
   u32 entryPoint = static_cast<u32>(m_output.instructions.size());
-  m_output.sceneEntryPoints[decl.name] = entryPoint;
-  m_labels[decl.name] = entryPoint;
+  m_output.sceneEntryPoints[std::string(decl.name)] = entryPoint;
+  m_labels[std::string(decl.name)] = entryPoint;
 
   m_currentScene = decl.name;
 
@@ -122,7 +188,23 @@ void Compiler::compileScene(const SceneDecl &decl) {
   m_currentScene.clear();
 }
 
+void Compiler::markSourceLocation(SourceLocation loc) {
+  const u32 next = static_cast<u32>(m_output.instructions.size());
+  auto &lines = m_output.lineTable;
+  // A statement that emitted nothing yields its entry to the next one
+  if (!lines.empty() && lines.back().instruction == next) {
+    lines.back().location = loc;
+    return;
+  }
+  if (!lines.empty() && lines.back().location.line == loc.line &&
+      lines.back().location.column == loc.column) {
+    return;
+  }
+  lines.push_back({next, loc});
+}
+
 void Compiler::compileStatement(const Statement &stmt) {
+  markSourceLocation(stmt.location);
   std::visit(
       [this](const auto &s) {
         using T = std::decay_t<decltype(s)>;
@@ -309,7 +391,7 @@ void Compiler::compileChoiceStmt(const ChoiceStmt &stmt) {
         // Forward reference to scene/label
         u32 jumpIndex = static_cast<u32>(m_output.instructions.size());
         emit(OpCode::JUMP, 0);
-        m_pendingJumps.push_back({jumpIndex, option.gotoTarget.value()});
+        m_pendingJumps.push_back({jumpIndex, std::string(*option.gotoTarget)});
       } else {
         for (const auto &bodyStmt : option.body) {
           if (bodyStmt) {
@@ -324,7 +406,7 @@ void Compiler::compileChoiceStmt(const ChoiceStmt &stmt) {
       if (option.gotoTarget.has_value()) {
         u32 jumpIndex = static_cast<u32>(m_output.instructions.size());
         emit(OpCode::JUMP, 0);
-        m_pendingJumps.push_back({jumpIndex, option.gotoTarget.value()});
+        m_pendingJumps.push_back({jumpIndex, std::string(*option.gotoTarget)});
       } else {
         for (const auto &bodyStmt : option.body) {
           if (bodyStmt) {
@@ -382,7 +464,7 @@ void Compiler::compileIfStmt(const IfStmt &stmt) {
 void Compiler::compileGotoStmt(const GotoStmt &stmt) {
   u32 jumpIndex = static_cast<u32>(m_output.instructions.size());
   emit(OpCode::GOTO_SCENE, 0);
-  m_pendingJumps.push_back({jumpIndex, stmt.target});
+  m_pendingJumps.push_back({jumpIndex, std::string(stmt.target)});
 }
 
 void Compiler::compileWaitStmt(const WaitStmt &stmt) {
@@ -410,19 +492,16 @@ void Compiler::compileStopStmt(const StopStmt &stmt) {
     emit(OpCode::PUSH_INT, durInt);
   }
 
-  emit(OpCode::STOP_MUSIC);
+  // Operand tells the VM whether a fade duration was pushed
+  emit(OpCode::STOP_MUSIC, stmt.fadeOut.has_value() ? 1u : 0u);
 }
 
 void Compiler::compileSetStmt(const SetStmt &stmt) {
   // Compile value expression
   compileExpression(*stmt.value);
 
-  // Store to variable
-  u32 varIndex = addString(stmt.variable);
-
-  // Check if it's a flag (boolean) or general variable
-  // For simplicity, use STORE_GLOBAL for all variables
-  emit(OpCode::STORE_GLOBAL, varIndex);
+  // Store to variable (resolved to a dense slot at compile time)
+  emit(OpCode::STORE_SLOT, addVariableSlot(stmt.variable));
 }
 
 void Compiler::compileTransitionStmt(const TransitionStmt &stmt) {
@@ -465,7 +544,7 @@ void Compiler::compileLiteral(const LiteralExpr &expr) {
           emit(OpCode::PUSH_FLOAT, intRep);
         } else if constexpr (std::is_same_v<T, bool>) {
           emit(OpCode::PUSH_BOOL, val ? 1 : 0);
-        } else if constexpr (std::is_same_v<T, std::string>) {
+        } else if constexpr (std::is_same_v<T, std::string_view>) {
           u32 index = addString(val);
           emit(OpCode::PUSH_STRING, index);
         }
@@ -474,8 +553,7 @@ void Compiler::compileLiteral(const LiteralExpr &expr) {
 }
 
 void Compiler::compileIdentifier(const IdentifierExpr &expr) {
-  u32 nameIndex = addString(expr.name);
-  emit(OpCode::LOAD_GLOBAL, nameIndex);
+  emit(OpCode::LOAD_SLOT, addVariableSlot(expr.name));
 }
 
 void Compiler::compileBinary(const BinaryExpr &expr) {
@@ -484,24 +562,12 @@ void Compiler::compileBinary(const BinaryExpr &expr) {
     compileExpression(*expr.left);
   }
 
-  // Short-circuit for and/or
-  if (expr.op == TokenType::And) {
-    u32 endJump = emitJump(OpCode::JUMP_IF_NOT);
-    emit(OpCode::POP);
-
-    if (expr.right) {
-      compileExpression(*expr.right);
-    }
-
-    patchJump(endJump);
-    return;
-  }
-
-  if (expr.op == TokenType::Or) {
-    u32 elseJump = emitJump(OpCode::JUMP_IF_NOT);
-    u32 endJump = emitJump(OpCode::JUMP);
-
-    patchJump(elseJump);
+  // Short-circuit for and/or. The jump pops its condition, so test a copy;
+  // the deciding operand is then made a bool, as the AND/OR opcodes do.
+  if (expr.op == TokenType::And || expr.op == TokenType::Or) {
+    emit(OpCode::DUP);
+    u32 endJump = emitJump(expr.op == TokenType::And ? OpCode::JUMP_IF_NOT
+                                                     : OpCode::JUMP_IF);
     emit(OpCode::POP);
 
     if (expr.right) {
@@ -509,6 +575,8 @@ void Compiler::compileBinary(const BinaryExpr &expr) {
     }
 
     patchJump(endJump);
+    emit(OpCode::NOT);
+    emit(OpCode::NOT);
     return;
   }
 
@@ -0,0 +1,761 @@
+#include "NovelMind/scripting/graph_cache.hpp"
+#include "NovelMind/core/json.hpp"
+#include "NovelMind/core/mapped_file.hpp"
+#include "NovelMind/scripting/compile_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace NovelMind::scripting {
+
+namespace {
+
+// ============================================================================
+// Binary graph format
+//
+// Header, then in order: string offsets (stringCount + 1 entries), string
+// bytes (padded to 8), nodes, properties, list entries or ports, edges,
+// scenes and characters. Every table holds fixed-size records, so the
+// header alone fixes the size and position of each; strings are referenced
+// by index everywhere.
+// ============================================================================
+
+constexpr u32 GRAPH_MAGIC = 0x42474D4E; // "NMGB"
+constexpr u16 GRAPH_FORMAT_VERSION = 1;
+constexpr u8 KIND_IR_GRAPH = 1;
+constexpr u8 KIND_VISUAL_GRAPH = 2;
+
+struct BlobHeader {
+  u32 magic;
+  u16 version;
+  u8 kind;
+  u8 reserved;
+  u64 sourceHash;
+  u64 nextId;
+  u32 name; // String index; IRGraph only
+  u32 stringCount;
+  u32 stringBytes;
+  u32 nodeCount;
+  u32 propertyCount;
+  u32 auxCount; // IRGraph: string list entries; VisualGraph: ports
+  u32 edgeCount;
+  u32 sceneCount;
+  u32 characterCount;
+  u32 padding;
+};
+static_assert(sizeof(BlobHeader) == 64);
+
+struct IRNodeRecord {
+  u64 id;
+  f32 x;
+  f32 y;
+  u32 firstProperty;
+  u32 propertyCount;
+  u8 type;
+  u8 padding[7];
+};
+static_assert(sizeof(IRNodeRecord) == 32);
+
+// kind is the IRPropertyValue alternative. payload holds a bool or i64, the
+// bits of an f64, a string index, or (first << 32 | count) of a list
+struct IRPropertyRecord {
+  u32 key;
+  u8 kind;
+  u8 padding[3];
+  u64 payload;
+};
+static_assert(sizeof(IRPropertyRecord) == 16);
+
+struct VisualNodeRecord {
+  u64 id;
+  f32 x;
+  f32 y;
+  f32 width;
+  f32 height;
+  u32 type;
+  u32 displayName;
+  u32 firstProperty;
+  u32 propertyCount;
+  u32 firstPort; // Inputs, then outputs
+  u16 inputCount;
+  u16 outputCount;
+};
+static_assert(sizeof(VisualNodeRecord) == 48);
+
+struct StringPairRecord { // Visual property (key, value) or port
+  u32 first;
+  u32 second;
+};
+
+struct EdgeRecord {
+  u64 sourceNode;
+  u64 targetNode;
+  u32 sourcePort;
+  u32 targetPort;
+};
+static_assert(sizeof(EdgeRecord) == 24);
+
+struct SceneRecord {
+  u64 node;
+  u32 name;
+  u32 padding;
+};
+
+struct CharacterRecord {
+  u32 id;
+  u32 name;
+  u32 color;
+};
+
+constexpr usize align8(usize size) { return (size + 7) & ~usize{7}; }
+
+template <typename T> void appendRecords(std::vector<u8> &out,
+                                         const std::vector<T> &records) {
+  const usize offset = out.size();
+  out.resize(offset + records.size() * sizeof(T));
+  if (!records.empty()) {
+    std::memcpy(out.data() + offset, records.data(),
+                records.size() * sizeof(T));
+  }
+}
+
+// Collects the tables of a blob; strings are interned as they are added
+class BlobWriter {
+public:
+  u32 intern(std::string_view text) {
+    auto [it, inserted] =
+        m_index.try_emplace(std::string(text), static_cast<u32>(m_offsets.size()));
+    if (inserted) {
+      m_offsets.push_back(static_cast<u32>(m_bytes.size()));
+      m_bytes.append(text);
+    }
+    return it->second;
+  }
+
+  // Lay out the header and string table, then let @p tables append the rest
+  template <typename Fn> std::vector<u8> finish(BlobHeader header, Fn &&tables) {
+    header.magic = GRAPH_MAGIC;
+    header.version = GRAPH_FORMAT_VERSION;
+    header.stringCount = static_cast<u32>(m_offsets.size());
+    header.stringBytes = static_cast<u32>(m_bytes.size());
+
+    std::vector<u8> out(sizeof(BlobHeader));
+    std::memcpy(out.data(), &header, sizeof(BlobHeader));
+    m_offsets.push_back(static_cast<u32>(m_bytes.size()));
+    appendRecords(out, m_offsets);
+    out.insert(out.end(), m_bytes.begin(), m_bytes.end());
+    out.resize(align8(out.size()));
+    tables(out);
+    return out;
+  }
+
+private:
+  std::unordered_map<std::string, u32> m_index;
+  std::vector<u32> m_offsets;
+  std::string m_bytes;
+};
+
+// Bounds-checked view of a blob; every accessor validates its index
+class BlobReader {
+public:
+  BlobReader(const u8 *data, usize size) : m_data(data), m_size(size) {}
+
+  [[nodiscard]] std::string parse(u8 kind, u64 sourceHash) {
+    if (m_size < sizeof(BlobHeader)) {
+      return "Graph cache entry is truncated";
+    }
+    std::memcpy(&m_header, m_data, sizeof(BlobHeader));
+    if (m_header.magic != GRAPH_MAGIC ||
+        m_header.version != GRAPH_FORMAT_VERSION || m_header.kind != kind) {
+      return "Not a graph cache entry of this version";
+    }
+    if (m_header.sourceHash != sourceHash) {
+      return "Graph cache entry is stale";
+    }
+
+    const bool ir = kind == KIND_IR_GRAPH;
+    u64 offset = sizeof(BlobHeader);
+    m_offsets = offset;
+    offset += (u64{m_header.stringCount} + 1) * sizeof(u32);
+    m_strings = offset;
+    offset = align8(offset + m_header.stringBytes);
+    m_nodes = offset;
+    offset += u64{m_header.nodeCount} *
+              (ir ? sizeof(IRNodeRecord) : sizeof(VisualNodeRecord));
+    m_properties = offset;
+    offset += u64{m_header.propertyCount} *
+              (ir ? sizeof(IRPropertyRecord) : sizeof(StringPairRecord));
+    m_aux = offset;
+    offset += u64{m_header.auxCount} *
+              (ir ? sizeof(u32) : sizeof(StringPairRecord));
+    m_edges = offset;
+    offset += u64{m_header.edgeCount} * sizeof(EdgeRecord);
+    m_scenes = offset;
+    offset += u64{m_header.sceneCount} * sizeof(SceneRecord);
+    m_characters = offset;
+    offset += u64{m_header.characterCount} * sizeof(CharacterRecord);
+    if (offset != m_size) {
+      return "Graph cache entry has the wrong size";
+    }
+
+    u32 previous = 0;
+    for (u32 i = 0; i <= m_header.stringCount; ++i) {
+      const u32 current = at<u32>(m_offsets, i);
+      if (current < previous || current > m_header.stringBytes) {
+        return "Graph cache entry has a damaged string table";
+      }
+      previous = current;
+    }
+    if (previous != m_header.stringBytes) {
+      return "Graph cache entry has a damaged string table";
+    }
+    return {};
+  }
+
+  [[nodiscard]] const BlobHeader &header() const { return m_header; }
+
+  // Index of a string, checked; sets the error flag when out of range
+  [[nodiscard]] std::string_view string(u32 index) {
+    if (index >= m_header.stringCount) {
+      m_damaged = true;
+      return {};
+    }
+    const u32 begin = at<u32>(m_offsets, index);
+    const u32 end = at<u32>(m_offsets, index + 1);
+    return {reinterpret_cast<const char *>(m_data + m_strings + begin),
+            end - begin};
+  }
+
+  template <typename T> [[nodiscard]] T node(u32 i) const {
+    return at<T>(m_nodes, i);
+  }
+  template <typename T> [[nodiscard]] T property(u32 i) const {
+    return at<T>(m_properties, i);
+  }
+  template <typename T> [[nodiscard]] T aux(u32 i) const {
+    return at<T>(m_aux, i);
+  }
+  [[nodiscard]] EdgeRecord edge(u32 i) const { return at<EdgeRecord>(m_edges, i); }
+  [[nodiscard]] SceneRecord scene(u32 i) const {
+    return at<SceneRecord>(m_scenes, i);
+  }
+  [[nodiscard]] CharacterRecord character(u32 i) const {
+    return at<CharacterRecord>(m_characters, i);
+  }
+
+  // Whether [first, first + count) lies inside a table of @p size records
+  [[nodiscard]] bool inRange(u64 first, u64 count, u32 size) {
+    if (first + count > size) {
+      m_damaged = true;
+    }
+    return !m_damaged;
+  }
+
+  [[nodiscard]] bool damaged() const { return m_damaged; }
+
+private:
+  template <typename T> [[nodiscard]] T at(u64 base, u64 index) const {
+    T record;
+    std::memcpy(&record, m_data + base + index * sizeof(T), sizeof(T));
+    return record;
+  }
+
+  const u8 *m_data;
+  usize m_size;
+  BlobHeader m_header{};
+  u64 m_offsets = 0;
+  u64 m_strings = 0;
+  u64 m_nodes = 0;
+  u64 m_properties = 0;
+  u64 m_aux = 0;
+  u64 m_edges = 0;
+  u64 m_scenes = 0;
+  u64 m_characters = 0;
+  bool m_damaged = false;
+};
+
+template <typename Graph>
+Result<std::unique_ptr<Graph>> damagedEntry() {
+  return Result<std::unique_ptr<Graph>>::error(
+      "Graph cache entry is damaged");
+}
+
+std::string toHex(u64 value) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+template <typename Graph>
+Result<std::unique_ptr<Graph>> readGraph(core::JsonReader &reader);
+
+template <>
+Result<std::unique_ptr<IRGraph>> readGraph<IRGraph>(core::JsonReader &reader) {
+  return IRGraph::readJson(reader);
+}
+
+template <>
+Result<std::unique_ptr<VisualGraph>>
+readGraph<VisualGraph>(core::JsonReader &reader) {
+  return VisualGraph::readJson(reader);
+}
+
+} // namespace
+
+// ============================================================================
+// IRGraph
+// ============================================================================
+
+std::vector<u8> IRGraph::toBinary(u64 sourceHash) const {
+  BlobWriter writer;
+  BlobHeader header{};
+  header.kind = KIND_IR_GRAPH;
+  header.sourceHash = sourceHash;
+  header.nextId = m_nextId;
+  header.name = writer.intern(m_name);
+
+  // Nodes are written in ID order so equal graphs give equal blobs
+  std::vector<const IRNode *> nodes;
+  nodes.reserve(m_nodes.size());
+  for (const auto &[id, node] : m_nodes) {
+    nodes.push_back(node.get());
+  }
+  std::sort(nodes.begin(), nodes.end(), [](const auto *a, const auto *b) {
+    return a->getId() < b->getId();
+  });
+
+  std::vector<IRNodeRecord> nodeRecords;
+  std::vector<IRPropertyRecord> properties;
+  std::vector<u32> listEntries;
+  nodeRecords.reserve(nodes.size());
+  for (const auto *node : nodes) {
+    IRNodeRecord record{};
+    record.id = node->getId();
+    record.x = node->getX();
+    record.y = node->getY();
+    record.type = static_cast<u8>(node->getType());
+    record.firstProperty = static_cast<u32>(properties.size());
+    record.propertyCount = static_cast<u32>(node->getProperties().size());
+    for (const auto &[name, value] : node->getProperties()) {
+      IRPropertyRecord property{};
+      property.key = writer.intern(name);
+      property.kind = static_cast<u8>(value.index());
+      std::visit(
+          [&](const auto &v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, bool>) {
+              property.payload = v ? 1 : 0;
+            } else if constexpr (std::is_same_v<T, i64>) {
+              property.payload = static_cast<u64>(v);
+            } else if constexpr (std::is_same_v<T, f64>) {
+              std::memcpy(&property.payload, &v, sizeof(f64));
+            } else if constexpr (std::is_same_v<T, std::string>) {
+              property.payload = writer.intern(v);
+            } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+              property.payload =
+                  (static_cast<u64>(listEntries.size()) << 32) | v.size();
+              for (const auto &item : v) {
+                listEntries.push_back(writer.intern(item));
+              }
+            }
+          },
+          value);
+      properties.push_back(property);
+    }
+    nodeRecords.push_back(record);
+  }
+
+  std::vector<EdgeRecord> edges;
+  edges.reserve(m_connections.size());
+  for (const auto &conn : m_connections) {
+    edges.push_back({conn.source.nodeId, conn.target.nodeId,
+                     writer.intern(conn.source.portName),
+                     writer.intern(conn.target.portName)});
+  }
+
+  std::vector<SceneRecord> scenes;
+  for (const auto &[name, node] : m_sceneStartNodes) {
+    scenes.push_back({node, writer.intern(name), 0});
+  }
+  std::vector<CharacterRecord> characters;
+  for (const auto &[id, info] : m_characters) {
+    characters.push_back({writer.intern(id), writer.intern(info.first),
+                          writer.intern(info.second)});
+  }
+
+  header.nodeCount = static_cast<u32>(nodeRecords.size());
+  header.propertyCount = static_cast<u32>(properties.size());
+  header.auxCount = static_cast<u32>(listEntries.size());
+  header.edgeCount = static_cast<u32>(edges.size());
+  header.sceneCount = static_cast<u32>(scenes.size());
+  header.characterCount = static_cast<u32>(characters.size());
+  return writer.finish(header, [&](std::vector<u8> &out) {
+    appendRecords(out, nodeRecords);
+    appendRecords(out, properties);
+    appendRecords(out, listEntries);
+    appendRecords(out, edges);
+    appendRecords(out, scenes);
+    appendRecords(out, characters);
+  });
+}
+
+Result<std::unique_ptr<IRGraph>>
+IRGraph::fromBinary(const u8 *data, usize size, u64 sourceHash) {
+  using GraphResult = Result<std::unique_ptr<IRGraph>>;
+  BlobReader blob(data, size);
+  if (auto error = blob.parse(KIND_IR_GRAPH, sourceHash); !error.empty()) {
+    return GraphResult::error(error);
+  }
+  const BlobHeader &header = blob.header();
+
+  auto graph = std::make_unique<IRGraph>();
+  graph->m_name = blob.string(header.name);
+  graph->m_nextId = header.nextId;
+  graph->m_nodes.reserve(header.nodeCount);
+  graph->m_adjacency.reserve(header.nodeCount);
+  for (u32 i = 0; i < header.nodeCount; ++i) {
+    const auto record = blob.node<IRNodeRecord>(i);
+    if (record.type > static_cast<u8>(IRNodeType::Custom) ||
+        record.id >= header.nextId ||
+        !blob.inRange(record.firstProperty, record.propertyCount,
+                      header.propertyCount)) {
+      return damagedEntry<IRGraph>();
+    }
+    auto node = std::make_unique<IRNode>(
+        record.id, static_cast<IRNodeType>(record.type));
+    node->setPosition(record.x, record.y);
+    for (u32 p = 0; p < record.propertyCount; ++p) {
+      const auto property =
+          blob.property<IRPropertyRecord>(record.firstProperty + p);
+      const std::string key(blob.string(property.key));
+      switch (property.kind) {
+      case 0:
+        node->setProperty(key, nullptr);
+        break;
+      case 1:
+        node->setProperty(key, property.payload != 0);
+        break;
+      case 2:
+        node->setProperty(key, static_cast<i64>(property.payload));
+        break;
+      case 3: {
+        f64 number = 0.0;
+        std::memcpy(&number, &property.payload, sizeof(f64));
+        node->setProperty(key, number);
+        break;
+      }
+      case 4:
+        if (property.payload > 0xFFFFFFFFu) {
+          return damagedEntry<IRGraph>();
+        }
+        node->setProperty(
+            key, std::string(blob.string(static_cast<u32>(property.payload))));
+        break;
+      case 5: {
+        const u64 first = property.payload >> 32;
+        const u64 count = property.payload & 0xFFFFFFFFu;
+        if (!blob.inRange(first, count, header.auxCount)) {
+          return damagedEntry<IRGraph>();
+        }
+        std::vector<std::string> items;
+        items.reserve(count);
+        for (u64 item = 0; item < count; ++item) {
+          items.emplace_back(
+              blob.string(blob.aux<u32>(static_cast<u32>(first + item))));
+        }
+        node->setProperty(key, std::move(items));
+        break;
+      }
+      default:
+        return damagedEntry<IRGraph>();
+      }
+    }
+    if (!graph->m_nodes.try_emplace(record.id, std::move(node)).second) {
+      return damagedEntry<IRGraph>();
+    }
+    graph->m_adjacency.try_emplace(record.id);
+  }
+
+  graph->m_connections.reserve(header.edgeCount);
+  for (u32 i = 0; i < header.edgeCount; ++i) {
+    const auto edge = blob.edge(i);
+    PortId source{edge.sourceNode, std::string(blob.string(edge.sourcePort)),
+                  true};
+    PortId target{edge.targetNode, std::string(blob.string(edge.targetPort)),
+                  false};
+    if (graph->connect(source, target).isError()) {
+      return damagedEntry<IRGraph>();
+    }
+  }
+  for (u32 i = 0; i < header.sceneCount; ++i) {
+    const auto scene = blob.scene(i);
+    graph->m_sceneStartNodes.emplace(blob.string(scene.name), scene.node);
+  }
+  for (u32 i = 0; i < header.characterCount; ++i) {
+    const auto character = blob.character(i);
+    graph->m_characters.emplace(
+        blob.string(character.id),
+        std::make_pair(std::string(blob.string(character.name)),
+                       std::string(blob.string(character.color))));
+  }
+
+  if (blob.damaged()) {
+    return damagedEntry<IRGraph>();
+  }
+  return GraphResult::ok(std::move(graph));
+}
+
+// ============================================================================
+// VisualGraph
+// ============================================================================
+
+std::vector<u8> VisualGraph::toBinary(u64 sourceHash) const {
+  BlobWriter writer;
+  BlobHeader header{};
+  header.kind = KIND_VISUAL_GRAPH;
+  header.sourceHash = sourceHash;
+  header.nextId = m_nextId;
+
+  std::vector<VisualNodeRecord> nodes;
+  std::vector<StringPairRecord> properties;
+  std::vector<StringPairRecord> ports;
+  nodes.reserve(m_nodes.size());
+  for (const auto &node : m_nodes) {
+    VisualNodeRecord record{};
+    record.id = node.id;
+    record.x = node.x;
+    record.y = node.y;
+    record.width = node.width;
+    record.height = node.height;
+    record.type = writer.intern(node.type);
+    record.displayName = writer.intern(node.displayName);
+    record.firstProperty = static_cast<u32>(properties.size());
+    record.propertyCount = static_cast<u32>(node.properties.size());
+    for (const auto &[key, value] : node.properties) {
+      properties.push_back({writer.intern(key), writer.intern(value)});
+    }
+    record.firstPort = static_cast<u32>(ports.size());
+    record.inputCount = static_cast<u16>(node.inputPorts.size());
+    record.outputCount = static_cast<u16>(node.outputPorts.size());
+    for (const auto *list : {&node.inputPorts, &node.outputPorts}) {
+      for (const auto &[name, displayName] : *list) {
+        ports.push_back({writer.intern(name), writer.intern(displayName)});
+      }
+    }
+    nodes.push_back(record);
+  }
+
+  std::vector<EdgeRecord> edges;
+  edges.reserve(m_edges.size());
+  for (const auto &edge : m_edges) {
+    edges.push_back({edge.sourceNode, edge.targetNode,
+                     writer.intern(edge.sourcePort),
+                     writer.intern(edge.targetPort)});
+  }
+
+  header.nodeCount = static_cast<u32>(nodes.size());
+  header.propertyCount = static_cast<u32>(properties.size());
+  header.auxCount = static_cast<u32>(ports.size());
+  header.edgeCount = static_cast<u32>(edges.size());
+  return writer.finish(header, [&](std::vector<u8> &out) {
+    appendRecords(out, nodes);
+    appendRecords(out, properties);
+    appendRecords(out, ports);
+    appendRecords(out, edges);
+  });
+}
+
+Result<std::unique_ptr<VisualGraph>>
+VisualGraph::fromBinary(const u8 *data, usize size, u64 sourceHash) {
+  using GraphResult = Result<std::unique_ptr<VisualGraph>>;
+  BlobReader blob(data, size);
+  if (auto error = blob.parse(KIND_VISUAL_GRAPH, sourceHash); !error.empty()) {
+    return GraphResult::error(error);
+  }
+  const BlobHeader &header = blob.header();
+  if (header.sceneCount != 0 || header.characterCount != 0) {
+    return damagedEntry<VisualGraph>();
+  }
+
+  auto graph = std::make_unique<VisualGraph>();
+  graph->m_nextId = header.nextId;
+  graph->m_nodes.reserve(header.nodeCount);
+  const auto readPorts = [&](u32 first, u32 count,
+                             std::vector<std::pair<std::string, std::string>> &out) {
+    out.reserve(count);
+    for (u32 i = 0; i < count; ++i) {
+      const auto port = blob.aux<StringPairRecord>(first + i);
+      out.emplace_back(blob.string(port.first), blob.string(port.second));
+    }
+  };
+  for (u32 i = 0; i < header.nodeCount; ++i) {
+    const auto record = blob.node<VisualNodeRecord>(i);
+    if (record.id >= header.nextId ||
+        !blob.inRange(record.firstProperty, record.propertyCount,
+                      header.propertyCount) ||
+        !blob.inRange(record.firstPort,
+                      u64{record.inputCount} + record.outputCount,
+                      header.auxCount)) {
+      return damagedEntry<VisualGraph>();
+    }
+    VisualGraphNode node;
+    node.id = record.id;
+    node.type = blob.string(record.type);
+    node.displayName = blob.string(record.displayName);
+    node.x = record.x;
+    node.y = record.y;
+    node.width = record.width;
+    node.height = record.height;
+    node.properties.reserve(record.propertyCount);
+    for (u32 p = 0; p < record.propertyCount; ++p) {
+      const auto property =
+          blob.property<StringPairRecord>(record.firstProperty + p);
+      node.properties.emplace(blob.string(property.first),
+                              blob.string(property.second));
+    }
+    readPorts(record.firstPort, record.inputCount, node.inputPorts);
+    readPorts(record.firstPort + record.inputCount, record.outputCount,
+              node.outputPorts);
+    graph->m_nodes.push_back(std::move(node));
+  }
+
+  graph->m_edges.reserve(header.edgeCount);
+  for (u32 i = 0; i < header.edgeCount; ++i) {
+    const auto record = blob.edge(i);
+    VisualGraphEdge edge;
+    edge.sourceNode = record.sourceNode;
+    edge.sourcePort = blob.string(record.sourcePort);
+    edge.targetNode = record.targetNode;
+    edge.targetPort = blob.string(record.targetPort);
+    graph->m_edges.push_back(std::move(edge));
+  }
+
+  if (blob.damaged()) {
+    return damagedEntry<VisualGraph>();
+  }
+  return GraphResult::ok(std::move(graph));
+}
+
+// ============================================================================
+// GraphCache
+// ============================================================================
+
+GraphCache::GraphCache(std::string directory)
+    : m_directory(std::move(directory)) {}
+
+u64 GraphCache::hashSource(std::string_view json) {
+  return CompileCache::hashContent(json, GRAPH_FORMAT_VERSION);
+}
+
+std::string GraphCache::entryPath(const std::string &jsonPath,
+                                  std::string_view extension) const {
+  std::string name = toHex(CompileCache::hashContent(jsonPath));
+  name += extension;
+  return (fs::path(m_directory) / name).string();
+}
+
+Result<std::unique_ptr<IRGraph>>
+GraphCache::loadIRGraph(const std::string &jsonPath) {
+  return load<IRGraph>(jsonPath, ".nmgi");
+}
+
+Result<std::unique_ptr<VisualGraph>>
+GraphCache::loadVisualGraph(const std::string &jsonPath) {
+  return load<VisualGraph>(jsonPath, ".nmgv");
+}
+
+Result<void> GraphCache::saveIRGraph(const IRGraph &graph,
+                                     const std::string &jsonPath) {
+  return save(graph, jsonPath, ".nmgi");
+}
+
+Result<void> GraphCache::saveVisualGraph(const VisualGraph &graph,
+                                         const std::string &jsonPath) {
+  return save(graph, jsonPath, ".nmgv");
+}
+
+template <typename Graph>
+Result<std::unique_ptr<Graph>> GraphCache::load(const std::string &jsonPath,
+                                                std::string_view extension) {
+  using GraphResult = Result<std::unique_ptr<Graph>>;
+  auto source = core::MappedFile::open(jsonPath);
+  if (source.isError()) {
+    return GraphResult::error(source.error());
+  }
+  const std::string_view json(
+      reinterpret_cast<const char *>(source.value()->data()),
+      source.value()->size());
+  const u64 hash = hashSource(json);
+  const std::string cachePath = entryPath(jsonPath, extension);
+
+  if (auto entry = core::MappedFile::open(cachePath); entry.isOk()) {
+    auto cached =
+        Graph::fromBinary(entry.value()->data(), entry.value()->size(), hash);
+    if (cached.isOk()) {
+      ++m_stats.hits;
+      return cached;
+    }
+  }
+
+  ++m_stats.misses;
+  core::JsonReader reader(json);
+  auto graph = readGraph<Graph>(reader);
+  if (graph.isOk() && reader.next() != core::JsonEvent::End) {
+    return GraphResult::error(jsonPath + ": " + reader.getError());
+  }
+  if (graph.isError()) {
+    return GraphResult::error(jsonPath + ": " + graph.error());
+  }
+  // The cache is an optimization; a read-only project still loads
+  (void)writeEntry(cachePath, graph.value()->toBinary(hash));
+  return graph;
+}
+
+template <typename Graph>
+Result<void> GraphCache::save(const Graph &graph, const std::string &jsonPath,
+                              std::string_view extension) {
+  const std::string json = graph.toJson();
+  {
+    std::ofstream file(jsonPath, std::ios::binary | std::ios::trunc);
+    if (!file ||
+        !file.write(json.data(), static_cast<std::streamsize>(json.size()))) {
+      return Result<void>::error("Failed to write file: " + jsonPath);
+    }
+  }
+  return writeEntry(entryPath(jsonPath, extension),
+                    graph.toBinary(hashSource(json)));
+}
+
+Result<void> GraphCache::writeEntry(const std::string &path,
+                                    const std::vector<u8> &data) const {
+  std::error_code ec;
+  fs::create_directories(m_directory, ec);
+  if (ec) {
+    return Result<void>::error("Cannot create cache directory: " +
+                               m_directory + " (" + ec.message() + ")");
+  }
+
+  // Written aside and renamed so a reader never maps a partial entry
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open() ||
+        !stream.write(reinterpret_cast<const char *>(data.data()),
+                      static_cast<std::streamsize>(data.size()))) {
+      return Result<void>::error("Cannot write cache entry: " + temporary);
+    }
+  }
+  fs::rename(temporary, path, ec);
+  if (ec) {
+    fs::remove(temporary, ec);
+    return Result<void>::error("Cannot write cache entry: " + path);
+  }
+  return Result<void>::ok();
+}
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,569 @@
+#include "NovelMind/scripting/incremental_validator.hpp"
+#include "NovelMind/core/timer.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include <algorithm>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+// Lexical state carried from one line to the next while splitting
+struct SplitState {
+  u32 braceDepth = 0;
+  u32 commentDepth = 0; // Block comments nest
+};
+
+bool isIdentifierChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_';
+}
+
+std::string_view skipBlanks(std::string_view text) {
+  usize i = 0;
+  while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) {
+    ++i;
+  }
+  return text.substr(i);
+}
+
+// Identifier at the start of @p text, empty if there is none
+std::string_view leadingWord(std::string_view text) {
+  usize i = 0;
+  while (i < text.size() && isIdentifierChar(text[i])) {
+    ++i;
+  }
+  return text.substr(0, i);
+}
+
+bool startsDeclaration(std::string_view line) {
+  const std::string_view word = leadingWord(skipBlanks(line));
+  return word == "scene" || word == "character";
+}
+
+// Track braces and comments over one line; strings never span lines
+void scanLine(std::string_view line, SplitState &state) {
+  for (usize i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    const char next = i + 1 < line.size() ? line[i + 1] : '\0';
+    if (state.commentDepth > 0) {
+      if (c == '*' && next == '/') {
+        --state.commentDepth;
+        ++i;
+      } else if (c == '/' && next == '*') {
+        ++state.commentDepth;
+        ++i;
+      }
+      continue;
+    }
+
+    if (c == '"') {
+      for (++i; i < line.size() && line[i] != '"' && line[i] != '\n'; ++i) {
+        if (line[i] == '\\') {
+          ++i;
+        }
+      }
+    } else if (c == '/' && next == '/') {
+      return;
+    } else if (c == '/' && next == '*') {
+      ++state.commentDepth;
+      ++i;
+    } else if (c == '{') {
+      ++state.braceDepth;
+    } else if (c == '}' && state.braceDepth > 0) {
+      --state.braceDepth;
+    }
+  }
+}
+
+// Offsets in @p text of the lines that start a section; the first is 0
+std::vector<usize> findSectionStarts(std::string_view text,
+                                     SplitState &state) {
+  std::vector<usize> starts{0};
+  usize pos = 0;
+  while (pos < text.size()) {
+    usize end = text.find('\n', pos);
+    end = end == std::string_view::npos ? text.size() : end + 1;
+    const std::string_view line = text.substr(pos, end - pos);
+    if (pos > 0 && state.braceDepth == 0 && state.commentDepth == 0 &&
+        startsDeclaration(line)) {
+      starts.push_back(pos);
+    }
+    scanLine(line, state);
+    pos = end;
+  }
+  return starts;
+}
+
+u32 countLines(std::string_view text) {
+  return static_cast<u32>(std::count(text.begin(), text.end(), '\n'));
+}
+
+SourceLocation shift(SourceLocation location, u32 lines) {
+  return SourceLocation(location.line + lines, location.column);
+}
+
+void addShifted(ErrorList &out, const ErrorList &errors, u32 lines) {
+  for (ScriptError error : errors.all()) {
+    error.span.start = shift(error.span.start, lines);
+    error.span.end = shift(error.span.end, lines);
+    for (auto &related : error.relatedInfo) {
+      related.location = shift(related.location, lines);
+    }
+    out.add(std::move(error));
+  }
+}
+
+} // namespace
+
+std::vector<std::string_view> splitDeclarations(std::string_view text) {
+  SplitState state;
+  const std::vector<usize> starts = findSectionStarts(text, state);
+  std::vector<std::string_view> sections;
+  sections.reserve(starts.size());
+  for (usize i = 0; i < starts.size(); ++i) {
+    const usize end = i + 1 < starts.size() ? starts[i + 1] : text.size();
+    sections.push_back(text.substr(starts[i], end - starts[i]));
+  }
+  return sections;
+}
+
+IncrementalValidator::IncrementalValidator() { open({}); }
+
+IncrementalValidator::~IncrementalValidator() = default;
+
+void IncrementalValidator::setReportUnused(bool report) {
+  m_reportUnused = report;
+}
+
+void IncrementalValidator::setReportDeadCode(bool report) {
+  m_reportDeadCode = report;
+}
+
+void IncrementalValidator::open(std::string text) {
+  core::Timer timer;
+  m_text = std::move(text);
+  m_sections.clear();
+  m_symbols = {};
+  m_sceneCounts.clear();
+  m_characterCounts.clear();
+  m_stats = {};
+
+  SplitState state;
+  const std::vector<usize> starts = findSectionStarts(m_text, state);
+  m_sections.resize(starts.size());
+  ChangedSymbols changed;
+  for (usize i = 0; i < starts.size(); ++i) {
+    const usize end = i + 1 < starts.size() ? starts[i + 1] : m_text.size();
+    Section &section = m_sections[i];
+    section.source =
+        SourceFile::create(m_text.substr(starts[i], end - starts[i]));
+    parseSection(section);
+    declare(section, true, changed);
+  }
+  layoutSections(0);
+  for (auto &section : m_sections) {
+    validateSection(section);
+  }
+  analyzeDocument();
+
+  m_stats.sections = m_sections.size();
+  m_stats.seconds = timer.getElapsedSeconds();
+}
+
+Result<void> IncrementalValidator::edit(const TextEdit &edit) {
+  if (edit.offset > m_text.size() ||
+      edit.length > m_text.size() - edit.offset) {
+    return Result<void>::error("Edit outside the document: " +
+                               std::to_string(edit.offset) + "+" +
+                               std::to_string(edit.length));
+  }
+
+  core::Timer timer;
+  m_stats = {};
+
+  // Sections the edit touches. The section ending where the edit starts
+  // joins in, so text typed at a boundary is split again with both sides.
+  usize first = sectionAt(edit.offset);
+  if (first > 0 && m_sections[first].offset == edit.offset) {
+    --first;
+  }
+  usize last = sectionAt(edit.offset + edit.length);
+
+  const usize oldSize = m_text.size();
+  m_text.replace(edit.offset, edit.length, edit.text);
+  const auto sizeAfter = [&](usize oldOffset) {
+    return oldOffset + edit.text.size() - edit.length;
+  };
+
+  // Split the region again; while it ends inside braces or a comment, the
+  // next section's boundary is no longer one, so take that section too
+  const usize begin = m_sections[first].offset;
+  std::vector<usize> starts;
+  usize end = 0;
+  for (;;) {
+    end = sizeAfter(last + 1 < m_sections.size() ? m_sections[last + 1].offset
+                                                 : oldSize);
+    SplitState state;
+    starts = findSectionStarts(
+        std::string_view(m_text).substr(begin, end - begin), state);
+    if ((state.braceDepth == 0 && state.commentDepth == 0) ||
+        last + 1 == m_sections.size()) {
+      break;
+    }
+    ++last;
+  }
+
+  std::vector<std::string_view> texts;
+  for (usize i = 0; i < starts.size(); ++i) {
+    const usize to = i + 1 < starts.size() ? starts[i + 1] : end - begin;
+    texts.push_back(
+        std::string_view(m_text).substr(begin + starts[i], to - starts[i]));
+  }
+
+  // Sections whose text is unchanged keep their parse; match them from
+  // both ends of the region
+  const usize oldCount = last - first + 1;
+  usize prefix = 0;
+  while (prefix < oldCount && prefix < texts.size() &&
+         m_sections[first + prefix].source->getText() == texts[prefix]) {
+    ++prefix;
+  }
+  usize suffix = 0;
+  while (suffix < oldCount - prefix && suffix < texts.size() - prefix &&
+         m_sections[last - suffix].source->getText() ==
+             texts[texts.size() - 1 - suffix]) {
+    ++suffix;
+  }
+
+  ChangedSymbols changed;
+  for (usize i = first + prefix; i + suffix <= last; ++i) {
+    declare(m_sections[i], false, changed);
+  }
+
+  std::vector<Section> replacement(texts.size() - prefix - suffix);
+  for (usize i = 0; i < replacement.size(); ++i) {
+    Section &section = replacement[i];
+    section.source = SourceFile::create(std::string(texts[prefix + i]));
+    parseSection(section);
+    declare(section, true, changed);
+  }
+
+  const auto removeBegin =
+      m_sections.begin() + static_cast<std::ptrdiff_t>(first + prefix);
+  const auto removeEnd = m_sections.begin() +
+                         static_cast<std::ptrdiff_t>(last + 1 - suffix);
+  const auto inserted = m_sections.erase(removeBegin, removeEnd);
+  m_sections.insert(inserted, std::make_move_iterator(replacement.begin()),
+                    std::make_move_iterator(replacement.end()));
+  layoutSections(first);
+
+  const usize newBegin = first + prefix;
+  const usize newEnd = newBegin + replacement.size();
+  for (usize i = 0; i < m_sections.size(); ++i) {
+    if ((i >= newBegin && i < newEnd) || dependsOn(m_sections[i], changed)) {
+      validateSection(m_sections[i]);
+    }
+  }
+  analyzeDocument();
+
+  m_stats.sections = m_sections.size();
+  m_stats.seconds = timer.getElapsedSeconds();
+  return Result<void>::ok();
+}
+
+ErrorList IncrementalValidator::getDiagnostics() const {
+  ErrorList diagnostics;
+  for (const auto &section : m_sections) {
+    addShifted(diagnostics, section.parseErrors, section.line);
+    addShifted(diagnostics, section.result.errors, section.line);
+  }
+  for (const auto &error : m_documentErrors.all()) {
+    diagnostics.add(error);
+  }
+  return diagnostics;
+}
+
+usize IncrementalValidator::sectionAt(usize offset) const {
+  auto it = std::upper_bound(
+      m_sections.begin(), m_sections.end(), offset,
+      [](usize value, const Section &section) { return value < section.offset; });
+  return static_cast<usize>(it - m_sections.begin()) - 1;
+}
+
+void IncrementalValidator::parseSection(Section &section) {
+  ++m_stats.reparsed;
+  section.lineCount = countLines(section.source->getText());
+
+  Lexer lexer;
+  auto tokens = lexer.tokenize(section.source->getText());
+  if (tokens.isError()) {
+    for (const auto &err : lexer.getErrors()) {
+      section.parseErrors.addError(ErrorCode::UnexpectedCharacter, err.message,
+                                   err.location);
+    }
+  } else {
+    Parser parser;
+    auto program = parser.parse(tokens.value());
+    if (program.isOk()) {
+      section.program = std::move(program).value();
+      section.parsed = true;
+    } else {
+      for (const auto &err : parser.getErrors()) {
+        section.parseErrors.addError(ErrorCode::UnexpectedToken, err.message,
+                                     err.location);
+      }
+    }
+  }
+  section.parseErrors.attachSource(*section.source);
+
+  if (section.parsed) {
+    for (const auto &decl : section.program.characters) {
+      section.characters.emplace_back(decl.id);
+    }
+    for (const auto &scene : section.program.scenes) {
+      section.scenes.emplace_back(scene.name);
+    }
+    return;
+  }
+
+  // A section that does not parse still declares what its first line
+  // names, so references to it do not all turn into errors mid-edit
+  std::string_view header = skipBlanks(section.source->getText());
+  const std::string_view keyword = leadingWord(header);
+  const std::string_view name =
+      leadingWord(skipBlanks(header.substr(keyword.size())));
+  if (!name.empty() && keyword == "scene") {
+    section.scenes.emplace_back(name);
+  } else if (!name.empty() && keyword == "character") {
+    section.characters.emplace_back(name);
+  }
+}
+
+void IncrementalValidator::validateSection(Section &section) {
+  ++m_stats.revalidated;
+  if (!section.parsed) {
+    section.result = {};
+    return;
+  }
+
+  Validator validator;
+  validator.setReportDeadCode(m_reportDeadCode);
+  validator.setSource(section.source);
+  validator.setProjectSymbols(&m_symbols);
+  section.result = validator.validate(section.program);
+}
+
+void IncrementalValidator::declare(const Section &section, bool add,
+                                   ChangedSymbols &changed) {
+  // A name that appears and disappears again within one edit is not a
+  // change, so every flip toggles its membership in the changed set
+  const auto flip = [](std::unordered_set<std::string> &changedNames,
+                       const std::string &name) {
+    if (changedNames.erase(name) == 0) {
+      changedNames.insert(name);
+    }
+  };
+  const auto update = [add, &flip](const std::vector<std::string> &names,
+                                   std::unordered_map<std::string, u32> &counts,
+                                   std::unordered_set<std::string> &symbols,
+                                   std::unordered_set<std::string> &changedNames) {
+    for (const auto &name : names) {
+      u32 &count = counts[name];
+      if (add) {
+        if (count++ == 0) {
+          symbols.insert(name);
+          flip(changedNames, name);
+        }
+      } else if (--count == 0) {
+        counts.erase(name);
+        symbols.erase(name);
+        flip(changedNames, name);
+      }
+    }
+  };
+  update(section.scenes, m_sceneCounts, m_symbols.scenes, changed.scenes);
+  update(section.characters, m_characterCounts, m_symbols.characters,
+         changed.characters);
+}
+
+bool IncrementalValidator::dependsOn(const Section &section,
+                                     const ChangedSymbols &changed) const {
+  const auto intersects = [](const std::unordered_set<std::string> &names,
+                             const std::unordered_set<std::string> &with) {
+    for (const auto &name : with) {
+      if (names.count(name) > 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  const ValidationResult &result = section.result;
+  return intersects(result.importedScenes, changed.scenes) ||
+         intersects(result.undefinedScenes, changed.scenes) ||
+         intersects(result.importedCharacters, changed.characters) ||
+         intersects(result.undefinedCharacters, changed.characters);
+}
+
+void IncrementalValidator::layoutSections(usize from) {
+  for (usize i = from; i < m_sections.size(); ++i) {
+    Section &section = m_sections[i];
+    if (i == 0) {
+      section.offset = 0;
+      section.line = 0;
+    } else {
+      const Section &previous = m_sections[i - 1];
+      section.offset = previous.offset + previous.source->size();
+      section.line = previous.line + previous.lineCount;
+    }
+  }
+}
+
+void IncrementalValidator::analyzeDocument() {
+  m_documentErrors.clear();
+
+  // Names are views into the sections, which outlive this pass.
+  // Declarations are reported at the line that starts their section.
+  using Declarations = std::vector<std::pair<std::string_view, SourceLocation>>;
+  std::unordered_map<std::string_view, SourceLocation> declaredScenes;
+  Declarations sceneOrder;
+  Declarations characterOrder;
+
+  const auto collect = [this](const std::vector<std::string> &names,
+                              SourceLocation location,
+                              std::unordered_map<std::string_view,
+                                                 SourceLocation> &seen,
+                              Declarations &order, ErrorCode duplicateCode,
+                              const char *kind) {
+    for (usize i = 0; i < names.size(); ++i) {
+      const std::string &name = names[i];
+      auto [it, inserted] = seen.try_emplace(name, location);
+      if (inserted) {
+        order.emplace_back(name, location);
+        continue;
+      }
+      // Duplicates within one section are the section's to report
+      const auto before = names.begin() + static_cast<std::ptrdiff_t>(i);
+      if (std::find(names.begin(), before, name) == before) {
+        ScriptError err(duplicateCode, Severity::Error,
+                        std::string(kind) + " '" + name +
+                            "' is already defined",
+                        location);
+        err.withRelated(it->second, "Previously defined here");
+        m_documentErrors.add(std::move(err));
+      }
+    }
+  };
+
+  std::unordered_map<std::string_view, SourceLocation> declaredCharacters;
+  std::unordered_set<std::string_view> usedScenes;
+  std::unordered_set<std::string_view> usedCharacters;
+  std::unordered_map<std::string_view, SourceLocation> variablesSet;
+  std::vector<std::string_view> variableOrder;
+  std::unordered_set<std::string_view> variablesRead;
+  std::unordered_map<std::string_view, const std::unordered_set<std::string> *>
+      graph;
+
+  for (const auto &section : m_sections) {
+    const SourceLocation location(section.line + 1, 1);
+    collect(section.scenes, location, declaredScenes, sceneOrder,
+            ErrorCode::DuplicateSceneDefinition, "Scene");
+    collect(section.characters, location, declaredCharacters, characterOrder,
+            ErrorCode::DuplicateCharacterDefinition, "Character");
+
+    const ValidationResult &result = section.result;
+    for (const auto &[name, info] : result.scenes) {
+      if (info.isUsed) {
+        usedScenes.insert(name);
+      }
+    }
+    usedScenes.insert(result.importedScenes.begin(),
+                      result.importedScenes.end());
+    for (const auto &[name, info] : result.characters) {
+      if (info.isUsed) {
+        usedCharacters.insert(name);
+      }
+    }
+    usedCharacters.insert(result.importedCharacters.begin(),
+                          result.importedCharacters.end());
+    for (const auto &[name, info] : result.variables) {
+      if (info.isUsed) {
+        variablesRead.insert(name);
+      }
+      if (info.isDefined &&
+          variablesSet
+              .try_emplace(name, shift(info.definitionLocation, section.line))
+              .second) {
+        variableOrder.push_back(name);
+      }
+    }
+    // A scene's edges come from the section that declares it first
+    for (const auto &[from, targets] : result.sceneGraph) {
+      graph.try_emplace(from, &targets);
+    }
+  }
+
+  if (sceneOrder.empty() && characterOrder.empty() && variableOrder.empty()) {
+    return;
+  }
+  const std::string_view startScene =
+      sceneOrder.empty() ? std::string_view{} : sceneOrder[0].first;
+
+  if (m_reportDeadCode && !startScene.empty()) {
+    std::unordered_set<std::string_view> reachable{startScene};
+    std::vector<std::string_view> pending{startScene};
+    while (!pending.empty()) {
+      const std::string_view scene = pending.back();
+      pending.pop_back();
+      auto it = graph.find(scene);
+      if (it == graph.end()) {
+        continue;
+      }
+      for (const auto &target : *it->second) {
+        if (reachable.insert(target).second) {
+          pending.push_back(target);
+        }
+      }
+    }
+    for (const auto &[name, location] : sceneOrder) {
+      if (reachable.count(name) == 0) {
+        m_documentErrors.addWarning(ErrorCode::UnreachableScene,
+                                    "Scene '" + std::string(name) +
+                                        "' is unreachable from the starting "
+                                        "scene",
+                                    location);
+      }
+    }
+  }
+
+  if (!m_reportUnused) {
+    return;
+  }
+  for (const auto &[name, location] : characterOrder) {
+    if (usedCharacters.count(name) == 0) {
+      m_documentErrors.addWarning(ErrorCode::UnusedCharacter,
+                                  "Character '" + std::string(name) +
+                                      "' is defined but never used",
+                                  location);
+    }
+  }
+  for (const auto &[name, location] : sceneOrder) {
+    if (name != startScene && usedScenes.count(name) == 0) {
+      m_documentErrors.addWarning(ErrorCode::UnusedScene,
+                                  "Scene '" + std::string(name) +
+                                      "' is defined but never referenced by "
+                                      "goto",
+                                  location);
+    }
+  }
+  for (const auto &name : variableOrder) {
+    if (variablesRead.count(name) == 0) {
+      m_documentErrors.addWarning(ErrorCode::UnusedVariable,
+                                  "Variable '" + std::string(name) +
+                                      "' is set but never read",
+                                  variablesSet[name]);
+    }
+  }
+}
+
+} // namespace NovelMind::scripting
@@ -1,5 +1,7 @@
 #include "NovelMind/scripting/interpreter.hpp"
 #include "NovelMind/core/logger.hpp"
+#include "NovelMind/core/mapped_file.hpp"
+#include "NovelMind/scripting/register_bytecode.hpp"
 #include <cstring>
 
 namespace NovelMind::scripting {
@@ -7,10 +9,25 @@ namespace NovelMind::scripting {
 constexpr u32 SCRIPT_MAGIC = 0x43534D4E; // "NMSC"
 
 ScriptInterpreter::ScriptInterpreter()
-    : m_vm(std::make_unique<VirtualMachine>()) {}
+    : m_vm(std::make_unique<VirtualMachine>()),
+      m_registerVm(std::make_unique<RegisterVM>()) {}
 
 ScriptInterpreter::~ScriptInterpreter() = default;
 
+template <typename F> decltype(auto) ScriptInterpreter::withVm(F &&f) {
+  if (m_registerFormat) {
+    return f(*m_registerVm);
+  }
+  return f(*m_vm);
+}
+
+template <typename F> decltype(auto) ScriptInterpreter::withVm(F &&f) const {
+  if (m_registerFormat) {
+    return f(static_cast<const RegisterVM &>(*m_registerVm));
+  }
+  return f(static_cast<const VirtualMachine &>(*m_vm));
+}
+
 Result<void>
 ScriptInterpreter::loadFromBytecode(const std::vector<u8> &bytecode) {
   if (bytecode.size() < 20) // Minimum header size
@@ -18,6 +35,71 @@ ScriptInterpreter::loadFromBytecode(const std::vector<u8> &bytecode) {
     return Result<void>::error("Bytecode too small");
   }
 
+  u16 version;
+  std::memcpy(&version, bytecode.data() + sizeof(u32), sizeof(u16));
+  if (version == NMSC_VERSION_REGISTER) {
+    auto program = deserializeRegisterProgram(bytecode);
+    if (program.isError()) {
+      return Result<void>::error(program.error());
+    }
+    auto result = m_registerVm->load(program.value());
+    if (result.isOk()) {
+      m_registerFormat = true;
+    }
+    return result;
+  }
+
+  if (version == NMSC_VERSION_IMAGE) {
+    auto image = ScriptImage::fromBytes(bytecode);
+    if (image.isError()) {
+      return Result<void>::error(image.error());
+    }
+    return loadImage(std::move(image).value());
+  }
+
+  auto result = loadStackBytecode(bytecode);
+  if (result.isOk()) {
+    m_registerFormat = false;
+  }
+  return result;
+}
+
+Result<void> ScriptInterpreter::loadFromFile(const std::string &path) {
+  auto file = core::MappedFile::open(path);
+  if (file.isError()) {
+    return Result<void>::error(file.error());
+  }
+
+  const core::MappedFile &mapped = *file.value();
+  u16 version = 0;
+  if (mapped.size() >= sizeof(u32) + sizeof(u16)) {
+    std::memcpy(&version, mapped.data() + sizeof(u32), sizeof(u16));
+  }
+  if (version == NMSC_VERSION_IMAGE) {
+    auto image = ScriptImage::open(path);
+    if (image.isError()) {
+      return Result<void>::error(image.error());
+    }
+    return loadImage(std::move(image).value());
+  }
+  return loadFromBytecode(
+      std::vector<u8>(mapped.data(), mapped.data() + mapped.size()));
+}
+
+Result<void> ScriptInterpreter::loadImage(ScriptImagePtr image) {
+  auto program = VMProgram::create(std::move(image));
+  if (program.isError()) {
+    return Result<void>::error(program.error());
+  }
+  auto result = m_vm->load(std::move(program).value());
+  if (result.isOk()) {
+    m_registerFormat = false;
+  }
+  return result;
+}
+
+Result<void>
+ScriptInterpreter::loadStackBytecode(const std::vector<u8> &bytecode) {
   usize offset = 0;
 
   // Read magic
@@ -87,45 +169,60 @@ ScriptInterpreter::loadFromBytecode(const std::vector<u8> &bytecode) {
   return m_vm->load(program, stringTable);
 }
 
-void ScriptInterpreter::reset() { m_vm->reset(); }
+void ScriptInterpreter::reset() {
+  withVm([](auto &vm) { vm.reset(); });
+}
 
-bool ScriptInterpreter::step() { return m_vm->step(); }
+bool ScriptInterpreter::step() {
+  return withVm([](auto &vm) { return vm.step(); });
+}
 
-void ScriptInterpreter::run() { m_vm->run(); }
+void ScriptInterpreter::run() {
+  withVm([](auto &vm) { vm.run(); });
+}
 
-void ScriptInterpreter::pause() { m_vm->pause(); }
+void ScriptInterpreter::pause() {
+  withVm([](auto &vm) { vm.pause(); });
+}
 
-void ScriptInterpreter::resume() { m_vm->resume(); }
+void ScriptInterpreter::resume() {
+  withVm([](auto &vm) { vm.resume(); });
+}
 
-bool ScriptInterpreter::isRunning() const { return m_vm->isRunning(); }
+bool ScriptInterpreter::isRunning() const {
+  return withVm([](const auto &vm) { return vm.isRunning(); });
+}
 
-bool ScriptInterpreter::isPaused() const { return m_vm->isPaused(); }
+bool ScriptInterpreter::isPaused() const {
+  return withVm([](const auto &vm) { return vm.isPaused(); });
+}
 
-bool ScriptInterpreter::isWaiting() const { return m_vm->isWaiting(); }
+bool ScriptInterpreter::isWaiting() const {
+  return withVm([](const auto &vm) { return vm.isWaiting(); });
+}
 
 void ScriptInterpreter::setVariable(const std::string &name, i32 value) {
-  m_vm->setVariable(name, value);
+  withVm([&](auto &vm) { vm.setVariable(name, value); });
 }
 
 void ScriptInterpreter::setVariable(const std::string &name, f32 value) {
-  m_vm->setVariable(name, value);
+  withVm([&](auto &vm) { vm.setVariable(name, value); });
 }
 
 void ScriptInterpreter::setVariable(const std::string &name,
                                     const std::string &value) {
-  m_vm->setVariable(name, value);
+  withVm([&](auto &vm) { vm.setVariable(name, value); });
 }
 
 void ScriptInterpreter::setVariable(const std::string &name, bool value) {
-  m_vm->setVariable(name, value);
+  withVm([&](auto &vm) { vm.setVariable(name, value); });
 }
 
 std::optional<i32>
 ScriptInterpreter::getIntVariable(const std::string &name) const {
-  if (!m_vm->hasVariable(name)) {
-    return std::nullopt;
-  }
-  Value val = m_vm->getVariable(name);
+  Value val = withVm([&](const auto &vm) -> Value {
+    return vm.hasVariable(name) ? vm.getVariable(name) : std::monostate{};
+  });
   if (auto *p = std::get_if<i32>(&val)) {
     return *p;
   }
@@ -134,10 +231,9 @@ ScriptInterpreter::getIntVariable(const std::string &name) const {
 
 std::optional<f32>
 ScriptInterpreter::getFloatVariable(const std::string &name) const {
-  if (!m_vm->hasVariable(name)) {
-    return std::nullopt;
-  }
-  Value val = m_vm->getVariable(name);
+  Value val = withVm([&](const auto &vm) -> Value {
+    return vm.hasVariable(name) ? vm.getVariable(name) : std::monostate{};
+  });
   if (auto *p = std::get_if<f32>(&val)) {
     return *p;
   }
@@ -146,10 +242,9 @@ ScriptInterpreter::getFloatVariable(const std::string &name) const {
 
 std::optional<std::string>
 ScriptInterpreter::getStringVariable(const std::string &name) const {
-  if (!m_vm->hasVariable(name)) {
-    return std::nullopt;
-  }
-  Value val = m_vm->getVariable(name);
+  Value val = withVm([&](const auto &vm) -> Value {
+    return vm.hasVariable(name) ? vm.getVariable(name) : std::monostate{};
+  });
   if (auto *p = std::get_if<std::string>(&val)) {
     return *p;
   }
@@ -158,10 +253,9 @@ ScriptInterpreter::getStringVariable(const std::string &name) const {
 
 std::optional<bool>
 ScriptInterpreter::getBoolVariable(const std::string &name) const {
-  if (!m_vm->hasVariable(name)) {
-    return std::nullopt;
-  }
-  Value val = m_vm->getVariable(name);
+  Value val = withVm([&](const auto &vm) -> Value {
+    return vm.hasVariable(name) ? vm.getVariable(name) : std::monostate{};
+  });
   if (auto *p = std::get_if<bool>(&val)) {
     return *p;
   }
@@ -170,18 +264,24 @@ ScriptInterpreter::getBoolVariable(const std::string &name) const {
 
 void ScriptInterpreter::setFlag(const std::string &name, bool value) {
   m_vm->setFlag(name, value);
+  m_registerVm->setFlag(name, value);
 }
 
 bool ScriptInterpreter::getFlag(const std::string &name) const {
-  return m_vm->getFlag(name);
+  return withVm([&](const auto &vm) { return vm.getFlag(name); });
 }
 
-void ScriptInterpreter::signalContinue() { m_vm->signalContinue(); }
+void ScriptInterpreter::signalContinue() {
+  withVm([](auto &vm) { vm.signalContinue(); });
+}
 
-void ScriptInterpreter::signalChoice(i32 choice) { m_vm->signalChoice(choice); }
+void ScriptInterpreter::signalChoice(i32 choice) {
+  withVm([choice](auto &vm) { vm.signalChoice(choice); });
+}
 
 void ScriptInterpreter::registerCallback(
     OpCode op, VirtualMachine::NativeCallback callback) {
+  m_registerVm->registerCallback(op, callback);
   m_vm->registerCallback(op, std::move(callback));
 }
 
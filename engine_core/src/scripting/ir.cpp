@@ -4,13 +4,246 @@
  */
 
 #include "NovelMind/scripting/ir.hpp"
+#include "NovelMind/core/json.hpp"
+#include "NovelMind/core/mapped_file.hpp"
+#include "NovelMind/core/thread_pool.hpp"
+#include "NovelMind/scripting/incremental_validator.hpp"
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <fstream>
 #include <queue>
 #include <sstream>
 #include <unordered_set>
 
 namespace NovelMind::scripting {
 
+namespace {
+
+using core::JsonEvent;
+using core::JsonReader;
+using core::JsonWriter;
+
+IRNodeType nodeTypeFromName(std::string_view name) {
+  static const std::unordered_map<std::string_view, IRNodeType> kTypes = [] {
+    std::unordered_map<std::string_view, IRNodeType> types;
+    for (u8 i = 0; i <= static_cast<u8>(IRNodeType::Custom); ++i) {
+      const auto type = static_cast<IRNodeType>(i);
+      types.emplace(IRNode(0, type).getTypeName(), type);
+    }
+    return types;
+  }();
+  auto it = kTypes.find(name);
+  return it != kTypes.end() ? it->second : IRNodeType::Custom;
+}
+
+// JSON reading helpers. Each returns false once the reader has failed; the
+// reader holds the error message.
+
+bool expectEvent(JsonReader &reader, JsonEvent expected, const char *what) {
+  if (reader.next() == expected) {
+    return true;
+  }
+  reader.fail(std::string("Expected ") + what);
+  return false;
+}
+
+bool readString(JsonReader &reader, std::string &out) {
+  if (!expectEvent(reader, JsonEvent::String, "a string")) {
+    return false;
+  }
+  out.assign(reader.getString());
+  return true;
+}
+
+bool readId(JsonReader &reader, NodeId &out) {
+  if (reader.next() != JsonEvent::Number || !reader.isInteger()) {
+    reader.fail("Expected a node ID");
+    return false;
+  }
+  out = reader.getUint();
+  return true;
+}
+
+bool readFloat(JsonReader &reader, f32 &out) {
+  if (!expectEvent(reader, JsonEvent::Number, "a number")) {
+    return false;
+  }
+  out = static_cast<f32>(reader.getNumber());
+  return true;
+}
+
+bool skip(JsonReader &reader) {
+  reader.skipValue();
+  return !reader.hasError();
+}
+
+// Call onMember(key) for each member of an object whose '{' was just read.
+// onMember reads the value; the key text is only valid until it does.
+template <typename Fn> bool readMembers(JsonReader &reader, Fn &&onMember) {
+  for (;;) {
+    const JsonEvent event = reader.next();
+    if (event == JsonEvent::EndObject) {
+      return true;
+    }
+    if (event != JsonEvent::Key || !onMember(reader.getString())) {
+      return false;
+    }
+  }
+}
+
+template <typename Fn> bool readObject(JsonReader &reader, Fn &&onMember) {
+  return expectEvent(reader, JsonEvent::BeginObject, "an object") &&
+         readMembers(reader, std::forward<Fn>(onMember));
+}
+
+// Call onElement() for each element of an array, after its '{' was read
+template <typename Fn> bool readObjects(JsonReader &reader, Fn &&onElement) {
+  if (!expectEvent(reader, JsonEvent::BeginArray, "an array")) {
+    return false;
+  }
+  for (;;) {
+    const JsonEvent event = reader.next();
+    if (event == JsonEvent::EndArray) {
+      return true;
+    }
+    if (event != JsonEvent::BeginObject) {
+      reader.fail("Expected an object");
+      return false;
+    }
+    if (!onElement()) {
+      return false;
+    }
+  }
+}
+
+bool readPropertyValue(JsonReader &reader, IRPropertyValue &out) {
+  switch (reader.next()) {
+  case JsonEvent::Null:
+    out = nullptr;
+    return true;
+  case JsonEvent::Bool:
+    out = reader.getBool();
+    return true;
+  case JsonEvent::Number:
+    if (reader.isInteger()) {
+      out = reader.getInt();
+    } else {
+      out = reader.getNumber();
+    }
+    return true;
+  case JsonEvent::String:
+    out = std::string(reader.getString());
+    return true;
+  case JsonEvent::BeginArray: {
+    std::vector<std::string> items;
+    for (JsonEvent event = reader.next(); event != JsonEvent::EndArray;
+         event = reader.next()) {
+      if (event != JsonEvent::String) {
+        reader.fail("Expected a string");
+        return false;
+      }
+      items.emplace_back(reader.getString());
+    }
+    out = std::move(items);
+    return true;
+  }
+  default:
+    reader.fail("Unsupported property value");
+    return false;
+  }
+}
+
+// Members of a node object whose '{' was just read
+Result<std::unique_ptr<IRNode>> readNodeMembers(JsonReader &reader) {
+  NodeId id = 0;
+  std::string type;
+  f32 x = 0.0f;
+  f32 y = 0.0f;
+  std::vector<std::pair<std::string, IRPropertyValue>> properties;
+
+  const bool ok = readMembers(reader, [&](std::string_view key) {
+    if (key == "id") {
+      return readId(reader, id);
+    }
+    if (key == "type") {
+      return readString(reader, type);
+    }
+    if (key == "x") {
+      return readFloat(reader, x);
+    }
+    if (key == "y") {
+      return readFloat(reader, y);
+    }
+    if (key == "properties") {
+      return readObject(reader, [&](std::string_view name) {
+        properties.emplace_back(std::string(name), nullptr);
+        return readPropertyValue(reader, properties.back().second);
+      });
+    }
+    return skip(reader);
+  });
+  if (ok && id == 0) {
+    reader.fail("Node without an ID");
+  }
+  if (reader.hasError()) {
+    return Result<std::unique_ptr<IRNode>>::error(reader.getError());
+  }
+
+  auto node = std::make_unique<IRNode>(id, nodeTypeFromName(type));
+  node->setPosition(x, y);
+  for (auto &[name, value] : properties) {
+    node->setProperty(name, value);
+  }
+  return Result<std::unique_ptr<IRNode>>::ok(std::move(node));
+}
+
+// Read a whole document with @p read, which must consume exactly one value
+template <typename T, typename Fn>
+Result<std::unique_ptr<T>> readDocument(std::string_view json, Fn &&read) {
+  JsonReader reader(json);
+  auto result = read(reader);
+  if (result.isOk() && reader.next() != JsonEvent::End) {
+    return Result<std::unique_ptr<T>>::error(reader.getError());
+  }
+  return result;
+}
+
+template <typename T, typename Fn>
+Result<std::unique_ptr<T>> loadDocument(const std::string &path, Fn &&read) {
+  auto file = core::MappedFile::open(path);
+  if (file.isError()) {
+    return Result<std::unique_ptr<T>>::error(file.error());
+  }
+  const std::string_view text(
+      reinterpret_cast<const char *>(file.value()->data()),
+      file.value()->size());
+  auto result = readDocument<T>(text, std::forward<Fn>(read));
+  if (result.isError()) {
+    return Result<std::unique_ptr<T>>::error(path + ": " + result.error());
+  }
+  return result;
+}
+
+template <typename Fn>
+Result<void> saveDocument(const std::string &path, Fn &&write) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return Result<void>::error("Cannot open file for writing: " + path);
+  }
+  {
+    JsonWriter writer(file);
+    write(writer);
+  }
+  if (!file.flush()) {
+    return Result<void>::error("Failed to write file: " + path);
+  }
+  return Result<void>::ok();
+}
+
+} // namespace
+
 // ============================================================================
 // IRNode Implementation
 // ============================================================================
@@ -78,6 +311,10 @@ void IRNode::setProperty(const std::string &name,
   m_properties[name] = value;
 }
 
+void IRNode::setProperty(const std::string &name, IRPropertyValue &&value) {
+  m_properties[name] = std::move(value);
+}
+
 std::optional<IRPropertyValue>
 IRNode::getProperty(const std::string &name) const {
   auto it = m_properties.find(name);
@@ -215,49 +452,52 @@ std::vector<PortDefinition> IRNode::getOutputPorts() const {
 }
 
 std::string IRNode::toJson() const {
-  std::stringstream ss;
-  ss << "{";
-  ss << "\"id\":" << m_id << ",";
-  ss << "\"type\":\"" << getTypeName() << "\",";
-  ss << "\"x\":" << m_x << ",";
-  ss << "\"y\":" << m_y << ",";
-  ss << "\"properties\":{";
-
-  bool first = true;
-  for (const auto &[name, value] : m_properties) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << "\"" << name << "\":";
+  std::string json;
+  JsonWriter writer(json);
+  writeJson(writer);
+  return json;
+}
 
+std::unique_ptr<IRNode> IRNode::fromJson(const std::string &json) {
+  auto node = readDocument<IRNode>(json, readJson);
+  return node.isOk() ? std::move(node).value() : nullptr;
+}
+
+void IRNode::writeJson(JsonWriter &writer) const {
+  writer.beginObject();
+  writer.key("id").value(m_id);
+  writer.key("type").value(getTypeName());
+  writer.key("x").value(m_x);
+  writer.key("y").value(m_y);
+  writer.key("properties").beginObject();
+  for (const auto &[name, value] : m_properties) {
+    writer.key(name);
     std::visit(
-        [&ss](const auto &v) {
+        [&writer](const auto &v) {
           using T = std::decay_t<decltype(v)>;
           if constexpr (std::is_same_v<T, std::nullptr_t>) {
-            ss << "null";
-          } else if constexpr (std::is_same_v<T, bool>) {
-            ss << (v ? "true" : "false");
-          } else if constexpr (std::is_same_v<T, i64>) {
-            ss << v;
-          } else if constexpr (std::is_same_v<T, f64>) {
-            ss << v;
-          } else if constexpr (std::is_same_v<T, std::string>) {
-            ss << "\"" << v << "\"";
+            writer.nullValue();
           } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
-            ss << "[";
-            for (size_t i = 0; i < v.size(); ++i) {
-              if (i > 0)
-                ss << ",";
-              ss << "\"" << v[i] << "\"";
+            writer.beginArray();
+            for (const auto &item : v) {
+              writer.value(item);
             }
-            ss << "]";
+            writer.endArray();
+          } else {
+            writer.value(v);
           }
         },
         value);
   }
+  writer.endObject();
+  writer.endObject();
+}
 
-  ss << "}}";
-  return ss.str();
+Result<std::unique_ptr<IRNode>> IRNode::readJson(JsonReader &reader) {
+  if (!expectEvent(reader, JsonEvent::BeginObject, "an object")) {
+    return Result<std::unique_ptr<IRNode>>::error(reader.getError());
+  }
+  return readNodeMembers(reader);
 }
 
 // ============================================================================
@@ -272,12 +512,14 @@ void IRGraph::setName(const std::string &name) { m_name = name; }
 NodeId IRGraph::createNode(IRNodeType type) {
   NodeId id = m_nextId++;
   m_nodes[id] = std::make_unique<IRNode>(id, type);
+  m_adjacency.try_emplace(id);
   return id;
 }
 
 void IRGraph::removeNode(NodeId id) {
   disconnectAll(id);
   m_nodes.erase(id);
+  m_adjacency.erase(id);
 }
 
 IRNode *IRGraph::getNode(NodeId id) {
@@ -328,58 +570,110 @@ Result<void> IRGraph::connect(const PortId &source, const PortId &target) {
     return Result<void>::ok();
   }
 
+  const auto index = static_cast<u32>(m_connections.size());
   IRConnection conn;
   conn.source = source;
   conn.target = target;
   m_connections.push_back(conn);
+  m_adjacency[source.nodeId].outgoing.push_back(index);
+  m_adjacency[target.nodeId].incoming.push_back(index);
 
   return Result<void>::ok();
 }
 
 void IRGraph::disconnect(const PortId &source, const PortId &target) {
-  m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end(),
-                                     [&](const IRConnection &c) {
-                                       return c.source == source &&
-                                              c.target == target;
-                                     }),
-                      m_connections.end());
+  auto it = m_adjacency.find(source.nodeId);
+  if (it == m_adjacency.end()) {
+    return;
+  }
+  for (u32 index : it->second.outgoing) {
+    const IRConnection &conn = m_connections[index];
+    if (conn.source == source && conn.target == target) {
+      removeConnections({index});
+      return;
+    }
+  }
 }
 
 void IRGraph::disconnectAll(NodeId nodeId) {
-  m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end(),
-                                     [nodeId](const IRConnection &c) {
-                                       return c.source.nodeId == nodeId ||
-                                              c.target.nodeId == nodeId;
-                                     }),
-                      m_connections.end());
+  auto it = m_adjacency.find(nodeId);
+  if (it == m_adjacency.end()) {
+    return;
+  }
+  // One pass for all of the node's edges, rather than one per edge
+  std::vector<u32> indices = it->second.outgoing;
+  indices.insert(indices.end(), it->second.incoming.begin(),
+                 it->second.incoming.end());
+  removeConnections(std::move(indices));
 }
 
-std::vector<IRConnection> IRGraph::getConnections() const {
-  return m_connections;
-}
+void IRGraph::removeConnections(std::vector<u32> indices) {
+  if (indices.empty()) {
+    return;
+  }
+  // A self-loop is listed as both outgoing and incoming
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
-std::vector<IRConnection> IRGraph::getConnectionsFrom(NodeId nodeId) const {
-  std::vector<IRConnection> result;
-  for (const auto &conn : m_connections) {
-    if (conn.source.nodeId == nodeId) {
-      result.push_back(conn);
+  // Every adjacency list holds its indices in ascending order, and closing
+  // the gaps keeps it that way, so entries are found by binary search
+  const auto find = [](std::vector<u32> &list, u32 index) {
+    return std::lower_bound(list.begin(), list.end(), index);
+  };
+  for (u32 index : indices) {
+    const IRConnection &conn = m_connections[index];
+    auto &outgoing = m_adjacency[conn.source.nodeId].outgoing;
+    auto &incoming = m_adjacency[conn.target.nodeId].incoming;
+    outgoing.erase(find(outgoing, index));
+    incoming.erase(find(incoming, index));
+  }
+
+  // Slide the later connections down over the gaps, renumbering each in
+  // the two lists that hold it
+  u32 kept = indices.front();
+  usize next = 0;
+  const auto count = static_cast<u32>(m_connections.size());
+  for (u32 i = indices.front(); i < count; ++i) {
+    if (next < indices.size() && indices[next] == i) {
+      ++next;
+      continue;
     }
+    IRConnection &conn = m_connections[i];
+    *find(m_adjacency[conn.source.nodeId].outgoing, i) = kept;
+    *find(m_adjacency[conn.target.nodeId].incoming, i) = kept;
+    m_connections[kept++] = std::move(conn);
   }
-  return result;
+  m_connections.resize(kept);
+}
+
+std::vector<IRConnection> IRGraph::getConnectionsFrom(NodeId nodeId) const {
+  auto range = getOutgoing(nodeId);
+  return {range.begin(), range.end()};
 }
 
 std::vector<IRConnection> IRGraph::getConnectionsTo(NodeId nodeId) const {
-  std::vector<IRConnection> result;
-  for (const auto &conn : m_connections) {
-    if (conn.target.nodeId == nodeId) {
-      result.push_back(conn);
-    }
+  auto range = getIncoming(nodeId);
+  return {range.begin(), range.end()};
+}
+
+IRConnectionRange IRGraph::getOutgoing(NodeId nodeId) const {
+  auto it = m_adjacency.find(nodeId);
+  if (it == m_adjacency.end()) {
+    return {};
   }
-  return result;
+  return {m_connections.data(), it->second.outgoing};
+}
+
+IRConnectionRange IRGraph::getIncoming(NodeId nodeId) const {
+  auto it = m_adjacency.find(nodeId);
+  if (it == m_adjacency.end()) {
+    return {};
+  }
+  return {m_connections.data(), it->second.incoming};
 }
 
 bool IRGraph::isConnected(const PortId &source, const PortId &target) const {
-  for (const auto &conn : m_connections) {
+  for (const auto &conn : getOutgoing(source.nodeId)) {
     if (conn.source == source && conn.target == target) {
       return true;
     }
@@ -389,19 +683,14 @@ bool IRGraph::isConnected(const PortId &source, const PortId &target) const {
 
 std::vector<NodeId> IRGraph::getTopologicalOrder() const {
   std::vector<NodeId> result;
-  std::unordered_map<NodeId, int> inDegree;
+  result.reserve(m_nodes.size());
+  std::unordered_map<NodeId, usize> inDegree;
+  inDegree.reserve(m_nodes.size());
   std::queue<NodeId> queue;
 
-  for (const auto &[id, node] : m_nodes) {
-    inDegree[id] = 0;
-  }
-
-  for (const auto &conn : m_connections) {
-    inDegree[conn.target.nodeId]++;
-  }
-
-  for (const auto &[id, degree] : inDegree) {
-    if (degree == 0) {
+  for (const auto &[id, adjacency] : m_adjacency) {
+    inDegree[id] = adjacency.incoming.size();
+    if (adjacency.incoming.empty()) {
       queue.push(id);
     }
   }
@@ -411,9 +700,8 @@ std::vector<NodeId> IRGraph::getTopologicalOrder() const {
     queue.pop();
     result.push_back(id);
 
-    for (const auto &conn : getConnectionsFrom(id)) {
-      inDegree[conn.target.nodeId]--;
-      if (inDegree[conn.target.nodeId] == 0) {
+    for (const auto &conn : getOutgoing(id)) {
+      if (--inDegree[conn.target.nodeId] == 0) {
         queue.push(conn.target.nodeId);
       }
     }
@@ -442,7 +730,7 @@ std::vector<NodeId> IRGraph::getExecutionOrder() const {
       visited.insert(id);
       result.push_back(id);
 
-      for (const auto &conn : getConnectionsFrom(id)) {
+      for (const auto &conn : getOutgoing(id)) {
         if (conn.source.portName.find("exec") != std::string::npos ||
             conn.source.portName == "true" || conn.source.portName == "false") {
           queue.push(conn.target.nodeId);
@@ -460,8 +748,7 @@ std::vector<std::string> IRGraph::validate() const {
   for (const auto &[id, node] : m_nodes) {
     if (node->getType() != IRNodeType::SceneStart &&
         node->getType() != IRNodeType::Comment) {
-      auto incoming = getConnectionsTo(id);
-      if (incoming.empty()) {
+      if (getIncoming(id).empty()) {
         errors.push_back("Node " + std::to_string(id) +
                          " has no incoming connections");
       }
@@ -472,7 +759,7 @@ std::vector<std::string> IRGraph::validate() const {
     for (const auto &port : node->getInputPorts()) {
       if (port.required && !port.isExecution) {
         bool found = false;
-        for (const auto &conn : getConnectionsTo(id)) {
+        for (const auto &conn : getIncoming(id)) {
           if (conn.target.portName == port.name) {
             found = true;
             break;
@@ -521,58 +808,152 @@ bool IRGraph::hasCharacter(const std::string &id) const {
 }
 
 std::string IRGraph::toJson() const {
-  std::stringstream ss;
-  ss << "{";
-  ss << "\"name\":\"" << m_name << "\",";
+  std::string json;
+  JsonWriter writer(json);
+  writeJson(writer);
+  return json;
+}
+
+std::unique_ptr<IRGraph> IRGraph::fromJson(const std::string &json) {
+  auto graph = readDocument<IRGraph>(json, readJson);
+  return graph.isOk() ? std::move(graph).value() : nullptr;
+}
+
+void IRGraph::writeJson(JsonWriter &writer) const {
+  writer.beginObject();
+  writer.key("name").value(m_name);
 
-  ss << "\"nodes\":[";
-  bool first = true;
+  writer.key("nodes").beginArray();
   for (const auto &[id, node] : m_nodes) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << node->toJson();
+    node->writeJson(writer);
   }
-  ss << "],";
+  writer.endArray();
 
-  ss << "\"connections\":[";
-  first = true;
+  writer.key("connections").beginArray();
   for (const auto &conn : m_connections) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << "{";
-    ss << "\"sourceNode\":" << conn.source.nodeId << ",";
-    ss << "\"sourcePort\":\"" << conn.source.portName << "\",";
-    ss << "\"targetNode\":" << conn.target.nodeId << ",";
-    ss << "\"targetPort\":\"" << conn.target.portName << "\"";
-    ss << "}";
-  }
-  ss << "],";
-
-  ss << "\"scenes\":{";
-  first = true;
+    writer.beginObject();
+    writer.key("sourceNode").value(conn.source.nodeId);
+    writer.key("sourcePort").value(conn.source.portName);
+    writer.key("targetNode").value(conn.target.nodeId);
+    writer.key("targetPort").value(conn.target.portName);
+    writer.endObject();
+  }
+  writer.endArray();
+
+  writer.key("scenes").beginObject();
   for (const auto &[name, id] : m_sceneStartNodes) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << "\"" << name << "\":" << id;
+    writer.key(name).value(id);
   }
-  ss << "},";
+  writer.endObject();
 
-  ss << "\"characters\":{";
-  first = true;
+  writer.key("characters").beginObject();
   for (const auto &[id, info] : m_characters) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << "\"" << id << "\":{\"name\":\"" << info.first << "\",\"color\":\""
-       << info.second << "\"}";
+    writer.key(id).beginObject();
+    writer.key("name").value(info.first);
+    writer.key("color").value(info.second);
+    writer.endObject();
+  }
+  writer.endObject();
+
+  writer.endObject();
+}
+
+Result<std::unique_ptr<IRGraph>> IRGraph::readJson(JsonReader &reader) {
+  using GraphResult = Result<std::unique_ptr<IRGraph>>;
+  auto graph = std::make_unique<IRGraph>();
+  // Connections may precede the nodes they join, so they are made last
+  std::vector<std::pair<PortId, PortId>> connections;
+
+  const auto readNode = [&] {
+    auto node = readNodeMembers(reader);
+    if (node.isError()) {
+      return false;
+    }
+    const NodeId id = node.value()->getId();
+    if (!graph->m_nodes.try_emplace(id, std::move(node).value()).second) {
+      reader.fail("Duplicate node ID " + std::to_string(id));
+      return false;
+    }
+    graph->m_adjacency.try_emplace(id);
+    graph->m_nextId = std::max(graph->m_nextId, id + 1);
+    return true;
+  };
+
+  const auto readConnection = [&] {
+    PortId source{0, {}, true};
+    PortId target{0, {}, false};
+    const bool ok = readMembers(reader, [&](std::string_view key) {
+      if (key == "sourceNode") {
+        return readId(reader, source.nodeId);
+      }
+      if (key == "sourcePort") {
+        return readString(reader, source.portName);
+      }
+      if (key == "targetNode") {
+        return readId(reader, target.nodeId);
+      }
+      if (key == "targetPort") {
+        return readString(reader, target.portName);
+      }
+      return skip(reader);
+    });
+    connections.emplace_back(std::move(source), std::move(target));
+    return ok;
+  };
+
+  const bool ok = readObject(reader, [&](std::string_view key) {
+    if (key == "name") {
+      return readString(reader, graph->m_name);
+    }
+    if (key == "nodes") {
+      return readObjects(reader, readNode);
+    }
+    if (key == "connections") {
+      return readObjects(reader, readConnection);
+    }
+    if (key == "scenes") {
+      return readObject(reader, [&](std::string_view name) {
+        std::string scene(name);
+        return readId(reader, graph->m_sceneStartNodes[std::move(scene)]);
+      });
+    }
+    if (key == "characters") {
+      return readObject(reader, [&](std::string_view id) {
+        auto &info = graph->m_characters[std::string(id)];
+        return readObject(reader, [&](std::string_view field) {
+          if (field == "name") {
+            return readString(reader, info.first);
+          }
+          if (field == "color") {
+            return readString(reader, info.second);
+          }
+          return skip(reader);
+        });
+      });
+    }
+    return skip(reader);
+  });
+  if (!ok) {
+    return GraphResult::error(reader.getError());
+  }
+
+  for (const auto &[source, target] : connections) {
+    auto connected = graph->connect(source, target);
+    if (connected.isError()) {
+      return GraphResult::error("Connection " + std::to_string(source.nodeId) +
+                                " -> " + std::to_string(target.nodeId) + ": " +
+                                connected.error());
+    }
   }
-  ss << "}";
+  return GraphResult::ok(std::move(graph));
+}
+
+Result<void> IRGraph::saveJson(const std::string &path) const {
+  return saveDocument(path, [this](JsonWriter &writer) { writeJson(writer); });
+}
 
-  ss << "}";
-  return ss.str();
+Result<std::unique_ptr<IRGraph>> IRGraph::loadJson(const std::string &path) {
+  return loadDocument<IRGraph>(path, readJson);
 }
 
 // ============================================================================
@@ -602,16 +983,18 @@ ASTToIRConverter::convert(const Program &program) {
 }
 
 void ASTToIRConverter::convertCharacterDecl(const CharacterDecl &decl) {
-  m_graph->addCharacter(decl.id, decl.displayName, decl.color);
+  m_graph->addCharacter(std::string(decl.id), std::string(decl.displayName),
+                        std::string(decl.color));
 }
 
 NodeId ASTToIRConverter::convertScene(const SceneDecl &scene) {
   NodeId startId = m_graph->createNode(IRNodeType::SceneStart);
   auto *startNode = m_graph->getNode(startId);
-  startNode->setProperty("sceneName", scene.name);
+  const std::string sceneName(scene.name);
+  startNode->setProperty("sceneName", sceneName);
   startNode->setPosition(100.0f, m_currentY);
 
-  m_graph->addScene(scene.name, startId);
+  m_graph->addScene(sceneName, startId);
 
   NodeId prevNode = startId;
   f32 y = m_currentY + m_nodeSpacing;
@@ -649,9 +1032,9 @@ NodeId ASTToIRConverter::convertStatement(const Statement &stmt,
           auto *node = m_graph->getNode(nodeId);
 
           if (stmtData.target == ShowStmt::Target::Background) {
-            node->setProperty("background", stmtData.identifier);
+            node->setProperty("background", std::string(stmtData.identifier));
           } else {
-            node->setProperty("character", stmtData.identifier);
+            node->setProperty("character", std::string(stmtData.identifier));
           }
           node->setSourceLocation(stmt.location);
 
@@ -660,16 +1043,16 @@ NodeId ASTToIRConverter::convertStatement(const Statement &stmt,
           NodeId nodeId =
               createNodeAndConnect(IRNodeType::HideCharacter, prevNode);
           auto *node = m_graph->getNode(nodeId);
-          node->setProperty("character", stmtData.identifier);
+          node->setProperty("character", std::string(stmtData.identifier));
           node->setSourceLocation(stmt.location);
           return nodeId;
         } else if constexpr (std::is_same_v<T, SayStmt>) {
           NodeId nodeId = createNodeAndConnect(IRNodeType::Dialogue, prevNode);
           auto *node = m_graph->getNode(nodeId);
           if (stmtData.speaker) {
-            node->setProperty("character", *stmtData.speaker);
+            node->setProperty("character", std::string(*stmtData.speaker));
           }
-          node->setProperty("text", stmtData.text);
+          node->setProperty("text", std::string(stmtData.text));
           node->setSourceLocation(stmt.location);
           return nodeId;
         } else if constexpr (std::is_same_v<T, ChoiceStmt>) {
@@ -679,7 +1062,7 @@ NodeId ASTToIRConverter::convertStatement(const Statement &stmt,
 
           std::vector<std::string> optionTexts;
           for (const auto &opt : stmtData.options) {
-            optionTexts.push_back(opt.text);
+            optionTexts.emplace_back(opt.text);
           }
           choiceNode->setProperty("options", optionTexts);
 
@@ -692,7 +1075,7 @@ NodeId ASTToIRConverter::convertStatement(const Statement &stmt,
         } else if constexpr (std::is_same_v<T, GotoStmt>) {
           NodeId gotoId = createNodeAndConnect(IRNodeType::Goto, prevNode);
           auto *gotoNode = m_graph->getNode(gotoId);
-          gotoNode->setProperty("target", stmtData.target);
+          gotoNode->setProperty("target", std::string(stmtData.target));
           gotoNode->setSourceLocation(stmt.location);
           return gotoId;
         } else if constexpr (std::is_same_v<T, PlayStmt>) {
@@ -701,7 +1084,7 @@ NodeId ASTToIRConverter::convertStatement(const Statement &stmt,
                                     : IRNodeType::PlaySound;
           NodeId nodeId = createNodeAndConnect(nodeType, prevNode);
           auto *node = m_graph->getNode(nodeId);
-          node->setProperty("track", stmtData.resource);
+          node->setProperty("track", std::string(stmtData.resource));
           if (stmtData.loop && *stmtData.loop) {
             node->setProperty("loop", true);
           }
@@ -721,7 +1104,7 @@ NodeId ASTToIRConverter::convertStatement(const Statement &stmt,
           NodeId nodeId =
               createNodeAndConnect(IRNodeType::Transition, prevNode);
           auto *node = m_graph->getNode(nodeId);
-          node->setProperty("type", stmtData.type);
+          node->setProperty("type", std::string(stmtData.type));
           node->setProperty("duration", static_cast<f64>(stmtData.duration));
           node->setSourceLocation(stmt.location);
           return nodeId;
@@ -772,8 +1155,11 @@ Result<Program> IRToASTConverter::convert(const IRGraph &graph) {
       continue;
     }
 
+    AstArena &arena = *program.arena;
     SceneDecl scene;
-    scene.name = sceneName;
+    scene.name = arena.intern(sceneName);
+
+    std::vector<StmtPtr> body;
 
     auto execOrder = graph.getExecutionOrder();
     for (NodeId id : execOrder) {
@@ -782,11 +1168,12 @@ Result<Program> IRToASTConverter::convert(const IRGraph &graph) {
         continue;
       }
 
-      auto stmt = convertNode(node, graph);
+      StmtPtr stmt = convertNode(node, graph, arena);
       if (stmt) {
-        scene.body.push_back(std::move(stmt));
+        body.push_back(stmt);
       }
     }
+    scene.body = arena.makeList(body);
 
     program.scenes.push_back(std::move(scene));
   }
@@ -794,74 +1181,67 @@ Result<Program> IRToASTConverter::convert(const IRGraph &graph) {
   return Result<Program>::ok(std::move(program));
 }
 
-std::unique_ptr<Statement>
-IRToASTConverter::convertNode(const IRNode *node, const IRGraph & /*graph*/) {
+StmtPtr IRToASTConverter::convertNode(const IRNode *node,
+                                      const IRGraph & /*graph*/,
+                                      AstArena &arena) {
   m_visited.insert(node->getId());
 
   switch (node->getType()) {
   case IRNodeType::ShowCharacter: {
     ShowStmt show;
     show.target = ShowStmt::Target::Character;
-    show.identifier = node->getStringProperty("character");
-    return std::make_unique<Statement>(std::move(show),
-                                       node->getSourceLocation());
+    show.identifier = arena.intern(node->getStringProperty("character"));
+    return makeStmt(arena, std::move(show), node->getSourceLocation());
   }
 
   case IRNodeType::ShowBackground: {
     ShowStmt show;
     show.target = ShowStmt::Target::Background;
-    show.identifier = node->getStringProperty("background");
-    return std::make_unique<Statement>(std::move(show),
-                                       node->getSourceLocation());
+    show.identifier = arena.intern(node->getStringProperty("background"));
+    return makeStmt(arena, std::move(show), node->getSourceLocation());
   }
 
   case IRNodeType::HideCharacter: {
     HideStmt hide;
-    hide.identifier = node->getStringProperty("character");
-    return std::make_unique<Statement>(std::move(hide),
-                                       node->getSourceLocation());
+    hide.identifier = arena.intern(node->getStringProperty("character"));
+    return makeStmt(arena, std::move(hide), node->getSourceLocation());
   }
 
   case IRNodeType::Dialogue: {
     SayStmt say;
     std::string character = node->getStringProperty("character");
     if (!character.empty()) {
-      say.speaker = character;
+      say.speaker = arena.intern(character);
     }
-    say.text = node->getStringProperty("text");
-    return std::make_unique<Statement>(std::move(say),
-                                       node->getSourceLocation());
+    say.text = arena.intern(node->getStringProperty("text"));
+    return makeStmt(arena, std::move(say), node->getSourceLocation());
   }
 
   case IRNodeType::PlayMusic: {
     PlayStmt play;
     play.type = PlayStmt::MediaType::Music;
-    play.resource = node->getStringProperty("track");
+    play.resource = arena.intern(node->getStringProperty("track"));
     play.loop = node->getBoolProperty("loop", false);
-    return std::make_unique<Statement>(std::move(play),
-                                       node->getSourceLocation());
+    return makeStmt(arena, std::move(play), node->getSourceLocation());
   }
 
   case IRNodeType::PlaySound: {
     PlayStmt play;
     play.type = PlayStmt::MediaType::Sound;
-    play.resource = node->getStringProperty("track");
-    return std::make_unique<Statement>(std::move(play),
-                                       node->getSourceLocation());
+    play.resource = arena.intern(node->getStringProperty("track"));
+    return makeStmt(arena, std::move(play), node->getSourceLocation());
   }
 
   case IRNodeType::Wait: {
     WaitStmt wait;
     wait.duration = static_cast<f32>(node->getFloatProperty("duration", 1.0));
-    return std::make_unique<Statement>(std::move(wait),
-                                       node->getSourceLocation());
+    return makeStmt(arena, std::move(wait), node->getSourceLocation());
   }
 
   case IRNodeType::Goto: {
     GotoStmt gotoStmt;
-    gotoStmt.target = node->getStringProperty("target");
-    return std::make_unique<Statement>(std::move(gotoStmt),
-                                       node->getSourceLocation());
+    gotoStmt.target = arena.intern(node->getStringProperty("target"));
+    return makeStmt(arena, std::move(gotoStmt), node->getSourceLocation());
   }
 
   default:
@@ -869,9 +1249,8 @@ IRToASTConverter::convertNode(const IRNode *node, const IRGraph & /*graph*/) {
   }
 }
 
-std::unique_ptr<Expression>
-IRToASTConverter::convertToExpression(const IRNode * /*node*/,
-                                      const IRGraph & /*graph*/) {
+ExprPtr IRToASTConverter::convertToExpression(const IRNode * /*node*/,
+                                              const IRGraph & /*graph*/) {
   // Stub implementation
   return nullptr;
 }
@@ -1005,7 +1384,7 @@ void ASTToTextGenerator::generateExpression(const Expression &expr) {
           std::visit(
               [this](const auto &val) {
                 using V = std::decay_t<decltype(val)>;
-                if constexpr (std::is_same_v<V, std::string>) {
+                if constexpr (std::is_same_v<V, std::string_view>) {
                   write("\"");
                   write(val);
                   write("\"");
@@ -1033,7 +1412,7 @@ void ASTToTextGenerator::indent() {
 
 void ASTToTextGenerator::newline() { m_output += "\n"; }
 
-void ASTToTextGenerator::write(const std::string &text) { m_output += text; }
+void ASTToTextGenerator::write(std::string_view text) { m_output += text; }
 
 // ============================================================================
 // VisualGraph Implementation
@@ -1099,34 +1478,9 @@ void VisualGraph::fromIR(const IRGraph &ir) {
 std::unique_ptr<IRGraph> VisualGraph::toIR() const {
   auto ir = std::make_unique<IRGraph>();
 
-  static std::unordered_map<std::string, IRNodeType> typeMap = {
-      {"SceneStart", IRNodeType::SceneStart},
-      {"SceneEnd", IRNodeType::SceneEnd},
-      {"Comment", IRNodeType::Comment},
-      {"Sequence", IRNodeType::Sequence},
-      {"Branch", IRNodeType::Branch},
-      {"ShowCharacter", IRNodeType::ShowCharacter},
-      {"HideCharacter", IRNodeType::HideCharacter},
-      {"ShowBackground", IRNodeType::ShowBackground},
-      {"Dialogue", IRNodeType::Dialogue},
-      {"Choice", IRNodeType::Choice},
-      {"PlayMusic", IRNodeType::PlayMusic},
-      {"StopMusic", IRNodeType::StopMusic},
-      {"PlaySound", IRNodeType::PlaySound},
-      {"Transition", IRNodeType::Transition},
-      {"Wait", IRNodeType::Wait},
-      {"SetVariable", IRNodeType::SetVariable},
-      {"GetVariable", IRNodeType::GetVariable},
-      {"Goto", IRNodeType::Goto},
-      {"Label", IRNodeType::Label}};
-
   std::unordered_map<NodeId, NodeId> idMap;
   for (const auto &vnode : m_nodes) {
-    auto typeIt = typeMap.find(vnode.type);
-    IRNodeType type =
-        (typeIt != typeMap.end()) ? typeIt->second : IRNodeType::Custom;
-
-    NodeId newId = ir->createNode(type);
+    NodeId newId = ir->createNode(nodeTypeFromName(vnode.type));
     idMap[vnode.id] = newId;
 
     auto *node = ir->getNode(newId);
@@ -1161,6 +1515,13 @@ std::unique_ptr<IRGraph> VisualGraph::toIR() const {
         node->setProperty(name, value);
       }
     }
+
+    if (node->getType() == IRNodeType::SceneStart) {
+      auto scene = vnode.properties.find("sceneName");
+      if (scene != vnode.properties.end()) {
+        ir->addScene(scene->second, newId);
+      }
+    }
   }
 
   for (const auto &edge : m_edges) {
@@ -1306,35 +1667,185 @@ void VisualGraph::autoLayout() {
 }
 
 std::string VisualGraph::toJson() const {
-  std::stringstream ss;
-  ss << "{\"nodes\":[";
+  std::string json;
+  JsonWriter writer(json);
+  writeJson(writer);
+  return json;
+}
+
+std::unique_ptr<VisualGraph> VisualGraph::fromJson(const std::string &json) {
+  auto graph = readDocument<VisualGraph>(json, readJson);
+  return graph.isOk() ? std::move(graph).value() : nullptr;
+}
+
+void VisualGraph::writeJson(JsonWriter &writer) const {
+  const auto writePorts =
+      [&writer](const std::vector<std::pair<std::string, std::string>> &ports) {
+        writer.beginArray();
+        for (const auto &[name, displayName] : ports) {
+          writer.beginObject();
+          writer.key("name").value(name);
+          writer.key("displayName").value(displayName);
+          writer.endObject();
+        }
+        writer.endArray();
+      };
 
-  bool first = true;
+  writer.beginObject();
+  writer.key("nodes").beginArray();
   for (const auto &node : m_nodes) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << "{\"id\":" << node.id;
-    ss << ",\"type\":\"" << node.type << "\"";
-    ss << ",\"x\":" << node.x;
-    ss << ",\"y\":" << node.y << "}";
+    writer.beginObject();
+    writer.key("id").value(node.id);
+    writer.key("type").value(node.type);
+    writer.key("displayName").value(node.displayName);
+    writer.key("x").value(node.x);
+    writer.key("y").value(node.y);
+    writer.key("width").value(node.width);
+    writer.key("height").value(node.height);
+    writer.key("inputs");
+    writePorts(node.inputPorts);
+    writer.key("outputs");
+    writePorts(node.outputPorts);
+    writer.key("properties").beginObject();
+    for (const auto &[name, value] : node.properties) {
+      writer.key(name).value(value);
+    }
+    writer.endObject();
+    writer.endObject();
   }
+  writer.endArray();
 
-  ss << "],\"edges\":[";
-
-  first = true;
+  writer.key("edges").beginArray();
   for (const auto &edge : m_edges) {
-    if (!first)
-      ss << ",";
-    first = false;
-    ss << "{\"src\":" << edge.sourceNode;
-    ss << ",\"srcPort\":\"" << edge.sourcePort << "\"";
-    ss << ",\"tgt\":" << edge.targetNode;
-    ss << ",\"tgtPort\":\"" << edge.targetPort << "\"}";
+    writer.beginObject();
+    writer.key("src").value(edge.sourceNode);
+    writer.key("srcPort").value(edge.sourcePort);
+    writer.key("tgt").value(edge.targetNode);
+    writer.key("tgtPort").value(edge.targetPort);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.endObject();
+}
+
+Result<std::unique_ptr<VisualGraph>>
+VisualGraph::readJson(JsonReader &reader) {
+  auto graph = std::make_unique<VisualGraph>();
+
+  const auto readPorts =
+      [&reader](std::vector<std::pair<std::string, std::string>> &ports) {
+        return readObjects(reader, [&] {
+          auto &port = ports.emplace_back();
+          return readMembers(reader, [&](std::string_view key) {
+            if (key == "name") {
+              return readString(reader, port.first);
+            }
+            if (key == "displayName") {
+              return readString(reader, port.second);
+            }
+            return skip(reader);
+          });
+        });
+      };
+
+  const auto readNode = [&] {
+    VisualGraphNode node;
+    node.id = 0;
+    node.x = 0.0f;
+    node.y = 0.0f;
+    bool hasDisplayName = false;
+    const bool ok = readMembers(reader, [&](std::string_view key) {
+      if (key == "id") {
+        return readId(reader, node.id);
+      }
+      if (key == "type") {
+        return readString(reader, node.type);
+      }
+      if (key == "displayName") {
+        hasDisplayName = true;
+        return readString(reader, node.displayName);
+      }
+      if (key == "x") {
+        return readFloat(reader, node.x);
+      }
+      if (key == "y") {
+        return readFloat(reader, node.y);
+      }
+      if (key == "width") {
+        return readFloat(reader, node.width);
+      }
+      if (key == "height") {
+        return readFloat(reader, node.height);
+      }
+      if (key == "inputs") {
+        return readPorts(node.inputPorts);
+      }
+      if (key == "outputs") {
+        return readPorts(node.outputPorts);
+      }
+      if (key == "properties") {
+        return readObject(reader, [&](std::string_view name) {
+          return readString(reader, node.properties[std::string(name)]);
+        });
+      }
+      return skip(reader);
+    });
+    if (!ok) {
+      return false;
+    }
+    if (!hasDisplayName) {
+      node.displayName = node.type;
+    }
+    graph->m_nextId = std::max(graph->m_nextId, node.id + 1);
+    graph->m_nodes.push_back(std::move(node));
+    return true;
+  };
+
+  const auto readEdge = [&] {
+    VisualGraphEdge edge;
+    edge.sourceNode = 0;
+    edge.targetNode = 0;
+    const bool ok = readMembers(reader, [&](std::string_view key) {
+      if (key == "src") {
+        return readId(reader, edge.sourceNode);
+      }
+      if (key == "srcPort") {
+        return readString(reader, edge.sourcePort);
+      }
+      if (key == "tgt") {
+        return readId(reader, edge.targetNode);
+      }
+      if (key == "tgtPort") {
+        return readString(reader, edge.targetPort);
+      }
+      return skip(reader);
+    });
+    graph->m_edges.push_back(std::move(edge));
+    return ok;
+  };
+
+  const bool ok = readObject(reader, [&](std::string_view key) {
+    if (key == "nodes") {
+      return readObjects(reader, readNode);
+    }
+    if (key == "edges") {
+      return readObjects(reader, readEdge);
+    }
+    return skip(reader);
+  });
+  if (!ok) {
+    return Result<std::unique_ptr<VisualGraph>>::error(reader.getError());
   }
+  return Result<std::unique_ptr<VisualGraph>>::ok(std::move(graph));
+}
 
-  ss << "]}";
-  return ss.str();
+Result<void> VisualGraph::saveJson(const std::string &path) const {
+  return saveDocument(path, [this](JsonWriter &writer) { writeJson(writer); });
+}
+
+Result<std::unique_ptr<VisualGraph>>
+VisualGraph::loadJson(const std::string &path) {
+  return loadDocument<VisualGraph>(path, readJson);
 }
 
 // ============================================================================
@@ -1422,6 +1933,186 @@ RoundTripConverter::validateConversion(const std::string & /*original*/,
 // GraphDiffer Implementation
 // ============================================================================
 
+namespace {
+
+constexpr u32 NO_GROUP = static_cast<u32>(-1);
+
+u64 mixHash(u64 value) {
+  value ^= value >> 30;
+  value *= 0xBF58476D1CE4E5B9ULL;
+  value ^= value >> 27;
+  value *= 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+u64 hashText(std::string_view text) { return std::hash<std::string_view>{}(text); }
+
+u64 hashFloat(f32 value) {
+  u32 bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Covers what GraphDiffer compares; properties are summed, so their order
+// in the map does not matter
+u64 hashNode(const VisualGraphNode &node) {
+  u64 hash = mixHash(node.id);
+  hash = mixHash(hash ^ hashText(node.type));
+  hash = mixHash(hash ^ hashText(node.displayName));
+  hash = mixHash(hash ^ (hashFloat(node.x) << 32 | hashFloat(node.y)));
+  u64 properties = 0;
+  for (const auto &[name, value] : node.properties) {
+    properties += mixHash(hashText(name) * 31 + hashText(value));
+  }
+  return mixHash(hash ^ properties);
+}
+
+u64 hashEdge(const VisualGraphEdge &edge) {
+  u64 hash = mixHash(edge.sourceNode ^ 0x9E3779B97F4A7C15ULL);
+  hash = mixHash(hash ^ hashText(edge.sourcePort));
+  hash = mixHash(hash ^ edge.targetNode);
+  return mixHash(hash ^ hashText(edge.targetPort));
+}
+
+// Nodes and edges of a VisualGraph split by the scene that reaches them
+struct SceneGroups {
+  std::unordered_map<std::string_view, u32> byScene; // "" holds the rest
+  std::vector<std::vector<u32>> nodes; // Indices into getNodes(), per group
+  std::vector<std::vector<u32>> edges; // Indices into getEdges(), per group
+  std::unordered_map<NodeId, u32> nodeIndex; // First node with each ID
+  // Edges by source node index: outgoing[outgoingStart[n]..outgoingStart[n+1])
+  std::vector<u32> outgoingStart;
+  std::vector<u32> outgoing;
+  std::vector<u32> danglingEdges; // Edges whose source is not a node
+
+  u32 groupFor(std::string_view scene) {
+    auto [it, inserted] =
+        byScene.try_emplace(scene, static_cast<u32>(nodes.size()));
+    if (inserted) {
+      nodes.emplace_back();
+      edges.emplace_back();
+    }
+    return it->second;
+  }
+
+  [[nodiscard]] std::span<const u32> outgoingOf(u32 node) const {
+    return {outgoing.data() + outgoingStart[node],
+            outgoingStart[node + 1] - outgoingStart[node]};
+  }
+
+  [[nodiscard]] u64 hash(const VisualGraph &graph, u32 group) const {
+    u64 result = 0;
+    for (u32 i : nodes[group]) {
+      result += hashNode(graph.getNodes()[i]);
+    }
+    for (u32 i : edges[group]) {
+      result += hashEdge(graph.getEdges()[i]);
+    }
+    return result;
+  }
+
+  [[nodiscard]] bool hasEdge(const VisualGraph &graph,
+                             const VisualGraphEdge &edge) const {
+    const auto matches = [&](u32 i) {
+      const auto &other = graph.getEdges()[i];
+      return other.sourceNode == edge.sourceNode &&
+             other.targetNode == edge.targetNode &&
+             other.sourcePort == edge.sourcePort &&
+             other.targetPort == edge.targetPort;
+    };
+    auto source = nodeIndex.find(edge.sourceNode);
+    const auto candidates = source != nodeIndex.end()
+                                ? outgoingOf(source->second)
+                                : std::span<const u32>(danglingEdges);
+    return std::any_of(candidates.begin(), candidates.end(), matches);
+  }
+};
+
+SceneGroups groupByScene(const VisualGraph &graph) {
+  const auto &nodes = graph.getNodes();
+  const auto &edges = graph.getEdges();
+  SceneGroups groups;
+  groups.nodeIndex.reserve(nodes.size());
+  for (u32 i = 0; i < nodes.size(); ++i) {
+    groups.nodeIndex.emplace(nodes[i].id, i);
+  }
+
+  // Bucket the edges by source node
+  std::vector<u32> sourceOf(edges.size(), NO_GROUP);
+  groups.outgoingStart.assign(nodes.size() + 1, 0);
+  for (u32 i = 0; i < edges.size(); ++i) {
+    auto source = groups.nodeIndex.find(edges[i].sourceNode);
+    if (source == groups.nodeIndex.end()) {
+      groups.danglingEdges.push_back(i);
+      continue;
+    }
+    sourceOf[i] = source->second;
+    ++groups.outgoingStart[source->second + 1];
+  }
+  for (usize n = 0; n < nodes.size(); ++n) {
+    groups.outgoingStart[n + 1] += groups.outgoingStart[n];
+  }
+  groups.outgoing.resize(groups.outgoingStart.back());
+  std::vector<u32> fill(groups.outgoingStart.begin(),
+                        groups.outgoingStart.end() - 1);
+  for (u32 i = 0; i < edges.size(); ++i) {
+    if (sourceOf[i] != NO_GROUP) {
+      groups.outgoing[fill[sourceOf[i]]++] = i;
+    }
+  }
+
+  // Scenes claim the nodes they reach, in name order
+  std::vector<std::pair<std::string_view, u32>> starts;
+  for (u32 i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].type == "SceneStart") {
+      auto name = nodes[i].properties.find("sceneName");
+      starts.emplace_back(name == nodes[i].properties.end()
+                              ? std::string_view()
+                              : std::string_view(name->second),
+                          i);
+    }
+  }
+  std::sort(starts.begin(), starts.end());
+
+  std::vector<u32> groupOf(nodes.size(), NO_GROUP);
+  std::vector<u32> stack;
+  for (const auto &[scene, start] : starts) {
+    if (groupOf[start] != NO_GROUP) {
+      continue;
+    }
+    const u32 group = groups.groupFor(scene);
+    groupOf[start] = group;
+    stack.push_back(start);
+    while (!stack.empty()) {
+      const u32 node = stack.back();
+      stack.pop_back();
+      groups.nodes[group].push_back(node);
+      for (u32 edge : groups.outgoingOf(node)) {
+        auto target = groups.nodeIndex.find(edges[edge].targetNode);
+        if (target != groups.nodeIndex.end() &&
+            groupOf[target->second] == NO_GROUP) {
+          groupOf[target->second] = group;
+          stack.push_back(target->second);
+        }
+      }
+    }
+  }
+  for (u32 i = 0; i < nodes.size(); ++i) {
+    if (groupOf[i] == NO_GROUP) {
+      groupOf[i] = groups.groupFor({});
+      groups.nodes[groupOf[i]].push_back(i);
+    }
+  }
+  for (u32 i = 0; i < edges.size(); ++i) {
+    const u32 group = sourceOf[i] != NO_GROUP ? groupOf[sourceOf[i]]
+                                              : groups.groupFor({});
+    groups.edges[group].push_back(i);
+  }
+  return groups;
+}
+
+} // namespace
+
 GraphDiff GraphDiffer::diff(const VisualGraph &oldGraph,
                             const VisualGraph &newGraph) const {
   GraphDiff result;
@@ -1432,18 +2123,143 @@ GraphDiff GraphDiffer::diff(const VisualGraph &oldGraph,
   return result;
 }
 
+GraphDiff GraphDiffer::diff(const VisualGraph &oldGraph,
+                            const VisualGraph &newGraph,
+                            core::ThreadPool &pool) const {
+  SceneGroups oldGroups;
+  SceneGroups newGroups;
+  pool.submit([&] { oldGroups = groupByScene(oldGraph); });
+  pool.submit([&] { newGroups = groupByScene(newGraph); });
+  pool.wait();
+
+  // Groups of the same scene are compared with each other
+  std::vector<std::pair<u32, u32>> pairs;
+  for (const auto &[scene, group] : oldGroups.byScene) {
+    auto other = newGroups.byScene.find(scene);
+    pairs.emplace_back(group, other == newGroups.byScene.end() ? NO_GROUP
+                                                               : other->second);
+  }
+  for (const auto &[scene, group] : newGroups.byScene) {
+    if (oldGroups.byScene.count(scene) == 0) {
+      pairs.emplace_back(NO_GROUP, group);
+    }
+  }
+
+  // Entries are tagged with the pass and position diff() finds them at,
+  // so merging the groups restores diff()'s order
+  struct TaggedEntry {
+    u32 pass;
+    u32 index;
+    GraphDiffEntry entry;
+  };
+  const auto &oldNodes = oldGraph.getNodes();
+  const auto &newNodes = newGraph.getNodes();
+  const auto &oldEdges = oldGraph.getEdges();
+  const auto &newEdges = newGraph.getEdges();
+  std::vector<std::vector<TaggedEntry>> found(pairs.size());
+
+  for (usize p = 0; p < pairs.size(); ++p) {
+    pool.submit([&, p] {
+      const auto [oldGroup, newGroup] = pairs[p];
+      if (oldGroup != NO_GROUP && newGroup != NO_GROUP &&
+          oldGroups.hash(oldGraph, oldGroup) ==
+              newGroups.hash(newGraph, newGroup)) {
+        return;
+      }
+      auto &out = found[p];
+      if (oldGroup != NO_GROUP) {
+        for (u32 i : oldGroups.nodes[oldGroup]) {
+          if (newGroups.nodeIndex.count(oldNodes[i].id) == 0) {
+            GraphDiffEntry removed;
+            removed.type = GraphDiffType::NodeRemoved;
+            removed.nodeId = oldNodes[i].id;
+            removed.oldValue = oldNodes[i].type;
+            out.push_back({0, i, removed});
+          }
+        }
+        for (u32 i : oldGroups.edges[oldGroup]) {
+          if (!newGroups.hasEdge(newGraph, oldEdges[i])) {
+            GraphDiffEntry removed;
+            removed.type = GraphDiffType::EdgeRemoved;
+            removed.edge = oldEdges[i];
+            out.push_back({2, i, removed});
+          }
+        }
+      }
+      if (newGroup != NO_GROUP) {
+        for (u32 i : newGroups.nodes[newGroup]) {
+          auto oldIt = oldGroups.nodeIndex.find(newNodes[i].id);
+          if (oldIt == oldGroups.nodeIndex.end()) {
+            GraphDiffEntry added;
+            added.type = GraphDiffType::NodeAdded;
+            added.nodeId = newNodes[i].id;
+            added.newValue = newNodes[i].type;
+            out.push_back({1, i, added});
+            continue;
+          }
+          GraphDiff changes;
+          diffNode(oldNodes[oldIt->second], newNodes[i], changes);
+          for (auto &change : changes.entries) {
+            out.push_back({1, i, std::move(change)});
+          }
+        }
+        for (u32 i : newGroups.edges[newGroup]) {
+          if (!oldGroups.hasEdge(oldGraph, newEdges[i])) {
+            GraphDiffEntry added;
+            added.type = GraphDiffType::EdgeAdded;
+            added.edge = newEdges[i];
+            out.push_back({3, i, added});
+          }
+        }
+      }
+    });
+  }
+  pool.wait();
+
+  std::vector<TaggedEntry> merged;
+  for (auto &entries : found) {
+    std::move(entries.begin(), entries.end(), std::back_inserter(merged));
+  }
+  std::stable_sort(merged.begin(), merged.end(),
+                   [](const TaggedEntry &a, const TaggedEntry &b) {
+                     return a.pass != b.pass ? a.pass < b.pass
+                                             : a.index < b.index;
+                   });
+
+  GraphDiff result;
+  result.entries.reserve(merged.size());
+  for (auto &tagged : merged) {
+    switch (tagged.entry.type) {
+    case GraphDiffType::NodeModified:
+    case GraphDiffType::PropertyChanged:
+      result.hasPropertyChanges = true;
+      break;
+    case GraphDiffType::PositionChanged:
+      result.hasPositionChanges = true;
+      break;
+    default:
+      result.hasStructuralChanges = true;
+      break;
+    }
+    result.entries.push_back(std::move(tagged.entry));
+  }
+  return result;
+}
+
 void GraphDiffer::diffNodes(const VisualGraph &oldGraph,
                             const VisualGraph &newGraph,
                             GraphDiff &result) const {
   const auto &oldNodes = oldGraph.getNodes();
   const auto &newNodes = newGraph.getNodes();
 
-  // Build ID sets
-  std::unordered_set<NodeId> oldIds;
+  // Index both sides by ID
+  std::unordered_map<NodeId, const VisualGraphNode *> oldIds;
   std::unordered_set<NodeId> newIds;
+  oldIds.reserve(oldNodes.size());
+  newIds.reserve(newNodes.size());
 
   for (const auto &node : oldNodes) {
-    oldIds.insert(node.id);
+    oldIds.emplace(node.id, &node);
   }
   for (const auto &node : newNodes) {
     newIds.insert(node.id);
@@ -1463,7 +2279,8 @@ void GraphDiffer::diffNodes(const VisualGraph &oldGraph,
 
   // Find added and modified nodes
   for (const auto &newNode : newNodes) {
-    if (oldIds.find(newNode.id) == oldIds.end()) {
+    auto oldIt = oldIds.find(newNode.id);
+    if (oldIt == oldIds.end()) {
       GraphDiffEntry entry;
       entry.type = GraphDiffType::NodeAdded;
       entry.nodeId = newNode.id;
@@ -1472,49 +2289,68 @@ void GraphDiffer::diffNodes(const VisualGraph &oldGraph,
       result.hasStructuralChanges = true;
     } else {
       // Node exists in both - check for modifications
-      const auto *oldNode = oldGraph.findNode(newNode.id);
-      if (oldNode) {
-        diffNodeProperties(*oldNode, newNode, result);
-
-        // Check position changes
-        if (oldNode->x != newNode.x || oldNode->y != newNode.y) {
-          GraphDiffEntry entry;
-          entry.type = GraphDiffType::PositionChanged;
-          entry.nodeId = newNode.id;
-          entry.oldValue =
-              std::to_string(oldNode->x) + "," + std::to_string(oldNode->y);
-          entry.newValue =
-              std::to_string(newNode.x) + "," + std::to_string(newNode.y);
-          result.entries.push_back(entry);
-          result.hasPositionChanges = true;
-        }
+      if (const auto *oldNode = oldIt->second) {
+        diffNode(*oldNode, newNode, result);
       }
     }
   }
 }
 
+void GraphDiffer::diffNode(const VisualGraphNode &oldNode,
+                           const VisualGraphNode &newNode,
+                           GraphDiff &result) const {
+  diffNodeProperties(oldNode, newNode, result);
+
+  // Check position changes
+  if (oldNode.x != newNode.x || oldNode.y != newNode.y) {
+    GraphDiffEntry entry;
+    entry.type = GraphDiffType::PositionChanged;
+    entry.nodeId = newNode.id;
+    entry.oldValue =
+        std::to_string(oldNode.x) + "," + std::to_string(oldNode.y);
+    entry.newValue = std::to_string(newNode.x) + "," + std::to_string(newNode.y);
+    result.entries.push_back(entry);
+    result.hasPositionChanges = true;
+  }
+}
+
 void GraphDiffer::diffEdges(const VisualGraph &oldGraph,
                             const VisualGraph &newGraph,
                             GraphDiff &result) const {
   const auto &oldEdges = oldGraph.getEdges();
   const auto &newEdges = newGraph.getEdges();
 
-  // Helper to compare edges
-  auto edgeEqual = [](const VisualGraphEdge &a, const VisualGraphEdge &b) {
-    return a.sourceNode == b.sourceNode && a.sourcePort == b.sourcePort &&
-           a.targetNode == b.targetNode && a.targetPort == b.targetPort;
+  // Edges are compared by value through a hash set of each side
+  struct EdgeHash {
+    usize operator()(const VisualGraphEdge *edge) const {
+      usize hash = std::hash<NodeId>{}(edge->sourceNode);
+      hash = hash * 31 + std::hash<std::string>{}(edge->sourcePort);
+      hash = hash * 31 + std::hash<NodeId>{}(edge->targetNode);
+      return hash * 31 + std::hash<std::string>{}(edge->targetPort);
+    }
+  };
+  struct EdgeEqual {
+    bool operator()(const VisualGraphEdge *a, const VisualGraphEdge *b) const {
+      return a->sourceNode == b->sourceNode && a->sourcePort == b->sourcePort &&
+             a->targetNode == b->targetNode && a->targetPort == b->targetPort;
+    }
+  };
+  using EdgeSet = std::unordered_set<const VisualGraphEdge *, EdgeHash, EdgeEqual>;
+
+  const auto index = [](const std::vector<VisualGraphEdge> &edges) {
+    EdgeSet set;
+    set.reserve(edges.size());
+    for (const auto &edge : edges) {
+      set.insert(&edge);
+    }
+    return set;
   };
+  const EdgeSet oldSet = index(oldEdges);
+  const EdgeSet newSet = index(newEdges);
 
   // Find removed edges
   for (const auto &oldEdge : oldEdges) {
-    bool found = false;
-    for (const auto &newEdge : newEdges) {
-      if (edgeEqual(oldEdge, newEdge)) {
-        found = true;
-        break;
-      }
-    }
-    if (!found) {
+    if (newSet.count(&oldEdge) == 0) {
       GraphDiffEntry entry;
       entry.type = GraphDiffType::EdgeRemoved;
       entry.edge = oldEdge;
@@ -1525,14 +2361,7 @@ void GraphDiffer::diffEdges(const VisualGraph &oldGraph,
 
   // Find added edges
   for (const auto &newEdge : newEdges) {
-    bool found = false;
-    for (const auto &oldEdge : oldEdges) {
-      if (edgeEqual(oldEdge, newEdge)) {
-        found = true;
-        break;
-      }
-    }
-    if (!found) {
+    if (oldSet.count(&newEdge) == 0) {
       GraphDiffEntry entry;
       entry.type = GraphDiffType::EdgeAdded;
       entry.edge = newEdge;
@@ -1970,6 +2799,104 @@ RoundTripValidator::validateFullRoundTrip(const std::string &nmScript) {
   return result;
 }
 
+namespace {
+
+std::string_view trimTrailingSpace(std::string_view text) {
+  const usize end = text.find_last_not_of(" \t\r\n");
+  return end == std::string_view::npos ? std::string_view() : text.substr(0, end + 1);
+}
+
+// Name of the scene a section declares, empty for other sections
+std::string_view declaredScene(std::string_view section) {
+  const auto isBlank = [](char c) { return c == ' ' || c == '\t'; };
+  const auto isName = [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+  };
+  usize i = 0;
+  while (i < section.size() && isBlank(section[i])) {
+    ++i;
+  }
+  if (section.substr(i, 5) != "scene" ||
+      (i + 5 < section.size() && isName(section[i + 5]))) {
+    return {};
+  }
+  i += 5;
+  while (i < section.size() && isBlank(section[i])) {
+    ++i;
+  }
+  usize end = i;
+  while (end < section.size() && isName(section[end])) {
+    ++end;
+  }
+  return section.substr(i, end - i);
+}
+
+} // namespace
+
+std::vector<RoundTripValidator::SceneResult>
+RoundTripValidator::validateScenes(const std::string &nmScript,
+                                   core::ThreadPool &pool) {
+  std::vector<SceneResult> results;
+  std::vector<std::string_view> texts;
+  usize offset = 0;
+  for (const std::string_view section : splitDeclarations(nmScript)) {
+    const std::string_view scene = declaredScene(section);
+    if (!scene.empty()) {
+      SceneResult result;
+      result.scene = scene;
+      result.offset = offset;
+      results.push_back(std::move(result));
+      texts.push_back(section);
+    }
+    offset += section.size();
+  }
+
+  // Converters keep lexer and parser state, so each worker gets its own
+  std::vector<std::unique_ptr<RoundTripConverter>> converters(
+      pool.getThreadCount());
+  std::vector<SceneVerdict> verdicts(results.size());
+  for (usize i = 0; i < results.size(); ++i) {
+    auto previous = m_sceneVerdicts.find(std::string(texts[i]));
+    if (previous != m_sceneVerdicts.end()) {
+      verdicts[i] = previous->second;
+      results[i].reused = true;
+      continue;
+    }
+    pool.submit([&, i] {
+      auto &converter = converters[pool.getCurrentWorker()];
+      if (!converter) {
+        converter = std::make_unique<RoundTripConverter>();
+      }
+      SceneVerdict &verdict = verdicts[i];
+      auto ir = converter->textToIR(std::string(texts[i]));
+      if (ir.isError()) {
+        verdict.differences.push_back("Failed to convert text to IR: " +
+                                      ir.error());
+        return;
+      }
+      auto text = converter->irToText(*ir.value());
+      if (text.isError()) {
+        verdict.differences.push_back("Failed to convert IR back to text: " +
+                                      text.error());
+      } else if (trimTrailingSpace(text.value()) !=
+                 trimTrailingSpace(texts[i])) {
+        verdict.differences.push_back("Text differs after round-trip");
+      } else {
+        verdict.isValid = true;
+      }
+    });
+  }
+  pool.wait();
+
+  m_sceneVerdicts.clear();
+  for (usize i = 0; i < results.size(); ++i) {
+    m_sceneVerdicts.try_emplace(std::string(texts[i]), verdicts[i]);
+    results[i].isValid = verdicts[i].isValid;
+    results[i].differences = std::move(verdicts[i].differences);
+  }
+  return results;
+}
+
 bool RoundTripValidator::areSemanticalllyEquivalent(const IRGraph &a,
                                                     const IRGraph &b) const {
   auto nodesA = a.getNodes();
@@ -1,6 +1,7 @@
 #include "NovelMind/scripting/lexer.hpp"
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 
 namespace NovelMind::scripting {
 
@@ -83,11 +84,10 @@ Result<std::vector<Token>> Lexer::tokenize(std::string_view source) {
 
     Token token = scanToken();
 
-    if (token.type == TokenType::Error) {
-      m_errors.emplace_back(token.lexeme, token.location);
-    } else if (token.type != TokenType::Newline) {
+    // Error tokens were already recorded in m_errors by errorToken()
+    if (token.type != TokenType::Error && token.type != TokenType::Newline) {
       // Skip newlines in token stream (optional: keep for statement separation)
-      tokens.push_back(std::move(token));
+      tokens.push_back(token);
     }
   }
 
@@ -295,21 +295,20 @@ Token Lexer::scanToken() {
 }
 
 Token Lexer::makeToken(TokenType type) {
-  std::string lexeme(m_source.substr(m_start, m_current - m_start));
-  return Token(type, std::move(lexeme), SourceLocation(m_line, m_startColumn));
-}
-
-Token Lexer::makeToken(TokenType type, const std::string &lexeme) {
-  return Token(type, lexeme, SourceLocation(m_line, m_startColumn));
+  return Token(type, m_source.substr(m_start, m_current - m_start),
+               SourceLocation(m_line, m_startColumn));
 }
 
 Token Lexer::errorToken(const std::string &message) {
-  return Token(TokenType::Error, message,
-               SourceLocation(m_line, m_startColumn));
+  SourceLocation location(m_line, m_startColumn);
+  m_errors.emplace_back(message, location);
+  return Token(TokenType::Error, m_source.substr(m_start, m_current - m_start),
+               location);
 }
 
 Token Lexer::scanString() {
-  std::string value;
+  // Escapes are only validated here; Token::text() decodes them on demand
+  bool escaped = false;
 
   while (!isAtEnd() && peek() != '"') {
     if (peek() == '\n') {
@@ -322,28 +321,19 @@ Token Lexer::scanString() {
         return errorToken("Unterminated string (escape at end)");
       }
 
-      char escaped = advance();
-      switch (escaped) {
+      switch (advance()) {
       case 'n':
-        value += '\n';
-        break;
       case 'r':
-        value += '\r';
-        break;
       case 't':
-        value += '\t';
-        break;
       case '\\':
-        value += '\\';
-        break;
       case '"':
-        value += '"';
+        escaped = true;
         break;
       default:
         return errorToken("Invalid escape sequence");
       }
     } else {
-      value += advance();
+      advance();
     }
   }
 
@@ -351,10 +341,14 @@ Token Lexer::scanString() {
     return errorToken("Unterminated string");
   }
 
+  // Contents between the quotes
+  Token token(TokenType::String,
+              m_source.substr(m_start + 1, m_current - m_start - 1),
+              SourceLocation(m_line, m_startColumn));
+  token.escaped = escaped;
+
   advance(); // Closing quote
 
-  Token token(TokenType::String, std::move(value),
-              SourceLocation(m_line, m_startColumn));
   return token;
 }
 
@@ -375,14 +369,17 @@ Token Lexer::scanNumber() {
     }
   }
 
-  std::string lexeme(m_source.substr(m_start, m_current - m_start));
+  std::string_view lexeme = m_source.substr(m_start, m_current - m_start);
   Token token(isFloat ? TokenType::Float : TokenType::Integer, lexeme,
               SourceLocation(m_line, m_startColumn));
 
-  if (isFloat) {
-    token.floatValue = std::stof(lexeme);
-  } else {
-    token.intValue = std::stoi(lexeme);
+  const char *first = lexeme.data();
+  const char *last = first + lexeme.size();
+  std::from_chars_result parsed =
+      isFloat ? std::from_chars(first, last, token.floatValue)
+              : std::from_chars(first, last, token.intValue);
+  if (parsed.ec != std::errc()) {
+    return errorToken("Number literal out of range");
   }
 
   return token;
@@ -393,10 +390,9 @@ Token Lexer::scanIdentifier() {
     advance();
   }
 
-  std::string lexeme(m_source.substr(m_start, m_current - m_start));
-  TokenType type = identifierType(lexeme);
-
-  return Token(type, std::move(lexeme), SourceLocation(m_line, m_startColumn));
+  std::string_view lexeme = m_source.substr(m_start, m_current - m_start);
+  return Token(identifierType(lexeme), lexeme,
+               SourceLocation(m_line, m_startColumn));
 }
 
 Token Lexer::scanColorLiteral() {
@@ -405,7 +401,7 @@ Token Lexer::scanColorLiteral() {
     advance();
   }
 
-  std::string lexeme(m_source.substr(m_start, m_current - m_start));
+  std::string_view lexeme = m_source.substr(m_start, m_current - m_start);
 
   // Validate color format: #RGB, #RGBA, #RRGGBB, #RRGGBBAA
   size_t hexLen = lexeme.size() - 1; // Exclude '#'
@@ -413,11 +409,11 @@ Token Lexer::scanColorLiteral() {
     return errorToken("Invalid color literal format");
   }
 
-  return Token(TokenType::String, std::move(lexeme),
+  return Token(TokenType::String, lexeme,
                SourceLocation(m_line, m_startColumn));
 }
 
-TokenType Lexer::identifierType(const std::string &lexeme) const {
+TokenType Lexer::identifierType(std::string_view lexeme) const {
   auto it = m_keywords.find(lexeme);
   if (it != m_keywords.end()) {
     return it->second;
@@ -425,4 +421,40 @@ TokenType Lexer::identifierType(const std::string &lexeme) const {
   return TokenType::Identifier;
 }
 
+std::string decodeStringLiteral(std::string_view raw) {
+  std::string value;
+  value.reserve(raw.size());
+
+  for (usize i = 0; i < raw.size(); ++i) {
+    char c = raw[i];
+    if (c != '\\' || i + 1 == raw.size()) {
+      value += c;
+      continue;
+    }
+
+    char escaped = raw[++i];
+    switch (escaped) {
+    case 'n':
+      value += '\n';
+      break;
+    case 'r':
+      value += '\r';
+      break;
+    case 't':
+      value += '\t';
+      break;
+    case '\\':
+    case '"':
+      value += escaped;
+      break;
+    default:
+      value += '\\';
+      value += escaped;
+      break;
+    }
+  }
+
+  return value;
+}
+
 } // namespace NovelMind::scripting
@@ -2,7 +2,7 @@
 
 namespace NovelMind::scripting {
 
-Parser::Parser() : m_tokens(nullptr), m_current(0) {}
+Parser::Parser() : m_tokens(nullptr), m_current(0), m_arena(nullptr) {}
 
 Parser::~Parser() = default;
 
@@ -11,11 +11,16 @@ Result<Program> Parser::parse(const std::vector<Token> &tokens) {
   m_current = 0;
   m_errors.clear();
   m_program = Program{};
+  m_arena = m_program.arena.get();
 
   while (!isAtEnd()) {
     try {
       parseDeclaration();
     } catch (...) {
+      // Lists that were being parsed are abandoned
+      m_stmtScratch.clear();
+      m_exprScratch.clear();
+      m_optionScratch.clear();
       synchronize();
     }
   }
@@ -24,6 +29,7 @@ Result<Program> Parser::parse(const std::vector<Token> &tokens) {
     return Result<Program>::error(m_errors[0].message);
   }
 
+  m_arena = nullptr;
   return Result<Program>::ok(std::move(m_program));
 }
 
@@ -130,7 +136,8 @@ CharacterDecl Parser::parseCharacterDecl() {
 
   const Token &id =
       consume(TokenType::Identifier, "Expected character identifier");
-  decl.id = id.lexeme;
+  decl.id = intern(id);
+  decl.location = id.location;
 
   if (match(TokenType::LeftParen)) {
     // Parse properties
@@ -142,17 +149,17 @@ CharacterDecl Parser::parseCharacterDecl() {
       if (propName.lexeme == "name") {
         const Token &value =
             consume(TokenType::String, "Expected string for name");
-        decl.displayName = value.lexeme;
+        decl.displayName = intern(value);
       } else if (propName.lexeme == "color") {
         const Token &value =
             consume(TokenType::String, "Expected color string");
-        decl.color = value.lexeme;
+        decl.color = intern(value);
       } else if (propName.lexeme == "sprite") {
         const Token &value =
             consume(TokenType::String, "Expected sprite string");
-        decl.defaultSprite = value.lexeme;
+        decl.defaultSprite = intern(value);
       } else {
-        error("Unknown character property: " + propName.lexeme);
+        error("Unknown character property: " + propName.text());
         // Skip the value
         advance();
       }
@@ -169,17 +176,11 @@ SceneDecl Parser::parseSceneDecl() {
   SceneDecl decl;
 
   const Token &name = consume(TokenType::Identifier, "Expected scene name");
-  decl.name = name.lexeme;
+  decl.name = intern(name);
+  decl.location = name.location;
 
   consume(TokenType::LeftBrace, "Expected '{' before scene body");
-
-  while (!check(TokenType::RightBrace) && !isAtEnd()) {
-    auto stmt = parseStatement();
-    if (stmt) {
-      decl.body.push_back(std::move(stmt));
-    }
-  }
-
+  decl.body = parseStatementList();
   consume(TokenType::RightBrace, "Expected '}' after scene body");
 
   return decl;
@@ -220,22 +221,28 @@ StmtPtr Parser::parseStatement() {
         (*m_tokens)[m_current + 1].type == TokenType::String) {
       advance(); // consume identifier
       SayStmt say;
-      say.speaker = id.lexeme;
+      say.speaker = intern(id);
       const Token &text =
           consume(TokenType::String, "Expected string after speaker");
-      say.text = text.lexeme;
-      return makeStmt(std::move(say), id.location);
+      say.text = intern(text);
+      return makeStmt(*m_arena, std::move(say), id.location);
     }
   }
 
   // Expression statement
+  const usize start = m_current;
   auto expr = parseExpression();
   if (expr) {
     ExpressionStmt exprStmt;
     exprStmt.expression = std::move(expr);
-    return makeStmt(std::move(exprStmt), previous().location);
+    return makeStmt(*m_arena, std::move(exprStmt), previous().location);
   }
 
+  // Skip a token no statement can start with, such as a declaration inside
+  // an unclosed block, so statement lists still reach their end
+  if (m_current == start && !isAtEnd()) {
+    advance();
+  }
   return nullptr;
 }
 
@@ -250,17 +257,17 @@ StmtPtr Parser::parseShowStmt() {
     stmt.target = ShowStmt::Target::Background;
     const Token &resource =
         consume(TokenType::String, "Expected background resource");
-    stmt.resource = resource.lexeme;
+    stmt.resource = intern(resource);
   } else {
     const Token &id =
         consume(TokenType::Identifier, "Expected character/sprite identifier");
-    stmt.identifier = id.lexeme;
+    stmt.identifier = intern(id);
     stmt.target = ShowStmt::Target::Character;
 
     // Optional sprite override
     if (check(TokenType::String)) {
       const Token &sprite = advance();
-      stmt.resource = sprite.lexeme;
+      stmt.resource = intern(sprite);
     }
 
     // Optional position
@@ -281,7 +288,7 @@ StmtPtr Parser::parseShowStmt() {
   if (match(TokenType::Transition)) {
     const Token &trans =
         consume(TokenType::Identifier, "Expected transition type");
-    stmt.transition = trans.lexeme;
+    stmt.transition = intern(trans);
 
     if (check(TokenType::Float) || check(TokenType::Integer)) {
       const Token &dur = advance();
@@ -291,7 +298,7 @@ StmtPtr Parser::parseShowStmt() {
     }
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseHideStmt() {
@@ -301,13 +308,13 @@ StmtPtr Parser::parseHideStmt() {
 
   const Token &id =
       consume(TokenType::Identifier, "Expected identifier to hide");
-  stmt.identifier = id.lexeme;
+  stmt.identifier = intern(id);
 
   // Optional transition
   if (match(TokenType::Transition)) {
     const Token &trans =
         consume(TokenType::Identifier, "Expected transition type");
-    stmt.transition = trans.lexeme;
+    stmt.transition = intern(trans);
 
     if (check(TokenType::Float) || check(TokenType::Integer)) {
       const Token &dur = advance();
@@ -317,7 +324,7 @@ StmtPtr Parser::parseHideStmt() {
     }
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseSayStmt() {
@@ -328,13 +335,13 @@ StmtPtr Parser::parseSayStmt() {
 
   if (check(TokenType::Identifier)) {
     const Token &speaker = advance();
-    stmt.speaker = speaker.lexeme;
+    stmt.speaker = intern(speaker);
   }
 
   const Token &text = consume(TokenType::String, "Expected dialogue text");
-  stmt.text = text.lexeme;
+  stmt.text = intern(text);
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseChoiceStmt() {
@@ -344,6 +351,7 @@ StmtPtr Parser::parseChoiceStmt() {
   // }
   SourceLocation loc = previous().location;
   ChoiceStmt stmt;
+  const usize firstOption = m_optionScratch.size();
 
   consume(TokenType::LeftBrace, "Expected '{' before choice options");
 
@@ -351,7 +359,7 @@ StmtPtr Parser::parseChoiceStmt() {
     ChoiceOption option;
 
     const Token &text = consume(TokenType::String, "Expected choice text");
-    option.text = text.lexeme;
+    option.text = intern(text);
 
     // Optional condition
     if (match(TokenType::If)) {
@@ -364,7 +372,7 @@ StmtPtr Parser::parseChoiceStmt() {
     if (match(TokenType::Goto)) {
       const Token &target =
           consume(TokenType::Identifier, "Expected goto target");
-      option.gotoTarget = target.lexeme;
+      option.gotoTarget = intern(target);
     } else if (check(TokenType::LeftBrace)) {
       advance();
       option.body = parseStatementList();
@@ -373,16 +381,17 @@ StmtPtr Parser::parseChoiceStmt() {
       // Single statement
       auto singleStmt = parseStatement();
       if (singleStmt) {
-        option.body.push_back(std::move(singleStmt));
+        option.body = m_arena->makeList({singleStmt});
       }
     }
 
-    stmt.options.push_back(std::move(option));
+    m_optionScratch.push_back(option);
   }
+  stmt.options = takeList(m_optionScratch, firstOption);
 
   consume(TokenType::RightBrace, "Expected '}' after choice block");
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseIfStmt() {
@@ -401,7 +410,7 @@ StmtPtr Parser::parseIfStmt() {
       // else if - create nested if as single statement in else branch
       auto nestedIf = parseIfStmt();
       if (nestedIf) {
-        stmt.elseBranch.push_back(std::move(nestedIf));
+        stmt.elseBranch = m_arena->makeList({nestedIf});
       }
     } else {
       consume(TokenType::LeftBrace, "Expected '{' before else body");
@@ -410,7 +419,7 @@ StmtPtr Parser::parseIfStmt() {
     }
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseGotoStmt() {
@@ -419,9 +428,9 @@ StmtPtr Parser::parseGotoStmt() {
   GotoStmt stmt;
 
   const Token &target = consume(TokenType::Identifier, "Expected goto target");
-  stmt.target = target.lexeme;
+  stmt.target = intern(target);
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseWaitStmt() {
@@ -439,7 +448,7 @@ StmtPtr Parser::parseWaitStmt() {
     stmt.duration = 0.0f;
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parsePlayStmt() {
@@ -458,7 +467,7 @@ StmtPtr Parser::parsePlayStmt() {
   }
 
   const Token &resource = consume(TokenType::String, "Expected resource path");
-  stmt.resource = resource.lexeme;
+  stmt.resource = intern(resource);
 
   // Optional volume
   if (check(TokenType::Float) || check(TokenType::Integer)) {
@@ -473,7 +482,7 @@ StmtPtr Parser::parsePlayStmt() {
     stmt.loop = true;
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseStopStmt() {
@@ -501,7 +510,7 @@ StmtPtr Parser::parseStopStmt() {
     }
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseSetStmt() {
@@ -510,13 +519,13 @@ StmtPtr Parser::parseSetStmt() {
   SetStmt stmt;
 
   const Token &var = consume(TokenType::Identifier, "Expected variable name");
-  stmt.variable = var.lexeme;
+  stmt.variable = intern(var);
 
   consume(TokenType::Assign, "Expected '=' after variable name");
 
   stmt.value = parseExpression();
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseTransitionStmt() {
@@ -531,7 +540,7 @@ StmtPtr Parser::parseTransitionStmt() {
   if (type.type == TokenType::Fade) {
     stmt.type = "fade";
   } else if (type.type == TokenType::Identifier) {
-    stmt.type = type.lexeme;
+    stmt.type = intern(type);
   } else {
     error("Expected transition type (fade, dissolve, slide, etc.)");
     stmt.type = "fade";
@@ -550,10 +559,10 @@ StmtPtr Parser::parseTransitionStmt() {
   // Optional color
   if (check(TokenType::String)) {
     const Token &color = advance();
-    stmt.color = color.lexeme;
+    stmt.color = intern(color);
   }
 
-  return makeStmt(std::move(stmt), loc);
+  return makeStmt(*m_arena, std::move(stmt), loc);
 }
 
 StmtPtr Parser::parseBlock() {
@@ -564,7 +573,7 @@ StmtPtr Parser::parseBlock() {
 
   consume(TokenType::RightBrace, "Expected '}' after block");
 
-  return makeStmt(std::move(block), loc);
+  return makeStmt(*m_arena, std::move(block), loc);
 }
 
 // Grammar rules - expressions (precedence climbing)
@@ -584,7 +593,7 @@ ExprPtr Parser::parseOr() {
     binary.op = op;
     binary.right = std::move(right);
 
-    expr = makeExpr(std::move(binary), loc);
+    expr = makeExpr(*m_arena, std::move(binary), loc);
   }
 
   return expr;
@@ -603,7 +612,7 @@ ExprPtr Parser::parseAnd() {
     binary.op = op;
     binary.right = std::move(right);
 
-    expr = makeExpr(std::move(binary), loc);
+    expr = makeExpr(*m_arena, std::move(binary), loc);
   }
 
   return expr;
@@ -622,7 +631,7 @@ ExprPtr Parser::parseEquality() {
     binary.op = op;
     binary.right = std::move(right);
 
-    expr = makeExpr(std::move(binary), loc);
+    expr = makeExpr(*m_arena, std::move(binary), loc);
   }
 
   return expr;
@@ -642,7 +651,7 @@ ExprPtr Parser::parseComparison() {
     binary.op = op;
     binary.right = std::move(right);
 
-    expr = makeExpr(std::move(binary), loc);
+    expr = makeExpr(*m_arena, std::move(binary), loc);
   }
 
   return expr;
@@ -661,7 +670,7 @@ ExprPtr Parser::parseTerm() {
     binary.op = op;
     binary.right = std::move(right);
 
-    expr = makeExpr(std::move(binary), loc);
+    expr = makeExpr(*m_arena, std::move(binary), loc);
   }
 
   return expr;
@@ -680,7 +689,7 @@ ExprPtr Parser::parseFactor() {
     binary.op = op;
     binary.right = std::move(right);
 
-    expr = makeExpr(std::move(binary), loc);
+    expr = makeExpr(*m_arena, std::move(binary), loc);
   }
 
   return expr;
@@ -696,7 +705,7 @@ ExprPtr Parser::parseUnary() {
     unary.op = op;
     unary.operand = std::move(operand);
 
-    return makeExpr(std::move(unary), loc);
+    return makeExpr(*m_arena, std::move(unary), loc);
   }
 
   return parseCall();
@@ -709,27 +718,24 @@ ExprPtr Parser::parseCall() {
     if (match(TokenType::LeftParen)) {
       // Function call
       SourceLocation loc = previous().location;
-      std::vector<ExprPtr> args;
+      const usize firstArg = m_exprScratch.size();
 
       if (!check(TokenType::RightParen)) {
         do {
-          args.push_back(parseExpression());
+          m_exprScratch.push_back(parseExpression());
         } while (match(TokenType::Comma));
       }
 
       consume(TokenType::RightParen, "Expected ')' after arguments");
 
+      CallExpr call;
       // Extract function name from expression
-      std::string callee;
       if (expr && std::holds_alternative<IdentifierExpr>(expr->data)) {
-        callee = std::get<IdentifierExpr>(expr->data).name;
+        call.callee = std::get<IdentifierExpr>(expr->data).name;
       }
+      call.arguments = takeList(m_exprScratch, firstArg);
 
-      CallExpr call;
-      call.callee = std::move(callee);
-      call.arguments = std::move(args);
-
-      expr = makeExpr(std::move(call), loc);
+      expr = makeExpr(*m_arena, std::move(call), loc);
     } else if (match(TokenType::Dot)) {
       // Property access
       SourceLocation loc = previous().location;
@@ -738,9 +744,9 @@ ExprPtr Parser::parseCall() {
 
       PropertyExpr prop;
       prop.object = std::move(expr);
-      prop.property = name.lexeme;
+      prop.property = intern(name);
 
-      expr = makeExpr(std::move(prop), loc);
+      expr = makeExpr(*m_arena, std::move(prop), loc);
     } else {
       break;
     }
@@ -755,37 +761,37 @@ ExprPtr Parser::parsePrimary() {
   if (match(TokenType::True)) {
     LiteralExpr lit;
     lit.value = true;
-    return makeExpr(std::move(lit), loc);
+    return makeExpr(*m_arena, std::move(lit), loc);
   }
 
   if (match(TokenType::False)) {
     LiteralExpr lit;
     lit.value = false;
-    return makeExpr(std::move(lit), loc);
+    return makeExpr(*m_arena, std::move(lit), loc);
   }
 
   if (match(TokenType::Integer)) {
     LiteralExpr lit;
     lit.value = previous().intValue;
-    return makeExpr(std::move(lit), loc);
+    return makeExpr(*m_arena, std::move(lit), loc);
   }
 
   if (match(TokenType::Float)) {
     LiteralExpr lit;
     lit.value = previous().floatValue;
-    return makeExpr(std::move(lit), loc);
+    return makeExpr(*m_arena, std::move(lit), loc);
   }
 
   if (match(TokenType::String)) {
     LiteralExpr lit;
-    lit.value = previous().lexeme;
-    return makeExpr(std::move(lit), loc);
+    lit.value = intern(previous());
+    return makeExpr(*m_arena, std::move(lit), loc);
   }
 
   if (match(TokenType::Identifier)) {
     IdentifierExpr id;
-    id.name = previous().lexeme;
-    return makeExpr(std::move(id), loc);
+    id.name = intern(previous());
+    return makeExpr(*m_arena, std::move(id), loc);
   }
 
   if (match(TokenType::LeftParen)) {
@@ -802,7 +808,7 @@ ExprPtr Parser::parsePrimary() {
 
 Position Parser::parsePosition() {
   if (check(TokenType::Identifier)) {
-    const std::string &pos = peek().lexeme;
+    std::string_view pos = peek().lexeme;
 
     if (pos == "left") {
       advance();
@@ -826,22 +832,38 @@ Position Parser::parsePosition() {
   return Position::Center;
 }
 
-std::string Parser::parseString() {
+std::string_view Parser::parseString() {
   const Token &str = consume(TokenType::String, "Expected string");
-  return str.lexeme;
+  return intern(str);
 }
 
-std::vector<StmtPtr> Parser::parseStatementList() {
-  std::vector<StmtPtr> statements;
+AstList<StmtPtr> Parser::parseStatementList() {
+  // Nested lists push above this mark and pop back before we append again
+  const usize first = m_stmtScratch.size();
 
   while (!check(TokenType::RightBrace) && !isAtEnd()) {
     auto stmt = parseStatement();
     if (stmt) {
-      statements.push_back(std::move(stmt));
+      m_stmtScratch.push_back(stmt);
     }
   }
 
-  return statements;
+  return takeList(m_stmtScratch, first);
+}
+
+std::string_view Parser::intern(const Token &token) {
+  if (token.escaped) {
+    return m_arena->intern(decodeStringLiteral(token.lexeme));
+  }
+  return m_arena->intern(token.lexeme);
+}
+
+template <typename T>
+AstList<T> Parser::takeList(std::vector<T> &scratch, usize first) {
+  AstList<T> list = m_arena->makeList(scratch.data() + first,
+                                      scratch.size() - first);
+  scratch.resize(first);
+  return list;
 }
 
 } // namespace NovelMind::scripting
@@ -0,0 +1,336 @@
+#include "NovelMind/scripting/project_compiler.hpp"
+#include "NovelMind/core/thread_pool.hpp"
+#include "NovelMind/core/timer.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/script_linker.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace NovelMind::scripting {
+
+namespace {
+
+// Tokenize and parse a loaded file; diagnostics stay with the file
+void parseFile(ProjectFile &file) {
+  Lexer lexer;
+  auto tokens = lexer.tokenize(file.source->getText());
+  if (tokens.isError()) {
+    for (const auto &err : lexer.getErrors()) {
+      file.diagnostics.addError(ErrorCode::UnexpectedCharacter, err.message,
+                                err.location);
+    }
+    file.diagnostics.attachSource(*file.source);
+    return;
+  }
+
+  Parser parser;
+  auto program = parser.parse(tokens.value());
+  if (program.isError()) {
+    for (const auto &err : parser.getErrors()) {
+      file.diagnostics.addError(ErrorCode::UnexpectedToken, err.message,
+                                err.location);
+    }
+    file.diagnostics.attachSource(*file.source);
+    return;
+  }
+  file.program = std::move(program).value();
+
+  file.compiled = CompiledFile{};
+  for (const auto &decl : file.program.characters) {
+    file.compiled.characters.emplace_back(decl.id);
+    file.compiled.characterLocations.push_back(decl.location);
+  }
+  for (const auto &scene : file.program.scenes) {
+    file.compiled.scenes.emplace_back(scene.name);
+    file.compiled.sceneLocations.push_back(scene.location);
+  }
+}
+
+// Load one file and take it from the cache if its entry is current
+void loadFile(ProjectFile &file, const CompileCache *cache) {
+  auto source = SourceFile::load(file.path);
+  if (source.isError()) {
+    file.diagnostics.addError(ErrorCode::InvalidSyntax, source.error(), {});
+    return;
+  }
+  file.source = source.value();
+
+  if (cache) {
+    file.cacheKey = cache->makeKey(file.source->getText());
+    if (auto cached = cache->load(file.path, file.cacheKey)) {
+      file.compiled = std::move(*cached);
+      file.fromCache = true;
+      return;
+    }
+  }
+  parseFile(file);
+}
+
+bool importsDeclared(const CompiledFile &file, const ProjectSymbols &symbols) {
+  for (const auto &scene : file.importedScenes) {
+    if (symbols.scenes.count(scene) == 0) {
+      return false;
+    }
+  }
+  for (const auto &character : file.importedCharacters) {
+    if (symbols.characters.count(character) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::string>
+sortedNames(const std::unordered_set<std::string> &names) {
+  std::vector<std::string> sorted(names.begin(), names.end());
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
+// Run body(i) for every file on the pool and wait for all of them
+template <typename Body>
+void forEachFile(core::ThreadPool &pool, usize count, Body body) {
+  for (usize i = 0; i < count; ++i) {
+    pool.submit([&body, i] { body(i); });
+  }
+  pool.wait();
+}
+
+} // namespace
+
+usize ProjectBuild::getErrorCount() const {
+  usize count = projectErrors.errorCount();
+  for (const auto &file : files) {
+    count += file.diagnostics.errorCount();
+  }
+  return count;
+}
+
+usize ProjectBuild::getWarningCount() const {
+  usize count = projectErrors.warningCount();
+  for (const auto &file : files) {
+    count += file.diagnostics.warningCount();
+  }
+  return count;
+}
+
+ProjectCompiler::ProjectCompiler(ProjectCompilerConfig config)
+    : m_config(config) {}
+
+Result<std::vector<std::string>>
+ProjectCompiler::collectSources(const std::string &path) {
+  std::error_code ec;
+  std::vector<std::string> sources;
+
+  if (fs::is_directory(path, ec)) {
+    for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end;
+         it.increment(ec)) {
+      if (it->is_regular_file(ec) && it->path().extension() == ".nms") {
+        sources.push_back(it->path().generic_string());
+      }
+    }
+    if (ec) {
+      return Result<std::vector<std::string>>::error(
+          "Cannot read directory: " + path + " (" + ec.message() + ")");
+    }
+    std::sort(sources.begin(), sources.end());
+  } else {
+    std::ifstream manifest(path);
+    if (!manifest.is_open()) {
+      return Result<std::vector<std::string>>::error("Cannot open file: " +
+                                                     path);
+    }
+
+    const fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+      const auto first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '#') {
+        continue;
+      }
+      const auto last = line.find_last_not_of(" \t\r");
+      sources.push_back(
+          (base / line.substr(first, last - first + 1)).generic_string());
+    }
+  }
+
+  if (sources.empty()) {
+    return Result<std::vector<std::string>>::error("No script files found in: " +
+                                                   path);
+  }
+  return Result<std::vector<std::string>>::ok(std::move(sources));
+}
+
+ProjectBuild ProjectCompiler::build(const std::vector<std::string> &paths) {
+  ProjectBuild build;
+  build.files.resize(paths.size());
+  for (usize i = 0; i < paths.size(); ++i) {
+    build.files[i].path = paths[i];
+  }
+
+  std::optional<CompileCache> cache;
+  if (!m_config.cacheDirectory.empty()) {
+    cache.emplace(m_config.cacheDirectory,
+                  CompileCache::hashContent(m_config.reportDeadCode
+                                                ? "dead-code=1"
+                                                : "dead-code=0"));
+  }
+  const CompileCache *cachePtr = cache ? &*cache : nullptr;
+
+  core::ThreadPool pool(m_config.threadCount);
+  core::Timer timer;
+
+  // Phase 1: load every file, then tokenize and parse the uncached ones
+  forEachFile(pool, build.files.size(),
+              [&](usize i) { loadFile(build.files[i], cachePtr); });
+  build.times.parse = timer.getElapsedSeconds();
+  if (build.getErrorCount() > 0) {
+    return build;
+  }
+
+  // Phase 2: link the declarations of all files, in input order
+  timer.reset();
+  ProjectSymbols &symbols = build.symbols;
+  std::unordered_map<std::string, usize> sceneOwners;
+  std::unordered_map<std::string, usize> characterOwners;
+  for (usize i = 0; i < build.files.size(); ++i) {
+    ProjectFile &file = build.files[i];
+    const CompiledFile &compiled = file.compiled;
+    for (usize c = 0; c < compiled.characters.size(); ++c) {
+      const std::string &id = compiled.characters[c];
+      auto [it, inserted] = characterOwners.try_emplace(id, i);
+      if (!inserted && it->second != i) {
+        file.diagnostics.addError(ErrorCode::DuplicateCharacterDefinition,
+                                  "Character '" + id +
+                                      "' is already defined in " +
+                                      build.files[it->second].path,
+                                  compiled.characterLocations[c]);
+      }
+      symbols.characters.insert(id);
+    }
+    for (usize s = 0; s < compiled.scenes.size(); ++s) {
+      const std::string &name = compiled.scenes[s];
+      auto [it, inserted] = sceneOwners.try_emplace(name, i);
+      if (!inserted && it->second != i) {
+        file.diagnostics.addError(ErrorCode::DuplicateSceneDefinition,
+                                  "Scene '" + name +
+                                      "' is already defined in " +
+                                      build.files[it->second].path,
+                                  compiled.sceneLocations[s]);
+      }
+      symbols.scenes.insert(name);
+    }
+  }
+
+  // A cached file that imports a symbol no file declares any more has to
+  // be validated again; its own declarations are unchanged
+  std::vector<usize> stale;
+  for (usize i = 0; i < build.files.size(); ++i) {
+    if (build.files[i].fromCache &&
+        !importsDeclared(build.files[i].compiled, symbols)) {
+      stale.push_back(i);
+    }
+  }
+  forEachFile(pool, stale.size(), [&](usize i) {
+    ProjectFile &file = build.files[stale[i]];
+    file.fromCache = false;
+    parseFile(file);
+  });
+
+  for (auto &file : build.files) {
+    if (file.fromCache) {
+      ++build.cache.hits;
+      for (const auto &diagnostic : file.compiled.diagnostics) {
+        file.diagnostics.add(diagnostic);
+      }
+      continue;
+    }
+    ++build.cache.misses;
+    build.linked.characters.insert(build.linked.characters.end(),
+                                   file.program.characters.begin(),
+                                   file.program.characters.end());
+    build.linked.scenes.insert(build.linked.scenes.end(),
+                               file.program.scenes.begin(),
+                               file.program.scenes.end());
+    build.linked.globalStatements.insert(build.linked.globalStatements.end(),
+                                         file.program.globalStatements.begin(),
+                                         file.program.globalStatements.end());
+  }
+  build.cache.invalidated = stale.size();
+  build.times.link = timer.getElapsedSeconds();
+
+  // Phase 3: validate each parsed file against the project's symbols
+  timer.reset();
+  forEachFile(pool, build.files.size(), [&](usize i) {
+    ProjectFile &file = build.files[i];
+    if (file.fromCache) {
+      return;
+    }
+    Validator validator;
+    validator.setReportDeadCode(m_config.reportDeadCode);
+    validator.setSource(file.source);
+    validator.setProjectSymbols(&symbols);
+    auto result = validator.validate(file.program);
+    for (const auto &err : result.errors.all()) {
+      file.diagnostics.add(err);
+    }
+    file.compiled.importedScenes = sortedNames(result.importedScenes);
+    file.compiled.importedCharacters = sortedNames(result.importedCharacters);
+  });
+  build.times.validate = timer.getElapsedSeconds();
+  if (!m_config.compile || build.getErrorCount() > 0) {
+    return build;
+  }
+
+  // Phase 4: compile each parsed file, then link every file's fragment
+  timer.reset();
+  forEachFile(pool, build.files.size(), [&](usize i) {
+    ProjectFile &file = build.files[i];
+    if (file.fromCache) {
+      return;
+    }
+    Compiler compiler;
+    auto fragment = compiler.compileFragment(file.program);
+    if (fragment.isError()) {
+      for (const auto &err : compiler.getErrors()) {
+        file.diagnostics.addError(ErrorCode::CompilationFailed, err.message,
+                                  err.location);
+      }
+      return;
+    }
+    file.compiled.fragment = std::move(fragment).value();
+    if (cachePtr) {
+      file.compiled.diagnostics = file.diagnostics.all();
+      // A failed store only costs the next build a recompile
+      (void)cachePtr->store(file.path, file.cacheKey, file.compiled);
+    }
+  });
+  if (build.getErrorCount() > 0) {
+    build.times.compile = timer.getElapsedSeconds();
+    return build;
+  }
+
+  std::vector<const ScriptFragment *> fragments;
+  fragments.reserve(build.files.size());
+  for (const auto &file : build.files) {
+    fragments.push_back(&file.compiled.fragment);
+  }
+  auto script = linkFragments(fragments);
+  if (script.isOk()) {
+    build.script = std::move(script).value();
+  } else {
+    build.projectErrors.addError(ErrorCode::CompilationFailed, script.error(),
+                                 {});
+  }
+  build.times.compile = timer.getElapsedSeconds();
+  return build;
+}
+
+} // namespace NovelMind::scripting
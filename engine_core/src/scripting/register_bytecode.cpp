@@ -0,0 +1,243 @@
+#include "NovelMind/scripting/register_bytecode.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+constexpr u32 SCRIPT_MAGIC = 0x43534D4E; // "NMSC"
+constexpr usize HEADER_SIZE = 24;
+
+void writeU8(std::vector<u8> &out, u8 value) { out.push_back(value); }
+
+void writeU16(std::vector<u8> &out, u16 value) {
+  u8 bytes[sizeof(u16)];
+  std::memcpy(bytes, &value, sizeof(u16));
+  out.insert(out.end(), bytes, bytes + sizeof(u16));
+}
+
+void writeU32(std::vector<u8> &out, u32 value) {
+  u8 bytes[sizeof(u32)];
+  std::memcpy(bytes, &value, sizeof(u32));
+  out.insert(out.end(), bytes, bytes + sizeof(u32));
+}
+
+void writeCString(std::vector<u8> &out, const std::string &str) {
+  out.insert(out.end(), str.begin(), str.end());
+  out.push_back(0);
+}
+
+class Reader {
+public:
+  explicit Reader(const std::vector<u8> &data) : m_data(data) {}
+
+  bool readU8(u8 &value) {
+    if (m_offset + 1 > m_data.size()) {
+      return false;
+    }
+    value = m_data[m_offset++];
+    return true;
+  }
+
+  bool readU32(u32 &value) {
+    if (m_offset + sizeof(u32) > m_data.size()) {
+      return false;
+    }
+    std::memcpy(&value, m_data.data() + m_offset, sizeof(u32));
+    m_offset += sizeof(u32);
+    return true;
+  }
+
+  bool readCString(std::string &value) {
+    auto begin = m_data.begin() + static_cast<std::ptrdiff_t>(m_offset);
+    auto end = std::find(begin, m_data.end(), u8{0});
+    if (end == m_data.end()) {
+      return false;
+    }
+    value.assign(begin, end);
+    m_offset = static_cast<usize>(end - m_data.begin()) + 1;
+    return true;
+  }
+
+  void seek(usize offset) { m_offset = offset; }
+
+private:
+  const std::vector<u8> &m_data;
+  usize m_offset = 0;
+};
+
+} // namespace
+
+OpCode commandOpCode(RegOp op) {
+  switch (op) {
+  case RegOp::SHOW_BACKGROUND:
+    return OpCode::SHOW_BACKGROUND;
+  case RegOp::SHOW_CHARACTER:
+    return OpCode::SHOW_CHARACTER;
+  case RegOp::HIDE_CHARACTER:
+    return OpCode::HIDE_CHARACTER;
+  case RegOp::SAY:
+    return OpCode::SAY;
+  case RegOp::CHOICE:
+    return OpCode::CHOICE;
+  case RegOp::PLAY_SOUND:
+    return OpCode::PLAY_SOUND;
+  case RegOp::PLAY_MUSIC:
+    return OpCode::PLAY_MUSIC;
+  case RegOp::STOP_MUSIC:
+    return OpCode::STOP_MUSIC;
+  case RegOp::WAIT:
+    return OpCode::WAIT;
+  case RegOp::TRANSITION:
+    return OpCode::TRANSITION;
+  case RegOp::GOTO_SCENE:
+    return OpCode::GOTO_SCENE;
+  default:
+    return OpCode::NOP;
+  }
+}
+
+u32 instructionWords(u32 word) {
+  RegOp op = decodeOp(word);
+  switch (op) {
+  case RegOp::JMP:
+  case RegOp::JMPIF:
+  case RegOp::JMPIFNOT:
+    return 2;
+  case RegOp::GOTO_SCENE:
+    return 2 + decodeBx(word);
+  default:
+    return isCommand(op) ? 1 + decodeBx(word) : 1;
+  }
+}
+
+std::vector<u8> serializeRegisterProgram(const RegisterProgram &program) {
+  std::vector<u8> out;
+  out.reserve(HEADER_SIZE + program.code.size() * sizeof(u32) +
+              program.constants.size() * 5);
+
+  writeU32(out, SCRIPT_MAGIC);
+  writeU16(out, NMSC_VERSION_REGISTER);
+  writeU16(out, 0); // flags
+  writeU32(out, static_cast<u32>(program.code.size()));
+  writeU32(out, static_cast<u32>(program.constants.size()));
+  writeU32(out, static_cast<u32>(program.stringTable.size()));
+  writeU32(out, static_cast<u32>(program.variableSlots.size()));
+
+  for (u32 word : program.code) {
+    writeU32(out, word);
+  }
+  for (const auto &constant : program.constants) {
+    writeU8(out, static_cast<u8>(constant.type));
+    writeU32(out, constant.bits);
+  }
+  for (const auto &str : program.stringTable) {
+    writeCString(out, str);
+  }
+  for (const auto &name : program.variableSlots) {
+    writeCString(out, name);
+  }
+
+  // Sorted so identical programs serialize to identical bytes
+  std::vector<std::pair<std::string, u32>> scenes(
+      program.sceneEntryPoints.begin(), program.sceneEntryPoints.end());
+  std::sort(scenes.begin(), scenes.end());
+  writeU32(out, static_cast<u32>(scenes.size()));
+  for (const auto &[name, offset] : scenes) {
+    writeCString(out, name);
+    writeU32(out, offset);
+  }
+
+  return out;
+}
+
+Result<RegisterProgram>
+deserializeRegisterProgram(const std::vector<u8> &bytecode) {
+  if (bytecode.size() < HEADER_SIZE) {
+    return Result<RegisterProgram>::error("Bytecode too small");
+  }
+
+  u32 magic = 0;
+  u16 version = 0;
+  std::memcpy(&magic, bytecode.data(), sizeof(u32));
+  std::memcpy(&version, bytecode.data() + 4, sizeof(u16));
+  if (magic != SCRIPT_MAGIC) {
+    return Result<RegisterProgram>::error("Invalid script magic");
+  }
+  if (version != NMSC_VERSION_REGISTER) {
+    return Result<RegisterProgram>::error("Unsupported NMSC version: " +
+                                          std::to_string(version));
+  }
+
+  Reader reader(bytecode);
+  reader.seek(8);
+  u32 wordCount = 0;
+  u32 constantCount = 0;
+  u32 stringCount = 0;
+  u32 slotCount = 0;
+  reader.readU32(wordCount);
+  reader.readU32(constantCount);
+  reader.readU32(stringCount);
+  reader.readU32(slotCount);
+
+  // Every entry takes at least one byte, so larger counts are corrupt and
+  // must not drive the reserve() calls below
+  const usize remaining = bytecode.size() - HEADER_SIZE;
+  if (static_cast<usize>(wordCount) * sizeof(u32) > remaining ||
+      constantCount > remaining || stringCount > remaining ||
+      slotCount > remaining) {
+    return Result<RegisterProgram>::error("Unexpected end of bytecode");
+  }
+
+  RegisterProgram program;
+  program.code.resize(wordCount);
+  for (auto &word : program.code) {
+    reader.readU32(word);
+  }
+
+  program.constants.resize(constantCount);
+  for (auto &constant : program.constants) {
+    u8 type = 0;
+    if (!reader.readU8(type) || !reader.readU32(constant.bits) ||
+        type > static_cast<u8>(ValueType::String)) {
+      return Result<RegisterProgram>::error("Invalid constant pool");
+    }
+    constant.type = static_cast<ValueType>(type);
+  }
+
+  program.stringTable.resize(stringCount);
+  for (auto &str : program.stringTable) {
+    if (!reader.readCString(str)) {
+      return Result<RegisterProgram>::error("Unexpected end of bytecode");
+    }
+  }
+
+  program.variableSlots.resize(slotCount);
+  for (auto &name : program.variableSlots) {
+    if (!reader.readCString(name)) {
+      return Result<RegisterProgram>::error("Unexpected end of bytecode");
+    }
+  }
+
+  u32 sceneCount = 0;
+  if (!reader.readU32(sceneCount)) {
+    return Result<RegisterProgram>::error("Unexpected end of bytecode");
+  }
+  for (u32 i = 0; i < sceneCount; ++i) {
+    std::string name;
+    u32 offset = 0;
+    if (!reader.readCString(name) || !reader.readU32(offset)) {
+      return Result<RegisterProgram>::error("Unexpected end of bytecode");
+    }
+    if (offset > wordCount) {
+      return Result<RegisterProgram>::error("Invalid scene entry point: " +
+                                            name);
+    }
+    program.sceneEntryPoints[name] = offset;
+  }
+
+  return Result<RegisterProgram>::ok(std::move(program));
+}
+
+} // namespace NovelMind::scripting
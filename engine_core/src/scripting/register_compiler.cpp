@@ -0,0 +1,519 @@
+#include "NovelMind/scripting/register_compiler.hpp"
+#include <cstring>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+constexpr u32 MAX_BX = 0xFFFF;
+
+std::optional<RegOp> binaryOp(TokenType op) {
+  switch (op) {
+  case TokenType::Plus:
+    return RegOp::ADD;
+  case TokenType::Minus:
+    return RegOp::SUB;
+  case TokenType::Star:
+    return RegOp::MUL;
+  case TokenType::Slash:
+    return RegOp::DIV;
+  case TokenType::Percent:
+    return RegOp::MOD;
+  case TokenType::Equal:
+    return RegOp::EQ;
+  case TokenType::NotEqual:
+    return RegOp::NE;
+  case TokenType::Less:
+    return RegOp::LT;
+  case TokenType::LessEqual:
+    return RegOp::LE;
+  case TokenType::Greater:
+    return RegOp::GT;
+  case TokenType::GreaterEqual:
+    return RegOp::GE;
+  default:
+    return std::nullopt;
+  }
+}
+
+// Same encoding as Compiler::compileShowStmt
+i32 positionCode(const std::optional<Position> &position) {
+  if (!position.has_value()) {
+    return 1;
+  }
+  switch (position.value()) {
+  case Position::Left:
+    return 0;
+  case Position::Center:
+    return 1;
+  case Position::Right:
+    return 2;
+  case Position::Custom:
+    return 3;
+  }
+  return 1;
+}
+
+u32 floatBits(f32 value) {
+  u32 bits = 0;
+  std::memcpy(&bits, &value, sizeof(f32));
+  return bits;
+}
+
+} // namespace
+
+RegisterCompiler::RegisterCompiler() = default;
+RegisterCompiler::~RegisterCompiler() = default;
+
+Result<RegisterProgram> RegisterCompiler::compile(const Program &program) {
+  reset();
+
+  try {
+    for (const auto &scene : program.scenes) {
+      compileScene(scene);
+    }
+    for (const auto &stmt : program.globalStatements) {
+      if (stmt) {
+        compileStatement(*stmt);
+      }
+    }
+    emit(encodeABC(RegOp::HALT, 0, 0, 0));
+  } catch (...) {
+    if (m_errors.empty()) {
+      error("Internal compiler error");
+    }
+  }
+
+  for (const auto &pending : m_pendingJumps) {
+    auto it = m_labels.find(pending.targetLabel);
+    if (it != m_labels.end()) {
+      m_output.code[pending.targetWord] = it->second;
+    } else {
+      error("Undefined label: " + pending.targetLabel);
+    }
+  }
+
+  if (!m_errors.empty()) {
+    return Result<RegisterProgram>::error(m_errors[0].message);
+  }
+
+  return Result<RegisterProgram>::ok(std::move(m_output));
+}
+
+const std::vector<CompileError> &RegisterCompiler::getErrors() const {
+  return m_errors;
+}
+
+void RegisterCompiler::reset() {
+  m_output = RegisterProgram{};
+  m_errors.clear();
+  m_pendingJumps.clear();
+  m_labels.clear();
+  m_variableSlots.clear();
+  m_strings.clear();
+  m_constants.clear();
+  m_nextTemp = REG_TEMP_BASE;
+}
+
+void RegisterCompiler::emit(u32 word) { m_output.code.push_back(word); }
+
+u32 RegisterCompiler::emitJump(RegOp op, u32 reg) {
+  emit(encodeABx(op, reg, 0));
+  emit(0); // Placeholder, will be patched
+  return static_cast<u32>(m_output.code.size() - 1);
+}
+
+void RegisterCompiler::patchJump(u32 targetWord) {
+  m_output.code[targetWord] = static_cast<u32>(m_output.code.size());
+}
+
+void RegisterCompiler::emitCommand(RegOp op, const std::vector<u32> &operands,
+                                   u32 a) {
+  emit(encodeABx(op, a, static_cast<u32>(operands.size())));
+  for (u32 operand : operands) {
+    emit(operand);
+  }
+}
+
+u32 RegisterCompiler::addString(std::string_view str) {
+  std::string key(str);
+  auto it = m_strings.find(key);
+  if (it != m_strings.end()) {
+    return it->second;
+  }
+  u32 index = static_cast<u32>(m_output.stringTable.size());
+  m_output.stringTable.push_back(key);
+  m_strings.emplace(std::move(key), index);
+  return index;
+}
+
+u32 RegisterCompiler::addConstant(ValueType type, u32 bits) {
+  u64 key = (static_cast<u64>(type) << 32) | bits;
+  auto it = m_constants.find(key);
+  if (it != m_constants.end()) {
+    return it->second;
+  }
+  u32 index = static_cast<u32>(m_output.constants.size());
+  m_output.constants.push_back({type, bits});
+  m_constants.emplace(key, index);
+  return index;
+}
+
+u32 RegisterCompiler::constantOperand(ValueType type, u32 bits) {
+  return REG_OPERAND_CONSTANT | addConstant(type, bits);
+}
+
+u32 RegisterCompiler::stringOperand(std::string_view str) {
+  return constantOperand(ValueType::String, addString(str));
+}
+
+u32 RegisterCompiler::floatBitsOperand(f32 value) {
+  // Durations travel as the raw f32 bits in an int, as in the stack format
+  return constantOperand(ValueType::Int, floatBits(value));
+}
+
+u32 RegisterCompiler::addVariableSlot(std::string_view name) {
+  std::string key(name);
+  auto it = m_variableSlots.find(key);
+  if (it != m_variableSlots.end()) {
+    return it->second;
+  }
+  u32 slot = static_cast<u32>(m_output.variableSlots.size());
+  m_output.variableSlots.push_back(key);
+  m_variableSlots.emplace(std::move(key), slot);
+  return slot;
+}
+
+u32 RegisterCompiler::allocTemp() {
+  if (m_nextTemp >= REG_TEMP_BASE + REG_TEMP_COUNT) {
+    error("Expression too complex: out of temporary registers");
+    return REG_TEMP_BASE;
+  }
+  return m_nextTemp++;
+}
+
+void RegisterCompiler::error(const std::string &message, SourceLocation loc) {
+  m_errors.emplace_back(message, loc);
+}
+
+void RegisterCompiler::compileScene(const SceneDecl &decl) {
+  u32 entryPoint = static_cast<u32>(m_output.code.size());
+  m_output.sceneEntryPoints[std::string(decl.name)] = entryPoint;
+  m_labels[std::string(decl.name)] = entryPoint;
+
+  for (const auto &stmt : decl.body) {
+    if (stmt) {
+      compileStatement(*stmt);
+    }
+  }
+}
+
+void RegisterCompiler::compileStatement(const Statement &stmt) {
+  // Temporaries never outlive a statement
+  const u32 tempMark = m_nextTemp;
+
+  std::visit(
+      [this](const auto &s) {
+        using T = std::decay_t<decltype(s)>;
+
+        if constexpr (std::is_same_v<T, ShowStmt>) {
+          if (s.target == ShowStmt::Target::Background) {
+            emitCommand(RegOp::SHOW_BACKGROUND,
+                        {stringOperand(s.resource.value_or(""))});
+          } else {
+            u32 expression =
+                s.resource.has_value()
+                    ? stringOperand(s.resource.value())
+                    : constantOperand(ValueType::Null, 0);
+            emitCommand(
+                RegOp::SHOW_CHARACTER,
+                {stringOperand(s.identifier),
+                 constantOperand(ValueType::Int,
+                                 static_cast<u32>(positionCode(s.position))),
+                 expression});
+          }
+          compileTransition(s.transition, s.duration);
+        } else if constexpr (std::is_same_v<T, HideStmt>) {
+          emitCommand(RegOp::HIDE_CHARACTER, {stringOperand(s.identifier)});
+          compileTransition(s.transition, s.duration);
+        } else if constexpr (std::is_same_v<T, SayStmt>) {
+          u32 speaker = s.speaker.has_value()
+                            ? stringOperand(s.speaker.value())
+                            : constantOperand(ValueType::Null, 0);
+          emitCommand(RegOp::SAY, {stringOperand(s.text), speaker});
+        } else if constexpr (std::is_same_v<T, ChoiceStmt>) {
+          compileChoice(s);
+        } else if constexpr (std::is_same_v<T, IfStmt>) {
+          compileIf(s);
+        } else if constexpr (std::is_same_v<T, GotoStmt>) {
+          emitCommand(RegOp::GOTO_SCENE, {stringOperand(s.target)});
+          emit(0);
+          m_pendingJumps.push_back(
+              {static_cast<u32>(m_output.code.size() - 1), std::string(s.target)});
+        } else if constexpr (std::is_same_v<T, WaitStmt>) {
+          emitCommand(RegOp::WAIT, {floatBitsOperand(s.duration)});
+        } else if constexpr (std::is_same_v<T, PlayStmt>) {
+          emitCommand(s.type == PlayStmt::MediaType::Sound ? RegOp::PLAY_SOUND
+                                                           : RegOp::PLAY_MUSIC,
+                      {stringOperand(s.resource)});
+        } else if constexpr (std::is_same_v<T, StopStmt>) {
+          if (s.fadeOut.has_value()) {
+            emitCommand(RegOp::STOP_MUSIC, {floatBitsOperand(s.fadeOut.value())});
+          } else {
+            emitCommand(RegOp::STOP_MUSIC, {});
+          }
+        } else if constexpr (std::is_same_v<T, SetStmt>) {
+          compileSet(s);
+        } else if constexpr (std::is_same_v<T, TransitionStmt>) {
+          emitCommand(RegOp::TRANSITION,
+                      {stringOperand(s.type), floatBitsOperand(s.duration)});
+        } else if constexpr (std::is_same_v<T, BlockStmt>) {
+          for (const auto &inner : s.statements) {
+            if (inner) {
+              compileStatement(*inner);
+            }
+          }
+        } else if constexpr (std::is_same_v<T, ExpressionStmt>) {
+          if (s.expression) {
+            compileExpression(*s.expression, std::nullopt);
+          }
+        } else if constexpr (std::is_same_v<T, SceneDecl>) {
+          compileScene(s);
+        }
+        // CharacterDecl carries no code in the register format
+      },
+      stmt.data);
+
+  m_nextTemp = tempMark;
+}
+
+void RegisterCompiler::compileTransition(
+    const std::optional<std::string_view> &transition,
+    const std::optional<f32> &duration) {
+  if (transition.has_value()) {
+    emitCommand(RegOp::TRANSITION, {stringOperand(transition.value()),
+                                    floatBitsOperand(duration.value_or(0.0f))});
+  }
+}
+
+void RegisterCompiler::compileChoice(const ChoiceStmt &stmt) {
+  std::vector<u32> operands;
+  operands.reserve(stmt.options.size() + 1);
+  operands.push_back(constantOperand(ValueType::Int,
+                                     static_cast<u32>(stmt.options.size())));
+  for (const auto &option : stmt.options) {
+    operands.push_back(stringOperand(option.text));
+  }
+
+  // The selection lands in `result`, which stays live for the jump table
+  const u32 result = allocTemp();
+  emitCommand(RegOp::CHOICE, operands, result);
+
+  std::vector<u32> endJumps;
+  const u32 test = allocTemp();
+  const u32 bodyMark = m_nextTemp;
+
+  for (usize i = 0; i < stmt.options.size(); ++i) {
+    const auto &option = stmt.options[i];
+
+    emit(encodeABx(RegOp::LOADK, test,
+                   addConstant(ValueType::Int, static_cast<u32>(i))));
+    emit(encodeABC(RegOp::EQ, test, result, test));
+    u32 skipJump = emitJump(RegOp::JMPIFNOT, test);
+
+    std::optional<u32> condJump;
+    if (option.condition && option.condition.value()) {
+      u32 cond = compileExpression(*option.condition.value(), std::nullopt);
+      condJump = emitJump(RegOp::JMPIFNOT, cond);
+      m_nextTemp = bodyMark;
+    }
+
+    if (option.gotoTarget.has_value()) {
+      u32 jump = emitJump(RegOp::JMP);
+      m_pendingJumps.push_back({jump, std::string(*option.gotoTarget)});
+    } else {
+      for (const auto &bodyStmt : option.body) {
+        if (bodyStmt) {
+          compileStatement(*bodyStmt);
+        }
+      }
+    }
+
+    if (condJump) {
+      patchJump(*condJump);
+    }
+    endJumps.push_back(emitJump(RegOp::JMP));
+    patchJump(skipJump);
+  }
+
+  for (u32 jump : endJumps) {
+    patchJump(jump);
+  }
+}
+
+void RegisterCompiler::compileIf(const IfStmt &stmt) {
+  const u32 mark = m_nextTemp;
+  u32 cond = compileExpression(*stmt.condition, std::nullopt);
+  u32 elseJump = emitJump(RegOp::JMPIFNOT, cond);
+  m_nextTemp = mark;
+
+  for (const auto &thenStmt : stmt.thenBranch) {
+    if (thenStmt) {
+      compileStatement(*thenStmt);
+    }
+  }
+
+  if (stmt.elseBranch.empty()) {
+    patchJump(elseJump);
+    return;
+  }
+
+  u32 endJump = emitJump(RegOp::JMP);
+  patchJump(elseJump);
+  for (const auto &elseStmt : stmt.elseBranch) {
+    if (elseStmt) {
+      compileStatement(*elseStmt);
+    }
+  }
+  patchJump(endJump);
+}
+
+void RegisterCompiler::compileSet(const SetStmt &stmt) {
+  u32 reg = registerForSlot(addVariableSlot(stmt.variable));
+  if (reg < REG_TEMP_BASE) {
+    compileExpression(*stmt.value, reg);
+    return;
+  }
+  if (reg > MAX_BX) {
+    error("Too many variables for the register format: " +
+          std::string(stmt.variable));
+    return;
+  }
+  u32 value = compileExpression(*stmt.value, std::nullopt);
+  emit(encodeABx(RegOp::STOREVAR, value, reg));
+}
+
+u32 RegisterCompiler::compileExpression(const Expression &expr,
+                                        std::optional<u32> dest) {
+  return std::visit(
+      [this, dest](const auto &e) -> u32 {
+        using T = std::decay_t<decltype(e)>;
+
+        auto loadConstant = [this, dest](ValueType type, u32 bits) {
+          u32 constant = addConstant(type, bits);
+          if (constant > MAX_BX) {
+            error("Too many constants for the register format");
+          }
+          u32 out = dest ? *dest : allocTemp();
+          emit(encodeABx(RegOp::LOADK, out, constant));
+          return out;
+        };
+
+        if constexpr (std::is_same_v<T, LiteralExpr>) {
+          return std::visit(
+              [&](const auto &val) -> u32 {
+                using V = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<V, i32>) {
+                  return loadConstant(ValueType::Int, static_cast<u32>(val));
+                } else if constexpr (std::is_same_v<V, f32>) {
+                  return loadConstant(ValueType::Float, floatBits(val));
+                } else if constexpr (std::is_same_v<V, bool>) {
+                  return loadConstant(ValueType::Bool, val ? 1u : 0u);
+                } else if constexpr (std::is_same_v<V, std::string_view>) {
+                  return loadConstant(ValueType::String, addString(val));
+                } else {
+                  return loadConstant(ValueType::Null, 0);
+                }
+              },
+              e.value);
+        } else if constexpr (std::is_same_v<T, IdentifierExpr>) {
+          u32 reg = registerForSlot(addVariableSlot(e.name));
+          if (reg < REG_TEMP_BASE) {
+            if (!dest) {
+              return reg;
+            }
+            if (*dest != reg) {
+              emit(encodeABC(RegOp::MOVE, *dest, reg, 0));
+            }
+            return *dest;
+          }
+          if (reg > MAX_BX) {
+            error("Too many variables for the register format: " +
+                  std::string(e.name));
+          }
+          u32 out = dest ? *dest : allocTemp();
+          emit(encodeABx(RegOp::LOADVAR, out, reg));
+          return out;
+        } else if constexpr (std::is_same_v<T, BinaryExpr>) {
+          return compileBinary(e, dest);
+        } else if constexpr (std::is_same_v<T, UnaryExpr>) {
+          const u32 mark = m_nextTemp;
+          u32 operand = e.operand ? compileExpression(*e.operand, std::nullopt)
+                                  : loadConstant(ValueType::Null, 0);
+          m_nextTemp = mark;
+          u32 out = dest ? *dest : allocTemp();
+          if (e.op == TokenType::Minus) {
+            emit(encodeABC(RegOp::NEG, out, operand, 0));
+          } else if (e.op == TokenType::Not) {
+            emit(encodeABC(RegOp::NOT, out, operand, 0));
+          } else {
+            error("Unknown unary operator");
+          }
+          return out;
+        } else if constexpr (std::is_same_v<T, CallExpr>) {
+          // Native functions are not callable from either bytecode format yet
+          return loadConstant(ValueType::Null, 0);
+        } else {
+          // PropertyExpr: evaluates to the property name, as in the stack
+          // format, until objects exist
+          return loadConstant(ValueType::String, addString(e.property));
+        }
+      },
+      expr.data);
+}
+
+u32 RegisterCompiler::compileBinary(const BinaryExpr &expr,
+                                    std::optional<u32> dest) {
+  const u32 mark = m_nextTemp;
+
+  if (expr.op == TokenType::And || expr.op == TokenType::Or) {
+    // Evaluate into a fresh temporary: writing dest early would clobber a
+    // variable that the right-hand side still reads
+    u32 tmp = allocTemp();
+    if (expr.left) {
+      compileExpression(*expr.left, tmp);
+    }
+    u32 endJump = emitJump(
+        expr.op == TokenType::And ? RegOp::JMPIFNOT : RegOp::JMPIF, tmp);
+    if (expr.right) {
+      compileExpression(*expr.right, tmp);
+    }
+    patchJump(endJump);
+    // The result is a bool, as in the stack format, not the deciding operand
+    emit(encodeABC(RegOp::NOT, tmp, tmp, 0));
+    if (dest) {
+      emit(encodeABC(RegOp::NOT, *dest, tmp, 0));
+      m_nextTemp = mark;
+      return *dest;
+    }
+    emit(encodeABC(RegOp::NOT, tmp, tmp, 0));
+    return tmp;
+  }
+
+  auto op = binaryOp(expr.op);
+  if (!op || !expr.left || !expr.right) {
+    error("Unknown binary operator");
+    return dest.value_or(REG_TEMP_BASE);
+  }
+
+  u32 lhs = compileExpression(*expr.left, std::nullopt);
+  u32 rhs = compileExpression(*expr.right, std::nullopt);
+  // Operands are read before the result is written, so the result may
+  // reuse an operand's temporary
+  m_nextTemp = mark;
+  u32 out = dest ? *dest : allocTemp();
+  emit(encodeABC(*op, out, lhs, rhs));
+  return out;
+}
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,473 @@
+#include "NovelMind/scripting/register_vm.hpp"
+#include "NovelMind/core/logger.hpp"
+#include <cstring>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+bool isKnownOp(RegOp op) {
+  switch (op) {
+  case RegOp::NOP:
+  case RegOp::HALT:
+  case RegOp::MOVE:
+  case RegOp::LOADK:
+  case RegOp::LOADVAR:
+  case RegOp::STOREVAR:
+  case RegOp::ADD:
+  case RegOp::SUB:
+  case RegOp::MUL:
+  case RegOp::DIV:
+  case RegOp::MOD:
+  case RegOp::EQ:
+  case RegOp::NE:
+  case RegOp::LT:
+  case RegOp::LE:
+  case RegOp::GT:
+  case RegOp::GE:
+  case RegOp::NOT:
+  case RegOp::NEG:
+  case RegOp::JMP:
+  case RegOp::JMPIF:
+  case RegOp::JMPIFNOT:
+    return true;
+  default:
+    return isCommand(op);
+  }
+}
+
+} // namespace
+
+RegisterVM::RegisterVM()
+    : m_ip(0), m_choiceRegister(0), m_running(false), m_paused(false),
+      m_waiting(false), m_halted(false) {}
+
+RegisterVM::~RegisterVM() = default;
+
+Result<void> RegisterVM::load(const RegisterProgram &program) {
+  if (program.code.empty()) {
+    return Result<void>::error("Empty program");
+  }
+
+  m_code = program.code;
+  m_strings.clear();
+
+  m_constants.clear();
+  m_constants.reserve(program.constants.size());
+  for (const auto &constant : program.constants) {
+    switch (constant.type) {
+    case ValueType::Int:
+      m_constants.push_back(VMValue::fromInt(static_cast<i32>(constant.bits)));
+      break;
+    case ValueType::Float: {
+      f32 value;
+      std::memcpy(&value, &constant.bits, sizeof(f32));
+      m_constants.push_back(VMValue::fromFloat(value));
+      break;
+    }
+    case ValueType::Bool:
+      m_constants.push_back(VMValue::fromBool(constant.bits != 0));
+      break;
+    case ValueType::String:
+      if (constant.bits >= program.stringTable.size()) {
+        return Result<void>::error("Invalid string constant: " +
+                                   std::to_string(constant.bits));
+      }
+      m_constants.push_back(VMValue::fromString(
+          m_strings.intern(program.stringTable[constant.bits])));
+      break;
+    default:
+      m_constants.push_back(VMValue::null());
+      break;
+    }
+  }
+
+  m_strings.pin();
+
+  m_variableNames = program.variableSlots;
+  m_variableSlots.clear();
+  for (u32 slot = 0; slot < m_variableNames.size(); ++slot) {
+    m_variableSlots.emplace(m_variableNames[slot], slot);
+  }
+  m_registers.assign(REG_OVERFLOW_BASE, VMValue::null());
+  if (m_variableNames.size() > REG_PINNED_VARIABLES) {
+    m_registers.resize(registerForSlot(
+        static_cast<u32>(m_variableNames.size() - 1)) + 1);
+  }
+
+  auto valid = validate();
+  if (valid.isError()) {
+    m_code.clear();
+    return valid;
+  }
+
+  reset();
+  return Result<void>::ok();
+}
+
+Result<void> RegisterVM::validate() const {
+  const usize size = m_code.size();
+  std::vector<bool> boundary(size + 1, false);
+
+  for (usize ip = 0; ip < size;) {
+    boundary[ip] = true;
+    RegOp op = decodeOp(m_code[ip]);
+    if (!isKnownOp(op)) {
+      return Result<void>::error("Unknown register opcode at " +
+                                 std::to_string(ip));
+    }
+    usize words = instructionWords(m_code[ip]);
+    if (ip + words > size) {
+      return Result<void>::error("Truncated instruction at " +
+                                 std::to_string(ip));
+    }
+    ip += words;
+  }
+  boundary[size] = true;
+
+  auto checkOperand = [this](u32 word) {
+    if (word & REG_OPERAND_CONSTANT) {
+      return (word & ~REG_OPERAND_CONSTANT) < m_constants.size();
+    }
+    return word < m_registers.size();
+  };
+
+  for (usize ip = 0; ip < size; ip += instructionWords(m_code[ip])) {
+    const u32 word = m_code[ip];
+    const RegOp op = decodeOp(word);
+    const std::string where = " at " + std::to_string(ip);
+
+    switch (op) {
+    case RegOp::LOADK:
+      if (decodeBx(word) >= m_constants.size()) {
+        return Result<void>::error("Invalid constant index" + where);
+      }
+      break;
+    case RegOp::LOADVAR:
+    case RegOp::STOREVAR:
+      if (decodeBx(word) >= m_registers.size()) {
+        return Result<void>::error("Invalid variable register" + where);
+      }
+      break;
+    case RegOp::JMP:
+    case RegOp::JMPIF:
+    case RegOp::JMPIFNOT:
+      if (m_code[ip + 1] > size || !boundary[m_code[ip + 1]]) {
+        return Result<void>::error("Invalid jump target" + where);
+      }
+      break;
+    default:
+      if (!isCommand(op)) {
+        break;
+      }
+      for (u32 i = 1; i <= decodeBx(word); ++i) {
+        if (!checkOperand(m_code[ip + i])) {
+          return Result<void>::error("Invalid command operand" + where);
+        }
+      }
+      if (op == RegOp::GOTO_SCENE) {
+        u32 target = m_code[ip + 1 + decodeBx(word)];
+        if (target > size || !boundary[target]) {
+          return Result<void>::error("Invalid jump target" + where);
+        }
+      }
+      break;
+    }
+  }
+
+  return Result<void>::ok();
+}
+
+void RegisterVM::reset() {
+  m_ip = 0;
+  m_running = false;
+  m_paused = false;
+  m_waiting = false;
+  m_halted = false;
+}
+
+bool RegisterVM::step() {
+  if (m_halted || m_paused || m_waiting) {
+    return false;
+  }
+  execute(true);
+  return !m_halted;
+}
+
+void RegisterVM::run() {
+  m_running = true;
+  m_paused = false;
+
+  if (!m_halted && !m_waiting) {
+    execute(false);
+  }
+}
+
+void RegisterVM::pause() { m_paused = true; }
+
+void RegisterVM::resume() {
+  m_paused = false;
+  if (m_running && !m_waiting) {
+    run();
+  }
+}
+
+bool RegisterVM::isRunning() const { return m_running; }
+
+bool RegisterVM::isPaused() const { return m_paused; }
+
+bool RegisterVM::isWaiting() const { return m_waiting; }
+
+bool RegisterVM::isHalted() const { return m_halted; }
+
+void RegisterVM::setVariable(const std::string &name, Value value) {
+  u32 slot = resolveVariableSlot(name);
+  m_registers[registerForSlot(slot)] = fromValue(value, m_strings);
+}
+
+Value RegisterVM::getVariable(const std::string &name) const {
+  auto it = m_variableSlots.find(name);
+  if (it != m_variableSlots.end()) {
+    return toValue(m_registers[registerForSlot(it->second)], m_strings);
+  }
+  return std::monostate{};
+}
+
+bool RegisterVM::hasVariable(const std::string &name) const {
+  auto it = m_variableSlots.find(name);
+  return it != m_variableSlots.end() &&
+         !m_registers[registerForSlot(it->second)].isNull();
+}
+
+std::unordered_map<std::string, Value> RegisterVM::getVariables() const {
+  std::unordered_map<std::string, Value> variables;
+  for (u32 slot = 0; slot < m_variableNames.size(); ++slot) {
+    const VMValue &value = m_registers[registerForSlot(slot)];
+    if (!value.isNull()) {
+      variables[m_variableNames[slot]] = toValue(value, m_strings);
+    }
+  }
+  return variables;
+}
+
+void RegisterVM::setFlag(const std::string &name, bool value) {
+  m_flags[name] = value;
+}
+
+bool RegisterVM::getFlag(const std::string &name) const {
+  auto it = m_flags.find(name);
+  if (it != m_flags.end()) {
+    return it->second;
+  }
+  return false;
+}
+
+void RegisterVM::registerCallback(OpCode op, NativeCallback callback) {
+  if (!m_callbacks.set(op, std::move(callback))) {
+    NOVELMIND_LOG_WARN("Callback registered for a non-command opcode");
+  }
+}
+
+void RegisterVM::signalContinue() {
+  m_waiting = false;
+  if (m_running && !m_paused) {
+    run();
+  }
+}
+
+void RegisterVM::signalChoice(i32 choice) {
+  if (m_choiceRegister < m_registers.size()) {
+    m_registers[m_choiceRegister] = VMValue::fromInt(choice);
+  }
+  m_waiting = false;
+  if (m_running && !m_paused) {
+    run();
+  }
+}
+
+u32 RegisterVM::resolveVariableSlot(const std::string &name) {
+  auto it = m_variableSlots.find(name);
+  if (it != m_variableSlots.end()) {
+    return it->second;
+  }
+
+  // Variables set by the host before the script mentions them
+  u32 slot = static_cast<u32>(m_variableNames.size());
+  m_variableNames.push_back(name);
+  m_variableSlots.emplace(name, slot);
+  if (m_registers.size() < REG_OVERFLOW_BASE) {
+    m_registers.resize(REG_OVERFLOW_BASE);
+  }
+  if (registerForSlot(slot) >= m_registers.size()) {
+    m_registers.resize(registerForSlot(slot) + 1);
+  }
+  return slot;
+}
+
+const VMValue &RegisterVM::operand(u32 word) const {
+  return (word & REG_OPERAND_CONSTANT)
+             ? m_constants[word & ~REG_OPERAND_CONSTANT]
+             : m_registers[word];
+}
+
+void RegisterVM::invokeCommand(RegOp op, u32 header, u32 ip) {
+  const u32 argc = decodeBx(header);
+
+  // Resume after the command, or at the scene for GOTO_SCENE, so callbacks
+  // observe the same IP as step() callers would
+  m_ip = op == RegOp::GOTO_SCENE ? m_code[ip + 1 + argc]
+                                 : ip + instructionWords(header);
+
+  if (op == RegOp::CHOICE) {
+    m_choiceRegister = decodeA(header);
+    m_registers[m_choiceRegister] = VMValue::fromInt(-1);
+  }
+
+  if (const NativeCallback *callback = m_callbacks.find(commandOpCode(op))) {
+    if (m_callbackArgs.size() < argc) {
+      m_callbackArgs.resize(argc);
+    }
+    for (u32 i = 0; i < argc; ++i) {
+      assignValue(m_callbackArgs[i], operand(m_code[ip + 1 + i]), m_strings);
+    }
+    (*callback)(NativeArgs(m_callbackArgs.data(), argc));
+  }
+
+  // These commands typically wait for user input
+  if (op == RegOp::SAY || op == RegOp::CHOICE || op == RegOp::WAIT) {
+    m_waiting = true;
+  }
+}
+
+void RegisterVM::execute(bool singleStep) {
+  const u32 *code = m_code.data();
+  const u32 size = static_cast<u32>(m_code.size());
+  const VMValue *k = m_constants.data();
+  VMValue *r = m_registers.data();
+  u32 ip = m_ip;
+
+  while (ip < size) {
+    const u32 word = code[ip];
+    const RegOp op = decodeOp(word);
+
+    switch (op) {
+    case RegOp::NOP:
+      ++ip;
+      break;
+
+    case RegOp::HALT:
+      m_ip = ip + 1;
+      m_halted = true;
+      return;
+
+    case RegOp::MOVE:
+      r[decodeA(word)] = r[decodeB(word)];
+      ++ip;
+      break;
+
+    case RegOp::LOADK:
+      r[decodeA(word)] = k[decodeBx(word)];
+      ++ip;
+      break;
+
+    case RegOp::LOADVAR:
+      r[decodeA(word)] = r[decodeBx(word)];
+      ++ip;
+      break;
+
+    case RegOp::STOREVAR:
+      r[decodeBx(word)] = r[decodeA(word)];
+      ++ip;
+      break;
+
+    case RegOp::ADD:
+      r[decodeA(word)] =
+          addValues(r[decodeB(word)], r[decodeC(word)], m_strings);
+      // Registers hold every run-time string; constants are pinned
+      if (m_strings.shouldCollect()) {
+        m_strings.collect({m_registers});
+      }
+      ++ip;
+      break;
+
+    case RegOp::SUB:
+      r[decodeA(word)] = subValues(r[decodeB(word)], r[decodeC(word)]);
+      ++ip;
+      break;
+
+    case RegOp::MUL:
+      r[decodeA(word)] = mulValues(r[decodeB(word)], r[decodeC(word)]);
+      ++ip;
+      break;
+
+    case RegOp::DIV:
+      r[decodeA(word)] = divValues(r[decodeB(word)], r[decodeC(word)]);
+      ++ip;
+      break;
+
+    case RegOp::MOD:
+      r[decodeA(word)] = modValues(r[decodeB(word)], r[decodeC(word)]);
+      ++ip;
+      break;
+
+    case RegOp::EQ:
+    case RegOp::NE:
+    case RegOp::LT:
+    case RegOp::LE:
+    case RegOp::GT:
+    case RegOp::GE: {
+      // RegOp::EQ..GE follow CompareOp order
+      auto cmp = static_cast<CompareOp>(static_cast<u8>(op) -
+                                        static_cast<u8>(RegOp::EQ));
+      r[decodeA(word)] = VMValue::fromBool(
+          compareValues(cmp, r[decodeB(word)], r[decodeC(word)], m_strings));
+      ++ip;
+      break;
+    }
+
+    case RegOp::NOT:
+      r[decodeA(word)] = VMValue::fromBool(!r[decodeB(word)].asBool(m_strings));
+      ++ip;
+      break;
+
+    case RegOp::NEG:
+      r[decodeA(word)] = negateValue(r[decodeB(word)]);
+      ++ip;
+      break;
+
+    case RegOp::JMP:
+      ip = code[ip + 1];
+      break;
+
+    case RegOp::JMPIF:
+      ip = r[decodeA(word)].asBool(m_strings) ? code[ip + 1] : ip + 2;
+      break;
+
+    case RegOp::JMPIFNOT:
+      ip = r[decodeA(word)].asBool(m_strings) ? ip + 2 : code[ip + 1];
+      break;
+
+    default:
+      // load() guarantees everything else is a command
+      invokeCommand(op, word, ip);
+      // Callbacks may add variables (reallocating registers) or stop the VM
+      r = m_registers.data();
+      ip = m_ip;
+      if (m_halted || m_paused || m_waiting) {
+        return;
+      }
+      break;
+    }
+
+    if (singleStep) {
+      break;
+    }
+  }
+
+  m_ip = ip;
+  if (ip >= size) {
+    m_halted = true;
+  }
+}
+
+} // namespace NovelMind::scripting
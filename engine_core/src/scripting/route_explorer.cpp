@@ -0,0 +1,409 @@
+#include "NovelMind/scripting/route_explorer.hpp"
+#include "NovelMind/core/logger.hpp"
+#include "NovelMind/core/thread_pool.hpp"
+#include "NovelMind/core/timer.hpp"
+#include "NovelMind/scripting/script_runtime.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+// Waits and transitions complete in a single update of this length
+constexpr f64 SKIP_SECONDS = 1.0e6;
+
+u64 mix(u64 x) {
+  // splitmix64 finalizer
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+u64 combine(u64 seed, u64 value) {
+  return mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) +
+                     (seed >> 2)));
+}
+
+u64 hashString(const std::string &str) { return std::hash<std::string>{}(str); }
+
+u64 hashValue(const Value &value) {
+  u64 payload = std::visit(
+      [](const auto &v) -> u64 {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+          return 0;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+          return hashString(v);
+        } else if constexpr (std::is_same_v<T, f32>) {
+          u32 bits = 0;
+          std::memcpy(&bits, &v, sizeof(f32));
+          return bits;
+        } else {
+          return static_cast<u64>(static_cast<u32>(v));
+        }
+      },
+      value);
+  return combine(value.index(), payload);
+}
+
+// Identity of a choice point: (scene, IP, stack, variables, flags)
+u64 hashState(const RuntimeSaveState &state) {
+  u64 hash = combine(hashString(state.currentScene), state.instructionPointer);
+  for (const auto &value : state.stack) {
+    hash = combine(hash, hashValue(value));
+  }
+
+  // Maps iterate in no particular order, so sum the per-entry hashes
+  u64 variables = 0;
+  for (const auto &[name, value] : state.variables) {
+    variables += combine(hashString(name), hashValue(value));
+  }
+  // An unset flag reads as false, so only set flags are part of the state
+  u64 flags = 0;
+  for (const auto &[name, set] : state.flags) {
+    if (set) {
+      flags += mix(hashString(name));
+    }
+  }
+
+  return combine(combine(hash, variables), flags);
+}
+
+using Snapshot = std::shared_ptr<const RuntimeSaveState>;
+
+// The fields hashState() covers, compared exactly
+bool sameState(const RuntimeSaveState &a, const RuntimeSaveState &b) {
+  if (a.instructionPointer != b.instructionPointer ||
+      a.currentScene != b.currentScene || a.stack != b.stack ||
+      a.variables != b.variables) {
+    return false;
+  }
+
+  usize setFlags = 0;
+  for (const auto &[name, set] : a.flags) {
+    if (set) {
+      auto it = b.flags.find(name);
+      if (it == b.flags.end() || !it->second) {
+        return false;
+      }
+      ++setFlags;
+    }
+  }
+  return setFlags == static_cast<usize>(std::count_if(
+                         b.flags.begin(), b.flags.end(),
+                         [](const auto &flag) { return flag.second; }));
+}
+
+/**
+ * @brief Concurrent set of explored states, sharded to keep lock contention
+ *        low
+ *
+ * States are found by hash but compared in full, so two states whose
+ * hashes collide are both explored.
+ */
+class SeenStates {
+public:
+  bool insert(u64 hash, const Snapshot &state) {
+    Shard &shard = m_shards[hash % SHARD_COUNT];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto &bucket = shard.states[hash];
+    for (const auto &seen : bucket) {
+      if (sameState(*seen, *state)) {
+        return false;
+      }
+    }
+    bucket.push_back(state);
+    return true;
+  }
+
+private:
+  static constexpr usize SHARD_COUNT = 64;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<u64, std::vector<Snapshot>> states;
+  };
+
+  std::array<Shard, SHARD_COUNT> m_shards;
+};
+
+/**
+ * @brief State of one explore() call, shared by its tasks
+ *
+ * Coverage is gathered per worker and merged at the end, so workers only
+ * synchronize on the seen-state set and the pool's deques.
+ */
+class Exploration {
+public:
+  Exploration(const CompiledScript &script, VMProgramPtr program,
+              const RouteExplorerConfig &config, core::ThreadPool &pool)
+      : m_script(script), m_program(std::move(program)), m_config(config),
+        m_pool(pool), m_workers(pool.getThreadCount()) {}
+
+  void submit(Snapshot from, i32 choice) {
+    m_pool.submit([this, from = std::move(from), choice] {
+      runRoute(from, choice);
+    });
+  }
+
+  void collect(RouteCoverage &coverage) const {
+    coverage.reachedInstructions.assign(m_script.instructions.size(), false);
+    std::unordered_map<u32, u64> choicesReached;
+    for (const auto &worker : m_workers) {
+      for (usize i = 0; i < worker.reached.size(); ++i) {
+        if (worker.reached[i]) {
+          coverage.reachedInstructions[i] = true;
+        }
+      }
+      for (const auto &[ip, count] : worker.choicesReached) {
+        choicesReached[ip] += count;
+      }
+      coverage.uniqueStates += worker.uniqueStates;
+      coverage.duplicateStates += worker.duplicateStates;
+      coverage.endings += worker.endings;
+      coverage.truncatedRoutes += worker.truncatedRoutes;
+    }
+    coverage.complete = !m_stateLimitHit.load();
+
+    // Scene owning each instruction: the nearest entry point at or before it
+    std::vector<std::pair<u32, std::string>> entries;
+    for (const auto &[name, entry] : m_script.sceneEntryPoints) {
+      entries.emplace_back(entry, name);
+      bool reached = entry < coverage.reachedInstructions.size() &&
+                     coverage.reachedInstructions[entry];
+      (reached ? coverage.reachedScenes : coverage.unreachedScenes)
+          .push_back(name);
+    }
+    std::sort(entries.begin(), entries.end());
+    std::sort(coverage.reachedScenes.begin(), coverage.reachedScenes.end());
+    std::sort(coverage.unreachedScenes.begin(),
+              coverage.unreachedScenes.end());
+
+    const auto &code = m_script.instructions;
+    for (u32 ip = 0; ip < code.size(); ++ip) {
+      if (code[ip].opcode != OpCode::CHOICE) {
+        continue;
+      }
+
+      ChoiceCoverage choice;
+      choice.instruction = ip;
+      choice.reached = coverage.reachedInstructions[ip];
+      auto count = choicesReached.find(ip);
+      choice.timesReached = count != choicesReached.end() ? count->second : 0;
+
+      auto owner = std::upper_bound(
+          entries.begin(), entries.end(), ip,
+          [](u32 value, const auto &entry) { return value < entry.first; });
+      if (owner != entries.begin()) {
+        choice.scene = std::prev(owner)->second;
+      }
+
+      // The compiler pushes the option texts right before the CHOICE
+      const u32 optionCount = code[ip].operand;
+      if (optionCount <= ip) {
+        for (u32 i = ip - optionCount; i < ip; ++i) {
+          if (code[i].opcode == OpCode::PUSH_STRING &&
+              code[i].operand < m_script.stringTable.size()) {
+            choice.options.push_back(m_script.stringTable[code[i].operand]);
+          }
+        }
+      }
+
+      coverage.choices.push_back(std::move(choice));
+    }
+  }
+
+private:
+  struct Worker {
+    std::unique_ptr<ScriptRuntime> runtime;
+    std::vector<u8> reached;
+    std::unordered_map<u32, u64> choicesReached;
+    u64 uniqueStates = 0;
+    u64 duplicateStates = 0;
+    u64 endings = 0;
+    u64 truncatedRoutes = 0;
+  };
+
+  Worker *currentWorker() {
+    usize index = m_pool.getCurrentWorker();
+    if (index == core::ThreadPool::NOT_A_WORKER) {
+      return nullptr;
+    }
+
+    Worker &worker = m_workers[index];
+    if (!worker.runtime) {
+      // No scene, audio or dialogue systems: the runtime runs headless.
+      // Every worker runs the one program linked by explore().
+      auto runtime = std::make_unique<ScriptRuntime>();
+      if (runtime->load(m_script, m_program).isError()) {
+        return nullptr;
+      }
+      worker.runtime = std::move(runtime);
+      worker.reached.assign(m_script.instructions.size(), 0);
+    }
+    return &worker;
+  }
+
+  void runRoute(const Snapshot &from, i32 choice) {
+    Worker *worker = currentWorker();
+    if (!worker) {
+      NOVELMIND_LOG_ERROR("Route explorer task ran outside its pool");
+      return;
+    }
+
+    ScriptRuntime &runtime = *worker->runtime;
+    if (!from) {
+      if (m_config.startScene.empty()) {
+        runtime.start();
+      } else if (runtime.gotoScene(m_config.startScene).isError()) {
+        return;
+      }
+    } else {
+      if (runtime.restoreSnapshot(*from).isError()) {
+        return;
+      }
+      runtime.selectChoice(choice);
+    }
+
+    const VirtualMachine &vm = runtime.getVM();
+    u64 steps = 0;
+    while (true) {
+      switch (runtime.getState()) {
+      case RuntimeState::Running: {
+        if (++steps > m_config.maxStepsPerBranch) {
+          ++worker->truncatedRoutes;
+          return;
+        }
+        // Stepped execution runs one instruction per update
+        u32 ip = vm.getIP();
+        if (ip < worker->reached.size()) {
+          worker->reached[ip] = 1;
+        }
+        runtime.update(0.0);
+        break;
+      }
+      case RuntimeState::WaitingInput:
+        runtime.continueExecution();
+        break;
+      case RuntimeState::WaitingTimer:
+      case RuntimeState::WaitingTransition:
+      case RuntimeState::WaitingAnimation:
+        runtime.update(SKIP_SECONDS);
+        break;
+      case RuntimeState::Paused:
+        runtime.resume();
+        break;
+      case RuntimeState::WaitingChoice:
+        fork(*worker, runtime.saveState());
+        return;
+      case RuntimeState::Idle:
+      case RuntimeState::Halted:
+        ++worker->endings;
+        return;
+      }
+    }
+  }
+
+  void fork(Worker &worker, RuntimeSaveState state) {
+    if (state.pendingChoices.empty()) {
+      ++worker.endings; // A choice without options ends the route
+      return;
+    }
+    const u64 hash = hashState(state);
+    Snapshot snapshot =
+        std::make_shared<const RuntimeSaveState>(std::move(state));
+    if (!m_seen.insert(hash, snapshot)) {
+      ++worker.duplicateStates;
+      return;
+    }
+    if (m_forked.fetch_add(1, std::memory_order_relaxed) >=
+        m_config.maxStates) {
+      m_stateLimitHit.store(true, std::memory_order_relaxed);
+      return;
+    }
+
+    ++worker.uniqueStates;
+    // The saved IP is just past the CHOICE
+    ++worker.choicesReached[snapshot->instructionPointer - 1];
+
+    const i32 optionCount =
+        static_cast<i32>(snapshot->pendingChoices.size());
+    for (i32 option = 0; option < optionCount; ++option) {
+      submit(snapshot, option);
+    }
+  }
+
+  const CompiledScript &m_script;
+  VMProgramPtr m_program;
+  const RouteExplorerConfig &m_config;
+  core::ThreadPool &m_pool;
+  std::vector<Worker> m_workers;
+  SeenStates m_seen;
+  std::atomic<u64> m_forked{0};
+  std::atomic<bool> m_stateLimitHit{false};
+};
+
+} // namespace
+
+usize RouteCoverage::getReachedInstructionCount() const {
+  return static_cast<usize>(std::count(reachedInstructions.begin(),
+                                       reachedInstructions.end(), true));
+}
+
+std::vector<const ChoiceCoverage *> RouteCoverage::getDeadChoices() const {
+  std::vector<const ChoiceCoverage *> dead;
+  for (const auto &choice : choices) {
+    if (!choice.reached) {
+      dead.push_back(&choice);
+    }
+  }
+  return dead;
+}
+
+RouteExplorer::RouteExplorer(RouteExplorerConfig config)
+    : m_config(config) {}
+
+Result<RouteCoverage> RouteExplorer::explore(const CompiledScript &script) {
+  // Link once, surfacing errors here rather than from inside a worker
+  if (!m_config.startScene.empty() &&
+      script.sceneEntryPoints.find(m_config.startScene) ==
+          script.sceneEntryPoints.end()) {
+    return Result<RouteCoverage>::error("Scene not found: " +
+                                        m_config.startScene);
+  }
+  auto program = VMProgram::create(script.instructions, script.stringTable,
+                                   script.variableSlots);
+  if (program.isError()) {
+    return Result<RouteCoverage>::error(program.error());
+  }
+
+  core::Timer timer;
+  RouteCoverage coverage;
+  {
+    core::ThreadPool pool(m_config.threadCount);
+    Exploration exploration(script, std::move(program.value()), m_config,
+                            pool);
+    exploration.submit(nullptr, -1);
+    pool.wait();
+    exploration.collect(coverage);
+  }
+
+  coverage.seconds = timer.getElapsedSeconds();
+  const u64 visited =
+      coverage.uniqueStates + coverage.duplicateStates + coverage.endings;
+  coverage.statesPerSecond =
+      coverage.seconds > 0.0 ? static_cast<f64>(visited) / coverage.seconds
+                             : 0.0;
+
+  return Result<RouteCoverage>::ok(std::move(coverage));
+}
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,221 @@
+#include "NovelMind/scripting/script_fiber.hpp"
+#include "NovelMind/core/logger.hpp"
+#include "NovelMind/scripting/vm.hpp"
+#include <algorithm>
+
+namespace NovelMind::scripting {
+
+// ScriptFiber
+
+ScriptFiber ScriptFiber::promise_type::get_return_object() {
+  return ScriptFiber(Handle::from_promise(*this));
+}
+
+void ScriptFiber::promise_type::unhandled_exception() noexcept {
+  // The fiber ends at its final suspend point; the scheduler drops it
+  NOVELMIND_LOG_ERROR("Unhandled exception in script fiber");
+}
+
+ScriptFiber::ScriptFiber(ScriptFiber &&other) noexcept
+    : m_handle(other.m_handle) {
+  other.m_handle = nullptr;
+}
+
+ScriptFiber &ScriptFiber::operator=(ScriptFiber &&other) noexcept {
+  if (this != &other) {
+    if (m_handle) {
+      m_handle.destroy();
+    }
+    m_handle = other.m_handle;
+    other.m_handle = nullptr;
+  }
+  return *this;
+}
+
+ScriptFiber::~ScriptFiber() {
+  if (m_handle) {
+    m_handle.destroy();
+  }
+}
+
+void ScriptFiber::resume() {
+  if (!done()) {
+    m_handle.promise().signaled = false;
+    m_handle.resume();
+  }
+}
+
+// FiberScheduler
+
+FiberScheduler::FiberScheduler() = default;
+FiberScheduler::~FiberScheduler() = default;
+
+FiberId FiberScheduler::spawn(ScriptFiber fiber) {
+  if (!fiber.valid() || fiber.done()) {
+    return INVALID_FIBER_ID;
+  }
+  FiberId id = m_nextId++;
+  if (m_nextId == INVALID_FIBER_ID) {
+    ++m_nextId;
+  }
+  m_fibers.push_back({id, std::move(fiber), false});
+  return id;
+}
+
+void FiberScheduler::update(f64 deltaTime) {
+  m_updating = true;
+
+  // Index loop: resumed fibers may spawn, which reallocates m_fibers
+  const usize count = m_fibers.size();
+  for (usize i = 0; i < count; ++i) {
+    if (m_fibers[i].cancelled || m_fibers[i].fiber.done()) {
+      continue;
+    }
+
+    auto &promise = m_fibers[i].fiber.promise();
+    bool ready = false;
+    switch (promise.wait) {
+    case FiberWait::Start:
+    case FiberWait::NextFrame:
+      ready = true;
+      break;
+    case FiberWait::Input:
+    case FiberWait::Choice:
+      ready = promise.signaled;
+      break;
+    case FiberWait::Timer:
+      promise.timer -= deltaTime;
+      ready = promise.timer <= 0.0;
+      break;
+    }
+
+    if (ready) {
+      m_fibers[i].fiber.resume();
+    }
+  }
+
+  m_updating = false;
+  collect();
+}
+
+bool FiberScheduler::signalInput(FiberId id) {
+  Entry *entry = find(id);
+  if (!entry || entry->fiber.promise().wait != FiberWait::Input) {
+    return false;
+  }
+  entry->fiber.promise().signaled = true;
+  return true;
+}
+
+bool FiberScheduler::signalChoice(FiberId id, i32 choice) {
+  Entry *entry = find(id);
+  if (!entry || entry->fiber.promise().wait != FiberWait::Choice) {
+    return false;
+  }
+  entry->fiber.promise().choice = choice;
+  entry->fiber.promise().signaled = true;
+  return true;
+}
+
+bool FiberScheduler::cancel(FiberId id) {
+  Entry *entry = find(id);
+  if (!entry) {
+    return false;
+  }
+  // A running fiber may cancel itself; its frame is destroyed after it
+  // suspends
+  entry->cancelled = true;
+  if (!m_updating) {
+    collect();
+  }
+  return true;
+}
+
+void FiberScheduler::clear() {
+  if (m_updating) {
+    for (auto &entry : m_fibers) {
+      entry.cancelled = true;
+    }
+    return;
+  }
+  m_fibers.clear();
+}
+
+bool FiberScheduler::isAlive(FiberId id) const { return find(id) != nullptr; }
+
+FiberWait FiberScheduler::getWait(FiberId id) const {
+  const Entry *entry = find(id);
+  return entry ? entry->fiber.promise().wait : FiberWait::Start;
+}
+
+usize FiberScheduler::size() const {
+  return static_cast<usize>(
+      std::count_if(m_fibers.begin(), m_fibers.end(), [](const Entry &entry) {
+        return !entry.cancelled && !entry.fiber.done();
+      }));
+}
+
+FiberScheduler::Entry *FiberScheduler::find(FiberId id) {
+  for (auto &entry : m_fibers) {
+    if (entry.id == id) {
+      return entry.cancelled || entry.fiber.done() ? nullptr : &entry;
+    }
+  }
+  return nullptr;
+}
+
+const FiberScheduler::Entry *FiberScheduler::find(FiberId id) const {
+  for (const auto &entry : m_fibers) {
+    if (entry.id == id) {
+      return entry.cancelled || entry.fiber.done() ? nullptr : &entry;
+    }
+  }
+  return nullptr;
+}
+
+void FiberScheduler::collect() {
+  m_fibers.erase(std::remove_if(m_fibers.begin(), m_fibers.end(),
+                                [](const Entry &entry) {
+                                  return entry.cancelled ||
+                                         entry.fiber.done();
+                                }),
+                 m_fibers.end());
+}
+
+// VM driver
+
+ScriptFiber runVirtualMachine(VirtualMachine &vm) {
+  while (true) {
+    // run() would clear a host pause, so wait it out first
+    while (vm.isPaused()) {
+      co_await NextFrame{};
+    }
+
+    vm.run();
+    if (vm.isHalted()) {
+      co_return;
+    }
+
+    switch (vm.getWaitReason()) {
+    case OpCode::CHOICE: {
+      i32 choice = co_await WaitForChoice{};
+      vm.completeChoice(choice);
+      break;
+    }
+    case OpCode::WAIT:
+      co_await WaitForSeconds{vm.getWaitDuration()};
+      vm.completeWait();
+      break;
+    case OpCode::SAY:
+      co_await WaitForInput{};
+      vm.completeWait();
+      break;
+    default:
+      // Paused or reset from a callback
+      co_await NextFrame{};
+      break;
+    }
+  }
+}
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,526 @@
+#include "NovelMind/scripting/script_image.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+
+namespace NovelMind::scripting {
+
+static_assert(sizeof(Instruction) == 8 && offsetof(Instruction, operand) == 4,
+              "Script images store instructions in their in-memory layout");
+
+namespace {
+
+constexpr u32 SCRIPT_MAGIC = 0x43534D4E; // "NMSC"
+constexpr usize HEADER_SIZE = 64;
+constexpr usize STRING_REF_SIZE = 8;  // offset, length
+constexpr usize SCENE_SIZE = 16;      // name ref, entry, end
+constexpr usize CHARACTER_SIZE = 32;  // id, name, color, sprite refs
+constexpr usize LINE_SIZE = 12;       // instruction, line, column
+constexpr u32 NO_STRING = 0xFFFFFFFFu; // Length of an absent string
+
+// Header field offsets
+constexpr usize H_VERSION = 4;
+constexpr usize H_CODE_COUNT = 8;
+constexpr usize H_STRING_COUNT = 12;
+constexpr usize H_SLOT_COUNT = 16;
+constexpr usize H_SCENE_COUNT = 20;
+constexpr usize H_CHARACTER_COUNT = 24;
+constexpr usize H_LINE_COUNT = 28;
+constexpr usize H_CODE = 32;
+constexpr usize H_STRINGS = 36;
+constexpr usize H_SLOTS = 40;
+constexpr usize H_SCENES = 44;
+constexpr usize H_CHARACTERS = 48;
+constexpr usize H_LINES = 52;
+constexpr usize H_STRING_DATA = 56;
+constexpr usize H_STRING_DATA_SIZE = 60;
+
+u32 readU32(const u8 *p) {
+  u32 value;
+  std::memcpy(&value, p, sizeof(u32));
+  return value;
+}
+
+void putU32(std::vector<u8> &out, usize offset, u32 value) {
+  std::memcpy(out.data() + offset, &value, sizeof(u32));
+}
+
+void appendU32(std::vector<u8> &out, u32 value) {
+  const usize offset = out.size();
+  out.resize(offset + sizeof(u32));
+  putU32(out, offset, value);
+}
+
+void alignTo(std::vector<u8> &out, usize alignment) {
+  out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+// Deduplicated string data section
+class StringData {
+public:
+  // Returns the {offset, length} pair of a string ref
+  std::pair<u32, u32> add(const std::string &str) {
+    auto [it, inserted] =
+        m_offsets.try_emplace(str, static_cast<u32>(m_data.size()));
+    if (inserted) {
+      m_data.insert(m_data.end(), str.begin(), str.end());
+      m_data.push_back(0);
+    }
+    return {it->second, static_cast<u32>(str.size())};
+  }
+
+  [[nodiscard]] const std::vector<u8> &data() const { return m_data; }
+
+private:
+  std::vector<u8> m_data;
+  std::unordered_map<std::string, u32> m_offsets;
+};
+
+void appendRef(std::vector<u8> &out, std::pair<u32, u32> ref) {
+  appendU32(out, ref.first);
+  appendU32(out, ref.second);
+}
+
+bool fits(usize offset, usize count, usize elementSize, usize size) {
+  return offset <= size && count <= (size - offset) / elementSize;
+}
+
+} // namespace
+
+std::vector<u8> serializeScriptImage(const CompiledScript &script) {
+  // Link name-addressed variable accesses to slots, as VMProgram would
+  std::vector<Instruction> code = script.instructions;
+  std::vector<std::string> slots = script.variableSlots;
+  std::unordered_map<std::string, u32> slotIndices;
+  for (u32 i = 0; i < slots.size(); ++i) {
+    slotIndices.emplace(slots[i], i);
+  }
+  for (auto &instr : code) {
+    const bool load =
+        instr.opcode == OpCode::LOAD_VAR || instr.opcode == OpCode::LOAD_GLOBAL;
+    const bool store = instr.opcode == OpCode::STORE_VAR ||
+                       instr.opcode == OpCode::STORE_GLOBAL;
+    if ((!load && !store) || instr.operand >= script.stringTable.size()) {
+      continue;
+    }
+    const std::string &name = script.stringTable[instr.operand];
+    auto [it, inserted] =
+        slotIndices.try_emplace(name, static_cast<u32>(slots.size()));
+    if (inserted) {
+      slots.push_back(name);
+    }
+    instr = Instruction(load ? OpCode::LOAD_SLOT : OpCode::STORE_SLOT,
+                        it->second);
+  }
+
+  // Scenes in entry order; each owns the code up to the next entry point
+  std::vector<std::pair<u32, std::string>> scenes;
+  for (const auto &[name, entry] : script.sceneEntryPoints) {
+    scenes.emplace_back(entry, name);
+  }
+  std::sort(scenes.begin(), scenes.end());
+  std::vector<u32> nameOrder(scenes.size());
+  for (u32 i = 0; i < nameOrder.size(); ++i) {
+    nameOrder[i] = i;
+  }
+  std::sort(nameOrder.begin(), nameOrder.end(), [&](u32 a, u32 b) {
+    return scenes[a].second < scenes[b].second;
+  });
+
+  std::vector<const CompiledCharacter *> characters;
+  for (const auto &[id, character] : script.characters) {
+    characters.push_back(&character);
+  }
+  std::sort(characters.begin(), characters.end(),
+            [](const auto *a, const auto *b) { return a->id < b->id; });
+
+  StringData strings;
+  std::vector<u8> out(HEADER_SIZE, 0);
+  putU32(out, 0, SCRIPT_MAGIC);
+  const u16 version = NMSC_VERSION_IMAGE;
+  std::memcpy(out.data() + H_VERSION, &version, sizeof(u16));
+  putU32(out, H_CODE_COUNT, static_cast<u32>(code.size()));
+  putU32(out, H_STRING_COUNT, static_cast<u32>(script.stringTable.size()));
+  putU32(out, H_SLOT_COUNT, static_cast<u32>(slots.size()));
+  putU32(out, H_SCENE_COUNT, static_cast<u32>(scenes.size()));
+  putU32(out, H_CHARACTER_COUNT, static_cast<u32>(characters.size()));
+  putU32(out, H_LINE_COUNT, static_cast<u32>(script.lineTable.size()));
+
+  alignTo(out, 8);
+  putU32(out, H_CODE, static_cast<u32>(out.size()));
+  for (const auto &instr : code) {
+    const usize offset = out.size();
+    out.resize(offset + sizeof(Instruction), 0);
+    out[offset] = static_cast<u8>(instr.opcode);
+    putU32(out, offset + 4, instr.operand);
+  }
+
+  putU32(out, H_STRINGS, static_cast<u32>(out.size()));
+  for (const auto &str : script.stringTable) {
+    appendRef(out, strings.add(str));
+  }
+
+  putU32(out, H_SLOTS, static_cast<u32>(out.size()));
+  for (const auto &name : slots) {
+    appendRef(out, strings.add(name));
+  }
+
+  putU32(out, H_SCENES, static_cast<u32>(out.size()));
+  for (usize i = 0; i < scenes.size(); ++i) {
+    appendRef(out, strings.add(scenes[i].second));
+    appendU32(out, scenes[i].first);
+    appendU32(out, i + 1 < scenes.size() ? scenes[i + 1].first
+                                         : static_cast<u32>(code.size()));
+  }
+  for (u32 index : nameOrder) {
+    appendU32(out, index);
+  }
+
+  putU32(out, H_CHARACTERS, static_cast<u32>(out.size()));
+  for (const auto *character : characters) {
+    appendRef(out, strings.add(character->id));
+    appendRef(out, strings.add(character->displayName));
+    appendRef(out, strings.add(character->color));
+    if (character->defaultSprite) {
+      appendRef(out, strings.add(*character->defaultSprite));
+    } else {
+      appendRef(out, {0, NO_STRING});
+    }
+  }
+
+  putU32(out, H_LINES, static_cast<u32>(out.size()));
+  for (const auto &entry : script.lineTable) {
+    appendU32(out, entry.instruction);
+    appendU32(out, entry.location.line);
+    appendU32(out, entry.location.column);
+  }
+
+  putU32(out, H_STRING_DATA, static_cast<u32>(out.size()));
+  putU32(out, H_STRING_DATA_SIZE, static_cast<u32>(strings.data().size()));
+  out.insert(out.end(), strings.data().begin(), strings.data().end());
+  return out;
+}
+
+ScriptImage::~ScriptImage() = default;
+
+Result<ScriptImagePtr> ScriptImage::open(const std::string &path) {
+  auto file = core::MappedFile::open(path);
+  if (file.isError()) {
+    return Result<ScriptImagePtr>::error(file.error());
+  }
+
+  // Private constructor, so no make_shared
+  std::shared_ptr<ScriptImage> image(new ScriptImage());
+  image->m_file = std::move(file).value();
+  auto bound = image->bind(image->m_file->data(), image->m_file->size());
+  if (bound.isError()) {
+    return Result<ScriptImagePtr>::error(bound.error() + ": " + path);
+  }
+  return Result<ScriptImagePtr>::ok(std::move(image));
+}
+
+Result<ScriptImagePtr> ScriptImage::fromBytes(std::vector<u8> bytes) {
+  std::shared_ptr<ScriptImage> image(new ScriptImage());
+  image->m_bytes = std::move(bytes);
+  auto bound = image->bind(image->m_bytes.data(), image->m_bytes.size());
+  if (bound.isError()) {
+    return Result<ScriptImagePtr>::error(bound.error());
+  }
+  return Result<ScriptImagePtr>::ok(std::move(image));
+}
+
+Result<void> ScriptImage::bind(const u8 *data, usize size) {
+  if (size < HEADER_SIZE) {
+    return Result<void>::error("Script image too small");
+  }
+  u16 version = 0;
+  std::memcpy(&version, data + H_VERSION, sizeof(u16));
+  if (readU32(data) != SCRIPT_MAGIC) {
+    return Result<void>::error("Invalid script magic");
+  }
+  if (version != NMSC_VERSION_IMAGE) {
+    return Result<void>::error("Unsupported NMSC version: " +
+                               std::to_string(version));
+  }
+
+  m_data = data;
+  m_size = size;
+  m_codeSize = readU32(data + H_CODE_COUNT);
+  m_stringCount = readU32(data + H_STRING_COUNT);
+  m_slotCount = readU32(data + H_SLOT_COUNT);
+  m_sceneCount = readU32(data + H_SCENE_COUNT);
+  m_characterCount = readU32(data + H_CHARACTER_COUNT);
+  m_lineCount = readU32(data + H_LINE_COUNT);
+
+  const u32 codeOffset = readU32(data + H_CODE);
+  const u32 stringsOffset = readU32(data + H_STRINGS);
+  const u32 slotsOffset = readU32(data + H_SLOTS);
+  const u32 scenesOffset = readU32(data + H_SCENES);
+  const u32 charactersOffset = readU32(data + H_CHARACTERS);
+  const u32 linesOffset = readU32(data + H_LINES);
+  const u32 stringDataOffset = readU32(data + H_STRING_DATA);
+  m_stringDataSize = readU32(data + H_STRING_DATA_SIZE);
+
+  if (!fits(codeOffset, m_codeSize, sizeof(Instruction), size) ||
+      !fits(stringsOffset, m_stringCount, STRING_REF_SIZE, size) ||
+      !fits(slotsOffset, m_slotCount, STRING_REF_SIZE, size) ||
+      !fits(scenesOffset, m_sceneCount, SCENE_SIZE + sizeof(u32), size) ||
+      !fits(charactersOffset, m_characterCount, CHARACTER_SIZE, size) ||
+      !fits(linesOffset, m_lineCount, LINE_SIZE, size) ||
+      !fits(stringDataOffset, m_stringDataSize, 1, size)) {
+    return Result<void>::error("Truncated script image");
+  }
+  if (reinterpret_cast<std::uintptr_t>(data + codeOffset) %
+          alignof(Instruction) !=
+      0) {
+    return Result<void>::error("Misaligned instruction section");
+  }
+
+  m_code = reinterpret_cast<const Instruction *>(data + codeOffset);
+  m_stringIndex = data + stringsOffset;
+  m_slotIndex = data + slotsOffset;
+  m_sceneIndex = data + scenesOffset;
+  m_sceneNameOrder = m_sceneIndex + static_cast<usize>(m_sceneCount) * SCENE_SIZE;
+  m_characters = data + charactersOffset;
+  m_lineTable = data + linesOffset;
+  m_stringData = data + stringDataOffset;
+
+  // The scene table is small; checking it now keeps every lookup simple.
+  // Scenes must tile the code after the prologue, so every instruction is
+  // validated either with the prologue or with the scene that owns it
+  u32 previousEnd = m_sceneCount > 0 ? getScene(0).entry : m_codeSize;
+  for (u32 i = 0; i < m_sceneCount; ++i) {
+    const ImageScene scene = getScene(i);
+    if (scene.entry != previousEnd || scene.entry > scene.end ||
+        scene.end > m_codeSize || readU32(m_sceneNameOrder + i * 4) >= m_sceneCount) {
+      return Result<void>::error("Invalid scene index");
+    }
+    previousEnd = scene.end;
+  }
+  if (previousEnd != m_codeSize) {
+    return Result<void>::error("Invalid scene index");
+  }
+
+  m_sceneStates = std::make_unique<std::atomic<u8>[]>(m_sceneCount);
+
+  // Code ahead of the first scene runs before any scene is entered
+  const u32 prologueEnd = m_sceneCount > 0 ? getScene(0).entry : m_codeSize;
+  return validateRange(0, prologueEnd);
+}
+
+std::string_view ScriptImage::stringAt(const u8 *ref) const {
+  const u32 offset = readU32(ref);
+  const u32 length = readU32(ref + 4);
+  if (length == NO_STRING || offset > m_stringDataSize ||
+      length > m_stringDataSize - offset) {
+    return {};
+  }
+  return {reinterpret_cast<const char *>(m_stringData) + offset, length};
+}
+
+std::string_view ScriptImage::getString(u32 index) const {
+  if (index >= m_stringCount) {
+    return {};
+  }
+  return stringAt(m_stringIndex + static_cast<usize>(index) * STRING_REF_SIZE);
+}
+
+std::string_view ScriptImage::getVariableSlot(u32 slot) const {
+  if (slot >= m_slotCount) {
+    return {};
+  }
+  return stringAt(m_slotIndex + static_cast<usize>(slot) * STRING_REF_SIZE);
+}
+
+ImageScene ScriptImage::getScene(u32 index) const {
+  if (index >= m_sceneCount) {
+    return {};
+  }
+  const u8 *record = m_sceneIndex + static_cast<usize>(index) * SCENE_SIZE;
+  return {stringAt(record), readU32(record + 8), readU32(record + 12)};
+}
+
+std::optional<u32> ScriptImage::findScene(std::string_view name) const {
+  u32 low = 0;
+  u32 high = m_sceneCount;
+  while (low < high) {
+    const u32 mid = low + (high - low) / 2;
+    const u32 index = readU32(m_sceneNameOrder + static_cast<usize>(mid) * 4);
+    const std::string_view candidate = getScene(index).name;
+    if (candidate == name) {
+      return index;
+    }
+    if (candidate < name) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<u32> ScriptImage::findSceneAt(u32 instruction) const {
+  // Last scene whose entry point is at or before the instruction
+  u32 low = 0;
+  u32 high = m_sceneCount;
+  while (low < high) {
+    const u32 mid = low + (high - low) / 2;
+    if (getScene(mid).entry <= instruction) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == 0) {
+    return std::nullopt;
+  }
+  return low - 1;
+}
+
+Result<void> ScriptImage::loadScene(u32 index) const {
+  if (index >= m_sceneCount) {
+    return Result<void>::error("Invalid scene index: " + std::to_string(index));
+  }
+
+  const u8 state = m_sceneStates[index].load(std::memory_order_acquire);
+  const ImageScene scene = getScene(index);
+  if (state == 1) {
+    return Result<void>::ok();
+  }
+
+  // Threads racing on the same scene validate it twice and agree
+  auto result = validateRange(scene.entry, scene.end);
+  m_sceneStates[index].store(result.isOk() ? 1 : 2, std::memory_order_release);
+  if (result.isError()) {
+    return Result<void>::error("Scene '" + std::string(scene.name) +
+                               "': " + result.error());
+  }
+  if (m_file) {
+    m_file->prefetch(
+        static_cast<usize>(reinterpret_cast<const u8 *>(m_code + scene.entry) -
+                           m_data),
+        static_cast<usize>(scene.end - scene.entry) * sizeof(Instruction));
+  }
+  return Result<void>::ok();
+}
+
+bool ScriptImage::isSceneLoaded(u32 index) const {
+  return index < m_sceneCount &&
+         m_sceneStates[index].load(std::memory_order_acquire) == 1;
+}
+
+usize ScriptImage::getLoadedSceneCount() const {
+  usize count = 0;
+  for (u32 i = 0; i < m_sceneCount; ++i) {
+    if (isSceneLoaded(i)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+Result<void> ScriptImage::validateRange(u32 begin, u32 end) const {
+  auto invalid = [](u32 at, const std::string &what) {
+    return Result<void>::error(what + " at instruction " + std::to_string(at));
+  };
+
+  for (u32 i = begin; i < end; ++i) {
+    const Instruction &instr = m_code[i];
+    const OpCode op = instr.opcode;
+    if (std::string_view(opcodeName(op)) == "UNKNOWN" ||
+        op == OpCode::EXTRA_ARG) {
+      return invalid(i, "Invalid opcode");
+    }
+    switch (op) {
+    case OpCode::LOAD_VAR:
+    case OpCode::STORE_VAR:
+    case OpCode::LOAD_GLOBAL:
+    case OpCode::STORE_GLOBAL:
+      return invalid(i, "Unlinked variable access");
+    case OpCode::CMP_JUMP_IF_NOT:
+      if (unpackCompareValue(instr.operand) > m_codeSize ||
+          unpackCompareOp(instr.operand) > CompareOp::Ge) {
+        return invalid(i, "Invalid jump target");
+      }
+      break;
+    case OpCode::SLOT_CMP_INT_JUMP_IF_NOT:
+      if (end - i < 3 || m_code[i + 1].opcode != OpCode::EXTRA_ARG ||
+          m_code[i + 2].opcode != OpCode::EXTRA_ARG) {
+        return invalid(i, "Truncated superinstruction");
+      }
+      if (unpackCompareValue(instr.operand) >= m_slotCount ||
+          unpackCompareOp(instr.operand) > CompareOp::Ge) {
+        return invalid(i, "Invalid variable slot");
+      }
+      if (m_code[i + 2].operand > m_codeSize) {
+        return invalid(i, "Invalid jump target");
+      }
+      i += 2;
+      break;
+    default:
+      if (hasStringOperand(op) && instr.operand >= m_stringCount) {
+        return invalid(i, "Invalid string index");
+      }
+      if (hasSlotOperand(op) && instr.operand >= m_slotCount) {
+        return invalid(i, "Invalid variable slot");
+      }
+      if (hasJumpTarget(op) && instr.operand > m_codeSize) {
+        return invalid(i, "Invalid jump target");
+      }
+      break;
+    }
+  }
+  return Result<void>::ok();
+}
+
+CompiledCharacter ScriptImage::getCharacter(u32 index) const {
+  CompiledCharacter character;
+  if (index >= m_characterCount) {
+    return character;
+  }
+  const u8 *record = m_characters + static_cast<usize>(index) * CHARACTER_SIZE;
+  character.id = stringAt(record);
+  character.displayName = stringAt(record + 8);
+  character.color = stringAt(record + 16);
+  if (readU32(record + 28) != NO_STRING) {
+    character.defaultSprite = std::string(stringAt(record + 24));
+  }
+  return character;
+}
+
+std::vector<LineTableEntry> ScriptImage::getLineTable() const {
+  std::vector<LineTableEntry> lines(m_lineCount);
+  for (u32 i = 0; i < m_lineCount; ++i) {
+    const u8 *record = m_lineTable + static_cast<usize>(i) * LINE_SIZE;
+    lines[i] = {readU32(record),
+                SourceLocation(readU32(record + 4), readU32(record + 8))};
+  }
+  return lines;
+}
+
+CompiledScript ScriptImage::toCompiledScript() const {
+  CompiledScript script;
+  script.instructions.assign(m_code, m_code + m_codeSize);
+  script.stringTable.reserve(m_stringCount);
+  for (u32 i = 0; i < m_stringCount; ++i) {
+    script.stringTable.emplace_back(getString(i));
+  }
+  script.variableSlots.reserve(m_slotCount);
+  for (u32 i = 0; i < m_slotCount; ++i) {
+    script.variableSlots.emplace_back(getVariableSlot(i));
+  }
+  for (u32 i = 0; i < m_sceneCount; ++i) {
+    const ImageScene scene = getScene(i);
+    script.sceneEntryPoints.emplace(std::string(scene.name), scene.entry);
+  }
+  for (u32 i = 0; i < m_characterCount; ++i) {
+    CompiledCharacter character = getCharacter(i);
+    std::string id = character.id;
+    script.characters.emplace(std::move(id), std::move(character));
+  }
+  script.lineTable = getLineTable();
+  return script;
+}
+
+} // namespace NovelMind::scripting
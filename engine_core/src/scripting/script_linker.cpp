@@ -0,0 +1,150 @@
+#include "NovelMind/scripting/script_linker.hpp"
+#include <string>
+#include <unordered_map>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+// Merged string or slot table that keeps the first index of every name
+class NameTable {
+public:
+  explicit NameTable(std::vector<std::string> &names) : m_names(names) {}
+
+  u32 add(const std::string &name) {
+    auto [it, inserted] =
+        m_indices.try_emplace(name, static_cast<u32>(m_names.size()));
+    if (inserted) {
+      m_names.push_back(name);
+    }
+    return it->second;
+  }
+
+private:
+  std::vector<std::string> &m_names;
+  std::unordered_map<std::string, u32> m_indices;
+};
+
+// Where the two sections of a fragment land in the linked code
+struct Placement {
+  u32 sceneBase = 0;
+  u32 globalsBase = 0;
+  u32 globalsStart = 0;
+
+  [[nodiscard]] u32 relocate(u32 instruction) const {
+    return instruction < globalsStart
+               ? sceneBase + instruction
+               : globalsBase + (instruction - globalsStart);
+  }
+
+  // The end of the scene section is where the last scene falls through,
+  // which is the next fragment's first scene, not this one's globals
+  [[nodiscard]] u32 relocateTarget(u32 target) const {
+    return target <= globalsStart ? sceneBase + target
+                                  : globalsBase + (target - globalsStart);
+  }
+};
+
+} // namespace
+
+Result<CompiledScript>
+linkFragments(const std::vector<const ScriptFragment *> &fragments) {
+  CompiledScript linked;
+  NameTable strings(linked.stringTable);
+  NameTable slots(linked.variableSlots);
+
+  // Lay out every scene section, then every globals section
+  std::vector<Placement> placements(fragments.size());
+  u32 offset = 0;
+  for (usize f = 0; f < fragments.size(); ++f) {
+    placements[f].sceneBase = offset;
+    placements[f].globalsStart = fragments[f]->globalsStart;
+    offset += fragments[f]->globalsStart;
+  }
+  for (usize f = 0; f < fragments.size(); ++f) {
+    placements[f].globalsBase = offset;
+    offset += static_cast<u32>(fragments[f]->script.instructions.size()) -
+              fragments[f]->globalsStart;
+  }
+  linked.instructions.resize(offset);
+
+  std::vector<LineTableEntry> globalLines;
+  for (usize f = 0; f < fragments.size(); ++f) {
+    const CompiledScript &script = fragments[f]->script;
+    const Placement &placement = placements[f];
+
+    std::vector<u32> stringMap(script.stringTable.size());
+    for (usize i = 0; i < script.stringTable.size(); ++i) {
+      stringMap[i] = strings.add(script.stringTable[i]);
+    }
+    std::vector<u32> slotMap(script.variableSlots.size());
+    for (usize i = 0; i < script.variableSlots.size(); ++i) {
+      slotMap[i] = slots.add(script.variableSlots[i]);
+    }
+
+    for (usize i = 0; i < script.instructions.size(); ++i) {
+      Instruction instr = script.instructions[i];
+      if (hasStringOperand(instr.opcode)) {
+        if (instr.operand >= stringMap.size()) {
+          return Result<CompiledScript>::error(
+              "Invalid string index in fragment: " +
+              std::to_string(instr.operand));
+        }
+        instr.operand = stringMap[instr.operand];
+      } else if (hasSlotOperand(instr.opcode)) {
+        if (instr.operand >= slotMap.size()) {
+          return Result<CompiledScript>::error(
+              "Invalid variable slot in fragment: " +
+              std::to_string(instr.operand));
+        }
+        instr.operand = slotMap[instr.operand];
+      } else if (hasJumpTarget(instr.opcode)) {
+        instr.operand = placement.relocateTarget(instr.operand);
+      } else if (instr.opcode == OpCode::CMP_JUMP_IF_NOT ||
+                 instr.opcode == OpCode::SLOT_CMP_INT_JUMP_IF_NOT ||
+                 instr.opcode == OpCode::EXTRA_ARG) {
+        return Result<CompiledScript>::error(
+            std::string("Cannot link optimized instruction: ") +
+            opcodeName(instr.opcode));
+      }
+      linked.instructions[placement.relocate(static_cast<u32>(i))] = instr;
+    }
+
+    for (const auto &entry : script.lineTable) {
+      LineTableEntry moved{placement.relocate(entry.instruction),
+                           entry.location};
+      (entry.instruction < placement.globalsStart ? linked.lineTable
+                                                  : globalLines)
+          .push_back(moved);
+    }
+
+    for (const auto &[name, entry] : script.sceneEntryPoints) {
+      linked.sceneEntryPoints[name] = placement.relocateTarget(entry);
+    }
+    for (const auto &[id, character] : script.characters) {
+      linked.characters[id] = character;
+    }
+    for (const auto &[name, type] : script.variables) {
+      linked.variables[name] = type;
+    }
+  }
+
+  // Bind gotos that leave their fragment
+  for (usize f = 0; f < fragments.size(); ++f) {
+    for (const auto &jump : fragments[f]->externalJumps) {
+      auto it = linked.sceneEntryPoints.find(jump.scene);
+      if (it == linked.sceneEntryPoints.end()) {
+        return Result<CompiledScript>::error("Undefined label: " + jump.scene);
+      }
+      linked.instructions[placements[f].relocate(jump.instruction)].operand =
+          it->second;
+    }
+  }
+
+  linked.lineTable.insert(linked.lineTable.end(), globalLines.begin(),
+                          globalLines.end());
+  linked.instructions.emplace_back(OpCode::HALT, 0);
+  return Result<CompiledScript>::ok(std::move(linked));
+}
+
+} // namespace NovelMind::scripting
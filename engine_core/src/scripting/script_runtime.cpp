@@ -1,4 +1,5 @@
 #include "NovelMind/scripting/script_runtime.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace NovelMind::scripting {
@@ -7,9 +8,58 @@ ScriptRuntime::ScriptRuntime() = default;
 ScriptRuntime::~ScriptRuntime() = default;
 
 Result<void> ScriptRuntime::load(const CompiledScript &script) {
-  m_script = script;
+  auto program = VMProgram::create(script.instructions, script.stringTable,
+                                   script.variableSlots);
+  if (!program.isOk()) {
+    return Result<void>::error(program.error());
+  }
+  return load(script, std::move(program.value()));
+}
+
+Result<void> ScriptRuntime::load(const CompiledScript &script,
+                                 VMProgramPtr program) {
+  if (!program) {
+    return Result<void>::error("Empty program");
+  }
+
+  // The program holds the instructions and strings; only the tables the
+  // runtime looks up itself are copied
+  CompiledScript tables;
+  tables.sceneEntryPoints = script.sceneEntryPoints;
+  tables.characters = script.characters;
+  return attach(std::move(tables), std::move(program));
+}
+
+Result<void> ScriptRuntime::load(ScriptImagePtr image) {
+  if (!image) {
+    return Result<void>::error("Empty program");
+  }
+  auto program = VMProgram::create(image);
+  if (!program.isOk()) {
+    return Result<void>::error(program.error());
+  }
+
+  // Only the scene and character tables are decoded; instructions and
+  // scenes stay in the image until the VM enters them
+  CompiledScript script;
+  for (u32 i = 0; i < image->getSceneCount(); ++i) {
+    const ImageScene scene = image->getScene(i);
+    script.sceneEntryPoints.emplace(std::string(scene.name), scene.entry);
+  }
+  for (u32 i = 0; i < image->getCharacterCount(); ++i) {
+    CompiledCharacter character = image->getCharacter(i);
+    std::string id = character.id;
+    script.characters.emplace(std::move(id), std::move(character));
+  }
+
+  return attach(std::move(script), std::move(program.value()));
+}
 
-  auto result = m_vm.load(script.instructions, script.stringTable);
+Result<void> ScriptRuntime::attach(CompiledScript tables,
+                                   VMProgramPtr program) {
+  m_script = std::move(tables);
+  m_program = std::move(program);
+  auto result = m_vm.load(m_program);
   if (!result.isOk()) {
     return Result<void>::error(result.error());
   }
@@ -52,8 +102,10 @@ void ScriptRuntime::start() {
     return;
   }
 
-  // Start from first scene
-  auto it = m_script.sceneEntryPoints.begin();
+  // Start from the first scene in the source, which has the lowest entry
+  auto it = std::min_element(
+      m_script.sceneEntryPoints.begin(), m_script.sceneEntryPoints.end(),
+      [](const auto &a, const auto &b) { return a.second < b.second; });
   gotoScene(it->first);
 }
 
@@ -63,22 +115,45 @@ Result<void> ScriptRuntime::gotoScene(const std::string &sceneName) {
     return Result<void>::error("Scene not found: " + sceneName);
   }
 
-  m_currentScene = sceneName;
-  m_vm.reset();
-
-  // Load the full program and set IP to scene entry
-  m_vm.load(m_script.instructions, m_script.stringTable);
+  // A scene of an image is validated the first time it is entered
+  if (const auto &image = m_program->getImage()) {
+    if (auto scene = image->findScene(sceneName)) {
+      auto loaded = image->loadScene(*scene);
+      if (loaded.isError()) {
+        return loaded;
+      }
+    }
+  }
 
-  // Set instruction pointer manually would require VM modification
-  // For now, we'll run until we reach the scene
+  // Reloading the shared program copies nothing
+  m_vm.load(m_program);
+  auto entered = m_vm.restoreExecution(it->second, {});
+  if (entered.isError()) {
+    return entered;
+  }
+  m_currentScene = sceneName;
 
   m_state = RuntimeState::Running;
   fireEvent(ScriptEventType::SceneChange, sceneName);
 
+  m_scheduler.cancel(m_storyFiber);
+  m_storyFiber = INVALID_FIBER_ID;
+  if (m_executionMode == ExecutionMode::Fibers) {
+    m_storyFiber = m_scheduler.spawn(runStory());
+  }
+
   return Result<void>::ok();
 }
 
 void ScriptRuntime::update(f64 deltaTime) {
+  m_scheduler.update(deltaTime);
+
+  if (m_executionMode == ExecutionMode::Fibers) {
+    // The story fiber handles execution, timers and input waits
+    updateDialogue(deltaTime);
+    return;
+  }
+
   switch (m_state) {
   case RuntimeState::Idle:
   case RuntimeState::Halted:
@@ -142,7 +217,11 @@ void ScriptRuntime::update(f64 deltaTime) {
 void ScriptRuntime::continueExecution() {
   if (m_state == RuntimeState::WaitingInput) {
     m_state = RuntimeState::Running;
-    m_vm.signalContinue();
+    if (m_executionMode == ExecutionMode::Fibers) {
+      m_scheduler.signalInput(m_storyFiber);
+    } else {
+      m_vm.signalContinue();
+    }
 
     if (m_dialogueBox) {
       m_dialogueBox->clear();
@@ -154,18 +233,25 @@ void ScriptRuntime::selectChoice(i32 index) {
   if (m_state == RuntimeState::WaitingChoice) {
     if (index >= 0 && index < static_cast<i32>(m_currentChoices.size())) {
       m_selectedChoice = index;
-      m_vm.signalChoice(index);
-      m_state = RuntimeState::Running;
-
-      fireEvent(ScriptEventType::ChoiceSelected,
-                m_currentChoices[static_cast<size_t>(index)],
-                Value{static_cast<i32>(index)});
+      std::string selected =
+          std::move(m_currentChoices[static_cast<size_t>(index)]);
+      m_currentChoices.clear();
 
       if (m_choiceMenu) {
         m_choiceMenu->setVisible(false);
       }
 
-      m_currentChoices.clear();
+      fireEvent(ScriptEventType::ChoiceSelected, selected,
+                Value{static_cast<i32>(index)});
+
+      // Signal last: a running VM may reach the next SAY or CHOICE inside
+      // signalChoice(), and its handler sets the new state and choices
+      m_state = RuntimeState::Running;
+      if (m_executionMode == ExecutionMode::Fibers) {
+        m_scheduler.signalChoice(m_storyFiber, index);
+      } else {
+        m_vm.signalChoice(index);
+      }
     }
   }
 }
@@ -173,19 +259,27 @@ void ScriptRuntime::selectChoice(i32 index) {
 void ScriptRuntime::pause() {
   if (m_state == RuntimeState::Running) {
     m_state = RuntimeState::Paused;
-    m_vm.pause();
+    // The story fiber checks m_state itself; pausing the VM would make
+    // resume() run it outside the fiber
+    if (m_executionMode == ExecutionMode::Stepped) {
+      m_vm.pause();
+    }
   }
 }
 
 void ScriptRuntime::resume() {
   if (m_state == RuntimeState::Paused) {
     m_state = RuntimeState::Running;
-    m_vm.resume();
+    if (m_executionMode == ExecutionMode::Stepped) {
+      m_vm.resume();
+    }
   }
 }
 
 void ScriptRuntime::stop() {
   m_state = RuntimeState::Halted;
+  m_scheduler.cancel(m_storyFiber);
+  m_storyFiber = INVALID_FIBER_ID;
   m_vm.reset();
 }
 
@@ -232,10 +326,15 @@ bool ScriptRuntime::isSkipMode() const { return m_skipMode; }
 RuntimeSaveState ScriptRuntime::saveState() const {
   RuntimeSaveState state;
   state.currentScene = m_currentScene;
-  state.instructionPointer = 0; // Would need VM modification to get this
+  state.instructionPointer = m_vm.getIP();
 
-  // Save all variables from VM (would need VM modification)
-  state.inDialogue = m_dialogueActive;
+  state.variables = m_vm.getVariables();
+  state.flags = m_vm.getFlags();
+  state.stack = m_vm.getStack();
+  if (m_state == RuntimeState::WaitingChoice) {
+    state.pendingChoices = m_currentChoices;
+  }
+  state.inDialogue = m_dialogueActive || m_state == RuntimeState::WaitingInput;
 
   return state;
 }
@@ -258,15 +357,115 @@ Result<void> ScriptRuntime::loadState(const RuntimeSaveState &state) {
   return Result<void>::ok();
 }
 
+Result<void> ScriptRuntime::restoreSnapshot(const RuntimeSaveState &state) {
+  if (!m_program) {
+    return Result<void>::error("No script loaded");
+  }
+
+  m_scheduler.cancel(m_storyFiber);
+  m_storyFiber = INVALID_FIBER_ID;
+
+  m_vm.clearVariables();
+  m_vm.clearFlags();
+  for (const auto &[name, value] : state.variables) {
+    m_vm.setVariable(name, value);
+  }
+  for (const auto &[name, value] : state.flags) {
+    m_vm.setFlag(name, value);
+  }
+
+  OpCode waitReason = OpCode::NOP;
+  RuntimeState runState = RuntimeState::Running;
+  if (!state.pendingChoices.empty()) {
+    waitReason = OpCode::CHOICE;
+    runState = RuntimeState::WaitingChoice;
+  } else if (state.inDialogue) {
+    waitReason = OpCode::SAY;
+    runState = RuntimeState::WaitingInput;
+  }
+
+  auto result =
+      m_vm.restoreExecution(state.instructionPointer, state.stack, waitReason);
+  if (result.isError()) {
+    return result;
+  }
+
+  m_currentScene = state.currentScene;
+  m_currentChoices = state.pendingChoices;
+  m_waitTimer = 0.0f;
+  m_activeTransition.reset();
+  m_state = runState;
+
+  return Result<void>::ok();
+}
+
 void ScriptRuntime::setEventCallback(EventCallback callback) {
   m_eventCallback = std::move(callback);
 }
 
 VirtualMachine &ScriptRuntime::getVM() { return m_vm; }
 
+void ScriptRuntime::setExecutionMode(ExecutionMode mode) {
+  m_executionMode = mode;
+}
+
+ExecutionMode ScriptRuntime::getExecutionMode() const {
+  return m_executionMode;
+}
+
+FiberScheduler &ScriptRuntime::getScheduler() { return m_scheduler; }
+
+ScriptFiber ScriptRuntime::runStory() {
+  while (true) {
+    while (m_state == RuntimeState::Paused) {
+      co_await NextFrame{};
+    }
+
+    // Runs until the next SAY/CHOICE/WAIT; the handlers set m_state
+    m_vm.run();
+    if (m_vm.isHalted()) {
+      m_state = RuntimeState::Halted;
+      co_return;
+    }
+
+    switch (m_vm.getWaitReason()) {
+    case OpCode::CHOICE: {
+      i32 choice = co_await WaitForChoice{};
+      m_vm.completeChoice(choice);
+      break;
+    }
+    case OpCode::WAIT:
+      co_await WaitForSeconds{m_vm.getWaitDuration()};
+      m_waitTimer = 0.0f;
+      m_vm.completeWait();
+      break;
+    case OpCode::SAY:
+      // Skip mode advances dialogue one line per frame instead of
+      // recursing through signalContinue()
+      if (m_skipMode) {
+        co_await NextFrame{};
+        if (m_dialogueBox) {
+          m_dialogueBox->clear();
+        }
+      } else {
+        co_await WaitForInput{};
+      }
+      m_vm.completeWait();
+      break;
+    default:
+      co_await NextFrame{};
+      break;
+    }
+
+    if (m_state != RuntimeState::Paused) {
+      m_state = RuntimeState::Running;
+    }
+  }
+}
+
 // VM callback handlers
 
-void ScriptRuntime::onShowBackground(const std::vector<Value> &args) {
+void ScriptRuntime::onShowBackground(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -281,7 +480,7 @@ void ScriptRuntime::onShowBackground(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::SceneChange, bgName);
 }
 
-void ScriptRuntime::onShowCharacter(const std::vector<Value> &args) {
+void ScriptRuntime::onShowCharacter(NativeArgs args) {
   if (args.size() < 2) {
     return;
   }
@@ -305,7 +504,7 @@ void ScriptRuntime::onShowCharacter(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::CharacterShow, charId);
 }
 
-void ScriptRuntime::onHideCharacter(const std::vector<Value> &args) {
+void ScriptRuntime::onHideCharacter(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -319,7 +518,7 @@ void ScriptRuntime::onHideCharacter(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::CharacterHide, charId);
 }
 
-void ScriptRuntime::onSay(const std::vector<Value> &args) {
+void ScriptRuntime::onSay(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -357,7 +556,7 @@ void ScriptRuntime::onSay(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::DialogueStart, speaker, Value{text});
 }
 
-void ScriptRuntime::onChoice(const std::vector<Value> &args) {
+void ScriptRuntime::onChoice(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -382,16 +581,32 @@ void ScriptRuntime::onChoice(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::ChoiceStart);
 }
 
-void ScriptRuntime::onGotoScene(const std::vector<Value> &args) {
+void ScriptRuntime::onGotoScene(NativeArgs args) {
   if (args.empty()) {
     return;
   }
 
-  std::string sceneName = asString(args[0]);
-  gotoScene(sceneName);
+  // The VM jumps to the scene itself; the stack format passes the entry
+  // point rather than the name
+  std::string sceneName;
+  if (const auto *entry = std::get_if<i32>(&args[0])) {
+    for (const auto &[name, ip] : m_script.sceneEntryPoints) {
+      if (static_cast<i32>(ip) == *entry) {
+        sceneName = name;
+        break;
+      }
+    }
+  } else {
+    sceneName = asString(args[0]);
+  }
+
+  if (!sceneName.empty()) {
+    m_currentScene = sceneName;
+    fireEvent(ScriptEventType::SceneChange, sceneName);
+  }
 }
 
-void ScriptRuntime::onWait(const std::vector<Value> &args) {
+void ScriptRuntime::onWait(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -405,7 +620,7 @@ void ScriptRuntime::onWait(const std::vector<Value> &args) {
   m_state = RuntimeState::WaitingTimer;
 }
 
-void ScriptRuntime::onPlaySound(const std::vector<Value> &args) {
+void ScriptRuntime::onPlaySound(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -419,7 +634,7 @@ void ScriptRuntime::onPlaySound(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::SoundPlay, soundId);
 }
 
-void ScriptRuntime::onPlayMusic(const std::vector<Value> &args) {
+void ScriptRuntime::onPlayMusic(NativeArgs args) {
   if (args.empty()) {
     return;
   }
@@ -433,7 +648,7 @@ void ScriptRuntime::onPlayMusic(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::MusicStart, musicId);
 }
 
-void ScriptRuntime::onStopMusic(const std::vector<Value> &args) {
+void ScriptRuntime::onStopMusic(NativeArgs args) {
   f32 fadeOut = 0.0f;
 
   if (!args.empty()) {
@@ -448,7 +663,7 @@ void ScriptRuntime::onStopMusic(const std::vector<Value> &args) {
   fireEvent(ScriptEventType::MusicStop);
 }
 
-void ScriptRuntime::onTransition(const std::vector<Value> &args) {
+void ScriptRuntime::onTransition(NativeArgs args) {
   if (args.size() < 2) {
     return;
   }
@@ -470,36 +685,36 @@ void ScriptRuntime::onTransition(const std::vector<Value> &args) {
 
 void ScriptRuntime::registerCallbacks() {
   m_vm.registerCallback(OpCode::SHOW_BACKGROUND,
-                        [this](const auto &args) { onShowBackground(args); });
+                        [this](NativeArgs args) { onShowBackground(args); });
 
   m_vm.registerCallback(OpCode::SHOW_CHARACTER,
-                        [this](const auto &args) { onShowCharacter(args); });
+                        [this](NativeArgs args) { onShowCharacter(args); });
 
   m_vm.registerCallback(OpCode::HIDE_CHARACTER,
-                        [this](const auto &args) { onHideCharacter(args); });
+                        [this](NativeArgs args) { onHideCharacter(args); });
 
-  m_vm.registerCallback(OpCode::SAY, [this](const auto &args) { onSay(args); });
+  m_vm.registerCallback(OpCode::SAY, [this](NativeArgs args) { onSay(args); });
 
   m_vm.registerCallback(OpCode::CHOICE,
-                        [this](const auto &args) { onChoice(args); });
+                        [this](NativeArgs args) { onChoice(args); });
 
   m_vm.registerCallback(OpCode::GOTO_SCENE,
-                        [this](const auto &args) { onGotoScene(args); });
+                        [this](NativeArgs args) { onGotoScene(args); });
 
   m_vm.registerCallback(OpCode::WAIT,
-                        [this](const auto &args) { onWait(args); });
+                        [this](NativeArgs args) { onWait(args); });
 
   m_vm.registerCallback(OpCode::PLAY_SOUND,
-                        [this](const auto &args) { onPlaySound(args); });
+                        [this](NativeArgs args) { onPlaySound(args); });
 
   m_vm.registerCallback(OpCode::PLAY_MUSIC,
-                        [this](const auto &args) { onPlayMusic(args); });
+                        [this](NativeArgs args) { onPlayMusic(args); });
 
   m_vm.registerCallback(OpCode::STOP_MUSIC,
-                        [this](const auto &args) { onStopMusic(args); });
+                        [this](NativeArgs args) { onStopMusic(args); });
 
   m_vm.registerCallback(OpCode::TRANSITION,
-                        [this](const auto &args) { onTransition(args); });
+                        [this](NativeArgs args) { onTransition(args); });
 }
 
 void ScriptRuntime::fireEvent(ScriptEventType type, const std::string &name,
@@ -518,6 +733,7 @@ void ScriptRuntime::updateWaitTimer(f64 deltaTime) {
   if (m_waitTimer <= 0.0f) {
     m_waitTimer = 0.0f;
     m_state = RuntimeState::Running;
+    m_vm.completeWait();
   }
 }
 
@@ -0,0 +1,75 @@
+#include "NovelMind/scripting/source_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace NovelMind::scripting {
+
+SourceFile::SourceFile(std::string text, std::string path)
+    : m_text(std::move(text)), m_path(std::move(path)) {
+  m_lineStarts.push_back(0);
+  const char *begin = m_text.data();
+  const char *end = begin + m_text.size();
+  for (const char *p = begin;
+       (p = static_cast<const char *>(
+            std::memchr(p, '\n', static_cast<usize>(end - p)))) != nullptr;
+       ++p) {
+    m_lineStarts.push_back(static_cast<u32>(p - begin + 1));
+  }
+}
+
+SourceFilePtr SourceFile::create(std::string text, std::string path) {
+  return SourceFilePtr(new SourceFile(std::move(text), std::move(path)));
+}
+
+Result<SourceFilePtr> SourceFile::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return Result<SourceFilePtr>::error("Cannot open file: " + path);
+  }
+
+  const std::streamoff size = file.tellg();
+  if (size < 0) {
+    return Result<SourceFilePtr>::error("Cannot read file: " + path);
+  }
+  if (static_cast<u64>(size) > 0xFFFFFFFFULL) {
+    return Result<SourceFilePtr>::error("Source file too large: " + path);
+  }
+
+  std::string text(static_cast<usize>(size), '\0');
+  file.seekg(0);
+  if (!file.read(text.data(), size)) {
+    return Result<SourceFilePtr>::error("Cannot read file: " + path);
+  }
+
+  return Result<SourceFilePtr>::ok(create(std::move(text), path));
+}
+
+std::string_view SourceFile::getLine(u32 line) const {
+  if (line == 0 || line > m_lineStarts.size()) {
+    return {};
+  }
+
+  const usize start = m_lineStarts[line - 1];
+  usize end = line < m_lineStarts.size() ? m_lineStarts[line] - 1
+                                         : m_text.size();
+  if (end > start && m_text[end - 1] == '\r') {
+    --end;
+  }
+  return std::string_view(m_text).substr(start, end - start);
+}
+
+usize SourceFile::getOffset(SourceLocation location) const {
+  if (location.line == 0) {
+    return 0;
+  }
+  if (location.line > m_lineStarts.size()) {
+    return m_text.size();
+  }
+
+  const usize offset = m_lineStarts[location.line - 1] +
+                       (location.column > 0 ? location.column - 1 : 0);
+  return std::min(offset, m_text.size());
+}
+
+} // namespace NovelMind::scripting
@@ -15,16 +15,30 @@ ValidationResult Validator::validate(const Program &program) {
   validateProgram(program);
 
   // Third pass: control flow analysis
-  analyzeControlFlow(program);
+  if (!m_projectSymbols) {
+    analyzeControlFlow(program);
+  }
 
   // Report unused symbols if configured
-  if (m_reportUnused) {
+  if (m_reportUnused && !m_projectSymbols) {
     reportUnusedSymbols();
   }
 
+  if (m_source) {
+    m_errors.attachSource(*m_source);
+  }
+
   ValidationResult result;
   result.errors = std::move(m_errors);
   result.isValid = !result.errors.hasErrors();
+  result.importedScenes = std::move(m_importedScenes);
+  result.importedCharacters = std::move(m_importedCharacters);
+  result.undefinedScenes = std::move(m_undefinedScenes);
+  result.undefinedCharacters = std::move(m_undefinedCharacters);
+  result.characters = std::move(m_characters);
+  result.scenes = std::move(m_scenes);
+  result.variables = std::move(m_variables);
+  result.sceneGraph = std::move(m_sceneGraph);
   return result;
 }
 
@@ -32,6 +46,12 @@ void Validator::setReportUnused(bool report) { m_reportUnused = report; }
 
 void Validator::setReportDeadCode(bool report) { m_reportDeadCode = report; }
 
+void Validator::setSource(SourceFilePtr source) { m_source = std::move(source); }
+
+void Validator::setProjectSymbols(const ProjectSymbols *symbols) {
+  m_projectSymbols = symbols;
+}
+
 void Validator::reset() {
   m_characters.clear();
   m_scenes.clear();
@@ -40,6 +60,10 @@ void Validator::reset() {
   m_currentScene.clear();
   m_currentLocation = {};
   m_errors.clear();
+  m_importedScenes.clear();
+  m_importedCharacters.clear();
+  m_undefinedScenes.clear();
+  m_undefinedCharacters.clear();
 }
 
 // First pass: collect definitions
@@ -57,11 +81,12 @@ void Validator::collectDefinitions(const Program &program) {
 }
 
 void Validator::collectCharacterDefinition(const CharacterDecl &decl) {
-  auto it = m_characters.find(decl.id);
+  std::string id(decl.id);
+  auto it = m_characters.find(id);
   if (it != m_characters.end() && it->second.isDefined) {
     // Duplicate definition
     ScriptError err(ErrorCode::DuplicateCharacterDefinition, Severity::Error,
-                    "Character '" + decl.id + "' is already defined",
+                    "Character '" + id + "' is already defined",
                     m_currentLocation);
     err.withRelated(it->second.definitionLocation, "Previously defined here");
     m_errors.add(std::move(err));
@@ -69,18 +94,19 @@ void Validator::collectCharacterDefinition(const CharacterDecl &decl) {
   }
 
   SymbolInfo info;
-  info.name = decl.id;
+  info.name = id;
   info.definitionLocation = m_currentLocation;
   info.isDefined = true;
-  m_characters[decl.id] = std::move(info);
+  m_characters[id] = std::move(info);
 }
 
 void Validator::collectSceneDefinition(const SceneDecl &decl) {
-  auto it = m_scenes.find(decl.name);
+  std::string name(decl.name);
+  auto it = m_scenes.find(name);
   if (it != m_scenes.end() && it->second.isDefined) {
     // Duplicate definition
     ScriptError err(ErrorCode::DuplicateSceneDefinition, Severity::Error,
-                    "Scene '" + decl.name + "' is already defined",
+                    "Scene '" + name + "' is already defined",
                     m_currentLocation);
     err.withRelated(it->second.definitionLocation, "Previously defined here");
     m_errors.add(std::move(err));
@@ -88,13 +114,13 @@ void Validator::collectSceneDefinition(const SceneDecl &decl) {
   }
 
   SymbolInfo info;
-  info.name = decl.name;
+  info.name = name;
   info.definitionLocation = m_currentLocation;
   info.isDefined = true;
-  m_scenes[decl.name] = std::move(info);
+  m_scenes[name] = std::move(info);
 
   // Initialize scene in the control flow graph
-  m_sceneGraph[decl.name] = {};
+  m_sceneGraph[name] = {};
 }
 
 // Second pass: validate references
@@ -119,7 +145,8 @@ void Validator::validateScene(const SceneDecl &decl) {
 
   // Check for empty scene
   if (decl.body.empty()) {
-    warning(ErrorCode::EmptyScene, "Scene '" + decl.name + "' is empty",
+    warning(ErrorCode::EmptyScene,
+            "Scene '" + m_currentScene + "' is empty",
             m_currentLocation);
   }
 
@@ -206,8 +233,7 @@ void Validator::validateShowStmt(const ShowStmt &stmt) {
   case ShowStmt::Target::Character:
   case ShowStmt::Target::Sprite: {
     if (!isCharacterDefined(stmt.identifier)) {
-      error(ErrorCode::UndefinedCharacter,
-            "Undefined character '" + stmt.identifier + "'", m_currentLocation);
+      undefinedCharacter(stmt.identifier);
     } else {
       markCharacterUsed(stmt.identifier, m_currentLocation);
     }
@@ -222,20 +248,20 @@ void Validator::validateShowStmt(const ShowStmt &stmt) {
   // Validate transition if present
   if (stmt.transition.has_value()) {
     // Validate known transition types
-    const std::string &trans = stmt.transition.value();
-    static const std::unordered_set<std::string> validTransitions = {
+    std::string_view trans = stmt.transition.value();
+    static const std::unordered_set<std::string_view> validTransitions = {
         "fade", "slide", "dissolve", "none"};
     if (validTransitions.find(trans) == validTransitions.end()) {
       warning(ErrorCode::UndefinedResource,
-              "Unknown transition type '" + trans + "'", m_currentLocation);
+              "Unknown transition type '" + std::string(trans) + "'",
+              m_currentLocation);
     }
   }
 }
 
 void Validator::validateHideStmt(const HideStmt &stmt) {
   if (!isCharacterDefined(stmt.identifier)) {
-    error(ErrorCode::UndefinedCharacter,
-          "Undefined character '" + stmt.identifier + "'", m_currentLocation);
+    undefinedCharacter(stmt.identifier);
   } else {
     markCharacterUsed(stmt.identifier, m_currentLocation);
   }
@@ -243,10 +269,9 @@ void Validator::validateHideStmt(const HideStmt &stmt) {
 
 void Validator::validateSayStmt(const SayStmt &stmt) {
   if (stmt.speaker.has_value()) {
-    const std::string &speaker = stmt.speaker.value();
+    std::string_view speaker = stmt.speaker.value();
     if (!isCharacterDefined(speaker)) {
-      error(ErrorCode::UndefinedCharacter,
-            "Undefined character '" + speaker + "'", m_currentLocation);
+      undefinedCharacter(speaker);
     } else {
       markCharacterUsed(speaker, m_currentLocation);
     }
@@ -267,11 +292,11 @@ void Validator::validateChoiceStmt(const ChoiceStmt &stmt,
   }
 
   // Check for duplicate choice texts
-  std::unordered_set<std::string> seenTexts;
+  std::unordered_set<std::string_view> seenTexts;
   for (const auto &option : stmt.options) {
     if (seenTexts.find(option.text) != seenTexts.end()) {
       warning(ErrorCode::DuplicateChoiceText,
-              "Duplicate choice text: '" + option.text + "'",
+              "Duplicate choice text: '" + std::string(option.text) + "'",
               m_currentLocation);
     }
     seenTexts.insert(option.text);
@@ -283,16 +308,14 @@ void Validator::validateChoiceStmt(const ChoiceStmt &stmt,
 
     // Validate goto target if present
     if (option.gotoTarget.has_value()) {
-      const std::string &target = option.gotoTarget.value();
+      std::string_view target = option.gotoTarget.value();
       if (!isSceneDefined(target)) {
-        error(ErrorCode::UndefinedScene,
-              "Undefined scene '" + target + "' in choice goto",
-              m_currentLocation);
+        undefinedScene(target, " in choice goto");
       } else {
         markSceneUsed(target, m_currentLocation);
         // Add to control flow graph
         if (!m_currentScene.empty()) {
-          m_sceneGraph[m_currentScene].insert(target);
+          m_sceneGraph[m_currentScene].emplace(target);
         }
       }
     } else if (option.body.empty()) {
@@ -344,14 +367,13 @@ void Validator::validateIfStmt(const IfStmt &stmt, bool &reachable) {
 
 void Validator::validateGotoStmt(const GotoStmt &stmt, bool &reachable) {
   if (!isSceneDefined(stmt.target)) {
-    error(ErrorCode::UndefinedScene, "Undefined scene '" + stmt.target + "'",
-          m_currentLocation);
+    undefinedScene(stmt.target, "");
   } else {
     markSceneUsed(stmt.target, m_currentLocation);
 
     // Add to control flow graph
     if (!m_currentScene.empty()) {
-      m_sceneGraph[m_currentScene].insert(stmt.target);
+      m_sceneGraph[m_currentScene].emplace(stmt.target);
     }
   }
 
@@ -403,11 +425,12 @@ void Validator::validateSetStmt(const SetStmt &stmt) {
 
 void Validator::validateTransitionStmt(const TransitionStmt &stmt) {
   // Validate known transition types
-  static const std::unordered_set<std::string> validTransitions = {
+  static const std::unordered_set<std::string_view> validTransitions = {
       "fade", "slide", "dissolve", "none", "fadethrough"};
   if (validTransitions.find(stmt.type) == validTransitions.end()) {
     warning(ErrorCode::UndefinedResource,
-            "Unknown transition type '" + stmt.type + "'", m_currentLocation);
+            "Unknown transition type '" + std::string(stmt.type) + "'",
+            m_currentLocation);
   }
 
   if (stmt.duration < 0.0f) {
@@ -476,7 +499,7 @@ void Validator::analyzeControlFlow(const Program &program) {
   }
 
   // Find the first scene (entry point)
-  const std::string &startScene = program.scenes[0].name;
+  const std::string startScene(program.scenes[0].name);
 
   // Find all reachable scenes
   std::unordered_set<std::string> reachable;
@@ -552,24 +575,29 @@ void Validator::reportUnusedSymbols() {
 
 // Helper methods
 
-void Validator::markCharacterUsed(const std::string &name, SourceLocation loc) {
-  auto it = m_characters.find(name);
+void Validator::markCharacterUsed(std::string_view name, SourceLocation loc) {
+  auto it = m_characters.find(std::string(name));
   if (it != m_characters.end()) {
     it->second.isUsed = true;
     it->second.usageLocations.push_back(loc);
+  } else if (m_projectSymbols) {
+    m_importedCharacters.emplace(name);
   }
 }
 
-void Validator::markSceneUsed(const std::string &name, SourceLocation loc) {
-  auto it = m_scenes.find(name);
+void Validator::markSceneUsed(std::string_view name, SourceLocation loc) {
+  auto it = m_scenes.find(std::string(name));
   if (it != m_scenes.end()) {
     it->second.isUsed = true;
     it->second.usageLocations.push_back(loc);
+  } else if (m_projectSymbols) {
+    m_importedScenes.emplace(name);
   }
 }
 
-void Validator::markVariableUsed(const std::string &name, SourceLocation loc) {
-  auto it = m_variables.find(name);
+void Validator::markVariableUsed(std::string_view name, SourceLocation loc) {
+  std::string key(name);
+  auto it = m_variables.find(key);
   if (it != m_variables.end()) {
     it->second.isUsed = true;
     it->second.usageLocations.push_back(loc);
@@ -577,16 +605,17 @@ void Validator::markVariableUsed(const std::string &name, SourceLocation loc) {
     // Variable used but not defined - could be an error in strict mode
     // For now, we allow global variables to be used before set
     SymbolInfo info;
-    info.name = name;
+    info.name = key;
     info.isUsed = true;
     info.usageLocations.push_back(loc);
-    m_variables[name] = std::move(info);
+    m_variables[key] = std::move(info);
   }
 }
 
-void Validator::markVariableDefined(const std::string &name,
+void Validator::markVariableDefined(std::string_view name,
                                     SourceLocation loc) {
-  auto it = m_variables.find(name);
+  std::string key(name);
+  auto it = m_variables.find(key);
   if (it != m_variables.end()) {
     // Variable already exists - just update definition location
     if (!it->second.isDefined) {
@@ -595,25 +624,46 @@ void Validator::markVariableDefined(const std::string &name,
     }
   } else {
     SymbolInfo info;
-    info.name = name;
+    info.name = key;
     info.definitionLocation = loc;
     info.isDefined = true;
-    m_variables[name] = std::move(info);
+    m_variables[key] = std::move(info);
   }
 }
 
-bool Validator::isCharacterDefined(const std::string &name) const {
-  auto it = m_characters.find(name);
-  return it != m_characters.end() && it->second.isDefined;
+void Validator::undefinedCharacter(std::string_view name) {
+  error(ErrorCode::UndefinedCharacter,
+        "Undefined character '" + std::string(name) + "'", m_currentLocation);
+  m_undefinedCharacters.emplace(name);
 }
 
-bool Validator::isSceneDefined(const std::string &name) const {
-  auto it = m_scenes.find(name);
-  return it != m_scenes.end() && it->second.isDefined;
+void Validator::undefinedScene(std::string_view name, const char *context) {
+  error(ErrorCode::UndefinedScene,
+        "Undefined scene '" + std::string(name) + "'" + context,
+        m_currentLocation);
+  m_undefinedScenes.emplace(name);
+}
+
+bool Validator::isCharacterDefined(std::string_view name) const {
+  std::string key(name);
+  auto it = m_characters.find(key);
+  if (it != m_characters.end() && it->second.isDefined) {
+    return true;
+  }
+  return m_projectSymbols && m_projectSymbols->characters.count(key) > 0;
+}
+
+bool Validator::isSceneDefined(std::string_view name) const {
+  std::string key(name);
+  auto it = m_scenes.find(key);
+  if (it != m_scenes.end() && it->second.isDefined) {
+    return true;
+  }
+  return m_projectSymbols && m_projectSymbols->scenes.count(key) > 0;
 }
 
-bool Validator::isVariableDefined(const std::string &name) const {
-  auto it = m_variables.find(name);
+bool Validator::isVariableDefined(std::string_view name) const {
+  auto it = m_variables.find(std::string(name));
   return it != m_variables.end() && it->second.isDefined;
 }
 
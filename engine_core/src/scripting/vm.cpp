@@ -1,7 +1,22 @@
 #include "NovelMind/scripting/vm.hpp"
 #include "NovelMind/core/logger.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 
+#ifndef NOVELMIND_VM_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define NOVELMIND_VM_COMPUTED_GOTO 1
+#else
+#define NOVELMIND_VM_COMPUTED_GOTO 0
+#endif
+#endif
+
+// Profiling hooks; set by the NOVELMIND_ENABLE_VM_PROFILER CMake option
+#ifndef NOVELMIND_VM_PROFILER
+#define NOVELMIND_VM_PROFILER 0
+#endif
+
 namespace NovelMind::scripting {
 
 VirtualMachine::VirtualMachine()
@@ -11,13 +26,45 @@ VirtualMachine::VirtualMachine()
 VirtualMachine::~VirtualMachine() = default;
 
 Result<void> VirtualMachine::load(const std::vector<Instruction> &program,
-                                  const std::vector<std::string> &stringTable) {
-  if (program.empty()) {
+                                  const std::vector<std::string> &stringTable,
+                                  const std::vector<std::string> &variableSlots) {
+  auto linked = VMProgram::create(program, stringTable, variableSlots);
+  if (linked.isError()) {
+    return Result<void>::error(linked.error());
+  }
+  return load(std::move(linked.value()));
+}
+
+Result<void> VirtualMachine::load(VMProgramPtr program) {
+  if (!program) {
     return Result<void>::error("Empty program");
   }
 
-  m_program = program;
-  m_stringTable = stringTable;
+  // Carry over anything already set by name (e.g. restored from a save)
+  std::vector<std::pair<std::string, Value>> previous;
+  for (usize slot = 0; slot < m_variables.size(); ++slot) {
+    if (m_variableAssigned[slot]) {
+      previous.emplace_back(getVariableName(static_cast<u32>(slot)),
+                            toValue(m_variables[slot], m_strings));
+    }
+  }
+
+  // Reloading is also when the pool drops strings no longer referenced
+  m_program = std::move(program);
+  m_loadedBegin = 0;
+  m_loadedEnd = 0;
+  m_strings = StringPool(m_program->getStrings());
+  m_localVariableNames.clear();
+  m_localVariableSlots.clear();
+  m_variables.assign(m_program->getVariableNames().size(), VMValue{});
+  m_variableAssigned.assign(m_variables.size(), false);
+
+  for (auto &[name, value] : previous) {
+    u32 slot = resolveVariableSlot(name);
+    m_variables[slot] = fromValue(value, m_strings);
+    m_variableAssigned[slot] = true;
+  }
+
   reset();
 
   return Result<void>::ok();
@@ -31,6 +78,8 @@ void VirtualMachine::reset() {
   m_waiting = false;
   m_halted = false;
   m_choiceResult = -1;
+  m_choiceSlot = static_cast<usize>(-1);
+  m_waitReason = OpCode::NOP;
 }
 
 bool VirtualMachine::step() {
@@ -38,12 +87,48 @@ bool VirtualMachine::step() {
     return false;
   }
 
-  if (m_ip >= m_program.size()) {
+  if (!m_program || m_ip >= m_program->size()) {
     m_halted = true;
     return false;
   }
 
-  executeInstruction(m_program[m_ip]);
+  // Entering code outside the validated range loads the scene owning it
+  if (m_ip < m_loadedBegin || m_ip >= m_loadedEnd) {
+    auto range = m_program->loadRange(m_ip);
+    if (range.isError()) {
+      NOVELMIND_LOG_ERROR(range.error());
+      m_halted = true;
+      return false;
+    }
+    m_loadedBegin = range.value().begin;
+    m_loadedEnd = range.value().end;
+    if (m_ip < m_loadedBegin || m_ip >= m_loadedEnd) {
+      NOVELMIND_LOG_ERROR("Instruction " + std::to_string(m_ip) +
+                          " is outside every validated range");
+      m_halted = true;
+      return false;
+    }
+  }
+
+  // By value: a callback may load another program and free this one
+  const Instruction instr = m_program->getInstructions()[m_ip];
+#if NOVELMIND_VM_PROFILER
+  if (m_profiler) {
+    const u32 ip = m_ip;
+    const auto start = std::chrono::steady_clock::now();
+    executeInstruction(instr);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    m_profiler->record(
+        ip, instr.opcode,
+        static_cast<u64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()));
+  } else {
+    executeInstruction(instr);
+  }
+#else
+  executeInstruction(instr);
+#endif
   ++m_ip;
 
   return !m_halted;
@@ -53,11 +138,36 @@ void VirtualMachine::run() {
   m_running = true;
   m_paused = false;
 
+#if NOVELMIND_VM_PROFILER
+  // The threaded loop has no per-instruction hook
+  const bool threaded =
+      m_dispatchMode == DispatchMode::Threaded && m_profiler == nullptr;
+#else
+  const bool threaded = m_dispatchMode == DispatchMode::Threaded;
+#endif
+  if (threaded) {
+    runThreaded();
+    return;
+  }
+
   while (m_running && !m_halted && !m_paused && !m_waiting) {
     step();
   }
 }
 
+void VirtualMachine::setProfiler(VMProfiler *profiler) {
+  if (profiler && !isProfilingAvailable()) {
+    NOVELMIND_LOG_WARN(
+        "VM profiler attached, but profiling is not compiled in "
+        "(NOVELMIND_ENABLE_VM_PROFILER)");
+  }
+  m_profiler = profiler;
+}
+
+bool VirtualMachine::isProfilingAvailable() {
+  return NOVELMIND_VM_PROFILER != 0;
+}
+
 void VirtualMachine::pause() { m_paused = true; }
 
 void VirtualMachine::resume() {
@@ -76,19 +186,33 @@ bool VirtualMachine::isWaiting() const { return m_waiting; }
 bool VirtualMachine::isHalted() const { return m_halted; }
 
 void VirtualMachine::setVariable(const std::string &name, Value value) {
-  m_variables[name] = std::move(value);
+  u32 slot = resolveVariableSlot(name);
+  m_variables[slot] = fromValue(value, m_strings);
+  m_variableAssigned[slot] = true;
 }
 
 Value VirtualMachine::getVariable(const std::string &name) const {
-  auto it = m_variables.find(name);
-  if (it != m_variables.end()) {
-    return it->second;
+  i32 slot = findVariableSlot(name);
+  if (slot >= 0) {
+    return toValue(m_variables[static_cast<usize>(slot)], m_strings);
   }
   return std::monostate{};
 }
 
 bool VirtualMachine::hasVariable(const std::string &name) const {
-  return m_variables.find(name) != m_variables.end();
+  i32 slot = findVariableSlot(name);
+  return slot >= 0 && m_variableAssigned[static_cast<usize>(slot)];
+}
+
+std::unordered_map<std::string, Value> VirtualMachine::getVariables() const {
+  std::unordered_map<std::string, Value> variables;
+  for (usize slot = 0; slot < m_variables.size(); ++slot) {
+    if (m_variableAssigned[slot]) {
+      variables[getVariableName(static_cast<u32>(slot))] =
+          toValue(m_variables[slot], m_strings);
+    }
+  }
+  return variables;
 }
 
 void VirtualMachine::setFlag(const std::string &name, bool value) {
@@ -103,25 +227,93 @@ bool VirtualMachine::getFlag(const std::string &name) const {
   return false;
 }
 
+void VirtualMachine::clearVariables() {
+  std::fill(m_variables.begin(), m_variables.end(), VMValue{});
+  std::fill(m_variableAssigned.begin(), m_variableAssigned.end(), false);
+}
+
+void VirtualMachine::clearFlags() { m_flags.clear(); }
+
+std::vector<Value> VirtualMachine::getStack() const {
+  std::vector<Value> stack;
+  stack.reserve(m_stack.size());
+  for (const auto &value : m_stack) {
+    stack.push_back(toValue(value, m_strings));
+  }
+  return stack;
+}
+
+Result<void> VirtualMachine::restoreExecution(u32 ip,
+                                              const std::vector<Value> &stack,
+                                              OpCode waitReason) {
+  if (!m_program || ip > m_program->size()) {
+    return Result<void>::error("Invalid instruction pointer: " +
+                               std::to_string(ip));
+  }
+  if (waitReason == OpCode::CHOICE && stack.empty()) {
+    return Result<void>::error("Pending choice without a result slot");
+  }
+
+  reset();
+  m_ip = ip;
+  m_stack.reserve(stack.size());
+  for (const auto &value : stack) {
+    m_stack.push_back(fromValue(value, m_strings));
+  }
+
+  if (waitReason == OpCode::CHOICE || waitReason == OpCode::SAY) {
+    m_waiting = true;
+    m_waitReason = waitReason;
+    if (waitReason == OpCode::CHOICE) {
+      m_choiceSlot = m_stack.size() - 1;
+    }
+  }
+  return Result<void>::ok();
+}
+
 void VirtualMachine::registerCallback(OpCode op, NativeCallback callback) {
-  m_callbacks[op] = std::move(callback);
+  if (!m_callbacks.set(op, std::move(callback))) {
+    NOVELMIND_LOG_WARN("Callback registered for a non-command opcode");
+  }
 }
 
 void VirtualMachine::signalContinue() {
-  m_waiting = false;
+  completeWait();
   if (m_running && !m_paused) {
     run();
   }
 }
 
 void VirtualMachine::signalChoice(i32 choice) {
-  m_choiceResult = choice;
-  m_waiting = false;
+  completeChoice(choice);
   if (m_running && !m_paused) {
     run();
   }
 }
 
+f32 VirtualMachine::getWaitDuration() const {
+  if (!m_waiting || m_waitReason != OpCode::WAIT) {
+    return 0.0f;
+  }
+  f32 seconds;
+  std::memcpy(&seconds, &m_waitOperand, sizeof(f32));
+  return seconds;
+}
+
+void VirtualMachine::completeWait() {
+  m_waiting = false;
+  m_waitReason = OpCode::NOP;
+}
+
+void VirtualMachine::completeChoice(i32 choice) {
+  m_choiceResult = choice;
+  if (m_choiceSlot < m_stack.size()) {
+    m_stack[m_choiceSlot] = VMValue::fromInt(choice);
+  }
+  m_choiceSlot = static_cast<usize>(-1);
+  completeWait();
+}
+
 void VirtualMachine::executeInstruction(const Instruction &instr) {
   switch (instr.opcode) {
   case OpCode::NOP:
@@ -136,38 +328,38 @@ void VirtualMachine::executeInstruction(const Instruction &instr) {
     break;
 
   case OpCode::JUMP_IF:
-    if (asBool(pop())) {
+    if (pop().asBool(m_strings)) {
       m_ip = instr.operand - 1;
     }
     break;
 
   case OpCode::JUMP_IF_NOT:
-    if (!asBool(pop())) {
+    if (!pop().asBool(m_strings)) {
       m_ip = instr.operand - 1;
     }
     break;
 
   case OpCode::PUSH_INT:
-    push(static_cast<i32>(instr.operand));
+    push(VMValue::fromInt(static_cast<i32>(instr.operand)));
     break;
 
   case OpCode::PUSH_FLOAT: {
     f32 val;
     std::memcpy(&val, &instr.operand, sizeof(f32));
-    push(val);
+    push(VMValue::fromFloat(val));
     break;
   }
 
   case OpCode::PUSH_STRING:
-    push(getString(instr.operand));
+    push(VMValue::fromString(getStringHandle(instr.operand)));
     break;
 
   case OpCode::PUSH_BOOL:
-    push(instr.operand != 0);
+    push(VMValue::fromBool(instr.operand != 0));
     break;
 
   case OpCode::PUSH_NULL:
-    push(std::monostate{});
+    push(VMValue::null());
     break;
 
   case OpCode::POP:
@@ -180,134 +372,110 @@ void VirtualMachine::executeInstruction(const Instruction &instr) {
     }
     break;
 
-  case OpCode::LOAD_VAR: {
-    const std::string &name = getString(instr.operand);
-    push(getVariable(name));
+  // LOAD_VAR/STORE_VAR are rewritten to slot opcodes by VMProgram::link(),
+  // which also guarantees the operand is a valid slot.
+  case OpCode::LOAD_SLOT:
+    push(m_variables[instr.operand]);
     break;
-  }
 
-  case OpCode::STORE_VAR: {
-    const std::string &name = getString(instr.operand);
-    setVariable(name, pop());
+  case OpCode::STORE_SLOT:
+    m_variables[instr.operand] = pop();
+    m_variableAssigned[instr.operand] = true;
     break;
-  }
 
   case OpCode::ADD: {
-    Value b = pop();
-    Value a = pop();
-    if (getValueType(a) == ValueType::String ||
-        getValueType(b) == ValueType::String) {
-      push(asString(a) + asString(b));
-    } else if (getValueType(a) == ValueType::Float ||
-               getValueType(b) == ValueType::Float) {
-      push(asFloat(a) + asFloat(b));
-    } else {
-      push(asInt(a) + asInt(b));
-    }
+    VMValue b = pop();
+    VMValue a = pop();
+    push(addValues(a, b, m_strings));
+    collectStrings();
     break;
   }
 
   case OpCode::SUB: {
-    Value b = pop();
-    Value a = pop();
-    if (getValueType(a) == ValueType::Float ||
-        getValueType(b) == ValueType::Float) {
-      push(asFloat(a) - asFloat(b));
-    } else {
-      push(asInt(a) - asInt(b));
-    }
+    VMValue b = pop();
+    VMValue a = pop();
+    push(subValues(a, b));
     break;
   }
 
   case OpCode::MUL: {
-    Value b = pop();
-    Value a = pop();
-    if (getValueType(a) == ValueType::Float ||
-        getValueType(b) == ValueType::Float) {
-      push(asFloat(a) * asFloat(b));
-    } else {
-      push(asInt(a) * asInt(b));
-    }
+    VMValue b = pop();
+    VMValue a = pop();
+    push(mulValues(a, b));
     break;
   }
 
   case OpCode::DIV: {
-    Value b = pop();
-    Value a = pop();
-    f32 divisor = asFloat(b);
-    if (divisor != 0.0f) {
-      push(asFloat(a) / divisor);
-    } else {
-      NOVELMIND_LOG_ERROR("Division by zero");
-      push(0);
-    }
+    VMValue b = pop();
+    VMValue a = pop();
+    push(divValues(a, b));
     break;
   }
 
   case OpCode::EQ: {
-    Value b = pop();
-    Value a = pop();
-    push(asString(a) == asString(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(valuesEqual(a, b, m_strings)));
     break;
   }
 
   case OpCode::NE: {
-    Value b = pop();
-    Value a = pop();
-    push(asString(a) != asString(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(!valuesEqual(a, b, m_strings)));
     break;
   }
 
   case OpCode::LT: {
-    Value b = pop();
-    Value a = pop();
-    push(asFloat(a) < asFloat(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(a.asFloat() < b.asFloat()));
     break;
   }
 
   case OpCode::LE: {
-    Value b = pop();
-    Value a = pop();
-    push(asFloat(a) <= asFloat(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(a.asFloat() <= b.asFloat()));
     break;
   }
 
   case OpCode::GT: {
-    Value b = pop();
-    Value a = pop();
-    push(asFloat(a) > asFloat(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(a.asFloat() > b.asFloat()));
     break;
   }
 
   case OpCode::GE: {
-    Value b = pop();
-    Value a = pop();
-    push(asFloat(a) >= asFloat(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(a.asFloat() >= b.asFloat()));
     break;
   }
 
   case OpCode::AND: {
-    Value b = pop();
-    Value a = pop();
-    push(asBool(a) && asBool(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(a.asBool(m_strings) && b.asBool(m_strings)));
     break;
   }
 
   case OpCode::OR: {
-    Value b = pop();
-    Value a = pop();
-    push(asBool(a) || asBool(b));
+    VMValue b = pop();
+    VMValue a = pop();
+    push(VMValue::fromBool(a.asBool(m_strings) || b.asBool(m_strings)));
     break;
   }
 
   case OpCode::NOT: {
-    Value a = pop();
-    push(!asBool(a));
+    VMValue a = pop();
+    push(VMValue::fromBool(!a.asBool(m_strings)));
     break;
   }
 
   case OpCode::SET_FLAG: {
-    bool value = asBool(pop());
+    bool value = pop().asBool(m_strings);
     const std::string &name = getString(instr.operand);
     setFlag(name, value);
     break;
@@ -315,10 +483,39 @@ void VirtualMachine::executeInstruction(const Instruction &instr) {
 
   case OpCode::CHECK_FLAG: {
     const std::string &name = getString(instr.operand);
-    push(getFlag(name));
+    push(VMValue::fromBool(getFlag(name)));
+    break;
+  }
+
+  case OpCode::CMP_JUMP_IF_NOT: {
+    VMValue b = pop();
+    VMValue a = pop();
+    if (!compareValues(unpackCompareOp(instr.operand), a, b, m_strings)) {
+      m_ip = unpackCompareValue(instr.operand) - 1;
+    }
+    break;
+  }
+
+  // load() guarantees the two EXTRA_ARG words follow: constant, then target
+  case OpCode::SLOT_CMP_INT_JUMP_IF_NOT: {
+    const VMValue &a = m_variables[unpackCompareValue(instr.operand)];
+    const auto &program = m_program->getInstructions();
+    VMValue b = VMValue::fromInt(static_cast<i32>(program[m_ip + 1].operand));
+    if (!compareValues(unpackCompareOp(instr.operand), a, b, m_strings)) {
+      m_ip = program[m_ip + 2].operand - 1;
+    } else {
+      m_ip += 2;
+    }
     break;
   }
 
+  case OpCode::INC_SLOT:
+    m_variables[instr.operand] =
+        addValues(m_variables[instr.operand], VMValue::fromInt(1), m_strings);
+    m_variableAssigned[instr.operand] = true;
+    collectStrings();
+    break;
+
   case OpCode::SAY:
   case OpCode::SHOW_BACKGROUND:
   case OpCode::SHOW_CHARACTER:
@@ -329,47 +526,536 @@ void VirtualMachine::executeInstruction(const Instruction &instr) {
   case OpCode::STOP_MUSIC:
   case OpCode::WAIT:
   case OpCode::TRANSITION:
-  case OpCode::GOTO_SCENE: {
-    auto it = m_callbacks.find(instr.opcode);
-    if (it != m_callbacks.end()) {
-      std::vector<Value> args;
-      // Collect args from stack if needed
-      it->second(args);
+    invokeCallback(instr.opcode, instr.operand);
+    break;
+
+  // The callback sees the transition first; control then continues at the
+  // target scene's entry point, as a choice `goto` does
+  case OpCode::GOTO_SCENE:
+    invokeCallback(instr.opcode, instr.operand);
+    m_ip = instr.operand - 1;
+    break;
+
+  default:
+    NOVELMIND_LOG_WARN("Unknown opcode");
+    break;
+  }
+}
+
+void VirtualMachine::invokeCallback(OpCode op, u32 operand) {
+  // Arguments are always taken off the stack so it stays balanced when no
+  // callback is installed
+  NativeArgs args = collectArgs(op, operand);
+  if (const NativeCallback *callback = m_callbacks.find(op)) {
+    (*callback)(args);
+  }
+
+  // These commands typically wait for user input
+  if (op == OpCode::SAY || op == OpCode::CHOICE || op == OpCode::WAIT) {
+    m_waiting = true;
+    m_waitReason = op;
+    m_waitOperand = operand;
+  }
+}
+
+#if NOVELMIND_VM_COMPUTED_GOTO
+// Labels-as-values is a GNU extension
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+void VirtualMachine::runThreaded() {
+#if NOVELMIND_VM_COMPUTED_GOTO
+  static const void *const targets[] = {
+      &&op_nop,       &&op_halt,      &&op_jump,        &&op_jump_if,
+      &&op_jump_if_not, &&op_push_int, &&op_push_float, &&op_push_string,
+      &&op_push_bool, &&op_push_null, &&op_pop,         &&op_dup,
+      &&op_load_slot, &&op_store_slot, &&op_add,        &&op_sub,
+      &&op_mul,       &&op_div,       &&op_eq,          &&op_ne,
+      &&op_lt,        &&op_le,        &&op_gt,          &&op_ge,
+      &&op_and,       &&op_or,        &&op_not,         &&op_set_flag,
+      &&op_check_flag, &&op_cmp_jump_if_not, &&op_slot_cmp_int_jump_if_not,
+      &&op_inc_slot,  &&op_callback,  &&op_unknown,     &&op_end};
+  static_assert(sizeof(targets) / sizeof(targets[0]) ==
+                    static_cast<usize>(ThreadedHandler::End) + 1,
+                "Label table out of sync with ThreadedHandler");
+#define VM_DISPATCH() goto *targets[code[ip].handler]
+#else
+#define VM_DISPATCH() goto dispatch
+#endif
+#define VM_NEXT()                                                              \
+  do {                                                                         \
+    ++ip;                                                                      \
+    VM_DISPATCH();                                                             \
+  } while (0)
+#define VM_JUMP(target)                                                        \
+  do {                                                                         \
+    ip = (target);                                                             \
+    VM_DISPATCH();                                                             \
+  } while (0)
+
+  if (m_halted || m_paused || m_waiting) {
+    return;
+  }
+
+  if (!m_program) {
+    m_halted = true;
+    return;
+  }
+
+  // Raw pointers are safe until a callback loads another program, which the
+  // callback handler checks for
+  const VMProgram *program = m_program.get();
+  const ThreadedInstruction *code = program->getThreaded().data();
+  const u32 size = program->size();
+  u32 ip = std::min(m_ip, size);
+
+  VM_DISPATCH();
+
+#if !NOVELMIND_VM_COMPUTED_GOTO
+dispatch:
+  switch (static_cast<ThreadedHandler>(code[ip].handler)) {
+  case ThreadedHandler::Nop:
+    goto op_nop;
+  case ThreadedHandler::Halt:
+    goto op_halt;
+  case ThreadedHandler::Jump:
+    goto op_jump;
+  case ThreadedHandler::JumpIf:
+    goto op_jump_if;
+  case ThreadedHandler::JumpIfNot:
+    goto op_jump_if_not;
+  case ThreadedHandler::PushInt:
+    goto op_push_int;
+  case ThreadedHandler::PushFloat:
+    goto op_push_float;
+  case ThreadedHandler::PushString:
+    goto op_push_string;
+  case ThreadedHandler::PushBool:
+    goto op_push_bool;
+  case ThreadedHandler::PushNull:
+    goto op_push_null;
+  case ThreadedHandler::Pop:
+    goto op_pop;
+  case ThreadedHandler::Dup:
+    goto op_dup;
+  case ThreadedHandler::LoadSlot:
+    goto op_load_slot;
+  case ThreadedHandler::StoreSlot:
+    goto op_store_slot;
+  case ThreadedHandler::Add:
+    goto op_add;
+  case ThreadedHandler::Sub:
+    goto op_sub;
+  case ThreadedHandler::Mul:
+    goto op_mul;
+  case ThreadedHandler::Div:
+    goto op_div;
+  case ThreadedHandler::Eq:
+    goto op_eq;
+  case ThreadedHandler::Ne:
+    goto op_ne;
+  case ThreadedHandler::Lt:
+    goto op_lt;
+  case ThreadedHandler::Le:
+    goto op_le;
+  case ThreadedHandler::Gt:
+    goto op_gt;
+  case ThreadedHandler::Ge:
+    goto op_ge;
+  case ThreadedHandler::And:
+    goto op_and;
+  case ThreadedHandler::Or:
+    goto op_or;
+  case ThreadedHandler::Not:
+    goto op_not;
+  case ThreadedHandler::SetFlag:
+    goto op_set_flag;
+  case ThreadedHandler::CheckFlag:
+    goto op_check_flag;
+  case ThreadedHandler::CmpJumpIfNot:
+    goto op_cmp_jump_if_not;
+  case ThreadedHandler::SlotCmpIntJumpIfNot:
+    goto op_slot_cmp_int_jump_if_not;
+  case ThreadedHandler::IncSlot:
+    goto op_inc_slot;
+  case ThreadedHandler::Callback:
+    goto op_callback;
+  case ThreadedHandler::Unknown:
+    goto op_unknown;
+  case ThreadedHandler::End:
+    goto op_end;
+  }
+  goto op_unknown;
+#endif
+
+op_nop:
+  VM_NEXT();
+
+op_halt:
+  m_halted = true;
+  m_ip = ip + 1;
+  return;
+
+op_end:
+  m_halted = true;
+  m_ip = ip;
+  return;
+
+op_jump:
+  VM_JUMP(code[ip].operand);
+
+op_jump_if:
+  if (pop().asBool(m_strings)) {
+    VM_JUMP(code[ip].operand);
+  }
+  VM_NEXT();
+
+op_jump_if_not:
+  if (!pop().asBool(m_strings)) {
+    VM_JUMP(code[ip].operand);
+  }
+  VM_NEXT();
+
+op_push_int:
+  push(VMValue::fromInt(static_cast<i32>(code[ip].operand)));
+  VM_NEXT();
+
+op_push_float: {
+  f32 val;
+  std::memcpy(&val, &code[ip].operand, sizeof(f32));
+  push(VMValue::fromFloat(val));
+}
+  VM_NEXT();
+
+op_push_string:
+  push(VMValue::fromString(code[ip].operand)); // Decoded to a pool handle
+  VM_NEXT();
+
+op_push_bool:
+  push(VMValue::fromBool(code[ip].operand != 0));
+  VM_NEXT();
+
+op_push_null:
+  push(VMValue::null());
+  VM_NEXT();
+
+op_pop:
+  pop();
+  VM_NEXT();
+
+op_dup:
+  if (!m_stack.empty()) {
+    push(m_stack.back());
+  }
+  VM_NEXT();
+
+op_load_slot:
+  push(m_variables[code[ip].operand]);
+  VM_NEXT();
+
+op_store_slot:
+  m_variables[code[ip].operand] = pop();
+  m_variableAssigned[code[ip].operand] = true;
+  VM_NEXT();
+
+op_add: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(addValues(a, b, m_strings));
+  collectStrings();
+}
+  VM_NEXT();
+
+op_sub: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(subValues(a, b));
+}
+  VM_NEXT();
+
+op_mul: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(mulValues(a, b));
+}
+  VM_NEXT();
+
+op_div: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(divValues(a, b));
+}
+  VM_NEXT();
+
+op_eq: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(valuesEqual(a, b, m_strings)));
+}
+  VM_NEXT();
+
+op_ne: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(!valuesEqual(a, b, m_strings)));
+}
+  VM_NEXT();
+
+op_lt: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(a.asFloat() < b.asFloat()));
+}
+  VM_NEXT();
+
+op_le: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(a.asFloat() <= b.asFloat()));
+}
+  VM_NEXT();
+
+op_gt: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(a.asFloat() > b.asFloat()));
+}
+  VM_NEXT();
+
+op_ge: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(a.asFloat() >= b.asFloat()));
+}
+  VM_NEXT();
+
+op_and: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(a.asBool(m_strings) && b.asBool(m_strings)));
+}
+  VM_NEXT();
+
+op_or: {
+  VMValue b = pop();
+  VMValue a = pop();
+  push(VMValue::fromBool(a.asBool(m_strings) || b.asBool(m_strings)));
+}
+  VM_NEXT();
+
+op_not:
+  push(VMValue::fromBool(!pop().asBool(m_strings)));
+  VM_NEXT();
+
+op_set_flag: {
+  bool value = pop().asBool(m_strings);
+  setFlag(getString(code[ip].operand), value);
+}
+  VM_NEXT();
+
+op_check_flag:
+  push(VMValue::fromBool(getFlag(getString(code[ip].operand))));
+  VM_NEXT();
+
+op_cmp_jump_if_not: {
+  VMValue b = pop();
+  VMValue a = pop();
+  if (!compareValues(static_cast<CompareOp>(code[ip].compare), a, b,
+                     m_strings)) {
+    VM_JUMP(code[ip].operand);
+  }
+}
+  VM_NEXT();
+
+op_slot_cmp_int_jump_if_not:
+  if (!compareValues(static_cast<CompareOp>(code[ip].compare),
+                     m_variables[code[ip].operand],
+                     VMValue::fromInt(static_cast<i32>(code[ip + 1].operand)),
+                     m_strings)) {
+    VM_JUMP(code[ip + 2].operand);
+  }
+  VM_JUMP(ip + 3);
+
+op_inc_slot:
+  m_variables[code[ip].operand] = addValues(
+      m_variables[code[ip].operand], VMValue::fromInt(1), m_strings);
+  m_variableAssigned[code[ip].operand] = true;
+  collectStrings();
+  VM_NEXT();
+
+op_unknown:
+  NOVELMIND_LOG_WARN("Unknown opcode");
+  VM_NEXT();
+
+op_callback:
+  // The only point besides HALT where run state can change: callbacks may
+  // pause, reset or reload the VM, so resync from the members afterwards.
+  {
+    // The callback may free the program, so copy the instruction first
+    const ThreadedInstruction instr = code[ip];
+    m_ip = ip;
+    invokeCallback(instr.opcode, instr.operand);
+    m_ip = instr.opcode == OpCode::GOTO_SCENE ? instr.operand : m_ip + 1;
+  }
+  if (!m_running || m_halted || m_paused || m_waiting) {
+    return;
+  }
+  if (m_program.get() != program) {
+    runThreaded();
+    return;
+  }
+  ip = std::min(m_ip, size);
+  VM_DISPATCH();
+
+#undef VM_JUMP
+#undef VM_NEXT
+#undef VM_DISPATCH
+}
+
+#if NOVELMIND_VM_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+Value &VirtualMachine::scratchArg(usize index) {
+  if (index >= m_callbackArgs.size()) {
+    m_callbackArgs.resize(index + 1);
+  }
+  return m_callbackArgs[index];
+}
+
+NativeArgs VirtualMachine::collectArgs(OpCode op, u32 operand) {
+  usize count = 0;
+  auto add = [this, &count](const VMValue &value) {
+    assignValue(scratchArg(count++), value, m_strings);
+  };
+  auto addString = [this, &add](u32 index) {
+    add(VMValue::fromString(getStringHandle(index)));
+  };
+
+  switch (op) {
+  case OpCode::SHOW_BACKGROUND:
+  case OpCode::HIDE_CHARACTER:
+  case OpCode::PLAY_SOUND:
+  case OpCode::PLAY_MUSIC:
+    addString(operand);
+    break;
+
+  case OpCode::SHOW_CHARACTER: {
+    VMValue position = pop();
+    VMValue id = pop();
+    add(id);
+    add(position);
+    break;
+  }
+
+  case OpCode::SAY: {
+    VMValue speaker = pop();
+    addString(operand);
+    add(speaker);
+    break;
+  }
+
+  case OpCode::CHOICE: {
+    // The stack holds the option count followed by `operand` texts; they
+    // are replaced by the selection, filled in by signalChoice()
+    usize taken = std::min<usize>(static_cast<usize>(operand) + 1,
+                                  m_stack.size());
+    usize base = m_stack.size() - taken;
+    for (usize i = base; i < m_stack.size(); ++i) {
+      add(m_stack[i]);
     }
+    m_stack.resize(base);
+    push(VMValue::fromInt(-1));
+    m_choiceSlot = base;
+    break;
+  }
 
-    // These commands typically wait for user input
-    if (instr.opcode == OpCode::SAY || instr.opcode == OpCode::CHOICE ||
-        instr.opcode == OpCode::WAIT) {
-      m_waiting = true;
+  case OpCode::STOP_MUSIC:
+    // Operand is set when the compiler pushed a fade duration
+    if (operand != 0) {
+      add(pop());
     }
     break;
+
+  case OpCode::WAIT:
+  case OpCode::GOTO_SCENE:
+    add(VMValue::fromInt(static_cast<i32>(operand)));
+    break;
+
+  case OpCode::TRANSITION: {
+    VMValue duration = pop();
+    addString(operand);
+    add(duration);
+    break;
   }
 
   default:
-    NOVELMIND_LOG_WARN("Unknown opcode");
     break;
   }
+
+  return NativeArgs(m_callbackArgs.data(), count);
 }
 
-void VirtualMachine::push(Value value) { m_stack.push_back(std::move(value)); }
+void VirtualMachine::push(VMValue value) { m_stack.push_back(value); }
+
+void VirtualMachine::collectStrings() {
+  if (m_strings.shouldCollect()) {
+    m_strings.collect({m_stack, m_variables});
+  }
+}
 
-Value VirtualMachine::pop() {
+VMValue VirtualMachine::pop() {
   if (m_stack.empty()) {
     NOVELMIND_LOG_WARN("Stack underflow");
-    return std::monostate{};
+    return VMValue::null();
   }
-  Value val = std::move(m_stack.back());
+  VMValue val = m_stack.back();
   m_stack.pop_back();
   return val;
 }
 
 const std::string &VirtualMachine::getString(u32 index) const {
-  static const std::string empty;
-  if (index < m_stringTable.size()) {
-    return m_stringTable[index];
+  return m_program->getString(index);
+}
+
+u32 VirtualMachine::getStringHandle(u32 index) const {
+  return m_program->getStringHandle(index);
+}
+
+i32 VirtualMachine::findVariableSlot(const std::string &name) const {
+  if (m_program) {
+    i32 slot = m_program->findVariableSlot(name);
+    if (slot >= 0) {
+      return slot;
+    }
   }
-  NOVELMIND_LOG_WARN("Invalid string index");
-  return empty;
+  auto it = m_localVariableSlots.find(name);
+  return it != m_localVariableSlots.end() ? static_cast<i32>(it->second) : -1;
+}
+
+const std::string &VirtualMachine::getVariableName(u32 slot) const {
+  const usize programSlots =
+      m_program ? m_program->getVariableNames().size() : 0;
+  if (slot < programSlots) {
+    return m_program->getVariableNames()[slot];
+  }
+  return m_localVariableNames[slot - programSlots];
+}
+
+u32 VirtualMachine::resolveVariableSlot(const std::string &name) {
+  i32 existing = findVariableSlot(name);
+  if (existing >= 0) {
+    return static_cast<u32>(existing);
+  }
+
+  // Variables the program never touches, set by the host
+  u32 slot = static_cast<u32>(m_variables.size());
+  m_localVariableSlots.emplace(name, slot);
+  m_localVariableNames.push_back(name);
+  m_variables.emplace_back();
+  m_variableAssigned.push_back(false);
+  return slot;
 }
 
 } // namespace NovelMind::scripting
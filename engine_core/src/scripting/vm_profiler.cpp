@@ -0,0 +1,165 @@
+#include "NovelMind/scripting/vm_profiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+bool hotterThan(const ExecutionCounter &a, const ExecutionCounter &b) {
+  if (a.nanoseconds != b.nanoseconds) {
+    return a.nanoseconds > b.nanoseconds;
+  }
+  return a.count > b.count;
+}
+
+void writeEvent(std::ofstream &file, bool &first, const std::string &name,
+                const char *track, f64 &cursorUs,
+                const ExecutionCounter &counter) {
+  if (!first) {
+    file << ",\n";
+  }
+  first = false;
+
+  // Chrome traces accept fractional microseconds; keep sub-µs opcodes
+  // visible instead of rounding them to zero
+  const f64 durationUs = static_cast<f64>(counter.nanoseconds) / 1000.0;
+  file << "{";
+  file << "\"name\":\"" << name << "\",";
+  file << "\"cat\":\"script\",";
+  file << "\"ph\":\"X\",";
+  file << "\"ts\":" << cursorUs << ",";
+  file << "\"dur\":" << durationUs << ",";
+  file << "\"pid\":1,";
+  file << "\"tid\":\"" << track << "\",";
+  file << "\"args\":{\"count\":" << counter.count << "}";
+  file << "}";
+
+  cursorUs += durationUs;
+}
+
+} // namespace
+
+void VMProfiler::reset() {
+  m_opcodes.fill({});
+  m_instructions.clear();
+}
+
+ExecutionCounter VMProfiler::getInstruction(u32 instruction) const {
+  if (instruction < m_instructions.size()) {
+    return m_instructions[instruction].counter;
+  }
+  return {};
+}
+
+ExecutionCounter VMProfiler::getTotal() const {
+  ExecutionCounter total;
+  for (const auto &opcode : m_opcodes) {
+    total.count += opcode.count;
+    total.nanoseconds += opcode.nanoseconds;
+  }
+  return total;
+}
+
+std::vector<HotSpot>
+VMProfiler::getHotSpots(const std::vector<LineTableEntry> &lineTable,
+                        usize limit) const {
+  std::vector<HotSpot> spots;
+  for (u32 i = 0; i < m_instructions.size(); ++i) {
+    const auto &profile = m_instructions[i];
+    if (profile.counter.count == 0) {
+      continue;
+    }
+    HotSpot spot;
+    spot.instruction = i;
+    spot.opcode = profile.opcode;
+    spot.counter = profile.counter;
+    if (const SourceLocation *loc = findSourceLocation(lineTable, i)) {
+      spot.location = *loc;
+    }
+    spots.push_back(spot);
+  }
+
+  std::stable_sort(spots.begin(), spots.end(),
+                   [](const HotSpot &a, const HotSpot &b) {
+                     return hotterThan(a.counter, b.counter);
+                   });
+  if (limit > 0 && spots.size() > limit) {
+    spots.resize(limit);
+  }
+  return spots;
+}
+
+std::vector<SourceLineProfile>
+VMProfiler::getSourceLines(const std::vector<LineTableEntry> &lineTable) const {
+  std::map<std::pair<u32, u32>, ExecutionCounter> byLocation;
+  for (u32 i = 0; i < m_instructions.size(); ++i) {
+    const auto &counter = m_instructions[i].counter;
+    if (counter.count == 0) {
+      continue;
+    }
+    const SourceLocation *loc = findSourceLocation(lineTable, i);
+    if (!loc) {
+      continue;
+    }
+    auto &total = byLocation[{loc->line, loc->column}];
+    total.count += counter.count;
+    total.nanoseconds += counter.nanoseconds;
+  }
+
+  std::vector<SourceLineProfile> lines;
+  lines.reserve(byLocation.size());
+  for (const auto &[key, counter] : byLocation) {
+    lines.push_back({SourceLocation(key.first, key.second), counter});
+  }
+  std::stable_sort(lines.begin(), lines.end(),
+                   [](const SourceLineProfile &a, const SourceLineProfile &b) {
+                     return hotterThan(a.counter, b.counter);
+                   });
+  return lines;
+}
+
+bool VMProfiler::exportToChromeTrace(
+    const std::string &filename,
+    const std::vector<LineTableEntry> &lineTable) const {
+  std::ofstream file(filename);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\":[\n";
+
+  bool first = true;
+
+  std::vector<std::pair<OpCode, ExecutionCounter>> opcodes;
+  for (usize op = 0; op < m_opcodes.size(); ++op) {
+    if (m_opcodes[op].count > 0) {
+      opcodes.emplace_back(static_cast<OpCode>(op), m_opcodes[op]);
+    }
+  }
+  std::stable_sort(opcodes.begin(), opcodes.end(),
+                   [](const auto &a, const auto &b) {
+                     return hotterThan(a.second, b.second);
+                   });
+  f64 cursorUs = 0.0;
+  for (const auto &[op, counter] : opcodes) {
+    writeEvent(file, first, opcodeName(op), "opcodes", cursorUs, counter);
+  }
+
+  cursorUs = 0.0;
+  for (const auto &line : getSourceLines(lineTable)) {
+    writeEvent(file, first,
+               "line " + std::to_string(line.location.line) + ":" +
+                   std::to_string(line.location.column),
+               "source lines", cursorUs, line.counter);
+  }
+
+  file << "\n]}\n";
+
+  return true;
+}
+
+} // namespace NovelMind::scripting
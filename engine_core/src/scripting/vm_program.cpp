@@ -0,0 +1,334 @@
+#include "NovelMind/scripting/vm_program.hpp"
+#include "NovelMind/core/logger.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace NovelMind::scripting {
+
+namespace {
+
+ThreadedHandler handlerFor(OpCode op) {
+  switch (op) {
+  case OpCode::NOP:
+    return ThreadedHandler::Nop;
+  case OpCode::HALT:
+    return ThreadedHandler::Halt;
+  case OpCode::JUMP:
+    return ThreadedHandler::Jump;
+  case OpCode::JUMP_IF:
+    return ThreadedHandler::JumpIf;
+  case OpCode::JUMP_IF_NOT:
+    return ThreadedHandler::JumpIfNot;
+  case OpCode::PUSH_INT:
+    return ThreadedHandler::PushInt;
+  case OpCode::PUSH_FLOAT:
+    return ThreadedHandler::PushFloat;
+  case OpCode::PUSH_STRING:
+    return ThreadedHandler::PushString;
+  case OpCode::PUSH_BOOL:
+    return ThreadedHandler::PushBool;
+  case OpCode::PUSH_NULL:
+    return ThreadedHandler::PushNull;
+  case OpCode::POP:
+    return ThreadedHandler::Pop;
+  case OpCode::DUP:
+    return ThreadedHandler::Dup;
+  case OpCode::LOAD_SLOT:
+    return ThreadedHandler::LoadSlot;
+  case OpCode::STORE_SLOT:
+    return ThreadedHandler::StoreSlot;
+  case OpCode::ADD:
+    return ThreadedHandler::Add;
+  case OpCode::SUB:
+    return ThreadedHandler::Sub;
+  case OpCode::MUL:
+    return ThreadedHandler::Mul;
+  case OpCode::DIV:
+    return ThreadedHandler::Div;
+  case OpCode::EQ:
+    return ThreadedHandler::Eq;
+  case OpCode::NE:
+    return ThreadedHandler::Ne;
+  case OpCode::LT:
+    return ThreadedHandler::Lt;
+  case OpCode::LE:
+    return ThreadedHandler::Le;
+  case OpCode::GT:
+    return ThreadedHandler::Gt;
+  case OpCode::GE:
+    return ThreadedHandler::Ge;
+  case OpCode::AND:
+    return ThreadedHandler::And;
+  case OpCode::OR:
+    return ThreadedHandler::Or;
+  case OpCode::NOT:
+    return ThreadedHandler::Not;
+  case OpCode::SET_FLAG:
+    return ThreadedHandler::SetFlag;
+  case OpCode::CHECK_FLAG:
+    return ThreadedHandler::CheckFlag;
+  case OpCode::CMP_JUMP_IF_NOT:
+    return ThreadedHandler::CmpJumpIfNot;
+  case OpCode::SLOT_CMP_INT_JUMP_IF_NOT:
+    return ThreadedHandler::SlotCmpIntJumpIfNot;
+  case OpCode::INC_SLOT:
+    return ThreadedHandler::IncSlot;
+  case OpCode::SAY:
+  case OpCode::SHOW_BACKGROUND:
+  case OpCode::SHOW_CHARACTER:
+  case OpCode::HIDE_CHARACTER:
+  case OpCode::CHOICE:
+  case OpCode::PLAY_SOUND:
+  case OpCode::PLAY_MUSIC:
+  case OpCode::STOP_MUSIC:
+  case OpCode::WAIT:
+  case OpCode::TRANSITION:
+  case OpCode::GOTO_SCENE:
+    return ThreadedHandler::Callback;
+  default:
+    return ThreadedHandler::Unknown;
+  }
+}
+
+} // namespace
+
+Result<VMProgramPtr>
+VMProgram::create(std::vector<Instruction> instructions,
+                  std::vector<std::string> stringTable,
+                  const std::vector<std::string> &variableSlots) {
+  if (instructions.empty()) {
+    return Result<VMProgramPtr>::error("Empty program");
+  }
+
+  // Private constructor, so no make_shared
+  std::shared_ptr<VMProgram> program(new VMProgram());
+  program->m_instructions = std::move(instructions);
+  program->m_code = program->m_instructions;
+  program->m_stringTable = std::move(stringTable);
+
+  auto linkResult = program->link(variableSlots);
+  if (linkResult.isError()) {
+    return Result<VMProgramPtr>::error(linkResult.error());
+  }
+  std::call_once(program->m_decoded, [&] { program->decode(); });
+
+  return Result<VMProgramPtr>::ok(std::move(program));
+}
+
+Result<VMProgramPtr> VMProgram::create(ScriptImagePtr image) {
+  if (!image || image->getInstructions().empty()) {
+    return Result<VMProgramPtr>::error("Empty program");
+  }
+
+  std::shared_ptr<VMProgram> program(new VMProgram());
+  program->m_code = image->getInstructions();
+  program->m_stringTable.reserve(image->getStringCount());
+  for (u32 i = 0; i < image->getStringCount(); ++i) {
+    program->m_stringTable.emplace_back(image->getString(i));
+  }
+  program->internStrings();
+
+  // Images are linked when written; every slot operand is checked as its
+  // scene is loaded
+  for (u32 slot = 0; slot < image->getVariableSlotCount(); ++slot) {
+    const std::string name(image->getVariableSlot(slot));
+    if (program->resolveVariableSlot(name) != slot) {
+      return Result<VMProgramPtr>::error("Duplicate variable slot: " + name);
+    }
+  }
+  program->m_image = std::move(image);
+
+  return Result<VMProgramPtr>::ok(std::move(program));
+}
+
+Result<InstructionRange> VMProgram::loadRange(u32 ip) const {
+  if (!m_image) {
+    return Result<InstructionRange>::ok({0, size()});
+  }
+
+  auto scene = m_image->findSceneAt(ip);
+  if (!scene) {
+    // Code ahead of the first scene is validated when the image is opened
+    const u32 end =
+        m_image->getSceneCount() > 0 ? m_image->getScene(0).entry : size();
+    return Result<InstructionRange>::ok({0, end});
+  }
+  auto loaded = m_image->loadScene(*scene);
+  if (loaded.isError()) {
+    return Result<InstructionRange>::error(loaded.error());
+  }
+  const ImageScene range = m_image->getScene(*scene);
+  return Result<InstructionRange>::ok({range.entry, range.end});
+}
+
+const std::vector<ThreadedInstruction> &VMProgram::getThreaded() const {
+  std::call_once(m_decoded, [this] { decode(); });
+  return m_threaded;
+}
+
+const std::string &VMProgram::getString(u32 index) const {
+  static const std::string empty;
+  if (index < m_stringTable.size()) {
+    return m_stringTable[index];
+  }
+  NOVELMIND_LOG_WARN("Invalid string index");
+  return empty;
+}
+
+u32 VMProgram::getStringHandle(u32 index) const {
+  if (index < m_stringHandles.size()) {
+    return m_stringHandles[index];
+  }
+  NOVELMIND_LOG_WARN("Invalid string index");
+  return 0;
+}
+
+i32 VMProgram::findVariableSlot(const std::string &name) const {
+  auto it = m_variableSlots.find(name);
+  return it != m_variableSlots.end() ? static_cast<i32>(it->second) : -1;
+}
+
+Result<void> VMProgram::link(const std::vector<std::string> &variableSlots) {
+  std::unordered_set<std::string> programSlots;
+  for (const auto &name : variableSlots) {
+    if (!programSlots.insert(name).second) {
+      return Result<void>::error("Duplicate variable slot: " + name);
+    }
+  }
+
+  internStrings();
+
+  for (const auto &name : variableSlots) {
+    resolveVariableSlot(name);
+  }
+
+  for (auto &instr : m_instructions) {
+    switch (instr.opcode) {
+    case OpCode::LOAD_VAR:
+    case OpCode::LOAD_GLOBAL:
+      instr = Instruction(OpCode::LOAD_SLOT,
+                          resolveVariableSlot(getString(instr.operand)));
+      break;
+    case OpCode::STORE_VAR:
+    case OpCode::STORE_GLOBAL:
+      instr = Instruction(OpCode::STORE_SLOT,
+                          resolveVariableSlot(getString(instr.operand)));
+      break;
+    default:
+      break;
+    }
+  }
+
+  for (usize i = 0; i < m_instructions.size(); ++i) {
+    const auto &instr = m_instructions[i];
+    u32 slot = 0;
+    switch (instr.opcode) {
+    case OpCode::LOAD_SLOT:
+    case OpCode::STORE_SLOT:
+    case OpCode::INC_SLOT:
+      slot = instr.operand;
+      break;
+    case OpCode::SLOT_CMP_INT_JUMP_IF_NOT:
+      if (i + 2 >= m_instructions.size() ||
+          m_instructions[i + 1].opcode != OpCode::EXTRA_ARG ||
+          m_instructions[i + 2].opcode != OpCode::EXTRA_ARG) {
+        return Result<void>::error("Truncated superinstruction at " +
+                                   std::to_string(i));
+      }
+      slot = unpackCompareValue(instr.operand);
+      break;
+    default:
+      continue;
+    }
+    if (slot >= m_variableNames.size()) {
+      return Result<void>::error("Invalid variable slot: " +
+                                 std::to_string(slot));
+    }
+  }
+
+  return Result<void>::ok();
+}
+
+void VMProgram::internStrings() {
+  auto strings = std::make_shared<StringPool>();
+  m_stringHandles.reserve(m_stringTable.size());
+  for (const auto &str : m_stringTable) {
+    m_stringHandles.push_back(strings->intern(str));
+  }
+  m_strings = std::move(strings);
+}
+
+void VMProgram::decode() const {
+  const u32 count = size();
+  m_threaded.clear();
+  m_threaded.reserve(m_code.size() + 1);
+  for (const auto &instr : m_code) {
+    ThreadedInstruction decoded{};
+    decoded.handler = static_cast<u8>(handlerFor(instr.opcode));
+    decoded.opcode = instr.opcode;
+    decoded.operand = instr.operand;
+    // Jumps past the end land on the sentinel instead of being range
+    // checked on every dispatch
+    switch (instr.opcode) {
+    case OpCode::PUSH_STRING:
+      decoded.operand = getStringHandle(instr.operand);
+      break;
+    case OpCode::JUMP:
+    case OpCode::JUMP_IF:
+    case OpCode::JUMP_IF_NOT:
+    case OpCode::GOTO_SCENE:
+      decoded.operand = std::min(instr.operand, count);
+      break;
+    case OpCode::CMP_JUMP_IF_NOT:
+      decoded.operand = std::min(unpackCompareValue(instr.operand), count);
+      decoded.compare = static_cast<u8>(unpackCompareOp(instr.operand));
+      break;
+    case OpCode::SLOT_CMP_INT_JUMP_IF_NOT:
+      decoded.operand = unpackCompareValue(instr.operand);
+      decoded.compare = static_cast<u8>(unpackCompareOp(instr.operand));
+      break;
+    default:
+      break;
+    }
+    m_threaded.push_back(decoded);
+  }
+  for (usize i = 0; i + 2 < m_code.size(); ++i) {
+    if (m_code[i].opcode == OpCode::SLOT_CMP_INT_JUMP_IF_NOT) {
+      m_threaded[i + 2].operand = std::min(m_threaded[i + 2].operand, count);
+    }
+  }
+
+  // The threaded loop has no per-scene check, so validate every scene up
+  // front and make an invalid one stop the VM where it is entered
+  if (m_image) {
+    for (u32 scene = 0; scene < m_image->getSceneCount(); ++scene) {
+      auto loaded = m_image->loadScene(scene);
+      if (loaded.isOk()) {
+        continue;
+      }
+      NOVELMIND_LOG_ERROR(loaded.error());
+      const ImageScene range = m_image->getScene(scene);
+      for (u32 i = range.entry; i < range.end; ++i) {
+        m_threaded[i] = ThreadedInstruction{};
+        m_threaded[i].handler = static_cast<u8>(ThreadedHandler::End);
+      }
+    }
+  }
+  ThreadedInstruction end{};
+  end.handler = static_cast<u8>(ThreadedHandler::End);
+  m_threaded.push_back(end);
+}
+
+u32 VMProgram::resolveVariableSlot(const std::string &name) {
+  auto it = m_variableSlots.find(name);
+  if (it != m_variableSlots.end()) {
+    return it->second;
+  }
+
+  u32 slot = static_cast<u32>(m_variableNames.size());
+  m_variableSlots.emplace(name, slot);
+  m_variableNames.push_back(name);
+  return slot;
+}
+
+} // namespace NovelMind::scripting
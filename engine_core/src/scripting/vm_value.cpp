@@ -0,0 +1,289 @@
+#include "NovelMind/scripting/vm_value.hpp"
+#include "NovelMind/core/logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace NovelMind::scripting {
+
+namespace {
+// Runtime strings a pool may hold before its first collection
+constexpr usize COLLECT_MIN_STRINGS = 256;
+} // namespace
+
+StringPool::StringPool() { clear(); }
+
+StringPool::StringPool(std::shared_ptr<const StringPool> base)
+    : m_base(std::move(base)),
+      m_baseSize(m_base ? static_cast<u32>(m_base->size()) : 0) {
+  clear();
+}
+
+StringPool::StringPool(const StringPool &other)
+    : m_base(other.m_base), m_baseSize(other.m_baseSize),
+      m_pinned(other.m_pinned), m_collectAt(other.m_collectAt),
+      m_strings(other.m_strings) {
+  rebuildIndex();
+}
+
+StringPool &StringPool::operator=(const StringPool &other) {
+  if (this != &other) {
+    m_base = other.m_base;
+    m_baseSize = other.m_baseSize;
+    m_pinned = other.m_pinned;
+    m_collectAt = other.m_collectAt;
+    m_strings = other.m_strings;
+    rebuildIndex();
+  }
+  return *this;
+}
+
+u32 StringPool::intern(std::string_view str) {
+  if (auto handle = find(str)) {
+    return *handle;
+  }
+
+  u32 handle = m_baseSize + static_cast<u32>(m_strings.size());
+  const std::string &stored = m_strings.emplace_back(str);
+  m_handles.emplace(std::string_view(stored), handle);
+  return handle;
+}
+
+std::optional<u32> StringPool::find(std::string_view str) const {
+  if (m_base) {
+    if (auto handle = m_base->find(str)) {
+      return handle;
+    }
+  }
+  auto it = m_handles.find(str);
+  if (it != m_handles.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+const std::string &StringPool::get(u32 handle) const {
+  if (handle < m_baseSize) {
+    return m_base->get(handle);
+  }
+  usize local = handle - m_baseSize;
+  if (local < m_strings.size()) {
+    return m_strings[local];
+  }
+  return m_base ? m_base->get(0) : m_strings.front();
+}
+
+void StringPool::clear() {
+  m_handles.clear();
+  m_strings.clear();
+  if (!m_base) {
+    intern("");
+  }
+  pin();
+}
+
+void StringPool::pin() {
+  m_pinned = m_strings.size();
+  m_collectAt = m_pinned + COLLECT_MIN_STRINGS;
+}
+
+void StringPool::collect(std::initializer_list<std::span<VMValue>> roots) {
+  constexpr u32 DEAD = static_cast<u32>(-1);
+  const u32 first = m_baseSize + static_cast<u32>(m_pinned);
+
+  // Mark, then slide live strings down over dead ones
+  std::vector<u32> remap(m_strings.size() - m_pinned, DEAD);
+  for (const auto &values : roots) {
+    for (const VMValue &value : values) {
+      if (value.type == ValueType::String && value.stringHandle >= first &&
+          value.stringHandle - first < remap.size()) {
+        remap[value.stringHandle - first] = 0;
+      }
+    }
+  }
+
+  usize kept = 0;
+  for (usize i = 0; i < remap.size(); ++i) {
+    if (remap[i] == DEAD) {
+      continue;
+    }
+    if (kept != i) {
+      m_strings[m_pinned + kept] = std::move(m_strings[m_pinned + i]);
+    }
+    remap[i] = first + static_cast<u32>(kept);
+    ++kept;
+  }
+  m_strings.resize(m_pinned + kept);
+  rebuildIndex();
+
+  for (const auto &values : roots) {
+    for (VMValue &value : values) {
+      if (value.type == ValueType::String && value.stringHandle >= first &&
+          value.stringHandle - first < remap.size()) {
+        value.stringHandle = remap[value.stringHandle - first];
+      }
+    }
+  }
+
+  m_collectAt = std::max(2 * m_strings.size(),
+                         m_pinned + COLLECT_MIN_STRINGS);
+}
+
+void StringPool::rebuildIndex() {
+  m_handles.clear();
+  for (u32 i = 0; i < m_strings.size(); ++i) {
+    m_handles.emplace(std::string_view(m_strings[i]), m_baseSize + i);
+  }
+}
+
+std::string toString(const VMValue &value, const StringPool &pool) {
+  switch (value.type) {
+  case ValueType::String:
+    return pool.get(value.stringHandle);
+  case ValueType::Int:
+    return std::to_string(value.intValue);
+  case ValueType::Float:
+    return std::to_string(value.floatValue);
+  case ValueType::Bool:
+    return value.boolValue ? "true" : "false";
+  default:
+    return "null";
+  }
+}
+
+Value toValue(const VMValue &value, const StringPool &pool) {
+  switch (value.type) {
+  case ValueType::Int:
+    return value.intValue;
+  case ValueType::Float:
+    return value.floatValue;
+  case ValueType::Bool:
+    return value.boolValue;
+  case ValueType::String:
+    return pool.get(value.stringHandle);
+  default:
+    return std::monostate{};
+  }
+}
+
+void assignValue(Value &out, const VMValue &value, const StringPool &pool) {
+  if (value.type == ValueType::String) {
+    if (auto *str = std::get_if<std::string>(&out)) {
+      str->assign(pool.get(value.stringHandle));
+      return;
+    }
+  }
+  out = toValue(value, pool);
+}
+
+VMValue fromValue(const Value &value, StringPool &pool) {
+  if (auto *p = std::get_if<i32>(&value))
+    return VMValue::fromInt(*p);
+  if (auto *p = std::get_if<f32>(&value))
+    return VMValue::fromFloat(*p);
+  if (auto *p = std::get_if<bool>(&value))
+    return VMValue::fromBool(*p);
+  if (auto *p = std::get_if<std::string>(&value))
+    return VMValue::fromString(pool.intern(*p));
+  return VMValue::null();
+}
+
+bool valuesEqual(const VMValue &a, const VMValue &b, const StringPool &pool) {
+  if (a.type == b.type) {
+    switch (a.type) {
+    case ValueType::Null:
+      return true;
+    case ValueType::Int:
+      return a.intValue == b.intValue;
+    case ValueType::Bool:
+      return a.boolValue == b.boolValue;
+    case ValueType::String:
+      return a.stringHandle == b.stringHandle;
+    default:
+      break;
+    }
+  }
+  return toString(a, pool) == toString(b, pool);
+}
+
+VMValue addValues(const VMValue &a, const VMValue &b, StringPool &strings) {
+  if (a.type == ValueType::String || b.type == ValueType::String) {
+    return VMValue::fromString(
+        strings.intern(toString(a, strings) + toString(b, strings)));
+  }
+  if (a.type == ValueType::Float || b.type == ValueType::Float) {
+    return VMValue::fromFloat(a.asFloat() + b.asFloat());
+  }
+  return VMValue::fromInt(a.asInt() + b.asInt());
+}
+
+VMValue subValues(const VMValue &a, const VMValue &b) {
+  if (a.type == ValueType::Float || b.type == ValueType::Float) {
+    return VMValue::fromFloat(a.asFloat() - b.asFloat());
+  }
+  return VMValue::fromInt(a.asInt() - b.asInt());
+}
+
+VMValue mulValues(const VMValue &a, const VMValue &b) {
+  if (a.type == ValueType::Float || b.type == ValueType::Float) {
+    return VMValue::fromFloat(a.asFloat() * b.asFloat());
+  }
+  return VMValue::fromInt(a.asInt() * b.asInt());
+}
+
+VMValue divValues(const VMValue &a, const VMValue &b) {
+  f32 divisor = b.asFloat();
+  if (divisor != 0.0f) {
+    return VMValue::fromFloat(a.asFloat() / divisor);
+  }
+  NOVELMIND_LOG_ERROR("Division by zero");
+  return VMValue::fromInt(0);
+}
+
+VMValue modValues(const VMValue &a, const VMValue &b) {
+  if (a.type == ValueType::Float || b.type == ValueType::Float) {
+    f32 divisor = b.asFloat();
+    if (divisor != 0.0f) {
+      return VMValue::fromFloat(std::fmod(a.asFloat(), divisor));
+    }
+  } else {
+    i32 divisor = b.asInt();
+    // x % -1 is always 0; computing it overflows for INT32_MIN
+    if (divisor == -1) {
+      return VMValue::fromInt(0);
+    }
+    if (divisor != 0) {
+      return VMValue::fromInt(a.asInt() % divisor);
+    }
+  }
+  NOVELMIND_LOG_ERROR("Modulo by zero");
+  return VMValue::fromInt(0);
+}
+
+VMValue negateValue(const VMValue &a) {
+  if (a.type == ValueType::Float) {
+    return VMValue::fromFloat(-a.floatValue);
+  }
+  return VMValue::fromInt(static_cast<i32>(0u - static_cast<u32>(a.asInt())));
+}
+
+bool compareValues(CompareOp op, const VMValue &a, const VMValue &b,
+                   const StringPool &strings) {
+  switch (op) {
+  case CompareOp::Eq:
+    return valuesEqual(a, b, strings);
+  case CompareOp::Ne:
+    return !valuesEqual(a, b, strings);
+  case CompareOp::Lt:
+    return a.asFloat() < b.asFloat();
+  case CompareOp::Le:
+    return a.asFloat() <= b.asFloat();
+  case CompareOp::Gt:
+    return a.asFloat() > b.asFloat();
+  case CompareOp::Ge:
+    return a.asFloat() >= b.asFloat();
+  }
+  return false;
+}
+
+} // namespace NovelMind::scripting
@@ -0,0 +1,324 @@
+#include "NovelMind/vfs/block_codec.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace NovelMind::vfs {
+
+namespace {
+
+constexpr usize MIN_MATCH = 4;
+constexpr usize LAST_LITERALS = 5; // Blocks always end in literals
+constexpr usize MATCH_LIMIT = 12;  // No match starts this close to the end
+constexpr usize MAX_OFFSET = 65535;
+constexpr usize RUN_MASK = 15;
+
+constexpr u32 HIGH_HASH_LOG = 16;
+constexpr usize HIGH_WINDOW_MASK = 65535;
+constexpr u32 HIGH_MAX_ATTEMPTS = 64;
+
+u32 read32(const u8 *data) {
+  u32 value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+u32 hash32(u32 value, u32 hashLog) {
+  return (value * 2654435761u) >> (32 - hashLog);
+}
+
+usize matchLength(const u8 *a, const u8 *b, usize limit) {
+  usize length = 0;
+  while (length < limit && a[length] == b[length]) {
+    ++length;
+  }
+  return length;
+}
+
+class SequenceWriter {
+public:
+  explicit SequenceWriter(std::span<u8> output) : m_output(output) {}
+
+  // Literals followed by a match; matchLength 0 ends the block
+  bool write(const u8 *literals, usize literalLength, usize offset,
+             usize matchLength) {
+    const usize matchCode = matchLength == 0 ? 0 : matchLength - MIN_MATCH;
+    const usize worstCase = 1 + literalLength / 255 + 1 + literalLength + 2 +
+                            matchCode / 255 + 1;
+    if (worstCase > m_output.size() - m_size) {
+      return false;
+    }
+
+    u8 &token = m_output[m_size++];
+    token = static_cast<u8>(std::min(literalLength, RUN_MASK) << 4);
+    writeLength(literalLength);
+    if (literalLength > 0) {
+      std::memcpy(m_output.data() + m_size, literals, literalLength);
+      m_size += literalLength;
+    }
+    if (matchLength == 0) {
+      return true;
+    }
+
+    m_output[m_size++] = static_cast<u8>(offset & 0xFF);
+    m_output[m_size++] = static_cast<u8>(offset >> 8);
+    token = static_cast<u8>(token | std::min(matchCode, RUN_MASK));
+    writeLength(matchCode);
+    return true;
+  }
+
+  [[nodiscard]] usize size() const { return m_size; }
+
+private:
+  void writeLength(usize length) {
+    if (length < RUN_MASK) {
+      return;
+    }
+    length -= RUN_MASK;
+    while (length >= 255) {
+      m_output[m_size++] = 255;
+      length -= 255;
+    }
+    m_output[m_size++] = static_cast<u8>(length);
+  }
+
+  std::span<u8> m_output;
+  usize m_size = 0;
+};
+
+usize compressFast(std::span<const u8> input, SequenceWriter &writer) {
+  const u8 *src = input.data();
+  const usize size = input.size();
+  const auto hashLog =
+      static_cast<u32>(std::clamp<usize>(std::bit_width(size), 10, 14));
+  std::vector<u32> table(usize{1} << hashLog, 0);
+
+  usize anchor = 0;
+  usize ip = 1;
+  usize misses = 1 << 6; // Step grows by one every 64 misses in a row
+  while (ip + MATCH_LIMIT <= size) {
+    const u32 sequence = read32(src + ip);
+    const u32 h = hash32(sequence, hashLog);
+    usize candidate = table[h];
+    table[h] = static_cast<u32>(ip);
+    if (ip - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+      ip += misses++ >> 6;
+      continue;
+    }
+
+    // Extend backwards over pending literals, then forwards
+    while (ip > anchor && candidate > 0 && src[ip - 1] == src[candidate - 1]) {
+      --ip;
+      --candidate;
+    }
+    const usize length =
+        MIN_MATCH + matchLength(src + ip + MIN_MATCH, src + candidate + MIN_MATCH,
+                                size - LAST_LITERALS - ip - MIN_MATCH);
+    if (!writer.write(src + anchor, ip - anchor, ip - candidate, length)) {
+      return 0;
+    }
+    ip += length;
+    anchor = ip;
+    misses = 1 << 6;
+    if (ip + MATCH_LIMIT <= size) {
+      table[hash32(read32(src + ip - 2), hashLog)] = static_cast<u32>(ip - 2);
+    }
+  }
+
+  if (!writer.write(src + anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return writer.size();
+}
+
+class HashChain {
+public:
+  explicit HashChain(const u8 *src)
+      : m_src(src), m_head(usize{1} << HIGH_HASH_LOG, 0),
+        m_chain(HIGH_WINDOW_MASK + 1, 0) {}
+
+  // Longest match for @p ip within @p limit bytes; inserts up to @p ip
+  usize find(usize ip, usize limit, usize &offset) {
+    for (; m_inserted < ip; ++m_inserted) {
+      insert(m_inserted);
+    }
+
+    usize best = 0;
+    u32 next = m_head[hash32(read32(m_src + ip), HIGH_HASH_LOG)];
+    for (u32 attempts = HIGH_MAX_ATTEMPTS; next != 0 && attempts > 0;
+         --attempts) {
+      const usize candidate = next - 1;
+      if (ip - candidate > MAX_OFFSET) {
+        break;
+      }
+      if (m_src[candidate + best] == m_src[ip + best] &&
+          read32(m_src + candidate) == read32(m_src + ip)) {
+        const usize length = MIN_MATCH + matchLength(m_src + ip + MIN_MATCH,
+                                                     m_src + candidate + MIN_MATCH,
+                                                     limit - MIN_MATCH);
+        if (length > best) {
+          best = length;
+          offset = ip - candidate;
+          if (length == limit) {
+            break;
+          }
+        }
+      }
+      next = m_chain[candidate & HIGH_WINDOW_MASK];
+      if (next - 1 >= candidate) {
+        break; // Slot reused by a newer position
+      }
+    }
+    return best;
+  }
+
+private:
+  void insert(usize position) {
+    const u32 h = hash32(read32(m_src + position), HIGH_HASH_LOG);
+    m_chain[position & HIGH_WINDOW_MASK] = m_head[h];
+    m_head[h] = static_cast<u32>(position + 1);
+  }
+
+  const u8 *m_src;
+  std::vector<u32> m_head;  // Newest position + 1 per hash, 0 for none
+  std::vector<u32> m_chain; // Previous position + 1 with the same hash
+  usize m_inserted = 0;
+};
+
+usize compressHigh(std::span<const u8> input, SequenceWriter &writer) {
+  const u8 *src = input.data();
+  const usize size = input.size();
+  HashChain chain(src);
+
+  usize anchor = 0;
+  usize ip = 0;
+  while (ip + MATCH_LIMIT <= size) {
+    usize offset = 0;
+    usize length = chain.find(ip, size - LAST_LITERALS - ip, offset);
+    if (length < MIN_MATCH) {
+      ++ip;
+      continue;
+    }
+
+    // Lazy matching: prefer a longer match starting one byte later
+    while (ip + 1 + MATCH_LIMIT <= size) {
+      usize nextOffset = 0;
+      const usize next =
+          chain.find(ip + 1, size - LAST_LITERALS - ip - 1, nextOffset);
+      if (next <= length) {
+        break;
+      }
+      ++ip;
+      length = next;
+      offset = nextOffset;
+    }
+
+    if (!writer.write(src + anchor, ip - anchor, offset, length)) {
+      return 0;
+    }
+    ip += length;
+    anchor = ip;
+  }
+
+  if (!writer.write(src + anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return writer.size();
+}
+
+bool readLength(std::span<const u8> input, usize &ip, usize &length) {
+  if (length != RUN_MASK) {
+    return true;
+  }
+  u8 byte = 255;
+  while (byte == 255) {
+    if (ip >= input.size()) {
+      return false;
+    }
+    byte = input[ip++];
+    length += byte;
+  }
+  return true;
+}
+
+} // namespace
+
+usize BlockCodec::compress(std::span<const u8> input, std::span<u8> output,
+                           Level level) {
+  if (input.size() > std::numeric_limits<u32>::max() - 1) {
+    return 0;
+  }
+  SequenceWriter writer(output);
+  if (input.size() < MATCH_LIMIT + 1) {
+    return writer.write(input.data(), input.size(), 0, 0) ? writer.size() : 0;
+  }
+  return level == Level::High ? compressHigh(input, writer)
+                              : compressFast(input, writer);
+}
+
+Result<void> BlockCodec::decompress(std::span<const u8> input,
+                                    std::span<u8> output) {
+  const auto corrupt = [] {
+    return Result<void>::error("Corrupt compressed block");
+  };
+
+  usize ip = 0;
+  usize op = 0;
+  while (true) {
+    if (ip >= input.size()) {
+      return corrupt();
+    }
+    const u8 token = input[ip++];
+
+    usize literalLength = static_cast<usize>(token >> 4);
+    if (!readLength(input, ip, literalLength) ||
+        literalLength > input.size() - ip ||
+        literalLength > output.size() - op) {
+      return corrupt();
+    }
+    if (literalLength > 0) {
+      std::memcpy(output.data() + op, input.data() + ip, literalLength);
+    }
+    ip += literalLength;
+    op += literalLength;
+    if (ip == input.size()) {
+      break;
+    }
+
+    if (input.size() - ip < 2) {
+      return corrupt();
+    }
+    const usize offset =
+        static_cast<usize>(input[ip]) | static_cast<usize>(input[ip + 1]) << 8;
+    ip += 2;
+    usize length = token & RUN_MASK;
+    if (!readLength(input, ip, length)) {
+      return corrupt();
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > op || length > output.size() - op) {
+      return corrupt();
+    }
+
+    u8 *dst = output.data() + op;
+    const u8 *match = dst - offset;
+    if (offset >= length) {
+      std::memcpy(dst, match, length);
+    } else {
+      // Overlapping copy repeats the last offset bytes
+      for (usize i = 0; i < length; ++i) {
+        dst[i] = match[i];
+      }
+    }
+    op += length;
+  }
+
+  if (op != output.size()) {
+    return Result<void>::error("Compressed block has the wrong size");
+  }
+  return Result<void>::ok();
+}
+
+} // namespace NovelMind::vfs
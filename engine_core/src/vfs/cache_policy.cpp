@@ -0,0 +1,362 @@
+#include "NovelMind/vfs/cache_policy.hpp"
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <list>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+namespace NovelMind::VFS {
+
+namespace {
+
+usize typeIndex(const ResourceId *id) {
+  const auto index = static_cast<usize>(id->type());
+  return index < RESOURCE_TYPE_COUNT ? index : 0;
+}
+
+bool inMask(u32 typeMask, usize type) {
+  return (typeMask & (1u << type)) != 0;
+}
+
+u64 nextTick(CacheClock &clock) {
+  return clock.tick.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// One recency list per type; the oldest tail across the allowed types goes
+class LruPolicy final : public CachePolicy {
+public:
+  explicit LruPolicy(std::shared_ptr<CacheClock> clock)
+      : m_clock(std::move(clock)) {}
+
+  void onInsert(const ResourceId *id, usize /*size*/) override {
+    auto &list = m_lists[typeIndex(id)];
+    list.push_front({id, nextTick(*m_clock)});
+    m_items[id] = list.begin();
+  }
+
+  void onAccess(const ResourceId *id) override {
+    const auto it = m_items.find(id);
+    if (it != m_items.end()) {
+      auto &list = m_lists[typeIndex(id)];
+      list.splice(list.begin(), list, it->second);
+      it->second->tick = nextTick(*m_clock);
+    }
+  }
+
+  void onRemove(const ResourceId *id) override {
+    const auto it = m_items.find(id);
+    if (it != m_items.end()) {
+      m_lists[typeIndex(id)].erase(it->second);
+      m_items.erase(it);
+    }
+  }
+
+  void clear() override {
+    for (auto &list : m_lists) {
+      list.clear();
+    }
+    m_items.clear();
+  }
+
+  const ResourceId *evict(u32 typeMask) override {
+    std::list<Item> *list = oldest(typeMask);
+    if (!list) {
+      return nullptr;
+    }
+
+    const ResourceId *id = list->back().id;
+    list->pop_back();
+    m_items.erase(id);
+    return id;
+  }
+
+  std::optional<f64> peek(u32 typeMask) override {
+    const std::list<Item> *list = oldest(typeMask);
+    if (!list) {
+      return std::nullopt;
+    }
+    return static_cast<f64>(list->back().tick);
+  }
+
+private:
+  struct Item {
+    const ResourceId *id;
+    u64 tick;
+  };
+
+  std::list<Item> *oldest(u32 typeMask) {
+    std::list<Item> *result = nullptr;
+    for (usize type = 0; type < RESOURCE_TYPE_COUNT; ++type) {
+      auto &list = m_lists[type];
+      if (inMask(typeMask, type) && !list.empty() &&
+          (!result || list.back().tick < result->back().tick)) {
+        result = &list;
+      }
+    }
+    return result;
+  }
+
+  std::shared_ptr<CacheClock> m_clock;
+  std::array<std::list<Item>, RESOURCE_TYPE_COUNT> m_lists;
+  std::unordered_map<const ResourceId *, std::list<Item>::iterator> m_items;
+};
+
+// Entries sit in a ring in the order the hand reaches them; it clears
+// reference bits until it finds an entry not used since its last pass.
+// New entries go just behind the hand, so they are reached last. An entry
+// is ranked by when it was inserted or last passed over, which is the
+// order the hand visits it in. peek() only looks; the hand moves in
+// spareNext() and evict().
+class ClockPolicy final : public CachePolicy {
+public:
+  explicit ClockPolicy(std::shared_ptr<CacheClock> clock)
+      : m_clock(std::move(clock)) {}
+
+  void onInsert(const ResourceId *id, usize /*size*/) override {
+    m_slots[id] = m_ring.insert(m_hand, {id, nextTick(*m_clock), false});
+    ++m_counts[typeIndex(id)];
+  }
+
+  void onAccess(const ResourceId *id) override {
+    const auto it = m_slots.find(id);
+    if (it != m_slots.end()) {
+      it->second->referenced = true;
+    }
+  }
+
+  void onRemove(const ResourceId *id) override {
+    const auto it = m_slots.find(id);
+    if (it != m_slots.end()) {
+      removeSlot(it->second);
+    }
+  }
+
+  void clear() override {
+    m_ring.clear();
+    m_slots.clear();
+    m_counts = {};
+    m_hand = m_ring.end();
+  }
+
+  const ResourceId *evict(u32 typeMask) override {
+    if (!advance(typeMask)) {
+      return nullptr;
+    }
+    const ResourceId *id = m_hand->id;
+    removeSlot(m_hand);
+    return id;
+  }
+
+  std::optional<f64> peek(u32 typeMask) override {
+    const Ring::iterator slot = next(typeMask);
+    if (slot == m_ring.end()) {
+      return std::nullopt;
+    }
+    return static_cast<f64>(slot->tick);
+  }
+
+  bool spareNext(u32 typeMask) override {
+    const Ring::iterator slot = next(typeMask);
+    if (slot == m_ring.end() || !slot->referenced) {
+      return false;
+    }
+    slot->referenced = false;
+    slot->tick = nextTick(*m_clock);
+    m_hand = std::next(slot);
+    return true;
+  }
+
+private:
+  struct Slot {
+    const ResourceId *id;
+    u64 tick;
+    bool referenced;
+  };
+  using Ring = std::list<Slot>;
+
+  bool hasCandidates(u32 typeMask) const {
+    for (usize type = 0; type < RESOURCE_TYPE_COUNT; ++type) {
+      if (inMask(typeMask, type) && m_counts[type] > 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // First entry of the allowed types the hand reaches, without moving it
+  Ring::iterator next(u32 typeMask) {
+    if (!hasCandidates(typeMask)) {
+      return m_ring.end();
+    }
+    Ring::iterator slot = m_hand;
+    for (;;) {
+      if (slot == m_ring.end()) {
+        slot = m_ring.begin();
+      }
+      if (inMask(typeMask, typeIndex(slot->id))) {
+        return slot;
+      }
+      ++slot;
+    }
+  }
+
+  // Move the hand to the next victim of the allowed types
+  bool advance(u32 typeMask) {
+    if (!hasCandidates(typeMask)) {
+      return false;
+    }
+
+    // One pass clears every reference bit, so the next finds a victim
+    for (usize step = 0; step <= 2 * m_ring.size(); ++step) {
+      if (m_hand == m_ring.end()) {
+        m_hand = m_ring.begin();
+      }
+      if (!inMask(typeMask, typeIndex(m_hand->id))) {
+        ++m_hand;
+      } else if (m_hand->referenced) {
+        m_hand->referenced = false;
+        m_hand->tick = nextTick(*m_clock);
+        ++m_hand;
+      } else {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void removeSlot(Ring::iterator slot) {
+    if (slot == m_hand) {
+      ++m_hand;
+    }
+    --m_counts[typeIndex(slot->id)];
+    m_slots.erase(slot->id);
+    m_ring.erase(slot);
+  }
+
+  std::shared_ptr<CacheClock> m_clock;
+  Ring m_ring;
+  std::unordered_map<const ResourceId *, Ring::iterator> m_slots;
+  std::array<usize, RESOURCE_TYPE_COUNT> m_counts{};
+  Ring::iterator m_hand = m_ring.end();
+};
+
+// Priority = inflation + hits / size. Evicting an entry raises the
+// inflation to its priority, so entries that stop being hit fall behind
+// newer ones instead of staying on past popularity. The inflation is the
+// cache's, not the shard's, so priorities compare across shards.
+class GdsfPolicy final : public CachePolicy {
+public:
+  explicit GdsfPolicy(std::shared_ptr<CacheClock> clock)
+      : m_clock(std::move(clock)) {}
+
+  void onInsert(const ResourceId *id, usize size) override {
+    Item &item = m_items[id];
+    item.size = std::max<usize>(size, 1);
+    item.frequency = 1;
+    enqueue(id, item);
+  }
+
+  void onAccess(const ResourceId *id) override {
+    const auto it = m_items.find(id);
+    if (it != m_items.end()) {
+      m_queues[typeIndex(id)].erase(it->second.position);
+      ++it->second.frequency;
+      enqueue(id, it->second);
+    }
+  }
+
+  void onRemove(const ResourceId *id) override {
+    const auto it = m_items.find(id);
+    if (it != m_items.end()) {
+      m_queues[typeIndex(id)].erase(it->second.position);
+      m_items.erase(it);
+    }
+  }
+
+  void clear() override {
+    for (auto &queue : m_queues) {
+      queue.clear();
+    }
+    m_items.clear();
+  }
+
+  const ResourceId *evict(u32 typeMask) override {
+    Queue *queue = lowest(typeMask);
+    if (!queue) {
+      return nullptr;
+    }
+
+    const auto [priority, sequence, id] = *queue->begin();
+    f64 inflation = m_clock->inflation.load(std::memory_order_relaxed);
+    while (inflation < priority &&
+           !m_clock->inflation.compare_exchange_weak(
+               inflation, priority, std::memory_order_relaxed)) {
+    }
+    queue->erase(queue->begin());
+    m_items.erase(id);
+    return id;
+  }
+
+  std::optional<f64> peek(u32 typeMask) override {
+    const Queue *queue = lowest(typeMask);
+    if (!queue) {
+      return std::nullopt;
+    }
+    return std::get<0>(*queue->begin());
+  }
+
+private:
+  // The sequence number breaks ties, so ids are never compared
+  using Key = std::tuple<f64, u64, const ResourceId *>;
+  using Queue = std::set<Key>;
+
+  struct Item {
+    usize size = 1;
+    u64 frequency = 0;
+    Queue::iterator position;
+  };
+
+  Queue *lowest(u32 typeMask) {
+    Queue *result = nullptr;
+    for (usize type = 0; type < RESOURCE_TYPE_COUNT; ++type) {
+      auto &queue = m_queues[type];
+      if (inMask(typeMask, type) && !queue.empty() &&
+          (!result || *queue.begin() < *result->begin())) {
+        result = &queue;
+      }
+    }
+    return result;
+  }
+
+  void enqueue(const ResourceId *id, Item &item) {
+    const f64 priority =
+        m_clock->inflation.load(std::memory_order_relaxed) +
+        static_cast<f64>(item.frequency) / static_cast<f64>(item.size);
+    item.position = m_queues[typeIndex(id)]
+                        .emplace(priority, nextTick(*m_clock), id)
+                        .first;
+  }
+
+  std::shared_ptr<CacheClock> m_clock;
+  std::array<Queue, RESOURCE_TYPE_COUNT> m_queues;
+  std::unordered_map<const ResourceId *, Item> m_items;
+};
+
+} // namespace
+
+std::unique_ptr<CachePolicy>
+CachePolicy::create(EvictionPolicy policy, std::shared_ptr<CacheClock> clock) {
+  switch (policy) {
+  case EvictionPolicy::Clock:
+    return std::make_unique<ClockPolicy>(std::move(clock));
+  case EvictionPolicy::GDSF:
+    return std::make_unique<GdsfPolicy>(std::move(clock));
+  case EvictionPolicy::LRU:
+    break;
+  }
+  return std::make_unique<LruPolicy>(std::move(clock));
+}
+
+} // namespace NovelMind::VFS
@@ -45,8 +45,12 @@ Result<std::vector<u8>> IFileHandle::readBytes(usize count) {
 MemoryFileHandle::MemoryFileHandle(std::vector<u8> data)
     : m_data(std::move(data)), m_position(0), m_valid(true) {}
 
+MemoryFileHandle::MemoryFileHandle(core::ByteBuffer data)
+    : m_data(std::move(data)), m_position(0), m_valid(true) {}
+
 MemoryFileHandle::MemoryFileHandle(const u8 *data, usize dataSize)
-    : m_data(data, data + dataSize), m_position(0), m_valid(true) {}
+    : m_data(core::ByteBuffer::copyOf({data, dataSize})), m_position(0),
+      m_valid(true) {}
 
 bool MemoryFileHandle::isValid() const { return m_valid; }
 
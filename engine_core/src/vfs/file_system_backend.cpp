@@ -22,6 +22,19 @@ u32 crc32(const std::vector<u8> &data) {
 
 } // anonymous namespace
 
+Result<core::ByteBuffer> IFileSystemBackend::read(const ResourceId &id) {
+  auto handle = open(id);
+  if (!handle || !handle->isValid()) {
+    return Result<core::ByteBuffer>::error("Resource not found: " + id.id());
+  }
+
+  auto bytes = handle->readAll();
+  if (!bytes.isOk()) {
+    return Result<core::ByteBuffer>::error(bytes.error());
+  }
+  return Result<core::ByteBuffer>::ok(std::move(bytes).value());
+}
+
 std::unique_ptr<IFileHandle> MemoryBackend::open(const ResourceId &id) {
   std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -33,6 +46,17 @@ std::unique_ptr<IFileHandle> MemoryBackend::open(const ResourceId &id) {
   return std::make_unique<MemoryFileHandle>(it->second.data);
 }
 
+Result<core::ByteBuffer> MemoryBackend::read(const ResourceId &id) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  const auto it = m_resources.find(id);
+  if (it == m_resources.end()) {
+    return Result<core::ByteBuffer>::error("Resource not found: " + id.id());
+  }
+
+  return Result<core::ByteBuffer>::ok(it->second.data);
+}
+
 bool MemoryBackend::exists(const ResourceId &id) const {
   std::lock_guard<std::mutex> lock(m_mutex);
   return m_resources.find(id) != m_resources.end();
@@ -98,4 +122,61 @@ u32 MemoryBackend::calculateChecksum(const std::vector<u8> &data) {
   return crc32(data);
 }
 
+std::unique_ptr<IFileHandle> PackBackend::open(const ResourceId &id) {
+  return m_reader.openStream(id.id());
+}
+
+Result<core::ByteBuffer> PackBackend::read(const ResourceId &id) {
+  return m_reader.readBuffer(id.id());
+}
+
+bool PackBackend::exists(const ResourceId &id) const {
+  return m_reader.exists(id.id());
+}
+
+std::optional<ResourceInfo> PackBackend::getInfo(const ResourceId &id) const {
+  const auto entry = m_reader.getEntry(id.id());
+  if (!entry) {
+    return std::nullopt;
+  }
+
+  const auto hasFlag = [&](vfs::PackFlags flag) {
+    return (entry->flags & static_cast<u32>(flag)) != 0;
+  };
+  ResourceInfo info;
+  info.resourceId = ResourceId(id.id(), static_cast<ResourceType>(entry->type));
+  info.size = static_cast<usize>(entry->uncompressedSize);
+  info.compressedSize = static_cast<usize>(entry->compressedSize);
+  info.checksum = entry->checksum;
+  info.encrypted = hasFlag(vfs::PackFlags::Encrypted);
+  info.compressed = hasFlag(vfs::PackFlags::Compressed);
+  return info;
+}
+
+std::vector<ResourceId> PackBackend::list(ResourceType type) const {
+  std::vector<ResourceId> result;
+  // Pack types stop at Data
+  if (type > ResourceType::Data) {
+    return result;
+  }
+
+  for (auto &id :
+       m_reader.listResources(static_cast<vfs::ResourceType>(type))) {
+    const auto entry = m_reader.getEntry(id);
+    const auto entryType =
+        entry ? static_cast<ResourceType>(entry->type) : ResourceType::Unknown;
+    result.emplace_back(std::move(id), entryType);
+  }
+
+  return result;
+}
+
+Result<void> PackBackend::mount(const std::string &packPath) {
+  return m_reader.mount(packPath);
+}
+
+void PackBackend::unmount(const std::string &packPath) {
+  m_reader.unmount(packPath);
+}
+
 } // namespace NovelMind::VFS
@@ -385,19 +385,21 @@ bool MultiPackManager::isPackEnabled(const std::string &packId) const {
 // Resource Access
 // =========================================================================
 
-Result<std::vector<u8>>
+Result<core::ByteBuffer>
 MultiPackManager::readResource(const std::string &resourceId) {
   auto it = m_resourceIndex.find(resourceId);
   if (it == m_resourceIndex.end()) {
-    return Result<std::vector<u8>>::error("Resource not found: " + resourceId);
+    return Result<core::ByteBuffer>::error("Resource not found: " +
+                                           resourceId);
   }
 
   auto &pack = m_packs[it->second];
   if (!pack->info.enabled) {
-    return Result<std::vector<u8>>::error("Pack is disabled: " + pack->info.id);
+    return Result<core::ByteBuffer>::error("Pack is disabled: " +
+                                           pack->info.id);
   }
 
-  return pack->reader->readFile(resourceId);
+  return pack->reader->readBuffer(resourceId);
 }
 
 bool MultiPackManager::exists(const std::string &resourceId) const {
@@ -485,15 +487,15 @@ std::vector<ResourceOverride> MultiPackManager::getActiveOverrides() const {
   return overrides;
 }
 
-Result<std::vector<u8>>
+Result<core::ByteBuffer>
 MultiPackManager::readResourceFromPack(const std::string &packId,
                                        const std::string &resourceId) {
   auto it = m_packIdToIndex.find(packId);
   if (it == m_packIdToIndex.end()) {
-    return Result<std::vector<u8>>::error("Pack not found: " + packId);
+    return Result<core::ByteBuffer>::error("Pack not found: " + packId);
   }
 
-  return m_packs[it->second]->reader->readFile(resourceId);
+  return m_packs[it->second]->reader->readBuffer(resourceId);
 }
 
 // =========================================================================
@@ -1,42 +1,83 @@
 #include "NovelMind/vfs/pack_reader.hpp"
 #include "NovelMind/core/logger.hpp"
+#include "NovelMind/vfs/block_codec.hpp"
+#include "NovelMind/vfs/pack_stream.hpp"
+#include <atomic>
 #include <cstring>
 
 namespace NovelMind::vfs {
 
+namespace {
+
+bool hasFlag(const PackResourceEntry &entry, PackFlags flag) {
+  return (entry.flags & static_cast<u32>(flag)) != 0;
+}
+
+// Compressed or chunked, and not encrypted, so the reader can decode it
+bool isDecodable(const PackResourceEntry &entry) {
+  return (hasFlag(entry, PackFlags::Compressed) ||
+          hasFlag(entry, PackFlags::Chunked)) &&
+         !hasFlag(entry, PackFlags::Encrypted);
+}
+
+// Copy a trivially copyable record out of the mapping at @p offset
+template <typename T>
+bool readRecord(const core::MappedFile &file, u64 offset, T &record) {
+  if (offset > file.size() || file.size() - offset < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&record, file.data() + offset, sizeof(T));
+  return true;
+}
+
+} // namespace
+
 PackReader::~PackReader() { unmountAll(); }
 
 Result<void> PackReader::mount(const std::string &packPath) {
   std::lock_guard<std::mutex> lock(m_mutex);
 
-  if (m_packs.find(packPath) != m_packs.end()) {
+  auto current = snapshot();
+  if (current->find(packPath) != current->end()) {
     return Result<void>::error("Pack already mounted: " + packPath);
   }
 
-  std::ifstream file(packPath, std::ios::binary);
-  if (!file.is_open()) {
+  auto file = core::MappedFile::open(packPath);
+  if (file.isError()) {
     return Result<void>::error("Failed to open pack file: " + packPath);
   }
 
-  MountedPack pack;
-  pack.path = packPath;
+  auto pack = std::make_shared<MountedPack>();
+  pack->path = packPath;
+  pack->file = std::move(file).value();
 
-  auto headerResult = readPackHeader(file, pack.header);
+  auto headerResult = readPackHeader(*pack->file, pack->header);
   if (headerResult.isError()) {
     return headerResult;
   }
 
-  auto tableResult = readResourceTable(file, pack);
+  std::vector<PackResourceEntry> table;
+  auto tableResult = readResourceTable(*pack->file, *pack, table);
   if (tableResult.isError()) {
     return tableResult;
   }
 
-  auto stringResult = readStringTable(file, pack);
+  auto stringResult = readStringTable(*pack->file, *pack);
   if (stringResult.isError()) {
     return stringResult;
   }
 
-  m_packs[packPath] = std::move(pack);
+  // Key entries by their resource ID
+  pack->entries.reserve(table.size());
+  for (const auto &entry : table) {
+    if (entry.idStringOffset < pack->stringTable.size()) {
+      pack->entries[pack->stringTable[entry.idStringOffset]] = entry;
+    }
+  }
+
+  auto packs = std::make_shared<PackTable>(*current);
+  packs->emplace(packPath, std::move(pack));
+  publish(std::move(packs));
   NOVELMIND_LOG_INFO("Mounted pack: " + packPath);
 
   return Result<void>::ok();
@@ -44,68 +85,189 @@ Result<void> PackReader::mount(const std::string &packPath) {
 
 void PackReader::unmount(const std::string &packPath) {
   std::lock_guard<std::mutex> lock(m_mutex);
-  m_packs.erase(packPath);
+  auto packs = std::make_shared<PackTable>(*snapshot());
+  packs->erase(packPath);
+  publish(std::move(packs));
   NOVELMIND_LOG_INFO("Unmounted pack: " + packPath);
 }
 
 void PackReader::unmountAll() {
   std::lock_guard<std::mutex> lock(m_mutex);
-  m_packs.clear();
+  publish(std::make_shared<PackTable>());
   NOVELMIND_LOG_INFO("Unmounted all packs");
 }
 
 Result<std::vector<u8>>
 PackReader::readFile(const std::string &resourceId) const {
-  std::lock_guard<std::mutex> lock(m_mutex);
+  auto [pack, entry] = find(resourceId);
+  if (!pack) {
+    return Result<std::vector<u8>>::error("Resource not found: " + resourceId);
+  }
+
+  // Decryption is handled by PackSecurity when enabled, so encrypted
+  // entries are returned as stored. See pack_security.hpp.
+  if (isDecodable(*entry)) {
+    return decodeWhole(*pack, *entry, resourceId);
+  }
+
+  auto bytes = resourceBytes(*pack, *entry);
+  if (bytes.isError()) {
+    return Result<std::vector<u8>>::error(bytes.error());
+  }
+
+  return Result<std::vector<u8>>::ok(
+      std::vector<u8>(bytes.value().begin(), bytes.value().end()));
+}
+
+Result<core::ByteBuffer>
+PackReader::readBuffer(const std::string &resourceId) const {
+  auto [pack, entry] = find(resourceId);
+  if (!pack) {
+    return Result<core::ByteBuffer>::error("Resource not found: " +
+                                           resourceId);
+  }
 
-  for (const auto &[packPath, pack] : m_packs) {
-    auto it = pack.entries.find(resourceId);
-    if (it != pack.entries.end()) {
-      return readResourceData(packPath, it->second);
+  if (isDecodable(*entry)) {
+    auto data = decodeWhole(*pack, *entry, resourceId);
+    if (data.isError()) {
+      return Result<core::ByteBuffer>::error(data.error());
     }
+    return Result<core::ByteBuffer>::ok(std::move(data).value());
   }
 
-  return Result<std::vector<u8>>::error("Resource not found: " + resourceId);
+  auto bytes = resourceBytes(*pack, *entry);
+  if (bytes.isError()) {
+    return Result<core::ByteBuffer>::error(bytes.error());
+  }
+
+  return Result<core::ByteBuffer>::ok(
+      core::ByteBuffer(pack->file, bytes.value()));
 }
 
-bool PackReader::exists(const std::string &resourceId) const {
-  std::lock_guard<std::mutex> lock(m_mutex);
+Result<usize> PackReader::readInto(const std::string &resourceId,
+                                   std::span<u8> buffer) const {
+  auto [pack, entry] = find(resourceId);
+  if (!pack) {
+    return Result<usize>::error("Resource not found: " + resourceId);
+  }
+  if (hasFlag(*entry, PackFlags::Encrypted)) {
+    return Result<usize>::error("Resource is encrypted: " + resourceId);
+  }
 
-  for (const auto &[packPath, pack] : m_packs) {
-    if (pack.entries.find(resourceId) != pack.entries.end()) {
-      return true;
+  const auto size = static_cast<usize>(entry->uncompressedSize);
+  if (buffer.size() < size) {
+    return Result<usize>::error("Buffer too small for resource: " +
+                                resourceId);
+  }
+
+  if (isDecodable(*entry)) {
+    auto decoded = decode(*pack, *entry, buffer.first(size));
+    if (decoded.isError()) {
+      return Result<usize>::error(decoded.error() + ": " + resourceId);
     }
+    return Result<usize>::ok(size);
   }
 
-  return false;
+  auto bytes = resourceBytes(*pack, *entry);
+  if (bytes.isError()) {
+    return Result<usize>::error(bytes.error());
+  }
+  if (bytes.value().size() > buffer.size()) {
+    return Result<usize>::error("Buffer too small for resource: " +
+                                resourceId);
+  }
+  std::memcpy(buffer.data(), bytes.value().data(), bytes.value().size());
+  return Result<usize>::ok(bytes.value().size());
 }
 
-std::optional<ResourceInfo>
-PackReader::getInfo(const std::string &resourceId) const {
-  std::lock_guard<std::mutex> lock(m_mutex);
+Result<PackResourceView>
+PackReader::readView(const std::string &resourceId) const {
+  auto [pack, entry] = find(resourceId);
+  if (!pack) {
+    return Result<PackResourceView>::error("Resource not found: " +
+                                           resourceId);
+  }
+
+  if (hasFlag(*entry, PackFlags::Encrypted) || isDecodable(*entry)) {
+    return Result<PackResourceView>::error(
+        "Resource is compressed or encrypted: " + resourceId);
+  }
+
+  auto bytes = resourceBytes(*pack, *entry);
+  if (bytes.isError()) {
+    return Result<PackResourceView>::error(bytes.error());
+  }
+
+  return Result<PackResourceView>::ok(
+      PackResourceView{pack->file, bytes.value()});
+}
+
+std::unique_ptr<VFS::IFileHandle>
+PackReader::openStream(const std::string &resourceId) const {
+  auto [pack, entry] = find(resourceId);
+  if (!pack || hasFlag(*entry, PackFlags::Encrypted)) {
+    return nullptr;
+  }
+
+  auto bytes = resourceBytes(*pack, *entry);
+  if (bytes.isError()) {
+    return nullptr;
+  }
+
+  if (hasFlag(*entry, PackFlags::Chunked)) {
+    auto chunks = PackChunkTable::parse(bytes.value(), entry->uncompressedSize);
+    if (chunks.isError()) {
+      return nullptr;
+    }
+    return std::make_unique<PackStream>(pack->file, chunks.value());
+  }
 
-  for (const auto &[packPath, pack] : m_packs) {
-    auto it = pack.entries.find(resourceId);
-    if (it != pack.entries.end()) {
-      ResourceInfo info;
-      info.id = resourceId;
-      info.type = static_cast<ResourceType>(it->second.type);
-      info.size = static_cast<usize>(it->second.uncompressedSize);
-      info.checksum = it->second.checksum;
-      return info;
+  if (hasFlag(*entry, PackFlags::Compressed)) {
+    auto data = readBuffer(resourceId);
+    if (data.isError()) {
+      return nullptr;
     }
+    return std::make_unique<VFS::MemoryFileHandle>(std::move(data).value());
   }
 
-  return std::nullopt;
+  return std::make_unique<PackStream>(pack->file, bytes.value());
+}
+
+std::optional<PackResourceEntry>
+PackReader::getEntry(const std::string &resourceId) const {
+  auto [pack, entry] = find(resourceId);
+  if (!pack) {
+    return std::nullopt;
+  }
+  return *entry;
+}
+
+bool PackReader::exists(const std::string &resourceId) const {
+  return find(resourceId).first != nullptr;
+}
+
+std::optional<ResourceInfo>
+PackReader::getInfo(const std::string &resourceId) const {
+  auto [pack, entry] = find(resourceId);
+  if (!pack) {
+    return std::nullopt;
+  }
+
+  ResourceInfo info;
+  info.id = resourceId;
+  info.type = static_cast<ResourceType>(entry->type);
+  info.size = static_cast<usize>(entry->uncompressedSize);
+  info.checksum = entry->checksum;
+  return info;
 }
 
 std::vector<std::string> PackReader::listResources(ResourceType type) const {
-  std::lock_guard<std::mutex> lock(m_mutex);
+  auto packs = snapshot();
 
   std::vector<std::string> result;
 
-  for (const auto &[packPath, pack] : m_packs) {
-    for (const auto &[id, entry] : pack.entries) {
+  for (const auto &[packPath, pack] : *packs) {
+    for (const auto &[id, entry] : pack->entries) {
       if (type == ResourceType::Unknown ||
           static_cast<ResourceType>(entry.type) == type) {
         result.push_back(id);
@@ -116,11 +278,32 @@ std::vector<std::string> PackReader::listResources(ResourceType type) const {
   return result;
 }
 
-Result<void> PackReader::readPackHeader(std::ifstream &file,
-                                        PackHeader &header) {
-  file.read(reinterpret_cast<char *>(&header), sizeof(PackHeader));
+std::shared_ptr<const PackReader::PackTable> PackReader::snapshot() const {
+  return std::atomic_load_explicit(&m_packs, std::memory_order_acquire);
+}
+
+void PackReader::publish(std::shared_ptr<const PackTable> packs) {
+  std::atomic_store_explicit(&m_packs, std::move(packs),
+                             std::memory_order_release);
+}
+
+std::pair<PackReader::PackPtr, const PackResourceEntry *>
+PackReader::find(const std::string &resourceId) const {
+  auto packs = snapshot();
+
+  for (const auto &[packPath, pack] : *packs) {
+    auto it = pack->entries.find(resourceId);
+    if (it != pack->entries.end()) {
+      return {pack, &it->second};
+    }
+  }
+
+  return {nullptr, nullptr};
+}
 
-  if (!file) {
+Result<void> PackReader::readPackHeader(const core::MappedFile &file,
+                                        PackHeader &header) {
+  if (!readRecord(file, 0, header)) {
     return Result<void>::error("Failed to read pack header");
   }
 
@@ -135,110 +318,106 @@ Result<void> PackReader::readPackHeader(std::ifstream &file,
   return Result<void>::ok();
 }
 
-Result<void> PackReader::readResourceTable(std::ifstream &file,
-                                           MountedPack &pack) {
-  file.seekg(static_cast<std::streamoff>(pack.header.resourceTableOffset));
-
-  if (!file) {
-    return Result<void>::error("Failed to seek to resource table");
+Result<void>
+PackReader::readResourceTable(const core::MappedFile &file, MountedPack &pack,
+                              std::vector<PackResourceEntry> &table) {
+  const u64 offset = pack.header.resourceTableOffset;
+  const u64 count = pack.header.resourceCount;
+  if (offset > file.size() ||
+      (file.size() - offset) / sizeof(PackResourceEntry) < count) {
+    return Result<void>::error("Failed to read resource entry");
   }
 
-  for (u32 i = 0; i < pack.header.resourceCount; ++i) {
-    PackResourceEntry entry;
-    file.read(reinterpret_cast<char *>(&entry), sizeof(PackResourceEntry));
-
-    if (!file) {
-      return Result<void>::error("Failed to read resource entry");
-    }
-
-    // Entry ID will be resolved after reading string table
-    pack.entries[std::to_string(i)] = entry;
-  }
+  // Entry IDs are resolved after reading the string table
+  table.resize(static_cast<usize>(count));
+  std::memcpy(table.data(), file.data() + offset,
+              table.size() * sizeof(PackResourceEntry));
 
   return Result<void>::ok();
 }
 
-Result<void> PackReader::readStringTable(std::ifstream &file,
+Result<void> PackReader::readStringTable(const core::MappedFile &file,
                                          MountedPack &pack) {
-  file.seekg(static_cast<std::streamoff>(pack.header.stringTableOffset));
-
-  if (!file) {
-    return Result<void>::error("Failed to seek to string table");
-  }
+  u64 offset = pack.header.stringTableOffset;
 
   u32 stringCount = 0;
-  file.read(reinterpret_cast<char *>(&stringCount), sizeof(u32));
-
-  if (!file) {
+  if (!readRecord(file, offset, stringCount)) {
     return Result<void>::error("Failed to read string count");
   }
+  offset += sizeof(u32);
 
-  // Read string offsets
-  std::vector<u32> offsets(stringCount);
-  file.read(reinterpret_cast<char *>(offsets.data()),
-            static_cast<std::streamsize>(stringCount * sizeof(u32)));
-
-  if (!file) {
+  // String offsets, then NUL-terminated string data
+  if ((file.size() - offset) / sizeof(u32) < stringCount) {
     return Result<void>::error("Failed to read string offsets");
   }
+  std::vector<u32> offsets(stringCount);
+  std::memcpy(offsets.data(), file.data() + offset,
+              offsets.size() * sizeof(u32));
+  const u64 stringDataStart = offset + offsets.size() * sizeof(u32);
 
-  // Read string data
-  auto stringDataStart = file.tellg();
   pack.stringTable.reserve(stringCount);
-
-  for (u32 i = 0; i < stringCount; ++i) {
-    file.seekg(stringDataStart + static_cast<std::streamoff>(offsets[i]));
-    std::string str;
-    std::getline(file, str, '\0');
-    pack.stringTable.push_back(str);
-  }
-
-  // Re-map entries with actual string IDs
-  std::unordered_map<std::string, PackResourceEntry> newEntries;
-  u32 index = 0;
-  for (auto &[key, entry] : pack.entries) {
-    if (entry.idStringOffset < pack.stringTable.size()) {
-      const std::string &resourceId = pack.stringTable[entry.idStringOffset];
-      newEntries[resourceId] = entry;
+  for (u32 stringOffset : offsets) {
+    if (stringOffset > file.size() - stringDataStart) {
+      return Result<void>::error("Failed to read string data");
     }
-    ++index;
+    const auto *begin = reinterpret_cast<const char *>(
+        file.data() + stringDataStart + stringOffset);
+    const usize available =
+        static_cast<usize>(file.size() - stringDataStart - stringOffset);
+    const auto *end = static_cast<const char *>(
+        std::memchr(begin, '\0', available));
+    pack.stringTable.emplace_back(begin, end ? end : begin + available);
   }
-  pack.entries = std::move(newEntries);
 
   return Result<void>::ok();
 }
 
-Result<std::vector<u8>>
-PackReader::readResourceData(const std::string &packPath,
-                             const PackResourceEntry &entry) const {
-  std::ifstream file(packPath, std::ios::binary);
-  if (!file.is_open()) {
-    return Result<std::vector<u8>>::error("Failed to open pack file");
-  }
-
-  auto it = m_packs.find(packPath);
-  if (it == m_packs.end()) {
-    return Result<std::vector<u8>>::error("Pack not mounted");
+Result<std::span<const u8>>
+PackReader::resourceBytes(const MountedPack &pack,
+                          const PackResourceEntry &entry) {
+  const u64 fileSize = pack.file->size();
+  const u64 dataOffset = pack.header.dataOffset;
+  if (dataOffset > fileSize || entry.dataOffset > fileSize - dataOffset ||
+      entry.compressedSize > fileSize - dataOffset - entry.dataOffset) {
+    return Result<std::span<const u8>>::error(
+        "Failed to read resource data");
   }
 
-  u64 absoluteOffset = it->second.header.dataOffset + entry.dataOffset;
-  file.seekg(static_cast<std::streamoff>(absoluteOffset));
+  return Result<std::span<const u8>>::ok(std::span<const u8>(
+      pack.file->data() + dataOffset + entry.dataOffset,
+      static_cast<usize>(entry.compressedSize)));
+}
 
-  if (!file) {
-    return Result<std::vector<u8>>::error("Failed to seek to resource data");
+Result<void> PackReader::decode(const MountedPack &pack,
+                                const PackResourceEntry &entry,
+                                std::span<u8> output) {
+  auto bytes = resourceBytes(pack, entry);
+  if (bytes.isError()) {
+    return Result<void>::error(bytes.error());
   }
-
-  std::vector<u8> data(static_cast<usize>(entry.compressedSize));
-  file.read(reinterpret_cast<char *>(data.data()),
-            static_cast<std::streamsize>(entry.compressedSize));
-
-  if (!file) {
-    return Result<std::vector<u8>>::error("Failed to read resource data");
+  if (hasFlag(entry, PackFlags::Chunked)) {
+    auto chunks = PackChunkTable::parse(bytes.value(), entry.uncompressedSize);
+    if (chunks.isError()) {
+      return Result<void>::error(chunks.error());
+    }
+    return chunks.value().decodeAll(output);
   }
+  return BlockCodec::decompress(bytes.value(), output);
+}
 
-  // Decryption and decompression are handled by PackSecurity when enabled.
-  // See pack_security.hpp for encryption/compression configuration.
-
+Result<std::vector<u8>> PackReader::decodeWhole(const MountedPack &pack,
+                                                const PackResourceEntry &entry,
+                                                const std::string &resourceId) {
+  // A block expands at most about 255 times, so a larger size is damage
+  if (entry.uncompressedSize / 256 > entry.compressedSize) {
+    return Result<std::vector<u8>>::error("Corrupt compressed block: " +
+                                          resourceId);
+  }
+  std::vector<u8> data(static_cast<usize>(entry.uncompressedSize));
+  auto decoded = decode(pack, entry, data);
+  if (decoded.isError()) {
+    return Result<std::vector<u8>>::error(decoded.error() + ": " + resourceId);
+  }
   return Result<std::vector<u8>>::ok(std::move(data));
 }
 
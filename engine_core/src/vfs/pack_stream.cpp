@@ -0,0 +1,218 @@
+#include "NovelMind/vfs/pack_stream.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace NovelMind::vfs {
+
+namespace {
+
+constexpr usize INDEX_HEADER_SIZE = 2 * sizeof(u32);
+
+template <typename T> T load(const u8 *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+void append(std::vector<u8> &out, const void *data, usize size) {
+  if (size == 0) {
+    return;
+  }
+  const usize offset = out.size();
+  out.resize(offset + size);
+  std::memcpy(out.data() + offset, data, size);
+}
+
+} // namespace
+
+std::vector<u8> PackChunkTable::encode(std::span<const u8> data,
+                                       usize chunkSize,
+                                       BlockCodec::Level level,
+                                       bool &anyCompressed) {
+  anyCompressed = false;
+  const auto chunkCount = static_cast<u32>((data.size() + chunkSize - 1) /
+                                           chunkSize);
+
+  std::vector<u64> ends(chunkCount);
+  std::vector<u8> chunks;
+  std::vector<u8> packed(BlockCodec::maxCompressedSize(chunkSize));
+  for (usize chunk = 0; chunk < chunkCount; ++chunk) {
+    const auto input = data.subspan(chunk * chunkSize,
+                                    std::min(chunkSize, data.size() -
+                                                            chunk * chunkSize));
+    const usize size = BlockCodec::compress(input, packed, level);
+    if (size != 0 && size < input.size()) {
+      append(chunks, packed.data(), size);
+      anyCompressed = true;
+    } else {
+      append(chunks, input.data(), input.size());
+    }
+    ends[chunk] = chunks.size();
+  }
+
+  const auto storedChunkSize = static_cast<u32>(chunkSize);
+  std::vector<u8> out;
+  out.reserve(INDEX_HEADER_SIZE + ends.size() * sizeof(u64) + chunks.size());
+  append(out, &storedChunkSize, sizeof(u32));
+  append(out, &chunkCount, sizeof(u32));
+  append(out, ends.data(), ends.size() * sizeof(u64));
+  append(out, chunks.data(), chunks.size());
+  return out;
+}
+
+Result<PackChunkTable> PackChunkTable::parse(std::span<const u8> entry,
+                                             u64 size) {
+  const auto corrupt = [] {
+    return Result<PackChunkTable>::error("Corrupt chunk index");
+  };
+  if (entry.size() < INDEX_HEADER_SIZE) {
+    return corrupt();
+  }
+
+  PackChunkTable table;
+  table.m_chunkSize = load<u32>(entry.data());
+  table.m_chunkCount = load<u32>(entry.data() + sizeof(u32));
+  table.m_size = size;
+  if (table.m_chunkSize == 0 ||
+      table.m_chunkCount != (size + table.m_chunkSize - 1) / table.m_chunkSize ||
+      (entry.size() - INDEX_HEADER_SIZE) / sizeof(u64) < table.m_chunkCount) {
+    return corrupt();
+  }
+
+  const usize indexSize = INDEX_HEADER_SIZE + table.m_chunkCount * sizeof(u64);
+  table.m_ends = entry.subspan(INDEX_HEADER_SIZE, indexSize - INDEX_HEADER_SIZE);
+  table.m_data = entry.subspan(indexSize);
+
+  // Ends must grow and stay inside the entry
+  u64 previous = 0;
+  for (usize chunk = 0; chunk < table.m_chunkCount; ++chunk) {
+    const u64 end = table.chunkEnd(chunk);
+    if (end < previous || end > table.m_data.size()) {
+      return corrupt();
+    }
+    previous = end;
+  }
+  return Result<PackChunkTable>::ok(table);
+}
+
+usize PackChunkTable::decodedSize(usize chunk) const {
+  const u64 begin = static_cast<u64>(chunk) * m_chunkSize;
+  return static_cast<usize>(std::min<u64>(m_chunkSize, m_size - begin));
+}
+
+Result<void> PackChunkTable::decode(usize chunk, std::span<u8> output) const {
+  if (chunk >= m_chunkCount || output.size() != decodedSize(chunk)) {
+    return Result<void>::error("Chunk out of range");
+  }
+
+  const u64 begin = chunk == 0 ? 0 : chunkEnd(chunk - 1);
+  const auto stored = m_data.subspan(static_cast<usize>(begin),
+                                     static_cast<usize>(chunkEnd(chunk) - begin));
+  if (stored.size() == output.size()) {
+    std::copy(stored.begin(), stored.end(), output.begin());
+    return Result<void>::ok();
+  }
+  return BlockCodec::decompress(stored, output);
+}
+
+Result<void> PackChunkTable::decodeAll(std::span<u8> output) const {
+  if (output.size() != m_size) {
+    return Result<void>::error("Chunk out of range");
+  }
+  for (usize chunk = 0; chunk < m_chunkCount; ++chunk) {
+    auto decoded = decode(
+        chunk, output.subspan(chunk * m_chunkSize, decodedSize(chunk)));
+    if (decoded.isError()) {
+      return decoded;
+    }
+  }
+  return Result<void>::ok();
+}
+
+u64 PackChunkTable::chunkEnd(usize chunk) const {
+  return load<u64>(m_ends.data() + chunk * sizeof(u64));
+}
+
+PackStream::PackStream(core::MappedFilePtr file, std::span<const u8> bytes)
+    : m_file(std::move(file)), m_bytes(bytes), m_size(bytes.size()) {}
+
+PackStream::PackStream(core::MappedFilePtr file, PackChunkTable chunks)
+    : m_file(std::move(file)), m_chunks(chunks), m_chunked(true) {
+  for (usize chunk = 0; chunk < m_chunks.chunkCount(); ++chunk) {
+    m_size += m_chunks.decodedSize(chunk);
+  }
+}
+
+Result<usize> PackStream::read(u8 *buffer, usize count) {
+  if (!isValid()) {
+    return Result<usize>::error("Invalid file handle");
+  }
+
+  if (buffer == nullptr) {
+    return Result<usize>::error("Null buffer");
+  }
+
+  const usize toRead = std::min(count, m_size - m_position);
+  if (!m_chunked) {
+    if (toRead > 0) {
+      std::memcpy(buffer, m_bytes.data() + m_position, toRead);
+      m_position += toRead;
+    }
+    return Result<usize>::ok(toRead);
+  }
+
+  usize done = 0;
+  while (done < toRead) {
+    const usize chunk = m_position / m_chunks.chunkSize();
+    if (chunk != m_loadedChunk) {
+      m_chunk.resize(m_chunks.decodedSize(chunk));
+      auto decoded = m_chunks.decode(chunk, m_chunk);
+      if (decoded.isError()) {
+        m_loadedChunk = NO_CHUNK;
+        return Result<usize>::error(decoded.error());
+      }
+      m_loadedChunk = chunk;
+    }
+
+    const usize offset = m_position - chunk * m_chunks.chunkSize();
+    const usize length = std::min(toRead - done, m_chunk.size() - offset);
+    std::memcpy(buffer + done, m_chunk.data() + offset, length);
+    done += length;
+    m_position += length;
+  }
+  return Result<usize>::ok(done);
+}
+
+Result<void> PackStream::seek(i64 offset, VFS::SeekOrigin origin) {
+  if (!isValid()) {
+    return Result<void>::error("Invalid file handle");
+  }
+
+  i64 newPosition = 0;
+
+  switch (origin) {
+  case VFS::SeekOrigin::Begin:
+    newPosition = offset;
+    break;
+  case VFS::SeekOrigin::Current:
+    newPosition = static_cast<i64>(m_position) + offset;
+    break;
+  case VFS::SeekOrigin::End:
+    newPosition = static_cast<i64>(m_size) + offset;
+    break;
+  }
+
+  if (newPosition < 0) {
+    return Result<void>::error("Seek position before beginning of file");
+  }
+
+  if (static_cast<usize>(newPosition) > m_size) {
+    return Result<void>::error("Seek position past end of file");
+  }
+
+  // Nothing is decoded until the next read
+  m_position = static_cast<usize>(newPosition);
+  return Result<void>::ok();
+}
+
+} // namespace NovelMind::vfs
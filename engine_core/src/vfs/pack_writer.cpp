@@ -0,0 +1,219 @@
+#include "NovelMind/vfs/pack_writer.hpp"
+#include "NovelMind/vfs/block_codec.hpp"
+#include "NovelMind/vfs/pack_reader.hpp"
+#include "NovelMind/vfs/pack_security.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace NovelMind::vfs {
+
+namespace {
+
+constexpr u64 PAGE_ALIGNMENT = 4096;
+constexpr u64 SMALL_ALIGNMENT = 16;
+
+usize typeIndex(ResourceType type) {
+  const auto index = static_cast<usize>(type);
+  return index <= static_cast<usize>(ResourceType::Data) ? index : 0;
+}
+
+u64 alignUp(u64 value, u64 alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+template <typename T> void writeRecord(std::vector<u8> &out, const T &value) {
+  const usize offset = out.size();
+  out.resize(offset + sizeof(T));
+  std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+} // namespace
+
+PackWriter::PackWriter() {
+  for (usize i = 0; i < m_compression.size(); ++i) {
+    m_compression[i] = defaultCompression(static_cast<ResourceType>(i));
+    m_chunkSize[i] = defaultChunkSize(static_cast<ResourceType>(i));
+  }
+}
+
+PackCompression PackWriter::defaultCompression(ResourceType type) {
+  switch (type) {
+  case ResourceType::Texture:
+    return PackCompression::None;
+  case ResourceType::Script:
+  case ResourceType::Scene:
+  case ResourceType::Localization:
+    return PackCompression::High;
+  default:
+    return PackCompression::Fast;
+  }
+}
+
+usize PackWriter::defaultChunkSize(ResourceType type) {
+  return type == ResourceType::Audio || type == ResourceType::Music
+             ? PACK_DEFAULT_CHUNK_SIZE
+             : 0;
+}
+
+void PackWriter::setCompression(ResourceType type,
+                                PackCompression compression) {
+  m_compression[typeIndex(type)] = compression;
+}
+
+PackCompression PackWriter::getCompression(ResourceType type) const {
+  return m_compression[typeIndex(type)];
+}
+
+void PackWriter::setChunkSize(ResourceType type, usize chunkSize) {
+  m_chunkSize[typeIndex(type)] = chunkSize;
+}
+
+usize PackWriter::getChunkSize(ResourceType type) const {
+  return m_chunkSize[typeIndex(type)];
+}
+
+void PackWriter::addResource(const std::string &resourceId,
+                             std::vector<u8> data, ResourceType type) {
+  auto [it, inserted] = m_index.try_emplace(resourceId, m_resources.size());
+  if (inserted) {
+    m_resources.push_back({resourceId, std::move(data), type});
+  } else {
+    m_resources[it->second] = {resourceId, std::move(data), type};
+  }
+}
+
+void PackWriter::clear() {
+  m_resources.clear();
+  m_index.clear();
+  m_stats = {};
+}
+
+Result<std::vector<u8>> PackWriter::build() {
+  m_stats = {};
+
+  // Compress each resource, keeping the smaller of the two forms
+  std::vector<std::vector<u8>> stored(m_resources.size());
+  std::vector<PackResourceEntry> entries(m_resources.size());
+  for (usize i = 0; i < m_resources.size(); ++i) {
+    const Resource &resource = m_resources[i];
+    PackResourceEntry &entry = entries[i];
+    entry = {};
+    entry.idStringOffset = static_cast<u32>(i);
+    entry.type = static_cast<u32>(resource.type);
+    entry.uncompressedSize = resource.data.size();
+
+    const PackCompression compression = getCompression(resource.type);
+    const BlockCodec::Level level = compression == PackCompression::High
+                                        ? BlockCodec::Level::High
+                                        : BlockCodec::Level::Fast;
+    const usize chunkSize = getChunkSize(resource.type);
+    if (compression != PackCompression::None && chunkSize > 0 &&
+        resource.data.size() > chunkSize) {
+      bool anyCompressed = false;
+      stored[i] =
+          PackChunkTable::encode(resource.data, chunkSize, level, anyCompressed);
+      entry.flags = static_cast<u32>(PackFlags::Chunked);
+      ++m_stats.chunkedCount;
+      if (anyCompressed) {
+        entry.flags |= static_cast<u32>(PackFlags::Compressed);
+        ++m_stats.compressedCount;
+      }
+    } else if (compression != PackCompression::None && !resource.data.empty()) {
+      std::vector<u8> packed(BlockCodec::maxCompressedSize(resource.data.size()));
+      const usize size = BlockCodec::compress(resource.data, packed, level);
+      if (size != 0 && size < resource.data.size()) {
+        packed.resize(size);
+        stored[i] = std::move(packed);
+        entry.flags = static_cast<u32>(PackFlags::Compressed);
+        ++m_stats.compressedCount;
+      }
+    }
+    const std::vector<u8> &bytes =
+        entry.flags != 0 ? stored[i] : resource.data;
+    entry.compressedSize = bytes.size();
+    entry.checksum =
+        VFS::PackIntegrityChecker::calculateCrc32(bytes.data(), bytes.size());
+    m_stats.uncompressedSize += resource.data.size();
+    m_stats.storedSize += bytes.size();
+  }
+  m_stats.resourceCount = m_resources.size();
+
+  // String table: count, offsets, then NUL-terminated IDs
+  std::vector<u8> strings;
+  std::vector<u32> stringOffsets;
+  for (const Resource &resource : m_resources) {
+    stringOffsets.push_back(static_cast<u32>(strings.size()));
+    strings.insert(strings.end(), resource.id.begin(), resource.id.end());
+    strings.push_back(0);
+  }
+
+  PackHeader header{};
+  header.magic = PACK_MAGIC;
+  header.versionMajor = PACK_VERSION_MAJOR;
+  header.versionMinor = PACK_VERSION_MINOR;
+  header.flags = m_stats.compressedCount > 0
+                     ? static_cast<u32>(PackFlags::Compressed)
+                     : 0;
+  header.resourceCount = static_cast<u32>(m_resources.size());
+  header.resourceTableOffset = sizeof(PackHeader);
+  header.stringTableOffset =
+      header.resourceTableOffset + entries.size() * sizeof(PackResourceEntry);
+  header.dataOffset = alignUp(header.stringTableOffset + sizeof(u32) +
+                                  stringOffsets.size() * sizeof(u32) +
+                                  strings.size(),
+                              PAGE_ALIGNMENT);
+
+  u64 dataSize = 0;
+  for (PackResourceEntry &entry : entries) {
+    dataSize = alignUp(dataSize, entry.compressedSize > PAGE_ALIGNMENT
+                                     ? PAGE_ALIGNMENT
+                                     : SMALL_ALIGNMENT);
+    entry.dataOffset = dataSize;
+    dataSize += entry.compressedSize;
+  }
+  header.totalSize = header.dataOffset + dataSize;
+
+  std::vector<u8> pack;
+  pack.reserve(static_cast<usize>(header.totalSize));
+  writeRecord(pack, header);
+  for (const PackResourceEntry &entry : entries) {
+    writeRecord(pack, entry);
+  }
+  writeRecord(pack, static_cast<u32>(stringOffsets.size()));
+  for (u32 offset : stringOffsets) {
+    writeRecord(pack, offset);
+  }
+  pack.insert(pack.end(), strings.begin(), strings.end());
+
+  pack.resize(static_cast<usize>(header.totalSize), 0);
+  for (usize i = 0; i < entries.size(); ++i) {
+    const std::vector<u8> &bytes =
+        entries[i].flags != 0 ? stored[i] : m_resources[i].data;
+    if (!bytes.empty()) {
+      std::memcpy(pack.data() + header.dataOffset + entries[i].dataOffset,
+                  bytes.data(), bytes.size());
+    }
+  }
+
+  return Result<std::vector<u8>>::ok(std::move(pack));
+}
+
+Result<void> PackWriter::write(const std::string &path) {
+  auto pack = build();
+  if (pack.isError()) {
+    return Result<void>::error(pack.error());
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    return Result<void>::error("Failed to create pack file: " + path);
+  }
+  file.write(reinterpret_cast<const char *>(pack.value().data()),
+             static_cast<std::streamsize>(pack.value().size()));
+  if (!file) {
+    return Result<void>::error("Failed to write pack file: " + path);
+  }
+  return Result<void>::ok();
+}
+
+} // namespace NovelMind::vfs
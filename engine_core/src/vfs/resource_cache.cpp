@@ -1,139 +1,350 @@
 #include "NovelMind/vfs/resource_cache.hpp"
+#include <algorithm>
 
 namespace NovelMind::VFS {
 
-ResourceCache::ResourceCache(usize maxSize) : m_maxSize(maxSize) {}
+namespace {
+
+usize typeIndex(ResourceType type) {
+  const auto index = static_cast<usize>(type);
+  return index < RESOURCE_TYPE_COUNT ? index : 0;
+}
+
+void addStats(CacheStats &total, const CacheStats &stats) {
+  total.totalSize += stats.totalSize;
+  total.entryCount += stats.entryCount;
+  total.hitCount += stats.hitCount;
+  total.missCount += stats.missCount;
+  total.evictionCount += stats.evictionCount;
+}
+
+ResourceCacheConfig configWithMaxSize(usize maxSize) {
+  ResourceCacheConfig config;
+  config.maxSize = maxSize;
+  return config;
+}
+
+void resetCounts(CacheStats &stats) {
+  stats.hitCount = 0;
+  stats.missCount = 0;
+  stats.evictionCount = 0;
+}
+
+} // namespace
+
+ResourceCache::ResourceCache(usize maxSize)
+    : ResourceCache(configWithMaxSize(maxSize)) {}
+
+ResourceCache::ResourceCache(const ResourceCacheConfig &config)
+    : m_clock(std::make_shared<CacheClock>()), m_maxSize(config.maxSize) {
+  const usize shardCount = std::max<usize>(config.shardCount, 1);
+  m_shards.reserve(shardCount);
+  for (usize i = 0; i < shardCount; ++i) {
+    auto shard = std::make_unique<Shard>();
+    if (config.policyFactory) {
+      shard->policy = config.policyFactory(m_clock);
+    }
+    if (!shard->policy) {
+      shard->policy = CachePolicy::create(config.policy, m_clock);
+    }
+    m_shards.push_back(std::move(shard));
+  }
+}
 
 void ResourceCache::setMaxSize(usize maxSize) {
-  std::lock_guard<std::mutex> lock(m_mutex);
   m_maxSize = maxSize;
-  evictIfNeeded(0);
+  enforceLimits();
+}
+
+void ResourceCache::setTypeBudget(ResourceType type, usize budget) {
+  counters(type).budget = budget;
+  enforceLimits();
+}
+
+usize ResourceCache::typeBudget(ResourceType type) const {
+  return counters(type).budget.load();
 }
 
-std::optional<std::vector<u8>> ResourceCache::get(const ResourceId &id) {
-  std::lock_guard<std::mutex> lock(m_mutex);
+std::optional<core::ByteBuffer> ResourceCache::get(const ResourceId &id) {
+  Shard &shard = shardFor(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
 
-  const auto it = m_cache.find(id);
-  if (it == m_cache.end()) {
-    ++m_stats.missCount;
+  const auto it = shard.entries.find(id);
+  if (it == shard.entries.end()) {
+    ++shard.stats.missCount;
+    ++shard.typeStats[typeIndex(id.type())].missCount;
     return std::nullopt;
   }
 
-  ++m_stats.hitCount;
+  ++shard.stats.hitCount;
+  ++shard.typeStats[typeIndex(it->first.type())].hitCount;
   it->second.lastAccess = std::chrono::steady_clock::now();
   ++it->second.accessCount;
-  updateAccessOrder(id);
+  shard.policy->onAccess(&it->first);
 
   return it->second.data;
 }
 
-void ResourceCache::put(const ResourceId &id, std::vector<u8> data) {
-  std::lock_guard<std::mutex> lock(m_mutex);
-
+void ResourceCache::put(const ResourceId &id, core::ByteBuffer data) {
   const usize dataSize = data.size();
 
-  if (dataSize > m_maxSize) {
+  if (dataSize > maxSize() || dataSize > partitionCapacity(id.type())) {
     return;
   }
 
-  const auto existingIt = m_cache.find(id);
-  if (existingIt != m_cache.end()) {
-    m_currentSize -= existingIt->second.data.size();
-    m_cache.erase(existingIt);
+  // The old copy must not count against the room the new one needs
+  remove(id);
+  makeRoom(id.type(), dataSize);
 
-    const auto orderIt = m_orderIterators.find(id);
-    if (orderIt != m_orderIterators.end()) {
-      m_accessOrder.erase(orderIt->second);
-      m_orderIterators.erase(orderIt);
-    }
-  }
+  Shard &shard = shardFor(id);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-  evictIfNeeded(dataSize);
-
-  CacheEntry entry;
-  entry.data = std::move(data);
-  entry.lastAccess = std::chrono::steady_clock::now();
-  entry.accessCount = 1;
+    // Another thread may have put the same id in the meantime
+    const auto existingIt = shard.entries.find(id);
+    if (existingIt != shard.entries.end()) {
+      shard.policy->onRemove(&existingIt->first);
+      erase(shard, existingIt);
+    }
 
-  m_cache[id] = std::move(entry);
-  m_currentSize += dataSize;
+    CacheEntry entry;
+    entry.data = std::move(data);
+    entry.lastAccess = std::chrono::steady_clock::now();
+    entry.accessCount = 1;
 
-  m_accessOrder.push_front(id);
-  m_orderIterators[id] = m_accessOrder.begin();
+    const auto it = shard.entries.emplace(id, std::move(entry)).first;
+    shard.policy->onInsert(&it->first, dataSize);
+    account(shard, it->first.type(), dataSize, true);
+  }
 
-  ++m_stats.entryCount;
+  // Only does work if concurrent puts raced for the same room
+  makeRoom(id.type(), 0);
 }
 
 void ResourceCache::remove(const ResourceId &id) {
-  std::lock_guard<std::mutex> lock(m_mutex);
-
-  const auto it = m_cache.find(id);
-  if (it != m_cache.end()) {
-    m_currentSize -= it->second.data.size();
-    m_cache.erase(it);
-
-    const auto orderIt = m_orderIterators.find(id);
-    if (orderIt != m_orderIterators.end()) {
-      m_accessOrder.erase(orderIt->second);
-      m_orderIterators.erase(orderIt);
-    }
+  Shard &shard = shardFor(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
 
-    --m_stats.entryCount;
+  const auto it = shard.entries.find(id);
+  if (it != shard.entries.end()) {
+    shard.policy->onRemove(&it->first);
+    erase(shard, it);
   }
 }
 
 void ResourceCache::clear() {
-  std::lock_guard<std::mutex> lock(m_mutex);
-  m_cache.clear();
-  m_accessOrder.clear();
-  m_orderIterators.clear();
-  m_currentSize = 0;
-  m_stats.entryCount = 0;
+  for (auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->policy->clear();
+    while (!shard->entries.empty()) {
+      erase(*shard, shard->entries.begin());
+    }
+  }
+  m_clock->inflation = 0.0;
 }
 
 bool ResourceCache::contains(const ResourceId &id) const {
-  std::lock_guard<std::mutex> lock(m_mutex);
-  return m_cache.find(id) != m_cache.end();
+  Shard &shard = shardFor(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.entries.find(id) != shard.entries.end();
 }
 
 CacheStats ResourceCache::stats() const {
-  std::lock_guard<std::mutex> lock(m_mutex);
+  CacheStats result;
+  for (usize i = 0; i < m_shards.size(); ++i) {
+    addStats(result, shardStats(i));
+  }
+  return result;
+}
 
-  CacheStats result = m_stats;
-  result.totalSize = m_currentSize;
-  result.entryCount = m_cache.size();
+CacheStats ResourceCache::shardStats(usize shard) const {
+  if (shard >= m_shards.size()) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(m_shards[shard]->mutex);
+  return m_shards[shard]->stats;
+}
+
+CacheStats ResourceCache::typeStats(ResourceType type) const {
+  CacheStats result;
+  for (const auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    addStats(result, shard->typeStats[typeIndex(type)]);
+  }
   return result;
 }
 
 void ResourceCache::resetStats() {
-  std::lock_guard<std::mutex> lock(m_mutex);
-  m_stats.hitCount = 0;
-  m_stats.missCount = 0;
-  m_stats.evictionCount = 0;
+  for (auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    resetCounts(shard->stats);
+    for (auto &stats : shard->typeStats) {
+      resetCounts(stats);
+    }
+  }
+}
+
+ResourceCache::Shard &ResourceCache::shardFor(const ResourceId &id) const {
+  return *m_shards[static_cast<usize>(id.hash() % m_shards.size())];
+}
+
+ResourceCache::TypeCounters &
+ResourceCache::counters(ResourceType type) const {
+  return m_types[typeIndex(type)];
+}
+
+u32 ResourceCache::partitionOf(ResourceType type) const {
+  if (counters(type).budget.load() > 0) {
+    return resourceTypeBit(static_cast<ResourceType>(typeIndex(type)));
+  }
+
+  u32 mask = 0;
+  for (usize i = 0; i < RESOURCE_TYPE_COUNT; ++i) {
+    if (m_types[i].budget.load() == 0) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+}
+
+usize ResourceCache::partitionSize(u32 typeMask) const {
+  usize size = 0;
+  for (usize i = 0; i < RESOURCE_TYPE_COUNT; ++i) {
+    if ((typeMask & (1u << i)) != 0) {
+      size += m_types[i].size.load();
+    }
+  }
+  return size;
+}
+
+usize ResourceCache::partitionCapacity(ResourceType type) const {
+  const usize budget = counters(type).budget.load();
+  if (budget > 0) {
+    return budget;
+  }
+
+  usize reserved = 0;
+  for (const auto &counter : m_types) {
+    reserved += counter.budget.load();
+  }
+  const usize total = maxSize();
+  return reserved < total ? total - reserved : 0;
+}
+
+void ResourceCache::makeRoom(ResourceType type, usize required) {
+  const u32 partition = partitionOf(type);
+  const usize capacity = partitionCapacity(type);
+  while (partitionSize(partition) + required > capacity &&
+         evictOne(partition)) {
+  }
+
+  // Budgets larger than the cache can still overflow it
+  while (currentSize() + required > maxSize() &&
+         evictOne(ALL_RESOURCE_TYPES)) {
+  }
+}
+
+void ResourceCache::enforceLimits() {
+  for (usize i = 0; i < RESOURCE_TYPE_COUNT; ++i) {
+    makeRoom(static_cast<ResourceType>(i), 0);
+  }
 }
 
-void ResourceCache::evictIfNeeded(usize requiredSpace) {
-  while (m_currentSize + requiredSpace > m_maxSize && !m_accessOrder.empty()) {
-    const ResourceId &lruId = m_accessOrder.back();
-    const auto it = m_cache.find(lruId);
+bool ResourceCache::evictOne(u32 typeMask) {
+  for (;;) {
+    // Ranks share the cache's clock, so the lowest across shards is the
+    // entry one policy over the whole cache would have chosen. A shard in
+    // use right now is passed over instead of waited for; only when every
+    // shard is busy does this wait on each in turn.
+    Shard *victimShard = nullptr;
+    f64 victimRank = 0.0;
+    std::optional<f64> runnerUp;
+    const auto rank = [&](Shard &shard) {
+      const std::optional<f64> r = shard.policy->peek(typeMask);
+      if (!r) {
+        return;
+      }
+      if (!victimShard || *r < victimRank) {
+        if (victimShard && (!runnerUp || victimRank < *runnerUp)) {
+          runnerUp = victimRank;
+        }
+        victimShard = &shard;
+        victimRank = *r;
+      } else if (!runnerUp || *r < *runnerUp) {
+        runnerUp = *r;
+      }
+    };
+    bool skipped = false;
+    for (auto &shard : m_shards) {
+      std::unique_lock<std::mutex> lock(shard->mutex, std::try_to_lock);
+      if (lock.owns_lock()) {
+        rank(*shard);
+      } else {
+        skipped = true;
+      }
+    }
+    if (!victimShard && skipped) {
+      for (auto &shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        rank(*shard);
+      }
+    }
+    if (!victimShard) {
+      return false;
+    }
 
-    if (it != m_cache.end()) {
-      m_currentSize -= it->second.data.size();
-      m_cache.erase(it);
-      ++m_stats.evictionCount;
+    // A spared entry is ranked again behind the others, so stay in this
+    // shard only while its next candidate still ranks lowest
+    Shard &shard = *victimShard;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    bool outranked = false;
+    while (!outranked && shard.policy->spareNext(typeMask)) {
+      const std::optional<f64> next = shard.policy->peek(typeMask);
+      outranked = next && runnerUp && *next > *runnerUp;
+    }
+    if (outranked) {
+      continue;
     }
 
-    m_orderIterators.erase(lruId);
-    m_accessOrder.pop_back();
+    // The shard may have changed since it was ranked; its policy still
+    // picks its own best victim, and the caller rechecks the sizes
+    const ResourceId *victim = shard.policy->evict(typeMask);
+    if (victim) {
+      const auto it = shard.entries.find(*victim);
+      if (it != shard.entries.end()) {
+        ++shard.stats.evictionCount;
+        ++shard.typeStats[typeIndex(it->first.type())].evictionCount;
+        erase(shard, it);
+      }
+    }
+    return true;
   }
 }
 
-void ResourceCache::updateAccessOrder(const ResourceId &id) {
-  const auto orderIt = m_orderIterators.find(id);
-  if (orderIt != m_orderIterators.end()) {
-    m_accessOrder.erase(orderIt->second);
-    m_accessOrder.push_front(id);
-    m_orderIterators[id] = m_accessOrder.begin();
+void ResourceCache::erase(Shard &shard, EntryMap::iterator it) {
+  account(shard, it->first.type(), it->second.data.size(), false);
+  shard.entries.erase(it);
+}
+
+void ResourceCache::account(Shard &shard, ResourceType type, usize size,
+                            bool added) {
+  CacheStats &typeStats = shard.typeStats[typeIndex(type)];
+  if (added) {
+    shard.stats.totalSize += size;
+    ++shard.stats.entryCount;
+    typeStats.totalSize += size;
+    ++typeStats.entryCount;
+    counters(type).size += size;
+    m_currentSize += size;
+    ++m_entryCount;
+  } else {
+    shard.stats.totalSize -= size;
+    --shard.stats.entryCount;
+    typeStats.totalSize -= size;
+    --typeStats.entryCount;
+    counters(type).size -= size;
+    m_currentSize -= size;
+    --m_entryCount;
   }
 }
 
@@ -6,16 +6,24 @@ namespace NovelMind::VFS {
 namespace {
 std::unique_ptr<VirtualFileSystem> g_globalVFS;
 std::mutex g_globalVFSMutex;
+
+ResourceCacheConfig cacheConfig(const VFSConfig &config) {
+  ResourceCacheConfig result;
+  result.maxSize = config.cacheMaxSize;
+  result.shardCount = config.cacheShardCount;
+  result.policy = config.cachePolicy;
+  return result;
+}
 } // anonymous namespace
 
 VirtualFileSystem::VirtualFileSystem()
     : m_config(),
-      m_cache(std::make_unique<ResourceCache>(m_config.cacheMaxSize)) {}
+      m_cache(std::make_unique<ResourceCache>(cacheConfig(m_config))) {}
 
 VirtualFileSystem::VirtualFileSystem(const VFSConfig &config)
     : m_config(config),
       m_cache(config.enableCaching
-                  ? std::make_unique<ResourceCache>(config.cacheMaxSize)
+                  ? std::make_unique<ResourceCache>(cacheConfig(config))
                   : nullptr) {}
 
 VirtualFileSystem::~VirtualFileSystem() { shutdown(); }
@@ -83,7 +91,7 @@ std::unique_ptr<IFileHandle>
 VirtualFileSystem::openStream(const ResourceId &id) {
   std::lock_guard<std::mutex> lock(m_mutex);
 
-  IFileSystemBackend *backend = findBackend(id);
+  const auto backend = findBackend(id);
   if (!backend) {
     return nullptr;
   }
@@ -96,20 +104,31 @@ VirtualFileSystem::openStream(const ResourceId &id) {
   return handle;
 }
 
-Result<std::vector<u8>> VirtualFileSystem::readAll(const ResourceId &id) {
+Result<core::ByteBuffer> VirtualFileSystem::readAll(const ResourceId &id) {
   if (m_config.enableCaching && m_cache) {
     auto cached = m_cache->get(id);
     if (cached.has_value()) {
-      return Result<std::vector<u8>>::ok(std::move(*cached));
+      return Result<core::ByteBuffer>::ok(std::move(*cached));
     }
   }
 
-  auto handle = openStream(id);
-  if (!handle || !handle->isValid()) {
-    return Result<std::vector<u8>>::error("Resource not found: " + id.id());
+  // Only the lookup is locked; the read and any decompression are not, so
+  // misses on different threads load in parallel
+  std::shared_ptr<IFileSystemBackend> backend;
+  ResourceLoadCallback loadCallback;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    backend = findBackend(id);
+    loadCallback = m_loadCallback;
   }
 
-  auto result = handle->readAll();
+  Result<core::ByteBuffer> result =
+      backend ? backend->read(id)
+              : Result<core::ByteBuffer>::error("Resource not found: " +
+                                                id.id());
+  if (loadCallback) {
+    loadCallback(id, result.isOk());
+  }
   if (!result.isOk()) {
     return result;
   }
@@ -121,7 +140,7 @@ Result<std::vector<u8>> VirtualFileSystem::readAll(const ResourceId &id) {
   return result;
 }
 
-Result<std::vector<u8>> VirtualFileSystem::readAll(const std::string &id) {
+Result<core::ByteBuffer> VirtualFileSystem::readAll(const std::string &id) {
   return readAll(ResourceId(id));
 }
 
@@ -183,6 +202,12 @@ void VirtualFileSystem::setCacheMaxSize(usize maxSize) {
   }
 }
 
+void VirtualFileSystem::setCacheTypeBudget(ResourceType type, usize budget) {
+  if (m_cache) {
+    m_cache->setTypeBudget(type, budget);
+  }
+}
+
 VFSStats VirtualFileSystem::stats() const {
   std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -201,10 +226,11 @@ VFSStats VirtualFileSystem::stats() const {
   return result;
 }
 
-IFileSystemBackend *VirtualFileSystem::findBackend(const ResourceId &id) const {
+std::shared_ptr<IFileSystemBackend>
+VirtualFileSystem::findBackend(const ResourceId &id) const {
   for (const auto &backend : m_backends) {
     if (backend->exists(id)) {
-      return backend.get();
+      return backend;
     }
   }
 
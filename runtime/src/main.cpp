@@ -22,6 +22,7 @@
 #include "NovelMind/scripting/parser.hpp"
 #include "NovelMind/scripting/validator.hpp"
 #include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/script_image.hpp"
 #include "NovelMind/scripting/script_runtime.hpp"
 #include "NovelMind/scripting/vm.hpp"
 #include "NovelMind/core/types.hpp"
@@ -611,93 +612,128 @@ NovelMind::scripting::CompiledScript compileScript(const std::string& source, bo
     return std::move(compileResult).value();
 }
 
+// Reads the fields of an NMC1 file, throwing on a short read or on a count
+// that could not fit in the rest of the file
+class CompiledScriptReader {
+public:
+    CompiledScriptReader(std::ifstream& file, std::uintmax_t fileSize)
+        : m_file(file), m_fileSize(fileSize) {}
+
+    void read(void* data, std::size_t size, const char* what) {
+        if (size > remaining() ||
+            !m_file.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error(std::string("Truncated compiled script: ") + what);
+        }
+        m_offset += size;
+    }
+
+    NovelMind::u32 readU32(const char* what) {
+        NovelMind::u32 value = 0;
+        read(&value, sizeof(value), what);
+        return value;
+    }
+
+    // A count of items taking at least itemSize bytes each
+    NovelMind::u32 readCount(std::size_t itemSize, const char* what) {
+        NovelMind::u32 count = readU32(what);
+        if (count > remaining() / itemSize) {
+            throw std::runtime_error(std::string("Corrupt compiled script: ") + what +
+                                     " count " + std::to_string(count) +
+                                     " exceeds the file size");
+        }
+        return count;
+    }
+
+    std::string readString(const char* what) {
+        std::string str(readCount(1, what), '\0');
+        read(str.data(), str.size(), what);
+        return str;
+    }
+
+    [[nodiscard]] bool atEnd() const { return remaining() == 0; }
+
+private:
+    [[nodiscard]] std::uintmax_t remaining() const { return m_fileSize - m_offset; }
+
+    std::ifstream& m_file;
+    std::uintmax_t m_fileSize;
+    std::uintmax_t m_offset = 0;
+};
+
 NovelMind::scripting::CompiledScript loadCompiledScript(const std::string& path) {
+    std::error_code sizeError;
+    const std::uintmax_t fileSize = fs::file_size(path, sizeError);
     std::ifstream file(path, std::ios::binary);
-    if (!file.is_open()) {
+    if (sizeError || !file.is_open()) {
         throw std::runtime_error("Cannot open file: " + path);
     }
 
     NovelMind::scripting::CompiledScript script;
+    CompiledScriptReader reader(file, fileSize);
 
     // Read and verify magic number
     char magic[5] = {0};
-    file.read(magic, 4);
+    reader.read(magic, 4, "magic");
+    if (std::string(magic) == "NMSC") {
+        auto image = NovelMind::scripting::ScriptImage::open(path);
+        if (image.isError()) {
+            throw std::runtime_error(image.error());
+        }
+        return image.value()->toCompiledScript();
+    }
     if (std::string(magic) != "NMC1") {
         throw std::runtime_error("Invalid compiled script format");
     }
 
     // Read version
-    NovelMind::u32 version;
-    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    (void)reader.readU32("version");
 
     // Read instructions
-    NovelMind::u32 instrCount;
-    file.read(reinterpret_cast<char*>(&instrCount), sizeof(instrCount));
-
+    const NovelMind::u32 instrCount =
+        reader.readCount(sizeof(NovelMind::scripting::OpCode) + sizeof(NovelMind::u32),
+                         "instruction");
     script.instructions.resize(instrCount);
-    for (NovelMind::u32 i = 0; i < instrCount; ++i) {
-        file.read(reinterpret_cast<char*>(&script.instructions[i].opcode),
-                  sizeof(script.instructions[i].opcode));
-        file.read(reinterpret_cast<char*>(&script.instructions[i].operand),
-                  sizeof(script.instructions[i].operand));
+    for (auto& instr : script.instructions) {
+        reader.read(&instr.opcode, sizeof(instr.opcode), "instruction");
+        reader.read(&instr.operand, sizeof(instr.operand), "instruction");
     }
 
     // Read string table
-    NovelMind::u32 strCount;
-    file.read(reinterpret_cast<char*>(&strCount), sizeof(strCount));
-
-    script.stringTable.resize(strCount);
+    const NovelMind::u32 strCount = reader.readCount(sizeof(NovelMind::u32), "string");
+    script.stringTable.reserve(strCount);
     for (NovelMind::u32 i = 0; i < strCount; ++i) {
-        NovelMind::u32 len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        script.stringTable[i].resize(len);
-        file.read(&script.stringTable[i][0], len);
+        script.stringTable.push_back(reader.readString("string"));
     }
 
     // Read scene entry points
-    NovelMind::u32 sceneCount;
-    file.read(reinterpret_cast<char*>(&sceneCount), sizeof(sceneCount));
-
+    const NovelMind::u32 sceneCount =
+        reader.readCount(2 * sizeof(NovelMind::u32), "scene");
     for (NovelMind::u32 i = 0; i < sceneCount; ++i) {
-        NovelMind::u32 nameLen;
-        file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
-        std::string name(nameLen, '\0');
-        file.read(&name[0], nameLen);
-
-        NovelMind::u32 index;
-        file.read(reinterpret_cast<char*>(&index), sizeof(index));
-
-        script.sceneEntryPoints[name] = index;
+        std::string name = reader.readString("scene name");
+        script.sceneEntryPoints[name] = reader.readU32("scene entry");
     }
 
     // Read characters
-    NovelMind::u32 charCount;
-    file.read(reinterpret_cast<char*>(&charCount), sizeof(charCount));
-
+    const NovelMind::u32 charCount =
+        reader.readCount(3 * sizeof(NovelMind::u32), "character");
     for (NovelMind::u32 i = 0; i < charCount; ++i) {
-        NovelMind::scripting::CharacterDecl ch;
-
-        // ID
-        NovelMind::u32 idLen;
-        file.read(reinterpret_cast<char*>(&idLen), sizeof(idLen));
-        ch.id.resize(idLen);
-        file.read(&ch.id[0], idLen);
-
-        // Display name
-        NovelMind::u32 nameLen;
-        file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
-        ch.displayName.resize(nameLen);
-        file.read(&ch.displayName[0], nameLen);
-
-        // Color
-        NovelMind::u32 colorLen;
-        file.read(reinterpret_cast<char*>(&colorLen), sizeof(colorLen));
-        ch.color.resize(colorLen);
-        file.read(&ch.color[0], colorLen);
-
+        NovelMind::scripting::CompiledCharacter ch;
+        ch.id = reader.readString("character id");
+        ch.displayName = reader.readString("character name");
+        ch.color = reader.readString("character color");
         script.characters[ch.id] = ch;
     }
 
+    // Read variable slots (absent in scripts compiled before slot addressing)
+    if (!reader.atEnd()) {
+        const NovelMind::u32 slotCount =
+            reader.readCount(sizeof(NovelMind::u32), "variable slot");
+        script.variableSlots.reserve(slotCount);
+        for (NovelMind::u32 i = 0; i < slotCount; ++i) {
+            script.variableSlots.push_back(reader.readString("variable slot"));
+        }
+    }
+
     return script;
 }
 
@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/vfs/block_codec.hpp"
+
+#include <random>
+#include <string>
+
+using namespace NovelMind;
+using namespace NovelMind::vfs;
+
+namespace {
+
+std::vector<u8> roundTrip(const std::vector<u8>& data, BlockCodec::Level level, usize& compressedSize)
+{
+    std::vector<u8> packed(BlockCodec::maxCompressedSize(data.size()));
+    compressedSize = BlockCodec::compress(data, packed, level);
+    REQUIRE(compressedSize != 0);
+    packed.resize(compressedSize);
+
+    std::vector<u8> unpacked(data.size());
+    REQUIRE(BlockCodec::decompress(packed, unpacked).isOk());
+    return unpacked;
+}
+
+std::vector<u8> textLike(usize size)
+{
+    const std::string words[] = {"say ", "Hero ", "\"Hello\" ", "scene ", "goto ", "{\n", "}\n", "choice "};
+    std::mt19937 rng(7);
+    std::vector<u8> data;
+    while (data.size() < size) {
+        const std::string& word = words[rng() % 8];
+        data.insert(data.end(), word.begin(), word.end());
+    }
+    data.resize(size);
+    return data;
+}
+
+std::vector<u8> noise(usize size)
+{
+    std::mt19937 rng(11);
+    std::vector<u8> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("BlockCodec round-trips data of every shape", "[vfs][block_codec]")
+{
+    for (auto level : {BlockCodec::Level::Fast, BlockCodec::Level::High}) {
+        std::vector<std::vector<u8>> inputs = {
+            {},
+            {42},
+            std::vector<u8>(12, 'a'),
+            std::vector<u8>(13, 'a'),
+            std::vector<u8>(100000, 0),
+            textLike(5000),
+            textLike(300000), // Matches across the 64 KiB window
+            noise(4096),
+        };
+        // Long literal runs between matches
+        auto mixed = noise(70000);
+        const auto text = textLike(70000);
+        mixed.insert(mixed.end(), text.begin(), text.end());
+        inputs.push_back(mixed);
+
+        for (const auto& input : inputs) {
+            usize compressed = 0;
+            CHECK(roundTrip(input, level, compressed) == input);
+            CHECK(compressed <= BlockCodec::maxCompressedSize(input.size()));
+        }
+    }
+}
+
+TEST_CASE("BlockCodec shrinks repetitive data", "[vfs][block_codec]")
+{
+    const auto text = textLike(200000);
+    usize fast = 0;
+    usize high = 0;
+    (void)roundTrip(text, BlockCodec::Level::Fast, fast);
+    (void)roundTrip(text, BlockCodec::Level::High, high);
+    CHECK(fast < text.size() / 2);
+    CHECK(high <= fast);
+
+    // Noise does not compress, but stays within the bound
+    usize random = 0;
+    (void)roundTrip(noise(50000), BlockCodec::Level::Fast, random);
+    CHECK(random > 50000);
+}
+
+TEST_CASE("BlockCodec compress reports a small output buffer", "[vfs][block_codec]")
+{
+    const auto data = noise(1000);
+    std::vector<u8> packed(500);
+    CHECK(BlockCodec::compress(data, packed, BlockCodec::Level::Fast) == 0);
+    CHECK(BlockCodec::compress(data, packed, BlockCodec::Level::High) == 0);
+}
+
+TEST_CASE("BlockCodec rejects damaged blocks", "[vfs][block_codec]")
+{
+    const auto text = textLike(20000);
+    std::vector<u8> packed(BlockCodec::maxCompressedSize(text.size()));
+    packed.resize(BlockCodec::compress(text, packed, BlockCodec::Level::Fast));
+    std::vector<u8> unpacked(text.size());
+
+    // Wrong output sizes
+    std::vector<u8> shorter(text.size() - 1);
+    std::vector<u8> longer(text.size() + 1);
+    CHECK(BlockCodec::decompress(packed, shorter).isError());
+    CHECK(BlockCodec::decompress(packed, longer).isError());
+
+    // Truncated input
+    for (usize size : {usize{0}, usize{1}, packed.size() / 2, packed.size() - 1}) {
+        CHECK(BlockCodec::decompress({packed.data(), size}, unpacked).isError());
+    }
+
+    // An offset pointing before the start of the output
+    const std::vector<u8> badOffset = {0x10, 'a', 0xFF, 0x00, 0x00};
+    std::vector<u8> small(6);
+    CHECK(BlockCodec::decompress(badOffset, small).isError());
+
+    // Flipped bytes either fail or decode to something, but never overrun
+    std::mt19937 rng(3);
+    for (int i = 0; i < 200; ++i) {
+        auto damaged = packed;
+        damaged[rng() % damaged.size()] ^= static_cast<u8>(1 + rng() % 255);
+        (void)BlockCodec::decompress(damaged, unpacked);
+    }
+}
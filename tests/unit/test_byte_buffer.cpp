@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/core/byte_buffer.hpp"
+#include "NovelMind/vfs/resource_cache.hpp"
+#include "NovelMind/vfs/virtual_file_system.hpp"
+
+using namespace NovelMind;
+using core::ByteBuffer;
+
+namespace {
+
+std::vector<u8> bytesOf(const std::string& text)
+{
+    return {text.begin(), text.end()};
+}
+
+} // namespace
+
+TEST_CASE("ByteBuffer takes over a vector without copying", "[core][byte_buffer]")
+{
+    std::vector<u8> bytes = bytesOf("background pixels");
+    const u8* storage = bytes.data();
+
+    ByteBuffer buffer(std::move(bytes));
+    CHECK(buffer.data() == storage);
+    CHECK(buffer.size() == 17);
+    CHECK(buffer == bytesOf("background pixels"));
+    CHECK(buffer.useCount() == 1);
+
+    const ByteBuffer shared = buffer;
+    CHECK(shared.data() == storage);
+    CHECK(buffer.useCount() == 2);
+
+    // The bytes live as long as any copy does
+    buffer = ByteBuffer();
+    CHECK(buffer.empty());
+    CHECK(shared == bytesOf("background pixels"));
+    CHECK(shared.useCount() == 1);
+}
+
+TEST_CASE("ByteBuffer ranges share their owner", "[core][byte_buffer]")
+{
+    const ByteBuffer buffer(bytesOf("header|payload"));
+
+    const ByteBuffer payload = buffer.subspan(7, 100);
+    CHECK(payload.data() == buffer.data() + 7);
+    CHECK(payload == bytesOf("payload"));
+    CHECK(buffer.useCount() == 2);
+
+    CHECK(buffer.subspan(50, 4).empty());
+    CHECK(ByteBuffer().useCount() == 0);
+    CHECK(ByteBuffer(std::vector<u8>{}).empty());
+
+    auto owner = std::make_shared<const std::string>("mapped");
+    const ByteBuffer view(owner, {reinterpret_cast<const u8*>(owner->data()), owner->size()});
+    owner.reset();
+    CHECK(view == bytesOf("mapped"));
+
+    const ByteBuffer copy = ByteBuffer::copyOf(view);
+    CHECK(copy.data() != view.data());
+    CHECK(copy.toVector() == bytesOf("mapped"));
+}
+
+TEST_CASE("ResourceCache hits share the cached bytes", "[vfs][resource_cache]")
+{
+    VFS::ResourceCache cache(64);
+    const VFS::ResourceId id("bg/city");
+    const ByteBuffer image(bytesOf("city at night"));
+    cache.put(id, image);
+
+    auto first = cache.get(id);
+    auto second = cache.get(id);
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    CHECK(first->data() == image.data());
+    CHECK(second->data() == image.data());
+    CHECK(cache.currentSize() == 13);
+
+    // Evicted bytes stay valid for whoever still holds them
+    cache.put(VFS::ResourceId("bg/forest"), ByteBuffer(std::vector<u8>(60)));
+    CHECK_FALSE(cache.contains(id));
+    CHECK(*first == bytesOf("city at night"));
+}
+
+TEST_CASE("VirtualFileSystem shares resources with its cache", "[vfs][resource_cache]")
+{
+    auto backend = std::make_unique<VFS::MemoryBackend>();
+    backend->addResource("bg/city", bytesOf("city at night"), VFS::ResourceType::Texture);
+    VFS::VirtualFileSystem vfs;
+    vfs.registerBackend(std::move(backend));
+    REQUIRE(vfs.initialize().isOk());
+
+    auto miss = vfs.readAll("bg/city");
+    auto hit = vfs.readAll("bg/city");
+    REQUIRE(miss.isOk());
+    REQUIRE(hit.isOk());
+    CHECK(hit.value() == bytesOf("city at night"));
+    CHECK(hit.value().data() == miss.value().data());
+    CHECK(vfs.stats().cacheStats.hitCount == 1);
+
+    // Streams over memory resources read the same bytes
+    auto stream = vfs.openStream(VFS::ResourceId("bg/city"));
+    REQUIRE(stream);
+    CHECK(stream->readAll().value() == bytesOf("city at night"));
+
+    CHECK(vfs.readAll("bg/missing").isError());
+}
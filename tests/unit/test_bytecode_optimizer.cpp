@@ -0,0 +1,189 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/bytecode_optimizer.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/vm.hpp"
+
+#include <algorithm>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+CompiledScript compileSource(const std::string& source)
+{
+    Lexer lexer;
+    Parser parser;
+    Compiler compiler;
+
+    auto tokens = lexer.tokenize(source);
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    auto compiled = compiler.compile(program.value());
+    REQUIRE(compiled.isOk());
+    return compiled.value();
+}
+
+std::unordered_map<std::string, Value> runScript(const CompiledScript& script,
+                                                 DispatchMode mode)
+{
+    VirtualMachine vm;
+    vm.setDispatchMode(mode);
+    REQUIRE(vm.load(script.instructions, script.stringTable, script.variableSlots).isOk());
+    vm.run();
+    REQUIRE(vm.isHalted());
+    return vm.getVariables();
+}
+
+bool contains(const CompiledScript& script, OpCode op)
+{
+    return std::any_of(script.instructions.begin(), script.instructions.end(),
+                       [op](const Instruction& instr) { return instr.opcode == op; });
+}
+
+// Loops via goto so jump threading, folding and fusion all get exercised
+const char* kLoopScript = R"(
+scene start {
+    set total = 2 * 3 + 4
+    set i = 0
+    set label = "a" + "b"
+    goto loop
+    set total = 999
+}
+scene loop {
+    set i = i + 1
+    set total = total + i
+    if i < 50 {
+        goto loop
+    }
+    if 1 > 2 {
+        set total = -1
+    }
+    goto done
+}
+scene done {
+    set finished = true
+}
+)";
+
+} // namespace
+
+TEST_CASE("Optimizer at -O0 leaves bytecode untouched", "[scripting][optimizer]")
+{
+    CompiledScript script = compileSource(kLoopScript);
+    auto before = script.instructions.size();
+
+    BytecodeOptimizer optimizer(OptimizationLevel::None);
+    auto stats = optimizer.optimize(script);
+
+    REQUIRE(script.instructions.size() == before);
+    REQUIRE(stats.instructionsRemoved() == 0);
+}
+
+TEST_CASE("Optimizer preserves program behaviour", "[scripting][optimizer]")
+{
+    CompiledScript reference = compileSource(kLoopScript);
+    auto expected = runScript(reference, DispatchMode::Switch);
+    REQUIRE(asInt(expected.at("total")) == 10 + 50 * 51 / 2);
+    REQUIRE(asString(expected.at("label")) == "ab");
+
+    for (auto level : {OptimizationLevel::Basic, OptimizationLevel::Full}) {
+        CompiledScript script = reference;
+        BytecodeOptimizer optimizer(level);
+        auto stats = optimizer.optimize(script);
+
+        REQUIRE(stats.instructionsRemoved() > 0);
+        REQUIRE(stats.instructionsAfter == script.instructions.size());
+        REQUIRE(stats.constantsFolded > 0);
+        REQUIRE(stats.deadInstructions > 0);
+
+        for (auto mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+            auto actual = runScript(script, mode);
+            REQUIRE(actual.size() == expected.size());
+            for (const auto& [name, value] : expected) {
+                REQUIRE(asString(actual.at(name)) == asString(value));
+            }
+        }
+    }
+}
+
+TEST_CASE("Optimizer remaps scene entry points", "[scripting][optimizer]")
+{
+    CompiledScript script = compileSource(kLoopScript);
+    BytecodeOptimizer optimizer(OptimizationLevel::Full);
+    optimizer.optimize(script);
+
+    // Every scene still starts inside the program and the loop scene begins
+    // with the increment of i, now a single superinstruction
+    for (const auto& [name, entry] : script.sceneEntryPoints) {
+        REQUIRE(entry < script.instructions.size());
+    }
+    REQUIRE(script.instructions[script.sceneEntryPoints.at("loop")].opcode ==
+            OpCode::INC_SLOT);
+}
+
+TEST_CASE("Optimizer folds constants and removes dead code", "[scripting][optimizer]")
+{
+    CompiledScript script;
+    script.instructions = {
+        {OpCode::PUSH_INT, 2},  {OpCode::PUSH_INT, 3},    {OpCode::MUL, 0},
+        {OpCode::STORE_SLOT, 0}, {OpCode::PUSH_BOOL, 0}, {OpCode::JUMP_IF_NOT, 8},
+        {OpCode::PUSH_INT, 7},  {OpCode::STORE_SLOT, 0}, {OpCode::HALT, 0},
+        {OpCode::PUSH_INT, 1},  {OpCode::HALT, 0}};
+    script.variableSlots = {"x"};
+
+    BytecodeOptimizer optimizer(OptimizationLevel::Basic);
+    auto stats = optimizer.optimize(script);
+
+    REQUIRE(script.instructions.size() == 3);
+    REQUIRE(script.instructions[0].opcode == OpCode::PUSH_INT);
+    REQUIRE(script.instructions[0].operand == 6);
+    REQUIRE(script.instructions[1].opcode == OpCode::STORE_SLOT);
+    REQUIRE(script.instructions[2].opcode == OpCode::HALT);
+    REQUIRE(stats.instructionsRemoved() == 8);
+}
+
+TEST_CASE("Optimizer threads jump chains", "[scripting][optimizer]")
+{
+    CompiledScript script;
+    script.instructions = {
+        {OpCode::CHECK_FLAG, 0}, {OpCode::JUMP_IF, 4},  {OpCode::PUSH_INT, 1},
+        {OpCode::STORE_SLOT, 0}, {OpCode::JUMP, 5},     {OpCode::JUMP, 7},
+        {OpCode::PUSH_INT, 2},   {OpCode::HALT, 0}};
+    script.stringTable = {"seen"};
+    script.variableSlots = {"x"};
+
+    BytecodeOptimizer optimizer(OptimizationLevel::Basic);
+    auto stats = optimizer.optimize(script);
+
+    REQUIRE(stats.jumpsThreaded > 0);
+    REQUIRE_FALSE(contains(script, OpCode::JUMP));
+    REQUIRE(script.instructions[1].opcode == OpCode::JUMP_IF);
+    REQUIRE(script.instructions[script.instructions[1].operand].opcode == OpCode::HALT);
+}
+
+TEST_CASE("Optimizer fuses compare-and-branch only at -O2", "[scripting][optimizer]")
+{
+    CompiledScript basic = compileSource(kLoopScript);
+    CompiledScript full = basic;
+
+    BytecodeOptimizer(OptimizationLevel::Basic).optimize(basic);
+    auto stats = BytecodeOptimizer(OptimizationLevel::Full).optimize(full);
+
+    REQUIRE_FALSE(contains(basic, OpCode::SLOT_CMP_INT_JUMP_IF_NOT));
+    REQUIRE(contains(full, OpCode::SLOT_CMP_INT_JUMP_IF_NOT));
+    REQUIRE(stats.superinstructions > 0);
+    REQUIRE(full.instructions.size() < basic.instructions.size());
+}
+
+TEST_CASE("VM rejects truncated superinstructions", "[scripting][optimizer]")
+{
+    VirtualMachine vm;
+    std::vector<Instruction> program = {
+        {OpCode::SLOT_CMP_INT_JUMP_IF_NOT, packCompareOperand(0, CompareOp::Lt)},
+        {OpCode::EXTRA_ARG, 5}};
+
+    REQUIRE(vm.load(program, {}, {"x"}).isError());
+}
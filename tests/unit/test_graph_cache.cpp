@@ -0,0 +1,180 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/graph_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::unique_ptr<IRGraph> makeGraph()
+{
+    auto graph = std::make_unique<IRGraph>();
+    graph->setName("Cached \"graph\"");
+    const NodeId start = graph->createNode(IRNodeType::SceneStart);
+    const NodeId line = graph->createNode(IRNodeType::Dialogue);
+    const NodeId choice = graph->createNode(IRNodeType::Choice);
+    graph->getNode(line)->setProperty("text", std::string("Hello"));
+    graph->getNode(line)->setProperty("character", std::string("Hero"));
+    graph->getNode(line)->setPosition(40.0f, -12.5f);
+    graph->getNode(choice)->setProperty("options", std::vector<std::string>{"Hello", "Bye"});
+    graph->getNode(choice)->setProperty("timeout", 2.5);
+    graph->getNode(choice)->setProperty("count", i64{-7});
+    graph->getNode(choice)->setProperty("hidden", false);
+    graph->getNode(choice)->setProperty("none", nullptr);
+    (void)graph->connect({start, "exec_out", true}, {line, "exec_in", false});
+    (void)graph->connect({line, "exec_out", true}, {choice, "exec_in", false});
+    graph->addScene("intro", start);
+    graph->addCharacter("Hero", "Alex", "#ffcc00");
+    return graph;
+}
+
+std::string readFile(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+struct TempDir
+{
+    fs::path path = fs::temp_directory_path() / "novelmind_graph_cache_test";
+    TempDir() { fs::remove_all(path); fs::create_directories(path); }
+    ~TempDir() { fs::remove_all(path); }
+};
+
+} // namespace
+
+TEST_CASE("IR graph binary form round-trips", "[graph_cache]")
+{
+    auto graph = makeGraph();
+    const auto blob = graph->toBinary(42);
+    CHECK(blob == graph->toBinary(42));
+
+    auto loaded = IRGraph::fromBinary(blob.data(), blob.size(), 42);
+    REQUIRE(loaded.isOk());
+    const IRGraph& copy = *loaded.value();
+    CHECK(copy.getName() == graph->getName());
+    CHECK(copy.getNodes().size() == 3);
+    CHECK(copy.getConnections().size() == 2);
+    CHECK(copy.getSceneStartNode("intro") == 1);
+    CHECK(copy.hasCharacter("Hero"));
+    CHECK(copy.isConnected({2, "exec_out", true}, {3, "exec_in", false}));
+    CHECK(copy.getOutgoing(1).size() == 1);
+
+    const IRNode* line = copy.getNode(2);
+    REQUIRE(line);
+    CHECK(line->getType() == IRNodeType::Dialogue);
+    CHECK(line->getY() == -12.5f);
+    CHECK(line->getStringProperty("text") == "Hello");
+    const IRNode* choice = copy.getNode(3);
+    CHECK(std::get<std::vector<std::string>>(*choice->getProperty("options")) ==
+          std::vector<std::string>{"Hello", "Bye"});
+    CHECK(choice->getFloatProperty("timeout") == 2.5);
+    CHECK(choice->getIntProperty("count") == -7);
+    CHECK(std::holds_alternative<bool>(*choice->getProperty("hidden")));
+    CHECK(std::holds_alternative<std::nullptr_t>(*choice->getProperty("none")));
+
+    // The binary copy serializes to the same JSON members
+    CHECK(copy.toJson().size() == graph->toJson().size());
+}
+
+TEST_CASE("IR graph binary form rejects stale and damaged blobs", "[graph_cache]")
+{
+    const auto blob = makeGraph()->toBinary(7);
+    CHECK(IRGraph::fromBinary(blob.data(), blob.size(), 8).isError());
+    CHECK(VisualGraph::fromBinary(blob.data(), blob.size(), 7).isError());
+
+    for (usize size = 0; size < blob.size(); size += 5) {
+        CHECK(IRGraph::fromBinary(blob.data(), size, 7).isError());
+    }
+
+    // A string index past the table
+    auto damaged = blob;
+    const usize nameOffset = 24;
+    damaged[nameOffset] = 0xFF;
+    damaged[nameOffset + 1] = 0xFF;
+    CHECK(IRGraph::fromBinary(damaged.data(), damaged.size(), 7).isError());
+}
+
+TEST_CASE("Visual graph binary form round-trips", "[graph_cache]")
+{
+    VisualGraph graph;
+    graph.fromIR(*makeGraph());
+    const NodeId extra = graph.addNode("Wait", 300.0f, 20.0f);
+    graph.setNodeProperty(extra, "duration", "1.5");
+
+    const auto blob = graph.toBinary(1);
+    auto loaded = VisualGraph::fromBinary(blob.data(), blob.size(), 1);
+    REQUIRE(loaded.isOk());
+
+    GraphDiffer differ;
+    CHECK(differ.diff(graph, *loaded.value()).isEmpty());
+    const VisualGraphNode* node = loaded.value()->findNode(extra);
+    REQUIRE(node);
+    CHECK(node->properties.at("duration") == "1.5");
+    CHECK(node->inputPorts == graph.findNode(extra)->inputPorts);
+    CHECK(node->outputPorts == graph.findNode(extra)->outputPorts);
+    CHECK(loaded.value()->addNode("Wait", 0.0f, 0.0f) == extra + 1);
+}
+
+TEST_CASE("GraphCache loads unchanged graphs from the binary entry", "[graph_cache]")
+{
+    TempDir temp;
+    const std::string jsonPath = (temp.path / "story.json").string();
+    GraphCache cache((temp.path / "cache").string());
+
+    auto graph = makeGraph();
+    REQUIRE(graph->saveJson(jsonPath).isOk());
+
+    auto first = cache.loadIRGraph(jsonPath);
+    REQUIRE(first.isOk());
+    CHECK(cache.getStats().misses == 1);
+    CHECK(cache.getStats().hits == 0);
+
+    auto second = cache.loadIRGraph(jsonPath);
+    REQUIRE(second.isOk());
+    CHECK(cache.getStats().hits == 1);
+    CHECK(second.value()->toJson().size() == graph->toJson().size());
+
+    // Editing the JSON invalidates the entry
+    graph->getNode(2)->setProperty("text", std::string("Changed"));
+    REQUIRE(graph->saveJson(jsonPath).isOk());
+    auto edited = cache.loadIRGraph(jsonPath);
+    REQUIRE(edited.isOk());
+    CHECK(edited.value()->getNode(2)->getStringProperty("text") == "Changed");
+    CHECK(cache.getStats().misses == 2);
+
+    // A corrupt entry is a miss and gets rewritten
+    for (const auto& entry : fs::directory_iterator(temp.path / "cache")) {
+        std::ofstream(entry.path(), std::ios::binary | std::ios::trunc) << "junk";
+    }
+    REQUIRE(cache.loadIRGraph(jsonPath).isOk());
+    CHECK(cache.getStats().misses == 3);
+    REQUIRE(cache.loadIRGraph(jsonPath).isOk());
+    CHECK(cache.getStats().hits == 2);
+}
+
+TEST_CASE("GraphCache saves the JSON and its entry together", "[graph_cache]")
+{
+    TempDir temp;
+    const std::string jsonPath = (temp.path / "story.graph.json").string();
+    GraphCache cache((temp.path / "cache").string());
+
+    VisualGraph graph;
+    graph.fromIR(*makeGraph());
+    REQUIRE(cache.saveVisualGraph(graph, jsonPath).isOk());
+    CHECK(readFile(jsonPath) == graph.toJson());
+
+    auto loaded = cache.loadVisualGraph(jsonPath);
+    REQUIRE(loaded.isOk());
+    CHECK(cache.getStats().hits == 1);
+    GraphDiffer differ;
+    CHECK(differ.diff(graph, *loaded.value()).isEmpty());
+
+    CHECK(cache.loadVisualGraph((temp.path / "missing.json").string()).isError());
+    std::ofstream(jsonPath, std::ios::trunc) << "{\"nodes\": [";
+    CHECK(cache.loadVisualGraph(jsonPath).isError());
+}
@@ -0,0 +1,200 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/incremental_validator.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+const char* kStory = R"(character Hero(name="Alex")
+character Sage(name="Elder")
+
+scene start {
+    say Hero "Where are we?"
+    set trust = 1
+    goto harbour
+}
+
+scene harbour {
+    say Sage "The tide is turning"
+    choice {
+        "Follow" -> goto cliffs
+        "Stay" -> { set stayed = true }
+    }
+}
+
+scene cliffs {
+    if trust > 0 {
+        say Hero "Together, then"
+    }
+    goto start
+}
+)";
+
+using Diagnostic = std::tuple<ErrorCode, std::string, u32, u32>;
+
+std::vector<Diagnostic> describe(const ErrorList& errors)
+{
+    std::vector<Diagnostic> out;
+    for (const auto& error : errors.all()) {
+        out.emplace_back(error.code, error.message, error.span.start.line,
+                         error.span.start.column);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::vector<Diagnostic> fresh(const std::string& text)
+{
+    IncrementalValidator document;
+    document.open(text);
+    return describe(document.getDiagnostics());
+}
+
+TextEdit replace(const std::string& text, const std::string& from, const std::string& to)
+{
+    const usize offset = text.find(from);
+    REQUIRE(offset != std::string::npos);
+    return {offset, from.size(), to};
+}
+
+bool hasMessage(const ErrorList& errors, const std::string& message)
+{
+    for (const auto& error : errors.all()) {
+        if (error.message == message) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST_CASE("Incremental validator matches the full validator", "[incremental_validator]")
+{
+    Lexer lexer;
+    Parser parser;
+    auto tokens = lexer.tokenize(kStory);
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    Validator validator;
+    auto full = validator.validate(program.value());
+
+    IncrementalValidator document;
+    document.open(kStory);
+    CHECK(document.getLastUpdate().sections == 5);
+
+    auto messages = [](const ErrorList& errors) {
+        std::vector<std::pair<ErrorCode, std::string>> out;
+        for (const auto& error : errors.all()) {
+            out.emplace_back(error.code, error.message);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    CHECK(messages(document.getDiagnostics()) == messages(full.errors));
+    CHECK(hasMessage(document.getDiagnostics(), "Variable 'stayed' is set but never read"));
+}
+
+TEST_CASE("Incremental validator edits match reopening the text", "[incremental_validator]")
+{
+    IncrementalValidator document;
+    document.open(kStory);
+
+    const std::vector<std::pair<std::string, std::string>> edits = {
+        {"Where are we?", "Where are we now?"},
+        {"goto harbour", "goto harbor"},
+        {"scene harbour", "scene harbor"},
+        {"say Sage", "say Ghost"},
+        {"character Sage(name=\"Elder\")\n", ""},
+        {"scene cliffs {", "scene cliffs {\n    set trust = 2\n}\nscene ledge {"},
+        {"    goto start\n}", "    goto start\n}\nscene start {\n}"},
+        {"set stayed = true", "set stayed = trust"},
+    };
+    for (const auto& [from, to] : edits) {
+        REQUIRE(document.edit(replace(document.getText(), from, to)).isOk());
+        CHECK(describe(document.getDiagnostics()) == fresh(document.getText()));
+    }
+    CHECK(hasMessage(document.getDiagnostics(), "Undefined character 'Ghost'"));
+    CHECK(hasMessage(document.getDiagnostics(), "Scene 'start' is already defined"));
+}
+
+TEST_CASE("Incremental validator reparses only the edited section", "[incremental_validator]")
+{
+    IncrementalValidator document;
+    document.open(kStory);
+
+    REQUIRE(document.edit(replace(document.getText(), "The tide", "The cold tide")).isOk());
+    CHECK(document.getLastUpdate().reparsed == 1);
+    CHECK(document.getLastUpdate().revalidated == 1);
+    CHECK(describe(document.getDiagnostics()) == fresh(document.getText()));
+}
+
+TEST_CASE("Incremental validator revalidates sections that reference a renamed scene",
+          "[incremental_validator]")
+{
+    IncrementalValidator document;
+    document.open(kStory);
+    CHECK_FALSE(document.getDiagnostics().hasErrors());
+
+    REQUIRE(document.edit(replace(document.getText(), "scene cliffs", "scene bluffs")).isOk());
+    CHECK(document.getLastUpdate().reparsed == 1);
+    CHECK(document.getLastUpdate().revalidated == 2);
+    CHECK(hasMessage(document.getDiagnostics(), "Undefined scene 'cliffs' in choice goto"));
+
+    REQUIRE(document.edit(replace(document.getText(), "scene bluffs", "scene cliffs")).isOk());
+    CHECK_FALSE(document.getDiagnostics().hasErrors());
+}
+
+TEST_CASE("Incremental validator extends the region over an open brace",
+          "[incremental_validator]")
+{
+    IncrementalValidator document;
+    document.open(kStory);
+
+    // Until the brace closes, the scenes after it are part of one section
+    REQUIRE(document.edit(replace(document.getText(), "say Hero \"Where", "if trust > 1 {\n    say Hero \"Where")).isOk());
+    CHECK(document.getLastUpdate().sections == 3);
+    CHECK(document.getDiagnostics().hasErrors());
+    CHECK(describe(document.getDiagnostics()) == fresh(document.getText()));
+
+    REQUIRE(document.edit(replace(document.getText(), "goto harbour", "goto harbour }")).isOk());
+    CHECK(document.getLastUpdate().sections == 5);
+    CHECK(describe(document.getDiagnostics()) == fresh(document.getText()));
+    CHECK_FALSE(document.getDiagnostics().hasErrors());
+}
+
+TEST_CASE("Incremental validator ignores declarations inside comments",
+          "[incremental_validator]")
+{
+    IncrementalValidator document;
+    document.open(kStory);
+
+    REQUIRE(document.edit(replace(document.getText(), "scene harbour {", "/* draft\nscene harbour {")).isOk());
+    REQUIRE(document.edit(replace(document.getText(), "goto start\n}", "goto start\n}\n*/")).isOk());
+    CHECK(document.getLastUpdate().sections == 3);
+    CHECK(describe(document.getDiagnostics()) == fresh(document.getText()));
+    CHECK(hasMessage(document.getDiagnostics(), "Undefined scene 'harbour'"));
+}
+
+TEST_CASE("Incremental validator rejects edits outside the document",
+          "[incremental_validator]")
+{
+    IncrementalValidator document;
+    document.open("scene start {\n}\n");
+
+    CHECK(document.edit({100, 0, "x"}).isError());
+    CHECK(document.edit({4, 100, ""}).isError());
+    CHECK(document.getText() == "scene start {\n}\n");
+
+    REQUIRE(document.edit({0, document.getText().size(), ""}).isOk());
+    CHECK(document.getDiagnostics().all().empty());
+    REQUIRE(document.edit({0, 0, "scene again {\n}\n"}).isOk());
+    CHECK(document.getLastUpdate().sections == 1);
+}
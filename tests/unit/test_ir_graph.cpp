@@ -0,0 +1,411 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/core/json.hpp"
+#include "NovelMind/core/thread_pool.hpp"
+#include "NovelMind/scripting/ir.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+PortId out(NodeId id, const std::string& port = "exec_out")
+{
+    return {id, port, true};
+}
+
+PortId in(NodeId id, const std::string& port = "exec_in")
+{
+    return {id, port, false};
+}
+
+// The adjacency views must agree with a scan of every connection
+void checkIndexed(const IRGraph& graph)
+{
+    for (const auto* node : graph.getNodes()) {
+        const NodeId id = node->getId();
+        usize from = 0;
+        usize to = 0;
+        for (const auto& conn : graph.getConnections()) {
+            from += conn.source.nodeId == id ? 1 : 0;
+            to += conn.target.nodeId == id ? 1 : 0;
+        }
+        REQUIRE(graph.getOutgoing(id).size() == from);
+        REQUIRE(graph.getIncoming(id).size() == to);
+        for (const auto& conn : graph.getOutgoing(id)) {
+            CHECK(conn.source.nodeId == id);
+        }
+        for (const auto& conn : graph.getIncoming(id)) {
+            CHECK(conn.target.nodeId == id);
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("IR graph indexes connections by node", "[ir_graph]")
+{
+    IRGraph graph;
+    const NodeId start = graph.createNode(IRNodeType::SceneStart);
+    const NodeId a = graph.createNode(IRNodeType::Dialogue);
+    const NodeId b = graph.createNode(IRNodeType::Dialogue);
+    const NodeId end = graph.createNode(IRNodeType::SceneEnd);
+
+    REQUIRE(graph.connect(out(start), in(a)).isOk());
+    REQUIRE(graph.connect(out(a), in(b)).isOk());
+    REQUIRE(graph.connect(out(a, "choice_1"), in(end)).isOk());
+    REQUIRE(graph.connect(out(b), in(end)).isOk());
+    REQUIRE(graph.connect(out(b), in(end)).isOk());
+    CHECK(graph.connect(out(b), in(99)).isError());
+
+    CHECK(graph.getConnections().size() == 4);
+    CHECK(graph.getOutgoing(a).size() == 2);
+    CHECK(graph.getIncoming(end).size() == 2);
+    CHECK(graph.getConnectionsFrom(a).size() == 2);
+    CHECK(graph.isConnected(out(a, "choice_1"), in(end)));
+    CHECK_FALSE(graph.isConnected(out(a), in(end)));
+    CHECK(graph.getOutgoing(99).empty());
+    checkIndexed(graph);
+
+    // Removing a connection keeps the others in the order they were made
+    graph.disconnect(out(start), in(a));
+    CHECK_FALSE(graph.isConnected(out(start), in(a)));
+    CHECK(graph.isConnected(out(b), in(end)));
+    CHECK(graph.getIncoming(a).empty());
+    REQUIRE(graph.getConnections().size() == 3);
+    CHECK(graph.getConnections()[0].source == out(a));
+    CHECK(graph.getConnections()[1].source == out(a, "choice_1"));
+    CHECK(graph.getConnections()[2].source == out(b));
+    checkIndexed(graph);
+
+    graph.removeNode(b);
+    CHECK(graph.getConnections().size() == 1);
+    CHECK(graph.getIncoming(end).size() == 1);
+    CHECK(graph.getIncoming(end).begin()->source.nodeId == a);
+    checkIndexed(graph);
+}
+
+TEST_CASE("IR graph keeps connection order when removing nodes", "[ir_graph]")
+{
+    IRGraph graph;
+    std::vector<NodeId> nodes;
+    for (int i = 0; i < 5; ++i) {
+        nodes.push_back(graph.createNode(IRNodeType::Sequence));
+    }
+    // Node 2 has edges on both sides and a self-loop
+    const std::vector<std::pair<usize, usize>> edges = {{0, 1}, {2, 3}, {1, 2}, {2, 2},
+                                                        {3, 4}, {0, 2}, {4, 0}};
+    for (const auto& [from, to] : edges) {
+        REQUIRE(graph.connect(out(nodes[from]), in(nodes[to], "in_" + std::to_string(from)))
+                    .isOk());
+    }
+
+    graph.removeNode(nodes[2]);
+    REQUIRE(graph.getConnections().size() == 3);
+    CHECK(graph.getConnections()[0].target.nodeId == nodes[1]);
+    CHECK(graph.getConnections()[1].target.nodeId == nodes[4]);
+    CHECK(graph.getConnections()[2].target.nodeId == nodes[0]);
+    checkIndexed(graph);
+
+    graph.disconnect(out(nodes[0]), in(nodes[1], "in_0"));
+    REQUIRE(graph.getConnections().size() == 2);
+    CHECK(graph.getOutgoing(nodes[3]).begin()->target.nodeId == nodes[4]);
+    CHECK(graph.getIncoming(nodes[0]).begin()->source.nodeId == nodes[4]);
+    checkIndexed(graph);
+}
+
+TEST_CASE("IR graph orders nodes topologically", "[ir_graph]")
+{
+    IRGraph graph;
+    std::vector<NodeId> nodes;
+    for (int i = 0; i < 6; ++i) {
+        nodes.push_back(graph.createNode(IRNodeType::Sequence));
+    }
+    // 0 -> 1 -> 3 -> 5, 0 -> 2 -> 3, 4 -> 5
+    const std::vector<std::pair<usize, usize>> edges = {{0, 1}, {1, 3}, {3, 5},
+                                                        {0, 2}, {2, 3}, {4, 5}};
+    for (const auto& [from, to] : edges) {
+        REQUIRE(graph.connect(out(nodes[from]), in(nodes[to], "in_" + std::to_string(from)))
+                    .isOk());
+    }
+
+    const auto order = graph.getTopologicalOrder();
+    REQUIRE(order.size() == nodes.size());
+    auto position = [&](usize i) {
+        return std::find(order.begin(), order.end(), nodes[i]) - order.begin();
+    };
+    for (const auto& [from, to] : edges) {
+        CHECK(position(from) < position(to));
+    }
+
+    // A cycle leaves its nodes out of the order
+    REQUIRE(graph.connect(out(nodes[5]), in(nodes[1], "loop")).isOk());
+    CHECK(graph.getTopologicalOrder().size() == 3);
+}
+
+TEST_CASE("IR graph validation reports nodes without incoming edges", "[ir_graph]")
+{
+    IRGraph graph;
+    const NodeId start = graph.createNode(IRNodeType::SceneStart);
+    const NodeId linked = graph.createNode(IRNodeType::Sequence);
+    const NodeId orphan = graph.createNode(IRNodeType::Sequence);
+    REQUIRE(graph.connect(out(start), in(linked)).isOk());
+
+    const auto errors = graph.validate();
+    const std::string message = "Node " + std::to_string(orphan) + " has no incoming connections";
+    CHECK(std::find(errors.begin(), errors.end(), message) != errors.end());
+    for (const auto& error : errors) {
+        CHECK(error.find("Node " + std::to_string(linked) + " has no") == std::string::npos);
+    }
+}
+
+TEST_CASE("Graph differ finds added and removed edges", "[ir_graph]")
+{
+    VisualGraph before;
+    const NodeId a = before.addNode("Sequence", 0.0f, 0.0f);
+    const NodeId b = before.addNode("Sequence", 0.0f, 100.0f);
+    const NodeId c = before.addNode("Sequence", 0.0f, 200.0f);
+    before.addEdge(a, "exec_out", b, "exec_in");
+    before.addEdge(b, "exec_out", c, "exec_in");
+
+    VisualGraph after = before;
+    after.removeEdge(b, "exec_out", c, "exec_in");
+    after.addEdge(a, "exec_out", c, "exec_in");
+    after.setNodePosition(c, 50.0f, 200.0f);
+
+    GraphDiffer differ;
+    const GraphDiff diff = differ.diff(before, after);
+    usize added = 0;
+    usize removed = 0;
+    for (const auto& entry : diff.entries) {
+        if (entry.type == GraphDiffType::EdgeAdded) {
+            ++added;
+            CHECK(entry.edge.sourceNode == a);
+            CHECK(entry.edge.targetNode == c);
+        } else if (entry.type == GraphDiffType::EdgeRemoved) {
+            ++removed;
+            CHECK(entry.edge.sourceNode == b);
+        }
+    }
+    CHECK(added == 1);
+    CHECK(removed == 1);
+    CHECK(diff.hasStructuralChanges);
+    CHECK(diff.hasPositionChanges);
+    CHECK(differ.diff(after, after).isEmpty());
+}
+
+TEST_CASE("IR graph JSON round-trips nodes, connections and escapes", "[ir_graph]")
+{
+    IRGraph graph;
+    graph.setName("Chapter \"One\"");
+    const NodeId start = graph.createNode(IRNodeType::SceneStart);
+    const NodeId line = graph.createNode(IRNodeType::Dialogue);
+    const NodeId wait = graph.createNode(IRNodeType::Wait);
+    graph.getNode(line)->setProperty("text", std::string("He said \"run\"\\\nThen\tsilence"));
+    graph.getNode(line)->setProperty("character", std::string("Hero"));
+    graph.getNode(line)->setPosition(12.5f, -0.1f);
+    graph.getNode(wait)->setProperty("duration", 2.0);
+    graph.getNode(wait)->setProperty("skippable", true);
+    graph.getNode(wait)->setProperty("count", i64{3});
+    graph.getNode(wait)->setProperty("tags", std::vector<std::string>{"a", "b\"c"});
+    graph.getNode(wait)->setProperty("none", nullptr);
+    REQUIRE(graph.connect(out(start), in(line)).isOk());
+    REQUIRE(graph.connect(out(line), in(wait)).isOk());
+    graph.addScene("intro", start);
+    graph.addCharacter("Hero", "Alex \"The Brave\"", "#ffcc00");
+
+    auto loaded = IRGraph::fromJson(graph.toJson());
+    REQUIRE(loaded);
+    CHECK(loaded->getName() == graph.getName());
+    CHECK(loaded->getSceneStartNode("intro") == start);
+    CHECK(loaded->hasCharacter("Hero"));
+    CHECK(loaded->isConnected(out(start), in(line)));
+    CHECK(loaded->isConnected(out(line), in(wait)));
+    checkIndexed(*loaded);
+
+    const IRNode* node = loaded->getNode(line);
+    REQUIRE(node);
+    CHECK(node->getType() == IRNodeType::Dialogue);
+    CHECK(node->getX() == 12.5f);
+    CHECK(node->getY() == -0.1f);
+    CHECK(std::get<std::string>(*node->getProperty("text")) ==
+          "He said \"run\"\\\nThen\tsilence");
+    const IRNode* waitNode = loaded->getNode(wait);
+    CHECK(std::get<f64>(*waitNode->getProperty("duration")) == 2.0);
+    CHECK(std::get<bool>(*waitNode->getProperty("skippable")));
+    CHECK(std::get<i64>(*waitNode->getProperty("count")) == 3);
+    CHECK(std::get<std::vector<std::string>>(*waitNode->getProperty("tags"))[1] == "b\"c");
+    CHECK(std::holds_alternative<std::nullptr_t>(*waitNode->getProperty("none")));
+
+    // Same members, though hash-map order may differ
+    CHECK(loaded->toJson().size() == graph.toJson().size());
+
+    // New nodes continue after the loaded IDs
+    CHECK(loaded->createNode(IRNodeType::Sequence) > wait);
+}
+
+TEST_CASE("IR graph JSON loading reports invalid documents", "[ir_graph]")
+{
+    CHECK_FALSE(IRGraph::fromJson("{\"nodes\":[{\"id\":1,\"type\":\"Sequence\"}"));
+    CHECK_FALSE(IRGraph::fromJson("{\"nodes\":[{\"type\":\"Sequence\"}]}"));
+    CHECK_FALSE(IRGraph::fromJson("{\"nodes\":[{\"id\":1},{\"id\":1}]}"));
+    CHECK_FALSE(IRGraph::fromJson("{\"connections\":[{\"sourceNode\":1,\"targetNode\":2}]}"));
+    CHECK_FALSE(IRGraph::fromJson("{} {}"));
+
+    core::JsonReader reader("{\"nodes\": [{\"id\": \"one\"}]}");
+    auto result = IRGraph::readJson(reader);
+    REQUIRE(result.isError());
+    CHECK(result.error().find("Expected a node ID") != std::string::npos);
+}
+
+TEST_CASE("Visual graph JSON round-trips through a file", "[ir_graph]")
+{
+    VisualGraph graph;
+    const NodeId a = graph.addNode("Dialogue", 10.0f, 20.0f);
+    const NodeId b = graph.addNode("Wait", 10.0f, 120.0f);
+    graph.setNodeProperty(a, "text", "Quote \" and \\ backslash");
+    graph.addEdge(a, "exec_out", b, "exec_in");
+
+    const std::string path = (std::filesystem::temp_directory_path() / "novelmind_visual_graph.json").string();
+    REQUIRE(graph.saveJson(path).isOk());
+    auto loaded = VisualGraph::loadJson(path);
+    std::filesystem::remove(path);
+    REQUIRE(loaded.isOk());
+
+    GraphDiffer differ;
+    CHECK(differ.diff(graph, *loaded.value()).isEmpty());
+    CHECK(loaded.value()->findNode(a)->properties.at("text") == "Quote \" and \\ backslash");
+    CHECK(loaded.value()->addNode("Sequence", 0.0f, 0.0f) == b + 1);
+
+    CHECK(VisualGraph::loadJson(path).isError());
+}
+
+namespace {
+
+const char* kStory = R"(character Hero(name="Alex", color="#ffcc00")
+
+scene intro {
+    say Hero "Hello"
+    goto forest
+}
+
+scene forest {
+    say Hero "Trees"
+    say Hero "More trees"
+}
+
+scene ending {
+    say Hero "Bye"
+}
+)";
+
+void checkSameDiff(const GraphDiff& expected, const GraphDiff& actual)
+{
+    REQUIRE(actual.size() == expected.size());
+    for (usize i = 0; i < expected.size(); ++i) {
+        const auto& a = expected.entries[i];
+        const auto& b = actual.entries[i];
+        CHECK(a.type == b.type);
+        CHECK(a.nodeId == b.nodeId);
+        CHECK(a.propertyName == b.propertyName);
+        CHECK(a.oldValue == b.oldValue);
+        CHECK(a.newValue == b.newValue);
+        if (a.type == GraphDiffType::EdgeAdded || a.type == GraphDiffType::EdgeRemoved) {
+            CHECK(a.edge.sourceNode == b.edge.sourceNode);
+            CHECK(a.edge.targetNode == b.edge.targetNode);
+        }
+    }
+    CHECK(actual.hasStructuralChanges == expected.hasStructuralChanges);
+    CHECK(actual.hasPropertyChanges == expected.hasPropertyChanges);
+    CHECK(actual.hasPositionChanges == expected.hasPositionChanges);
+}
+
+} // namespace
+
+TEST_CASE("Graph differ compares scenes in parallel", "[ir_graph]")
+{
+    RoundTripConverter converter;
+    auto parsed = converter.textToVisualGraph(kStory);
+    REQUIRE(parsed.isOk());
+    const VisualGraph& before = *parsed.value();
+    core::ThreadPool pool(4);
+    GraphDiffer differ;
+
+    CHECK(differ.diff(before, before, pool).isEmpty());
+
+    VisualGraph after = before;
+    NodeId forestText = 0;
+    NodeId endingStart = 0;
+    for (const auto& node : before.getNodes()) {
+        const auto text = node.properties.find("text");
+        if (text != node.properties.end() && text->second == "More trees") {
+            forestText = node.id;
+        }
+        const auto scene = node.properties.find("sceneName");
+        if (scene != node.properties.end() && scene->second == "ending") {
+            endingStart = node.id;
+        }
+    }
+    REQUIRE(forestText != 0);
+    REQUIRE(endingStart != 0);
+
+    after.setNodeProperty(forestText, "text", "Fewer trees");
+    after.setNodePosition(forestText, 5.0f, 5.0f);
+    after.removeNode(endingStart);
+    const NodeId epilogue = after.addNode("SceneStart", 0.0f, 0.0f);
+    after.setNodeProperty(epilogue, "sceneName", "epilogue");
+    const NodeId line = after.addNode("Dialogue", 0.0f, 100.0f);
+    after.addEdge(epilogue, "exec_out", line, "exec_in");
+
+    const GraphDiff expected = differ.diff(before, after);
+    REQUIRE(expected.hasStructuralChanges);
+    REQUIRE(expected.hasPropertyChanges);
+    checkSameDiff(expected, differ.diff(before, after, pool));
+    checkSameDiff(differ.diff(after, before), differ.diff(after, before, pool));
+}
+
+TEST_CASE("Round-trip validator checks each scene and reuses verdicts", "[ir_graph]")
+{
+    core::ThreadPool pool(3);
+    RoundTripValidator validator;
+
+    const std::string script = kStory;
+    auto results = validator.validateScenes(script, pool);
+    REQUIRE(results.size() == 3);
+    CHECK(results[0].scene == "intro");
+    CHECK(results[1].scene == "forest");
+    CHECK(results[2].scene == "ending");
+    CHECK(script.compare(results[1].offset, 12, "scene forest") == 0);
+    for (const auto& result : results) {
+        INFO(result.scene);
+        CHECK(result.isValid);
+        CHECK_FALSE(result.reused);
+    }
+
+    // Only the edited scene is converted again
+    std::string edited = script;
+    edited.replace(edited.find("\"Bye\""), 5, "\"Farewell\"");
+    edited.replace(edited.find("    say Hero \"Trees\""), 4, "  ");
+    results = validator.validateScenes(edited, pool);
+    REQUIRE(results.size() == 3);
+    CHECK(results[0].reused);
+    CHECK_FALSE(results[1].reused);
+    CHECK_FALSE(results[1].isValid); // Indentation is not preserved
+    CHECK_FALSE(results[1].differences.empty());
+    CHECK_FALSE(results[2].reused);
+    CHECK(results[2].isValid);
+}
+
+TEST_CASE("Visual graph conversion keeps scene start nodes", "[ir_graph]")
+{
+    RoundTripConverter converter;
+    auto visual = converter.textToVisualGraph(kStory);
+    REQUIRE(visual.isOk());
+    auto ir = visual.value()->toIR();
+    auto scenes = ir->getSceneNames();
+    std::sort(scenes.begin(), scenes.end());
+    CHECK(scenes == std::vector<std::string>{"ending", "forest", "intro"});
+    CHECK(ir->getNode(ir->getSceneStartNode("forest"))->getType() == IRNodeType::SceneStart);
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/core/json.hpp"
+
+#include <limits>
+#include <sstream>
+
+using namespace NovelMind;
+using namespace NovelMind::core;
+
+TEST_CASE("JsonWriter separates and escapes values", "[json]")
+{
+    std::string json;
+    {
+        JsonWriter writer(json);
+        writer.beginObject();
+        writer.key("name").value("say \"hi\"\\\n\t\x01");
+        writer.key("count").value(3);
+        writer.key("id").value(u64{18446744073709551615ull});
+        writer.key("ratio").value(0.5);
+        writer.key("whole").value(2.0);
+        writer.key("x").value(0.1f);
+        writer.key("nan").value(std::numeric_limits<f64>::quiet_NaN());
+        writer.key("flags").beginArray().value(true).value(false).nullValue().endArray();
+        writer.key("empty").beginObject().endObject();
+        writer.endObject();
+    }
+
+    CHECK(json == "{\"name\":\"say \\\"hi\\\"\\\\\\n\\t\\u0001\",\"count\":3,"
+                  "\"id\":18446744073709551615,\"ratio\":0.5,\"whole\":2.0,"
+                  "\"x\":0.1,\"nan\":null,\"flags\":[true,false,null],\"empty\":{}}");
+}
+
+TEST_CASE("JsonWriter streams through its buffer", "[json]")
+{
+    std::ostringstream out;
+    {
+        JsonWriter writer(out);
+        writer.beginArray();
+        for (int i = 0; i < 20000; ++i) {
+            writer.value("item");
+        }
+        writer.endArray();
+    }
+    const std::string json = out.str();
+    CHECK(json.size() == 2 + 20000 * 6 + 19999);
+    CHECK(json.substr(0, 8) == "[\"item\",");
+    CHECK(json.back() == ']');
+}
+
+TEST_CASE("JsonReader reports events in document order", "[json]")
+{
+    JsonReader reader(R"( {"a": [1, -2.5e3, "x"], "b": {"c": null}, "d": true} )");
+
+    CHECK(reader.next() == JsonEvent::BeginObject);
+    REQUIRE(reader.next() == JsonEvent::Key);
+    CHECK(reader.getString() == "a");
+    CHECK(reader.next() == JsonEvent::BeginArray);
+    REQUIRE(reader.next() == JsonEvent::Number);
+    CHECK(reader.isInteger());
+    CHECK(reader.getInt() == 1);
+    REQUIRE(reader.next() == JsonEvent::Number);
+    CHECK_FALSE(reader.isInteger());
+    CHECK(reader.getNumber() == -2500.0);
+    REQUIRE(reader.next() == JsonEvent::String);
+    CHECK(reader.getString() == "x");
+    CHECK(reader.next() == JsonEvent::EndArray);
+
+    REQUIRE(reader.next() == JsonEvent::Key);
+    CHECK(reader.getString() == "b");
+    reader.skipValue();
+
+    REQUIRE(reader.next() == JsonEvent::Key);
+    CHECK(reader.getString() == "d");
+    REQUIRE(reader.next() == JsonEvent::Bool);
+    CHECK(reader.getBool());
+    CHECK(reader.next() == JsonEvent::EndObject);
+    CHECK(reader.next() == JsonEvent::End);
+    CHECK(reader.next() == JsonEvent::End);
+    CHECK_FALSE(reader.hasError());
+}
+
+TEST_CASE("JsonReader decodes escapes", "[json]")
+{
+    JsonReader reader(R"(["plain", "a\"b\\c\/d\n", "\u00e9\u4e2d\ud83d\ude00"])");
+
+    CHECK(reader.next() == JsonEvent::BeginArray);
+    REQUIRE(reader.next() == JsonEvent::String);
+    CHECK(reader.getString() == "plain");
+    REQUIRE(reader.next() == JsonEvent::String);
+    CHECK(reader.getString() == "a\"b\\c/d\n");
+    REQUIRE(reader.next() == JsonEvent::String);
+    CHECK(reader.getString() == "\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80");
+    CHECK(reader.next() == JsonEvent::EndArray);
+    CHECK(reader.next() == JsonEvent::End);
+}
+
+TEST_CASE("JsonReader reads back what JsonWriter writes", "[json]")
+{
+    const std::string text = "line one\nquote \" slash \\ tab \t bell \x07 caf\xC3\xA9";
+    std::string json;
+    {
+        JsonWriter writer(json);
+        writer.beginObject().key(text).value(text).key("f").value(1.0f / 3.0f).endObject();
+    }
+
+    JsonReader reader(json);
+    CHECK(reader.next() == JsonEvent::BeginObject);
+    REQUIRE(reader.next() == JsonEvent::Key);
+    CHECK(reader.getString() == text);
+    REQUIRE(reader.next() == JsonEvent::String);
+    CHECK(reader.getString() == text);
+    REQUIRE(reader.next() == JsonEvent::Key);
+    REQUIRE(reader.next() == JsonEvent::Number);
+    CHECK(static_cast<f32>(reader.getNumber()) == 1.0f / 3.0f);
+    CHECK(reader.next() == JsonEvent::EndObject);
+    CHECK(reader.next() == JsonEvent::End);
+}
+
+TEST_CASE("JsonReader rejects malformed documents", "[json]")
+{
+    const char* documents[] = {
+        "",       "{",           "[1,]",          "{\"a\" 1}",     "{\"a\":1,}",
+        "[1 2]",  "01",          "1.",            "tru",           "\"open",
+        "[\"\t\"]", "\"\\x\"",   "\"\\ud800\"",   "{\"a\":1]",     "[] []",
+    };
+    for (const char* document : documents) {
+        JsonReader reader(document);
+        JsonEvent event = JsonEvent::Null;
+        for (int i = 0; i < 16 && event != JsonEvent::End && event != JsonEvent::Error; ++i) {
+            event = reader.next();
+        }
+        INFO(document);
+        CHECK(event == JsonEvent::Error);
+        CHECK(reader.hasError());
+    }
+
+    JsonReader reader("{\n  \"a\": x}");
+    CHECK(reader.next() == JsonEvent::BeginObject);
+    CHECK(reader.next() == JsonEvent::Key);
+    CHECK(reader.next() == JsonEvent::Error);
+    CHECK(reader.getError().find("line 2, column 8") != std::string::npos);
+}
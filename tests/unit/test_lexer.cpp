@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 #include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/script_error.hpp"
+#include "NovelMind/scripting/source_file.hpp"
 
 using namespace NovelMind::scripting;
 
@@ -97,9 +99,13 @@ TEST_CASE("Lexer tokenizes basic tokens", "[lexer]")
         const auto& tokens = result.value();
         REQUIRE(tokens.size() == 4);
 
-        REQUIRE(tokens[0].lexeme == "line1\nline2");
-        REQUIRE(tokens[1].lexeme == "tab\there");
-        REQUIRE(tokens[2].lexeme == "quote\"here");
+        REQUIRE(tokens[0].text() == "line1\nline2");
+        REQUIRE(tokens[1].text() == "tab\there");
+        REQUIRE(tokens[2].text() == "quote\"here");
+
+        // The lexeme itself is the raw literal contents
+        REQUIRE(tokens[0].escaped);
+        REQUIRE(tokens[0].lexeme == R"(line1\nline2)");
     }
 
     SECTION("tokenizes operators")
@@ -239,4 +245,47 @@ TEST_CASE("Lexer reports errors", "[lexer]")
         auto result = lexer.tokenize("\"unterminated");
         REQUIRE(result.isError());
     }
+
+    SECTION("reports out of range numbers")
+    {
+        auto result = lexer.tokenize("set x = 99999999999");
+        REQUIRE(result.isError());
+        REQUIRE(lexer.getErrors().size() == 1);
+        REQUIRE(lexer.getErrors()[0].location.column == 9);
+    }
+}
+
+TEST_CASE("Lexer tokens view into a shared source file", "[lexer]")
+{
+    auto file = SourceFile::create("scene intro {\r\n    say Hero \"Hi\"\n}", "intro.nms");
+    REQUIRE(file->getLineCount() == 3);
+    REQUIRE(file->getLine(1) == "scene intro {");
+    REQUIRE(file->getLine(2) == "    say Hero \"Hi\"");
+    REQUIRE(file->getLine(4).empty());
+    REQUIRE(file->getOffset(SourceLocation(2, 5)) == 19);
+
+    Lexer lexer;
+    auto result = lexer.tokenize(file->getText());
+    REQUIRE(result.isOk());
+
+    const auto& tokens = result.value();
+    const char* begin = file->getText().data();
+    const char* end = begin + file->size();
+    for (const auto& token : tokens) {
+        if (!token.lexeme.empty()) {
+            REQUIRE(token.lexeme.data() >= begin);
+            REQUIRE(token.lexeme.data() + token.lexeme.size() <= end);
+        }
+    }
+
+    // Diagnostics can point back into the retained text
+    const Token& say = tokens[3];
+    REQUIRE(say.type == TokenType::Say);
+    REQUIRE(file->getText().substr(file->getOffset(say.location), 3) == "say");
+
+    ScriptError error(ErrorCode::UndefinedCharacter, Severity::Error, "Undefined character",
+                      tokens[4].location);
+    error.withSource(*file);
+    REQUIRE(error.source.has_value());
+    REQUIRE(*error.source == "    say Hero \"Hi\"");
 }
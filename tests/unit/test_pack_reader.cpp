@@ -0,0 +1,460 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/vfs/pack_reader.hpp"
+#include "NovelMind/vfs/pack_stream.hpp"
+#include "NovelMind/vfs/pack_writer.hpp"
+#include "NovelMind/vfs/virtual_file_system.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+using namespace NovelMind;
+using namespace NovelMind::vfs;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PackItem
+{
+    std::string id;
+    std::vector<u8> data;
+    ResourceType type = ResourceType::Data;
+    u32 flags = 0;
+};
+
+template <typename T>
+void append(std::vector<u8>& out, const T& value)
+{
+    const usize offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+// Header, resource table, string table, then the resource data
+std::vector<u8> buildPack(const std::vector<PackItem>& items)
+{
+    std::vector<u8> strings;
+    std::vector<u32> stringOffsets;
+    std::vector<u8> data;
+    std::vector<PackResourceEntry> entries;
+    for (usize i = 0; i < items.size(); ++i) {
+        stringOffsets.push_back(static_cast<u32>(strings.size()));
+        strings.insert(strings.end(), items[i].id.begin(), items[i].id.end());
+        strings.push_back(0);
+
+        PackResourceEntry entry{};
+        entry.idStringOffset = static_cast<u32>(i);
+        entry.type = static_cast<u32>(items[i].type);
+        entry.dataOffset = data.size();
+        entry.compressedSize = items[i].data.size();
+        entry.uncompressedSize = items[i].data.size();
+        entry.flags = items[i].flags;
+        entries.push_back(entry);
+        data.insert(data.end(), items[i].data.begin(), items[i].data.end());
+    }
+
+    PackHeader header{};
+    header.magic = PACK_MAGIC;
+    header.versionMajor = PACK_VERSION_MAJOR;
+    header.versionMinor = PACK_VERSION_MINOR;
+    header.resourceCount = static_cast<u32>(items.size());
+    header.resourceTableOffset = sizeof(PackHeader);
+    header.stringTableOffset = header.resourceTableOffset + entries.size() * sizeof(PackResourceEntry);
+    header.dataOffset = header.stringTableOffset + sizeof(u32) + stringOffsets.size() * sizeof(u32) + strings.size();
+    header.totalSize = header.dataOffset + data.size();
+
+    std::vector<u8> pack;
+    append(pack, header);
+    for (const auto& entry : entries) {
+        append(pack, entry);
+    }
+    append(pack, static_cast<u32>(stringOffsets.size()));
+    for (u32 offset : stringOffsets) {
+        append(pack, offset);
+    }
+    pack.insert(pack.end(), strings.begin(), strings.end());
+    pack.insert(pack.end(), data.begin(), data.end());
+    return pack;
+}
+
+struct TempDir
+{
+    fs::path path = fs::temp_directory_path() / "novelmind_pack_reader_test";
+    TempDir() { fs::remove_all(path); fs::create_directories(path); }
+    ~TempDir() { fs::remove_all(path); }
+
+    std::string write(const std::string& name, const std::vector<u8>& bytes) const
+    {
+        const fs::path file = path / name;
+        std::ofstream(file, std::ios::binary)
+            .write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return file.string();
+    }
+};
+
+std::vector<u8> bytesOf(const std::string& text)
+{
+    return {text.begin(), text.end()};
+}
+
+// 16-bit PCM-like samples: a slow ramp with a little noise
+std::vector<u8> pcm(usize size)
+{
+    std::mt19937 rng(5);
+    std::vector<u8> data(size);
+    for (usize i = 0; i < size; ++i) {
+        data[i] = i % 2 == 0 ? static_cast<u8>((i / 64) & 0xFF) : static_cast<u8>(rng() % 4);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("PackReader reads resources from a mounted pack", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    const std::string path = temp.write("base.nmres", buildPack({
+        {"sprites/hero.png", bytesOf("hero pixels"), ResourceType::Texture},
+        {"music/theme.ogg", bytesOf("theme"), ResourceType::Music},
+        {"empty.bin", {}},
+    }));
+
+    PackReader reader;
+    REQUIRE(reader.mount(path).isOk());
+    CHECK(reader.mount(path).isError());
+
+    auto hero = reader.readFile("sprites/hero.png");
+    REQUIRE(hero.isOk());
+    CHECK(hero.value() == bytesOf("hero pixels"));
+    CHECK(reader.readFile("empty.bin").value().empty());
+    CHECK(reader.readFile("missing").isError());
+
+    CHECK(reader.exists("music/theme.ogg"));
+    auto info = reader.getInfo("music/theme.ogg");
+    REQUIRE(info.has_value());
+    CHECK(info->type == ResourceType::Music);
+    CHECK(info->size == 5);
+    CHECK(reader.listResources().size() == 3);
+    CHECK(reader.listResources(ResourceType::Texture) == std::vector<std::string>{"sprites/hero.png"});
+
+    reader.unmount(path);
+    CHECK_FALSE(reader.exists("music/theme.ogg"));
+}
+
+TEST_CASE("PackReader views stored resources in place", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    const std::string path = temp.write("base.nmres", buildPack({
+        {"plain", bytesOf("stored bytes")},
+        {"secret", bytesOf("ciphertext"), ResourceType::Data, static_cast<u32>(PackFlags::Encrypted)},
+        {"packed", bytesOf("lz"), ResourceType::Data, static_cast<u32>(PackFlags::Compressed)},
+    }));
+
+    PackReader reader;
+    REQUIRE(reader.mount(path).isOk());
+
+    auto view = reader.readView("plain");
+    REQUIRE(view.isOk());
+    const auto& bytes = view.value().bytes;
+    CHECK(std::string(bytes.begin(), bytes.end()) == "stored bytes");
+    const u8* begin = view.value().file->data();
+    CHECK(bytes.data() >= begin);
+    CHECK(bytes.data() + bytes.size() <= begin + view.value().file->size());
+
+    // Encoded entries have to be read, not viewed
+    CHECK(reader.readView("secret").isError());
+    CHECK(reader.readView("packed").isError());
+    CHECK(reader.readFile("secret").value() == bytesOf("ciphertext"));
+
+    // The view outlives the mount
+    reader.unmountAll();
+    CHECK(std::string(bytes.begin(), bytes.end()) == "stored bytes");
+}
+
+TEST_CASE("PackReader shares resource buffers", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    const auto script = bytesOf(std::string(5000, 'x') + "say \"hello\"");
+    PackWriter writer;
+    writer.addResource("bg/city.png", bytesOf("city pixels"), ResourceType::Texture);
+    writer.addResource("script", script, ResourceType::Script);
+    const std::string path = (temp.path / "game.nmres").string();
+    REQUIRE(writer.write(path).isOk());
+
+    PackReader reader;
+    REQUIRE(reader.mount(path).isOk());
+
+    // Stored entries are the mapped bytes themselves
+    auto city = reader.readBuffer("bg/city.png");
+    REQUIRE(city.isOk());
+    CHECK(city.value() == bytesOf("city pixels"));
+    CHECK(city.value().data() == reader.readView("bg/city.png").value().bytes.data());
+
+    // Compressed entries are decoded into a buffer of their own
+    auto decoded = reader.readBuffer("script");
+    REQUIRE(decoded.isOk());
+    CHECK(decoded.value() == script);
+    CHECK(reader.readBuffer("missing").isError());
+
+    reader.unmountAll();
+    CHECK(city.value() == bytesOf("city pixels"));
+}
+
+TEST_CASE("PackReader rejects damaged packs", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    const auto pack = buildPack({{"a", bytesOf("alpha")}, {"b", bytesOf("beta")}});
+    PackReader reader;
+
+    CHECK(reader.mount((temp.path / "missing.nmres").string()).isError());
+    CHECK(reader.mount(temp.write("short.nmres", {pack.begin(), pack.begin() + 10})).isError());
+
+    auto badMagic = pack;
+    badMagic[0] ^= 0xFF;
+    CHECK(reader.mount(temp.write("magic.nmres", badMagic)).isError());
+
+    // Cut inside the resource table
+    CHECK(reader.mount(temp.write("table.nmres", {pack.begin(), pack.begin() + sizeof(PackHeader) + 8})).isError());
+
+    // Data cut short: the pack mounts but the entry cannot be read
+    const std::string truncated = temp.write("data.nmres", {pack.begin(), pack.end() - 2});
+    REQUIRE(reader.mount(truncated).isOk());
+    CHECK(reader.readFile("a").isOk());
+    CHECK(reader.readFile("b").isError());
+    CHECK(reader.readView("b").isError());
+}
+
+TEST_CASE("PackReader serves reads while packs are mounted", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    std::vector<PackItem> items;
+    for (int i = 0; i < 64; ++i) {
+        items.push_back({"res" + std::to_string(i), bytesOf("payload " + std::to_string(i))});
+    }
+    const std::string base = temp.write("base.nmres", buildPack(items));
+    const std::string extra = temp.write("extra.nmres", buildPack({{"extra", bytesOf("more")}}));
+
+    PackReader reader;
+    REQUIRE(reader.mount(base).isOk());
+
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                const int n = (i * 7 + t) % 64;
+                auto view = reader.readView("res" + std::to_string(n));
+                if (view.isError() ||
+                    std::string(view.value().bytes.begin(), view.value().bytes.end()) !=
+                        "payload " + std::to_string(n)) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE(reader.mount(extra).isOk());
+        reader.unmount(extra);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK_FALSE(failed.load());
+}
+
+TEST_CASE("PackWriter compresses resources by type", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    std::string script;
+    for (int i = 0; i < 400; ++i) {
+        script += "say Hero \"Line " + std::to_string(i % 20) + "\"\n";
+    }
+    const std::vector<u8> texture(3000, 0x7F);
+
+    PackWriter writer;
+    CHECK(writer.getCompression(ResourceType::Texture) == PackCompression::None);
+    CHECK(writer.getCompression(ResourceType::Localization) == PackCompression::High);
+    CHECK(writer.getCompression(ResourceType::Data) == PackCompression::Fast);
+
+    writer.addResource("scripts/main.nmc", bytesOf(script), ResourceType::Script);
+    writer.addResource("bg/city.png", texture, ResourceType::Texture);
+    writer.addResource("tiny", bytesOf("abc"));
+    writer.addResource("empty", {});
+    writer.addResource("tiny", bytesOf("abcd")); // Replaces the first one
+    const std::string path = (temp.path / "game.nmres").string();
+    REQUIRE(writer.write(path).isOk());
+
+    const auto& stats = writer.getStats();
+    CHECK(stats.resourceCount == 4);
+    CHECK(stats.compressedCount == 1);
+    CHECK(stats.uncompressedSize == script.size() + texture.size() + 4);
+    CHECK(stats.storedSize < stats.uncompressedSize);
+
+    PackReader reader;
+    REQUIRE(reader.mount(path).isOk());
+    CHECK(reader.readFile("scripts/main.nmc").value() == bytesOf(script));
+    CHECK(reader.readFile("bg/city.png").value() == texture);
+    CHECK(reader.readFile("tiny").value() == bytesOf("abcd"));
+    CHECK(reader.readFile("empty").value().empty());
+    CHECK(reader.getInfo("scripts/main.nmc")->size == script.size());
+
+    // Stored resources can be viewed, compressed ones decoded in place
+    CHECK(reader.readView("bg/city.png").isOk());
+    CHECK(reader.readView("scripts/main.nmc").isError());
+    std::vector<u8> buffer(script.size() + 10);
+    auto read = reader.readInto("scripts/main.nmc", buffer);
+    REQUIRE(read.isOk());
+    CHECK(read.value() == script.size());
+    CHECK(std::equal(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(script.size()), script.begin()));
+    std::vector<u8> small(script.size() - 1);
+    CHECK(reader.readInto("scripts/main.nmc", small).isError());
+    CHECK(reader.readInto("bg/city.png", buffer).value() == texture.size());
+
+    // Stored data is page aligned for resources above 4 KiB
+    auto view = reader.readView("bg/city.png");
+    CHECK(static_cast<usize>(view.value().bytes.data() - view.value().file->data()) % 16 == 0);
+}
+
+TEST_CASE("PackWriter can store every type as is", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    PackWriter writer;
+    writer.setCompression(ResourceType::Script, PackCompression::None);
+    writer.addResource("script", std::vector<u8>(10000, 'x'), ResourceType::Script);
+    const std::string path = (temp.path / "stored.nmres").string();
+    REQUIRE(writer.write(path).isOk());
+    CHECK(writer.getStats().compressedCount == 0);
+
+    PackReader reader;
+    REQUIRE(reader.mount(path).isOk());
+    auto view = reader.readView("script");
+    REQUIRE(view.isOk());
+    CHECK(view.value().bytes.size() == 10000);
+    CHECK(static_cast<usize>(view.value().bytes.data() - view.value().file->data()) % 4096 == 0);
+}
+
+TEST_CASE("PackReader streams chunked resources", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    const auto track = pcm(5 * PACK_DEFAULT_CHUNK_SIZE + 1234);
+    const std::vector<u8> shortSound(1000, 9);
+
+    PackWriter writer;
+    CHECK(writer.getChunkSize(ResourceType::Music) == PACK_DEFAULT_CHUNK_SIZE);
+    CHECK(writer.getChunkSize(ResourceType::Script) == 0);
+    writer.addResource("music/theme", track, ResourceType::Music);
+    writer.addResource("sfx/click", shortSound, ResourceType::Audio);
+    const std::string path = (temp.path / "audio.nmres").string();
+    REQUIRE(writer.write(path).isOk());
+    CHECK(writer.getStats().chunkedCount == 1);
+    CHECK(writer.getStats().storedSize < writer.getStats().uncompressedSize);
+
+    PackReader reader;
+    REQUIRE(reader.mount(path).isOk());
+    CHECK((reader.getEntry("music/theme")->flags & static_cast<u32>(PackFlags::Chunked)) != 0);
+    CHECK(reader.readFile("music/theme").value() == track);
+    CHECK(reader.readView("music/theme").isError());
+
+    auto stream = reader.openStream("music/theme");
+    REQUIRE(stream);
+    REQUIRE(stream->size() == track.size());
+
+    // Sequential reads across chunk boundaries
+    std::vector<u8> all;
+    std::vector<u8> piece(1000);
+    while (!stream->isEof()) {
+        auto read = stream->read(piece.data(), piece.size());
+        REQUIRE(read.isOk());
+        all.insert(all.end(), piece.begin(), piece.begin() + static_cast<std::ptrdiff_t>(read.value()));
+    }
+    CHECK(all == track);
+
+    // Random seeks only keep the chunk under the position
+    std::mt19937 rng(9);
+    bool matches = true;
+    for (int i = 0; i < 100; ++i) {
+        const usize offset = rng() % track.size();
+        REQUIRE(stream->seek(static_cast<i64>(offset), VFS::SeekOrigin::Begin).isOk());
+        auto bytes = stream->readBytes(3000);
+        REQUIRE(bytes.isOk());
+        const usize expected = std::min<usize>(3000, track.size() - offset);
+        matches = matches && bytes.value().size() == expected &&
+                  std::equal(bytes.value().begin(), bytes.value().end(),
+                             track.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+    CHECK(matches);
+    CHECK(static_cast<PackStream&>(*stream).bufferedSize() <= PACK_DEFAULT_CHUNK_SIZE);
+
+    REQUIRE(stream->seek(-10, VFS::SeekOrigin::End).isOk());
+    CHECK(stream->readBytes(100).value().size() == 10);
+    CHECK(stream->seek(1, VFS::SeekOrigin::End).isError());
+    CHECK(stream->seek(-1, VFS::SeekOrigin::Begin).isError());
+
+    // Short resources are not chunked but still stream
+    auto click = reader.openStream("sfx/click");
+    REQUIRE(click);
+    CHECK(click->readAll().value() == shortSound);
+    CHECK_FALSE(reader.openStream("missing"));
+}
+
+TEST_CASE("PackReader rejects damaged chunk indexes", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    std::vector<u8> index(8 + 8, 0);
+    index[0] = 16; // Chunk size 16, one chunk
+    index[4] = 1;
+    index[8] = 200; // Chunk ends past the entry
+    PackItem item{"music/broken", index, ResourceType::Music, static_cast<u32>(PackFlags::Chunked)};
+    auto pack = buildPack({item});
+    // buildPack records the index size as the decoded size; make it 10
+    PackResourceEntry entry;
+    std::memcpy(&entry, pack.data() + sizeof(PackHeader), sizeof(entry));
+    entry.uncompressedSize = 10;
+    std::memcpy(pack.data() + sizeof(PackHeader), &entry, sizeof(entry));
+
+    PackReader reader;
+    REQUIRE(reader.mount(temp.write("broken.nmres", pack)).isOk());
+    CHECK_FALSE(reader.openStream("music/broken"));
+    CHECK(reader.readFile("music/broken").isError());
+}
+
+TEST_CASE("VirtualFileSystem streams resources from packs", "[vfs][pack_reader]")
+{
+    TempDir temp;
+    const auto track = pcm(3 * PACK_DEFAULT_CHUNK_SIZE);
+    PackWriter writer;
+    writer.addResource("music/theme", track, ResourceType::Music);
+    writer.addResource("lang/en", bytesOf("{\"hello\": \"Hello\"}"), ResourceType::Localization);
+    const std::string path = (temp.path / "game.nmres").string();
+    REQUIRE(writer.write(path).isOk());
+
+    auto backend = std::make_unique<VFS::PackBackend>();
+    REQUIRE(backend->mount(path).isOk());
+    VFS::VirtualFileSystem vfs;
+    vfs.registerBackend(std::move(backend));
+    REQUIRE(vfs.initialize().isOk());
+
+    const VFS::ResourceId theme("music/theme");
+    CHECK(vfs.exists(theme));
+    auto info = vfs.getInfo(theme);
+    REQUIRE(info.has_value());
+    CHECK(info->size == track.size());
+    CHECK(info->compressed);
+    CHECK(info->resourceId.type() == VFS::ResourceType::Music);
+    CHECK(vfs.listResources(VFS::ResourceType::Music).size() == 1);
+    CHECK(vfs.listResources().size() == 2);
+
+    auto stream = vfs.openStream(theme);
+    REQUIRE(stream);
+    const usize offset = 2 * PACK_DEFAULT_CHUNK_SIZE + 17;
+    REQUIRE(stream->seek(static_cast<i64>(offset)).isOk());
+    auto bytes = stream->readBytes(64);
+    REQUIRE(bytes.isOk());
+    CHECK(std::equal(bytes.value().begin(), bytes.value().end(), track.begin() + static_cast<std::ptrdiff_t>(offset)));
+
+    CHECK(vfs.readAll("lang/en").value() == bytesOf("{\"hello\": \"Hello\"}"));
+    CHECK(vfs.readAll(theme).value() == track);
+}
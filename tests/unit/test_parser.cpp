@@ -432,3 +432,103 @@ TEST_CASE("Parser parses wait and transition", "[parser]")
         REQUIRE(trans.duration == Catch::Approx(1.0f));
     }
 }
+
+TEST_CASE("Parser recovers from tokens that start no statement", "[parser]")
+{
+    Lexer lexer;
+    Parser parser;
+
+    // A scene inside an unclosed block, as while typing in an editor
+    auto tokens = lexer.tokenize(R"(
+        scene start {
+            if trust > 1 {
+            say Hero "Where are we?"
+        }
+        scene harbour {
+            fade
+        }
+    )");
+    REQUIRE(tokens.isOk());
+
+    auto result = parser.parse(tokens.value());
+    REQUIRE(result.isError());
+    CHECK_FALSE(parser.getErrors().empty());
+}
+
+TEST_CASE("Parser allocates the AST from the program arena", "[parser]")
+{
+    Lexer lexer;
+    Parser parser;
+
+    SECTION("interns equal names and strings once")
+    {
+        auto tokens = lexer.tokenize(R"(
+            character Hero(name="Alex")
+            scene intro {
+                show Hero
+                say Hero "Hi"
+                say Hero "Hi"
+            }
+        )");
+        REQUIRE(tokens.isOk());
+
+        auto result = parser.parse(tokens.value());
+        REQUIRE(result.isOk());
+
+        const auto& program = result.value();
+        const auto& body = program.scenes[0].body;
+        REQUIRE(body.size() == 3);
+
+        const auto& show = std::get<ShowStmt>(body[0]->data);
+        const auto& first = std::get<SayStmt>(body[1]->data);
+        const auto& second = std::get<SayStmt>(body[2]->data);
+        CHECK(show.identifier.data() == program.characters[0].id.data());
+        CHECK(first.speaker->data() == show.identifier.data());
+        CHECK(first.text.data() == second.text.data());
+    }
+
+    SECTION("AST outlives the source text and survives a program move")
+    {
+        Program moved;
+        {
+            std::string source = R"(
+                scene intro {
+                    if trust > 2 {
+                        say "Trusted"
+                    } else {
+                        say "Doubtful"
+                        goto outro
+                    }
+                    choice {
+                        "Stay" -> { set stayed = true }
+                        "Leave" -> goto outro
+                    }
+                }
+            )";
+            auto tokens = lexer.tokenize(source);
+            REQUIRE(tokens.isOk());
+            auto result = parser.parse(tokens.value());
+            REQUIRE(result.isOk());
+            moved = std::move(result.value());
+            source.assign(source.size(), '#');
+        }
+
+        REQUIRE(moved.scenes.size() == 1);
+        const auto& body = moved.scenes[0].body;
+        REQUIRE(body.size() == 2);
+
+        const auto& ifStmt = std::get<IfStmt>(body[0]->data);
+        REQUIRE(ifStmt.thenBranch.size() == 1);
+        REQUIRE(ifStmt.elseBranch.size() == 2);
+        CHECK(std::get<SayStmt>(ifStmt.thenBranch[0]->data).text == "Trusted");
+        CHECK(std::get<GotoStmt>(ifStmt.elseBranch[1]->data).target == "outro");
+
+        const auto& choice = std::get<ChoiceStmt>(body[1]->data);
+        REQUIRE(choice.options.size() == 2);
+        REQUIRE(choice.options[0].body.size() == 1);
+        CHECK(std::get<SetStmt>(choice.options[0].body[0]->data).variable ==
+              "stayed");
+        CHECK(choice.options[1].gotoTarget.value() == "outro");
+        CHECK(moved.arena->getInternedCount() > 0);
+    }
+}
@@ -0,0 +1,288 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/project_compiler.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A project directory that is removed again when the test ends
+class TempProject {
+public:
+    explicit TempProject(const std::string& name)
+        : m_root(fs::temp_directory_path() / ("novelmind_project_" + name))
+    {
+        fs::remove_all(m_root);
+        fs::create_directories(m_root);
+    }
+
+    ~TempProject() { fs::remove_all(m_root); }
+
+    std::string write(const std::string& relative, const std::string& text)
+    {
+        const fs::path path = m_root / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << text;
+        return path.generic_string();
+    }
+
+    std::string root() const { return m_root.generic_string(); }
+
+private:
+    fs::path m_root;
+};
+
+void writeStory(TempProject& project)
+{
+    project.write("a_start.nms", R"(
+character Hero(name="Alex")
+scene start {
+    say Hero "Hello"
+    goto chapter1
+}
+)");
+    project.write("chapters/one.nms", R"(
+character Sage(name="Sage")
+scene chapter1 {
+    say Sage "Welcome"
+    say Hero "Thanks"
+    choice {
+        "Go on" -> goto chapter2
+        "Back" -> goto start
+    }
+}
+)");
+    project.write("chapters/two.nms", R"(
+scene chapter2 {
+    set trust = 1
+    say Sage "Bye"
+}
+)");
+}
+
+} // namespace
+
+TEST_CASE("ProjectCompiler collects sources from a directory or manifest", "[project_compiler]")
+{
+    TempProject project("sources");
+    writeStory(project);
+    project.write("notes.txt", "not a script");
+
+    auto fromDirectory = ProjectCompiler::collectSources(project.root());
+    REQUIRE(fromDirectory.isOk());
+    REQUIRE(fromDirectory.value().size() == 3);
+    CHECK(fromDirectory.value()[0] == project.root() + "/a_start.nms");
+    CHECK(fromDirectory.value()[2] == project.root() + "/chapters/two.nms");
+
+    const std::string manifest = project.write("game.nmproj",
+        "# build order\nchapters/two.nms\n\n  a_start.nms  \n");
+    auto fromManifest = ProjectCompiler::collectSources(manifest);
+    REQUIRE(fromManifest.isOk());
+    REQUIRE(fromManifest.value().size() == 2);
+    CHECK(fromManifest.value()[0] == project.root() + "/chapters/two.nms");
+    CHECK(fromManifest.value()[1] == project.root() + "/a_start.nms");
+
+    CHECK(ProjectCompiler::collectSources(project.root() + "/missing").isError());
+}
+
+TEST_CASE("ProjectCompiler links cross-file references into one module", "[project_compiler]")
+{
+    TempProject project("link");
+    writeStory(project);
+    auto sources = ProjectCompiler::collectSources(project.root());
+    REQUIRE(sources.isOk());
+
+    ProjectCompilerConfig config;
+    config.threadCount = 4;
+    ProjectBuild build = ProjectCompiler(config).build(sources.value());
+
+    CHECK(build.getErrorCount() == 0);
+    REQUIRE(build.files.size() == 3);
+    CHECK(build.linked.scenes.size() == 3);
+    CHECK(build.linked.characters.size() == 2);
+    CHECK(build.script.sceneEntryPoints.count("start") == 1);
+    CHECK(build.script.sceneEntryPoints.count("chapter2") == 1);
+    CHECK(build.script.characters.count("Sage") == 1);
+    CHECK_FALSE(build.script.instructions.empty());
+}
+
+TEST_CASE("ProjectCompiler reports the same diagnostics for any thread count", "[project_compiler]")
+{
+    TempProject project("diagnostics");
+    writeStory(project);
+    project.write("chapters/three.nms", R"(
+scene chapter2 {
+    say Nobody "Hi"
+    goto nowhere
+}
+)");
+    auto sources = ProjectCompiler::collectSources(project.root());
+    REQUIRE(sources.isOk());
+
+    auto collect = [&](usize threads) {
+        ProjectCompilerConfig config;
+        config.threadCount = threads;
+        ProjectBuild build = ProjectCompiler(config).build(sources.value());
+        std::vector<std::string> messages;
+        for (const auto& file : build.files) {
+            for (const auto& err : file.diagnostics.all()) {
+                messages.push_back(file.path + ": " + err.message);
+            }
+        }
+        CHECK(build.script.instructions.empty());
+        return messages;
+    };
+
+    auto serial = collect(1);
+    REQUIRE(serial.size() == 3);
+    CHECK(serial[0].find("Undefined character 'Nobody'") != std::string::npos);
+    CHECK(serial[1].find("Undefined scene 'nowhere'") != std::string::npos);
+    CHECK(serial[2].find("Scene 'chapter2' is already defined in") != std::string::npos);
+    CHECK(serial[2].rfind(project.root() + "/chapters/two.nms", 0) == 0);
+
+    for (usize threads : {2u, 8u}) {
+        CHECK(collect(threads) == serial);
+    }
+
+    // The duplicate points at its own declaration
+    ProjectBuild build = ProjectCompiler().build(sources.value());
+    REQUIRE(build.files[3].diagnostics.all().size() == 1);
+    const auto& duplicate = build.files[3].diagnostics.all()[0];
+    CHECK(duplicate.span.start.line == 2);
+    CHECK(duplicate.span.start.column == 7);
+}
+
+TEST_CASE("ProjectCompiler stops after syntax errors", "[project_compiler]")
+{
+    TempProject project("syntax");
+    writeStory(project);
+    project.write("broken.nms", "scene broken {\n    say \"unterminated\n}\n");
+    auto sources = ProjectCompiler::collectSources(project.root());
+    REQUIRE(sources.isOk());
+
+    ProjectBuild build = ProjectCompiler().build(sources.value());
+    CHECK(build.getErrorCount() > 0);
+    CHECK(build.linked.scenes.empty());
+    CHECK(build.times.validate == 0.0);
+
+    bool reported = false;
+    for (const auto& file : build.files) {
+        if (file.path.find("broken.nms") != std::string::npos) {
+            reported = file.diagnostics.hasErrors();
+        } else {
+            CHECK_FALSE(file.diagnostics.hasErrors());
+        }
+    }
+    CHECK(reported);
+}
+
+TEST_CASE("ProjectCompiler links per-file fragments like a whole-program compile", "[project_compiler]")
+{
+    TempProject project("fragments");
+    writeStory(project);
+    auto sources = ProjectCompiler::collectSources(project.root());
+    REQUIRE(sources.isOk());
+
+    ProjectBuild build = ProjectCompiler().build(sources.value());
+    REQUIRE(build.getErrorCount() == 0);
+
+    Compiler compiler;
+    auto whole = compiler.compile(build.linked);
+    REQUIRE(whole.isOk());
+    REQUIRE(build.script.instructions.size() == whole.value().instructions.size());
+    for (usize i = 0; i < whole.value().instructions.size(); ++i) {
+        CHECK(build.script.instructions[i].opcode == whole.value().instructions[i].opcode);
+        CHECK(build.script.instructions[i].operand == whole.value().instructions[i].operand);
+    }
+    CHECK(build.script.stringTable == whole.value().stringTable);
+    CHECK(build.script.sceneEntryPoints == whole.value().sceneEntryPoints);
+    CHECK(build.script.lineTable.size() == whole.value().lineTable.size());
+}
+
+TEST_CASE("ProjectCompiler skips unchanged files with a compile cache", "[project_compiler]")
+{
+    TempProject project("cache");
+    writeStory(project);
+    auto sources = ProjectCompiler::collectSources(project.root());
+    REQUIRE(sources.isOk());
+
+    ProjectCompilerConfig config;
+    config.cacheDirectory = project.root() + "/.cache";
+
+    ProjectBuild cold = ProjectCompiler(config).build(sources.value());
+    REQUIRE(cold.getErrorCount() == 0);
+    CHECK(cold.cache.hits == 0);
+    CHECK(cold.cache.misses == 3);
+
+    ProjectBuild warm = ProjectCompiler(config).build(sources.value());
+    REQUIRE(warm.getErrorCount() == 0);
+    CHECK(warm.cache.hits == 3);
+    CHECK(warm.cache.misses == 0);
+    CHECK(warm.linked.scenes.empty());
+    CHECK(warm.symbols.scenes.size() == 3);
+    REQUIRE(warm.script.instructions.size() == cold.script.instructions.size());
+    CHECK(warm.script.stringTable == cold.script.stringTable);
+    CHECK(warm.script.sceneEntryPoints == cold.script.sceneEntryPoints);
+
+    SECTION("An edited file is rebuilt on its own")
+    {
+        project.write("chapters/two.nms", R"(
+scene chapter2 {
+    set trust = 2
+    say Sage "Goodbye"
+}
+)");
+        ProjectBuild edited = ProjectCompiler(config).build(sources.value());
+        CHECK(edited.getErrorCount() == 0);
+        CHECK(edited.cache.hits == 2);
+        CHECK(edited.cache.misses == 1);
+        CHECK(edited.script.sceneEntryPoints.count("chapter2") == 1);
+    }
+
+    SECTION("Removing a scene revalidates the files that import it")
+    {
+        project.write("chapters/two.nms", R"(
+scene chapter3 {
+    say Sage "Bye"
+}
+)");
+        ProjectBuild removed = ProjectCompiler(config).build(sources.value());
+        CHECK(removed.cache.hits == 1);
+        CHECK(removed.cache.misses == 2);
+        CHECK(removed.cache.invalidated == 1);
+        REQUIRE(removed.files[1].diagnostics.hasErrors());
+        CHECK(removed.files[1].diagnostics.all()[0].message.find("'chapter2'") !=
+              std::string::npos);
+    }
+
+    SECTION("A duplicate in a cached file keeps its location")
+    {
+        project.write("chapters/one_more.nms", "\n\nscene chapter2 {\n}\n");
+        auto more = ProjectCompiler::collectSources(project.root());
+        REQUIRE(more.isOk());
+        ProjectBuild duplicated = ProjectCompiler(config).build(more.value());
+        CHECK(duplicated.cache.hits == 3);
+        REQUIRE(duplicated.files.back().fromCache);
+        REQUIRE(duplicated.files.back().diagnostics.hasErrors());
+        const auto& duplicate = duplicated.files.back().diagnostics.all()[0];
+        CHECK(duplicate.message.find("one_more.nms") != std::string::npos);
+        CHECK(duplicate.span.start.line == 2);
+        CHECK(duplicate.span.start.column == 7);
+    }
+
+    SECTION("A corrupt entry is a miss")
+    {
+        for (const auto& entry : fs::directory_iterator(config.cacheDirectory)) {
+            std::ofstream(entry.path(), std::ios::binary) << "NMCC garbage";
+        }
+        ProjectBuild rebuilt = ProjectCompiler(config).build(sources.value());
+        CHECK(rebuilt.getErrorCount() == 0);
+        CHECK(rebuilt.cache.hits == 0);
+        CHECK(rebuilt.cache.misses == 3);
+    }
+}
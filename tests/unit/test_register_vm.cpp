@@ -0,0 +1,326 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/interpreter.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/register_compiler.hpp"
+#include "NovelMind/scripting/register_vm.hpp"
+#include "NovelMind/scripting/vm.hpp"
+
+#include <cstring>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+Program parseSource(const std::string& source)
+{
+    Lexer lexer;
+    Parser parser;
+
+    auto tokens = lexer.tokenize(source);
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    return std::move(program.value());
+}
+
+RegisterProgram compileRegister(const std::string& source)
+{
+    Program program = parseSource(source);
+    RegisterCompiler compiler;
+    auto compiled = compiler.compile(program);
+    REQUIRE(compiled.isOk());
+    return compiled.value();
+}
+
+const char* kArithmeticScript = R"(
+scene start {
+    set total = 0
+    set i = 0
+    set label = "n=" + 7
+    goto loop
+}
+scene loop {
+    set i = i + 1
+    set total = total + i * 2 - i % 3
+    if i < 40 and not (total > 100000) {
+        goto loop
+    }
+    set ratio = total / 4
+    set done = i >= 40 or false
+}
+)";
+
+// Restricted to operators the stack VM implements
+const char* kParityScript = R"(
+scene start {
+    set total = 0
+    set i = 0
+    set label = "n=" + 7
+    goto loop
+}
+scene loop {
+    set i = i + 1
+    set total = total + i * 2 - 1
+    if i < 40 {
+        goto loop
+    }
+    set ratio = total / 4
+    set done = i >= 40
+}
+)";
+
+const char* kLogicScript = R"(
+scene start {
+    set a = 2 and 3
+    set b = 0 and 3
+    set c = 2 or 3
+    set d = 0 or 0
+    set e = "" or "text"
+    set f = "text" and 0.5
+    set g = not (a and 0)
+    set n = 0
+    if n or "yes" {
+        set n = n + 1
+    }
+    if (n and "") or 7 {
+        set n = n + 1
+    }
+}
+)";
+
+void requireSameVariables(const std::string& source)
+{
+    Program ast = parseSource(source);
+
+    Compiler stackCompiler;
+    auto stackScript = stackCompiler.compile(ast);
+    REQUIRE(stackScript.isOk());
+    VirtualMachine stackVm;
+    REQUIRE(stackVm.load(stackScript.value().instructions, stackScript.value().stringTable,
+                         stackScript.value().variableSlots)
+                .isOk());
+    stackVm.run();
+    REQUIRE(stackVm.isHalted());
+
+    RegisterCompiler registerCompiler;
+    auto registerProgram = registerCompiler.compile(ast);
+    REQUIRE(registerProgram.isOk());
+    RegisterVM registerVm;
+    REQUIRE(registerVm.load(registerProgram.value()).isOk());
+    registerVm.run();
+    REQUIRE(registerVm.isHalted());
+
+    auto expected = stackVm.getVariables();
+    auto actual = registerVm.getVariables();
+    REQUIRE(actual.size() == expected.size());
+    for (const auto& [name, value] : expected) {
+        INFO(name);
+        REQUIRE(asString(actual.at(name)) == asString(value));
+    }
+}
+
+} // namespace
+
+TEST_CASE("Register VM matches the stack VM on and/or", "[scripting][register_vm]")
+{
+    requireSameVariables(kLogicScript);
+
+    RegisterVM vm;
+    REQUIRE(vm.load(compileRegister(kLogicScript)).isOk());
+    vm.run();
+    auto variables = vm.getVariables();
+    CHECK(asString(variables.at("a")) == "true");
+    CHECK(asString(variables.at("b")) == "false");
+    CHECK(asString(variables.at("c")) == "true");
+    CHECK(asString(variables.at("d")) == "false");
+    CHECK(asString(variables.at("e")) == "true");
+    CHECK(asString(variables.at("f")) == "true");
+    CHECK(asString(variables.at("g")) == "true");
+    CHECK(asString(variables.at("n")) == "2");
+}
+
+TEST_CASE("Register VM drops concatenation results nothing refers to", "[scripting][register_vm]")
+{
+    const char* source = R"(
+scene start {
+    set acc = ""
+    set i = 0
+    goto loop
+}
+scene loop {
+    set acc = acc + "x"
+    set label = "item" + i
+    set i = i + 1
+    if i < 3000 {
+        goto loop
+    }
+}
+)";
+    requireSameVariables(source);
+
+    RegisterVM vm;
+    REQUIRE(vm.load(compileRegister(source)).isOk());
+    vm.run();
+    REQUIRE(vm.isHalted());
+    auto variables = vm.getVariables();
+    REQUIRE(asString(variables.at("acc")) == std::string(3000, 'x'));
+    REQUIRE(asString(variables.at("label")) == "item2999");
+    REQUIRE(vm.getStringCount() < 600);
+}
+
+TEST_CASE("Register VM matches the stack VM", "[scripting][register_vm]")
+{
+    Program ast = parseSource(kParityScript);
+
+    Compiler stackCompiler;
+    auto stackScript = stackCompiler.compile(ast);
+    REQUIRE(stackScript.isOk());
+    VirtualMachine stackVm;
+    REQUIRE(stackVm.load(stackScript.value().instructions, stackScript.value().stringTable,
+                         stackScript.value().variableSlots)
+                .isOk());
+    stackVm.run();
+    REQUIRE(stackVm.isHalted());
+
+    RegisterCompiler registerCompiler;
+    auto registerProgram = registerCompiler.compile(ast);
+    REQUIRE(registerProgram.isOk());
+    RegisterVM registerVm;
+    REQUIRE(registerVm.load(registerProgram.value()).isOk());
+    registerVm.run();
+    REQUIRE(registerVm.isHalted());
+
+    auto expected = stackVm.getVariables();
+    auto actual = registerVm.getVariables();
+    REQUIRE(actual.size() == expected.size());
+    for (const auto& [name, value] : expected) {
+        REQUIRE(asString(actual.at(name)) == asString(value));
+    }
+
+    // The register form needs far fewer dispatches for the same program
+    REQUIRE(registerProgram.value().code.size() < stackScript.value().instructions.size());
+}
+
+TEST_CASE("Register VM passes command operands to callbacks", "[scripting][register_vm]")
+{
+    RegisterProgram program = compileRegister(R"(
+scene start {
+    say hero "Hello"
+    wait 1.5
+    goto next
+}
+scene next {
+    say "Narration"
+}
+)");
+
+    RegisterVM vm;
+    REQUIRE(vm.load(program).isOk());
+
+    std::vector<std::vector<Value>> said;
+    std::vector<std::string> scenes;
+    i32 waitBits = 0;
+    vm.registerCallback(OpCode::SAY, [&](NativeArgs args) { said.emplace_back(args.begin(), args.end()); });
+    vm.registerCallback(OpCode::WAIT,
+                        [&](NativeArgs args) { waitBits = asInt(args[0]); });
+    vm.registerCallback(OpCode::GOTO_SCENE, [&](NativeArgs args) {
+        scenes.push_back(asString(args[0]));
+    });
+
+    vm.run();
+    REQUIRE(vm.isWaiting());
+    REQUIRE(said.size() == 1);
+    REQUIRE(asString(said[0].at(0)) == "Hello");
+    REQUIRE(asString(said[0].at(1)) == "hero");
+
+    vm.signalContinue();
+    REQUIRE(vm.isWaiting());
+    f32 duration = 0.0f;
+    std::memcpy(&duration, &waitBits, sizeof(f32));
+    REQUIRE(duration == 1.5f);
+
+    vm.signalContinue();
+    REQUIRE(scenes == std::vector<std::string>{"next"});
+    REQUIRE(said.size() == 2);
+    REQUIRE(std::holds_alternative<std::monostate>(said[1].at(1)));
+
+    vm.signalContinue();
+    REQUIRE(vm.isHalted());
+}
+
+TEST_CASE("Register VM branches on the selected choice", "[scripting][register_vm]")
+{
+    RegisterProgram program = compileRegister(R"(
+scene start {
+    choice {
+        "Left" -> { set picked = 1 }
+        "Right" -> { set picked = 2 }
+    }
+    set after = true
+}
+)");
+
+    RegisterVM vm;
+    REQUIRE(vm.load(program).isOk());
+
+    std::vector<Value> options;
+    vm.registerCallback(OpCode::CHOICE, [&](NativeArgs args) { options.assign(args.begin(), args.end()); });
+
+    vm.run();
+    REQUIRE(vm.isWaiting());
+    REQUIRE(options.size() == 3);
+    REQUIRE(asInt(options[0]) == 2);
+    REQUIRE(asString(options[2]) == "Right");
+
+    vm.signalChoice(1);
+    REQUIRE(vm.isHalted());
+    REQUIRE(asInt(vm.getVariable("picked")) == 2);
+    REQUIRE(asBool(vm.getVariable("after")));
+}
+
+TEST_CASE("Register bytecode round-trips through ScriptInterpreter", "[scripting][register_vm]")
+{
+    RegisterProgram program = compileRegister(kArithmeticScript);
+    std::vector<u8> image = serializeRegisterProgram(program);
+
+    auto decoded = deserializeRegisterProgram(image);
+    REQUIRE(decoded.isOk());
+    REQUIRE(decoded.value().code == program.code);
+    REQUIRE(decoded.value().variableSlots == program.variableSlots);
+    REQUIRE(decoded.value().sceneEntryPoints == program.sceneEntryPoints);
+
+    ScriptInterpreter interpreter;
+    REQUIRE(interpreter.loadFromBytecode(image).isOk());
+    REQUIRE(interpreter.usesRegisterFormat());
+    interpreter.run();
+    REQUIRE(interpreter.getIntVariable("i") == 40);
+    REQUIRE(interpreter.getStringVariable("label") == "n=7");
+    REQUIRE(interpreter.getBoolVariable("done") == true);
+
+    image.resize(image.size() - 3);
+    REQUIRE(ScriptInterpreter().loadFromBytecode(image).isError());
+}
+
+TEST_CASE("Register VM rejects malformed programs", "[scripting][register_vm]")
+{
+    RegisterVM vm;
+
+    RegisterProgram badJump;
+    badJump.code = {encodeABx(RegOp::JMP, 0, 0), 1, encodeABC(RegOp::HALT, 0, 0, 0)};
+    REQUIRE(vm.load(badJump).isError());
+
+    RegisterProgram badConstant;
+    badConstant.code = {encodeABx(RegOp::LOADK, 0, 3), encodeABC(RegOp::HALT, 0, 0, 0)};
+    REQUIRE(vm.load(badConstant).isError());
+
+    RegisterProgram truncated;
+    truncated.code = {encodeABx(RegOp::SAY, 0, 2), REG_OPERAND_CONSTANT};
+    truncated.constants = {{ValueType::Null, 0}};
+    REQUIRE(vm.load(truncated).isError());
+
+    RegisterProgram unknown;
+    unknown.code = {0xEE};
+    REQUIRE(vm.load(unknown).isError());
+}
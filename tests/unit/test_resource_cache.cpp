@@ -0,0 +1,315 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/vfs/resource_cache.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace NovelMind;
+using namespace NovelMind::VFS;
+
+namespace {
+
+ResourceCacheConfig singleShard(usize maxSize, EvictionPolicy policy)
+{
+    ResourceCacheConfig config;
+    config.maxSize = maxSize;
+    config.shardCount = 1;
+    config.policy = policy;
+    return config;
+}
+
+core::ByteBuffer bytes(usize size)
+{
+    return core::ByteBuffer(std::vector<u8>(size, 0x5A));
+}
+
+ResourceId texture(const std::string& name)
+{
+    return ResourceId("ui/" + name, ResourceType::Texture);
+}
+
+// Counts calls, evicting like LRU underneath
+class CountingPolicy : public CachePolicy
+{
+public:
+    CountingPolicy(usize& evictions, std::shared_ptr<CacheClock> clock)
+        : m_evictions(evictions), m_inner(CachePolicy::create(EvictionPolicy::LRU, std::move(clock))) {}
+
+    void onInsert(const ResourceId* id, usize size) override { m_inner->onInsert(id, size); }
+    void onAccess(const ResourceId* id) override { m_inner->onAccess(id); }
+    void onRemove(const ResourceId* id) override { m_inner->onRemove(id); }
+    void clear() override { m_inner->clear(); }
+
+    const ResourceId* evict(u32 typeMask) override
+    {
+        ++m_evictions;
+        return m_inner->evict(typeMask);
+    }
+
+    std::optional<f64> peek(u32 typeMask) override { return m_inner->peek(typeMask); }
+
+private:
+    usize& m_evictions;
+    std::unique_ptr<CachePolicy> m_inner;
+};
+
+} // namespace
+
+TEST_CASE("ResourceCache LRU evicts the least recently used entry", "[vfs][resource_cache]")
+{
+    ResourceCache cache(singleShard(300, EvictionPolicy::LRU));
+    cache.put(texture("a"), bytes(100));
+    cache.put(texture("b"), bytes(100));
+    cache.put(texture("c"), bytes(100));
+    CHECK(cache.get(texture("a")).has_value());
+
+    cache.put(texture("d"), bytes(100));
+    CHECK(cache.contains(texture("a")));
+    CHECK_FALSE(cache.contains(texture("b")));
+    CHECK(cache.contains(texture("c")));
+    CHECK(cache.currentSize() == 300);
+    CHECK(cache.stats().evictionCount == 1);
+
+    // Too large to ever fit
+    cache.put(texture("huge"), bytes(301));
+    CHECK_FALSE(cache.contains(texture("huge")));
+    CHECK(cache.entryCount() == 3);
+}
+
+TEST_CASE("ResourceCache CLOCK gives used entries a second chance", "[vfs][resource_cache]")
+{
+    ResourceCache cache(singleShard(300, EvictionPolicy::Clock));
+    cache.put(texture("a"), bytes(100));
+    cache.put(texture("b"), bytes(100));
+    cache.put(texture("c"), bytes(100));
+    CHECK(cache.get(texture("a")).has_value());
+    CHECK(cache.get(texture("c")).has_value());
+
+    cache.put(texture("d"), bytes(100));
+    CHECK(cache.contains(texture("a")));
+    CHECK_FALSE(cache.contains(texture("b")));
+    CHECK(cache.contains(texture("c")));
+    CHECK(cache.contains(texture("d")));
+
+    // c loses its bit as the hand passes, then a goes, its second chance spent
+    cache.put(texture("e"), bytes(100));
+    CHECK_FALSE(cache.contains(texture("a")));
+    CHECK(cache.contains(texture("c")));
+    CHECK(cache.contains(texture("d")));
+    CHECK(cache.contains(texture("e")));
+
+    // d was inserted behind the hand, so it is reached before newer e
+    cache.put(texture("f"), bytes(100));
+    CHECK(cache.contains(texture("c")));
+    CHECK_FALSE(cache.contains(texture("d")));
+    CHECK(cache.contains(texture("e")));
+    CHECK(cache.contains(texture("f")));
+}
+
+TEST_CASE("ResourceCache CLOCK without hits evicts in insertion order", "[vfs][resource_cache]")
+{
+    ResourceCache cache(singleShard(400, EvictionPolicy::Clock));
+    const std::string names[] = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    for (usize i = 0; i < 8; ++i) {
+        cache.put(texture(names[i]), bytes(100));
+        for (usize j = 0; j <= i; ++j) {
+            CHECK(cache.contains(texture(names[j])) == (j + 4 > i));
+        }
+    }
+}
+
+TEST_CASE("ResourceCache CLOCK keeps second chances in shards it does not evict from", "[vfs][resource_cache]")
+{
+    ResourceCacheConfig config;
+    config.maxSize = 200;
+    config.policy = EvictionPolicy::Clock;
+    ResourceCache cache(config);
+    REQUIRE(cache.shardCount() > 1);
+
+    const ResourceId used = texture("used");
+    std::string name = "old";
+    while (texture(name).hash() % cache.shardCount() == used.hash() % cache.shardCount()) {
+        name += "er";
+    }
+    const ResourceId old = texture(name);
+    cache.put(old, bytes(100));
+    cache.put(used, bytes(100));
+    CHECK(cache.get(used).has_value());
+
+    // Ranking the shard of the used entry must not spend its reference bit
+    cache.put(texture("c"), bytes(100));
+    CHECK_FALSE(cache.contains(old));
+    CHECK(cache.contains(used));
+
+    // So the hand spares it once more and takes the newer entry
+    cache.put(texture("d"), bytes(100));
+    CHECK(cache.contains(used));
+    CHECK_FALSE(cache.contains(texture("c")));
+    CHECK(cache.contains(texture("d")));
+}
+
+TEST_CASE("ResourceCache GDSF keeps small popular entries", "[vfs][resource_cache]")
+{
+    ResourceCache cache(singleShard(1000, EvictionPolicy::GDSF));
+    cache.put(texture("icon1"), bytes(50));
+    cache.put(texture("icon2"), bytes(50));
+    cache.put(texture("background"), bytes(800));
+    for (int i = 0; i < 3; ++i) {
+        CHECK(cache.get(texture("icon1")).has_value());
+        CHECK(cache.get(texture("icon2")).has_value());
+        CHECK(cache.get(texture("background")).has_value());
+    }
+
+    // LRU would drop icon1; GDSF gives up the large entry instead
+    cache.put(texture("icon3"), bytes(150));
+    CHECK(cache.contains(texture("icon1")));
+    CHECK(cache.contains(texture("icon2")));
+    CHECK(cache.contains(texture("icon3")));
+    CHECK_FALSE(cache.contains(texture("background")));
+}
+
+TEST_CASE("ResourceCache policies order the whole cache across shards", "[vfs][resource_cache]")
+{
+    for (const EvictionPolicy policy : {EvictionPolicy::LRU, EvictionPolicy::Clock, EvictionPolicy::GDSF}) {
+        ResourceCacheConfig config;
+        config.maxSize = 400;
+        config.policy = policy;
+        ResourceCache cache(config);
+        REQUIRE(cache.shardCount() == 16);
+
+        // The hot entry is read before every put, so no policy should drop it
+        cache.put(texture("hot"), bytes(100));
+        for (int i = 0; i < 20; ++i) {
+            CHECK(cache.get(texture("hot")).has_value());
+            cache.put(texture("cold" + std::to_string(i)), bytes(100));
+        }
+        CHECK(cache.stats().evictionCount == 17);
+
+        // Cold entries leave oldest first
+        for (int i = 0; i < 20; ++i) {
+            CHECK(cache.contains(texture("cold" + std::to_string(i))) == (i >= 17));
+        }
+    }
+}
+
+TEST_CASE("ResourceCache type budgets keep types from evicting each other", "[vfs][resource_cache]")
+{
+    ResourceCacheConfig config;
+    config.maxSize = 1000;
+    ResourceCache cache(config);
+    cache.setTypeBudget(ResourceType::Music, 400);
+    CHECK(cache.typeBudget(ResourceType::Music) == 400);
+
+    for (int i = 0; i < 6; ++i) {
+        cache.put(texture("atlas" + std::to_string(i)), bytes(100));
+    }
+    CHECK(cache.typeStats(ResourceType::Texture).totalSize == 600);
+
+    // Music only ever evicts music
+    for (int i = 0; i < 10; ++i) {
+        cache.put(ResourceId("music/track" + std::to_string(i), ResourceType::Music), bytes(150));
+    }
+    CHECK(cache.typeStats(ResourceType::Texture).entryCount == 6);
+    CHECK(cache.typeStats(ResourceType::Texture).evictionCount == 0);
+    CHECK(cache.typeStats(ResourceType::Music).totalSize == 300);
+    CHECK(cache.typeStats(ResourceType::Music).evictionCount == 8);
+    CHECK(cache.contains(ResourceId("music/track9", ResourceType::Music)));
+
+    // The rest of the cache is shared by the types without a budget
+    cache.put(ResourceId("scripts/main", ResourceType::Script), bytes(100));
+    CHECK(cache.typeStats(ResourceType::Texture).entryCount == 5);
+    CHECK(cache.currentSize() <= 1000);
+    CHECK_FALSE(cache.get(ResourceId("music/none", ResourceType::Music)).has_value());
+    CHECK(cache.typeStats(ResourceType::Music).missCount == 1);
+
+    // Shrinking a budget evicts down to it
+    cache.setTypeBudget(ResourceType::Music, 200);
+    CHECK(cache.typeStats(ResourceType::Music).totalSize == 150);
+    cache.setTypeBudget(ResourceType::Music, 0);
+    CHECK(cache.typeBudget(ResourceType::Music) == 0);
+}
+
+TEST_CASE("ResourceCache reports stats per shard", "[vfs][resource_cache]")
+{
+    usize evictions = 0;
+    ResourceCacheConfig config;
+    config.maxSize = 1000;
+    config.shardCount = 4;
+    config.policyFactory = [&evictions](std::shared_ptr<CacheClock> clock) {
+        return std::make_unique<CountingPolicy>(evictions, std::move(clock));
+    };
+    ResourceCache cache(config);
+    REQUIRE(cache.shardCount() == 4);
+
+    for (int i = 0; i < 20; ++i) {
+        cache.put(texture(std::to_string(i)), bytes(100));
+        (void)cache.get(texture(std::to_string(i)));
+        (void)cache.get(texture("missing" + std::to_string(i)));
+    }
+    CHECK(evictions >= 10);
+
+    CacheStats total;
+    for (usize shard = 0; shard < cache.shardCount(); ++shard) {
+        const CacheStats stats = cache.shardStats(shard);
+        total.totalSize += stats.totalSize;
+        total.entryCount += stats.entryCount;
+        total.hitCount += stats.hitCount;
+        total.missCount += stats.missCount;
+        total.evictionCount += stats.evictionCount;
+    }
+    const CacheStats stats = cache.stats();
+    CHECK(stats.totalSize == 1000);
+    CHECK(stats.entryCount == 10);
+    CHECK(stats.hitCount == 20);
+    CHECK(stats.missCount == 20);
+    CHECK(stats.evictionCount == 10);
+    CHECK(total.totalSize == stats.totalSize);
+    CHECK(total.hitCount == stats.hitCount);
+    CHECK(total.evictionCount == stats.evictionCount);
+    CHECK(cache.typeStats(ResourceType::Texture).hitCount == 20);
+
+    cache.resetStats();
+    CHECK(cache.stats().hitCount == 0);
+    CHECK(cache.stats().entryCount == 10);
+    cache.clear();
+    CHECK(cache.currentSize() == 0);
+    CHECK(cache.stats().entryCount == 0);
+}
+
+TEST_CASE("ResourceCache stays within its size under concurrent use", "[vfs][resource_cache]")
+{
+    ResourceCacheConfig config;
+    config.maxSize = 64 * 100;
+    config.policy = EvictionPolicy::Clock;
+    ResourceCache cache(config);
+    cache.setTypeBudget(ResourceType::Music, 16 * 100);
+
+    std::atomic<int> badHits{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, &badHits, t] {
+            for (int i = 0; i < 2000; ++i) {
+                const int key = (i * 7 + t * 13) % 200;
+                const ResourceId id(std::to_string(key), key % 5 == 0 ? ResourceType::Music : ResourceType::Texture);
+                if (auto hit = cache.get(id)) {
+                    badHits += hit->size() == 100 ? 0 : 1;
+                } else {
+                    cache.put(id, bytes(100));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(badHits == 0);
+    const CacheStats stats = cache.stats();
+    CHECK(stats.totalSize == cache.currentSize());
+    CHECK(stats.entryCount == cache.entryCount());
+    CHECK(stats.totalSize == stats.entryCount * 100);
+    CHECK(stats.totalSize <= config.maxSize);
+    CHECK(cache.typeStats(ResourceType::Music).totalSize <= 16 * 100);
+    CHECK(stats.hitCount + stats.missCount == 8000);
+}
@@ -0,0 +1,205 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/route_explorer.hpp"
+#include "NovelMind/scripting/script_runtime.hpp"
+
+#include <algorithm>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+// Both options of the first choice lead to the same state, so the second
+// choice is explored once; "orphan" is skipped by the goto
+const char* kStory = R"(
+scene start {
+    say "Hello"
+    choice {
+        "Left" -> { set mood = 1 }
+        "Right" -> { set mood = 1 }
+    }
+    choice {
+        "Stay" -> { set stayed = true }
+        "Leave" -> { set stayed = false }
+    }
+    goto ending
+}
+scene orphan {
+    choice {
+        "Never" -> { set never = true }
+        "Shown" -> { set never = false }
+    }
+}
+scene ending {
+    say "Bye"
+}
+)";
+
+CompiledScript compileStory(const char* source)
+{
+    Lexer lexer;
+    Parser parser;
+    Compiler compiler;
+    auto tokens = lexer.tokenize(source);
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    auto script = compiler.compile(program.value());
+    REQUIRE(script.isOk());
+    return script.value();
+}
+
+void runToChoice(ScriptRuntime& runtime)
+{
+    for (int i = 0; i < 1000 && !runtime.isWaitingForChoice() && !runtime.isComplete(); ++i) {
+        if (runtime.isWaitingForInput()) {
+            runtime.continueExecution();
+        } else {
+            runtime.update(0.0);
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("ScriptRuntime enters scenes at their entry point", "[scripting][route_explorer]")
+{
+    CompiledScript script = compileStory(kStory);
+    ScriptRuntime runtime;
+    REQUIRE(runtime.load(script).isOk());
+
+    runtime.start();
+    REQUIRE(runtime.getCurrentScene() == "start");
+    runToChoice(runtime);
+    REQUIRE(runtime.saveState().pendingChoices == std::vector<std::string>{"Left", "Right"});
+
+    REQUIRE(runtime.gotoScene("orphan").isOk());
+    REQUIRE(runtime.saveState().instructionPointer == script.sceneEntryPoints.at("orphan"));
+    runToChoice(runtime);
+    REQUIRE(runtime.saveState().pendingChoices == std::vector<std::string>{"Never", "Shown"});
+
+    REQUIRE(runtime.gotoScene("missing").isError());
+    REQUIRE(runtime.getCurrentScene() == "orphan");
+}
+
+TEST_CASE("ScriptRuntimes share a linked program", "[scripting][route_explorer]")
+{
+    CompiledScript script = compileStory(kStory);
+    auto program = VMProgram::create(script.instructions, script.stringTable, script.variableSlots);
+    REQUIRE(program.isOk());
+
+    ScriptRuntime first;
+    ScriptRuntime second;
+    REQUIRE(first.load(script, program.value()).isOk());
+    REQUIRE(second.load(script, program.value()).isOk());
+    REQUIRE(first.getVM().getProgram() == program.value());
+    REQUIRE(second.getVM().getProgram() == program.value());
+
+    REQUIRE(second.gotoScene("orphan").isOk());
+    runToChoice(second);
+    REQUIRE(second.saveState().pendingChoices == std::vector<std::string>{"Never", "Shown"});
+    REQUIRE(first.load(script, nullptr).isError());
+}
+
+TEST_CASE("ScriptRuntime restores a snapshot taken at a choice", "[scripting][route_explorer]")
+{
+    CompiledScript script = compileStory(kStory);
+    ScriptRuntime runtime;
+    REQUIRE(runtime.load(script).isOk());
+    runtime.start();
+
+    runToChoice(runtime);
+    REQUIRE(runtime.isWaitingForChoice());
+    runtime.selectChoice(0);
+    runToChoice(runtime);
+    REQUIRE(runtime.isWaitingForChoice());
+
+    RuntimeSaveState saved = runtime.saveState();
+    REQUIRE(saved.pendingChoices == std::vector<std::string>{"Stay", "Leave"});
+    REQUIRE(saved.instructionPointer > 0);
+
+    for (i32 option : {0, 1}) {
+        REQUIRE(runtime.restoreSnapshot(saved).isOk());
+        REQUIRE(runtime.isWaitingForChoice());
+        runtime.selectChoice(option);
+        runToChoice(runtime);
+        runToChoice(runtime); // Past the final say
+        REQUIRE(runtime.isComplete());
+        REQUIRE(std::get<bool>(runtime.getVariable("stayed")) == (option == 0));
+        REQUIRE(asInt(runtime.getVariable("mood")) == 1);
+    }
+}
+
+TEST_CASE("RouteExplorer covers every branch and deduplicates states", "[scripting][route_explorer]")
+{
+    CompiledScript script = compileStory(kStory);
+
+    for (usize threads : {usize{1}, usize{4}}) {
+        RouteExplorerConfig config;
+        config.threadCount = threads;
+        RouteExplorer explorer(config);
+
+        auto result = explorer.explore(script);
+        REQUIRE(result.isOk());
+        const RouteCoverage& coverage = result.value();
+
+        REQUIRE(coverage.complete);
+        REQUIRE(coverage.uniqueStates == 2);
+        REQUIRE(coverage.duplicateStates == 1);
+        REQUIRE(coverage.endings == 2);
+        REQUIRE(coverage.truncatedRoutes == 0);
+
+        REQUIRE(coverage.reachedScenes == std::vector<std::string>{"ending", "start"});
+        REQUIRE(coverage.unreachedScenes == std::vector<std::string>{"orphan"});
+
+        REQUIRE(coverage.choices.size() == 3);
+        auto dead = coverage.getDeadChoices();
+        REQUIRE(dead.size() == 1);
+        REQUIRE(dead[0]->scene == "orphan");
+        REQUIRE(dead[0]->options == std::vector<std::string>{"Never", "Shown"});
+        REQUIRE(coverage.choices[0].timesReached == 1);
+        REQUIRE(coverage.choices[1].timesReached == 1);
+
+        REQUIRE(coverage.getReachedInstructionCount() > 0);
+        REQUIRE(coverage.getReachedInstructionCount() < script.instructions.size());
+        REQUIRE_FALSE(coverage.reachedInstructions[dead[0]->instruction]);
+    }
+}
+
+TEST_CASE("RouteExplorer stops at the state limit", "[scripting][route_explorer]")
+{
+    CompiledScript script = compileStory(kStory);
+    RouteExplorerConfig config;
+    config.threadCount = 2;
+    config.maxStates = 1;
+
+    auto result = RouteExplorer(config).explore(script);
+    REQUIRE(result.isOk());
+    REQUIRE_FALSE(result.value().complete);
+    REQUIRE(result.value().uniqueStates == 1);
+}
+
+TEST_CASE("RouteExplorer starts at the requested scene", "[scripting][route_explorer]")
+{
+    CompiledScript script = compileStory(kStory);
+    RouteExplorerConfig config;
+    config.threadCount = 2;
+    config.startScene = "orphan";
+
+    auto result = RouteExplorer(config).explore(script);
+    REQUIRE(result.isOk());
+    const RouteCoverage& coverage = result.value();
+
+    // orphan has no goto, so it runs on into ending
+    REQUIRE(coverage.reachedScenes == std::vector<std::string>{"ending", "orphan"});
+    REQUIRE(coverage.unreachedScenes == std::vector<std::string>{"start"});
+    REQUIRE(coverage.uniqueStates == 1);
+    REQUIRE(coverage.endings == 2);
+    REQUIRE(coverage.getDeadChoices().size() == 2);
+
+    config.startScene = "missing";
+    REQUIRE(RouteExplorer(config).explore(script).isError());
+}
@@ -0,0 +1,209 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/script_fiber.hpp"
+#include "NovelMind/scripting/script_runtime.hpp"
+#include "NovelMind/scripting/vm.hpp"
+
+#include <cstring>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+ScriptFiber countFrames(int& frames, int limit)
+{
+    while (frames < limit) {
+        ++frames;
+        co_await NextFrame{};
+    }
+}
+
+ScriptFiber dialogue(std::vector<std::string>& log)
+{
+    log.push_back("line 1");
+    co_await WaitForInput{};
+    log.push_back("line 2");
+    i32 choice = co_await WaitForChoice{};
+    log.push_back("choice " + std::to_string(choice));
+    co_await WaitForSeconds{1.0};
+    log.push_back("done");
+}
+
+ScriptFiber spawner(FiberScheduler& scheduler, int& frames)
+{
+    scheduler.spawn(countFrames(frames, 100));
+    co_return;
+}
+
+u32 floatBits(f32 value)
+{
+    u32 bits = 0;
+    std::memcpy(&bits, &value, sizeof(f32));
+    return bits;
+}
+
+} // namespace
+
+TEST_CASE("Fibers run only when the scheduler updates", "[scripting][fiber]")
+{
+    FiberScheduler scheduler;
+    int frames = 0;
+    FiberId id = scheduler.spawn(countFrames(frames, 3));
+
+    REQUIRE(id != INVALID_FIBER_ID);
+    REQUIRE(frames == 0);
+
+    for (int i = 0; i < 3; ++i) {
+        scheduler.update(0.016);
+    }
+    REQUIRE(frames == 3);
+    REQUIRE(scheduler.isAlive(id));
+
+    scheduler.update(0.016);
+    REQUIRE_FALSE(scheduler.isAlive(id));
+    REQUIRE(scheduler.size() == 0);
+}
+
+TEST_CASE("Fibers suspend on input, choices and timers", "[scripting][fiber]")
+{
+    FiberScheduler scheduler;
+    std::vector<std::string> log;
+    FiberId id = scheduler.spawn(dialogue(log));
+
+    scheduler.update(0.0);
+    REQUIRE(log.size() == 1);
+    REQUIRE(scheduler.getWait(id) == FiberWait::Input);
+
+    // Waiting fibers are not resumed by plain updates or the wrong signal
+    scheduler.update(0.0);
+    REQUIRE_FALSE(scheduler.signalChoice(id, 1));
+    REQUIRE(log.size() == 1);
+
+    REQUIRE(scheduler.signalInput(id));
+    REQUIRE(log.size() == 1); // Resumes on the next update, not in the signal
+    scheduler.update(0.0);
+    REQUIRE(log.back() == "line 2");
+    REQUIRE(scheduler.getWait(id) == FiberWait::Choice);
+
+    REQUIRE(scheduler.signalChoice(id, 2));
+    scheduler.update(0.0);
+    REQUIRE(log.back() == "choice 2");
+    REQUIRE(scheduler.getWait(id) == FiberWait::Timer);
+
+    scheduler.update(0.6);
+    REQUIRE(log.back() == "choice 2");
+    scheduler.update(0.6);
+    REQUIRE(log.back() == "done");
+    REQUIRE_FALSE(scheduler.isAlive(id));
+}
+
+TEST_CASE("Fibers can spawn and cancel fibers", "[scripting][fiber]")
+{
+    FiberScheduler scheduler;
+    int frames = 0;
+    scheduler.spawn(spawner(scheduler, frames));
+
+    scheduler.update(0.0);
+    REQUIRE(frames == 0); // Spawned fibers start on the following update
+    REQUIRE(scheduler.size() == 1);
+
+    scheduler.update(0.0);
+    REQUIRE(frames == 1);
+
+    std::vector<std::string> log;
+    FiberId waiting = scheduler.spawn(dialogue(log));
+    REQUIRE(scheduler.cancel(waiting));
+    REQUIRE_FALSE(scheduler.isAlive(waiting));
+    scheduler.update(0.0);
+    REQUIRE(log.empty());
+
+    scheduler.clear();
+    REQUIRE(scheduler.size() == 0);
+}
+
+TEST_CASE("runVirtualMachine drives independent VM contexts", "[scripting][fiber]")
+{
+    // say; wait 0.5; choice of two; store the selection
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_NULL, 0},
+        {OpCode::SAY, 0},
+        {OpCode::WAIT, floatBits(0.5f)},
+        {OpCode::PUSH_INT, 2},
+        {OpCode::PUSH_STRING, 1},
+        {OpCode::PUSH_STRING, 2},
+        {OpCode::CHOICE, 2},
+        {OpCode::STORE_SLOT, 0},
+        {OpCode::HALT, 0}
+    };
+    std::vector<std::string> strings = {"Hello", "A", "B"};
+
+    VirtualMachine story;
+    VirtualMachine ambient;
+    REQUIRE(story.load(program, strings, {"picked"}).isOk());
+    REQUIRE(ambient.load(program, strings, {"picked"}).isOk());
+
+    FiberScheduler scheduler;
+    FiberId storyId = scheduler.spawn(runVirtualMachine(story));
+    FiberId ambientId = scheduler.spawn(runVirtualMachine(ambient));
+
+    scheduler.update(0.0);
+    REQUIRE(story.getWaitReason() == OpCode::SAY);
+    REQUIRE(ambient.getWaitReason() == OpCode::SAY);
+
+    REQUIRE(scheduler.signalInput(storyId));
+    scheduler.update(0.0);
+    REQUIRE(story.getWaitReason() == OpCode::WAIT);
+    REQUIRE(story.getWaitDuration() == 0.5f);
+    REQUIRE(ambient.getWaitReason() == OpCode::SAY);
+
+    scheduler.update(0.5);
+    REQUIRE(story.getWaitReason() == OpCode::CHOICE);
+
+    REQUIRE(scheduler.signalChoice(storyId, 1));
+    scheduler.update(0.0);
+    REQUIRE(story.isHalted());
+    REQUIRE(std::get<i32>(story.getVariable("picked")) == 1);
+    REQUIRE_FALSE(scheduler.isAlive(storyId));
+
+    // The other context never advanced
+    REQUIRE(scheduler.isAlive(ambientId));
+    REQUIRE(ambient.isWaiting());
+}
+
+TEST_CASE("ScriptRuntime runs the story as a fiber", "[scripting][fiber]")
+{
+    Lexer lexer;
+    Parser parser;
+    Compiler compiler;
+    auto tokens = lexer.tokenize(R"(
+scene intro {
+    say "One"
+    say "Two"
+    set seen = true
+}
+)");
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    auto script = compiler.compile(program.value());
+    REQUIRE(script.isOk());
+
+    ScriptRuntime runtime;
+    runtime.setExecutionMode(ExecutionMode::Fibers);
+    REQUIRE(runtime.load(script.value()).isOk());
+    runtime.start();
+
+    runtime.update(0.016);
+    REQUIRE(runtime.isWaitingForInput());
+
+    runtime.continueExecution();
+    runtime.update(0.016);
+    REQUIRE(runtime.isWaitingForInput());
+
+    runtime.continueExecution();
+    runtime.update(0.016);
+    REQUIRE(runtime.isComplete());
+    REQUIRE(std::get<bool>(runtime.getVariable("seen")));
+}
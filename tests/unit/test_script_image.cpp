@@ -0,0 +1,270 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/script_image.hpp"
+#include "NovelMind/scripting/vm.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* kStory = R"(character Hero(name="Alex", color="#ffcc00")
+scene start {
+    set visits = 1
+    set score = visits + 2
+    goto middle
+}
+scene unused {
+    set label = "never"
+    show background "bg_unused"
+}
+scene middle {
+    set score = score * 3
+    if score > 5 {
+        set label = "high"
+    }
+})";
+
+CompiledScript compileScript(const char* source)
+{
+    Lexer lexer;
+    Parser parser;
+    Compiler compiler;
+    auto tokens = lexer.tokenize(source);
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    auto script = compiler.compile(program.value());
+    REQUIRE(script.isOk());
+    return script.value();
+}
+
+ScriptImagePtr makeImage(const CompiledScript& script)
+{
+    auto image = ScriptImage::fromBytes(serializeScriptImage(script));
+    REQUIRE(image.isOk());
+    return image.value();
+}
+
+// Point the first string operand of a scene past the string table
+std::vector<u8> corruptScene(const CompiledScript& script, const std::string& scene)
+{
+    auto image = makeImage(script);
+    auto index = image->findScene(scene);
+    REQUIRE(index.has_value());
+    const ImageScene range = image->getScene(*index);
+
+    std::vector<u8> bytes = serializeScriptImage(script);
+    u32 codeOffset = 0;
+    std::memcpy(&codeOffset, bytes.data() + 32, sizeof(u32));
+    for (u32 i = range.entry; i < range.end; ++i) {
+        if (hasStringOperand(image->getInstructions()[i].opcode)) {
+            const u32 invalid = 0xFFFFu;
+            std::memcpy(bytes.data() + codeOffset + i * sizeof(Instruction) + 4,
+                        &invalid, sizeof(u32));
+            return bytes;
+        }
+    }
+    FAIL("Scene has no string operand");
+    return bytes;
+}
+
+} // namespace
+
+TEST_CASE("Script image round-trips a compiled script", "[script_image]")
+{
+    CompiledScript script = compileScript(kStory);
+    auto image = makeImage(script);
+
+    CompiledScript decoded = image->toCompiledScript();
+    REQUIRE(decoded.instructions.size() == script.instructions.size());
+    for (usize i = 0; i < script.instructions.size(); ++i) {
+        CHECK(decoded.instructions[i].opcode == script.instructions[i].opcode);
+        CHECK(decoded.instructions[i].operand == script.instructions[i].operand);
+    }
+    CHECK(decoded.stringTable == script.stringTable);
+    CHECK(decoded.variableSlots == script.variableSlots);
+    CHECK(decoded.sceneEntryPoints == script.sceneEntryPoints);
+    REQUIRE(decoded.characters.count("Hero") == 1);
+    CHECK(decoded.characters["Hero"].displayName == "Alex");
+    CHECK(decoded.characters["Hero"].color == "#ffcc00");
+    REQUIRE(decoded.lineTable.size() == script.lineTable.size());
+    CHECK(decoded.lineTable.back().location.line == script.lineTable.back().location.line);
+
+    // Scenes are indexed by entry point and found by name
+    REQUIRE(image->getSceneCount() == 3);
+    CHECK(image->getScene(0).name == "start");
+    CHECK(image->getScene(0).end == image->getScene(1).entry);
+    CHECK(image->findScene("unused") == 1u);
+    CHECK_FALSE(image->findScene("missing").has_value());
+    CHECK(image->findSceneAt(image->getScene(1).entry + 1) == 1u);
+}
+
+TEST_CASE("Script image links name-addressed variables to slots", "[script_image]")
+{
+    CompiledScript script;
+    script.stringTable = {"gold"};
+    script.instructions = {Instruction(OpCode::PUSH_INT, 7),
+                           Instruction(OpCode::STORE_VAR, 0),
+                           Instruction(OpCode::LOAD_GLOBAL, 0),
+                           Instruction(OpCode::HALT)};
+    auto image = makeImage(script);
+
+    REQUIRE(image->getVariableSlotCount() == 1);
+    CHECK(image->getVariableSlot(0) == "gold");
+    CHECK(image->getInstructions()[1].opcode == OpCode::STORE_SLOT);
+    CHECK(image->getInstructions()[2].opcode == OpCode::LOAD_SLOT);
+}
+
+TEST_CASE("Script image scenes are validated when the VM enters them", "[script_image]")
+{
+    CompiledScript script = compileScript(kStory);
+    auto image = makeImage(script);
+    CHECK(image->getLoadedSceneCount() == 0);
+
+    auto program = VMProgram::create(image);
+    REQUIRE(program.isOk());
+    VirtualMachine vm;
+    REQUIRE(vm.load(program.value()).isOk());
+    vm.run();
+
+    CHECK(vm.isHalted());
+    CHECK(image->isSceneLoaded(0));
+    CHECK_FALSE(image->isSceneLoaded(1));
+    CHECK(image->isSceneLoaded(2));
+    CHECK(image->getLoadedSceneCount() == 2);
+}
+
+TEST_CASE("Script image runs like the linked instruction vector", "[script_image]")
+{
+    CompiledScript script = compileScript(kStory);
+
+    for (DispatchMode mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        auto fromVector = VMProgram::create(script.instructions, script.stringTable,
+                                            script.variableSlots);
+        auto fromImage = VMProgram::create(makeImage(script));
+        REQUIRE(fromVector.isOk());
+        REQUIRE(fromImage.isOk());
+
+        VirtualMachine expected;
+        VirtualMachine actual;
+        expected.setDispatchMode(mode);
+        actual.setDispatchMode(mode);
+        REQUIRE(expected.load(fromVector.value()).isOk());
+        REQUIRE(actual.load(fromImage.value()).isOk());
+        expected.run();
+        actual.run();
+
+        CHECK(actual.getVariables() == expected.getVariables());
+        CHECK(actual.getIP() == expected.getIP());
+        auto score = actual.getVariable("score");
+        REQUIRE(std::holds_alternative<i32>(score));
+        CHECK(std::get<i32>(score) == 9);
+    }
+}
+
+TEST_CASE("Script image rejects only the corrupt scene", "[script_image]")
+{
+    CompiledScript script = compileScript(kStory);
+
+    // The damage is in a scene that is never entered, so opening succeeds
+    auto image = ScriptImage::fromBytes(corruptScene(script, "unused"));
+    REQUIRE(image.isOk());
+    CHECK(image.value()->loadScene(0).isOk());
+    auto broken = image.value()->loadScene(1);
+    REQUIRE(broken.isError());
+    CHECK(broken.error().find("unused") != std::string::npos);
+    CHECK_FALSE(image.value()->isSceneLoaded(1));
+
+    auto program = VMProgram::create(image.value());
+    REQUIRE(program.isOk());
+    VirtualMachine vm;
+    REQUIRE(vm.load(program.value()).isOk());
+    vm.run();
+    CHECK(std::get<i32>(vm.getVariable("score")) == 9);
+
+    // Entering the corrupt scene halts instead of executing it
+    auto start = image.value()->getScene(1).entry;
+    auto entered = ScriptImage::fromBytes(corruptScene(script, "unused"));
+    REQUIRE(entered.isOk());
+    auto enteredProgram = VMProgram::create(entered.value());
+    REQUIRE(enteredProgram.isOk());
+    VirtualMachine corrupt;
+    REQUIRE(corrupt.load(enteredProgram.value()).isOk());
+    REQUIRE(corrupt.restoreExecution(start, {}, OpCode::NOP).isOk());
+    CHECK_FALSE(corrupt.step());
+    CHECK(corrupt.isHalted());
+    CHECK(corrupt.getIP() == start);
+}
+
+TEST_CASE("Script image rejects truncated and foreign data", "[script_image]")
+{
+    std::vector<u8> bytes = serializeScriptImage(compileScript(kStory));
+
+    CHECK(ScriptImage::fromBytes({}).isError());
+    CHECK(ScriptImage::fromBytes(std::vector<u8>(bytes.begin(), bytes.begin() + 40))
+              .isError());
+    CHECK(ScriptImage::fromBytes(std::vector<u8>(bytes.begin(), bytes.end() - 8))
+              .isError());
+
+    std::vector<u8> otherVersion = bytes;
+    otherVersion[4] = 2;
+    auto rejected = ScriptImage::fromBytes(otherVersion);
+    REQUIRE(rejected.isError());
+    CHECK(rejected.error().find("version") != std::string::npos);
+}
+
+TEST_CASE("Script image rejects scene tables that leave code unvalidated", "[script_image]")
+{
+    const std::vector<u8> bytes = serializeScriptImage(compileScript(kStory));
+    u32 scenesOffset = 0;
+    std::memcpy(&scenesOffset, bytes.data() + 44, sizeof(u32));
+    // Scene records are a name reference, then the entry and end points
+    auto patchScene = [&](u32 scene, usize field, i32 delta) {
+        std::vector<u8> patched = bytes;
+        u8* value = patched.data() + scenesOffset + scene * 16 + field;
+        u32 point = 0;
+        std::memcpy(&point, value, sizeof(u32));
+        point = static_cast<u32>(static_cast<i32>(point) + delta);
+        std::memcpy(value, &point, sizeof(u32));
+        return patched;
+    };
+    REQUIRE(ScriptImage::fromBytes(bytes).isOk());
+
+    // A gap between the first two scenes
+    auto gapped = ScriptImage::fromBytes(patchScene(1, 8, 1));
+    REQUIRE(gapped.isError());
+    CHECK(gapped.error().find("scene") != std::string::npos);
+
+    // A last scene that stops short of the end of the code
+    CHECK(ScriptImage::fromBytes(patchScene(2, 12, -1)).isError());
+}
+
+TEST_CASE("Script image maps a compiled file", "[script_image]")
+{
+    CompiledScript script = compileScript(kStory);
+    const fs::path path = fs::temp_directory_path() / "novelmind_script_image.nmc";
+    {
+        std::vector<u8> bytes = serializeScriptImage(script);
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+    }
+
+    auto image = ScriptImage::open(path.string());
+    REQUIRE(image.isOk());
+    CHECK(image.value()->getInstructions().size() == script.instructions.size());
+    CHECK(image.value()->getString(0) == script.stringTable[0]);
+    CHECK(image.value()->loadScene(1).isOk());
+
+    CHECK(ScriptImage::open((fs::temp_directory_path() / "novelmind_missing.nmc").string())
+              .isError());
+    fs::remove(path);
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/core/thread_pool.hpp"
+
+#include <atomic>
+
+using namespace NovelMind;
+using namespace NovelMind::core;
+
+namespace {
+
+// Binary tree of tasks, each submitting its children from a worker
+void spawnTree(ThreadPool& pool, std::atomic<int>& visited, int depth)
+{
+    visited.fetch_add(1);
+    if (depth == 0) {
+        return;
+    }
+    for (int i = 0; i < 2; ++i) {
+        pool.submit([&pool, &visited, depth] { spawnTree(pool, visited, depth - 1); });
+    }
+}
+
+} // namespace
+
+TEST_CASE("ThreadPool runs nested tasks until idle", "[core][thread_pool]")
+{
+    ThreadPool pool(4);
+    REQUIRE(pool.getThreadCount() == 4);
+    REQUIRE(pool.getCurrentWorker() == ThreadPool::NOT_A_WORKER);
+
+    std::atomic<int> visited{0};
+    pool.submit([&] { spawnTree(pool, visited, 10); });
+    pool.wait();
+    REQUIRE(visited.load() == (1 << 11) - 1);
+
+    // Reusable after wait()
+    std::atomic<bool> onWorker{false};
+    pool.submit([&] { onWorker = pool.getCurrentWorker() < pool.getThreadCount(); });
+    pool.wait();
+    REQUIRE(onWorker.load());
+}
+
+TEST_CASE("ThreadPool finishes queued tasks on destruction", "[core][thread_pool]")
+{
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] { done.fetch_add(1); });
+        }
+    }
+    REQUIRE(done.load() == 100);
+}
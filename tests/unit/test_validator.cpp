@@ -5,6 +5,15 @@
 
 using namespace NovelMind::scripting;
 
+// Append a statement to a scene body allocated in the program's arena
+template <typename T>
+static void addStatement(Program& program, SceneDecl& scene, T&& stmt)
+{
+    std::vector<StmtPtr> body(scene.body.begin(), scene.body.end());
+    body.push_back(makeStmt(*program.arena, std::forward<T>(stmt)));
+    scene.body = program.arena->makeList(body);
+}
+
 // Helper to create a simple program for testing
 [[maybe_unused]] static Program createTestProgram()
 {
@@ -139,7 +148,7 @@ TEST_CASE("Validator - Undefined character in show statement reports error", "[v
     showStmt.identifier = "UndefinedCharacter";
     showStmt.position = Position::Center;
 
-    scene.body.push_back(makeStmt(showStmt));
+    addStatement(program, scene, showStmt);
     program.scenes.push_back(std::move(scene));
 
     auto result = validator.validate(program);
@@ -169,7 +178,7 @@ TEST_CASE("Validator - Undefined scene in goto reports error", "[validator]")
     GotoStmt gotoStmt;
     gotoStmt.target = "nonexistent_scene";
 
-    scene.body.push_back(makeStmt(gotoStmt));
+    addStatement(program, scene, gotoStmt);
     program.scenes.push_back(std::move(scene));
 
     auto result = validator.validate(program);
@@ -200,14 +209,14 @@ TEST_CASE("Validator - Valid goto to defined scene passes", "[validator]")
 
     GotoStmt gotoStmt;
     gotoStmt.target = "scene2";
-    scene1.body.push_back(makeStmt(gotoStmt));
+    addStatement(program, scene1, gotoStmt);
     program.scenes.push_back(std::move(scene1));
 
     SceneDecl scene2;
     scene2.name = "scene2";
     SayStmt sayStmt;
     sayStmt.text = "Hello";
-    scene2.body.push_back(makeStmt(sayStmt));
+    addStatement(program, scene2, sayStmt);
     program.scenes.push_back(std::move(scene2));
 
     auto result = validator.validate(program);
@@ -242,7 +251,7 @@ TEST_CASE("Validator - Unused character reports warning", "[validator]")
     scene.name = "test_scene";
     SayStmt sayStmt;
     sayStmt.text = "Hello";
-    scene.body.push_back(makeStmt(sayStmt));
+    addStatement(program, scene, sayStmt);
     program.scenes.push_back(std::move(scene));
 
     auto result = validator.validate(program);
@@ -281,7 +290,7 @@ TEST_CASE("Validator - Used character does not report warning", "[validator]")
     showStmt.target = ShowStmt::Target::Character;
     showStmt.identifier = "Hero";
     showStmt.position = Position::Center;
-    scene.body.push_back(makeStmt(showStmt));
+    addStatement(program, scene, showStmt);
 
     program.scenes.push_back(std::move(scene));
 
@@ -309,7 +318,7 @@ TEST_CASE("Validator - Empty choice block reports error", "[validator]")
 
     ChoiceStmt choiceStmt;
     // No options
-    scene.body.push_back(makeStmt(std::move(choiceStmt)));
+    addStatement(program, scene, std::move(choiceStmt));
     program.scenes.push_back(std::move(scene));
 
     auto result = validator.validate(program);
@@ -339,7 +348,7 @@ TEST_CASE("Validator - Undefined speaker in say reports error", "[validator]")
     SayStmt sayStmt;
     sayStmt.speaker = "UndefinedSpeaker";
     sayStmt.text = "Hello";
-    scene.body.push_back(makeStmt(sayStmt));
+    addStatement(program, scene, sayStmt);
     program.scenes.push_back(std::move(scene));
 
     auto result = validator.validate(program);
@@ -380,12 +389,12 @@ TEST_CASE("Validator - Valid program validates successfully", "[validator]")
     showStmt.target = ShowStmt::Target::Character;
     showStmt.identifier = "Hero";
     showStmt.position = Position::Center;
-    scene.body.push_back(makeStmt(showStmt));
+    addStatement(program, scene, showStmt);
 
     SayStmt sayStmt;
     sayStmt.speaker = "Hero";
     sayStmt.text = "Hello, world!";
-    scene.body.push_back(makeStmt(sayStmt));
+    addStatement(program, scene, sayStmt);
 
     program.scenes.push_back(std::move(scene));
 
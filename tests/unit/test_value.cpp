@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include "NovelMind/scripting/value.hpp"
+#include "NovelMind/scripting/vm_value.hpp"
 
 using namespace NovelMind::scripting;
 
@@ -65,3 +66,53 @@ TEST_CASE("asString conversions", "[value]")
     REQUIRE(asString(false) == "false");
     REQUIRE(asString(std::monostate{}) == "null");
 }
+
+TEST_CASE("StringPool interns equal strings to one handle", "[value]")
+{
+    StringPool pool;
+
+    REQUIRE(pool.intern("") == 0);
+
+    auto a = pool.intern("hello");
+    auto b = pool.intern(std::string{"hel"} + "lo");
+    REQUIRE(a == b);
+    REQUIRE(pool.intern("world") != a);
+    REQUIRE(pool.get(a) == "hello");
+
+    StringPool copy = pool;
+    REQUIRE(copy.intern("hello") == a);
+
+    pool.clear();
+    REQUIRE(pool.size() == 1);
+}
+
+TEST_CASE("VMValue round-trips through Value", "[value]")
+{
+    StringPool pool;
+
+    std::vector<Value> values = {
+        std::monostate{}, NovelMind::i32{-7}, NovelMind::f32{2.5f}, true,
+        std::string{"text"}};
+
+    for (const auto &value : values) {
+        VMValue packed = fromValue(value, pool);
+        REQUIRE(packed.type == getValueType(value));
+        REQUIRE(toValue(packed, pool) == value);
+        REQUIRE(toString(packed, pool) == asString(value));
+    }
+}
+
+TEST_CASE("VMValue equality matches string comparison semantics", "[value]")
+{
+    StringPool pool;
+
+    auto str = [&](const char *s) { return VMValue::fromString(pool.intern(s)); };
+
+    REQUIRE(valuesEqual(VMValue::fromInt(3), VMValue::fromInt(3), pool));
+    REQUIRE_FALSE(valuesEqual(VMValue::fromInt(3), VMValue::fromInt(4), pool));
+    REQUIRE(valuesEqual(str("a"), str("a"), pool));
+    REQUIRE_FALSE(valuesEqual(str("a"), str("b"), pool));
+    REQUIRE(valuesEqual(VMValue::fromInt(1), str("1"), pool));
+    REQUIRE(valuesEqual(VMValue::null(), str("null"), pool));
+    REQUIRE_FALSE(valuesEqual(VMValue::fromInt(1), VMValue::fromBool(true), pool));
+}
@@ -204,3 +204,293 @@ TEST_CASE("VM reset", "[scripting]")
     REQUIRE_FALSE(vm.isHalted());
     REQUIRE_FALSE(vm.isRunning());
 }
+
+TEST_CASE("VM slot-addressed variables", "[scripting]")
+{
+    VirtualMachine vm;
+
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_INT, 7},
+        {OpCode::STORE_SLOT, 1},
+        {OpCode::LOAD_SLOT, 1},
+        {OpCode::PUSH_INT, 3},
+        {OpCode::ADD, 0},
+        {OpCode::STORE_SLOT, 0},
+        {OpCode::HALT, 0}
+    };
+
+    auto result = vm.load(program, {}, {"total", "base"});
+    REQUIRE(result.isOk());
+
+    vm.run();
+
+    REQUIRE(std::get<NovelMind::i32>(vm.getVariable("base")) == 7);
+    REQUIRE(std::get<NovelMind::i32>(vm.getVariable("total")) == 10);
+    REQUIRE(vm.getVariables().size() == 2);
+}
+
+TEST_CASE("VM rejects out-of-range variable slots", "[scripting]")
+{
+    VirtualMachine vm;
+
+    std::vector<Instruction> program = {
+        {OpCode::LOAD_SLOT, 3},
+        {OpCode::HALT, 0}
+    };
+
+    REQUIRE(vm.load(program, {}, {"only"}).isError());
+    REQUIRE(vm.load({{OpCode::HALT, 0}}, {}, {"dup", "dup"}).isError());
+}
+
+TEST_CASE("VM name and slot access share storage", "[scripting]")
+{
+    VirtualMachine vm;
+
+    // Legacy name-addressed STORE_VAR must land in the same slot
+    std::vector<Instruction> program = {
+        {OpCode::LOAD_SLOT, 0},
+        {OpCode::PUSH_INT, 1},
+        {OpCode::ADD, 0},
+        {OpCode::STORE_VAR, 0},
+        {OpCode::HALT, 0}
+    };
+
+    vm.setVariable("counter", NovelMind::i32{41});
+    REQUIRE_FALSE(vm.hasVariable("missing"));
+
+    auto result = vm.load(program, {"counter"}, {"counter"});
+    REQUIRE(result.isOk());
+    REQUIRE(vm.hasVariable("counter"));
+
+    vm.run();
+
+    REQUIRE(std::get<NovelMind::i32>(vm.getVariable("counter")) == 42);
+}
+
+TEST_CASE("VM string concatenation and comparison", "[scripting]")
+{
+    VirtualMachine vm;
+
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_STRING, 0},
+        {OpCode::PUSH_STRING, 1},
+        {OpCode::ADD, 0},
+        {OpCode::DUP, 0},
+        {OpCode::STORE_SLOT, 0},
+        {OpCode::PUSH_STRING, 2},
+        {OpCode::EQ, 0},
+        {OpCode::STORE_SLOT, 1},
+        {OpCode::HALT, 0}
+    };
+
+    auto result = vm.load(program, {"ab", "cd", "abcd"}, {"text", "same"});
+    REQUIRE(result.isOk());
+
+    vm.run();
+
+    REQUIRE(std::get<std::string>(vm.getVariable("text")) == "abcd");
+    REQUIRE(std::get<bool>(vm.getVariable("same")) == true);
+}
+
+TEST_CASE("VM drops concatenation results nothing refers to", "[scripting]")
+{
+    // acc = ""; for (i = 0; i < 3000; ++i) { acc = acc + "x"; label = "item" + i }
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_STRING, 0}, {OpCode::STORE_SLOT, 0},
+        {OpCode::PUSH_INT, 0},    {OpCode::STORE_SLOT, 1},
+        {OpCode::LOAD_SLOT, 1},   {OpCode::PUSH_INT, 3000},
+        {OpCode::LT, 0},          {OpCode::JUMP_IF_NOT, 21},
+        {OpCode::LOAD_SLOT, 0},   {OpCode::PUSH_STRING, 1},
+        {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 0},
+        {OpCode::PUSH_STRING, 2}, {OpCode::LOAD_SLOT, 1},
+        {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 2},
+        {OpCode::LOAD_SLOT, 1},   {OpCode::PUSH_INT, 1},
+        {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 1},
+        {OpCode::JUMP, 4},        {OpCode::HALT, 0}
+    };
+
+    for (auto mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        VirtualMachine vm;
+        vm.setDispatchMode(mode);
+        REQUIRE(vm.load(program, {"", "x", "item"}, {"acc", "i", "label"}).isOk());
+
+        vm.run();
+
+        REQUIRE(vm.isHalted());
+        REQUIRE(std::get<std::string>(vm.getVariable("acc")) == std::string(3000, 'x'));
+        REQUIRE(std::get<std::string>(vm.getVariable("label")) == "item2999");
+        // 6000 strings were created; only the live ones and some slack remain
+        REQUIRE(vm.getStringCount() < 600);
+    }
+}
+
+TEST_CASE("VM threaded dispatch matches switch dispatch", "[scripting]")
+{
+    // sum = 0; for (i = 0; i < 10; ++i) { sum = sum + i * 2; } label = "n" + sum
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_INT, 0},    {OpCode::STORE_SLOT, 0},
+        {OpCode::PUSH_INT, 0},    {OpCode::STORE_SLOT, 1},
+        {OpCode::LOAD_SLOT, 1},   {OpCode::PUSH_INT, 10},
+        {OpCode::LT, 0},          {OpCode::JUMP_IF_NOT, 19},
+        {OpCode::LOAD_SLOT, 0},   {OpCode::LOAD_SLOT, 1},
+        {OpCode::PUSH_INT, 2},    {OpCode::MUL, 0},
+        {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 0},
+        {OpCode::LOAD_SLOT, 1},   {OpCode::PUSH_INT, 1},
+        {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 1},
+        {OpCode::JUMP, 4},
+        {OpCode::PUSH_STRING, 0}, {OpCode::LOAD_SLOT, 0},
+        {OpCode::ADD, 0},         {OpCode::STORE_SLOT, 2},
+        {OpCode::HALT, 0}
+    };
+
+    for (auto mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        VirtualMachine vm;
+        vm.setDispatchMode(mode);
+        REQUIRE(vm.load(program, {"n"}, {"sum", "i", "label"}).isOk());
+
+        vm.run();
+
+        REQUIRE(vm.isHalted());
+        REQUIRE(vm.getIP() == 24);
+        REQUIRE(std::get<NovelMind::i32>(vm.getVariable("sum")) == 90);
+        REQUIRE(std::get<std::string>(vm.getVariable("label")) == "n90");
+    }
+}
+
+TEST_CASE("VM threaded dispatch suspends at SAY", "[scripting]")
+{
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_NULL, 0},
+        {OpCode::SAY, 0},
+        {OpCode::PUSH_INT, 5},
+        {OpCode::STORE_SLOT, 0},
+        {OpCode::HALT, 0}
+    };
+
+    VirtualMachine vm;
+    vm.setDispatchMode(DispatchMode::Threaded);
+
+    int sayCount = 0;
+    vm.registerCallback(OpCode::SAY, [&](const auto &) { ++sayCount; });
+    REQUIRE(vm.load(program, {"Hello"}, {"after"}).isOk());
+
+    vm.run();
+    REQUIRE(vm.isWaiting());
+    REQUIRE(vm.getIP() == 2);
+    REQUIRE(sayCount == 1);
+    REQUIRE_FALSE(vm.hasVariable("after"));
+
+    vm.signalContinue();
+    REQUIRE(vm.isHalted());
+    REQUIRE(std::get<NovelMind::i32>(vm.getVariable("after")) == 5);
+}
+
+TEST_CASE("VM passes command arguments to callbacks", "[scripting]")
+{
+    // say hero "Hello"; choice of two options; store the selection
+    std::vector<Instruction> program = {
+        {OpCode::PUSH_STRING, 1},
+        {OpCode::SAY, 0},
+        {OpCode::PUSH_INT, 2},
+        {OpCode::PUSH_STRING, 2},
+        {OpCode::PUSH_STRING, 3},
+        {OpCode::CHOICE, 2},
+        {OpCode::STORE_SLOT, 0},
+        {OpCode::HALT, 0}
+    };
+
+    for (auto mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        VirtualMachine vm;
+        vm.setDispatchMode(mode);
+
+        std::vector<Value> said;
+        std::vector<Value> options;
+        vm.registerCallback(OpCode::SAY,
+                            [&](NativeArgs args) { said.assign(args.begin(), args.end()); });
+        vm.registerCallback(OpCode::CHOICE,
+                            [&](NativeArgs args) { options.assign(args.begin(), args.end()); });
+        REQUIRE(vm.load(program, {"Hello", "hero", "Left", "Right"}, {"picked"}).isOk());
+
+        vm.run();
+        REQUIRE(said.size() == 2);
+        REQUIRE(asString(said[0]) == "Hello");
+        REQUIRE(asString(said[1]) == "hero");
+
+        vm.signalContinue();
+        REQUIRE(vm.isWaiting());
+        REQUIRE(options.size() == 3);
+        REQUIRE(asInt(options[0]) == 2);
+        REQUIRE(asString(options[1]) == "Left");
+        REQUIRE(asString(options[2]) == "Right");
+
+        vm.signalChoice(1);
+        REQUIRE(vm.isHalted());
+        REQUIRE(std::get<NovelMind::i32>(vm.getVariable("picked")) == 1);
+    }
+}
+
+TEST_CASE("VM contexts share one immutable program", "[scripting]")
+{
+    // counter = counter + 1; label = "n" + "!"; halt
+    std::vector<Instruction> program = {
+        {OpCode::LOAD_VAR, 0},
+        {OpCode::PUSH_INT, 1},
+        {OpCode::ADD, 0},
+        {OpCode::STORE_VAR, 0},
+        {OpCode::PUSH_STRING, 2},
+        {OpCode::PUSH_STRING, 3},
+        {OpCode::ADD, 0},
+        {OpCode::STORE_VAR, 1},
+        {OpCode::HALT, 0}
+    };
+    auto linked = VMProgram::create(program, {"counter", "label", "n", "!"});
+    REQUIRE(linked.isOk());
+    VMProgramPtr shared = linked.value();
+    REQUIRE(shared->getVariableNames().size() == 2);
+
+    for (auto mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        VirtualMachine first;
+        VirtualMachine second;
+        first.setDispatchMode(mode);
+        second.setDispatchMode(mode);
+        REQUIRE(first.load(shared).isOk());
+        REQUIRE(second.load(shared).isOk());
+        REQUIRE(first.getProgram().get() == shared.get());
+        REQUIRE(second.getProgram().get() == shared.get());
+
+        // Each context owns its variables, including host-only ones
+        first.setVariable("counter", NovelMind::i32{10});
+        first.setVariable("hostOnly", std::string("first"));
+        first.run();
+        second.run();
+
+        REQUIRE(first.isHalted());
+        REQUIRE(second.isHalted());
+        REQUIRE(std::get<NovelMind::i32>(first.getVariable("counter")) == 11);
+        REQUIRE(std::get<NovelMind::i32>(second.getVariable("counter")) == 1);
+        REQUIRE(asString(first.getVariable("label")) == "n!");
+        REQUIRE(asString(second.getVariable("label")) == "n!");
+        REQUIRE(asString(first.getVariable("hostOnly")) == "first");
+        REQUIRE_FALSE(second.hasVariable("hostOnly"));
+
+        // Reloading keeps variables set so far
+        REQUIRE(first.load(shared).isOk());
+        REQUIRE(std::get<NovelMind::i32>(first.getVariable("counter")) == 11);
+        REQUIRE(asString(first.getVariable("hostOnly")) == "first");
+    }
+
+    // Run-time strings live in each context, never in the shared pool
+    REQUIRE_FALSE(shared->getStrings()->find("n!").has_value());
+}
+
+TEST_CASE("VMProgram rejects invalid slot references", "[scripting]")
+{
+    REQUIRE(VMProgram::create({}, {}).isError());
+    REQUIRE(VMProgram::create({{OpCode::LOAD_SLOT, 1}, {OpCode::HALT, 0}}, {}, {"a"})
+                .isError());
+    REQUIRE(VMProgram::create({{OpCode::HALT, 0}}, {}, {"a", "a"}).isError());
+
+    VirtualMachine vm;
+    REQUIRE(vm.load(VMProgramPtr{}).isError());
+    REQUIRE_FALSE(vm.step());
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+#include "NovelMind/scripting/bytecode_optimizer.hpp"
+#include "NovelMind/scripting/compiler.hpp"
+#include "NovelMind/scripting/lexer.hpp"
+#include "NovelMind/scripting/parser.hpp"
+#include "NovelMind/scripting/vm.hpp"
+#include "NovelMind/scripting/vm_profiler.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace NovelMind;
+using namespace NovelMind::scripting;
+
+namespace {
+
+const char* kScript = R"(scene start {
+    set a = 1
+    set b = a + 2
+    if b > 2 {
+        set c = b * 3
+    }
+})";
+
+CompiledScript compileScript(const char* source)
+{
+    Lexer lexer;
+    Parser parser;
+    Compiler compiler;
+    auto tokens = lexer.tokenize(source);
+    REQUIRE(tokens.isOk());
+    auto program = parser.parse(tokens.value());
+    REQUIRE(program.isOk());
+    auto script = compiler.compile(program.value());
+    REQUIRE(script.isOk());
+    return script.value();
+}
+
+} // namespace
+
+TEST_CASE("Compiler emits a line table", "[scripting][vm_profiler]")
+{
+    CompiledScript script = compileScript(kScript);
+
+    REQUIRE_FALSE(script.lineTable.empty());
+    for (usize i = 1; i < script.lineTable.size(); ++i) {
+        CHECK(script.lineTable[i - 1].instruction < script.lineTable[i].instruction);
+    }
+
+    const SourceLocation* first = findSourceLocation(script.lineTable, 0);
+    REQUIRE(first != nullptr);
+    CHECK(first->line == 2);
+
+    // The multiply belongs to the statement on line 5
+    for (u32 i = 0; i < script.instructions.size(); ++i) {
+        if (script.instructions[i].opcode == OpCode::MUL) {
+            const SourceLocation* loc = findSourceLocation(script.lineTable, i);
+            REQUIRE(loc != nullptr);
+            CHECK(loc->line == 5);
+        }
+    }
+}
+
+TEST_CASE("Line table survives bytecode optimization", "[scripting][vm_profiler]")
+{
+    CompiledScript script = compileScript(kScript);
+    BytecodeOptimizer optimizer(OptimizationLevel::Full);
+    optimizer.optimize(script);
+
+    REQUIRE_FALSE(script.lineTable.empty());
+    for (const auto& entry : script.lineTable) {
+        CHECK(entry.instruction < script.instructions.size());
+        CHECK(entry.location.line >= 2);
+        CHECK(entry.location.line <= 5);
+    }
+}
+
+TEST_CASE("VMProfiler counts executions per opcode and instruction", "[scripting][vm_profiler]")
+{
+    CompiledScript script = compileScript(kScript);
+
+    for (DispatchMode mode : {DispatchMode::Switch, DispatchMode::Threaded}) {
+        VirtualMachine vm;
+        REQUIRE(vm.load(script.instructions, script.stringTable, script.variableSlots).isOk());
+        vm.setDispatchMode(mode);
+
+        VMProfiler profiler;
+        vm.setProfiler(&profiler);
+        vm.run();
+
+        CHECK(vm.getVariable("c") == Value{9});
+        if (!VirtualMachine::isProfilingAvailable()) {
+            CHECK(profiler.getTotal().count == 0);
+            continue;
+        }
+
+        CHECK(profiler.getOpcode(OpCode::MUL).count == 1);
+        CHECK(profiler.getOpcode(OpCode::ADD).count == 1);
+
+        // Every instruction of this straight-line script runs once, plus
+        // the final HALT
+        const ExecutionCounter total = profiler.getTotal();
+        CHECK(total.count >= script.instructions.size() - 1);
+        for (u32 i = 0; i + 1 < script.instructions.size(); ++i) {
+            CHECK(profiler.getInstruction(i).count <= 1);
+        }
+
+        auto spots = profiler.getHotSpots(script.lineTable, 3);
+        REQUIRE(spots.size() == 3);
+        CHECK(spots[0].counter.nanoseconds >= spots[1].counter.nanoseconds);
+        CHECK(spots[0].location.line >= 2);
+
+        u64 lineCount = 0;
+        for (const auto& line : profiler.getSourceLines(script.lineTable)) {
+            lineCount += line.counter.count;
+        }
+        CHECK(lineCount == total.count);
+
+        profiler.reset();
+        CHECK(profiler.getTotal().count == 0);
+    }
+}
+
+TEST_CASE("VMProfiler exports a Chrome trace", "[scripting][vm_profiler]")
+{
+    CompiledScript script = compileScript(kScript);
+
+    VMProfiler profiler;
+    profiler.record(0, OpCode::PUSH_INT, 1500);
+    profiler.record(1, OpCode::STORE_VAR, 500);
+    profiler.record(0, OpCode::PUSH_INT, 1500);
+
+    const std::string path = "vm_profiler_trace_test.json";
+    REQUIRE(profiler.exportToChromeTrace(path, script.lineTable));
+
+    std::ifstream file(path);
+    REQUIRE(file.is_open());
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string trace = buffer.str();
+    file.close();
+    std::remove(path.c_str());
+
+    CHECK(trace.find("{\"traceEvents\":[") == 0);
+    CHECK(trace.find("\"name\":\"PUSH_INT\"") != std::string::npos);
+    CHECK(trace.find("\"ph\":\"X\"") != std::string::npos);
+    CHECK(trace.find("\"count\":2") != std::string::npos);
+    CHECK(trace.find("\"name\":\"line 2:") != std::string::npos);
+    // The hottest opcode starts the track
+    CHECK(trace.find("PUSH_INT") < trace.find("STORE_VAR"));
+}